@@ -0,0 +1,397 @@
+#ifndef balance_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define balance_h // Precompiler macro used for precompiler check.
+
+#include <main.h> // Header file for all libraries needed by this program.
+#include <ESP32TimerInterrupt.h> // https://github.com/khoih-prog/ESP32TimerInterrupt
+#include <amBalance.h> // Pure balance control step.
+#include <amLoopStats.h> // Execution time, jitter and overrun statistics.
+#include <amTilt.h> // Pitch estimators.
+#include <amOdometry.h> // Wheel speeds and pose from the encoders.
+#include <amTrajectory.h> // Velocity profiles and queued paths.
+
+const uint16_t BALANCE_MIN_HZ = 200; // Slowest balance loop rate allowed.
+const uint16_t BALANCE_MAX_HZ = 1000; // Fastest balance loop rate allowed.
+const uint16_t BALANCE_DEFAULT_HZ = 200; // Balance loop rate used at boot.
+const uint8_t BALANCE_TIMER = 1; // ESP32 hardware timer that paces the loop. Timer 0 left free.
+const BaseType_t BALANCE_CORE = 1; // Application core. WiFi and the network stack live on core 0.
+const UBaseType_t BALANCE_PRIORITY = configMAX_PRIORITIES - 1; // Preempts loop() and everything else on core 1.
+const uint32_t BALANCE_STACK = 4096; // Bytes of stack for the balance task.
+const float WHEEL_DIAMETER = 0.1; // Wheel diameter in metres.
+const float TICKS_PER_REV = 360.0; // MD25 encoder ticks per wheel revolution.
+const float TRACK_WIDTH = 0.2; // Metres between the centres of the two wheels.
+const uint32_t ODOMETRY_IDLE_US = 50000; // How often the encoders are read for odometry while the balance loop is not driving.
+const profileLimits PATH_STRAIGHT_LIMITS = {0.3f, 0.5f, 2.0f}; // Straight segments. m/s, m/s/s, m/s/s/s.
+const profileLimits PATH_TURN_LIMITS = {1.5f, 3.0f, 15.0f}; // Turns on the spot. rad/s, rad/s/s, rad/s/s/s.
+const float PATH_COMMAND_PER_MPS = 143.0; // Motor command per m/s of wheel speed. An EMG30 at 170 rpm is 0.89 m/s at full command.
+const float PATH_TURN_KP = 4.0; // Motor command per rad/s of turn rate error. Much more and the turn loop rings.
+
+ESP32Timer balanceTimer(BALANCE_TIMER); // Hardware timer that wakes the balance task.
+TaskHandle_t balanceTaskHandle = NULL; // Balance task, pinned to BALANCE_CORE.
+amLoopStats balanceStats(1000000 / BALANCE_DEFAULT_HZ); // Timing of each balance cycle.
+balanceGains balanceGain = BALANCE_DEFAULT_GAINS; // Controller tuning.
+balanceCascade balancePid; // Speed loop cascaded into the angle loop. Used at BALANCE_CASCADE_HZ.
+float balanceTargetSpeed = 0.0f; // Wheel speed in metres/second the cascade should hold.
+amTiltKalman balanceTilt(IMU_SAMPLE_PERIOD, IMU_GYRO_LSB_PER_DPS); // Pitch from the IMU samples. Float is fine in a task.
+balanceInput balanceIn = {0, 0, 0}; // Latest sensor readings handed to the controller.
+balanceOutput balanceOut = {0, false}; // Latest controller decision.
+volatile bool balanceEnabled = false; // True when the loop is allowed to drive the motors.
+md25Telemetry balanceLastSnapshot = {0, 0, 0, 0, 0}; // Encoder readings from the previous cycle.
+amOdometry odometry({WHEEL_DIAMETER, TRACK_WIDTH, TICKS_PER_REV}); // Wheel speeds and pose. Only the balance task updates it.
+uint16_t odometryIdleCycles = 0; // Cycles since the encoders were last read while not driving.
+volatile bool odometryResetRequested = false; // Set by resetOdometry(). The balance task does the reset.
+amPath balancePath(PATH_STRAIGHT_LIMITS, PATH_TURN_LIMITS); // Segments queued by loop(), run by the balance task.
+pathSetpoint balancePathSetpoint = {0, 0, 0, 0, false}; // What the path wants this cycle.
+uint16_t balanceTelemetryCycles = 0; // Cycles since the last state sample.
+md25Telemetry balanceTelemetrySnapshot = {0, 0, 0, 0, 0}; // Encoder readings at the last state sample.
+uint32_t balanceTelemetryUs = 0; // When the last state sample was taken.
+amI2cPort md25ControlPort(i2cBus0, I2C_PRIO_CONTROL, I2C_CONTROL_TIMEOUT_US); // Balance task's way to the MD25. Goes ahead of loop() and the LCD.
+amMD25Driver md25Control(md25ControlPort, md25I2cAddress, &md25Shadow); // The MD25, as seen by the balance task. Shares the register shadow with md25.
+
+/**
+ * @brief Timer interrupt. Wakes the balance task.
+ * @details Does nothing but give the task a notification. If the task has not finished the last
+ * cycle the notification count climbs and the task records the missed ticks as overruns.
+ * ==========================================================================*/
+void IRAM_ATTR balanceTimerISR()
+{
+   BaseType_t woken = pdFALSE;
+   vTaskNotifyGiveFromISR(balanceTaskHandle, &woken); // Count one tick for the task.
+   if(woken == pdTRUE) // Balance task outranks whatever was interrupted.
+   {
+      portYIELD_FROM_ISR();
+   } // if
+} // balanceTimerISR()
+
+/**
+ * @brief Read the sensors for one balance cycle.
+ * @details Reads the MD25 every cycle while the loop is driving the motors. Otherwise only every
+ * ODOMETRY_IDLE_US, enough for odometry to follow moves made by the motion engine in loop()
+ * without taking much bus0 time from it. Wheel speed comes from odometry, which times the ticks
+ * when they are slow.
+ * @param nowUs micros() at the start of the cycle.
+ * ==========================================================================*/
+void balanceSense(uint32_t nowUs)
+{
+   collectImuSamples(); // Every IMU sample since the last cycle. IMU has bus1 to itself.
+   if(balanceEnabled == false && (md25Device.isPresent() == false || ++odometryIdleCycles < ODOMETRY_IDLE_US / balanceStats.getPeriod()))
+   {
+      return;
+   } // if
+   odometryIdleCycles = 0;
+   if(odometryResetRequested == true)
+   {
+      odometry.reset({0.0f, 0.0f, 0.0f}); // Here, facing the way the robot faces now.
+      odometryResetRequested = false;
+   } // if
+   md25Telemetry snapshot;
+   if(md25Control.readTelemetrySnapshot(&snapshot) != I2C_OK)
+   {
+      return; // Keep the last wheel speed.
+   } // if
+   odometry.update(snapshot.encoder1, snapshot.encoder2, nowUs);
+   balanceIn.wheelSpeed = odometry.getSpeed();
+   balanceLastSnapshot = snapshot;
+} // balanceSense()
+
+/**
+ * @brief Update the pitch estimate for one balance cycle.
+ * @details Runs every IMU sample collected this cycle through the Kalman filter, oldest first, so
+ * the estimate keeps the full 1kHz sample rate whatever rate the loop runs at.
+ * ==========================================================================*/
+void balanceEstimate()
+{
+   if(imuSampleCount == 0) // No new samples. Keep the last estimate.
+   {
+      return;
+   } // if
+   balanceTilt.updateBatch(imuSamples, imuSampleCount);
+   balanceIn.pitch = balanceTilt.getAngle();
+   balanceIn.pitchRate = balanceTilt.getRate();
+} // balanceEstimate()
+
+/**
+ * @brief Work out the motor command for one balance cycle.
+ * @details The cascaded PID gains are fixed at compile time for BALANCE_CASCADE_HZ, so at any
+ * other loop rate the plain PD step is used instead. While the loop is not driving the motors the
+ * cascade is held in reset so that it starts clean when enableBalance() hands it control. A path
+ * that is running sets the speed the cascade holds, so straight segments only drive at
+ * BALANCE_CASCADE_HZ. The path is dropped if the loop stops driving or the robot falls.
+ * @param nowUs micros() at the start of the cycle.
+ * ==========================================================================*/
+void balanceControl(uint32_t nowUs)
+{
+   if(balanceEnabled == false)
+   {
+      balancePid.reset(balanceIn.wheelSpeed, balanceIn.pitch);
+   } // if
+   if(balanceEnabled == false || balanceOut.fallen == true)
+   {
+      balancePath.stop();
+   } // if
+   bool wasActive = balancePathSetpoint.active;
+   balancePathSetpoint = balancePath.tick(nowUs);
+   if(balancePathSetpoint.active == true || wasActive == true) // Hand back a standstill when the path ends.
+   {
+      balanceTargetSpeed = balancePathSetpoint.speed;
+   } // if
+   if(balanceEnabled == true && balanceStats.getPeriod() == 1000000 / BALANCE_CASCADE_HZ)
+   {
+      balanceOut = balanceCascadeStep(balancePid, balanceGain, balanceIn, balanceTargetSpeed);
+   } // if
+   else
+   {
+      balanceOut = balanceStep(balanceGain, balanceIn);
+   } // else
+} // balanceControl()
+
+/**
+ * @brief Motor command to add to the right wheel, and take from the left, to follow the path's turn rate.
+ * @details Feeds the wheel speed the turn needs forward and trims it on the turn rate odometry
+ * measures. Anticlockwise is positive, so the right wheel goes faster.
+ * @return Motor command. 0 when no path is running.
+ * ==========================================================================*/
+float balanceSteer()
+{
+   if(balancePathSetpoint.active == false)
+   {
+      return 0.0f;
+   } // if
+   float wheelSpeed = balancePathSetpoint.turnRate * TRACK_WIDTH * 0.5f; // m/s of each wheel about the middle.
+   return PATH_COMMAND_PER_MPS * wheelSpeed + PATH_TURN_KP * (balancePathSetpoint.turnRate - odometry.getTurnRate());
+} // balanceSteer()
+
+/**
+ * @brief Send the controller output to the motors.
+ * ==========================================================================*/
+void balanceActuate()
+{
+   if(balanceEnabled == false)
+   {
+      return;
+   } // if
+   if(balanceOut.fallen == true)
+   {
+      md25Control.stop();
+      return;
+   } // if
+   float steer = balanceSteer();
+   md25Control.setSpeeds(balanceToSpeed(balanceOut.command - steer), balanceToSpeed(balanceOut.command + steer)); // Mode 0. Speed1 is the left wheel.
+} // balanceActuate()
+
+/**
+ * @brief Hand the latest readings to loop() for the state telemetry topic.
+ * @details Runs every TELEMETRY_STATE_US worth of cycles. Only copies the readings into the ring.
+ * Encoding and sending are left to checkTelemetry(). Wheel speeds are per wheel, worked out over
+ * the time since the last sample.
+ * @param nowUs micros() at the start of the cycle.
+ * ==========================================================================*/
+void balanceTelemetry(uint32_t nowUs)
+{
+   if(++balanceTelemetryCycles < TELEMETRY_STATE_US / balanceStats.getPeriod())
+   {
+      return;
+   } // if
+   balanceTelemetryCycles = 0;
+   telemetryStateEntry entry;
+   entry.ms = millis();
+   entry.state.pitch = tlmFixed16(balanceIn.pitch, 100); // 0.01 degree.
+   entry.state.pitchRate = tlmFixed16(balanceIn.pitchRate, 10); // 0.1 degree/s.
+   entry.state.wheelSpeed1 = 0;
+   entry.state.wheelSpeed2 = 0;
+   uint32_t dtUs = nowUs - balanceTelemetryUs;
+   if(balanceTelemetryUs != 0 && dtUs > 0)
+   {
+      float metresPerTick = PI * WHEEL_DIAMETER / TICKS_PER_REV;
+      entry.state.wheelSpeed1 = tlmFixed16((balanceLastSnapshot.encoder1 - balanceTelemetrySnapshot.encoder1) * metresPerTick * 1000000.0 / dtUs, 1000); // mm/s.
+      entry.state.wheelSpeed2 = tlmFixed16((balanceLastSnapshot.encoder2 - balanceTelemetrySnapshot.encoder2) * metresPerTick * 1000000.0 / dtUs, 1000); // mm/s.
+   } // if
+   entry.state.encoder1 = balanceLastSnapshot.encoder1;
+   entry.state.encoder2 = balanceLastSnapshot.encoder2;
+   entry.state.batteryVolts = balanceLastSnapshot.batteryVolts;
+   entry.state.motorCurrent1 = balanceLastSnapshot.motorCurrent1;
+   entry.state.motorCurrent2 = balanceLastSnapshot.motorCurrent2;
+   entry.state.execUs = tlmClamp16(balanceStats.getExecLastUs());
+   entry.state.flags = (balanceEnabled ? TLM_STATE_BALANCING : 0) | (balanceOut.fallen ? TLM_STATE_FALLEN : 0);
+   telemetryStates.push(&entry, sizeof(entry)); // Full ring drops its oldest entry.
+   balanceTelemetrySnapshot = balanceLastSnapshot;
+   balanceTelemetryUs = nowUs;
+} // balanceTelemetry()
+
+/**
+ * @brief Fill in the balance loop timing of a health sample.
+ * @param health Sample.
+ * ==========================================================================*/
+void balanceHealth(tlmHealth* health)
+{
+   health->loopPeriodUs = tlmClamp16(balanceStats.getPeriod());
+   health->loopExecMaxUs = tlmClamp16(balanceStats.getExecMaxUs());
+   health->loopJitterMaxUs = tlmClamp16(balanceStats.getJitterMaxUs());
+   health->loopOverruns = balanceStats.getOverruns();
+} // balanceHealth()
+
+/**
+ * @brief Balance task. Runs sense, estimate, control and actuate once per timer tick.
+ * ==========================================================================*/
+void balanceTask(void*)
+{
+   for(;;)
+   {
+      uint32_t ticks = ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // Sleep until the timer fires.
+      uint32_t startUs = micros();
+      if(ticks > 1) // Timer fired more than once since the last cycle.
+      {
+         balanceStats.recordMissed(ticks - 1);
+      } // if
+      balanceSense(startUs);
+      balanceEstimate();
+      balanceControl(startUs);
+      balanceActuate();
+      balanceStats.record(startUs, micros());
+      balanceTelemetry(startUs); // After record() so that execUs is this cycle's.
+   } // for
+} // balanceTask()
+
+/**
+ * @brief Let the balance loop drive the motors, or take control away from it.
+ * @param enable true to drive the motors from the balance loop.
+ * @return false if a move started by spinMotor() is still running, or the MD25 did not take the
+ * mode and acceleration the loop needs. The loop is left disabled.
+ * ==========================================================================*/
+bool enableBalance(bool enable)
+{
+   if(enable == true && motion.isBusy() == true)
+   {
+      LOG_WARNINGLN(LOG_MOD_BALANCE, "<enableBalance> Motion engine busy. Balance loop not enabled.");
+      return false;
+   } // if
+   if(enable == true)
+   {
+      uint8_t status = md25.setModeAndAcceleration(MD25ModeUnsigned, MD25AccelFastest); // Speed1 and speed2 drive each motor. The loop and the path profiles shape the commands, so a ramp on top only adds lag.
+      if(status != I2C_OK)
+      {
+         LOG_ERRORLN(LOG_MOD_BALANCE, "<enableBalance> MD25 mode not set. Balance loop not enabled. I2C status = %d", status);
+         return false;
+      } // if
+   } // if
+   balanceEnabled = enable;
+   if(enable == false)
+   {
+      md25.stop();
+      md25.setAcceleration(MD25AccelDefault); // Back to the rate spinMotor() moves expect.
+   } // if
+   LOG_NOTICELN(LOG_MOD_BALANCE, "<enableBalance> Balance loop driving motors = %T", enable);
+   return true;
+} // enableBalance()
+
+/**
+ * @brief Change the balance loop rate.
+ * @param hz Loop rate. Clamped to BALANCE_MIN_HZ to BALANCE_MAX_HZ.
+ * ==========================================================================*/
+void setBalanceRate(uint16_t hz)
+{
+   if(hz < BALANCE_MIN_HZ)
+   {
+      hz = BALANCE_MIN_HZ;
+   } // if
+   if(hz > BALANCE_MAX_HZ)
+   {
+      hz = BALANCE_MAX_HZ;
+   } // if
+   balanceStats.setPeriod(1000000 / hz);
+   balanceTimer.attachInterruptInterval(balanceStats.getPeriod(), balanceTimerISR);
+   LOG_VERBOSELN(LOG_MOD_BALANCE, "<setBalanceRate> Balance loop running at %d Hz.", hz);
+} // setBalanceRate()
+
+/**
+ * @brief Start the balance task and the timer that drives it.
+ * @details The loop runs from boot with the motors disabled so that its timing can be checked
+ * before it is trusted with the drive train. See enableBalance().
+ * @param hz Loop rate.
+ * @return true if the task was created.
+ * ==========================================================================*/
+bool startBalanceLoop(uint16_t hz = BALANCE_DEFAULT_HZ)
+{
+   LOG_TRACELN(LOG_MOD_BALANCE, "<startBalanceLoop> Start balance task on core %d.", BALANCE_CORE);
+   BaseType_t created = xTaskCreatePinnedToCore(balanceTask, "balance", BALANCE_STACK, NULL, BALANCE_PRIORITY, &balanceTaskHandle, BALANCE_CORE);
+   if(created != pdPASS)
+   {
+      LOG_ERRORLN(LOG_MOD_BALANCE, "<startBalanceLoop> Could not create balance task.");
+      return false;
+   } // if
+   setBalanceRate(hz);
+   return true;
+} // startBalanceLoop()
+
+/**
+ * @brief Send balance loop timing to the console.
+ * ==========================================================================*/
+void showBalanceStats()
+{
+   LOG_VERBOSELN(LOG_MOD_BALANCE, "<showBalanceStats> Period = %l us, cycles = %l, exec last/avg/max = %l/%l/%l us, worst jitter = %l us, overruns = %l.",
+      balanceStats.getPeriod(), balanceStats.getCycles(), balanceStats.getExecLastUs(), balanceStats.getExecAvgUs(),
+      balanceStats.getExecMaxUs(), balanceStats.getJitterMaxUs(), balanceStats.getOverruns());
+} // showBalanceStats()
+
+/**
+ * @brief Log where odometry puts the robot and how fast its wheels are turning.
+ * @details Read from outside the balance task, so the fields can be one update apart.
+ * ==========================================================================*/
+void showOdometry()
+{
+   odometryPose pose = odometry.getPose();
+   LOG_NOTICELN(LOG_MOD_BALANCE, "<showOdometry> x = %l mm, y = %l mm, heading = %l mrad, turned = %l mrad, driven = %l mm.", (long)(pose.x * 1000),
+                (long)(pose.y * 1000), (long)(pose.heading * 1000), (long)(odometry.getTurned() * 1000), (long)(odometry.getDistance() * 1000));
+   LOG_NOTICELN(LOG_MOD_BALANCE, "<showOdometry> Wheel speeds left = %l mm/s, right = %l mm/s, turn rate = %l mrad/s.", (long)(odometry.getLeftSpeed() * 1000),
+                (long)(odometry.getRightSpeed() * 1000), (long)(odometry.getTurnRate() * 1000));
+} // showOdometry()
+
+/**
+ * @brief Make where the robot is now the odometry origin, facing along x.
+ * @details Done by the balance task at its next MD25 read, as it owns the odometry.
+ * ==========================================================================*/
+void resetOdometry()
+{
+   odometryResetRequested = true;
+} // resetOdometry()
+
+/**
+ * @brief Queue a segment for the balance loop to drive.
+ * @details Segments run one after another, each starting and ending at rest, for as long as the
+ * balance loop is driving the motors.
+ * @param segment Straight move in metres or turn on the spot in radians.
+ * @return false if the balance loop is not driving the motors, or the segment was refused.
+ * ==========================================================================*/
+bool addPathSegment(const pathSegment &segment)
+{
+   if(balanceEnabled == false)
+   {
+      LOG_WARNINGLN(LOG_MOD_BALANCE, "<addPathSegment> Balance loop not driving motors. Segment not queued.");
+      return false;
+   } // if
+   if(balancePath.add(segment) == false)
+   {
+      LOG_WARNINGLN(LOG_MOD_BALANCE, "<addPathSegment> Segment refused. %d already queued.", balancePath.getQueued());
+      return false;
+   } // if
+   return true;
+} // addPathSegment()
+
+/**
+ * @brief Drop the segment running and everything queued. The robot is asked to hold still.
+ * ==========================================================================*/
+void stopPath()
+{
+   balancePath.stop();
+} // stopPath()
+
+/**
+ * @brief Log how far through its path the balance loop is.
+ * ==========================================================================*/
+void showPath()
+{
+   LOG_NOTICELN(LOG_MOD_BALANCE, "<showPath> Busy = %T, queued = %d, started = %l, finished = %l, stopped = %l, refused = %l.", balancePath.isBusy(),
+                balancePath.getQueued(), (long)balancePath.getStarted(), (long)balancePath.getFinished(), (long)balancePath.getStopped(), (long)balancePath.getRejected());
+} // showPath()
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,194 @@
+#ifndef bootSequence_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define bootSequence_h // Precompiler macro used for precompiler check.
+
+#include <main.h> // Header file for all libraries needed by this program.
+#include <amBoot.h> // Boot profiler and dependency aware start up sequence.
+
+/**
+ * @brief Start up sequence and boot profile.
+ * @details setup() used to bring everything up one step after another. The 
+ * steps are now phases of a graph that amBoot runs, each in a task of its own
+ * as soon as the phases it needs have finished:
+ * - net: start WiFi. Only starts it. checkWifiLink() does the rest from loop().
+ * - scan0, motors, lcd: bus0. The motors and LCD wait for the probe that finds
+ *   them. The LCD driver sleeps for over a second with bus0 to itself, so it
+ *   goes last.
+ * - scan1, imu, balance: bus1, on the balance core so that the IMU and timer 
+ *   interrupts land there.
+ * - ready: milestone once the motors and the balance loop are up.
+ * Every phase is timed. WiFi getting its address and the broker accepting are
+ * added as they happen, and the whole breakdown goes to the events topic once
+ * the broker is there. The BOOT command logs it again.
+ * ==========================================================================*/
+const uint32_t BOOT_STACK = 4096; // Bytes of stack for each phase task.
+const uint8_t BOOT_PRIORITY = 1; // Same as loop().
+const size_t BOOT_REPORT_LEN = 384; // Longest boot report. One telemetry frame.
+amBoot boot; // Phases of the start up sequence and their times.
+uint32_t bootWifiStartUs = 0; // When the net phase started WiFi.
+uint32_t bootWifiUpUs = 0; // When WiFi got its address. 0 until then.
+bool bootReported = false; // Boot report sent on the events topic.
+
+/**
+ * @brief Phase: start WiFi. Returns at once.
+ * ==========================================================================*/
+bool bootNetwork(void*)
+{
+   LOG_VERBOSELN(LOG_MOD_BOOT, "<bootNetwork> Start wifi connection. Web and MQTT services start once it is up."); 
+   bootWifiStartUs = micros();
+   network.onProgress(wifiProgress); // Log each step.
+   network.connect(); // checkWifiLink() does the rest from loop().
+   return true;
+} // bootNetwork()
+
+/**
+ * @brief Phase: find the devices on bus0.
+ * ==========================================================================*/
+bool bootScanBus0(void*)
+{
+   probeBus(0);
+   return true;
+} // bootScanBus0()
+
+/**
+ * @brief Phase: find the devices on bus1.
+ * ==========================================================================*/
+bool bootScanBus1(void*)
+{
+   probeBus(1);
+   return true;
+} // bootScanBus1()
+
+/**
+ * @brief Phase: set up the MD25 and start the self-test move.
+ * ==========================================================================*/
+bool bootMotors(void*)
+{
+   if(md25Device.isPresent() == false)
+   {
+      LOG_ERRORLN(LOG_MOD_BOOT, "<bootMotors> Motor driver not connencted to I2C bus. No motion is possible.");
+      mobilityStatus = false;
+      return false;
+   } // if
+   LOG_TRACELN(LOG_MOD_BOOT, "<bootMotors> Initialize DC motor driver.");
+   mobilityStatus = initMobility(); // Initialize drive motors. 
+   return mobilityStatus;
+} // bootMotors()
+
+/**
+ * @brief Phase: set up the LCD.
+ * ==========================================================================*/
+bool bootLcd(void*)
+{
+   if(lcdDevice.isPresent() == false)
+   {
+      LOG_WARNINGLN(LOG_MOD_BOOT, "<bootLcd> LCD not connencted to I2C bus. No LCD messages to be issued.");
+      return false;
+   } // if
+   LOG_TRACELN(LOG_MOD_BOOT, "<bootLcd> Initialize LCD.");
+   initLcd();
+   return true;
+} // bootLcd()
+
+/**
+ * @brief Phase: start the MPU6050 FIFO.
+ * ==========================================================================*/
+bool bootImu(void*)
+{
+   if(imuDevice.isPresent() == false)
+   {
+      LOG_ERRORLN(LOG_MOD_BOOT, "<bootImu> MPU6050 not connencted to I2C bus. No balancing is possible.");
+      return false;
+   } // if
+   LOG_TRACELN(LOG_MOD_BOOT, "<bootImu> Initialize IMU.");
+   return initImu();
+} // bootImu()
+
+/**
+ * @brief Phase: start the balance control loop, motors disabled.
+ * ==========================================================================*/
+bool bootBalance(void*)
+{
+   LOG_VERBOSELN(LOG_MOD_BOOT, "<bootBalance> Start balance control loop."); 
+   return startBalanceLoop(BALANCE_DEFAULT_HZ); // Runs with motors disabled until enableBalance() is called.
+} // bootBalance()
+
+/**
+ * @brief Run the start up sequence. Returns when every phase has ended.
+ * ==========================================================================*/
+void runBootSequence()
+{
+   boot.setTaskEnd(releaseDeferredLogChannel); // Phase tasks give their log channels back.
+   uint8_t scan0 = boot.add("scan0", bootScanBus0, nullptr, 0);
+   uint8_t scan1 = boot.add("scan1", bootScanBus1, nullptr, 0);
+   boot.add("net", bootNetwork, nullptr, 0);
+   uint8_t motors = boot.add("motors", bootMotors, nullptr, BOOT_AFTER(scan0));
+   uint8_t imu = boot.add("imu", bootImu, nullptr, BOOT_AFTER(scan1), BALANCE_CORE);
+   uint8_t balance = boot.add("balance", bootBalance, nullptr, BOOT_AFTER(imu), BALANCE_CORE);
+   uint8_t ready = boot.milestone("ready", BOOT_AFTER(motors) | BOOT_AFTER(balance));
+   boot.add("lcd", bootLcd, nullptr, BOOT_AFTER(motors));
+   bool ok = boot.run(BOOT_STACK, BOOT_PRIORITY);
+   if(boot.getState(ready) == BOOT_DONE)
+   {
+      LOG_NOTICELN(LOG_MOD_BOOT, "<runBootSequence> Ready to balance %l ms after reset. Start up took %l ms, critical path %l ms, %l ms one after another.", 
+                   (long)(boot.getEndUs(ready) / 1000), (long)(boot.getWallUs() / 1000), (long)(boot.getCriticalPathUs() / 1000), (long)(boot.getSerialUs() / 1000));
+   } // if
+   else
+   {
+      LOG_WARNINGLN(LOG_MOD_BOOT, "<runBootSequence> Not ready to balance. Start up took %l ms, critical path %l ms, %l ms one after another.", 
+                    (long)(boot.getWallUs() / 1000), (long)(boot.getCriticalPathUs() / 1000), (long)(boot.getSerialUs() / 1000));
+   } // else
+   if(ok == false)
+   {
+      LOG_WARNINGLN(LOG_MOD_BOOT, "<runBootSequence> Not every phase worked. See BOOT for which.");
+   } // if
+} // runBootSequence()
+
+/**
+ * @brief Add WiFi getting its address to the boot profile. Called by checkWifiLink().
+ * ==========================================================================*/
+void bootWifiUp()
+{
+   bootWifiUpUs = micros();
+   boot.record("wifi", bootWifiStartUs, bootWifiUpUs);
+} // bootWifiUp()
+
+/**
+ * @brief Log the boot profile, one phase to a line.
+ * ==========================================================================*/
+void showBootProfile()
+{
+   static const char* STATES[] = {"not started", "running", "ok", "failed"};
+   for(uint8_t i = 0; i < boot.getCount(); i++)
+   {
+      uint32_t lengthUs = boot.getEndUs(i) - boot.getStartUs(i);
+      LOG_NOTICELN(LOG_MOD_BOOT, "<showBootProfile> %s started %l ms after reset, took %l us, %s%s.", boot.getName(i), (long)(boot.getStartUs(i) / 1000), 
+                   (long)lengthUs, boot.getInGraph(i) ? STATES[boot.getState(i)] : "outside the graph", boot.isCritical(i) ? ", critical path" : "");
+   } // for
+   char text[BOOT_REPORT_LEN];
+   boot.report(text, sizeof(text));
+   LOG_NOTICELN(LOG_MOD_BOOT, "<showBootProfile> %s", text);
+} // showBootProfile()
+
+/**
+ * @brief Send the boot profile to the events topic once the broker is there. 
+ * Call from loop().
+ * ==========================================================================*/
+void checkBootReport()
+{
+   if(bootReported == true || mqttBrokerConnected == false || bootEvents < 0)
+   {
+      return;
+   } // if
+   static bool mqttRecorded = false; // Broker time added to the profile.
+   if(mqttRecorded == false)
+   {
+      mqttRecorded = true;
+      boot.record("mqtt", bootWifiUpUs, micros());
+   } // if
+   char text[BOOT_REPORT_LEN];
+   boot.report(text, sizeof(text));
+   bootReported = telemetry.event(bootEvents, text) == TLM_OK; // Send window full. Try again next loop().
+} // checkBootReport()
+
+#endif // End of precompiler protected code block
@@ -9,50 +9,56 @@ aaChip appCpu; // Access information about the ESP32 application microprocessor
 aaNetwork network(HOST_NAME_PREFIX); // WiFi session management.
 bool networkConnected = false; // Track WiFi connectivity status.
 bool mqttBrokerConnected = false; // Track MQTT broker connection status.
-bool lcdConnected = false; // Track LED I2C connection status.
-bool motorControllerConnected = false; // Track motor controller I2C connectionstatus.
 
 /** 
  * @brief Show the environment details of this application on console.
  * =================================================================================*/
 void showCfgDetails()
 {
-   Log.verboseln("<showCfgDetails> Robot Configuration Report");
-   Log.verboseln("<showCfgDetails> ==========================");
+   LOG_VERBOSELN(LOG_MOD_CONFIG, "<showCfgDetails> Robot Configuration Report");
+   LOG_VERBOSELN(LOG_MOD_CONFIG, "<showCfgDetails> ==========================");
    appCpu.cfgToConsole(); // Display core0 information on the console.
    if(networkConnected == true)
    {
-      Log.verboseln("<showCfgDetails> Network connection status = TRUE");
+      LOG_VERBOSELN(LOG_MOD_CONFIG, "<showCfgDetails> Network connection status = TRUE");
       network.cfgToConsole(); // Display network information on the console.
       if(mqttBrokerConnected == true)
       {
-         Log.verboseln("<showCfgDetails> MQTT broker connection status = TRUE");
-         Log.verboseln("<showCfgDetails> MQTT broker IP address = %p", getMqttBrokerIP());
+         LOG_VERBOSELN(LOG_MOD_CONFIG, "<showCfgDetails> MQTT broker connection status = TRUE");
+         LOG_VERBOSELN(LOG_MOD_CONFIG, "<showCfgDetails> MQTT broker IP address = %p", getMqttBrokerIP());
       } // if
       else
       {
-         Log.verboseln("<showCfgDetails> MQTT broker connection status = FALSE");
+         LOG_VERBOSELN(LOG_MOD_CONFIG, "<showCfgDetails> MQTT broker connection status = FALSE");
       } // else
    } // if
    else
    {
-      Log.verboseln("<showCfgDetails> Network connection status = FALSE");
+      LOG_VERBOSELN(LOG_MOD_CONFIG, "<showCfgDetails> Network connection status = FALSE");
    } // else
-   if(lcdConnected == true)
+   if(lcdDevice.isPresent() == true)
    {
-      Log.verboseln("<showCfgDetails> LED connection status = TRUE.");
+      LOG_VERBOSELN(LOG_MOD_CONFIG, "<showCfgDetails> LED connection status = TRUE.");
    } // if
    else
    {
-      Log.verboseln("<showCfgDetails> LED connection status = FALSE.");
+      LOG_VERBOSELN(LOG_MOD_CONFIG, "<showCfgDetails> LED connection status = FALSE.");
    } // else
-   if(motorControllerConnected == true)
+   if(md25Device.isPresent() == true)
    {
-      Log.verboseln("<showCfgDetails> DC motor controller connection status = TRUE.");
+      LOG_VERBOSELN(LOG_MOD_CONFIG, "<showCfgDetails> DC motor controller connection status = TRUE.");
    } // if
    else
    {
-      Log.verboseln("<showCfgDetails> DC motor controller connection status = FALSE.");
+      LOG_VERBOSELN(LOG_MOD_CONFIG, "<showCfgDetails> DC motor controller connection status = FALSE.");
+   } // else
+   if(imuDevice.isPresent() == true)
+   {
+      LOG_VERBOSELN(LOG_MOD_CONFIG, "<showCfgDetails> MPU6050 IMU connection status = TRUE.");
+   } // if
+   else
+   {
+      LOG_VERBOSELN(LOG_MOD_CONFIG, "<showCfgDetails> MPU6050 IMU connection status = FALSE.");
    } // else
 } //showCfgDetails()
 
@@ -62,14 +68,14 @@ void showCfgDetails()
 /*
 void checkBoot()
 {
-   if(networkConnected == true && mqttBrokerConnected == true && lcdConnected == true && mobilityStatus == true)
+   if(networkConnected == true && mqttBrokerConnected == true && lcdDevice.isPresent() == true && mobilityStatus == true)
    {
-      Log.verboseln("<checkBoot> Bootup was normal. Set RGB LED to normal colour."); 
+      LOG_VERBOSELN(LOG_MOD_CONFIG, "<checkBoot> Bootup was normal. Set RGB LED to normal colour."); 
       setStdRgbColour(BLUE); // Indicates that bootup was normal.
    } // if
    else
    {
-      Log.verboseln("<checkBoot> Bootup had an issue. Set RGB LED to warning colour."); 
+      LOG_VERBOSELN(LOG_MOD_CONFIG, "<checkBoot> Bootup had an issue. Set RGB LED to warning colour."); 
       setStdRgbColour(YELLOW); // Indicates that there was a bootup issue.
    } // else
 } // checkBoot
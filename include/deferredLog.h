@@ -0,0 +1,221 @@
+#ifndef deferredLog_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define deferredLog_h // Precompiler macro used for precompiler check.
+
+#include <main.h> // Header file for all libraries needed by this program.
+
+/**
+ * @brief Deferred log backend. Only built with -D LOG_DEFERRED.
+ * @details With LOG_DEFERRED the LOG_xxxLN() macros of logLevels.h call logDeferred() instead of
+ * Log. Each task that logs is lent its own amDeferredLogChannel the first time it logs, so every
+ * channel has exactly one producer and needs no lock. A task that is going to delete itself gives
+ * its channel back with releaseDeferredLogChannel() first. amBoot does this for every boot phase
+ * task, so the phase tasks do not use up the channels of the tasks that run for good. A task that
+ * finds every channel lent out logs straight to Log until one is free. A low priority task on core 0, away from the
+ * balance loop on core 1, drains the channels and prints each record through Log's output as text,
+ * or as binary frames after setDeferredLogBinary(true). Decode a binary capture on the host with
+ * native/tools/dlogDecode.cpp. Records that find their channel full are dropped and counted, and
+ * the running total is reported whenever it goes up.
+ * ==========================================================================*/
+#ifdef LOG_DEFERRED
+#include <amDeferredLog.h> // Deferred log records, channels and frames.
+
+const uint8_t DLOG_CHANNELS = 8; // Tasks logging deferred at once: loop, balance, I2C workers, network tasks and boot phases.
+const BaseType_t DLOG_CORE = 0; // Network core. Keeps formatting off the balance loop core.
+const UBaseType_t DLOG_PRIORITY = 1; // Just above idle.
+const uint32_t DLOG_STACK = 4096; // Bytes of stack for the drain task.
+const uint32_t DLOG_IDLE_MS = 10; // Sleep between drains when there is nothing to do.
+const uint8_t DLOG_SENT_FORMATS = 64; // Format strings remembered as already sent in binary mode.
+
+amDeferredLogChannels<DLOG_CHANNELS> dlogChannels; // Lent to logging tasks.
+thread_local int8_t dlogChannel = -1; // Channel of the task that is running. -1 until it has one.
+TaskHandle_t dlogTaskHandle = NULL; // Drain task.
+volatile bool dlogBinary = false; // Drain as binary frames rather than text.
+const char* dlogSent[DLOG_SENT_FORMATS]; // Formats whose frame has gone out since binary mode started.
+uint8_t dlogSentCount = 0; // Entries in dlogSent.
+uint32_t dlogReportedDrops = 0; // Dropped total last reported.
+
+/**
+ * @brief Find the channel of the task that is running, claiming a free one if it has none.
+ * @return Channel index, or -1 while every channel is lent to other tasks.
+ * ==========================================================================*/
+int8_t deferredLogChannel()
+{
+   if(dlogChannel < 0)
+   {
+      dlogChannel = dlogChannels.claim();
+   } // if
+   return dlogChannel;
+} // deferredLogChannel()
+
+/**
+ * @brief Give the running task's channel back. Call before a task that has logged deletes itself.
+ * @details Records already queued are still drained.
+ * ==========================================================================*/
+void releaseDeferredLogChannel()
+{
+   dlogChannels.release(dlogChannel);
+   dlogChannel = -1;
+} // releaseDeferredLogChannel()
+
+/**
+ * @brief Queue a log call for the drain task.
+ * @details Only the level check, a copy of the arguments and a ring push happen here.
+ * @param level LOG_LEVEL_ value.
+ * @param format ArduinoLog style format string literal.
+ * ==========================================================================*/
+template <typename... Args> void logDeferred(int level, const char* format, const Args&... args)
+{
+   if(level > Log.getLevel())
+   {
+      return;
+   } // if
+   int8_t channel = deferredLogChannel();
+   if(channel >= 0)
+   {
+      dlogChannels.get(channel).log(micros(), level, format, args...);
+      return;
+   } // if
+   switch(level) // More tasks than channels. Log the slow way rather than lose the line.
+   {
+      case LOG_LEVEL_FATAL: Log.fatalln(format, args...); break;
+      case LOG_LEVEL_ERROR: Log.errorln(format, args...); break;
+      case LOG_LEVEL_WARNING: Log.warningln(format, args...); break;
+      case LOG_LEVEL_NOTICE: Log.noticeln(format, args...); break;
+      case LOG_LEVEL_TRACE: Log.traceln(format, args...); break;
+      default: Log.verboseln(format, args...); break;
+   } // switch
+} // logDeferred()
+
+/**
+ * @brief Record a Printable argument, such as an IPAddress passed to %p, as text.
+ * @param rec Record.
+ * @param value Object that prints itself.
+ * ==========================================================================*/
+void dlogAdd(dlogRecord &rec, const Printable &value)
+{
+   class textPrint : public Print
+   {
+      public:
+         size_t write(uint8_t c) override
+         {
+            if(len < sizeof(text) - 1)
+            {
+               text[len++] = c;
+               text[len] = '\0';
+            } // if
+            return 1;
+         } // write()
+         char text[DLOG_TEXT_LEN] = "";
+         size_t len = 0;
+   }; // class
+   textPrint out;
+   value.printTo(out);
+   dlogAddText(rec, out.text);
+} // dlogAdd()
+
+/**
+ * @brief Send one record out, as text or as binary frames.
+ * @param out Where the log goes.
+ * @param rec Record.
+ * ==========================================================================*/
+void drainDeferredRecord(Print* out, const dlogRecord &rec)
+{
+   if(dlogBinary == false)
+   {
+      char line[DLOG_LINE_LEN];
+      dlogFormat(rec, true, line, sizeof(line));
+      out->println(line);
+      return;
+   } // if
+   uint8_t frame[DLOG_FRAME_MAX];
+   bool sent = false;
+   for(uint8_t f = 0; f < dlogSentCount && sent == false; f++)
+   {
+      sent = (dlogSent[f] == rec.format);
+   } // for
+   if(sent == false)
+   {
+      if(dlogSentCount == DLOG_SENT_FORMATS) // Forget them all. The decoder copes with repeats.
+      {
+         dlogSentCount = 0;
+      } // if
+      dlogSent[dlogSentCount++] = rec.format;
+      out->write(frame, dlogEncodeFormat(dlogFormatId(rec.format), rec.format, frame, sizeof(frame)));
+   } // if
+   out->write(frame, dlogEncodeRecord(rec, frame, sizeof(frame)));
+} // drainDeferredRecord()
+
+/**
+ * @brief Drain task. Empties every channel, then reports any new drops.
+ * @param parameter Where the log goes. The Print given to Log.begin().
+ * ==========================================================================*/
+void deferredLogTask(void* parameter)
+{
+   Print* out = (Print*)parameter;
+   dlogRecord rec;
+   for(;;)
+   {
+      bool busy = false;
+      uint32_t dropped = 0;
+      for(uint8_t c = 0; c < DLOG_CHANNELS; c++)
+      {
+         while(dlogChannels.get(c).take(&rec) == true)
+         {
+            drainDeferredRecord(out, rec);
+            busy = true;
+         } // while
+         dropped += dlogChannels.get(c).getDropped();
+      } // for
+      if(dropped != dlogReportedDrops)
+      {
+         dlogReportedDrops = dropped;
+         if(dlogBinary == true)
+         {
+            uint8_t frame[DLOG_FRAME_MAX];
+            out->write(frame, dlogEncodeDropped(dropped, frame, sizeof(frame)));
+         } // if
+         else
+         {
+            out->printf("<deferredLogTask> %lu log records dropped so far.\r\n", (unsigned long)dropped);
+         } // else
+      } // if
+      if(busy == false)
+      {
+         vTaskDelay(pdMS_TO_TICKS(DLOG_IDLE_MS));
+      } // if
+   } // for
+} // deferredLogTask()
+
+/**
+ * @brief Drain the deferred log as binary frames, or go back to text.
+ * @param binary true for binary frames.
+ * ==========================================================================*/
+void setDeferredLogBinary(bool binary)
+{
+   dlogSentCount = 0; // Decoder may have missed earlier format frames. Send them again.
+   dlogBinary = binary;
+} // setDeferredLogBinary()
+
+/**
+ * @brief Start the task that drains the deferred log. Call straight after Log.begin().
+ * @param out Where the log goes. The Print given to Log.begin().
+ * @return true if the task was created.
+ * ==========================================================================*/
+bool startDeferredLog(Print* out)
+{
+   BaseType_t created = xTaskCreatePinnedToCore(deferredLogTask, "dlog", DLOG_STACK, out, DLOG_PRIORITY, &dlogTaskHandle, DLOG_CORE);
+   if(created != pdPASS)
+   {
+      Log.errorln("<startDeferredLog> Could not create deferred log task.");
+      return false;
+   } // if
+   LOG_TRACELN(LOG_MOD_MAIN, "<startDeferredLog> Deferred log drained on core %d.", DLOG_CORE);
+   return true;
+} // startDeferredLog()
+#else
+bool startDeferredLog(Print*) { return true; } // startDeferredLog() Nothing to start. Log prints as it is called.
+void releaseDeferredLogChannel() {} // releaseDeferredLogChannel() No channels.
+#endif
+
+#endif // End of precompiler protected code block
@@ -3,27 +3,35 @@
 #define i2c_h // Precompiler macro used for precompiler check.
 
 #include <main.h> // Header file for all libraries needed by this program.
+#include <amWireBus.h> // Register level access to Wire and Wire1.
+#include <amI2cQueue.h> // Prioritised transaction queue and worker task per bus.
+#include <amI2cRegistry.h> // Devices expected on each bus.
 
 /**
- * @brief Monitor local web service to see if there are any client requests.
- * @details Call to checkForClientRequest() does two things. First, it causes the 
- * localWebServer service to process any new binay downloads. Second, it returns a 
- * boolean, that when TRUE, indicates there is a new IP address for the MQTT broker 
- * that needs to be saved to NV RAM.
+ * @brief I2C buses, the devices expected on them and the queues every transaction goes through.
+ * @details Each bus has a worker task that runs its transactions one at a time, balance loop
+ * first, then everything else, then the LCD, then diagnostics. Drivers reach a bus through an
+ * amI2cPort at their priority, one port per task. At boot only the addresses in i2cDevices are
+ * probed. Build with -D I2C_FULL_SCAN, or send the I2CSCAN command, to sweep every address.
+ * Every transaction is counted against its address: bytes, NACKs, timeouts, errors and bus time.
+ * Below the queues amWireBus bounds every wait, retries failed transfers and clocks free a bus a
+ * device is holding. Its counts are reported alongside.
+ * The counts go out on the i2c telemetry topic, to the log with the I2C command and to the
+ * status web page.
  * =================================================================================*/
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-/// @brief Define I2C bus0 - wire() - constants, classes and global variables 
+/// @brief Define I2C bus0 - wire() - constants, classes and global variables
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #define I2C_BUS0_SPEED 100000 // Define speed of I2C bus 2. Note 400KHz is the upper speed limit for MD25 I2C
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-/// @brief Define I2C bus1 - wire1() - constants, classes and global variables 
+/// @brief Define I2C bus1 - wire1() - constants, classes and global variables
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #define I2C_BUS1_SPEED 400000 // Define speed of I2C bus 2. Note 100KHz is the upper speed limit for ESP32 I2C
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-/// @brief Define I2C device addresses 
+/// @brief Define I2C device addresses
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #define MPU6050_I2C_ADD 0x68 // GY521 I2C address.
 #define leftOLED_I2C_ADD 0x3D // OLED used for robot's left eye I2C adddress.
@@ -39,100 +47,280 @@
 #define PCA9685ServoDriver6 0x45 // I2C address for sixth servo driver.
 #define PCA9685ServoDriver7 0x46 // I2C address for seventh servo driver.
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// @brief Transaction queues and the devices expected on each bus
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+const uint32_t I2C_WORKER_STACK = 4096; // Bytes of stack for each bus worker. LCD calls run on it.
+const uint8_t I2C_WORKER_PRIORITY = configMAX_PRIORITIES - 2; // Just below the balance loop so a ready transaction goes straight on the bus.
+const int8_t I2C_WORKER_CORE = 1; // Application core, with the balance loop.
+const uint32_t I2C_CONTROL_TIMEOUT_US = 2000; // Balance loop gives up on a transaction that cannot get the bus this quickly.
+amWireBus wire0Bus(Wire); // Bus0 as an amI2cBus. Only its worker touches it.
+amWireBus wire1Bus(Wire1); // Bus1 as an amI2cBus. Only its worker touches it.
+amI2cQueue i2cBus0(wire0Bus, "i2c0"); // Every bus0 transaction.
+amI2cQueue i2cBus1(wire1Bus, "i2c1"); // Every bus1 transaction.
+amI2cPort i2cScanPort0(i2cBus0, I2C_PRIO_DIAG); // Probes and sweeps of bus0.
+amI2cPort i2cScanPort1(i2cBus1, I2C_PRIO_DIAG); // Probes and sweeps of bus1.
+amI2cRegistry i2cDevices; // Every device the robot knows about.
+amI2cDevice md25Device(I2C_DEV_MD25, 0, md25I2cAddress, "MD25 motor controller");
+amI2cDevice lcdDevice(I2C_DEV_LCD, 0, LCD16x2, "16x2 LCD screen");
+amI2cDevice imuDevice(I2C_DEV_MPU6050, 1, MPU6050_I2C_ADD, "MPU6050");
+amI2cDevice leftOledDevice(I2C_DEV_OLED, 0, leftOLED_I2C_ADD, "Left OLED");
+amI2cDevice rightOledDevice(I2C_DEV_OLED, 0, rightOLED_I2C_ADD, "Right OLED");
+amI2cDevice servoAllDevice(I2C_DEV_PCA9685, 0, PCA9685ServoDriverAllCall, "PCA9685 servo driver ALL CALL");
+amI2cDevice servoDevice[] = // PCA9685 16-channel 12-bit servo motor drivers.
+{
+   amI2cDevice(I2C_DEV_PCA9685, 0, PCA9685ServoDriver1, "PCA9685 servo driver 1"),
+   amI2cDevice(I2C_DEV_PCA9685, 0, PCA9685ServoDriver2, "PCA9685 servo driver 2"),
+   amI2cDevice(I2C_DEV_PCA9685, 0, PCA9685ServoDriver3, "PCA9685 servo driver 3"),
+   amI2cDevice(I2C_DEV_PCA9685, 0, PCA9685ServoDriver4, "PCA9685 servo driver 4"),
+   amI2cDevice(I2C_DEV_PCA9685, 0, PCA9685ServoDriver5, "PCA9685 servo driver 5"),
+   amI2cDevice(I2C_DEV_PCA9685, 0, PCA9685ServoDriver6, "PCA9685 servo driver 6"),
+   amI2cDevice(I2C_DEV_PCA9685, 0, PCA9685ServoDriver7, "PCA9685 servo driver 7"),
+}; // servoDevice
+
+/*************************************************************************************************************************************
+ * @brief Register the expected devices and start a worker task for each bus.
+ * @details Call once Wire and Wire1 have been started.
+ *************************************************************************************************************************************/
+void initI2c()
+{
+   i2cDevices.add(&md25Device);
+   i2cDevices.add(&lcdDevice);
+   i2cDevices.add(&imuDevice);
+   i2cDevices.add(&leftOledDevice);
+   i2cDevices.add(&rightOledDevice);
+   i2cDevices.add(&servoAllDevice);
+   for(uint8_t i = 0; i < sizeof(servoDevice) / sizeof(servoDevice[0]); i++)
+   {
+      i2cDevices.add(&servoDevice[i]);
+   } // for
+   if(i2cBus0.start(I2C_WORKER_STACK, I2C_WORKER_PRIORITY, I2C_WORKER_CORE) == false ||
+      i2cBus1.start(I2C_WORKER_STACK, I2C_WORKER_PRIORITY, I2C_WORKER_CORE) == false)
+   {
+      LOG_ERRORLN(LOG_MOD_I2C, "<initI2c> Could not start an I2C worker task. That bus runs on its callers.");
+   } // if
+   i2cBus0.resetStats(micros());
+   i2cBus1.resetStats(micros());
+} // initI2c()
+
+/*************************************************************************************************************************************
+ * @brief Log an address that answered a sweep.
+ * @param bus Bus number.
+ * @param address 7 bit I2C address.
+ * @param device Registered device at that address, or nullptr.
+ *************************************************************************************************************************************/
+void identifyDevice(uint8_t bus, uint8_t address, amI2cDevice* device, void*)
+{
+   if(device == nullptr)
+   {
+      LOG_NOTICELN(LOG_MOD_I2C, "<identifyDevice> Bus %d device with I2C address %d (%X) identified as UNKNOWN", bus, address, address);
+      return;
+   } // if
+   LOG_NOTICELN(LOG_MOD_I2C, "<identifyDevice> Bus %d device with I2C address %d (%X) identified as %s", bus, address, address, device->getName());
+} // identifyDevice()
+
 /*************************************************************************************************************************************
- * @brief Identify a device based on its I2C address
- * @param deviceAddress I2C address of the device to be identified
+ * @brief Probe every address on a bus and name what answers. For diagnostics.
+ * @param bus 0 for Wire, 1 for Wire1.
+ * @return Number of addresses that answered.
  *************************************************************************************************************************************/
-void identifyDevice(int deviceAddress)
+uint8_t sweepBus(uint8_t bus)
 {
-  switch (deviceAddress) 
-  {
-    case rightOLED_I2C_ADD:    
-      Log.noticeln("<identifyDevice> Device with I2C address %d (%X) identified as Right OLED", deviceAddress, deviceAddress);
-      break;
-    case leftOLED_I2C_ADD:    
-      Log.noticeln("<identifyDevice> Device with I2C address %d (%X) identified as Left OLED", deviceAddress, deviceAddress);
-      break;
-    case md25I2cAddress:    
-      motorControllerConnected = true;
-      Log.noticeln("<identifyDevice> Device with I2C address %d (%X) identified as MD25 motor controller", deviceAddress, deviceAddress);
-      break;
-    case MPU6050_I2C_ADD:
-      Log.noticeln("<identifyDevice> Device with I2C address %d (%X) identified as MPU6050", deviceAddress, deviceAddress);
-      break;
-    case LCD16x2:
-      lcdConnected = true;
-      Log.noticeln("<identifyDevice> Device with I2C address %d (%X) identified as 16x2 LCD screen", deviceAddress, deviceAddress);
-      break;
-    case PCA9685ServoDriverAllCall:
-      Log.noticeln("<identifyDevice> Device with I2C address %d (%X) identified as PCA9685 16-channel 12-bit servo motor driver ALL CALL", deviceAddress, deviceAddress);
-      break;
-    case PCA9685ServoDriver1:
-      Log.noticeln("<identifyDevice> Device with I2C address %d (%X) identified as PCA9685 16-channel 12-bit servo motor driver 1", deviceAddress, deviceAddress);
-      break;
-    case PCA9685ServoDriver2:
-      Log.noticeln("<identifyDevice> Device with I2C address %d (%X) identified as PCA9685 16-channel 12-bit servo motor driver 2", deviceAddress, deviceAddress);
-      break;
-    case PCA9685ServoDriver3:
-      Log.noticeln("<identifyDevice> Device with I2C address %d (%X) identified as PCA9685 16-channel 12-bit servo motor driver 3", deviceAddress, deviceAddress);
-      break;
-    case PCA9685ServoDriver4:
-      Log.noticeln("<identifyDevice> Device with I2C address %d (%X) identified as PCA9685 16-channel 12-bit servo motor driver 4", deviceAddress, deviceAddress);
-      break;
-    case PCA9685ServoDriver5:
-      Log.noticeln("<identifyDevice> Device with I2C address %d (%X) identified as PCA9685 16-channel 12-bit servo motor driver 5", deviceAddress, deviceAddress);
-      break;
-    case PCA9685ServoDriver6:
-      Log.noticeln("<identifyDevice> Device with I2C address %d (%X) identified as PCA9685 16-channel 12-bit servo motor driver 6", deviceAddress, deviceAddress);
-      break;
-    case PCA9685ServoDriver7:
-      Log.noticeln("<identifyDevice> Device with I2C address %d (%X) identified as PCA9685 16-channel 12-bit servo motor driver 7", deviceAddress, deviceAddress);
-      break;
-    default: 
-      Log.noticeln("<identifyDevice> Device with I2C address %d (%X) Identified as UKNOWN");
-      break;
-  } //switch
-} //identifyDevice()
+   LOG_NOTICELN(LOG_MOD_I2C, "<sweepBus> Sweep I2C bus %d looking for devices...", bus);
+   uint8_t count = i2cDevices.sweep(bus, (bus == 0) ? i2cScanPort0 : i2cScanPort1, identifyDevice, nullptr);
+   LOG_NOTICELN(LOG_MOD_I2C, "<sweepBus> Done. Found %d device(s) on bus %d.", count, bus);
+   return count;
+} // sweepBus()
 
 /*************************************************************************************************************************************
- * @brief Scan I2C bus0 aka wire()
+ * @brief Probe the devices expected on a bus, and only those.
+ * @details Built with I2C_FULL_SCAN, sweeps the whole bus instead.
+ * @param bus 0 for Wire, 1 for Wire1.
+ * @return Number of expected devices that answered.
  *************************************************************************************************************************************/
-void scanBus0()
+uint8_t probeBus(uint8_t bus)
 {
-   Log.noticeln("<scanBus0> Scan I2C bus 0 looking for devices...");
-   byte count = 0;
-   for (byte i = 8; i < 120; i++)
-   { 
-      Wire.beginTransmission (i);
-      if (Wire.endTransmission () == 0)
+#ifdef I2C_FULL_SCAN
+   sweepBus(bus);
+#else
+   i2cDevices.probe(bus, (bus == 0) ? i2cScanPort0 : i2cScanPort1);
+#endif
+   uint8_t count = 0;
+   for(uint8_t i = 0; i < i2cDevices.getCount(); i++)
+   {
+      amI2cDevice* device = i2cDevices.getDevice(i);
+      if(device->getBus() != bus)
+      {
+         continue;
+      } // if
+      if(device->isPresent())
       {
-         Log.noticeln("<scanBus0> Found address: %d (%X).", i, i);
          count++;
-         identifyDevice(i); // Identify what device has been found 
-         delay(1);
+         LOG_NOTICELN(LOG_MOD_I2C, "<probeBus> Bus %d found %s at %X.", bus, device->getName(), device->getAddress());
       } // if
+      else
+      {
+         LOG_VERBOSELN(LOG_MOD_I2C, "<probeBus> Bus %d no %s at %X. I2C status = %d", bus, device->getName(), device->getAddress(), device->getStatus());
+      } // else
+   } // for
+   LOG_NOTICELN(LOG_MOD_I2C, "<probeBus> Done. Found %d expected device(s) on bus %d.", count, bus);
+   return count;
+} // probeBus()
+
+amI2cQueue* i2cQueues[] = {&i2cBus0, &i2cBus1}; // Queue of each bus, by bus number.
+amWireBus* i2cWires[] = {&wire0Bus, &wire1Bus}; // TwoWire of each bus, by bus number.
+
+/*************************************************************************************************************************************
+ * @brief Name of the device at an address, for reports.
+ * @param bus Bus number.
+ * @param address 7 bit I2C address, or I2C_METER_OTHER.
+ * @return Name.
+ *************************************************************************************************************************************/
+const char* i2cDeviceName(uint8_t bus, uint8_t address)
+{
+   if(address == I2C_METER_OTHER)
+   {
+      return "Other addresses";
+   } // if
+   amI2cDevice* device = i2cDevices.find(bus, address);
+   return (device == nullptr) ? "Unknown" : device->getName();
+} // i2cDeviceName()
+
+/*************************************************************************************************************************************
+ * @brief Share of a bus's time since its statistics were reset that one address used.
+ * @param bus Bus number.
+ * @param s Counts of the address.
+ * @return Tenths of a percent.
+ *************************************************************************************************************************************/
+uint16_t i2cShare(uint8_t bus, amI2cAddressStats* s)
+{
+   uint32_t elapsed = micros() - i2cQueues[bus]->getSinceUs();
+   return (elapsed == 0) ? 0 : (uint16_t)((uint64_t)s->busyUs * 1000 / elapsed);
+} // i2cShare()
+
+/*************************************************************************************************************************************
+ * @brief Send a telemetry sample for each address seen on each bus.
+ * @param stream Telemetry stream the samples go to.
+ * @param nowMs millis().
+ *************************************************************************************************************************************/
+void i2cTelemetry(int8_t stream, uint32_t nowMs)
+{
+   for(uint8_t b = 0; b < 2; b++)
+   {
+      amI2cMeter &meter = i2cQueues[b]->getMeter();
+      for(uint8_t i = 0; i < meter.getCount(); i++)
+      {
+         amI2cAddressStats* s = meter.getStats(i);
+         tlmI2c sample;
+         sample.bus = b;
+         sample.address = s->address;
+         sample.transactions = s->transactions;
+         sample.bytes = s->bytes;
+         sample.nacks = s->nacks;
+         sample.timeouts = s->timeouts;
+         sample.errors = s->errors;
+         sample.busyUs = s->busyUs;
+         sample.maxUs = s->time.getMaxUs();
+         for(uint8_t k = 0; k < TLM_I2C_BUCKETS; k++)
+         {
+            sample.buckets[k] = s->time.getBucket(k); // 0 past the last bucket of the histogram.
+         } // for
+         uint8_t wire[TLM_I2C_LEN];
+         tlmEncodeI2c(sample, wire);
+         telemetry.sample(stream, nowMs, wire, TLM_I2C_LEN);
+      } // for
    } // for
-   Log.noticeln("<scanBus0> Done. Found %d device(s).", count);
-} //scanBus0()
+} // i2cTelemetry()
 
 /*************************************************************************************************************************************
- * @brief Scan I2C bus1 aka wire1()
+ * @brief Body of the status web page: how much of each bus each address uses.
+ * @param page Where to add the text.
  *************************************************************************************************************************************/
-void scanBus1()
+void i2cStatusPage(String &page)
 {
-   Log.noticeln("<scanBus1> Scan I2C bus 1 looking for devices...");
-   byte count = 0;
-   for (byte i = 8; i < 120; i++)
-   { 
-      Wire1.beginTransmission (i);
-      if (Wire1.endTransmission () == 0)
+   char line[160];
+   for(uint8_t b = 0; b < 2; b++)
+   {
+      amI2cQueue &q = *i2cQueues[b];
+      uint16_t permille = q.getUtilization(micros());
+      snprintf(line, sizeof(line), "I2C bus %u at %lu kHz: busy %u.%u%% over %lu s, most queued %u.\n", (unsigned)b,
+               (unsigned long)(((b == 0) ? I2C_BUS0_SPEED : I2C_BUS1_SPEED) / 1000), (unsigned)(permille / 10), (unsigned)(permille % 10),
+               (unsigned long)((micros() - q.getSinceUs()) / 1000000), (unsigned)q.getMaxQueued());
+      page += line;
+      amWireBus &w = *i2cWires[b];
+      snprintf(line, sizeof(line), "Wire: %lu timeouts, %lu retries, %lu recoveries, %lu stuck, %lu given up.\n", (unsigned long)w.getTimeouts(),
+               (unsigned long)w.getRetries(), (unsigned long)w.getRecoveries(), (unsigned long)w.getStuck(), (unsigned long)w.getFailures());
+      page += line;
+      page += "Addr Device                    Trans      Bytes   NACK    Tmo    Err  Bus ms  Share  p50 us  p99 us  max us\n";
+      amI2cMeter &meter = q.getMeter();
+      for(uint8_t i = 0; i < meter.getCount(); i++)
       {
-         Log.noticeln("<scanBus1> Found address: %d (%X).", i, i);
-         count++;
-         identifyDevice(i); // Identify what device has been found 
-         delay(1);
-      } // if
+         amI2cAddressStats* s = meter.getStats(i);
+         uint16_t share = i2cShare(b, s);
+         snprintf(line, sizeof(line), "0x%02X %-24.24s %7lu %10lu %6lu %6lu %6lu %7lu %3u.%u%% %7lu %7lu %7lu\n", (unsigned)s->address,
+                  i2cDeviceName(b, s->address), (unsigned long)s->transactions, (unsigned long)s->bytes, (unsigned long)s->nacks,
+                  (unsigned long)s->timeouts, (unsigned long)s->errors, (unsigned long)(s->busyUs / 1000), (unsigned)(share / 10),
+                  (unsigned)(share % 10), (unsigned long)s->time.getPercentileUs(50), (unsigned long)s->time.getPercentileUs(99),
+                  (unsigned long)s->time.getMaxUs());
+         page += line;
+         page += "     Bus time:";
+         for(uint8_t k = 0; k < HIST_BUCKETS; k++)
+         {
+            if(s->time.getBucket(k) == 0)
+            {
+               continue;
+            } // if
+            if(k == HIST_BUCKETS - 1)
+            {
+               snprintf(line, sizeof(line), " %lu from %lu us", (unsigned long)s->time.getBucket(k), (unsigned long)(amLogHistogram::bucketTopUs(k - 1) + 1));
+            } // if
+            else
+            {
+               snprintf(line, sizeof(line), " %lu under %lu us", (unsigned long)s->time.getBucket(k), (unsigned long)(amLogHistogram::bucketTopUs(k) + 1));
+            } // else
+            page += line;
+         } // for
+         page += "\n";
+      } // for
+      page += "\n";
+   } // for
+} // i2cStatusPage()
+
+/*************************************************************************************************************************************
+ * @brief Log how busy each bus has been, how long its transactions waited, by priority, and what
+ * each address cost it.
+ *************************************************************************************************************************************/
+void showI2cStats()
+{
+   static const char* PRIORITY[] = {"control", "normal", "display", "diag"};
+   for(uint8_t b = 0; b < 2; b++)
+   {
+      amI2cQueue &q = *i2cQueues[b];
+      uint16_t permille = q.getUtilization(micros());
+      LOG_NOTICELN(LOG_MOD_I2C, "<showI2cStats> Bus %d busy %d.%d%%, most queued %d, taken back %l.", b, permille / 10, permille % 10, q.getMaxQueued(), (long)q.getCancelled());
+      amWireBus &w = *i2cWires[b];
+      LOG_NOTICELN(LOG_MOD_I2C, "<showI2cStats> Bus %d wire: %l timeouts, %l retries, %l recoveries, %l stuck, %l given up.", b, (long)w.getTimeouts(),
+                   (long)w.getRetries(), (long)w.getRecoveries(), (long)w.getStuck(), (long)w.getFailures());
+      for(uint8_t p = 0; p < I2C_PRIORITIES; p++)
+      {
+         amLogHistogram &latency = q.getLatency(p);
+         if(latency.getCount() == 0)
+         {
+            continue;
+         } // if
+         LOG_NOTICELN(LOG_MOD_I2C, "<showI2cStats> Bus %d %s: %l done, %l errors, %l timeouts. Latency p50 %l us, p99 %l us, max %l us.", b, PRIORITY[p],
+                      (long)q.getDone(p), (long)q.getErrors(p), (long)q.getTimeouts(p), (long)latency.getPercentileUs(50), (long)latency.getPercentileUs(99), (long)latency.getMaxUs());
+      } // for
+      amI2cMeter &meter = q.getMeter();
+      for(uint8_t i = 0; i < meter.getCount(); i++)
+      {
+         amI2cAddressStats* s = meter.getStats(i);
+         uint16_t share = i2cShare(b, s);
+         LOG_NOTICELN(LOG_MOD_I2C, "<showI2cStats> Bus %d %X %s: %l transactions, %l bytes, %l NACKs, %l timeouts, %l errors.", b, s->address,
+                      i2cDeviceName(b, s->address), (long)s->transactions, (long)s->bytes, (long)s->nacks, (long)s->timeouts, (long)s->errors);
+         LOG_NOTICELN(LOG_MOD_I2C, "<showI2cStats> Bus %d %X: %l us on the bus, %d.%d%% of it. p50 %l us, p99 %l us, max %l us.", b, s->address,
+                      (long)s->busyUs, share / 10, share % 10, (long)s->time.getPercentileUs(50), (long)s->time.getPercentileUs(99), (long)s->time.getMaxUs());
+      } // for
    } // for
-   Log.noticeln("<scanBus0> Done. Found %d device(s).", count);
-} //scanBus1()
-#endif // End of precompiler protected code block
\ No newline at end of file
+} // showI2cStats()
+#endif // End of precompiler protected code block
@@ -0,0 +1,72 @@
+#ifndef imu_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define imu_h // Precompiler macro used for precompiler check.
+
+#include <main.h> // Header file for all libraries needed by this program.
+#include <amMPU6050.h> // MPU6050 FIFO driver.
+
+const uint8_t IMU_DLPF = MPU6050_DLPF_44HZ; // Filter bandwidth. Gyro output rate is 1kHz with the filter on.
+const uint8_t IMU_SAMPLE_RATE_DIV = 0; // 1kHz / (1 + 0) = 1kHz sample rate.
+const uint8_t IMU_GYRO_RANGE = MPU6050_GYRO_500DPS; // Plenty for a falling robot.
+const uint8_t IMU_ACCEL_RANGE = MPU6050_ACCEL_4G; // Room for bumps without clipping.
+const float IMU_SAMPLE_PERIOD = (1 + IMU_SAMPLE_RATE_DIV) / 1000.0; // Seconds between samples.
+const float IMU_GYRO_LSB_PER_DPS = 65.5; // Gyro scale for IMU_GYRO_RANGE.
+const uint16_t IMU_MAX_SAMPLES = 32; // Most samples collected per call to collectImuSamples().
+
+amI2cPort imuPort(i2cBus1, I2C_PRIO_CONTROL, I2C_CONTROL_TIMEOUT_US); // MPU6050 is on I2C bus1 (400KHz). Used by the boot, then the balance task.
+amMPU6050 imu(imuPort, MPU6050_I2C_ADD); // Accelerometer and gyro.
+mpu6050Sample imuSamples[IMU_MAX_SAMPLES]; // Samples from the last collectImuSamples(), oldest first.
+uint16_t imuSampleCount = 0; // Number of samples in imuSamples.
+bool imuStatus = false; // True once the MPU6050 is set up and filling its FIFO.
+volatile uint32_t imuDataReadyCount = 0; // Data ready interrupts seen.
+uint32_t imuServicedCount = 0; // Value of imuDataReadyCount when the FIFO was last drained.
+
+/**
+ * @brief Data ready interrupt from the MPU6050. A new sample is in the FIFO.
+ * ==========================================================================*/
+void IRAM_ATTR imuDataReadyISR()
+{
+   imuDataReadyCount++;
+} // imuDataReadyISR()
+
+/**
+ * @brief Collect any new samples from the MPU6050 FIFO into imuSamples.
+ * @details Does nothing, and uses no bus time, unless a data ready interrupt has arrived since the
+ * last call. Otherwise drains the FIFO in bursts so every sample is seen no matter how the balance
+ * loop rate compares with the sample rate.
+ * @return Number of samples collected.
+ * ==========================================================================*/
+uint16_t collectImuSamples()
+{
+   imuSampleCount = 0;
+   uint32_t seen = imuDataReadyCount;
+   if(imuStatus == false || seen == imuServicedCount) // Nothing new.
+   {
+      return 0;
+   } // if
+   imuServicedCount = seen;
+   imu.drainFifo(imuSamples, IMU_MAX_SAMPLES, &imuSampleCount); // Overflows are counted by the driver.
+   return imuSampleCount;
+} // collectImuSamples()
+
+/**
+ * @brief Set up the MPU6050 FIFO and its data ready interrupt.
+ * @return true if the MPU6050 is running.
+ * ==========================================================================*/
+bool initImu()
+{
+   LOG_TRACELN(LOG_MOD_IMU, "<initImu> Initialize the MPU6050.");
+   uint8_t status = imu.begin(IMU_DLPF, IMU_SAMPLE_RATE_DIV, IMU_GYRO_RANGE, IMU_ACCEL_RANGE);
+   if(status != I2C_OK)
+   {
+      LOG_ERRORLN(LOG_MOD_IMU, "<initImu> MPU6050 set up failed. Status = %d", status);
+      return false;
+   } // if
+   pinMode(imuInterruptPin, INPUT); // Chip drives the pin push-pull.
+   attachInterrupt(digitalPinToInterrupt(imuInterruptPin), imuDataReadyISR, RISING);
+   LOG_VERBOSELN(LOG_MOD_IMU, "<initImu> MPU6050 filling FIFO at %d Hz.", 1000 / (1 + IMU_SAMPLE_RATE_DIV));
+   imuStatus = true;
+   return true;
+} // initImu()
+
+#endif // End of precompiler protected code block
@@ -6,6 +6,41 @@
 const uint8_t lCD_COLUMNS = 16; // Number of characters that fint on one row of LCD.
 const uint8_t lCD_ROWS = 2; // Number of rows on the LCD unit used for this robot. 
 LiquidCrystal_I2C lcd(LCD16x2, lCD_COLUMNS, lCD_ROWS); // Define LCD object.
+amI2cPort lcdPort(i2cBus0, I2C_PRIO_DISPLAY); // LiquidCrystal_I2C talks to Wire directly, so it runs as calls on the bus0 worker.
+
+/*! Text to put on the LCD, handed to lcdWriteCall(). */
+struct lcdText
+{
+   const char* msg; ///< Text.
+   uint8_t column; ///< Column of the first character.
+   uint8_t row; ///< Row.
+}; // struct
+
+/**
+ * @brief Bus0 worker call. Writes text at a position.
+ * @param arg The lcdText.
+ * @return I2C_OK.
+ * ==========================================================================*/
+uint8_t lcdWriteCall(void* arg)
+{
+   lcdText* text = (lcdText*)arg;
+   lcd.setCursor(text->column, text->row);
+   lcd.print(text->msg);
+   return I2C_OK;
+} // lcdWriteCall()
+
+/**
+ * @brief Bus0 worker call. Starts the LCD and turns its backlight on.
+ * @details Holds bus0 for over a second. Only used at boot, before anything
+ * else needs bus0.
+ * @return I2C_OK.
+ * ==========================================================================*/
+uint8_t lcdInitCall(void*)
+{
+   lcd.init(I2C_BUS0_SDA, I2C_BUS0_SCL); // initialize the lcd 
+   lcd.setBacklight(true);
+   return I2C_OK;
+} // lcdInitCall()
 
 /**
  * @brief Places a text message centrered horizontally.
@@ -19,25 +54,25 @@ void placeTextHcentre(String msg, int8_t row)
    
    if(row == 0 || row == 1)
    {
-      Log.verboseln("<placeTextHcentre> Row specified is valid.");
+      LOG_VERBOSELN(LOG_MOD_LCD, "<placeTextHcentre> Row specified is valid.");
    } // if
    else
    {
-      Log.verboseln("<placeTextHcentre> Row specified is not valid. Will write on row 0.");
+      LOG_VERBOSELN(LOG_MOD_LCD, "<placeTextHcentre> Row specified is not valid. Will write on row 0.");
       row = 0;
    } // else
    if(row >= lCD_COLUMNS)
    {
-      Log.verboseln("<placeTextHcentre> Message too long to center. Starting in column 0.");
+      LOG_VERBOSELN(LOG_MOD_LCD, "<placeTextHcentre> Message too long to center. Starting in column 0.");
       column = 0;
    }  // if
    else
    {
       column = (lCD_COLUMNS - msg.length()) / 2; 
-      Log.verboseln("<placeTextHcentre> To centre message <%s> start in column %d.", msg.c_str(), column);
+      LOG_VERBOSELN(LOG_MOD_LCD, "<placeTextHcentre> To centre message <%s> start in column %d.", msg.c_str(), column);
    }  // else
-   lcd.setCursor(column, row);
-   lcd.print(msg);
+   lcdText text = {msg.c_str(), (uint8_t)column, (uint8_t)row};
+   lcdPort.call(LCD16x2, lcdWriteCall, &text); // Waits for the worker.
 } // placeTextHcentre()
 
 /**
@@ -47,7 +82,7 @@ void displaySplashScreen()
 {
    int8_t row0 = 0; // First row of LCD.
    int8_t row1 = 1; // Second row of LCD.
-   Log.traceln("<displaySplashScreen> Display splash screen on LCD.");
+   LOG_TRACELN(LOG_MOD_LCD, "<displaySplashScreen> Display splash screen on LCD.");
    String robotIP = "R:" + WiFi.localIP().toString(); 
    String mqttBrokerIP = "B:" + getMqttBrokerIP().toString();
    placeTextHcentre(robotIP, row0);
@@ -59,9 +94,8 @@ void displaySplashScreen()
  * ==========================================================================*/
 void initLcd() 
 {
-   Log.traceln("<initLcd> Initialize 2x16 LCD.");
-   lcd.init(I2C_BUS0_SDA, I2C_BUS0_SCL); // initialize the lcd 
-   lcd.setBacklight(true);
+   LOG_TRACELN(LOG_MOD_LCD, "<initLcd> Initialize 2x16 LCD.");
+   lcdPort.call(LCD16x2, lcdInitCall, nullptr);
    displaySplashScreen();
 } // initLed()
 
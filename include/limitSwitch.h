@@ -18,7 +18,7 @@ int8_t memSwitch = 0; // Track what the switch was set to when last checked.
  * ==========================================================================*/
 void setupLimitSwitches()
 {
-   Log.traceln("<setupLimitSwitches> Set weak pullup resistor for GPIO pin %d (forward limit switch) and %d (backward limit switch).", frontLimitSwitch, backLimitSwitch);
+   LOG_TRACELN(LOG_MOD_LIMIT, "<setupLimitSwitches> Set weak pullup resistor for GPIO pin %d (forward limit switch) and %d (backward limit switch).", frontLimitSwitch, backLimitSwitch);
    pinMode(frontLimitSwitch, INPUT_PULLUP); // Set GPIO pin to input.
    pinMode(backLimitSwitch, INPUT_PULLUP); // Set GPIO pin to input.
 } // setupLimitSwitches()
@@ -32,7 +32,7 @@ void checkLimitSwitches()
    {
       if(memSwitch != FRONT_SWITCH) // Was not pressed during last check?
       {
-         Log.verboseln("<checkLimitSwitches> Front limit switch tripped. memSwitch = %d", memSwitch);
+         LOG_VERBOSELN(LOG_MOD_LIMIT, "<checkLimitSwitches> Front limit switch tripped. memSwitch = %d", memSwitch);
          memSwitch = FRONT_SWITCH;
          saveRgbColour();
          setStdRgbColour(PINK);
@@ -47,7 +47,7 @@ void checkLimitSwitches()
    {
       if(memSwitch != BACK_SWITCH) // Was not pressed during last check?
       {
-         Log.verboseln("<checkLimitSwitches> Back limit switch tripped. memSwitch = %d", memSwitch);
+         LOG_VERBOSELN(LOG_MOD_LIMIT, "<checkLimitSwitches> Back limit switch tripped. memSwitch = %d", memSwitch);
          memSwitch = BACK_SWITCH;
          saveRgbColour();
          setStdRgbColour(AQUA); // Temporarily set RGB LED to indicate robot lean
@@ -60,7 +60,7 @@ void checkLimitSwitches()
    } // if 
    if(memSwitch != NO_SWITCH) // No switched pressed this time nor the last time we checked. 
    {
-      Log.verboseln("<checkLimitSwitches> No limit switch tripped. memSwitch = %d", memSwitch);
+      LOG_VERBOSELN(LOG_MOD_LIMIT, "<checkLimitSwitches> No limit switch tripped. memSwitch = %d", memSwitch);
       memSwitch = NO_SWITCH; // Track the fact that now no bumper switches are pressed.
       loadRgbColour(); // Set RGB LED back to colour it was before the switches tripped.
    } // if
@@ -0,0 +1,94 @@
+#ifndef logLevels_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define logLevels_h // Precompiler macro used for precompiler check.
+
+#include <ArduinoLog.h> // https://github.com/thijse/Arduino-Log.
+
+/**
+ * @brief Compile time log filtering.
+ * @details Log.setLevel() only filters at run time. The call, the evaluation of every argument
+ * (I2C reads, ledcRead() and so on) and the trip through ArduinoLog's printLevel() all still
+ * happen before the level is checked. The LOG_xxxLN() macros below check the level at compile
+ * time instead, so a call below it is dead code and the compiler drops it, arguments and format
+ * string included. A call passes only if its level is at or below both LOG_LEVEL_MIN and the
+ * level of the module it is in. The run time level set by Log.begin() still applies on top.
+ *
+ * Set the floor for the whole build, or one module, from build_flags in platformio.ini. e.g.
+ * -D LOG_LEVEL_MIN=LOG_LEVEL_NOTICE or -D LOG_MOD_BALANCE=LOG_LEVEL_WARNING
+ * ==========================================================================*/
+#ifndef LOG_LEVEL_MIN
+#define LOG_LEVEL_MIN LOG_LEVEL_VERBOSE // Most detailed level compiled into any module.
+#endif
+
+/**
+ * @brief Most detailed level compiled into each module.
+ * ==========================================================================*/
+#ifndef LOG_MOD_MAIN
+#define LOG_MOD_MAIN LOG_LEVEL_VERBOSE // src/main.cpp.
+#endif
+#ifndef LOG_MOD_BOOT
+#define LOG_MOD_BOOT LOG_LEVEL_VERBOSE // bootSequence.h.
+#endif
+#ifndef LOG_MOD_CONFIG
+#define LOG_MOD_CONFIG LOG_LEVEL_VERBOSE // configDetails.h.
+#endif
+#ifndef LOG_MOD_WIFI
+#define LOG_MOD_WIFI LOG_LEVEL_VERBOSE // wifiLink.h.
+#endif
+#ifndef LOG_MOD_WEB
+#define LOG_MOD_WEB LOG_LEVEL_VERBOSE // startWebServer.h and monitorWebServer.h.
+#endif
+#ifndef LOG_MOD_MQTT
+#define LOG_MOD_MQTT LOG_LEVEL_VERBOSE // mqttBroker.h.
+#endif
+#ifndef LOG_MOD_I2C
+#define LOG_MOD_I2C LOG_LEVEL_VERBOSE // i2c.h.
+#endif
+#ifndef LOG_MOD_LCD
+#define LOG_MOD_LCD LOG_LEVEL_VERBOSE // lcd.h.
+#endif
+#ifndef LOG_MOD_LED
+#define LOG_MOD_LED LOG_LEVEL_VERBOSE // statusLED.h.
+#endif
+#ifndef LOG_MOD_LIMIT
+#define LOG_MOD_LIMIT LOG_LEVEL_VERBOSE // limitSwitch.h. Runs every loop().
+#endif
+#ifndef LOG_MOD_MOBILITY
+#define LOG_MOD_MOBILITY LOG_LEVEL_VERBOSE // mobility.h. Runs every loop().
+#endif
+#ifndef LOG_MOD_IMU
+#define LOG_MOD_IMU LOG_LEVEL_VERBOSE // imu.h.
+#endif
+#ifndef LOG_MOD_BALANCE
+#define LOG_MOD_BALANCE LOG_LEVEL_VERBOSE // balance.h.
+#endif
+
+/**
+ * @brief True if a call at this level in this module is compiled in.
+ * @param module One of the LOG_MOD_ levels.
+ * @param level One of the LOG_LEVEL_ values.
+ * ==========================================================================*/
+#define LOG_ENABLED(module, level) ((level) <= LOG_LEVEL_MIN && (level) <= (module))
+
+/**
+ * @brief Log a line if the level is compiled in. Arguments are not evaluated otherwise.
+ * @details Built with -D LOG_DEFERRED the line is queued for the drain task of deferredLog.h
+ * rather than printed by the caller.
+ * @param module One of the LOG_MOD_ levels.
+ * @param level One of the LOG_LEVEL_ values.
+ * @param method Logging method that matches level.
+ * ==========================================================================*/
+#ifdef LOG_DEFERRED
+#define LOG_AT(module, level, method, ...) do { if(LOG_ENABLED(module, level)) { logDeferred(level, __VA_ARGS__); } } while(0)
+#else
+#define LOG_AT(module, level, method, ...) do { if(LOG_ENABLED(module, level)) { Log.method(__VA_ARGS__); } } while(0)
+#endif
+
+#define LOG_FATALLN(module, ...) LOG_AT(module, LOG_LEVEL_FATAL, fatalln, __VA_ARGS__) // Log.fatalln().
+#define LOG_ERRORLN(module, ...) LOG_AT(module, LOG_LEVEL_ERROR, errorln, __VA_ARGS__) // Log.errorln().
+#define LOG_WARNINGLN(module, ...) LOG_AT(module, LOG_LEVEL_WARNING, warningln, __VA_ARGS__) // Log.warningln().
+#define LOG_NOTICELN(module, ...) LOG_AT(module, LOG_LEVEL_NOTICE, noticeln, __VA_ARGS__) // Log.noticeln().
+#define LOG_TRACELN(module, ...) LOG_AT(module, LOG_LEVEL_TRACE, traceln, __VA_ARGS__) // Log.traceln().
+#define LOG_VERBOSELN(module, ...) LOG_AT(module, LOG_LEVEL_VERBOSE, verboseln, __VA_ARGS__) // Log.verboseln().
+
+#endif // End of precompiler protected code block
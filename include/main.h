@@ -18,6 +18,7 @@
 #include <Wire.h> // Required for I2C communication.
 #include <Adafruit_PWMServoDriver.h> // https://github.com/adafruit/Adafruit-PWM-Servo-Driver-Library.
 #include <ArduinoLog.h> // https://github.com/thijse/Arduino-Log.
+#include <logLevels.h> // Compile time log filtering.
 #include <LiquidCrystal_I2C.h> // https://github.com/tonykambo/LiquidCrystal_I2C
 /*******************************************************************************
  * @section codeModules Functions put into files according to function.
@@ -27,31 +28,65 @@
 #include <huzzah32_gpio_pins.h> // Map pins on Adafruit Huzzah32 dev board to friendly names.
 #include <zippy_gpio_pins.h> // Map Hexbot specific pin naming to generic development board pin names. 
 #include <setupSerial.h> // Serial port initialization.
+#include <deferredLog.h> // Log lines formatted by a background task when built with LOG_DEFERRED.
+#include <telemetry.h> // Batched MQTT telemetry.
+#include <i2c.h> // Manage I2C bus0 and bus1.
 #include <configDetails.h> // Show the environment details of this application.
 #include <startWebServer.h> // Start up the web server service. 
 #include <mqttBroker.h> // Establish connect to the the MQTT broker.
 #include <monitorWebServer.h> // Monitor the web server service.
-#include <i2c.h> // Manage I2C bus0 and bus1.
 #include <lcd.h> // Control LCD.
+#include <wifiLink.h> // Bring WiFi up without holding up the boot.
 #include <mobility.h> // Robot drive train. 
 #include <statusLED.h> // Control status LEDs.
 #include <limitSwitch.h> // Limit switches used to detect robot falling over.
 #include <mobility.h> // Motors used to move robot.
+#include <imu.h> // MPU6050 accelerometer and gyro.
+#include <balance.h> // Fixed rate balance control loop.
+#include <bootSequence.h> // Start up phases, run side by side where they can, and their times.
 /************************************************************************************
  * @section mainDeclare Declare functions.
  ************************************************************************************/
 void setupSerial(); // Initialize the serial output.
+bool startDeferredLog(Print* out); // Start the deferred log drain task.
+void releaseDeferredLogChannel(); // Give the running task's deferred log channel back.
 void showCfgDetails(); // Show the environment details of this application.
 void startWebServer(); // Start up the local web server service.
 void monitorWebServer(); // Look after pending web server requests.
-bool connectToMqttBroker(); // Establish connect to the the MQTT broker. 
-void identifyDevice(int deviceAddress);
-void scanBus0(); // ID devices connected to I2C bus0.
-void scanBus1(); //  ID devices connected to I2C bus1.
+void connectToMqttBroker(aaNetwork &network); // Start connecting to the MQTT broker. 
+void wifiProgress(uint8_t state, uint32_t nowMs); // Log each step of bringing WiFi up.
+void checkWifiLink(); // Bring WiFi up and start the network services once it is.
+void checkMqttLink(); // Reconnect to the MQTT broker and send held messages.
+void checkMqtt(); // Run any commands that came in from the broker.
+bool initTelemetry(const char* uniqueName); // Build the telemetry topics.
+void checkTelemetry(); // Send telemetry batches that are due.
+void initI2c(); // Register the expected I2C devices and start the bus workers.
+uint8_t probeBus(uint8_t bus); // Probe the devices expected on an I2C bus.
+uint8_t sweepBus(uint8_t bus); // ID every device connected to an I2C bus.
+void showI2cStats(); // Log I2C bus use and latency.
+void i2cStatusPage(String &page); // I2C bus use for the status web page.
 void initServo(); // Initialize serv motor control.
+bool initMobility(); // Initialize drive motors and start self-test move.
+void checkMobility(); // Advance any drive train move in progress.
+void showMd25Shadow(); // Log the MD25 register writes kept off the bus.
+bool initImu(); // Set up the MPU6050 FIFO and data ready interrupt.
+uint16_t collectImuSamples(); // Drain new MPU6050 samples.
+bool startBalanceLoop(uint16_t hz); // Start the balance task and its timer.
+bool enableBalance(bool enable); // Let the balance loop drive the motors.
+void showBalanceStats(); // Send balance loop timing to the console.
+void showOdometry(); // Log the odometry pose and wheel speeds.
+void resetOdometry(); // Make the current pose the odometry origin.
+bool addPathSegment(const pathSegment &segment); // Queue a segment for the balance loop to drive.
+void stopPath(); // Drop the path the balance loop is driving.
+void showPath(); // Log how far through its path the balance loop is.
+void runBootSequence(); // Run the start up phases.
+void bootWifiUp(); // Add WiFi getting its address to the boot profile.
+void showBootProfile(); // Log the boot profile.
+void checkBootReport(); // Send the boot profile once the broker is there.
 void initOled(); // Set up OLED.
 void checkOledButtons(); // Check oled buttons to see if they have been pressed. 
 void displayLegScreen(); // Display what legs are doing on oled.
+void checkBoot(); // Check to see how the boot up process went.
 void setup(); // Arduino mandatory function #1. Runs once at boot. 
 void loop(); // Arduino mandatory function #2. Runs continually.
 
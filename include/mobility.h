@@ -3,90 +3,64 @@
 #define mobility_h // Precompiler macro used for precompiler check.
 
 #include <main.h> // Header file for all libraries needed by this program.
+#include <amMD25Regs.h> // MD25 register map.
+#include <amMD25Driver.h> // Register level MD25 driver.
+#include <amMotion.h> // Non-blocking motion engine.
 bool mobilityStatus = false;
- 
-// Define MD25 registers 
-#define MD25RegSpeed1 (byte) 0x00 // Motor1 speed (mode 0,1) or both motors speed (mode 2,3)
-                                  // Cast as a byte to stop them being misinterperted as NULL. This is a bug with arduino 1
-#define MD25RegSpeed2 0x01 // Motor2 speed (mode 0,1) or turn (mode 2,3)
-#define MD25RegEncoder1a 0x02 // Byte 1 of encoder 1 
-#define MD25RegEncoder1b 0x03 // Byte 2 of encoder 1
-#define MD25RegEncoder1c 0x04 // Byte 3 of encoder 1
-#define MD25RegEncoder1d 0x05 // Byte 4 of encoder 1
-#define MD25RegEncoder2a 0x06 // Byte 1 of encoder 2
-#define MD25RegEncoder2b 0x07 // Byte 2 of encoder 2
-#define MD25RegEncoder2c 0x08 // Byte 3 of encoder 2
-#define MD25RegEncoder2d 0x09 // Byte 4 of encoder 2
-#define MD25RegBatteryVolts 0x0A // The supply battery voltatage
-#define MD25RegMotorCur1 0x0B // The current through motor 1 (Left)
-#define MD25RegMotorCur2 0x0C // The current through motor 2 (Right)
-#define MD25RegSoftwareRev 0x0D // Software Revision Number
-#define MD25RegMotorAccel 0x0E // Optional Acceleration register
-#define MD25RegMode 0x0F // Used to set the funtion of Speed1 and speed2 registers
-#define MD25RegCmd 0x10 // Used for reset of encoder counts and module address changes  
-
-// Define MD25 commands. Note changing I2C address commands not listed here
-#define MD25CmdResetEncoders 0x20 // Reset the motor encoder counters
-#define MD25CmdAutoSpeedRegOff 0x30 // Disable automatic speed regulation
-#define MD25CmdAutoSpeedRegOn 0x31 // Enable automatic speed regulation
-#define MD25CmdAutoTimeoutOff 0x32 // Disable automatic 2 second timeout of motors when no I2C activity
-#define MD25CmdAutoTimeoutOn 0x33 // Enable automatic 2 second timeout of motors when no I2C activitybool mobilityStatus = false; 
+extern volatile bool balanceEnabled; // Defined in balance.h, which main.h includes after this file.
+amI2cPort md25Port(i2cBus0, I2C_PRIO_NORMAL); // MD25 is on I2C bus0. Used by loop() and the boot.
+uint32_t md25ShadowClock() { return millis(); } // Clock for md25Shadow, which takes a plain uint32_t function.
+amMD25Shadow md25Shadow(md25ShadowClock); // What the MD25's writable registers hold. Shared with md25Control in balance.h.
+amMD25Driver md25(md25Port, md25I2cAddress, &md25Shadow); // MD25 motor controller.
+amMotion motion(md25); // Runs distance/speed goals without blocking loop().
+const uint32_t SELF_TEST_TIMEOUT = 3000; // Milliseconds allowed for the initMobility() self-test move.
 
 // Define easily understood references to differentiate each motor and associated encoder.
 const bool LEFT_SIDE = 0; // Motor and encoder on left side of robot.
 const bool RIGHT_SIDE = 1; // Motor and encoder on right side of robot.
 
-/** 
- * @brief Reads one byte from the MD25 regster via I2C.
- * @param The register to be read.
- * @return The value stored in the specified register. 
-=================================================================================================== */
-byte readRegisterByte(byte reg)
-{
-   Wire.beginTransmission(md25I2cAddress); // Request token to transmit on I2C bus
-   Wire.write(reg); // Send byte to read software version as a single byte
-   Wire.endTransmission(); // End request for token
-   Wire.requestFrom(md25I2cAddress, 1); // Request 1 byte from MD25 address register
-   while(Wire.available() < 1); // Wait for reply to request for address to arrive
-   return(Wire.read()); // Return address to   
-} // readRegisterByte
+md25Telemetry md25Snapshot = {0, 0, 0, 0, 0}; // Last encoder, volts and current readings from the MD25.
+unsigned long md25SnapshotTime = 0; // micros() when md25Snapshot was read.
 
 /** 
- * @brief Reads one byte from the MD25 regster via I2C.
- * @param reg specifies which register to be read.
- * @return The value stored in the specified register. 
+ * @brief Read encoders, battery volts and motor currents from the MD25 in one I2C transaction.
+ * @details All five readings in md25Snapshot come from the same moment so encoder counts can be 
+ * compared with each other and with the motor currents. 
+ * @return true if md25Snapshot was updated. 
 =================================================================================================== */
-long readEncoderArray(byte reg)
+bool readTelemetry()
 {
-   Wire.beginTransmission(md25I2cAddress); // Get the attention of the MD25 controller.
-   Wire.write(reg); // Tell the controller which encoder we wish to read.
-   Wire.endTransmission(); // Release control of the I2C bus.
-   Wire.requestFrom(md25I2cAddress, 4); // Request 4 bytes from MD25
-   while(Wire.available() < 4); // Wait for 4 bytes to arrive
-   long position = Wire.read(); // First byte for encoder 1, HH.
-   position <<= 8;
-   position += Wire.read(); // Second byte for encoder 1, HL
-   position <<= 8;
-   position += Wire.read(); // Third byte for encoder 1, LH
-   position <<= 8;
-   position +=Wire.read(); // Fourth byte for encoder 1, LL
-   return(position);
-} // readEncoderArray()
+   uint8_t status = md25.readTelemetrySnapshot(&md25Snapshot);
+   if(status != I2C_OK)
+   {
+      LOG_ERRORLN(LOG_MOD_MOBILITY, "<readTelemetry> MD25 read failed. I2C status = %d", status);
+      return false;
+   } // if
+   md25SnapshotTime = micros(); // When this reading was taken.
+   return true;
+} // readTelemetry()
 
 /** 
  * @brief Get current reading of the specified motor encoder.
+ * @details Call readTelemetry() once and then read both sides with fresh false, so that left and right
+ * come from the same snapshot. 
  * @param reg specifies if the left or right encoder is to be read.
- * @return value of the specified encoder. 
+ * @param fresh true to take a new snapshot first. false uses the one the last readTelemetry() took.
+ * @return value of the specified encoder, or the last good one on a bus error. 
 =================================================================================================== */
-long getEncoder(bool reg)
+long getEncoder(bool reg, bool fresh)
 {                                            
+   if(fresh == true)
+   {
+      readTelemetry(); // Both encoders in one transaction.
+   } // if
    if(reg == LEFT_SIDE) 
    {
-      return(readEncoderArray(MD25RegEncoder1a)); // Return encoder reading for left motor.
+      return(md25Snapshot.encoder1); // Return encoder reading for left motor.
    } // if
    else
    {
-      return(readEncoderArray(MD25RegEncoder2a)); // Return encoder reading for right motor.
+      return(md25Snapshot.encoder2); // Return encoder reading for right motor.
    } // else
 } // getEncoder()
 
@@ -95,7 +69,9 @@ long getEncoder(bool reg)
 =================================================================================================== */
 byte getMD25Version()
 {                                               
-   return(readRegisterByte(MD25RegSoftwareRev));
+   uint8_t version = 0;
+   md25.getFirmwareVersion(&version);
+   return(version);
 } //getMD25Version()
 
 /** 
@@ -103,94 +79,121 @@ byte getMD25Version()
 =================================================================================================== */
 void resetEncoder()
 {                                       
-  Wire.beginTransmission(md25I2cAddress); // Start conversation with motor controller
-  Wire.write(MD25RegCmd); // Set up command register
-  Wire.write(MD25CmdResetEncoders); // Send command to reset motor encoders
-  Wire.endTransmission(); 
+   md25.resetEncoders();
 } //encodeReset()
 
-void setMode(int8_t mode)
+/** 
+ * @brief Report the outcome of a move started by spinMotor().
+ * @details Called by the motion engine from checkMobility() once the motors have stopped and 
+ * settled. A move that does not finish normally marks the drive train as not working.
+ * @param result How the move ended and the final encoder readings.
+=================================================================================================== */
+void motionComplete(const motionResult &result)
 {
-   String explanation[4] = {"0 (full reverse) 128 (stop) 255 (full forward)",
-                            "-128 (full reverse), 0 (Stop), 127 (full forward)",
-                            "Speed1 controls both motors speed. Speed2 becomes the turn value. 0 (full reverse), 128 (stop), 255 (full forward)",
-                            "Speed1 control both motors speed, and Speed2 becomes the turn value. -128 (full reverse), 0 (stop), 127 (full forward)."};
-   Log.verboseln("<setMode> Setting mode to %d. Now Speed registers mean: %s", mode, explanation[mode].c_str());
-   Wire.beginTransmission(md25I2cAddress); // Request start transmit to the MD25 H-bridge.
-   Wire.write(MD25RegMode); // Going to write to the mode register.
-   Wire.write(mode); // Set mode.
-   Wire.endTransmission(); // End transmit.
-} // setMode
+   switch(result.state)
+   {
+      case MOTION_DONE:
+         LOG_VERBOSELN(LOG_MOD_MOBILITY, "<motionComplete> Move finished in %l ms. Left encoder = %l, right encoder = %l", result.elapsedMs, result.leftTicks, result.rightTicks);
+         break;
+      case MOTION_ABORTED:
+         LOG_NOTICELN(LOG_MOD_MOBILITY, "<motionComplete> Move aborted after %l ms. Left encoder = %l, right encoder = %l", result.elapsedMs, result.leftTicks, result.rightTicks);
+         break;
+      case MOTION_TIMEOUT:
+         LOG_ERRORLN(LOG_MOD_MOBILITY, "<motionComplete> Move timed out after %l ms. Left encoder = %l, right encoder = %l", result.elapsedMs, result.leftTicks, result.rightTicks);
+         mobilityStatus = false;
+         break;
+      default:
+         LOG_ERRORLN(LOG_MOD_MOBILITY, "<motionComplete> Lost contact with MD25 during move. I2C status = %d", result.busStatus);
+         mobilityStatus = false;
+         break;
+   } // switch
+} // motionComplete()
 
 /** 
  * @brief Spin one or both motors at specified speed.
- * @details This is a blocking function which will halt execution of the main logic until the 
- * motor reaches it's end point. 
+ * @details This function returns as soon as the move has been sent to the MD25. The move is 
+ * advanced by checkMobility() from loop() and motionComplete() is called when it finishes.
  * @param motorNumber 0=left, 1=right, 2=both.
- * @param speed How many encoder ticks to move.
- * @param distance how far the robot should move.
+ * @param speed 1-127 = backwards, 128 = stop, 129-255 = forward.
+ * @param distance How many encoder ticks to move.
+ * @param timeout Milliseconds to wait for the distance to be reached. 0 = no limit.
+ * @return true if the move was started. false while the balance loop drives the motors.
  * @note See full detais at https://www.pishrobot.com/files/products/datasheets/md25.pdf
 =================================================================================================== */
-void spinMotor(int8_t motorNumber, int8_t speed, long distance)
+bool spinMotor(int8_t motorNumber, uint8_t speed, long distance, uint32_t timeout = 0)
 {
-   resetEncoder(); // Set both encoders to 0.
+   if(balanceEnabled == true) // Both write speed1 and speed2 through md25Shadow. Only one may drive.
+   {
+      LOG_ERRORLN(LOG_MOD_MOBILITY, "<spinMotor> Move not started. Balance loop is driving the motors.");
+      return false;
+   } // if
+   motionGoal goal = {(uint8_t)motorNumber, speed, (int32_t)distance, timeout};
    switch(motorNumber)
    {
-      case 0: // Left motor 
-         Log.verboseln("<spinMotor> Spin left motor");
-         setMode(0); // Set MD25 controller to mode 0.
-         Wire.beginTransmission(md25I2cAddress); // Request start transmit to the MD25 H-bridge
-         Wire.write(MD25RegSpeed1); // Indicate motor1 speed register
-         Wire.write(speed); // 1-127 = backwards, 128 = stop, 129-255 = forward                                           
-         Wire.endTransmission(); // End transmit
+      case MOTION_LEFT:
+         LOG_VERBOSELN(LOG_MOD_MOBILITY, "<spinMotor> Spin left motor");
          break;
-      case 1: // Right motor 
-         Log.verboseln("<spinMotor> Spin right motor");
-         setMode(0); // Set MD25 controller to mode 0.
-         Wire.beginTransmission(md25I2cAddress); // Request start transmit to the MD25 H-bridge
-         Wire.write(MD25RegSpeed2); // Indicate motor1 speed register
-         Wire.write(speed); // 1-127 = backwards, 128 = stop, 129-255 = forward                                           
-         Wire.endTransmission(); // End transmit
+      case MOTION_RIGHT:
+         LOG_VERBOSELN(LOG_MOD_MOBILITY, "<spinMotor> Spin right motor");
          break;
-      default: // Both motors
-         Log.verboseln("<spinMotor> Spin both motors");
-         setMode(2); // Set MD25 controller to mode 2.
-         Wire.beginTransmission(md25I2cAddress); // Request start transmit to the MD25 H-bridge
-         Wire.write(MD25RegSpeed1); // Indicate motor1 speed register
-         Wire.write(speed); // 1-127 = backwards, 128 = stop, 129-255 = forward                                           
-         Wire.endTransmission(); // End transmit
+      default:
+         LOG_VERBOSELN(LOG_MOD_MOBILITY, "<spinMotor> Spin both motors");
+         goal.motors = MOTION_BOTH;
          break;
    } // switch
-   Log.verboseln("<initMobility> Readings before: Left encoder = %l, right encoder = %l", getEncoder(LEFT_SIDE), getEncoder(RIGHT_SIDE));
-   Log.verboseln("<initMobility> Wait for motor to  stop spinning.");
-   while(getEncoder(LEFT_SIDE) < distance)
+   if(motion.start(goal, millis()) == false)
    {
-      Log.verboseln("<spinMotor> ... Still spinning.");
-      delay(10); // Give motor time to before taking next reading.
-   } // while   
-   // Stop both motors
-   Wire.beginTransmission(md25I2cAddress); // Request start transmit to the MD25 H-bridge
-   Wire.write(MD25RegSpeed1); // Indicate motor1 speed register
-   Wire.write(128); // 1-127 = backwards, 128 = stop, 129-255 = forward                                           
-   Wire.endTransmission(); // End transmit
-   delay(100); // Give motor time to stop.
-   Log.verboseln("<initMobility> Readings after: Left encoder = %l, right encoder = %l", getEncoder(LEFT_SIDE), getEncoder(RIGHT_SIDE));
+      LOG_ERRORLN(LOG_MOD_MOBILITY, "<spinMotor> Move not started. Busy = %T, I2C status = %d", motion.isBusy(), motion.getResult().busStatus);
+      return false;
+   } // if
+   return true;
 } // spinMotor()
 
+/**
+ * @brief Log how many MD25 register writes the shadow has kept off bus0.
+ * ==========================================================================*/
+void showMd25Shadow()
+{
+   LOG_NOTICELN(LOG_MOD_MOBILITY, "<showMd25Shadow> MD25 register writes suppressed = %l, resyncs after a quiet bus = %l.", (long)md25Shadow.getSuppressed(),
+                (long)md25Shadow.getResyncs());
+} // showMd25Shadow()
+
+/**
+ * @brief Advance any move in progress.
+ * @details Call from loop(). Never blocks. The encoders are only read every 10ms no matter how 
+ * often this is called.
+ * ==========================================================================*/
+void checkMobility()
+{
+   motion.tick(millis());
+} // checkMobility()
+
 /**
  * @brief Initialize robot drive train.
- * @details Robot moves on two DC motors driven via an I2C motor controller.
+ * @details Robot moves on two DC motors driven via an I2C motor controller. Starts a short
+ * self-test move that runs in the background. Its outcome is reported by motionComplete().
  * ==========================================================================*/
 bool initMobility()
 {
-   bool mStatus = true; // Status of mobility platform.
-   Log.traceln("<initMobility> Initialize the drive train for this platform.");
-   Log.verboseln("<initMobility> MD25 driver firmware version = %d", getMD25Version());
-   const int8_t BOTH_MOTORS = 2;
-   int8_t speed = 180; // 0 - 127 backwards, 128 stop, 129 - 255 forward.
-   long distance = 100; // Distance to travel in millimeters.
-   spinMotor(BOTH_MOTORS, speed, distance); // Spin both motors.
-   return mStatus;
+   LOG_TRACELN(LOG_MOD_MOBILITY, "<initMobility> Initialize the drive train for this platform.");
+   uint8_t version;
+   uint8_t status = md25.getFirmwareVersion(&version);
+   if(status != I2C_OK)
+   {
+      LOG_ERRORLN(LOG_MOD_MOBILITY, "<initMobility> MD25 did not answer. I2C status = %d", status);
+      return false;
+   } // if
+   LOG_VERBOSELN(LOG_MOD_MOBILITY, "<initMobility> MD25 driver firmware version = %d", version);
+   status = md25.setAcceleration(MD25AccelDefault); // Moves from spinMotor() ramp at the MD25's own rate, so make it a known one.
+   if(status != I2C_OK)
+   {
+      LOG_ERRORLN(LOG_MOD_MOBILITY, "<initMobility> MD25 acceleration not set. I2C status = %d", status);
+      return false;
+   } // if
+   motion.onComplete(motionComplete); // Report how moves end.
+   uint8_t speed = 180; // 0 - 127 backwards, 128 stop, 129 - 255 forward.
+   long distance = 100; // Encoder ticks to travel. 360 to a turn of the wheel, so about 87 mm.
+   return spinMotor(MOTION_BOTH, speed, distance, SELF_TEST_TIMEOUT); // Spin both motors.
 } // initMobility. 
 
 #endif // End of precompiler protected code block
\ No newline at end of file
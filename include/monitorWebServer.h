@@ -18,10 +18,10 @@ void monitorWebServer()
       if(localWebService.checkForClientRequest()) // New binary or broker IP?
       {
          IPAddress tmpIP = localWebService.getBrokerIP(); // Get awaiting IP address.
-         Log.noticeln("<monitorWebServer> Set broker IP to %p", tmpIP); 
+         LOG_NOTICELN(LOG_MOD_WEB, "<monitorWebServer> Set broker IP to %p", tmpIP); 
          flash.writeBrokerIP(tmpIP); // Write address to flash.
          brokerIP = flash.readBrokerIP(); // Retrieve MQTT broker IP address from NV-RAM.
-         Log.noticeln("<setup> MQTT broker IP believed to be %p", brokerIP);
+         LOG_NOTICELN(LOG_MOD_WEB, "<setup> MQTT broker IP believed to be %p", brokerIP);
       } //if
    } //if     
 } //monitorWebServer()
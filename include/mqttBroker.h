@@ -5,98 +5,314 @@
 #include <main.h> // Header file for all libraries needed by this program.
 #include <configDetails.h> // Wifi functions. 
 #include <aaStringQueue.h> // Required for string buffer to hold incoming commands.
-#include <aaFormat.h> //
+#include <amCmd.h> // Allocation free command parsing and dispatch.
+#include <telemetry.h> // Batched MQTT telemetry.
+#include <amTrajectory.h> // Path segments.
 
 aaFlash flash; // Non-volatile memory management. 
 aaMqtt mqtt; // Publish and subscribe to MQTT broker. 
 IPAddress brokerIP; // IP address of the MQTT broker.
 char uniqueName[HOST_NAME_SIZE]; // Character array that holds unique name for Wifi network purposes. 
 char *uniqueNamePtr = &uniqueName[0]; // Pointer to first address position of unique name character array.
-char healthTopicTree[50] = ""; // Char array to hold full health topic tree name.
 String result[2] = {"false","true"}; // Provide english lables for true and flase return codes.
+extern bool mqttBrokerConnected; // Defined in configDetails.h, which includes this file first.
+extern aaNetwork network; // Defined in configDetails.h, which includes this file first.
+void showBootProfile(); // Defined in bootSequence.h.
+void showOdometry(); // Defined in balance.h.
+void resetOdometry(); // Defined in balance.h.
+bool addPathSegment(const pathSegment &segment); // Defined in balance.h.
+void stopPath(); // Defined in balance.h.
+void showPath(); // Defined in balance.h.
+bool enableBalance(bool enable); // Defined in balance.h.
+void showMd25Shadow(); // Defined in mobility.h.
 
-// TODO #7 : A pingable but non MQTT IP address crash loops code.
 /** 
  * @brief Establish connect to the the MQTT broker.
- * @details Retrieve the MQTT broker IP address from Flash memory and ping that 
- *          address to see if there is a responsive device on the network. If there 
- *          is then publish a health message noting that end-to-end network services 
- *          are working. Note that upon connecting to the broker the MQTT library 
- *          automatically subscribes to the <unique name>/commands topic.  
+ * @details Retrieve the MQTT broker IP address from Flash memory and start 
+ *          connecting to it. Called by checkWifiLink() once WiFi is up, and 
+ *          returns at once. checkMqttLink() does the rest from loop(), 
+ *          backing off between attempts, so a wrong address, a host with no 
+ *          broker or a broker that keeps dropping the connection never holds 
+ *          up the robot. The message noting that end-to-end network services 
+ *          are working goes out on the events topic as soon as the broker 
+ *          accepts, with how long WiFi took to come up. Note that upon 
+ *          connecting to the broker the MQTT library automatically subscribes
+ *          to the <unique name>/commands topic.  
  * =================================================================================*/
-bool connectToMqttBroker(aaNetwork &network)
+void connectToMqttBroker(aaNetwork &network)
 {
    network.getUniqueName(uniqueNamePtr); // Puts unique name value into uniqueName[]
-   Log.noticeln("<connectToMqttBroker> Unique network name = %s.", uniqueName);
-   Log.noticeln("<connectToMqttBroker> Health topic = %s.", HEALTH_MQTT_TOPIC);
-   strcpy(healthTopicTree, uniqueName);
-   strcat(healthTopicTree, HEALTH_MQTT_TOPIC);
-   Log.noticeln("<connectToMqttBroker> Full health topic tree = %s (length = %d).", healthTopicTree, strlen(healthTopicTree));
+   LOG_NOTICELN(LOG_MOD_MQTT, "<connectToMqttBroker> Unique network name = %s.", uniqueName);
+   initTelemetry(uniqueName); // Build the state, health, I2C and events topics once.
 
    brokerIP = flash.readBrokerIP(); // Retrieve MQTT broker IP address from NV-RAM.
-   Log.noticeln("<connectToMqttBroker> MQTT broker IP believed to be %p.", brokerIP);
-
-   bool tmpPingResult = network.pingIP(brokerIP, 5);
-   String tmpResult[2];
-   tmpResult[0] = "Not found - invalid address";
-   tmpResult[1] = "Found - valid address";
-   Log.noticeln("<connectToMqttBroker> Ping of broker at %p resulted in %T.", brokerIP, tmpPingResult);
-   if(tmpPingResult == true)
+   LOG_NOTICELN(LOG_MOD_MQTT, "<connectToMqttBroker> MQTT broker IP believed to be %p.", brokerIP);
+   mqtt.connect(brokerIP, uniqueName);
+   char eventsTopic[HOST_NAME_SIZE + 8]; // <unique name>/events.
+   snprintf(eventsTopic, sizeof(eventsTopic), "%s/events", uniqueName);
+   char message[96]; // Boot event with the WiFi boot metric.
+   snprintf(message, sizeof(message), "End-to-end network services established. WiFi up in %lu ms (%s)", 
+            (unsigned long)network.getTimeToIpMs(), network.getLink().getFastWasUsed() ? "fast" : "scan");
+   mqtt.publishMQTT(eventsTopic, message); // Held until the broker accepts.
+} //connectToMqttBroker()
+
+/** 
+ * @brief Look after the MQTT broker connection. Call from loop().
+ * @details Reconnects with backoff when the broker goes away and sends what 
+ * was published while it was gone.
+ * =================================================================================*/
+void checkMqttLink()
+{
+   mqtt.poll(millis());
+   mqttBrokerConnected = mqtt.isConnected();
+} // checkMqttLink()
+
+/**
+ * @brief Handle the TEST command. Takes no arguments.
+ * =================================================================================*/
+bool cmdTest(const cmdArg*, uint8_t)
+{
+   LOG_NOTICELN(LOG_MOD_MQTT, "<cmdTest> Recieved test command."); 
+   return true;
+} // cmdTest()
+
+/**
+ * @brief Handle the ODOMETRY command. ODOMETRY logs the pose and wheel speeds,
+ * ODOMETRY,RESET makes where the robot is now the origin.
+ * =================================================================================*/
+bool cmdOdometry(const cmdArg* arg, uint8_t argCount)
+{
+   if(argCount == 2 && cmdEquals(arg[1], "RESET"))
    {
-      mqtt.connect(brokerIP, uniqueName);
-      bool x = false;
-      while(x == false)
-      {
-         x = mqtt.publishMQTT(healthTopicTree, "End-to-end network services estabished");
-         delay(1);
-      } //while  
-   } //if
-   else
+      resetOdometry();
+      LOG_NOTICELN(LOG_MOD_MQTT, "<cmdOdometry> Odometry origin moved to the robot.");
+      return true;
+   } // if
+   if(argCount != 1)
    {
-      Log.errorln("<connectToMqttBroker> Cannot reach MQTT broker.");
-      return false; 
-   } //else
+      LOG_WARNINGLN(LOG_MOD_MQTT, "<cmdOdometry> Expected ODOMETRY or ODOMETRY,RESET.");
+      return false;
+   } // if
+   showOdometry();
    return true;
-} //connectToMqttBroker()
+} // cmdOdometry()
 
 /**
- * @brief Process the incoming command.
+ * @brief Handle the PATH command.
+ * @details PATH logs how far through its path the balance loop is and PATH,STOP drops the path.
+ * Otherwise the arguments are one or more segments, each STRAIGHT,<mm> or TURN,<degrees>,
+ * optionally followed by TRAPEZOID or SCURVE (the default), e.g.
+ * PATH,STRAIGHT,500,TURN,90,TRAPEZOID,STRAIGHT,-500. Turns are on the spot, anticlockwise
+ * positive. The whole command is parsed before any segment is queued. Paths are refused until
+ * BALANCE,ON has handed the motors to the balance loop.
  * =================================================================================*/
-bool processCmd(String payload)
-{
-   aaFormat format;
-   String ucPayload = format.stringToUpper(payload);
-   const int8_t maxArg = 20; // Allow 1 cmd and up to 19 args in an MQTT message.
-   String arg[maxArg]; // arg[0] = cmd, arg[1] = 1st argument, arg[2] = second ...
-   int argN = 0; // argument number that we're working on
-   int argStart = 0; // character number where current argument starts
-   int argEnd = ucPayload.indexOf(",",argStart);  // position of comma at end of cmd
-   // Parse comma delimited message into array elements 
-   while(argEnd >= 0) // .indexOf returns -1 if no string found
-   {  arg[argN] = ucPayload.substring(argStart,argEnd);  // extract the current argument
-      argN ++ ; // advance the argument counter
-      argStart = argEnd + 1; // next arg starts after previous arg's delimiting comma
-      argEnd = ucPayload.indexOf(",",argStart); // find next arg's delimiting comma
-   } // while            
-   arg[argN] = ucPayload.substring(argStart,argEnd); // last argument has no comma 
-                                                     // delimiter. argN ends up as a 
-                                                     // count of the number of 
-                                                     // arguments, excluding the command
-
-   String cmd = arg[0]; // first comma separated value in payload is the command
-   if(cmd == "TEST")
+bool cmdPath(const cmdArg* arg, uint8_t argCount)
+{
+   if(argCount == 1)
    {
-      Log.noticeln("<processCmd> Recieved test command."); 
+      showPath();
       return true;
-   }  // if 
-   if(cmd == "RGB")
+   } // if
+   if(argCount == 2 && cmdEquals(arg[1], "STOP"))
    {
-      Log.noticeln("<processCmd> Recieved command to change RGB LED to red = %s, green = %s, blue = %s.", arg[1], arg[2], arg[3]); 
+      stopPath();
+      LOG_NOTICELN(LOG_MOD_MQTT, "<cmdPath> Path stopped.");
       return true;
-   }  // if 
+   } // if
+   pathSegment segments[CMD_MAX_ARGS / 2]; // Each segment takes at least two arguments.
+   uint8_t count = 0;
+   uint8_t i = 1;
+   while(i < argCount)
+   {
+      long amount;
+      bool turn = cmdEquals(arg[i], "TURN");
+      if((turn == false && cmdEquals(arg[i], "STRAIGHT") == false) || i + 1 >= argCount || cmdToLong(arg[i + 1], &amount) == false)
+      {
+         LOG_WARNINGLN(LOG_MOD_MQTT, "<cmdPath> Expected PATH, PATH,STOP or PATH followed by STRAIGHT,<mm> or TURN,<degrees> segments.");
+         return false;
+      } // if
+      segments[count] = {turn ? (uint8_t)PATH_TURN : (uint8_t)PATH_STRAIGHT, PROFILE_SCURVE, turn ? amount * (float)DEG_TO_RAD : amount * 0.001f};
+      i += 2;
+      if(i < argCount && cmdEquals(arg[i], "TRAPEZOID"))
+      {
+         segments[count].shape = PROFILE_TRAPEZOID;
+         i++;
+      } // if
+      else if(i < argCount && cmdEquals(arg[i], "SCURVE"))
+      {
+         i++;
+      } // else if
+      count++;
+   } // while
+   for(i = 0; i < count; i++)
+   {
+      if(addPathSegment(segments[i]) == false)
+      {
+         LOG_WARNINGLN(LOG_MOD_MQTT, "<cmdPath> Only %d of %d segments queued.", i, count);
+         return false;
+      } // if
+   } // for
+   LOG_NOTICELN(LOG_MOD_MQTT, "<cmdPath> %d segments queued.", count);
+   return true;
+} // cmdPath()
+
+/**
+ * @brief Handle the RGB command. Arguments are red, green and blue, 0 to 255.
+ * =================================================================================*/
+bool cmdRgb(const cmdArg* arg, uint8_t argCount)
+{
+   long colour[3];
+   if(argCount != 4 || cmdToLong(arg[1], &colour[0]) == false || cmdToLong(arg[2], &colour[1]) == false || cmdToLong(arg[3], &colour[2]) == false)
+   {
+      LOG_WARNINGLN(LOG_MOD_MQTT, "<cmdRgb> Expected RGB,<red>,<green>,<blue>.");
+      return false;
+   } // if
+   LOG_NOTICELN(LOG_MOD_MQTT, "<cmdRgb> Recieved command to change RGB LED to red = %l, green = %l, blue = %l.", colour[0], colour[1], colour[2]); 
+   return true;
+} // cmdRgb()
+
+/**
+ * @brief Handle the BALANCE command.
+ * @details BALANCE,ON lets the balance loop drive the motors and BALANCE,OFF stops them and takes
+ * them back. Paths are only accepted while the loop is on.
+ * =================================================================================*/
+bool cmdBalance(const cmdArg* arg, uint8_t argCount)
+{
+   if(argCount != 2 || (cmdEquals(arg[1], "ON") == false && cmdEquals(arg[1], "OFF") == false))
+   {
+      LOG_WARNINGLN(LOG_MOD_MQTT, "<cmdBalance> Expected BALANCE,ON or BALANCE,OFF.");
+      return false;
+   } // if
+   return enableBalance(cmdEquals(arg[1], "ON"));
+} // cmdBalance()
+
+/**
+ * @brief Handle the BOOT command. Takes no arguments.
+ * @details Logs how long each start up phase took and which ones were on the
+ * critical path.
+ * =================================================================================*/
+bool cmdBoot(const cmdArg*, uint8_t)
+{
+   showBootProfile();
+   return true;
+} // cmdBoot()
+
+/**
+ * @brief Handle the I2C command. Takes no arguments.
+ * @details Reports how busy each I2C bus has been, how long transactions 
+ * of each priority waited and how many MD25 register writes were left off
+ * the bus.
+ * =================================================================================*/
+bool cmdI2c(const cmdArg*, uint8_t)
+{
+   showI2cStats();
+   showMd25Shadow();
+   return true;
+} // cmdI2c()
+
+/**
+ * @brief Handle the I2CSCAN command. Takes no arguments.
+ * @details Sweeps every address on both I2C buses and names what answers. 
+ * Diagnostic traffic, so it waits behind everything else on the buses.
+ * =================================================================================*/
+bool cmdI2cScan(const cmdArg*, uint8_t)
+{
+   sweepBus(0);
+   sweepBus(1);
+   return true;
+} // cmdI2cScan()
+
+/**
+ * @brief Handle the MQTT command. Takes no arguments.
+ * @details Reports the state of the broker connection, how often it has been 
+ * lost and how many messages are waiting for it.
+ * =================================================================================*/
+bool cmdMqtt(const cmdArg*, uint8_t)
+{
+   amReconnect &link = aaMqtt::getLink();
+   static const char* STATES[] = {"idle", "waiting", "connecting", "connected"};
+   LOG_NOTICELN(LOG_MOD_MQTT, "<cmdMqtt> Broker %s, next attempt in %l ms, %d failures in a row.", STATES[link.getState()], (long)link.getWaitMs(millis()), link.getFailures());
+   LOG_NOTICELN(LOG_MOD_MQTT, "<cmdMqtt> Attempts %l, connects %l, timeouts %l, drops %l.", (long)link.getAttempts(), (long)link.getConnects(), (long)link.getTimeouts(), (long)link.getDrops());
+   LOG_NOTICELN(LOG_MOD_MQTT, "<cmdMqtt> Messages held for the broker %d, lost %l.", aaMqtt::getHeldCount(), (long)aaMqtt::getHeldLost());
+   return true;
+} // cmdMqtt()
+
+/**
+ * @brief Handle the MQTTPOOL command. Takes no arguments.
+ * @details Reports how full the MQTT client's packet pools are and how often they have
+ * had to fall back on the heap.
+ * =================================================================================*/
+bool cmdMqttPool(const cmdArg*, uint8_t)
+{
+   AsyncMqttClientPoolStats packets = AsyncMqttClient::getPacketPoolStats();
+   AsyncMqttClientPoolStats buffers = AsyncMqttClient::getBufferPoolStats();
+   LOG_NOTICELN(LOG_MOD_MQTT, "<cmdMqttPool> Packets in use %d, high water %d of %d, heap fallbacks %l.", packets.inUse, packets.highWater, packets.slots, (long)packets.fallbacks);
+   LOG_NOTICELN(LOG_MOD_MQTT, "<cmdMqttPool> Buffers in use %d, high water %d of %d, heap fallbacks %l.", buffers.inUse, buffers.highWater, buffers.slots, (long)buffers.fallbacks);
+   return true;
+} // cmdMqttPool()
+
+/**
+ * @brief Handle the WIFI command. Takes no arguments.
+ * @details Reports the state of the WiFi connection, how long it took to come
+ * up and how often the fast connect to the remembered Access Point has worked.
+ * =================================================================================*/
+bool cmdWifi(const cmdArg*, uint8_t)
+{
+   amWifiLink &link = network.getLink();
+   static const char* STATES[] = {"idle", "fast connecting", "scanning", "joining", "up", "waiting"};
+   LOG_NOTICELN(LOG_MOD_MQTT, "<cmdWifi> WiFi %s, next scan in %l ms, %d failures in a row.", STATES[link.getState()], (long)link.getWaitMs(millis()), link.getFailures());
+   LOG_NOTICELN(LOG_MOD_MQTT, "<cmdWifi> Time to IP %l ms, fast connects %l, won %l, scans %l, drops %l.", (long)link.getTimeToIpMs(), (long)link.getFastConnects(), (long)link.getFastWins(), (long)link.getScans(), (long)link.getLosses());
+   LOG_NOTICELN(LOG_MOD_MQTT, "<cmdWifi> Signal strength %l dBm.", network.getSignalStrength());
+   return true;
+} // cmdWifi()
+
+/**
+ * @brief Handle the TELEMETRY command. Takes no arguments.
+ * @details Reports how much telemetry has been sent and what a full send 
+ * window has cost.
+ * =================================================================================*/
+bool cmdTelemetry(const cmdArg*, uint8_t)
+{
+   showTelemetryStats();
+   return true;
+} // cmdTelemetry()
 
-   Log.warningln("<processCmd> Warning - unrecognized command."); 
-   return false;
+const cmdEntry mqttCmds[] = // Commands accepted on the <unique name>/commands topic. Keep sorted by name.
+{
+   {"BALANCE", cmdBalance},
+   {"BOOT", cmdBoot},
+   {"I2C", cmdI2c},
+   {"I2CSCAN", cmdI2cScan},
+   {"MQTT", cmdMqtt},
+   {"MQTTPOOL", cmdMqttPool},
+   {"ODOMETRY", cmdOdometry},
+   {"PATH", cmdPath},
+   {"RGB", cmdRgb},
+   {"TELEMETRY", cmdTelemetry},
+   {"TEST", cmdTest},
+   {"WIFI", cmdWifi},
+}; // mqttCmds
+const uint8_t MQTT_NUM_CMDS = sizeof(mqttCmds) / sizeof(mqttCmds[0]); // Rows in mqttCmds.
+
+/**
+ * @brief Process the incoming command.
+ * @details Parses the command in place and looks it up in mqttCmds. Uses no heap.
+ * @param payload Command text. Upper-cased and split up in place.
+ * @param len Characters in payload. The buffer must have room for one more.
+ * @return true if the command was recognized and its handler succeeded.
+ * =================================================================================*/
+bool processCmd(char* payload, size_t len)
+{
+   uint8_t status = cmdDispatch(mqttCmds, MQTT_NUM_CMDS, payload, len);
+   if(status == CMD_UNKNOWN || status == CMD_EMPTY)
+   {
+      LOG_WARNINGLN(LOG_MOD_MQTT, "<processCmd> Warning - unrecognized command."); 
+   } // if
+   else if(status == CMD_TOO_MANY_ARGS)
+   {
+      LOG_WARNINGLN(LOG_MOD_MQTT, "<processCmd> Warning - more than %d arguments.", CMD_MAX_ARGS - 1); 
+   } // else if
+   return status == CMD_OK;
 } // processCmd()
 
 /** 
@@ -112,18 +328,18 @@ IPAddress getMqttBrokerIP()
  * =================================================================================*/
 void checkMqtt()
 {
-   String cmd = mqtt.getCmd();
-   if(cmd != "")
+   char cmd[COMMAND_MAX_LENGTH + 1]; // Room for the 0 cmdTokenize() may add.
+   if(mqtt.getCmd(cmd, COMMAND_MAX_LENGTH) == true)
    {
-      Log.noticeln("<checkMqtt> cmd = %s.", cmd);
-      bool allIsWell = processCmd(cmd);
+      LOG_NOTICELN(LOG_MOD_MQTT, "<checkMqtt> cmd = %s.", cmd);
+      bool allIsWell = processCmd(cmd, strlen(cmd));
       if(allIsWell)
       {
-         Log.noticeln("<checkMqtt> All went well.");
+         LOG_NOTICELN(LOG_MOD_MQTT, "<checkMqtt> All went well.");
       } // if 
       else
       {
-         Log.warningln("<checkMqtt> Something went wrong.");
+         LOG_WARNINGLN(LOG_MOD_MQTT, "<checkMqtt> Something went wrong.");
       } // if 
    } // if   
 } // checkMqtt()
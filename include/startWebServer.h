@@ -17,15 +17,16 @@ void startWebServer()
    char uniqueName[HOST_NAME_SIZE]; // Contain unique name for Wifi network purposes. 
    char *uniqueNamePtr = &uniqueName[0]; // Pointer to starting address of name. 
    network.getUniqueName(uniqueNamePtr); // Get unique name. 
-   Log.noticeln("<startWebServer> Unique Name: %s (Length of %d).", uniqueName, strlen(uniqueName));
+   LOG_NOTICELN(LOG_MOD_WEB, "<startWebServer> Unique Name: %s (Length of %d).", uniqueName, strlen(uniqueName));
+   localWebService.setStatusPage(i2cStatusPage); // I2C bus use on the status page.
    isWebServer = localWebService.start(uniqueNamePtr); // Start web server and track result.
    if(isWebServer)
    {
-      Log.noticeln("<startWebServer> Web server successfully started.");
+      LOG_NOTICELN(LOG_MOD_WEB, "<startWebServer> Web server successfully started.");
    } //if
    else
    {
-      Log.errorln("<startWebServer> Web server failed to start.");
+      LOG_ERRORLN(LOG_MOD_WEB, "<startWebServer> Web server failed to start.");
    } //else
 } //startWebServer()
 
@@ -48,54 +48,54 @@ struct_Colour memColour; // Used to switch back RGB LED colour when it is tempor
 // TODO - use colour wheel routine: https://github.com/espressif/arduino-esp32/blob/master/libraries/ESP32/examples/AnalogOut/ledcWrite_RGB/ledcWrite_RGB.ino
 void createPredefinedColours()
 {
-   Log.traceln("<createPredefinedColours> Creating array of colours.");
+   LOG_TRACELN(LOG_MOD_LED, "<createPredefinedColours> Creating array of colours.");
    statusColour[RED].name = "RED";
    statusColour[RED].redDutyCycle = 256;
    statusColour[RED].greenDutyCycle = 0;
    statusColour[RED].blueDutyCycle = 0;
-   Log.verboseln("<createPredefinedColours> Red (%d) settings  - red = %d, green = %d, blue = %d.", RED, statusColour[RED].redDutyCycle, statusColour[RED].greenDutyCycle, statusColour[RED].blueDutyCycle);
+   LOG_VERBOSELN(LOG_MOD_LED, "<createPredefinedColours> Red (%d) settings  - red = %d, green = %d, blue = %d.", RED, statusColour[RED].redDutyCycle, statusColour[RED].greenDutyCycle, statusColour[RED].blueDutyCycle);
 
    statusColour[GREEN].name = "GREEN";
    statusColour[GREEN].redDutyCycle = 0;
    statusColour[GREEN].greenDutyCycle = 256;
    statusColour[GREEN].blueDutyCycle = 0;
-   Log.verboseln("<createPredefinedColours> Green (%d) settings  - red = %d, green = %d, blue = %d.", GREEN, statusColour[GREEN].redDutyCycle, statusColour[GREEN].greenDutyCycle, statusColour[GREEN].blueDutyCycle);
+   LOG_VERBOSELN(LOG_MOD_LED, "<createPredefinedColours> Green (%d) settings  - red = %d, green = %d, blue = %d.", GREEN, statusColour[GREEN].redDutyCycle, statusColour[GREEN].greenDutyCycle, statusColour[GREEN].blueDutyCycle);
 
    statusColour[BLUE].name = "BLUE";
    statusColour[BLUE].redDutyCycle = 0;
    statusColour[BLUE].greenDutyCycle = 0;
    statusColour[BLUE].blueDutyCycle = 256;
-   Log.verboseln("<createPredefinedColours> Blue (%d) settings  - red = %d, green = %d, blue = %d.", BLUE, statusColour[BLUE].redDutyCycle, statusColour[BLUE].greenDutyCycle, statusColour[BLUE].blueDutyCycle);
+   LOG_VERBOSELN(LOG_MOD_LED, "<createPredefinedColours> Blue (%d) settings  - red = %d, green = %d, blue = %d.", BLUE, statusColour[BLUE].redDutyCycle, statusColour[BLUE].greenDutyCycle, statusColour[BLUE].blueDutyCycle);
 
    statusColour[YELLOW].name = "YELLOW";
    statusColour[YELLOW].redDutyCycle = 128;
    statusColour[YELLOW].greenDutyCycle = 256;
    statusColour[YELLOW].blueDutyCycle = 0;
-   Log.verboseln("<createPredefinedColours> YELLOW (%d) settings  - red = %d, green = %d, blue = %d.", YELLOW, statusColour[YELLOW].redDutyCycle, statusColour[YELLOW].greenDutyCycle, statusColour[YELLOW].blueDutyCycle);
+   LOG_VERBOSELN(LOG_MOD_LED, "<createPredefinedColours> YELLOW (%d) settings  - red = %d, green = %d, blue = %d.", YELLOW, statusColour[YELLOW].redDutyCycle, statusColour[YELLOW].greenDutyCycle, statusColour[YELLOW].blueDutyCycle);
 
    statusColour[PINK].name = "PINK";
    statusColour[PINK].redDutyCycle = 128;
    statusColour[PINK].greenDutyCycle = 0;
    statusColour[PINK].blueDutyCycle = 256;
-   Log.verboseln("<createPredefinedColours> PINK (%d) settings  - red = %d, green = %d, blue = %d.", PINK, statusColour[PINK].redDutyCycle, statusColour[PINK].greenDutyCycle, statusColour[PINK].blueDutyCycle);
+   LOG_VERBOSELN(LOG_MOD_LED, "<createPredefinedColours> PINK (%d) settings  - red = %d, green = %d, blue = %d.", PINK, statusColour[PINK].redDutyCycle, statusColour[PINK].greenDutyCycle, statusColour[PINK].blueDutyCycle);
 
    statusColour[AQUA].name = "AQUA";
    statusColour[AQUA].redDutyCycle = 0;
    statusColour[AQUA].greenDutyCycle = 128;
    statusColour[AQUA].blueDutyCycle = 256;
-   Log.verboseln("<createPredefinedColours> Aqua (%d) settings  - red = %d, green = %d, blue = %d.", AQUA, statusColour[AQUA].redDutyCycle, statusColour[AQUA].greenDutyCycle, statusColour[AQUA].blueDutyCycle);
+   LOG_VERBOSELN(LOG_MOD_LED, "<createPredefinedColours> Aqua (%d) settings  - red = %d, green = %d, blue = %d.", AQUA, statusColour[AQUA].redDutyCycle, statusColour[AQUA].greenDutyCycle, statusColour[AQUA].blueDutyCycle);
 
    statusColour[WHITE].name = "WHITE";
    statusColour[WHITE].redDutyCycle = 64;
    statusColour[WHITE].greenDutyCycle = 128;
    statusColour[WHITE].blueDutyCycle = 128;
-   Log.verboseln("<createPredefinedColours> White (%d) settings  - red = %d, green = %d, blue = %d.", WHITE, statusColour[WHITE].redDutyCycle, statusColour[WHITE].greenDutyCycle, statusColour[WHITE].blueDutyCycle);
+   LOG_VERBOSELN(LOG_MOD_LED, "<createPredefinedColours> White (%d) settings  - red = %d, green = %d, blue = %d.", WHITE, statusColour[WHITE].redDutyCycle, statusColour[WHITE].greenDutyCycle, statusColour[WHITE].blueDutyCycle);
 
    statusColour[BLACK].name = "BLACK";
    statusColour[BLACK].redDutyCycle = 0;
    statusColour[BLACK].greenDutyCycle = 0;
    statusColour[BLACK].blueDutyCycle = 0;
-   Log.verboseln("<createPredefinedColours> Black (%d) settings  - red = %d, green = %d, blue = %d.", BLACK, statusColour[BLACK].redDutyCycle, statusColour[BLACK].greenDutyCycle, statusColour[BLACK].blueDutyCycle);
+   LOG_VERBOSELN(LOG_MOD_LED, "<createPredefinedColours> Black (%d) settings  - red = %d, green = %d, blue = %d.", BLACK, statusColour[BLACK].redDutyCycle, statusColour[BLACK].greenDutyCycle, statusColour[BLACK].blueDutyCycle);
 } // createPredefinedColours()
 
 /**
@@ -106,7 +106,7 @@ void createPredefinedColours()
  * ==========================================================================*/
 void saveRgbColour()
 {
-   Log.verboseln("<saveRgbColour> Save Red = %d, Green = %d, Blue = %d.", ledcRead(PWM_RED_CHANNEL), ledcRead(PWM_GREEN_CHANNEL), ledcRead(PWM_BLUE_CHANNEL));
+   LOG_VERBOSELN(LOG_MOD_LED, "<saveRgbColour> Save Red = %d, Green = %d, Blue = %d.", ledcRead(PWM_RED_CHANNEL), ledcRead(PWM_GREEN_CHANNEL), ledcRead(PWM_BLUE_CHANNEL));
    memColour.redDutyCycle = ledcRead(PWM_RED_CHANNEL);
    memColour.greenDutyCycle = ledcRead(PWM_GREEN_CHANNEL);
    memColour.blueDutyCycle = ledcRead(PWM_BLUE_CHANNEL);
@@ -119,7 +119,7 @@ void saveRgbColour()
  * ==========================================================================*/
 void loadRgbColour()
 {
-   Log.verboseln("<loadRgbColour> Load Red = %d, Green = %d, Blue = %d.", memColour.redDutyCycle, memColour.greenDutyCycle, memColour.blueDutyCycle);
+   LOG_VERBOSELN(LOG_MOD_LED, "<loadRgbColour> Load Red = %d, Green = %d, Blue = %d.", memColour.redDutyCycle, memColour.greenDutyCycle, memColour.blueDutyCycle);
    ledcWrite(PWM_RED_CHANNEL, memColour.redDutyCycle);
    ledcWrite(PWM_GREEN_CHANNEL, memColour.greenDutyCycle);
    ledcWrite(PWM_BLUE_CHANNEL, memColour.blueDutyCycle);
@@ -153,7 +153,7 @@ void setCustRgbColour(uint32_t red, uint32_t green, uint32_t blue)
    ledcWrite(PWM_RED_CHANNEL, redDC); // Set RGB LED red duty cycle.
    ledcWrite(PWM_GREEN_CHANNEL, greenDC); // Set RGB LED red green duty cycle.
    ledcWrite(PWM_BLUE_CHANNEL, blueDC); // Set RGB LED red blue duty cycle.
-   Log.verboseln("<setCustRgbColour> Red = %d, Green = %d, Blue = %d.", redDC, greenDC, blueDC);   
+   LOG_VERBOSELN(LOG_MOD_LED, "<setCustRgbColour> Red = %d, Green = %d, Blue = %d.", redDC, greenDC, blueDC);   
 } // setCustRgbColour()
 
 /**
@@ -167,22 +167,22 @@ void setStdRgbColour(uint8_t ledColour)
    if(ledColour - 1 > numColoursSupported) // 8 predefined colours (7 and below valid).
    {
       ledColour = GREEN;
-      Log.warningln("<setStdRgbColour> Requested colour %d unknown. Setting RGB LED to %s.", statusColour[ledColour].name.c_str());
+      LOG_WARNINGLN(LOG_MOD_LED, "<setStdRgbColour> Requested colour %d unknown. Setting RGB LED to %s.", statusColour[ledColour].name.c_str());
    } // if
    else
    {
-      Log.verboseln("<setStdRgbColour> Set status RGB LED to %s.", statusColour[ledColour].name.c_str());
+      LOG_VERBOSELN(LOG_MOD_LED, "<setStdRgbColour> Set status RGB LED to %s.", statusColour[ledColour].name.c_str());
    } // else
    if(commonAnode) // RGB LED has commmon anode. 
    {   
-      Log.verboseln("<setStdRgbColour> RGB LED has common anode. Inverting duty cycle values.");
+      LOG_VERBOSELN(LOG_MOD_LED, "<setStdRgbColour> RGB LED has common anode. Inverting duty cycle values.");
       redDC = 256 - statusColour[ledColour].redDutyCycle; // Invert red duty cycle.
       greenDC = 256 - statusColour[ledColour].greenDutyCycle; // Invert green duty cycle.
       blueDC = 256 - statusColour[ledColour].blueDutyCycle; // Invert blue duty cycle.
    } //if
    else // RGB LED has commmon cathode.
    {
-      Log.verboseln("<setStdRgbColour> RGB LED has common cathode. Use unaltered duty cycle values.");
+      LOG_VERBOSELN(LOG_MOD_LED, "<setStdRgbColour> RGB LED has common cathode. Use unaltered duty cycle values.");
       redDC = statusColour[ledColour].redDutyCycle; 
       greenDC = statusColour[ledColour].greenDutyCycle;
       blueDC = statusColour[ledColour].blueDutyCycle;
@@ -190,7 +190,7 @@ void setStdRgbColour(uint8_t ledColour)
    ledcWrite(PWM_RED_CHANNEL, redDC); // Set RGB LED red duty cycle.
    ledcWrite(PWM_GREEN_CHANNEL, greenDC); // Set RGB LED red green duty cycle.
    ledcWrite(PWM_BLUE_CHANNEL, blueDC); // Set RGB LED red blue duty cycle.
-   Log.verboseln("<setStdRgbColour> Red = %d, Green = %d, Blue = %d.", redDC, greenDC, blueDC);
+   LOG_VERBOSELN(LOG_MOD_LED, "<setStdRgbColour> Red = %d, Green = %d, Blue = %d.", redDC, greenDC, blueDC);
 } // setStdRgbColour()
 
 /**
@@ -202,7 +202,7 @@ void setStdRgbColour(uint8_t ledColour)
 void setupStatusLed()
 {
    createPredefinedColours(); // Create predefined colour settings.
-   Log.traceln("<setupStatusLed> Initialize status RGB LED on reset button.");
+   LOG_TRACELN(LOG_MOD_LED, "<setupStatusLed> Initialize status RGB LED on reset button.");
    pinMode(resetRedLED, OUTPUT); // Set GPIO pin connected to red LED inside of the reset button RGB LED to output.
    pinMode(resetBlueLED, OUTPUT); // Set GPIO pin connected to green LED inside of the reset button RGB LED to output.
    pinMode(resetGreenLED, OUTPUT); // Set GPIO pin connected to blue LED inside of the reset button RGB LED to output.
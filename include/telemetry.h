@@ -0,0 +1,173 @@
+#ifndef telemetry_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define telemetry_h // Precompiler macro used for precompiler check.
+
+#include <main.h> // Header file for all libraries needed by this program.
+#include <amTelemetry.h> // Batching MQTT publisher.
+#include <amTelemetrySchema.h> // Binary state and health samples.
+#include <amRing.h> // Lock free hand off from the balance task.
+
+/**
+ * @brief MQTT telemetry.
+ * @details Topics are built once, in initTelemetry(). Streamed samples are 
+ * batched into one QoS 0 message per stream every TELEMETRY_BATCH_MS and events
+ * go out at QoS 1 as they happen. Nothing is handed to the MQTT client unless 
+ * it can write it straight away, so a slow link drops old batches and refuses
+ * events, and shows up in the TELEMETRY command's counters, instead of filling
+ * the client's queue.
+ * 
+ * Four topics below <unique name>/:
+ * - state: tlmState samples at TELEMETRY_STATE_US, captured by the balance 
+ *   task. About 3kB/s with the batch headers, or 25kbit/s, at 100Hz.
+ * - health: tlmHealth samples every TELEMETRY_HEALTH_MS, sent as they come.
+ * - i2c: a tlmI2c sample for each address on each bus every TELEMETRY_I2C_MS,
+ *   with counts since the bus statistics were last reset.
+ * - events: text, e.g. the boot message.
+ * Samples are in the binary layout of amTelemetrySchema.h. Record them with
+ * mosquitto_sub and read them back with native/tools/tlmDecode.cpp.
+ * 
+ * The balance task only copies its readings into telemetryStates. loop() 
+ * encodes them straight into the batch frame, so the balance loop never waits 
+ * on the publisher or the network.
+ * ==========================================================================*/
+const uint16_t TELEMETRY_BATCH_MS = 100; // Longest a streamed sample waits before its batch is sent.
+const uint32_t TELEMETRY_STATE_US = 10000; // State sample period. 100Hz.
+const uint16_t TELEMETRY_HEALTH_MS = 1000; // Health sample period.
+const uint16_t TELEMETRY_I2C_MS = 10000; // I2C sample period.
+
+/**
+ * @brief One state reading on its way from the balance task to loop().
+ * ==========================================================================*/
+struct telemetryStateEntry
+{
+   uint32_t ms; // millis() when captured.
+   tlmState state; // Reading.
+}; // struct
+
+void balanceHealth(tlmHealth* health); // Balance loop timing. Defined in balance.h.
+void i2cTelemetry(int8_t stream, uint32_t nowMs); // Bus use of each I2C address. Defined in i2c.h.
+
+/**
+ * @brief Hand a telemetry message to the MQTT client.
+ * ==========================================================================*/
+bool telemetrySend(void*, const char* topic, uint8_t qos, const uint8_t* payload, size_t len)
+{
+   return aaMqtt::publishRaw(topic, qos, payload, len);
+} // telemetrySend()
+
+/**
+ * @brief Ask the MQTT client whether a packet this size would go straight out.
+ * ==========================================================================*/
+bool telemetryReady(void*, size_t wireBytes)
+{
+   return aaMqtt::isSendReady(wireBytes);
+} // telemetryReady()
+
+amTelemetry telemetry(telemetrySend, telemetryReady, nullptr); // Publisher for every stream and event.
+amRing<16, sizeof(telemetryStateEntry), RING_DROP_OLDEST> telemetryStates; // Balance task to loop(). 160ms of slack at 100Hz.
+int8_t stateStream = -1; // <unique name>/state.
+int8_t healthStream = -1; // <unique name>/health.
+int8_t bootEvents = -1; // <unique name>/events.
+int8_t i2cStream = -1; // <unique name>/i2c.
+uint32_t telemetryHealthMs = 0; // When the last health sample was taken.
+uint32_t telemetryI2cMs = 0; // When the last I2C samples were taken.
+
+/**
+ * @brief Build the telemetry topics.
+ * @param uniqueName Unique name of this robot, the first level below the top of the tree.
+ * @return false if a topic could not be registered.
+ * ==========================================================================*/
+bool initTelemetry(const char* uniqueName)
+{
+   char name[TLM_TOPIC_LEN]; // Topic below the top of the tree.
+   if(stateStream < 0)
+   {
+      snprintf(name, sizeof(name), "%s/state", uniqueName);
+      stateStream = telemetry.addStream(TOP_OF_TREE, name, TELEMETRY_BATCH_MS);
+   } // if
+   if(healthStream < 0)
+   {
+      snprintf(name, sizeof(name), "%s/health", uniqueName);
+      healthStream = telemetry.addStream(TOP_OF_TREE, name, 0);
+   } // if
+   if(i2cStream < 0)
+   {
+      snprintf(name, sizeof(name), "%s/i2c", uniqueName);
+      i2cStream = telemetry.addStream(TOP_OF_TREE, name, TELEMETRY_BATCH_MS);
+   } // if
+   if(bootEvents < 0)
+   {
+      snprintf(name, sizeof(name), "%s/events", uniqueName);
+      bootEvents = telemetry.addEvents(TOP_OF_TREE, name);
+   } // if
+   if(stateStream < 0 || healthStream < 0 || i2cStream < 0 || bootEvents < 0)
+   {
+      LOG_ERRORLN(LOG_MOD_MQTT, "<initTelemetry> Topics for %s are too long.", uniqueName);
+      return false;
+   } // if
+   LOG_NOTICELN(LOG_MOD_MQTT, "<initTelemetry> State to %s, health to %s, I2C to %s, events to %s.", telemetry.getStreamTopic(stateStream), 
+      telemetry.getStreamTopic(healthStream), telemetry.getStreamTopic(i2cStream), telemetry.getEventTopic(bootEvents));
+   return true;
+} // initTelemetry()
+
+/**
+ * @brief Take a health sample.
+ * @param nowMs millis().
+ * ==========================================================================*/
+void telemetryHealth(uint32_t nowMs)
+{
+   tlmHealth health;
+   health.uptimeMs = nowMs;
+   health.freeHeap = ESP.getFreeHeap();
+   health.minFreeHeap = ESP.getMinFreeHeap();
+   health.maxAllocHeap = ESP.getMaxAllocHeap();
+   balanceHealth(&health); // Loop period, worst execution time and jitter, overruns.
+   health.telemetryDropped = telemetry.getStats().droppedSamples;
+   health.stateLost = telemetryStates.getDropped() + telemetryStates.getRejected();
+   uint8_t sample[TLM_HEALTH_LEN];
+   tlmEncodeHealth(health, sample);
+   telemetry.sample(healthStream, nowMs, sample, TLM_HEALTH_LEN);
+} // telemetryHealth()
+
+/**
+ * @brief Batch the state samples from the balance task, take health and I2C 
+ * samples when they are due and send the batches whose time is up. Call from 
+ * loop().
+ * ==========================================================================*/
+void checkTelemetry()
+{
+   uint32_t nowMs = millis();
+   if(stateStream >= 0) // Topics built. Before that samples wait, or age out of the ring.
+   {
+      telemetryStateEntry entry;
+      uint16_t len;
+      while(telemetryStates.pop(&entry, sizeof(entry), &len) == true)
+      {
+         tlmEncodeState(entry.state, telemetry.reserve(stateStream, entry.ms, TLM_STATE_LEN)); // Straight into the batch frame.
+      } // while
+      if(nowMs - telemetryHealthMs >= TELEMETRY_HEALTH_MS)
+      {
+         telemetryHealthMs = nowMs;
+         telemetryHealth(nowMs);
+      } // if
+      if(nowMs - telemetryI2cMs >= TELEMETRY_I2C_MS)
+      {
+         telemetryI2cMs = nowMs;
+         i2cTelemetry(i2cStream, nowMs);
+      } // if
+   } // if
+   telemetry.poll(nowMs);
+} // checkTelemetry()
+
+/**
+ * @brief Log the telemetry counters.
+ * ==========================================================================*/
+void showTelemetryStats()
+{
+   tlmStats stats = telemetry.getStats();
+   LOG_NOTICELN(LOG_MOD_MQTT, "<showTelemetryStats> Samples %l in %l batches, %l events, %l bytes on the wire.", (long)stats.samples, (long)stats.batches, (long)stats.events, (long)stats.wireBytes);
+   LOG_NOTICELN(LOG_MOD_MQTT, "<showTelemetryStats> Send window full %l times, samples dropped %l, events refused %l.", (long)stats.deferred, (long)stats.droppedSamples, (long)stats.droppedEvents);
+   LOG_NOTICELN(LOG_MOD_MQTT, "<showTelemetryStats> State samples captured %l, lost before batching %l.", (long)telemetryStates.getPushed(), (long)(telemetryStates.getDropped() + telemetryStates.getRejected()));
+} // showTelemetryStats()
+
+#endif // End of precompiler protected code block
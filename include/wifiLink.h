@@ -0,0 +1,65 @@
+#ifndef wifiLink_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define wifiLink_h // Precompiler macro used for precompiler check.
+
+#include <main.h> // Header file for all libraries needed by this program.
+
+void checkBoot(); // Defined in main.cpp.
+void bootWifiUp(); // Defined in bootSequence.h.
+
+/**
+ * @brief Bring WiFi up without holding up the boot.
+ * @details setup() only starts the connection. checkWifiLink() moves it along
+ * from loop() and, the first time an IP address comes in, starts the web 
+ * server and the MQTT broker connection. The balance loop and everything else
+ * in setup() are running long before that.
+ * ==========================================================================*/
+bool wifiServicesStarted = false; // Web server and MQTT started on the first IP address.
+
+/**
+ * @brief Log each step of bringing WiFi up. Given to network.onProgress().
+ * @param state One of the WF_ states of amWifiLink.
+ * @param nowMs millis() when the step began.
+ * ==========================================================================*/
+void wifiProgress(uint8_t state, uint32_t nowMs)
+{
+   static const char* STATES[] = {"idle", "fast connecting to the last Access Point", "scanning", "joining", "up", "waiting to scan again"};
+   LOG_VERBOSELN(LOG_MOD_WIFI, "<wifiProgress> WiFi %s at %l ms.", STATES[state], (long)nowMs);
+} // wifiProgress()
+
+/**
+ * @brief Look after the WiFi connection. Call from loop().
+ * @details The first time an IP address comes in, records how long it took 
+ * and starts the network services. Boot status is checked again whenever 
+ * WiFi or the MQTT broker comes or goes.
+ * ==========================================================================*/
+void checkWifiLink()
+{
+   static bool lastMqtt = false; // Broker status when boot status was last checked.
+   network.poll(millis());
+   bool connected = network.getLink().getState() == WF_UP; // Have an IP address, and poll() has seen it.
+   if(connected == true && wifiServicesStarted == false)
+   {
+      wifiServicesStarted = true;
+      bootWifiUp(); // Time to IP goes in the boot profile.
+      LOG_NOTICELN(LOG_MOD_WIFI, "<checkWifiLink> Connection to network successfully estabished in %l ms (%s).", 
+                   (long)network.getTimeToIpMs(), network.getLink().getFastWasUsed() ? "fast connect" : "scan");
+      LOG_VERBOSELN(LOG_MOD_WIFI, "<checkWifiLink> Initialize local web services."); 
+      startWebServer(); // Start up web server.
+      LOG_VERBOSELN(LOG_MOD_WIFI, "<checkWifiLink> Initialize MQTT broker connection."); 
+      connectToMqttBroker(network); // checkMqttLink() does the rest.
+      network.cfgToConsole(); // Display network information on the console.
+      if(lcdDevice.isPresent() == true)
+      {
+         displaySplashScreen(); // Now there is an IP address to show.
+      } // if
+   } // if
+   if(connected != networkConnected || mqttBrokerConnected != lastMqtt)
+   {
+      networkConnected = connected;
+      lastMqtt = mqttBrokerConnected;
+      checkBoot(); // Update the status LED.
+   } // if
+} // checkWifiLink()
+
+#endif // End of precompiler protected code block
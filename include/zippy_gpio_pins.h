@@ -16,5 +16,6 @@
 #define resetRedLED PIN_LBL_27 // Red LED in reset button, physical pin 23
 #define resetBlueLED PIN_LBL_33 // Blue LED in reset button, physical pin 22
 #define resetGreenLED PIN_LBL_15 // Green LED in reset button, physical pin 21
+#define imuInterruptPin PIN_LBL_A4 // MPU6050 INT (data ready), physical pin 9. Input only pin
 
 #endif // End of conditional preprocessor code
\ No newline at end of file
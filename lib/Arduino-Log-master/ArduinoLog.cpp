@@ -204,7 +204,7 @@ void Logging::printFormat(const char format, va_list *args) {
 	}
 	else if (format == 'p')
 	{		
-		register Printable *obj = (Printable *) va_arg(*args, int);
+		register Printable *obj = (Printable *) va_arg(*args, Printable *);
 		_logOutput->print(*obj);
 	}
 	else if (format == 'b')
@@ -41,7 +41,8 @@ AsyncMqttClient::AsyncMqttClient()
 , _currentParsedPacket(nullptr)
 , _remainingLengthBufferPosition(0)
 , _remainingLengthBuffer{0}
-, _pendingPubRels() {
+, _pendingPubRels()
+, _pendingPubRelCount(0) {
   _client.onConnect([](void* obj, AsyncClient* c) { (static_cast<AsyncMqttClient*>(obj))->_onConnect(); }, this);
   _client.onDisconnect([](void* obj, AsyncClient* c) { (static_cast<AsyncMqttClient*>(obj))->_onDisconnect(); }, this);
   // _client.onError([](void* obj, AsyncClient* c, int8_t error) { (static_cast<AsyncMqttClient*>(obj))->_onError(error); }, this);
@@ -62,11 +63,10 @@ AsyncMqttClient::AsyncMqttClient()
 }
 
 AsyncMqttClient::~AsyncMqttClient() {
-  delete _currentParsedPacket;
+  _freeCurrentParsedPacket();
   delete[] _parsingInformation.topicBuffer;
   _clear();
-  _pendingPubRels.clear();
-  _pendingPubRels.shrink_to_fit();
+  _pendingPubRelCount = 0;
   _clearQueue(false);  // _clear() doesn't clear session data
 #ifdef ESP32
   vSemaphoreDelete(_xSemaphore);
@@ -169,7 +169,7 @@ AsyncMqttClient& AsyncMqttClient::onPublish(AsyncMqttClientInternals::OnPublishU
 }
 
 void AsyncMqttClient::_freeCurrentParsedPacket() {
-  delete _currentParsedPacket;
+  if (_currentParsedPacket) _currentParsedPacket->~Packet();
   _currentParsedPacket = nullptr;
 }
 
@@ -226,7 +226,7 @@ void AsyncMqttClient::_onDisconnect() {
 
   _clear();
 
-  for (auto callback : _onDisconnectUserCallbacks) callback(_disconnectReason);
+  for (const auto& callback : _onDisconnectUserCallbacks) callback(_disconnectReason);
 }
 
 /*
@@ -248,7 +248,7 @@ void AsyncMqttClient::_onAck(size_t len) {
 void AsyncMqttClient::_onData(char* data, size_t len) {
   log_i("data rcv (%u)", len);
   size_t currentBytePosition = 0;
-  char currentByte;
+  uint8_t currentByte;
   _lastServerActivity = millis();
   do {
     switch (_parsingInformation.bufferState) {
@@ -257,43 +257,47 @@ void AsyncMqttClient::_onData(char* data, size_t len) {
         _parsingInformation.packetType = currentByte >> 4;
         _parsingInformation.packetFlags = (currentByte << 4) >> 4;
         _parsingInformation.bufferState = AsyncMqttClientInternals::BufferState::REMAINING_LENGTH;
+        _freeCurrentParsedPacket();
         switch (_parsingInformation.packetType) {
           case AsyncMqttClientInternals::PacketType.CONNACK:
             log_i("rcv CONNACK");
-            _currentParsedPacket = new AsyncMqttClientInternals::ConnAckPacket(&_parsingInformation, std::bind(&AsyncMqttClient::_onConnAck, this, std::placeholders::_1, std::placeholders::_2));
+            _currentParsedPacket = new (&_parsedPacketStorage) AsyncMqttClientInternals::ConnAckPacket(&_parsingInformation, [](void* obj, bool sessionPresent, uint8_t connectReturnCode) { (static_cast<AsyncMqttClient*>(obj))->_onConnAck(sessionPresent, connectReturnCode); }, this);
             _client.setRxTimeout(0);
             break;
           case AsyncMqttClientInternals::PacketType.PINGRESP:
             log_i("rcv PINGRESP");
-            _currentParsedPacket = new AsyncMqttClientInternals::PingRespPacket(&_parsingInformation, std::bind(&AsyncMqttClient::_onPingResp, this));
+            _currentParsedPacket = new (&_parsedPacketStorage) AsyncMqttClientInternals::PingRespPacket(&_parsingInformation, [](void* obj) { (static_cast<AsyncMqttClient*>(obj))->_onPingResp(); }, this);
             break;
           case AsyncMqttClientInternals::PacketType.SUBACK:
             log_i("rcv SUBACK");
-            _currentParsedPacket = new AsyncMqttClientInternals::SubAckPacket(&_parsingInformation, std::bind(&AsyncMqttClient::_onSubAck, this, std::placeholders::_1, std::placeholders::_2));
+            _currentParsedPacket = new (&_parsedPacketStorage) AsyncMqttClientInternals::SubAckPacket(&_parsingInformation, [](void* obj, uint16_t packetId, char status) { (static_cast<AsyncMqttClient*>(obj))->_onSubAck(packetId, status); }, this);
             break;
           case AsyncMqttClientInternals::PacketType.UNSUBACK:
             log_i("rcv UNSUBACK");
-            _currentParsedPacket = new AsyncMqttClientInternals::UnsubAckPacket(&_parsingInformation, std::bind(&AsyncMqttClient::_onUnsubAck, this, std::placeholders::_1));
+            _currentParsedPacket = new (&_parsedPacketStorage) AsyncMqttClientInternals::UnsubAckPacket(&_parsingInformation, [](void* obj, uint16_t packetId) { (static_cast<AsyncMqttClient*>(obj))->_onUnsubAck(packetId); }, this);
             break;
           case AsyncMqttClientInternals::PacketType.PUBLISH:
             log_i("rcv PUBLISH");
-            _currentParsedPacket = new AsyncMqttClientInternals::PublishPacket(&_parsingInformation, std::bind(&AsyncMqttClient::_onMessage, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4, std::placeholders::_5, std::placeholders::_6, std::placeholders::_7, std::placeholders::_8, std::placeholders::_9), std::bind(&AsyncMqttClient::_onPublish, this, std::placeholders::_1, std::placeholders::_2));
+            _currentParsedPacket = new (&_parsedPacketStorage) AsyncMqttClientInternals::PublishPacket(&_parsingInformation,
+              [](void* obj, char* topic, char* payload, uint8_t qos, bool dup, bool retain, size_t len, size_t index, size_t total, uint16_t packetId) { (static_cast<AsyncMqttClient*>(obj))->_onMessage(topic, payload, qos, dup, retain, len, index, total, packetId); },
+              [](void* obj, uint16_t packetId, uint8_t qos) { (static_cast<AsyncMqttClient*>(obj))->_onPublish(packetId, qos); },
+              this);
             break;
           case AsyncMqttClientInternals::PacketType.PUBREL:
             log_i("rcv PUBREL");
-            _currentParsedPacket = new AsyncMqttClientInternals::PubRelPacket(&_parsingInformation, std::bind(&AsyncMqttClient::_onPubRel, this, std::placeholders::_1));
+            _currentParsedPacket = new (&_parsedPacketStorage) AsyncMqttClientInternals::PubRelPacket(&_parsingInformation, [](void* obj, uint16_t packetId) { (static_cast<AsyncMqttClient*>(obj))->_onPubRel(packetId); }, this);
             break;
           case AsyncMqttClientInternals::PacketType.PUBACK:
             log_i("rcv PUBACK");
-            _currentParsedPacket = new AsyncMqttClientInternals::PubAckPacket(&_parsingInformation, std::bind(&AsyncMqttClient::_onPubAck, this, std::placeholders::_1));
+            _currentParsedPacket = new (&_parsedPacketStorage) AsyncMqttClientInternals::PubAckPacket(&_parsingInformation, [](void* obj, uint16_t packetId) { (static_cast<AsyncMqttClient*>(obj))->_onPubAck(packetId); }, this);
             break;
           case AsyncMqttClientInternals::PacketType.PUBREC:
             log_i("rcv PUBREC");
-            _currentParsedPacket = new AsyncMqttClientInternals::PubRecPacket(&_parsingInformation, std::bind(&AsyncMqttClient::_onPubRec, this, std::placeholders::_1));
+            _currentParsedPacket = new (&_parsedPacketStorage) AsyncMqttClientInternals::PubRecPacket(&_parsingInformation, [](void* obj, uint16_t packetId) { (static_cast<AsyncMqttClient*>(obj))->_onPubRec(packetId); }, this);
             break;
           case AsyncMqttClientInternals::PacketType.PUBCOMP:
             log_i("rcv PUBCOMP");
-            _currentParsedPacket = new AsyncMqttClientInternals::PubCompPacket(&_parsingInformation, std::bind(&AsyncMqttClient::_onPubComp, this, std::placeholders::_1));
+            _currentParsedPacket = new (&_parsedPacketStorage) AsyncMqttClientInternals::PubCompPacket(&_parsingInformation, [](void* obj, uint16_t packetId) { (static_cast<AsyncMqttClient*>(obj))->_onPubComp(packetId); }, this);
             break;
           default:
             log_i("rcv PROTOCOL VIOLATION");
@@ -504,14 +508,13 @@ void AsyncMqttClient::_onConnAck(bool sessionPresent, uint8_t connectReturnCode)
   _freeCurrentParsedPacket();
 
   if (!sessionPresent) {
-    _pendingPubRels.clear();
-    _pendingPubRels.shrink_to_fit();
+    _pendingPubRelCount = 0;
     _clearQueue(false);  // remove session data
   }
 
   if (connectReturnCode == 0) {
     _state = CONNECTED;
-    for (auto callback : _onConnectUserCallbacks) callback(sessionPresent);
+    for (const auto& callback : _onConnectUserCallbacks) callback(sessionPresent);
   } else {
     // Callbacks are handled by the onDisconnect function which is called from the AsyncTcp lib
     _disconnectReason = static_cast<AsyncMqttClientDisconnectReason>(connectReturnCode);
@@ -530,7 +533,7 @@ void AsyncMqttClient::_onSubAck(uint16_t packetId, char status) {
   }
   SEMAPHORE_GIVE();
 
-  for (auto callback : _onSubscribeUserCallbacks) callback(packetId, status);
+  for (const auto& callback : _onSubscribeUserCallbacks) callback(packetId, status);
 
   _handleQueue();  // subscribe confirmed, ready to send next queued item
 }
@@ -545,7 +548,7 @@ void AsyncMqttClient::_onUnsubAck(uint16_t packetId) {
   }
   SEMAPHORE_GIVE();
 
-  for (auto callback : _onUnsubscribeUserCallbacks) callback(packetId);
+  for (const auto& callback : _onUnsubscribeUserCallbacks) callback(packetId);
 
   _handleQueue();  // unsubscribe confirmed, ready to send next queued item
 }
@@ -554,8 +557,8 @@ void AsyncMqttClient::_onMessage(char* topic, char* payload, uint8_t qos, bool d
   bool notifyPublish = true;
 
   if (qos == 2) {
-    for (AsyncMqttClientInternals::PendingPubRel pendingPubRel : _pendingPubRels) {
-      if (pendingPubRel.packetId == packetId) {
+    for (size_t i = 0; i < _pendingPubRelCount; i++) {
+      if (_pendingPubRels[i].packetId == packetId) {
         notifyPublish = false;
         break;
       }
@@ -568,7 +571,7 @@ void AsyncMqttClient::_onMessage(char* topic, char* payload, uint8_t qos, bool d
     properties.dup = dup;
     properties.retain = retain;
 
-    for (auto callback : _onMessageUserCallbacks) callback(topic, payload, properties, len, index, total);
+    for (const auto& callback : _onMessageUserCallbacks) callback(topic, payload, properties, len, index, total);
   }
 }
 
@@ -589,17 +592,19 @@ void AsyncMqttClient::_onPublish(uint16_t packetId, uint8_t qos) {
     _addBack(msg);
 
     bool pubRelAwaiting = false;
-    for (AsyncMqttClientInternals::PendingPubRel pendingPubRel : _pendingPubRels) {
-      if (pendingPubRel.packetId == packetId) {
+    for (size_t i = 0; i < _pendingPubRelCount; i++) {
+      if (_pendingPubRels[i].packetId == packetId) {
         pubRelAwaiting = true;
         break;
       }
     }
 
     if (!pubRelAwaiting) {
-      AsyncMqttClientInternals::PendingPubRel pendingPubRel;
-      pendingPubRel.packetId = packetId;
-      _pendingPubRels.push_back(pendingPubRel);
+      if (_pendingPubRelCount < MQTT_MAX_PENDING_PUBRELS) {
+        _pendingPubRels[_pendingPubRelCount++].packetId = packetId;
+      } else {
+        log_w("PUBREL table full");
+      }
     }
   }
 
@@ -620,10 +625,10 @@ void AsyncMqttClient::_onPubRel(uint16_t packetId) {
     log_i("PUBREC released");
   }
 
-  for (size_t i = 0; i < _pendingPubRels.size(); i++) {
+  for (size_t i = 0; i < _pendingPubRelCount; i++) {
     if (_pendingPubRels[i].packetId == packetId) {
-      _pendingPubRels.erase(_pendingPubRels.begin() + i);
-      _pendingPubRels.shrink_to_fit();
+      _pendingPubRels[i] = _pendingPubRels[--_pendingPubRelCount];
+      break;
     }
   }
 }
@@ -635,7 +640,7 @@ void AsyncMqttClient::_onPubAck(uint16_t packetId) {
     log_i("PUB released");
   }
 
-  for (auto callback : _onPublishUserCallbacks) callback(packetId);
+  for (const auto& callback : _onPublishUserCallbacks) callback(packetId);
 }
 
 void AsyncMqttClient::_onPubRec(uint16_t packetId) {
@@ -667,7 +672,7 @@ void AsyncMqttClient::_onPubComp(uint16_t packetId) {
     log_i("PUBREL released");
   }
 
-  for (auto callback : _onPublishUserCallbacks) callback(packetId);
+  for (const auto& callback : _onPublishUserCallbacks) callback(packetId);
 }
 
 void AsyncMqttClient::_sendPing() {
@@ -722,8 +727,10 @@ uint16_t AsyncMqttClient::subscribe(const char* topic, uint8_t qos) {
   log_i("SUBSCRIBE");
 
   AsyncMqttClientInternals::OutPacket* msg = new AsyncMqttClientInternals::SubscribeOutPacket(topic, qos);
+  // A QoS 0 packet can be sent and freed inside _addBack(), and an acknowledged one on the TCP task, so read the id first.
+  uint16_t packetId = msg->packetId();
   _addBack(msg);
-  return msg->packetId();
+  return packetId;
 }
 
 uint16_t AsyncMqttClient::unsubscribe(const char* topic) {
@@ -731,8 +738,10 @@ uint16_t AsyncMqttClient::unsubscribe(const char* topic) {
   log_i("UNSUBSCRIBE");
 
   AsyncMqttClientInternals::OutPacket* msg = new AsyncMqttClientInternals::UnsubscribeOutPacket(topic);
+  // A QoS 0 packet can be sent and freed inside _addBack(), and an acknowledged one on the TCP task, so read the id first.
+  uint16_t packetId = msg->packetId();
   _addBack(msg);
-  return msg->packetId();
+  return packetId;
 }
 
 uint16_t AsyncMqttClient::publish(const char* topic, uint8_t qos, bool retain, const char* payload, size_t length, bool dup, uint16_t message_id) {
@@ -740,8 +749,10 @@ uint16_t AsyncMqttClient::publish(const char* topic, uint8_t qos, bool retain, c
   log_i("PUBLISH");
 
   AsyncMqttClientInternals::OutPacket* msg = new AsyncMqttClientInternals::PublishOutPacket(topic, qos, retain, payload, length);
+  // A QoS 0 packet can be sent and freed inside _addBack(), and an acknowledged one on the TCP task, so read the id first.
+  uint16_t packetId = msg->packetId();
   _addBack(msg);
-  return msg->packetId();
+  return packetId;
 }
 
 bool AsyncMqttClient::clearQueue() {
@@ -750,6 +761,22 @@ bool AsyncMqttClient::clearQueue() {
   return true;
 }
 
+bool AsyncMqttClient::isSendReady(size_t length) {
+  if (_state != CONNECTED) return false;
+  SEMAPHORE_TAKE();
+  bool ready = !_head && _client.space() >= length;
+  SEMAPHORE_GIVE();
+  return ready;
+}
+
 const char* AsyncMqttClient::getClientId() const {
   return _clientId;
 }
+
+AsyncMqttClientPoolStats AsyncMqttClient::getPacketPoolStats() {
+  return AsyncMqttClientInternals::OutPacket::packetPoolStats();
+}
+
+AsyncMqttClientPoolStats AsyncMqttClient::getBufferPoolStats() {
+  return AsyncMqttClientInternals::OutPacket::bufferPoolStats();
+}
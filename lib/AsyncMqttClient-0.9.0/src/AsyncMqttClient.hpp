@@ -2,6 +2,7 @@
 
 #include <functional>
 #include <vector>
+#include <type_traits>
 
 #include "Arduino.h"
 
@@ -9,6 +10,12 @@
 #define MQTT_MIN_FREE_MEMORY 4096
 #endif
 
+// QoS 2 messages received but not yet released by the broker. Redelivery of a message past this
+// limit is passed to onMessage again.
+#ifndef MQTT_MAX_PENDING_PUBRELS
+#define MQTT_MAX_PENDING_PUBRELS 8
+#endif
+
 #ifdef ESP32
 #include <AsyncTCP.h>
 #include <freertos/semphr.h>
@@ -30,6 +37,7 @@
 #include "AsyncMqttClient/Callbacks.hpp"
 #include "AsyncMqttClient/DisconnectReasons.hpp"
 #include "AsyncMqttClient/Storage.hpp"
+#include "AsyncMqttClient/Pool.hpp"
 
 #include "AsyncMqttClient/Packets/Packet.hpp"
 #include "AsyncMqttClient/Packets/ConnAckPacket.hpp"
@@ -82,9 +90,15 @@ class AsyncMqttClient {
   uint16_t unsubscribe(const char* topic);
   uint16_t publish(const char* topic, uint8_t qos, bool retain, const char* payload = nullptr, size_t length = 0, bool dup = false, uint16_t message_id = 0);
   bool clearQueue();  // Not MQTT compliant!
+  // True when a packet of length bytes would go straight onto the wire: connected, nothing queued
+  // ahead of it (including unacknowledged QoS 1 and 2 packets) and room for all of it in the TCP send window.
+  bool isSendReady(size_t length);
 
   const char* getClientId() const;
 
+  static AsyncMqttClientPoolStats getPacketPoolStats();
+  static AsyncMqttClientPoolStats getBufferPoolStats();
+
  private:
   AsyncClient _client;
   AsyncMqttClientInternals::OutPacket* _head;
@@ -133,10 +147,22 @@ class AsyncMqttClient {
 
   AsyncMqttClientInternals::ParsingInformation _parsingInformation;
   AsyncMqttClientInternals::Packet* _currentParsedPacket;
+  // Only one incoming packet is parsed at a time, so its parser is built in place here.
+  std::aligned_union<0,
+                     AsyncMqttClientInternals::ConnAckPacket,
+                     AsyncMqttClientInternals::PingRespPacket,
+                     AsyncMqttClientInternals::SubAckPacket,
+                     AsyncMqttClientInternals::UnsubAckPacket,
+                     AsyncMqttClientInternals::PublishPacket,
+                     AsyncMqttClientInternals::PubRelPacket,
+                     AsyncMqttClientInternals::PubAckPacket,
+                     AsyncMqttClientInternals::PubRecPacket,
+                     AsyncMqttClientInternals::PubCompPacket>::type _parsedPacketStorage;
   uint8_t _remainingLengthBufferPosition;
   char _remainingLengthBuffer[4];
 
-  std::vector<AsyncMqttClientInternals::PendingPubRel> _pendingPubRels;
+  AsyncMqttClientInternals::PendingPubRel _pendingPubRels[MQTT_MAX_PENDING_PUBRELS];
+  uint8_t _pendingPubRelCount;
 
 #if defined(ESP32)
   SemaphoreHandle_t _xSemaphore = nullptr;
@@ -16,15 +16,15 @@ typedef std::function<void(char* topic, char* payload, AsyncMqttClientMessagePro
 typedef std::function<void(uint16_t packetId)> OnPublishUserCallback;
 typedef std::function<void(uint16_t packetId, AsyncMqttClientError error)> OnErrorUserCallback;
 
-// internal callbacks
-typedef std::function<void(bool sessionPresent, uint8_t connectReturnCode)> OnConnAckInternalCallback;
-typedef std::function<void()> OnPingRespInternalCallback;
-typedef std::function<void(uint16_t packetId, char status)> OnSubAckInternalCallback;
-typedef std::function<void(uint16_t packetId)> OnUnsubAckInternalCallback;
-typedef std::function<void(char* topic, char* payload, uint8_t qos, bool dup, bool retain, size_t len, size_t index, size_t total, uint16_t packetId)> OnMessageInternalCallback;
-typedef std::function<void(uint16_t packetId, uint8_t qos)> OnPublishInternalCallback;
-typedef std::function<void(uint16_t packetId)> OnPubRelInternalCallback;
-typedef std::function<void(uint16_t packetId)> OnPubAckInternalCallback;
-typedef std::function<void(uint16_t packetId)> OnPubRecInternalCallback;
-typedef std::function<void(uint16_t packetId)> OnPubCompInternalCallback;
+// internal callbacks, plain function pointers so the packet parsers can be built without allocating
+typedef void (*OnConnAckInternalCallback)(void* arg, bool sessionPresent, uint8_t connectReturnCode);
+typedef void (*OnPingRespInternalCallback)(void* arg);
+typedef void (*OnSubAckInternalCallback)(void* arg, uint16_t packetId, char status);
+typedef void (*OnUnsubAckInternalCallback)(void* arg, uint16_t packetId);
+typedef void (*OnMessageInternalCallback)(void* arg, char* topic, char* payload, uint8_t qos, bool dup, bool retain, size_t len, size_t index, size_t total, uint16_t packetId);
+typedef void (*OnPublishInternalCallback)(void* arg, uint16_t packetId, uint8_t qos);
+typedef void (*OnPubRelInternalCallback)(void* arg, uint16_t packetId);
+typedef void (*OnPubAckInternalCallback)(void* arg, uint16_t packetId);
+typedef void (*OnPubRecInternalCallback)(void* arg, uint16_t packetId);
+typedef void (*OnPubCompInternalCallback)(void* arg, uint16_t packetId);
 }  // namespace AsyncMqttClientInternals
@@ -2,9 +2,10 @@
 
 using AsyncMqttClientInternals::ConnAckPacket;
 
-ConnAckPacket::ConnAckPacket(ParsingInformation* parsingInformation, OnConnAckInternalCallback callback)
+ConnAckPacket::ConnAckPacket(ParsingInformation* parsingInformation, OnConnAckInternalCallback callback, void* callbackArg)
 : _parsingInformation(parsingInformation)
 , _callback(callback)
+, _callbackArg(callbackArg)
 , _bytePosition(0)
 , _sessionPresent(false)
 , _connectReturnCode(0) {
@@ -14,13 +15,13 @@ ConnAckPacket::~ConnAckPacket() {
 }
 
 void ConnAckPacket::parseVariableHeader(char* data, size_t len, size_t* currentBytePosition) {
-  char currentByte = data[(*currentBytePosition)++];
+  uint8_t currentByte = data[(*currentBytePosition)++];
   if (_bytePosition++ == 0) {
     _sessionPresent = (currentByte << 7) >> 7;
   } else {
     _connectReturnCode = currentByte;
     _parsingInformation->bufferState = BufferState::NONE;
-    _callback(_sessionPresent, _connectReturnCode);
+    _callback(_callbackArg, _sessionPresent, _connectReturnCode);
   }
 }
 
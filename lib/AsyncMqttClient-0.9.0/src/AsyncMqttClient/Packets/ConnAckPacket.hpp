@@ -8,7 +8,7 @@
 namespace AsyncMqttClientInternals {
 class ConnAckPacket : public Packet {
  public:
-  explicit ConnAckPacket(ParsingInformation* parsingInformation, OnConnAckInternalCallback callback);
+  explicit ConnAckPacket(ParsingInformation* parsingInformation, OnConnAckInternalCallback callback, void* callbackArg);
   ~ConnAckPacket();
 
   void parseVariableHeader(char* data, size_t len, size_t* currentBytePosition);
@@ -17,6 +17,7 @@ class ConnAckPacket : public Packet {
  private:
   ParsingInformation* _parsingInformation;
   OnConnAckInternalCallback _callback;
+  void* _callbackArg;
 
   uint8_t _bytePosition;
   bool _sessionPresent;
@@ -116,47 +116,64 @@ ConnectOutPacket::ConnectOutPacket(bool cleanSession,
     neededSpace += passwordLength;
   }
 
-  _data.reserve(neededSpace);
+  _data = _allocateBuffer(neededSpace);
+  _size = 0;
 
-  _data.insert(_data.end(), fixedHeader, fixedHeader + 1 + remainingLengthLength);
+  memcpy(_data + _size, fixedHeader, 1 + remainingLengthLength);
+  _size += 1 + remainingLengthLength;
 
-  _data.push_back(protocolNameLengthBytes[0]);
-  _data.push_back(protocolNameLengthBytes[1]);
+  _data[_size++] = protocolNameLengthBytes[0];
+  _data[_size++] = protocolNameLengthBytes[1];
 
-  _data.push_back('M');
-  _data.push_back('Q');
-  _data.push_back('T');
-  _data.push_back('T');
+  _data[_size++] = 'M';
+  _data[_size++] = 'Q';
+  _data[_size++] = 'T';
+  _data[_size++] = 'T';
 
-  _data.push_back(protocolLevel[0]);
-  _data.push_back(connectFlags[0]);
-  _data.push_back(keepAliveBytes[0]);
-  _data.push_back(keepAliveBytes[1]);
-  _data.push_back(clientIdLengthBytes[0]);
-  _data.push_back(clientIdLengthBytes[1]);
+  _data[_size++] = protocolLevel[0];
+  _data[_size++] = connectFlags[0];
+  _data[_size++] = keepAliveBytes[0];
+  _data[_size++] = keepAliveBytes[1];
+  _data[_size++] = clientIdLengthBytes[0];
+  _data[_size++] = clientIdLengthBytes[1];
 
-  _data.insert(_data.end(), clientId, clientId + clientIdLength);
+  memcpy(_data + _size, clientId, clientIdLength);
+  _size += clientIdLength;
   if (willTopic != nullptr) {
-    _data.insert(_data.end(), willTopicLengthBytes, willTopicLengthBytes + 2);
-    _data.insert(_data.end(), willTopic, willTopic + willTopicLength);
-
-    _data.insert(_data.end(), willPayloadLengthBytes, willPayloadLengthBytes + 2);
-    if (willPayload != nullptr) _data.insert(_data.end(), willPayload, willPayload + willPayloadLength);
+    memcpy(_data + _size, willTopicLengthBytes, 2);
+    _size += 2;
+    memcpy(_data + _size, willTopic, willTopicLength);
+    _size += willTopicLength;
+
+    memcpy(_data + _size, willPayloadLengthBytes, 2);
+    _size += 2;
+    if (willPayload != nullptr) {
+      memcpy(_data + _size, willPayload, willPayloadLength);
+      _size += willPayloadLength;
+    }
   }
   if (username != nullptr) {
-    _data.insert(_data.end(), usernameLengthBytes, usernameLengthBytes + 2);
-    _data.insert(_data.end(), username, username + usernameLength);
+    memcpy(_data + _size, usernameLengthBytes, 2);
+    _size += 2;
+    memcpy(_data + _size, username, usernameLength);
+    _size += usernameLength;
   }
   if (password != nullptr) {
-    _data.insert(_data.end(), passwordLengthBytes, passwordLengthBytes + 2);
-    _data.insert(_data.end(), password, password + passwordLength);
+    memcpy(_data + _size, passwordLengthBytes, 2);
+    _size += 2;
+    memcpy(_data + _size, password, passwordLength);
+    _size += passwordLength;
   }
 }
 
+ConnectOutPacket::~ConnectOutPacket() {
+  _releaseBuffer(_data);
+}
+
 const uint8_t* ConnectOutPacket::data(size_t index) const {
-  return &_data.data()[index];
+  return &_data[index];
 }
 
 size_t ConnectOutPacket::size() const {
-  return _data.size();
+  return _size;
 }
@@ -1,7 +1,6 @@
 #pragma once
 
-#include <vector>
-#include <cstring>  // strlen
+#include <cstring>  // strlen, memcpy
 
 #include "OutPacket.hpp"
 #include "../../Flags.hpp"
@@ -20,10 +19,12 @@ class ConnectOutPacket : public OutPacket {
                    uint16_t willPayloadLength,
                    uint16_t keepAlive,
                    const char* clientId);
+  ~ConnectOutPacket();
   const uint8_t* data(size_t index = 0) const;
   size_t size() const;
 
  private:
-  std::vector<uint8_t> _data;
+  uint8_t* _data;
+  size_t _size;
 };
 }  // namespace AsyncMqttClientInternals
@@ -1,4 +1,11 @@
 #include "OutPacket.hpp"
+#include "Connect.hpp"
+#include "Disconn.hpp"
+#include "PingReq.hpp"
+#include "PubAck.hpp"
+#include "Publish.hpp"
+#include "Subscribe.hpp"
+#include "Unsubscribe.hpp"
 
 using AsyncMqttClientInternals::OutPacket;
 
@@ -42,3 +49,40 @@ uint16_t OutPacket::_getNextPacketId() {
   }
   return _nextPacketId;
 }
+
+// Sized for the largest packet object. The bytes of variable length packets live in _bufferPool.
+typedef std::aligned_union<0,
+                           AsyncMqttClientInternals::ConnectOutPacket,
+                           AsyncMqttClientInternals::DisconnOutPacket,
+                           AsyncMqttClientInternals::PingReqOutPacket,
+                           AsyncMqttClientInternals::PubAckOutPacket,
+                           AsyncMqttClientInternals::PublishOutPacket,
+                           AsyncMqttClientInternals::SubscribeOutPacket,
+                           AsyncMqttClientInternals::UnsubscribeOutPacket>::type OutPacketSlot;
+
+static AsyncMqttClientInternals::Pool<sizeof(OutPacketSlot), MQTT_OUT_PACKET_POOL_SIZE> _packetPool;
+static AsyncMqttClientInternals::Pool<MQTT_OUT_BUFFER_SIZE, MQTT_OUT_BUFFER_POOL_SIZE> _bufferPool;
+
+void* OutPacket::operator new(size_t size) {
+  return _packetPool.allocate(size);
+}
+
+void OutPacket::operator delete(void* pointer) {
+  _packetPool.release(pointer);
+}
+
+AsyncMqttClientPoolStats OutPacket::packetPoolStats() {
+  return _packetPool.stats();
+}
+
+AsyncMqttClientPoolStats OutPacket::bufferPoolStats() {
+  return _bufferPool.stats();
+}
+
+uint8_t* OutPacket::_allocateBuffer(size_t size) {
+  return static_cast<uint8_t*>(_bufferPool.allocate(size));
+}
+
+void OutPacket::_releaseBuffer(uint8_t* buffer) {
+  _bufferPool.release(buffer);
+}
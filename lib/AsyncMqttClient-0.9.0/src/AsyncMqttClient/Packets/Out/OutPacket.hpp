@@ -5,6 +5,7 @@
 #include <algorithm>  // std::min
 
 #include "../../Flags.hpp"
+#include "../../Pool.hpp"
 
 namespace AsyncMqttClientInternals {
 class OutPacket {
@@ -19,6 +20,11 @@ class OutPacket {
   uint8_t qos() const;
   void release();
 
+  static void* operator new(size_t size);
+  static void operator delete(void* pointer);
+  static AsyncMqttClientPoolStats packetPoolStats();
+  static AsyncMqttClientPoolStats bufferPoolStats();
+
  public:
   OutPacket* next;
   uint32_t timeout;
@@ -26,6 +32,8 @@ class OutPacket {
 
  protected:
   static uint16_t _getNextPacketId();
+  static uint8_t* _allocateBuffer(size_t size);
+  static void _releaseBuffer(uint8_t* buffer);
   bool _released;
   uint16_t _packetId;
 
@@ -39,29 +39,41 @@ PublishOutPacket::PublishOutPacket(const char* topic, uint8_t qos, bool retain,
   if (qos != 0) neededSpace += 2;
   if (payload != nullptr) neededSpace += payloadLength;
 
-  _data.reserve(neededSpace);
+  _data = _allocateBuffer(neededSpace);
+  _size = 0;
 
   _packetId = (qos !=0) ? _getNextPacketId() : 1;
   char packetIdBytes[2];
   packetIdBytes[0] = _packetId >> 8;
   packetIdBytes[1] = _packetId & 0xFF;
 
-  _data.insert(_data.end(), fixedHeader, fixedHeader + 1 + remainingLengthLength);
-  _data.insert(_data.end(), topicLengthBytes, topicLengthBytes + 2);
-  _data.insert(_data.end(), topic, topic + topicLength);
+  memcpy(_data + _size, fixedHeader, 1 + remainingLengthLength);
+  _size += 1 + remainingLengthLength;
+  memcpy(_data + _size, topicLengthBytes, 2);
+  _size += 2;
+  memcpy(_data + _size, topic, topicLength);
+  _size += topicLength;
   if (qos != 0) {
-    _data.insert(_data.end(), packetIdBytes, packetIdBytes + 2);
+    memcpy(_data + _size, packetIdBytes, 2);
+    _size += 2;
     _released = false;
   }
-  if (payload != nullptr) _data.insert(_data.end(), payload, payload + payloadLength);
+  if (payload != nullptr) {
+    memcpy(_data + _size, payload, payloadLength);
+    _size += payloadLength;
+  }
+}
+
+PublishOutPacket::~PublishOutPacket() {
+  _releaseBuffer(_data);
 }
 
 const uint8_t* PublishOutPacket::data(size_t index) const {
-  return &_data.data()[index];
+  return &_data[index];
 }
 
 size_t PublishOutPacket::size() const {
-  return _data.size();
+  return _size;
 }
 
 void PublishOutPacket::setDup() {
@@ -1,7 +1,6 @@
 #pragma once
 
-#include <cstring>  // strlen
-#include <vector>
+#include <cstring>  // strlen, memcpy
 
 #include "OutPacket.hpp"
 #include "../../Flags.hpp"
@@ -12,12 +11,14 @@ namespace AsyncMqttClientInternals {
 class PublishOutPacket : public OutPacket {
  public:
   PublishOutPacket(const char* topic, uint8_t qos, bool retain, const char* payload, size_t length);
+  ~PublishOutPacket();
   const uint8_t* data(size_t index = 0) const;
   size_t size() const;
 
   void setDup();  // you cannot unset dup
 
  private:
-  std::vector<uint8_t> _data;
+  uint8_t* _data;
+  size_t _size;
 };
 }  // namespace AsyncMqttClientInternals
@@ -1,7 +1,6 @@
 #pragma once
 
-#include <cstring>  // strlen
-#include <vector>
+#include <cstring>  // strlen, memcpy
 
 #include "OutPacket.hpp"
 #include "../../Flags.hpp"
@@ -12,10 +11,12 @@ namespace AsyncMqttClientInternals {
 class SubscribeOutPacket : public OutPacket {
  public:
   SubscribeOutPacket(const char* topic, uint8_t qos);
+  ~SubscribeOutPacket();
   const uint8_t* data(size_t index = 0) const;
   size_t size() const;
 
  private:
-  std::vector<uint8_t> _data;
+  uint8_t* _data;
+  size_t _size;
 };
 }  // namespace AsyncMqttClientInternals
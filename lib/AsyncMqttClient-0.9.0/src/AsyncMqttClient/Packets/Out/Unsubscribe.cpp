@@ -21,22 +21,33 @@ UnsubscribeOutPacket::UnsubscribeOutPacket(const char* topic) {
   neededSpace += 2;
   neededSpace += topicLength;
 
+  _data = _allocateBuffer(neededSpace);
+  _size = 0;
+
   _packetId = _getNextPacketId();
   char packetIdBytes[2];
   packetIdBytes[0] = _packetId >> 8;
   packetIdBytes[1] = _packetId & 0xFF;
 
-  _data.insert(_data.end(), fixedHeader, fixedHeader + 1 + remainingLengthLength);
-  _data.insert(_data.end(), packetIdBytes, packetIdBytes + 2);
-  _data.insert(_data.end(), topicLengthBytes, topicLengthBytes + 2);
-  _data.insert(_data.end(), topic, topic + topicLength);
+  memcpy(_data + _size, fixedHeader, 1 + remainingLengthLength);
+  _size += 1 + remainingLengthLength;
+  memcpy(_data + _size, packetIdBytes, 2);
+  _size += 2;
+  memcpy(_data + _size, topicLengthBytes, 2);
+  _size += 2;
+  memcpy(_data + _size, topic, topicLength);
+  _size += topicLength;
   _released = false;
 }
 
+UnsubscribeOutPacket::~UnsubscribeOutPacket() {
+  _releaseBuffer(_data);
+}
+
 const uint8_t* UnsubscribeOutPacket::data(size_t index) const {
-  return &_data.data()[index];
+  return &_data[index];
 }
 
 size_t UnsubscribeOutPacket::size() const {
-  return _data.size();
+  return _size;
 }
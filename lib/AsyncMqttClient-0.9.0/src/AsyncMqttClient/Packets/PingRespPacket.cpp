@@ -2,9 +2,10 @@
 
 using AsyncMqttClientInternals::PingRespPacket;
 
-PingRespPacket::PingRespPacket(ParsingInformation* parsingInformation, OnPingRespInternalCallback callback)
+PingRespPacket::PingRespPacket(ParsingInformation* parsingInformation, OnPingRespInternalCallback callback, void* callbackArg)
 : _parsingInformation(parsingInformation)
-, _callback(callback) {
+, _callback(callback)
+, _callbackArg(callbackArg) {
 }
 
 PingRespPacket::~PingRespPacket() {
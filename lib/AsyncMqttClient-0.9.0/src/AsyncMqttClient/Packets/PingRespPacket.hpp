@@ -8,7 +8,7 @@
 namespace AsyncMqttClientInternals {
 class PingRespPacket : public Packet {
  public:
-  explicit PingRespPacket(ParsingInformation* parsingInformation, OnPingRespInternalCallback callback);
+  explicit PingRespPacket(ParsingInformation* parsingInformation, OnPingRespInternalCallback callback, void* callbackArg);
   ~PingRespPacket();
 
   void parseVariableHeader(char* data, size_t len, size_t* currentBytePosition);
@@ -17,5 +17,6 @@ class PingRespPacket : public Packet {
  private:
   ParsingInformation* _parsingInformation;
   OnPingRespInternalCallback _callback;
+  void* _callbackArg;
 };
 }  // namespace AsyncMqttClientInternals
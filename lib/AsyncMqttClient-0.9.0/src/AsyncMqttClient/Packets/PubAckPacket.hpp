@@ -8,7 +8,7 @@
 namespace AsyncMqttClientInternals {
 class PubAckPacket : public Packet {
  public:
-  explicit PubAckPacket(ParsingInformation* parsingInformation, OnPubAckInternalCallback callback);
+  explicit PubAckPacket(ParsingInformation* parsingInformation, OnPubAckInternalCallback callback, void* callbackArg);
   ~PubAckPacket();
 
   void parseVariableHeader(char* data, size_t len, size_t* currentBytePosition);
@@ -17,9 +17,10 @@ class PubAckPacket : public Packet {
  private:
   ParsingInformation* _parsingInformation;
   OnPubAckInternalCallback _callback;
+  void* _callbackArg;
 
   uint8_t _bytePosition;
-  char _packetIdMsb;
+  uint8_t _packetIdMsb;
   uint16_t _packetId;
 };
 }  // namespace AsyncMqttClientInternals
@@ -8,7 +8,7 @@
 namespace AsyncMqttClientInternals {
 class PubCompPacket : public Packet {
  public:
-  explicit PubCompPacket(ParsingInformation* parsingInformation, OnPubCompInternalCallback callback);
+  explicit PubCompPacket(ParsingInformation* parsingInformation, OnPubCompInternalCallback callback, void* callbackArg);
   ~PubCompPacket();
 
   void parseVariableHeader(char* data, size_t len, size_t* currentBytePosition);
@@ -17,9 +17,10 @@ class PubCompPacket : public Packet {
  private:
   ParsingInformation* _parsingInformation;
   OnPubCompInternalCallback _callback;
+  void* _callbackArg;
 
   uint8_t _bytePosition;
-  char _packetIdMsb;
+  uint8_t _packetIdMsb;
   uint16_t _packetId;
 };
 }  // namespace AsyncMqttClientInternals
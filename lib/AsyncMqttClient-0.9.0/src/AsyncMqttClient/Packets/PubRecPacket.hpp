@@ -8,7 +8,7 @@
 namespace AsyncMqttClientInternals {
 class PubRecPacket : public Packet {
  public:
-  explicit PubRecPacket(ParsingInformation* parsingInformation, OnPubRecInternalCallback callback);
+  explicit PubRecPacket(ParsingInformation* parsingInformation, OnPubRecInternalCallback callback, void* callbackArg);
   ~PubRecPacket();
 
   void parseVariableHeader(char* data, size_t len, size_t* currentBytePosition);
@@ -17,9 +17,10 @@ class PubRecPacket : public Packet {
  private:
   ParsingInformation* _parsingInformation;
   OnPubRecInternalCallback _callback;
+  void* _callbackArg;
 
   uint8_t _bytePosition;
-  char _packetIdMsb;
+  uint8_t _packetIdMsb;
   uint16_t _packetId;
 };
 }  // namespace AsyncMqttClientInternals
@@ -2,9 +2,10 @@
 
 using AsyncMqttClientInternals::PubRelPacket;
 
-PubRelPacket::PubRelPacket(ParsingInformation* parsingInformation, OnPubRelInternalCallback callback)
+PubRelPacket::PubRelPacket(ParsingInformation* parsingInformation, OnPubRelInternalCallback callback, void* callbackArg)
 : _parsingInformation(parsingInformation)
 , _callback(callback)
+, _callbackArg(callbackArg)
 , _bytePosition(0)
 , _packetIdMsb(0)
 , _packetId(0) {
@@ -14,13 +15,13 @@ PubRelPacket::~PubRelPacket() {
 }
 
 void PubRelPacket::parseVariableHeader(char* data, size_t len, size_t* currentBytePosition) {
-  char currentByte = data[(*currentBytePosition)++];
+  uint8_t currentByte = data[(*currentBytePosition)++];
   if (_bytePosition++ == 0) {
     _packetIdMsb = currentByte;
   } else {
     _packetId = currentByte | _packetIdMsb << 8;
     _parsingInformation->bufferState = BufferState::NONE;
-    _callback(_packetId);
+    _callback(_callbackArg, _packetId);
   }
 }
 
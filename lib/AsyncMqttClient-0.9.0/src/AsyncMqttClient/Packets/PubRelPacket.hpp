@@ -8,7 +8,7 @@
 namespace AsyncMqttClientInternals {
 class PubRelPacket : public Packet {
  public:
-  explicit PubRelPacket(ParsingInformation* parsingInformation, OnPubRelInternalCallback callback);
+  explicit PubRelPacket(ParsingInformation* parsingInformation, OnPubRelInternalCallback callback, void* callbackArg);
   ~PubRelPacket();
 
   void parseVariableHeader(char* data, size_t len, size_t* currentBytePosition);
@@ -17,9 +17,10 @@ class PubRelPacket : public Packet {
  private:
   ParsingInformation* _parsingInformation;
   OnPubRelInternalCallback _callback;
+  void* _callbackArg;
 
   uint8_t _bytePosition;
-  char _packetIdMsb;
+  uint8_t _packetIdMsb;
   uint16_t _packetId;
 };
 }  // namespace AsyncMqttClientInternals
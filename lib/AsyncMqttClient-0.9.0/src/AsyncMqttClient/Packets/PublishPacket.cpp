@@ -2,10 +2,11 @@
 
 using AsyncMqttClientInternals::PublishPacket;
 
-PublishPacket::PublishPacket(ParsingInformation* parsingInformation, OnMessageInternalCallback dataCallback, OnPublishInternalCallback completeCallback)
+PublishPacket::PublishPacket(ParsingInformation* parsingInformation, OnMessageInternalCallback dataCallback, OnPublishInternalCallback completeCallback, void* callbackArg)
 : _parsingInformation(parsingInformation)
 , _dataCallback(dataCallback)
 , _completeCallback(completeCallback)
+, _callbackArg(callbackArg)
 , _dup(false)
 , _qos(0)
 , _retain(0)
@@ -37,7 +38,7 @@ PublishPacket::~PublishPacket() {
 }
 
 void PublishPacket::parseVariableHeader(char* data, size_t len, size_t* currentBytePosition) {
-  char currentByte = data[(*currentBytePosition)++];
+  uint8_t currentByte = data[(*currentBytePosition)++];
   if (_bytePosition == 0) {
     _topicLengthMsb = currentByte;
   } else if (_bytePosition == 1) {
@@ -68,8 +69,8 @@ void PublishPacket::_preparePayloadHandling(uint32_t payloadLength) {
   if (payloadLength == 0) {
     _parsingInformation->bufferState = BufferState::NONE;
     if (!_ignore) {
-      _dataCallback(_parsingInformation->topicBuffer, nullptr, _qos, _dup, _retain, 0, 0, 0, _packetId);
-      _completeCallback(_packetId, _qos);
+      _dataCallback(_callbackArg, _parsingInformation->topicBuffer, nullptr, _qos, _dup, _retain, 0, 0, 0, _packetId);
+      _completeCallback(_callbackArg, _packetId, _qos);
     }
   } else {
     _parsingInformation->bufferState = BufferState::PAYLOAD;
@@ -80,12 +81,12 @@ void PublishPacket::parsePayload(char* data, size_t len, size_t* currentBytePosi
   size_t remainToRead = len - (*currentBytePosition);
   if (_payloadBytesRead + remainToRead > _payloadLength) remainToRead = _payloadLength - _payloadBytesRead;
 
-  if (!_ignore) _dataCallback(_parsingInformation->topicBuffer, data + (*currentBytePosition), _qos, _dup, _retain, remainToRead, _payloadBytesRead, _payloadLength, _packetId);
+  if (!_ignore) _dataCallback(_callbackArg, _parsingInformation->topicBuffer, data + (*currentBytePosition), _qos, _dup, _retain, remainToRead, _payloadBytesRead, _payloadLength, _packetId);
   _payloadBytesRead += remainToRead;
   (*currentBytePosition) += remainToRead;
 
   if (_payloadBytesRead == _payloadLength) {
     _parsingInformation->bufferState = BufferState::NONE;
-    if (!_ignore) _completeCallback(_packetId, _qos);
+    if (!_ignore) _completeCallback(_callbackArg, _packetId, _qos);
   }
 }
@@ -9,7 +9,7 @@
 namespace AsyncMqttClientInternals {
 class PublishPacket : public Packet {
  public:
-  explicit PublishPacket(ParsingInformation* parsingInformation, OnMessageInternalCallback dataCallback, OnPublishInternalCallback completeCallback);
+  explicit PublishPacket(ParsingInformation* parsingInformation, OnMessageInternalCallback dataCallback, OnPublishInternalCallback completeCallback, void* callbackArg);
   ~PublishPacket();
 
   void parseVariableHeader(char* data, size_t len, size_t* currentBytePosition);
@@ -19,6 +19,7 @@ class PublishPacket : public Packet {
   ParsingInformation* _parsingInformation;
   OnMessageInternalCallback _dataCallback;
   OnPublishInternalCallback _completeCallback;
+  void* _callbackArg;
 
   void _preparePayloadHandling(uint32_t payloadLength);
 
@@ -27,10 +28,10 @@ class PublishPacket : public Packet {
   bool _retain;
 
   uint8_t _bytePosition;
-  char _topicLengthMsb;
+  uint8_t _topicLengthMsb;
   uint16_t _topicLength;
   bool _ignore;
-  char _packetIdMsb;
+  uint8_t _packetIdMsb;
   uint16_t _packetId;
   uint32_t _payloadLength;
   uint32_t _payloadBytesRead;
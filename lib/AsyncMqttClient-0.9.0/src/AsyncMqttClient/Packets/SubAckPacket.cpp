@@ -2,9 +2,10 @@
 
 using AsyncMqttClientInternals::SubAckPacket;
 
-SubAckPacket::SubAckPacket(ParsingInformation* parsingInformation, OnSubAckInternalCallback callback)
+SubAckPacket::SubAckPacket(ParsingInformation* parsingInformation, OnSubAckInternalCallback callback, void* callbackArg)
 : _parsingInformation(parsingInformation)
 , _callback(callback)
+, _callbackArg(callbackArg)
 , _bytePosition(0)
 , _packetIdMsb(0)
 , _packetId(0) {
@@ -14,7 +15,7 @@ SubAckPacket::~SubAckPacket() {
 }
 
 void SubAckPacket::parseVariableHeader(char* data, size_t len, size_t* currentBytePosition) {
-  char currentByte = data[(*currentBytePosition)++];
+  uint8_t currentByte = data[(*currentBytePosition)++];
   if (_bytePosition++ == 0) {
     _packetIdMsb = currentByte;
   } else {
@@ -42,5 +43,5 @@ void SubAckPacket::parsePayload(char* data, size_t len, size_t* currentBytePosit
   } */
 
   _parsingInformation->bufferState = BufferState::NONE;
-  _callback(_packetId, status);
+  _callback(_callbackArg, _packetId, status);
 }
@@ -8,7 +8,7 @@
 namespace AsyncMqttClientInternals {
 class SubAckPacket : public Packet {
  public:
-  explicit SubAckPacket(ParsingInformation* parsingInformation, OnSubAckInternalCallback callback);
+  explicit SubAckPacket(ParsingInformation* parsingInformation, OnSubAckInternalCallback callback, void* callbackArg);
   ~SubAckPacket();
 
   void parseVariableHeader(char* data, size_t len, size_t* currentBytePosition);
@@ -17,9 +17,10 @@ class SubAckPacket : public Packet {
  private:
   ParsingInformation* _parsingInformation;
   OnSubAckInternalCallback _callback;
+  void* _callbackArg;
 
   uint8_t _bytePosition;
-  char _packetIdMsb;
+  uint8_t _packetIdMsb;
   uint16_t _packetId;
 };
 }  // namespace AsyncMqttClientInternals
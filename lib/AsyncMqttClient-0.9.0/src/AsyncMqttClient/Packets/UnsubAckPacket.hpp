@@ -8,7 +8,7 @@
 namespace AsyncMqttClientInternals {
 class UnsubAckPacket : public Packet {
  public:
-  explicit UnsubAckPacket(ParsingInformation* parsingInformation, OnUnsubAckInternalCallback callback);
+  explicit UnsubAckPacket(ParsingInformation* parsingInformation, OnUnsubAckInternalCallback callback, void* callbackArg);
   ~UnsubAckPacket();
 
   void parseVariableHeader(char* data, size_t len, size_t* currentBytePosition);
@@ -17,9 +17,10 @@ class UnsubAckPacket : public Packet {
  private:
   ParsingInformation* _parsingInformation;
   OnUnsubAckInternalCallback _callback;
+  void* _callbackArg;
 
   uint8_t _bytePosition;
-  char _packetIdMsb;
+  uint8_t _packetIdMsb;
   uint16_t _packetId;
 };
 }  // namespace AsyncMqttClientInternals
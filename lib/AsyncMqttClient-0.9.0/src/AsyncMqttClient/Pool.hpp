@@ -0,0 +1,118 @@
+#pragma once
+
+#include <stdint.h>  // uint*_t
+#include <stddef.h>  // size_t
+#include <new>  // ::operator new
+#include <type_traits>  // std::aligned_storage
+
+#include "Arduino.h"
+
+// Out packets (the objects queued for sending) are taken from a fixed pool.
+#ifndef MQTT_OUT_PACKET_POOL_SIZE
+#define MQTT_OUT_PACKET_POOL_SIZE 16
+#endif
+
+// The bytes of PUBLISH, SUBSCRIBE, UNSUBSCRIBE and CONNECT packets are taken from a second pool.
+// Packets that do not fit in one buffer, or that arrive while the pool is empty, go to the heap.
+#ifndef MQTT_OUT_BUFFER_POOL_SIZE
+#define MQTT_OUT_BUFFER_POOL_SIZE 6
+#endif
+
+#ifndef MQTT_OUT_BUFFER_SIZE
+#define MQTT_OUT_BUFFER_SIZE 512  // room for a full telemetry batch (TLM_FRAME_LEN) and its topic
+#endif
+
+struct AsyncMqttClientPoolStats {
+  uint16_t slots;      // blocks in the pool
+  uint16_t inUse;      // blocks handed out right now
+  uint16_t highWater;  // most blocks ever handed out at the same time
+  uint32_t fallbacks;  // requests that went to the heap instead
+};
+
+namespace AsyncMqttClientInternals {
+// Fixed size block allocator. Requests larger than BlockSize, or made while every block is
+// handed out, are passed to the heap and counted, so the caller never has to check for failure.
+template <size_t BlockSize, uint16_t BlockCount>
+class Pool {
+ public:
+  Pool()
+  : _free(nullptr)
+  , _inUse(0)
+  , _highWater(0)
+  , _fallbacks(0) {
+    for (uint16_t i = BlockCount; i > 0; i--) {
+      _blocks[i - 1].next = _free;
+      _free = &_blocks[i - 1];
+    }
+  }
+
+  void* allocate(size_t size) {
+    Block* block = nullptr;
+    _lock();
+    if (size <= BlockSize && _free) {
+      block = _free;
+      _free = block->next;
+      if (++_inUse > _highWater) _highWater = _inUse;
+    } else {
+      _fallbacks++;
+    }
+    _unlock();
+    if (block) return block;
+    return ::operator new(size);
+  }
+
+  void release(void* pointer) {
+    if (!pointer) return;
+    if (!owns(pointer)) {
+      ::operator delete(pointer);
+      return;
+    }
+    Block* block = static_cast<Block*>(pointer);
+    _lock();
+    block->next = _free;
+    _free = block;
+    _inUse--;
+    _unlock();
+  }
+
+  bool owns(const void* pointer) const {
+    const uint8_t* p = static_cast<const uint8_t*>(pointer);
+    const uint8_t* first = reinterpret_cast<const uint8_t*>(&_blocks[0]);
+    const uint8_t* last = reinterpret_cast<const uint8_t*>(&_blocks[BlockCount]);
+    return p >= first && p < last;
+  }
+
+  AsyncMqttClientPoolStats stats() {
+    AsyncMqttClientPoolStats stats;
+    _lock();
+    stats.slots = BlockCount;
+    stats.inUse = _inUse;
+    stats.highWater = _highWater;
+    stats.fallbacks = _fallbacks;
+    _unlock();
+    return stats;
+  }
+
+ private:
+  union Block {
+    Block* next;
+    typename std::aligned_storage<BlockSize>::type storage;
+  };
+
+  Block _blocks[BlockCount];
+  Block* _free;
+  uint16_t _inUse;
+  uint16_t _highWater;
+  uint32_t _fallbacks;
+
+  // Packets are queued by the application task and freed by the TCP task.
+#if defined(ARDUINO_ARCH_ESP32)
+  portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+  void _lock() { portENTER_CRITICAL(&_mux); }
+  void _unlock() { portEXIT_CRITICAL(&_mux); }
+#else
+  void _lock() {}
+  void _unlock() {}
+#endif
+};
+}  // namespace AsyncMqttClientInternals
@@ -41,18 +41,22 @@
  *****************************************************************************/
 #include <aaMqtt.h> // Header file for linking.
 #include <aaStringQueue.h> // Required for string buffer to hold incoming commands.
+#include <atomic> // Connection flags shared with the TCP task.
 
 /************************************************************************************
  * @section mqttGlobalVariables Define global variables. Redo like below. 
  ************************************************************************************/
-static TimerHandle_t mqttReconnectTimer; // Instantiate OS software timer.
 static const char* uniqueName; // Unique name to prefix all topics with.
 static IPAddress brokerIP; // IP address of broker.
 static uint16_t BROKER_PORT = 1883; // Port used by MQTT broker. 
 static AsyncMqttClient mqttClient; // Instantiate MQTT object.
-static const char*  cmdTopicMQTT = "NOTHING"; // Full path to incoming command topic from MQTT broker.
+static char cmdTopicMQTT[80] = "NOTHING"; // Full path to incoming command topic from MQTT broker.
 static uint8_t MQTT_QOS = 1; // use Quality of Service level 1 or 0? (0 has less overhead).
-static bool _mqttConnected;
+static std::atomic<bool> _mqttConnected(false); // Set by the client's callbacks, which run on the TCP task.
+static std::atomic<uint32_t> _mqttDisconnects(0); // Disconnect callbacks so far. Read by poll().
+static uint32_t _seenDisconnects = 0; // Disconnect callbacks poll() has passed on to mqttLink.
+static amReconnect mqttLink(MQTT_RETRY_FIRST_MS, MQTT_RETRY_MAX_MS, MQTT_CONNECT_TIMEOUT_MS, MQTT_STABLE_MS, 1); // When to connect. Reseeded by connect().
+static amRing<MQTT_OFFLINE_SLOTS, MQTT_OFFLINE_LEN, RING_DROP_OLDEST> heldMessages; // publishMQTT() messages waiting for the broker.
 aaStringQueue cmdQueue; // Instantiate the command queue.
 
 /************************************************************************************
@@ -79,13 +83,15 @@ aaMqtt::~aaMqtt()
 } // aaMqtt::aaMqtt()
 
 /**
- * @brief Connect to MQTT broker.
+ * @brief Start connecting to the MQTT broker.
+ * @details Returns straight away. The first attempt is made here and poll() 
+ * makes the rest, backing off after each failure, so a broker that refuses, 
+ * never answers or keeps dropping the connection costs the caller nothing.
  * @param IPAddress IP address of the MQTT broker. 
  * @param char* Unique name used to prefix all topic trees.
  =============================================================================*/
 void aaMqtt::connect(IPAddress address, const char* uName)
 {
-   _mqttConnected = false;
    brokerIP = address;
    uniqueName = uName; // Prefix for all MQTT topic tree names.
    Serial.print("<aaMqtt::connect> Connecting as ");
@@ -100,9 +106,94 @@ void aaMqtt::connect(IPAddress address, const char* uName)
    mqttClient.onMessage(onMqttMessage); // Define recieve message event.
    mqttClient.onPublish(onMqttPublish); // Define publish message event.
    mqttClient.setServer(brokerIP, BROKER_PORT); // Set IP and port for broker service.  
-   mqttClient.connect(); // Connect to broker.
+   uint32_t seed = (uint32_t)ESP.getEfuseMac() ^ (uint32_t)(ESP.getEfuseMac() >> 32) ^ micros(); // Robots retry at different times.
+   mqttLink = amReconnect(MQTT_RETRY_FIRST_MS, MQTT_RETRY_MAX_MS, MQTT_CONNECT_TIMEOUT_MS, MQTT_STABLE_MS, seed);
+   mqttLink.start(millis());
+   poll(millis()); // First attempt.
 } // aaMqtt::connect()
 
+/**
+ * @brief Look after the broker connection. Call from loop().
+ * @details Passes the client's connect and disconnect callbacks, which run on
+ * the TCP task, to the state machine, starts and abandons connect attempts when
+ * it says so and sends the messages publishMQTT() held while the broker was 
+ * away, oldest first.
+ * @param uint32_t millis().
+ =============================================================================*/
+void aaMqtt::poll(uint32_t nowMs)
+{
+   uint32_t disconnects = _mqttDisconnects.load();
+   if(disconnects != _seenDisconnects) // Refused, or dropped.
+   {
+      _seenDisconnects = disconnects;
+      mqttLink.disconnected(nowMs);
+   } // if
+   if(_mqttConnected == true)
+   {
+      mqttLink.connected(nowMs); // Ignored unless an attempt is under way.
+   } // if
+   switch(mqttLink.poll(nowMs))
+   {
+      case RC_CONNECT:
+         if(WiFi.isConnected() == false) // Counts as a failed attempt.
+         {
+            mqttLink.disconnected(nowMs);
+            break;
+         } // if
+         Serial.print("<aaMqtt::poll> Connect attempt "); Serial.println(mqttLink.getAttempts());
+         mqttClient.connect(); // Answered by onMqttConnect() or onMqttDisconnect().
+         break;
+      case RC_ABORT:
+         Serial.print("<aaMqtt::poll> No answer from broker. Next attempt in "); Serial.print(mqttLink.getWaitMs(nowMs)); Serial.println(" ms.");
+         mqttClient.disconnect(true);
+         break;
+      default:
+         break;
+   } // switch
+   char held[MQTT_OFFLINE_LEN]; // Full topic, 0, payload, 0.
+   uint16_t len;
+   while(_mqttConnected == true && heldMessages.pop(held, sizeof(held), &len) == true)
+   {
+      mqttClient.publish(held, MQTT_QOS, false, held + strlen(held) + 1);
+   } // while
+} // aaMqtt::poll()
+
+/**
+ * @brief Report whether the broker connection is up.
+ * @return bool true if connected.
+ =============================================================================*/
+bool aaMqtt::isConnected()
+{
+   return _mqttConnected;
+} // aaMqtt::isConnected()
+
+/**
+ * @brief Connection state machine, for its state and counters.
+ * @return amReconnect& The one used by poll().
+ =============================================================================*/
+amReconnect& aaMqtt::getLink()
+{
+   return mqttLink;
+} // aaMqtt::getLink()
+
+/**
+ * @brief Report how many messages are waiting for the broker.
+ * @return uint16_t Messages held by publishMQTT().
+ =============================================================================*/
+uint16_t aaMqtt::getHeldCount()
+{
+   return heldMessages.getCount();
+} // aaMqtt::getHeldCount()
+
+/**
+ * @brief Report how many held messages were dropped to make room for newer ones.
+ * @return uint32_t Messages lost.
+ =============================================================================*/
+uint32_t aaMqtt::getHeldLost()
+{
+   return heldMessages.getDropped() + heldMessages.getRejected();
+} // aaMqtt::getHeldLost()
+
 /**
  * @brief Event handler for connecting to the broker.
  * @param bool  Check to see if there are messages queued already. 
@@ -111,34 +202,29 @@ void aaMqtt::onMqttConnect(bool sessionPresent)
 {
    Serial.print("<aaMqtt::onMqttConnect> Connected to MQTT. Session present = ");
    Serial.println(sessionPresent);
-   char buf[30];
-   const char* topic = "/commands";
-   cmdTopicMQTT = uniqueName;
-   Serial.print("<aaMqtt::onMqttConnect> uniqueName = "); Serial.println(cmdTopicMQTT);
-   strcpy(buf, uniqueName);
-   strcat(buf, topic);   
-   cmdTopicMQTT = buf;   
+   snprintf(cmdTopicMQTT, sizeof(cmdTopicMQTT), "%s/commands", uniqueName); // Kept. The client may read it after this returns.
    uint16_t packetIdSub = mqttClient.subscribe(cmdTopicMQTT, MQTT_QOS); // QOS can be 0,1 or 2. controlled by MQTTQos parameter
    Serial.print("<aaMqtt::onMqttConnect> Subscribing to "); Serial.print(cmdTopicMQTT);
    Serial.print(" at a QOS of "); Serial.print(MQTT_QOS);
    Serial.print(" with a packetId of "); Serial.println(packetIdSub);
-   _mqttConnected = true; // Flag that a broker connection now exists.
-   publishMQTT(CHECKIN_MQTT_TOPIC,uniqueName); // Checkin with unique name.
+   char checkinTopic[80];
+   snprintf(checkinTopic, sizeof(checkinTopic), "%s%s", TOP_OF_TREE, CHECKIN_MQTT_TOPIC);
+   mqttClient.publish(checkinTopic, MQTT_QOS, false, uniqueName); // Checkin with unique name. Not through publishMQTT(), which belongs to loop().
    Serial.println("<aaMqtt::onMqttConnect> Send checkin message to broker"); 
+   _mqttConnected = true; // Flag that a broker connection now exists. poll() sends held messages.
 } // aaMqtt::onMqttConnect()
 
 /**
- * @brief Event handler for disconnecting from the broker.
+ * @brief Event handler for disconnecting from the broker, or failing to connect.
+ * @details Runs on the TCP task. Leaves reconnecting to poll().
  * @param AsyncMqttClientDisconnectReason Reason code. 
  =============================================================================*/
 void aaMqtt::onMqttDisconnect(AsyncMqttClientDisconnectReason reason)
 {
    _mqttConnected = false;
-   Serial.println("<onMqttDisconnect> Disconnected from MQTT");
-   if(WiFi.isConnected())
-   {
-      xTimerStart(mqttReconnectTimer, 0); // Activate mqtt timer (which only runs 1 time)
-   } //if
+   _mqttDisconnects++; // poll() schedules the next attempt.
+   Serial.print("<onMqttDisconnect> Disconnected from MQTT. Reason = ");
+   Serial.println((int)reason);
 } // void aaMqtt::onMqttDisconnect()
 
 /**
@@ -192,8 +278,13 @@ void aaMqtt::onMqttUnsubscribe(uint16_t packetId)
 
 /**
  * @brief Publishes a message to the MQTT server.
+ * @details While the broker is away, or older messages are still waiting, 
+ * the message is held and poll() sends it once the broker is back. When 
+ * MQTT_OFFLINE_SLOTS are waiting the oldest is dropped. Call from the task 
+ * that calls poll().
  * @param char* Topic to pubished to.
  * @param char* Message to publish. 
+ * @return bool false if the message is too long to hold.
  =============================================================================*/
 bool aaMqtt::publishMQTT(const char* topic, const char* msg)
 {
@@ -201,17 +292,55 @@ bool aaMqtt::publishMQTT(const char* topic, const char* msg)
    strcpy(fullTopic,TOP_OF_TREE); // Move vendor name into full topic name.
    strcat(fullTopic,topic); // Append topic into full topic name.
 
-   if(_mqttConnected == true)
+   if(_mqttConnected == true && heldMessages.isEmpty() == true)
    {
       mqttClient.publish(fullTopic, MQTT_QOS, false, msg);
       return true;
    } //if
-   else
+   size_t topicLen = strlen(fullTopic);
+   size_t msgLen = strlen(msg);
+   if(topicLen + msgLen + 2 > MQTT_OFFLINE_LEN)
    {
       return false;
-   } //else
+   } //if
+   char held[MQTT_OFFLINE_LEN];
+   memcpy(held, fullTopic, topicLen + 1);
+   memcpy(held + topicLen + 1, msg, msgLen + 1);
+   heldMessages.push(held, topicLen + msgLen + 2); // Full ring drops its oldest message.
+   return true;
 } // aaMqtt::publishMQTT()
 
+/**
+ * @brief Publishes a payload to a topic that is already complete.
+ * @details Unlike publishMQTT() the topic is used as is, with no prefix added, 
+ * so a caller that builds its topics once does no string work per message.
+ * @param char* Full topic to publish to.
+ * @param uint8_t Quality of service. 
+ * @param uint8_t* Payload. May hold zeros.
+ * @param size_t Bytes of payload.
+ * @return bool true if the client took the message.
+ =============================================================================*/
+bool aaMqtt::publishRaw(const char* fullTopic, uint8_t qos, const uint8_t* payload, size_t len)
+{
+   if(_mqttConnected == false)
+   {
+      return false;
+   } //if
+   return mqttClient.publish(fullTopic, qos, false, (const char*)payload, len) != 0;
+} // aaMqtt::publishRaw()
+
+/**
+ * @brief Check for room to send.
+ * @details True only if the broker is connected, nothing is waiting in the 
+ * client's queue and the TCP send window has room for the whole packet.
+ * @param size_t Size of the MQTT packet, header included.
+ * @return bool true if a packet that size would go out straight away.
+ =============================================================================*/
+bool aaMqtt::isSendReady(size_t wireBytes)
+{
+   return _mqttConnected == true && mqttClient.isSendReady(wireBytes);
+} // aaMqtt::isSendReady()
+
 /**
  * @brief Publishes an event.
  * @param int Event ID.
@@ -250,39 +379,30 @@ void aaMqtt::onMqttMessage(char *topic, char *payload, AsyncMqttClientMessagePro
    Serial.print("<onMqttMessage>  total: ");
    Serial.println(total);
    Serial.print("<onMqttMessage>  payload: ");
-   Serial.println(payload);
-   String tmp = String(payload).substring(0, len);
-   Serial.print("<onMqttMessage> Message to process = ");
-   Serial.println(tmp);
-   char msg[30]; // Used to hold message converted from const.
-   strcpy(msg, tmp.c_str()); // Convert const char* to char*;
-   Serial.print("<onMqttMessage> msg = ");
-   Serial.println(msg);
+   Serial.write(payload, len); // Payload is not 0 terminated.
+   Serial.println();
+   if(index != 0 || len != total) // Commands are short. A message split across packets is not one.
+   {
+      Serial.println("<onMqttMessage> Fragmented message ignored.");
+      return;
+   } // if
+   char msg[COMMAND_MAX_LENGTH]; // Queue slot sized copy of the payload.
+   size_t msgLen = (len < sizeof(msg) - 1) ? len : sizeof(msg) - 1; // Longer commands are truncated, not overflowed.
+   memcpy(msg, payload, msgLen);
+   msg[msgLen] = '\0';
    cmdQueue.push(msg); // Push message onto FIFO buffer stack.
    cmdQueue.dumpBuffer();
 } // aaMqtt::onMqttMessage()
 
 /**
- * @brief Event handler for the ACK from a published message.
- * @param uint16_t Packet Id of message that was published.
+ * @brief Take the oldest command off the queue.
+ * @param char* Where to put the command. 
+ * @param size_t Size of dest. Longer commands are truncated. 
+ * @return bool true if there was a command, false if the queue was empty.
  =============================================================================*/
-String aaMqtt::getCmd()
+bool aaMqtt::getCmd(char* dest, size_t size)
 {
-   if(cmdQueue.isEmpty())
-   {
-      return "";
-   } // if
-   else
-   {
-      int8_t strSize = cmdQueue.getMaxBufferSize();
-      char str[strSize];
-      cmdQueue.pop(str);
-      Serial.print("<aaMqtt::getCmd> Size of string = ");
-      Serial.println(strSize);
-      Serial.print("<aaMqtt::getCmd> Command pulled from buffer = ");
-      Serial.println(String(str));
-      return String(str);
-   } // else
+   return cmdQueue.pop(dest, size);
 } // aaMqtt::getCmd()
 
 /**
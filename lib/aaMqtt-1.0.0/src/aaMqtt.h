@@ -12,9 +12,10 @@
 #include <WiFi.h> // Required to connect to WiFi network. Comes with Platform.io.
 #include <AsyncMqttClient.h> // MQTT. https://github.com/marvinroger/async-mqtt-client.
 #include "freertos/FreeRTOS.h" // OS threads. Comes with Platform.io.
-#include "freertos/timers.h" // Software Timers. Comes with Platform.io.
 #include <aaNetwork.h> // Store values that persist past reboot.
 #include <aaFlash.h> // Use Flash memory to store values that persist past reboot.
+#include <amReconnect.h> // When to connect and reconnect to the broker.
+#include <amRing.h> // Messages held while the broker is away.
 
 /************************************************************************************
  * @section mqttDeclareConstants Declare constants. 
@@ -22,6 +23,12 @@
 extern const char* TOP_OF_TREE; // Declare top of MQTT topic tree.
 extern const char* HEALTH_MQTT_TOPIC; // Declare MQTT health topic.
 extern const char* CHECKIN_MQTT_TOPIC; // Declare MQTT health topic.
+const uint32_t MQTT_RETRY_FIRST_MS = 1000; // Wait after the first failed connect. Doubles with each failure.
+const uint32_t MQTT_RETRY_MAX_MS = 60000; // Longest wait between connect attempts.
+const uint32_t MQTT_CONNECT_TIMEOUT_MS = 5000; // Longest a connect attempt may take, e.g. to a host that never sends CONNACK.
+const uint32_t MQTT_STABLE_MS = 30000; // Connection up this long resets the wait to MQTT_RETRY_FIRST_MS.
+const uint8_t MQTT_OFFLINE_SLOTS = 8; // Messages publishMQTT() holds while the broker is away. Oldest dropped first.
+const uint8_t MQTT_OFFLINE_LEN = 128; // Longest held message, full topic and payload, with a 0 after each.
 
 /************************************************************************************
  * @class Read/write to/from flash RAM.
@@ -31,16 +38,23 @@ class aaMqtt // Indicate that we are extending LiquidCrystal_I2C class with our
    public:
       aaMqtt(); // Default constructor for this class.
       ~aaMqtt(); // Class destructor.
-      static void connect(IPAddress address, const char* uniqueName); // Connect to MQTT broker.
+      static void connect(IPAddress address, const char* uniqueName); // Start connecting to the MQTT broker.
+      static void poll(uint32_t nowMs); // Connect, reconnect and send held messages. Call from loop().
+      static bool isConnected(); // True while the broker connection is up.
+      static amReconnect& getLink(); // Connection state and counters.
+      static uint16_t getHeldCount(); // Messages waiting for the broker.
+      static uint32_t getHeldLost(); // Held messages dropped to make room.
       static void onMqttConnect(bool sessionPresent);
       static void onMqttDisconnect(AsyncMqttClientDisconnectReason reason); 
       static void onMqttSubscribe(uint16_t packetId, uint8_t qos);
       static void onMqttUnsubscribe(uint16_t packetId);
-      static bool publishMQTT(const char* topic, const char* msg);
+      static bool publishMQTT(const char* topic, const char* msg); // Publish now, or hold until the broker is back.
+      static bool publishRaw(const char* fullTopic, uint8_t qos, const uint8_t* payload, size_t len); // Publish to a topic built beforehand.
+      static bool isSendReady(size_t wireBytes); // True if a packet this size would go out straight away.
       static void publishEvent(int evtId, int evtSev, String evtMsg);
       static void onMqttMessage(char *topic, char *payload, AsyncMqttClientMessageProperties properties, size_t len, size_t index, size_t total);
       static void onMqttPublish(uint16_t packetId);
-      static String getCmd(); // Checks if there is a command in the queue returns the command or "" is there is not.
+      static bool getCmd(char* dest, size_t size); // Copies the oldest queued command into dest. Returns false if there is none.
    private: 
 }; //class aaMqtt
 
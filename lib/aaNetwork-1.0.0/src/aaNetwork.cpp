@@ -44,6 +44,12 @@
  *****************************************************************************/
 #include <aaNetwork.h> // Header file for linking.
 
+static const char* NVS_NAMESPACE = "aaNetwork"; // NVS namespace of the remembered Access Point.
+static const char* NVS_LAST_AP = "lastAP"; // NVS key of the remembered Access Point.
+static Preferences apStore; // NVS access for the remembered Access Point.
+std::atomic<uint32_t> aaNetwork::_gotIpEvents(0); // IP addresses got, counted by the WiFi event task.
+std::atomic<uint32_t> aaNetwork::_lostEvents(0); // Disconnects, counted by the WiFi event task.
+
 /**
  * @class Write variables to flash memory.
  ============================================================================*/
@@ -51,6 +57,8 @@ aaNetwork::aaNetwork()
 {
    Serial.println("<aaNetwork::aaNetwork> Default constructor running.");
    _HOST_NAME_PREFIX = "";
+   memset(&_cachedAP, 0, sizeof(_cachedAP)); // Nothing remembered until connect() reads NVS.
+   memset(&_foundAP, 0, sizeof(_foundAP)); // Nothing scanned yet.
 } // aaNetwork::aaNetwork()
 
 /**
@@ -61,6 +69,8 @@ aaNetwork::aaNetwork(const char* prefix)
 {
    Serial.println("<aaNetwork::aaNetwork> Default constructor running.");
    _HOST_NAME_PREFIX = prefix;
+   memset(&_cachedAP, 0, sizeof(_cachedAP)); // Nothing remembered until connect() reads NVS.
+   memset(&_foundAP, 0, sizeof(_foundAP)); // Nothing scanned yet.
 } // aaNetwork::aaNetwork()
 
 /**
@@ -125,23 +135,26 @@ const char* aaNetwork::_connectionStatus(wl_status_t status)
  
 /**
  * @brief Send wifi connection details to console.
- * @param wl_status_t wifi connection status code.
+ * @details Uses the signal strength poll() samples rather than taking fresh
+ * readings, so it does not hold up the caller.
  =============================================================================*/
 void aaNetwork::cfgToConsole()
 {
-   wifi_auth_mode_t encryption = WiFi.encryptionType(_SSIDIndex);
-   int8_t dataReadings = 10; // Number of data readings to average to determine Wifi signal strength.
-   long signalStrength = rfSignalStrength(dataReadings); // Get average signal strength reading.
+   wifi_auth_mode_t encryption = (wifi_auth_mode_t)_cachedAP.authMode; // Saved when we got our address.
+   long signalStrength = (_rssi != 0) ? _rssi : WiFi.RSSI(); // Average kept by poll(), so nothing waits here.
    Serial.println("<aaNetwork::cfgToConsole> Network settings:");  
    Serial.print("<aaNetwork::cfgToConsole> ... Access Point Name = "); Serial.println(WiFi.SSID()); 
    Serial.print("<aaNetwork::cfgToConsole> ... Access Point Encryption method = "); Serial.print(encryption,HEX);
-   Serial.print(" ("); Serial.print(_translateEncryptionType(WiFi.encryptionType(encryption))); Serial.println(")"); 
+   Serial.print(" ("); Serial.print(_translateEncryptionType(encryption)); Serial.println(")"); 
+   Serial.print("<aaNetwork::cfgToConsole> ... Access Point Channel = "); Serial.println(WiFi.channel()); 
    Serial.print("<aaNetwork::cfgToConsole> ... Wifi signal strength = "); Serial.print(signalStrength);
    Serial.print(" ("); Serial.print(evalSignal(signalStrength)); Serial.println(")"); 
+   Serial.print("<aaNetwork::cfgToConsole> ... Time to IP address = "); Serial.print(_link.getTimeToIpMs());
+   Serial.println(_link.getFastWasUsed() ? "ms (fast connect)" : "ms (scan)"); 
    String macAdd = WiFi.macAddress(); // Get MAC address as String
    const int8_t macNumBytes = 6; // MAC addresses have 6 byte addresses.
    byte myMacByte[macNumBytes]; // Byte array containing the 6 bytes of the SOC Mac address.
-   const char* myMacChar = WiFi.macAddress().c_str();  
+   const char* myMacChar = macAdd.c_str(); // Points into macAdd, which outlives it.
    _convert.macToByteArray(myMacChar, myMacByte); // Convert to Byte array
    Serial.print("<aaNetwork::cfgToConsole> ... Robot MAC address: ");
    Serial.printf("%02X",myMacByte[0]);    
@@ -157,7 +170,8 @@ void aaNetwork::cfgToConsole()
    Serial.printf("%02X",myMacByte[5]);
    Serial.println();
    Serial.print("<aaNetwork::cfgToConsole> ... Robot IP address: "); 
-   const char* myIpChar = _convert.ipToString(WiFi.localIP()).c_str(); // Pointer to char array containing MQTT broker IP address
+   String myIp = _convert.ipToString(WiFi.localIP()); // Robot IP address as String.
+   const char* myIpChar = myIp.c_str(); // Pointer to char array containing robot IP address
    const int8_t ipv4NumBytes = 4; // IPv4 has 4 byte address 
    byte myIpByte[ipv4NumBytes]; // Byte array for IP address   
    _convert.ipToByteArray(myIpChar, myIpByte); // Convert to byte array
@@ -173,37 +187,130 @@ void aaNetwork::cfgToConsole()
 } // aaNetwork::cfgToConsole()
 
 /**
- * @brief Connect to Wifi.
+ * @brief Start connecting to Wifi. Returns at once.
+ * @details If NVS remembers the Access Point we last got an address from, and
+ * it is still a known one, the first attempt joins it on its channel without a
+ * scan. Otherwise, or if that fails, poll() runs a scan that does not wait and
+ * joins the strongest known Access Point it finds. Call poll() from loop() to
+ * move all of this along, and areWeConnected() to see when it is done.
  =============================================================================*/
 void aaNetwork::connect()
 {
-   if(_lookForAP() == _unknownAP) // Scan the 2.4Ghz band for known Access Points and select the one with the strongest signal 
+   WiFi.onEvent(_wiFiEvent); // Set up WiFi event handler
+   WiFi.mode(WIFI_STA); // Station only.
+   WiFi.setAutoReconnect(false); // poll() decides when and how to reconnect.
+   bool haveCache = _loadAP(); // Fast connect if we know where to look.
+   if(haveCache)
    {
-      Serial.println("<aaNetwork::connect> No known Access Point SSID was detected. Cannot connect to WiFi at this time.");
+      Serial.print("<aaNetwork::connect> Joining remembered Access Point ");
+      Serial.print(_cachedAP.ssid);
+      Serial.print(" on channel ");
+      Serial.println(_cachedAP.channel);
    } // if
-   else // Found a known Access Point to connect to
+   else
    {
-      WiFi.onEvent(_wiFiEvent); // Set up WiFi event handler
-      WiFi.begin(_ssid, _password); // Connect too strongest AP found
-      Serial.print("<aaNetwork::connect> Attempting to connect to Access Point with the SSID ");
-      Serial.println(_ssid);
-      while(WiFi.waitForConnectResult() != WL_CONNECTED) // Hold boot process here until IP assigned
-      {
-         delay(500);
-      } //while
-      Serial.println("");
-      Serial.print("<aaNetwork::connect> Connected to Access Point with the SSID ");
-      Serial.print(_ssid);
-      Serial.print(" with status code "); 
-      Serial.print(WiFi.status());
-      Serial.print(" (");
-      Serial.print(_connectionStatus(WiFi.status())); 
-      Serial.println(")"); 
-   } //else
+      Serial.println("<aaNetwork::connect> No Access Point remembered. Scanning for known Access Points.");
+   } // else
+   _gotIpSeen = _gotIpEvents.load(); // Events before now belong to an earlier connection.
+   _lostSeen = _lostEvents.load();
+   _link.start(millis(), haveCache); // Time to IP is measured from here.
+   poll(millis()); // Make the first attempt now.
 } // aaNetwork::connect()
 
+/**
+ * @brief Move the connection along. Call from loop().
+ * @details Hands WiFi events to the state machine, collects the answer of a 
+ * scan once it is ready, starts whatever the state machine asks for next and 
+ * samples the signal strength once in a while. Never waits.
+ * @param uint32_t Current time in ms.
+ =============================================================================*/
+void aaNetwork::poll(uint32_t nowMs)
+{
+   uint32_t lost = _lostEvents.load(); // Disconnects since the last poll().
+   if(lost != _lostSeen)
+   {
+      _lostSeen = lost;
+      _link.lost(nowMs);
+   } // if
+   uint32_t gotIp = _gotIpEvents.load(); // Addresses got since the last poll().
+   if(gotIp != _gotIpSeen)
+   {
+      _gotIpSeen = gotIp;
+      if(WiFi.isConnected())
+      {
+         _link.gotIp(nowMs);
+         _saveAP(); // Fast connect to this one next time.
+         _rssi = 0; // Start the average again for this Access Point.
+      } // if
+   } // if
+   if(_scanIssued && _link.getState() == WF_SCANNING)
+   {
+      int16_t found = WiFi.scanComplete(); // WIFI_SCAN_RUNNING until it is done.
+      if(found != WIFI_SCAN_RUNNING)
+      {
+         _scanIssued = false;
+         _link.scanDone(nowMs, _pickAP(found));
+         WiFi.scanDelete(); // Free the scan results.
+      } // if
+   } // if
+   switch(_link.poll(nowMs))
+   {
+      case WF_FAST_CONNECT:
+         WiFi.begin(_cachedAP.ssid, _passwordFor(_cachedAP.ssid), _cachedAP.channel, _cachedAP.bssid);
+         break;
+      case WF_SCAN:
+         WiFi.disconnect(); // Scans need the station idle.
+         _scanIssued = WiFi.scanNetworks(true) != WIFI_SCAN_FAILED; // Answer comes to a later poll().
+         if(!_scanIssued)
+         {
+            _link.scanDone(nowMs, false); // Could not start. Wait and try again.
+         } // if
+         break;
+      case WF_JOIN:
+         Serial.print("<aaNetwork::poll> Joining Access Point "); Serial.print(_foundAP.ssid);
+         Serial.print(" on channel "); Serial.println(_foundAP.channel);
+         WiFi.begin(_foundAP.ssid, _passwordFor(_foundAP.ssid), _foundAP.channel, _foundAP.bssid);
+         break;
+      case WF_ABORT:
+         WiFi.disconnect(); // Give up on the join under way.
+         WiFi.scanDelete(); // And on the scan.
+         _scanIssued = false;
+         break;
+      default:
+         break;
+   } // switch
+   if(_link.getState() == WF_UP && (_rssi == 0 || nowMs - _rssiMs >= NET_RSSI_SAMPLE_MS))
+   {
+      long sample = WiFi.RSSI(); // One reading. Does not wait.
+      _rssi = (_rssi == 0) ? sample : (_rssi * 7 + sample) / 8; // Smooth over about 8 samples.
+      _rssiMs = nowMs;
+   } // if
+   if(_link.getState() != _lastState)
+   {
+      _lastState = _link.getState();
+      if(_progress != nullptr)
+      {
+         _progress(_lastState, nowMs);
+      } // if
+   } // if
+} // aaNetwork::poll()
+
+/**
+ * @brief Forget the remembered Access Point so the next connect() scans.
+ =============================================================================*/
+void aaNetwork::forgetAP()
+{
+   apStore.begin(NVS_NAMESPACE, false); // Open for writing.
+   apStore.remove(NVS_LAST_AP);
+   apStore.end();
+   memset(&_cachedAP, 0, sizeof(_cachedAP));
+   _link.setCache(false);
+} // aaNetwork::forgetAP()
+
 /**
  * @brief Collect an average WiFi signal strength. 
+ * @details Waits 20ms between readings. getSignalStrength() returns the
+ * average poll() keeps without waiting.
  * @param int8_t Number of datapoints to use to create average. 
  * @return long Average signal strength of AP connection in decibels (db).
  =============================================================================*/
@@ -236,6 +343,8 @@ const char* aaNetwork::evalSignal(int16_t signalStrength)
 
 /**
  * @brief Ping IP address once and return the response.
+ * @details Blocks while ESP32Ping waits for the echo, up to a second. From loop()
+ * use amProbe, which does not wait.
  * @param IPAddress Address to ping. 
  * @return bool Result of ping. 
  =============================================================================*/
@@ -248,6 +357,8 @@ bool aaNetwork::pingIP(IPAddress address)
 
 /**
  * @brief Ping IP address usert specified number of times and return response.
+ * @details Blocks for up to a second for every ping. From loop() use amProbe,
+ * which does not wait.
  * @param IPAddress Address to ping. 
  * @param int8_t Number of times to ping address. 
  * @return bool Result of pings. 
@@ -259,45 +370,104 @@ bool aaNetwork::pingIP(IPAddress address, int8_t numPings)
 } // aaNetwork::pingIP()
 
 /**
- * @brief Scan 2.4GHz radio spectrum for known Access Point.
- * @return const char* Service Set IDentifier (SSID). 
+ * @brief Choose the strongest known Access Point a scan found.
+ * @param int16_t Number of Access Points the scan found. Negative if it failed.
+ * @return bool True if one was chosen. It is left in _foundAP.
  =============================================================================*/
-const char* aaNetwork::_lookForAP()
+bool aaNetwork::_pickAP(int16_t found)
 {
-   Serial.println("<aaNetwork::_lookForAP> Scanning the 2.4GHz radio spectrum for known Access Points.");
-   _ssid = _unknownAP; //  At the start no known Access Point has been foundto connect to
-   int numberOfNetworks = WiFi.scanNetworks(); // Used to track how many APs are detected by the scan
-   int StrongestSignal = -127; // Used to find the strongest signal. Set as low as possible to start
-   bool APknown; // Flag to indicate if the current AP appears in the known AP list
-   Serial.println(numberOfNetworks);
-
-   // Loop through all detected APs
-   for(int i = 0; i < numberOfNetworks; i++)
+   Serial.print("<aaNetwork::_pickAP> Scan found "); Serial.print(found); Serial.println(" Access Points.");
+   int32_t strongestSignal = -127; // Used to find the strongest signal. Set as low as possible to start
+   bool picked = false; // A known Access Point was seen.
+   for(int i = 0; i < found; i++)
    {
-      APknown = false;
-   
-      // Scan table of known APs to see if the current AP is known to us
-      for (int j = 0; j < numKnownAPs; j++)
+      String ssid = WiFi.SSID(i); // Name of this one.
+      if(_passwordFor(ssid.c_str()) == nullptr || WiFi.RSSI(i) <= strongestSignal)
       {
-         // If the current scanned AP appears in the known AP list note the index value and flag found
-         if(WiFi.SSID(i) == SSID[j])
-         {
-            APknown = true;
-            _SSIDIndex = j;
-         } //if
-      }   //for
+         continue; // Unknown, or weaker than one already picked.
+      } // if
+      strongestSignal = WiFi.RSSI(i);
+      memset(&_foundAP, 0, sizeof(_foundAP));
+      strncpy(_foundAP.ssid, ssid.c_str(), sizeof(_foundAP.ssid) - 1);
+      const uint8_t* bssid = WiFi.BSSID(i); // Join exactly this one.
+      if(bssid != nullptr)
+      {
+         memcpy(_foundAP.bssid, bssid, sizeof(_foundAP.bssid));
+      } // if
+      _foundAP.channel = WiFi.channel(i);
+      _foundAP.authMode = WiFi.encryptionType(i);
+      picked = true;
+   } // for
+   if(!picked)
+   {
+      Serial.println("<aaNetwork::_pickAP> No known Access Point SSID was detected. Will scan again.");
+   } // if
+   return picked;
+} // aaNetwork::_pickAP()
 
-      // If the current AP is known and has a stronger signal than the others that have been checked
-      // then store it in the variables that will be used to connect to the AP later
-      if((APknown == true) && (WiFi.SSID(i).toInt() > StrongestSignal))
+/**
+ * @brief Read the remembered Access Point from NVS.
+ * @return bool True if there is one and it is still in the known list.
+ =============================================================================*/
+bool aaNetwork::_loadAP()
+{
+   apStore.begin(NVS_NAMESPACE, true); // Open read only.
+   size_t len = apStore.getBytes(NVS_LAST_AP, &_cachedAP, sizeof(_cachedAP));
+   apStore.end();
+   _cachedAP.ssid[sizeof(_cachedAP.ssid) - 1] = '\0'; // Never trust what comes off flash.
+   if(len != sizeof(_cachedAP) || _cachedAP.channel == 0 || _passwordFor(_cachedAP.ssid) == nullptr)
+   {
+      memset(&_cachedAP, 0, sizeof(_cachedAP));
+      return false;
+   } // if
+   return true;
+} // aaNetwork::_loadAP()
+
+/**
+ * @brief Remember the Access Point we are connected to, for a fast connect 
+ * next time. Only writes to flash when it has changed.
+ =============================================================================*/
+void aaNetwork::_saveAP()
+{
+   aaNetworkAP current; // Where we are now.
+   memset(&current, 0, sizeof(current));
+   strncpy(current.ssid, WiFi.SSID().c_str(), sizeof(current.ssid) - 1);
+   const uint8_t* bssid = WiFi.BSSID(); // Hardware address of the Access Point.
+   if(bssid != nullptr)
+   {
+      memcpy(current.bssid, bssid, sizeof(current.bssid));
+   } // if
+   current.channel = WiFi.channel();
+   current.authMode = (strcmp(current.ssid, _foundAP.ssid) == 0) ? _foundAP.authMode : _cachedAP.authMode; // From the scan, if there was one.
+   if(memcmp(&current, &_cachedAP, sizeof(current)) == 0)
+   {
+      return; // Same as last time. Spare the flash.
+   } // if
+   _cachedAP = current;
+   apStore.begin(NVS_NAMESPACE, false); // Open for writing.
+   apStore.putBytes(NVS_LAST_AP, &_cachedAP, sizeof(_cachedAP));
+   apStore.end();
+   _link.setCache(true);
+   Serial.print("<aaNetwork::_saveAP> Remembered Access Point "); Serial.print(_cachedAP.ssid);
+   Serial.print(" on channel "); Serial.println(_cachedAP.channel);
+} // aaNetwork::_saveAP()
+
+/**
+ * @brief Look up the password of a known Access Point.
+ * @param const char* SSID of the Access Point.
+ * @return const char* Its password, or nullptr if it is not a known one.
+ =============================================================================*/
+const char* aaNetwork::_passwordFor(const char* ssid)
+{
+   for(int j = 0; j < numKnownAPs; j++)
+   {
+      if(SSID[j] == ssid)
       {
-         _ssid = SSID[_SSIDIndex].c_str();
-         _password = Password[_SSIDIndex].c_str();
-         StrongestSignal = WiFi.SSID(i).toInt();
-      } //if
-   } //for
-   return _ssid;
-} // aaNetwork::_lookForAP()
+         return Password[j].c_str();
+      } // if
+   } // for
+   return nullptr;
+} // aaNetwork::_passwordFor()
 
 /**
  * @brief Provide human readable wifi encryption method.
@@ -320,10 +490,8 @@ const char* aaNetwork::_translateEncryptionType(wifi_auth_mode_t encryptionType)
 
 /**
  * @brief Event handler for wifi.
- * @details Tracks all wifi event activity even though we do not act on any of 
- * it at this time. At the very least the logs help us trouble shoot wifi issues 
- * but this routine also acts as a reminder of what functional possibilities 
- * exist for future consideration.
+ * @details Logs all wifi event activity and counts IP addresses got and 
+ * disconnects for poll(). Runs in the WiFi event task, so it only counts.
  * @param WiFiEvent_t Type of event that triggered this handler.
  * @param WiFiEventInfo_t Additional information about the triggering event.
  =============================================================================*/
@@ -349,9 +517,11 @@ void aaNetwork::_wiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info)
          break;
       case SYSTEM_EVENT_STA_GOT_IP:
 //         wifiOnConnect(); // Call function to do things dependant upon getting wifi connected
+         _gotIpEvents++; // poll() takes it from here.
          Serial.println("<aaNetwork::WiFiEvent> Detected SYSTEM_EVENT_STA_GOT_IP");            
          break;
       case SYSTEM_EVENT_STA_DISCONNECTED:
+         _lostEvents++; // poll() takes it from here.
          Serial.println("<aaNetwork::WiFiEvent> Detected SYSTEM_EVENT_STA_DISCONNECTED");            
          break;
       case WL_NO_SSID_AVAIL:
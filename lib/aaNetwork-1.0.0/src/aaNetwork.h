@@ -14,6 +14,9 @@
 #include <aaFormat.h> // Collection of handy format conversion functions.
 #include <known_networks.h> // Defines Access points and passwords that the robot can scan for and connect to.
 #include <ESP32Ping.h> // Verify IP addresses. https://github.com/marian-craciunescu/ESP32Ping.
+#include <Preferences.h> // Remember the last Access Point in NVS.
+#include <amWifiLink.h> // When to fast connect, scan and join.
+#include <atomic> // Event counts handed from the WiFi event task to poll().
 
 /*! Valid values for wifi signal strength. */
 enum signalStrength 
@@ -29,6 +32,38 @@ enum signalStrength
 /// @ingroup globalVariables
 static const int8_t HOST_NAME_SIZE = 30; 
 
+/// Longest a fast connect to the remembered Access Point may take before scanning.
+/// @ingroup globalVariables
+static const uint32_t NET_FAST_TIMEOUT_MS = 3000;
+
+/// Longest a scan and the join after it may take together.
+/// @ingroup globalVariables
+static const uint32_t NET_ATTEMPT_TIMEOUT_MS = 15000;
+
+/// Wait after the first scan or join that fails. Doubles with each failure.
+/// @ingroup globalVariables
+static const uint32_t NET_RETRY_FIRST_MS = 2000;
+
+/// Longest wait between scans.
+/// @ingroup globalVariables
+static const uint32_t NET_RETRY_MAX_MS = 60000;
+
+/// How often poll() samples the signal strength while connected.
+/// @ingroup globalVariables
+static const uint32_t NET_RSSI_SAMPLE_MS = 1000;
+
+/*! Access Point remembered in NVS for the next fast connect. */
+struct aaNetworkAP
+{
+   char ssid[33]; ///< Name, null terminated.
+   uint8_t bssid[6]; ///< Hardware address.
+   uint8_t channel; ///< Channel it was on.
+   uint8_t authMode; ///< wifi_auth_mode_t it uses.
+}; // struct aaNetworkAP
+
+/*! Told of each step of bringing WiFi up. state is one of the WF_ states of amWifiLink. */
+typedef void (*aaNetworkProgress)(uint8_t state, uint32_t nowMs);
+
 /************************************************************************************
  * @class Manage wifi connection to Access Point.
  ************************************************************************************/
@@ -41,21 +76,38 @@ class aaNetwork
       void getUniqueName(char *ptrNameArray); // Construct a name that is sure to be unique on the network.
       bool areWeConnected(); // Return flag reporting if we are wifi connected or not.
       void cfgToConsole(); // Send wifi connection details to console.
-      void connect(); // Connect to Wifi.
+      void connect(); // Start connecting to Wifi. Returns at once.
+      void poll(uint32_t nowMs); // Move the connection along. Call from loop().
+      void onProgress(aaNetworkProgress callback) { _progress = callback; } // aaNetwork::onProgress()
+      amWifiLink& getLink() { return _link; } // aaNetwork::getLink()
+      uint32_t getTimeToIpMs() { return _link.getTimeToIpMs(); } // aaNetwork::getTimeToIpMs()
+      long getSignalStrength() { return _rssi; } // aaNetwork::getSignalStrength()
+      void forgetAP(); // Forget the remembered Access Point so the next connect scans.
       long rfSignalStrength(int8_t points); // Collect an average WiFi signal strength. 
       const char* evalSignal(int16_t signalStrength); // Return human readable assessment of signal strength.
       bool pingIP(IPAddress address); // Ping IP address and return response. Assume 1 ping.
       bool pingIP(IPAddress address, int8_t numPings); // Ping IP address and return response. User specified num pings.
    private:
-      const char* _lookForAP(); // Scan 2.4GHz radio spectrum for known Access Point.
+      bool _pickAP(int16_t found); // Choose the strongest known Access Point a scan found.
+      bool _loadAP(); // Read the remembered Access Point from NVS.
+      void _saveAP(); // Remember the Access Point we are connected to.
+      const char* _passwordFor(const char* ssid); // Password of a known Access Point.
       const char* _translateEncryptionType(wifi_auth_mode_t encryptionType); // Provide human readable wifi encryption method.
       const char* _connectionStatus(wl_status_t status); // Provide human readable text for wifi connection status codes. 
       static void _wiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info); // Event handler for wifi.
-      const char* _unknownAP = "unknown"; // Comparitor used to check if a valid AP was found.
-      const char* _ssid; // SSID of Access Point selected to connect to over Wifi. 
-      const char* _password; // Password of Access Point selected to connect to over Wifi.
       aaFormat _convert; // Accept various variable type/formats and return a different variable type/format.
-      int8_t _SSIDIndex = 0; // Contains the SSID index number from the known list of APs.
+      amWifiLink _link{NET_FAST_TIMEOUT_MS, NET_ATTEMPT_TIMEOUT_MS, NET_RETRY_FIRST_MS, NET_RETRY_MAX_MS}; // When to fast connect, scan and join.
+      aaNetworkAP _cachedAP; // Access Point remembered in NVS.
+      aaNetworkAP _foundAP; // Access Point picked by the last scan.
+      aaNetworkProgress _progress = nullptr; // Told of each state change.
+      uint8_t _lastState = WF_IDLE; // State at the end of the last poll().
+      uint32_t _gotIpSeen = 0; // _gotIpEvents handled by poll().
+      uint32_t _lostSeen = 0; // _lostEvents handled by poll().
+      bool _scanIssued = false; // Waiting on an asynchronous scan.
+      long _rssi = 0; // Running average of the signal strength. 0 until sampled.
+      uint32_t _rssiMs = 0; // When it was last sampled.
+      static std::atomic<uint32_t> _gotIpEvents; // IP addresses got, counted by the WiFi event task.
+      static std::atomic<uint32_t> _lostEvents; // Disconnects, counted by the WiFi event task.
       char _uniqueName[HOST_NAME_SIZE]; // Character array that holds unique name for Wifi network purposes. 
       char *_uniqueNamePtr = &_uniqueName[0]; // Pointer to first address position of unique name character array.
       const char* _HOST_NAME_PREFIX; // Prefix for unique network name. 
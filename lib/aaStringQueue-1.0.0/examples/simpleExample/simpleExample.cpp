@@ -103,8 +103,8 @@ void setup()
    cmdQueue.push(msg8);
    cmdQueue.dumpBuffer();
    Serial.println("<setup> Pull a message from the buffer.");
-   char str[cmdQueue.getMaxBufferSize()];
-   cmdQueue.pop(str);
+   char str[COMMAND_MAX_LENGTH];
+   cmdQueue.pop(str, sizeof(str));
    cmdQueue.dumpBuffer();
    Serial.print("<setup> myMessage = "); Serial.println(str);
    Serial.println("<setup> Clear the buffer.");
@@ -40,10 +40,6 @@
  *****************************************************************************/
 #include <aaStringQueue.h> // Header file for linking.
 
-// Define global variables.
-const int8_t BUFFER_MAX_SIZE = 5;
-const int8_t COMMAND_MAX_LENGTH = 20;
-char mqttCommandBuffer[BUFFER_MAX_SIZE][COMMAND_MAX_LENGTH] = { "", "", "", "", ""}; // Buffer.
 
 /**
  * @class Provide a FIFO queue for Strings.
@@ -59,14 +55,7 @@ aaStringQueue::aaStringQueue()
  * ==========================================================================*/
 bool aaStringQueue::isEmpty()
 {
-   if(_numCmdsBuffered == 0)
-   {
-      return true;
-   } //if
-   else
-   {
-      return false;
-   } //else
+   return _ring.isEmpty();
 } // aaStringQueue::isEmpty()
 
 /**
@@ -75,14 +64,7 @@ bool aaStringQueue::isEmpty()
  * ==========================================================================*/
 bool aaStringQueue::isFull() 
 {
-   if(_numCmdsBuffered >= BUFFER_MAX_SIZE)
-   {
-      return true;
-   } //if
-   else
-   {
-      return false;
-   } //else
+   return _ring.getCount() >= BUFFER_MAX_SIZE;
 } // aaStringQueue::isFull()
 
 /**
@@ -96,101 +78,84 @@ int8_t aaStringQueue::getMaxBufferSize()
 
 /**
  * @brief Reports the number of commands currently in the queue.
- * @return int8_t reports value of the _numCmdsBuffered variable.   
+ * @return int8_t number of commands waiting to be popped.   
  * ==========================================================================*/
 int8_t aaStringQueue::getCount() 
 {
-   return _numCmdsBuffered;
+   return _ring.getCount();
 } // aaStringQueue::getCount()
 
 /**
  * @brief Reports the number of commands that were discarded.
  * @details When the command buffer is full the oldest message is discarded 
- * to make room for a newer message. 
- * @return int8_t reports value of the _numCmdsLost variable.   
+ * to make room for a newer message. A message is also lost in the rare case
+ * that the slot it needs is still being popped. 
+ * @return uint32_t total commands lost since boot.   
  * ==========================================================================*/
-int8_t aaStringQueue::getLost() 
+uint32_t aaStringQueue::getLost() 
 {
-   return _numCmdsLost;
-} // aaStringQueue::getCount()
+   return _ring.getDropped() + _ring.getRejected();
+} // aaStringQueue::getLost()
 
 /**
  * @brief Clears the command queue.
- * @details Actually leaves the values in memory but chnages the counter so 
- * all slots are treated as empty.   
+ * @details Pops and discards everything waiting. Call from the same task that
+ * pops.   
  * ==========================================================================*/
 void aaStringQueue::flush() // Clear command queue.
 {
-   for(int i = BUFFER_MAX_SIZE - 1; i >= 0; i--)
+   char discard[COMMAND_MAX_LENGTH];
+   uint16_t len;
+   while(_ring.pop(discard, sizeof(discard), &len) == true)
    {
-      memset(mqttCommandBuffer[i],0,COMMAND_MAX_LENGTH);      
-   } // for
-   _numCmdsBuffered = 0;
+   } // while
 } // aaStringQueue::flush()
 
-/**
- * @brief Shift command buffer rows down.
- * @details Move each row of command buffer down leaving the top row empty.
- * ==========================================================================*/
-void aaStringQueue::_shiftBuffer() // Shift content in buffer down one position.
-{
-   for(int i = BUFFER_MAX_SIZE - 1; i >= 0; i--)
-   {
-      strcpy((char*)mqttCommandBuffer[i], (const char *)mqttCommandBuffer[i - 1]);      
-   } // for
-} // aaStringQueue::_shiftBuffer()
-
 /** 
- * @brief Sends the content of the buffer to the console. 
+ * @brief Sends the queue counters to the console. 
+ * @details Slot contents are not shown. They belong to whichever task is 
+ * pushing or popping at the time and could be read half written.
  * =================================================================================*/
 void aaStringQueue::dumpBuffer()
 {
-   Serial.print("<aaStringQueue::dumpBuffer> Buffer size = "); Serial.println(_numCmdsBuffered);
-   Serial.print("<aaStringQueue::dumpBuffer> Lost messages = "); Serial.println(_numCmdsLost);
-   for(int i = 0; i <= BUFFER_MAX_SIZE - 1; i++)
-   {
-      Serial.print("<aaStringQueue::dumpBuffer> Row ");
-      Serial.print(i);
-      Serial.print(" = "); 
-      Serial.println(mqttCommandBuffer[i]);
-   } // for
+   Serial.print("<aaStringQueue::dumpBuffer> Buffer size = "); Serial.println(getCount());
+   Serial.print("<aaStringQueue::dumpBuffer> Lost messages = "); Serial.println(getLost());
 } // aaStringQueue::dumpBuffer()
 
 /** 
  * @brief Adds a new command to the top of the queue.
- * @details Shift all previous commands done in the queue and add thhe newest command
- * to the top. If the queue is full then the bottom item (the odest one) gets dropped
- * and is never processed. The variable _numCmdsLost is used as a counter tracks this 
- * loss. 
+ * @details If the queue is full then the bottom item (the oldest one) gets 
+ * dropped and is never processed. getLost() counts this loss. Strings longer 
+ * than COMMAND_MAX_LENGTH - 1 are truncated. O(1), no locks, no allocation.
+ * @param char* 0 terminated string to add.
+ * @return bool false if the command was lost.
  * =================================================================================*/
-void aaStringQueue::push(char* newItem) // Add content to top of buffer.
+bool aaStringQueue::push(const char* newItem) // Add content to top of buffer.
 {
-   _shiftBuffer();
-   strcpy((char*)mqttCommandBuffer[0], newItem);
-   _numCmdsBuffered++;
-   if(_numCmdsBuffered > BUFFER_MAX_SIZE)
-   {
-      _numCmdsLost++;
-      _numCmdsBuffered = BUFFER_MAX_SIZE;
-   } //if
+   size_t len = strnlen(newItem, COMMAND_MAX_LENGTH - 1);
+   char item[COMMAND_MAX_LENGTH];
+   memcpy(item, newItem, len);
+   item[len] = '\0';
+   return _ring.push(item, len + 1);
 } // aaStringQueue::push()
 
 /** 
  * @brief Puts oldest content from the the buffer into the specified char array.
- * @details Return the oldest command in the buffer. The variable _numCmdsBuffered is
- * used to track the number of buffered command left. Note that the buffer index 
- * starts at 0 so we must subtract one from the index pointer to point at the 
- * corresponding slot. This means that subtracting one from the index counter first 
- * both points at the right slot and et the total number of buffered commands 
- * correctly when we are popping one off the stack.  
- * @param char* A pointer to the character array where the buffer command is placed.
+ * @param char* Where to put the command. Always 0 terminated when true is returned.
+ * @param size_t Size of dest. Longer commands are truncated. 
+ * @return bool true if there was a command, false if the queue was empty.
  * =================================================================================*/
-void aaStringQueue::pop(char* dest)
+bool aaStringQueue::pop(char* dest, size_t size)
 {
-   if(_numCmdsBuffered > 0)
+   if(size == 0)
    {
-      _numCmdsBuffered --; // Reduce count and aligns index to 0 based index slot.
-      strcpy(dest, (const char*)mqttCommandBuffer[_numCmdsBuffered]); // Pass command. 
-      memset(mqttCommandBuffer[_numCmdsBuffered], 0, COMMAND_MAX_LENGTH); // Clear slot.
+      return false;
+   } // if
+   uint16_t len;
+   if(_ring.pop(dest, size > COMMAND_MAX_LENGTH ? COMMAND_MAX_LENGTH : size, &len) == false)
+   {
+      return false;
    } // if
-} // aaStringQueue::pop()
\ No newline at end of file
+   dest[len - 1] = '\0'; // Cut short strings lose their terminator.
+   return true;
+} // aaStringQueue::pop()
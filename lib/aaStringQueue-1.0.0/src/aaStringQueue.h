@@ -7,11 +7,17 @@
 #define aaStringQueue_h // Precompiler macro used for precompiler check.
 
 #include <Arduino.h> // Arduino Core for ESP32. Comes with Platform.io
+#include <amRing.h> // Lock free single producer, single consumer ring.
 
 // Declare global variablles.
-extern const int8_t BUFFER_MAX_SIZE;
-extern const int8_t COMMAND_MAX_LENGTH;
+const int8_t BUFFER_MAX_SIZE = 8; // Commands held. Must be a power of 2.
+const int8_t COMMAND_MAX_LENGTH = 96; // Longest command, 0 terminator included. Room for a PATH of several segments.
 
+/**
+ * @class FIFO queue of short strings.
+ * @details One task may push while one other task pops. When the queue is full
+ * the oldest string is dropped to make room.
+ * ==========================================================================*/
 class aaStringQueue // Define aaStringQueue class 
 {
    public:
@@ -20,15 +26,13 @@ class aaStringQueue // Define aaStringQueue class
       bool isFull(); // Check if buffer is full.
       int8_t getMaxBufferSize(); // Return max size of command buffer.
       int8_t getCount(); // Return the current count of commands buffered. 
-      int8_t getLost(); // Return the number of commands that fell off the buffer. 
-      void dumpBuffer(); // Sends the content of the buffer to the console.
-      void flush(); // Clear command queue.
-      void push(char*); // Add content to top of buffer.
-      void pop(char*); // Puts oldest content from the the buffer into the specified char array.
+      uint32_t getLost(); // Return the number of commands that fell off the buffer. 
+      void dumpBuffer(); // Sends the queue counters to the console.
+      void flush(); // Clear command queue. Consumer only.
+      bool push(const char*); // Add content to top of buffer. Producer only.
+      bool pop(char*, size_t); // Puts oldest content from the the buffer into the specified char array. Consumer only.
    private:
-      void _shiftBuffer(); // Shift content in buffer down one position.
-      int8_t _numCmdsLost = 0; // Count messages dropped off the bottom of the buffer. 
-      int8_t _numCmdsBuffered = 0; // Count messages currently in the buffer. 
+      amRing<BUFFER_MAX_SIZE, COMMAND_MAX_LENGTH, RING_DROP_OLDEST> _ring; // Command slots.
 }; //class aaStringQueue
 
 extern aaStringQueue cmdBuffer; // Expose all public variables and methods for libraries.
@@ -16,6 +16,8 @@
  * 
  * YYYY-MM-DD Dev        Description
  * ---------- ---------- -------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam     Status web page filled in by the application.
+ * 2026-10-17 va3wam     Check a new broker with a TCP connect to its MQTT port, without blocking the web server.
  * 2021-03-28 Old Squire Fixed path to OTA web page.
  * 2021-03-17 Old Squire Program created.
  *************************************************************************************************************************************/
@@ -24,6 +26,9 @@ static const char* optionMessage; // Message to put at bottom of option web page
 static const char* titleName; // Name to use in web page titles.
 static bool haveNewBrokerIp; // Flag indicatng that a new Mqtt broker IP is available.
 static IPAddress newBrokerIp; // Contains validated new broker IP address.
+static IPAddress checkingBrokerIp; // Broker IP address most recently entered, being checked.
+static amProbe brokerProbe(BROKER_PROBE_TIMEOUT_MS, BROKER_PROBE_TTL_MS); // Checks for an MQTT broker listening.
+static aaWebStatusFn statusFn = nullptr; // Fills in the status web page.
 /**
  * @brief This is the default constructor for this class.
 ===================================================================================================*/
@@ -99,6 +104,7 @@ void aaWebService::_defineOptionPage(const char* nameForTitles)
                      "<h2>" + String(nameForTitles) + " Web Control</h2>"
                      "<input type=submit onclick=ota() class=btn value=OTA>"
                      "<input type=submit onclick=cfg() class=btn value=Config>"
+                     "<input type=submit onclick=status() class=btn value=Status>"
                      "<div>" + String(optionMessage) + "</div>"
                      "</form>"
                      "<script>"
@@ -108,6 +114,9 @@ void aaWebService::_defineOptionPage(const char* nameForTitles)
                      "function cfg() {"
                      "window.open('/cfgWebUpdate')"
                      "}"
+                     "function status() {"
+                     "window.open('/status')"
+                     "}"
                      "</script>" + _webPageStyle; 
 
 } //aaWebService::_defineOptionPage()
@@ -199,6 +208,7 @@ bool aaWebService::start(char *uniqueNamePtr)
    _cfgOtaPageHandler(); // Define event handler for Over The Air upload web page.
    _cfgSetMqttPageHandler(); // Define event handler for incoming post messages with new broker IP.
    _cfgSelectBinaryPageHandler(); // Define event handler for selecting binary file.
+   _cfgStatusPageHandler(); // Define event handler for the status web page.
    server.begin(); // Start web server
    return true;
 } //aaWebService::start()
@@ -274,7 +284,7 @@ void aaWebService::_cfgOtaPageHandler()
       {
          if (Update.end(true)) //true to set the size to the current progress
          { 
-            Serial.printf("Update Success: %u\nRebooting...\n", upload.totalSize);
+            Serial.printf("Update Success: %lu\nRebooting...\n", (unsigned long)upload.totalSize);
          } // if
          else 
          {
@@ -291,8 +301,8 @@ void aaWebService::_cfgSetMqttPageHandler()
 {
    server.on("/setMqtt", HTTP_POST, []() 
    {
-      const char* tmp = server.arg("mqttIp").c_str();
-      newMqttBrokerIp(tmp);
+      String tmp = server.arg("mqttIp"); // Keep the String until we are done with its characters.
+      newMqttBrokerIp(tmp.c_str());
       _defineOptionPage(titleName);
       server.sendHeader("Connection", "close");
       server.send(200, "text/html", _optionPage);
@@ -313,31 +323,104 @@ void aaWebService::_cfgSelectBinaryPageHandler()
 } //aaWebService::_cfgSendBinaryPageHandler()
 
 /**
- * @brief Check for pending client requests and service them as required.
+ * @brief Configure the status web page handler.
+ * @details The page is built on each request, from the function given to setStatusPage(), and
+ * reloads itself every STATUS_REFRESH_S seconds.
+===================================================================================================*/
+void aaWebService::_cfgStatusPageHandler()
+{
+   server.on("/status", HTTP_GET, []() 
+   {
+      String page = "<head><meta charset='utf-8'/><meta http-equiv='refresh' content='" + String(STATUS_REFRESH_S) + "'/></head>"
+                    "<h2>" + String(titleName) + " Status</h2>"
+                    "<pre style='background:#fff;color:#333;padding:15px;border-radius:5px'>";
+      if(statusFn == nullptr)
+      {
+         page += "Nothing to show.";
+      } //if
+      else
+      {
+         statusFn(page);
+      } //else
+      page += "</pre>" + _webPageStyle;
+      server.sendHeader("Connection", "close");
+      server.send(200, "text/html", page);
+   });
+} //aaWebService::_cfgStatusPageHandler()
+
+/**
+ * @brief Say what goes on the status web page.
+ * @param fn Adds the body of the page as plain text. Called for each request, from checkForClientRequest().
+===================================================================================================*/
+void aaWebService::setStatusPage(aaWebStatusFn fn)
+{
+   statusFn = fn;
+} //aaWebService::setStatusPage()
+
+/**
+ * @brief Handle a new IP address for the broker from the web.
+ * @details Starts a check that something accepts connections on the MQTT port of the address, and returns without waiting
+ * for it. _brokerChecked() is called with the answer, straight away if the address was checked recently, otherwise from
+ * checkForClientRequest() once it arrives.
+ * @param address Dotted decimal IP address.
+ * @return bool False if the address was rejected straight away.
 ===================================================================================================*/
 bool aaWebService::newMqttBrokerIp(const char* address) // Handle new IP address for broker from web.
 {
-   int8_t numPings = 1; // How many pings to send to verify IP address
    IPAddress tmpIp; 
-   tmpIp.fromString(address);
-   bool ret = Ping.ping(address, numPings);
-   Serial.print("<aaWebService::newMqttBrokerIp> Sent "); Serial.print(numPings);
-   Serial.print(" pings to new IP address "); Serial.print(tmpIp); 
-   Serial.print(" and got the response "); Serial.println(ret);
-   if(ret == 0)
+   if(!tmpIp.fromString(address))
    {
-      Serial.println("<aaWebService::newMqttBrokerIp> New broker IP address is invalid and has been discarded.");
+      Serial.print("<aaWebService::newMqttBrokerIp> "); Serial.print(address); Serial.println(" is not an IP address and has been discarded.");
+      optionMessage = "Broker IP rejected. Keeping Old Address";
+      return false;
+   } //if
+   checkingBrokerIp = tmpIp; // Only the answer for the latest address counts.
+   uint8_t ret = brokerProbe.probe((uint32_t)tmpIp, PROBE_TCP, PROBE_MQTT_PORT, millis(), _brokerChecked);
+   Serial.print("<aaWebService::newMqttBrokerIp> Checking for an MQTT broker at "); Serial.print(tmpIp); 
+   Serial.print(":"); Serial.print(PROBE_MQTT_PORT); Serial.print(" got the response "); Serial.println(ret);
+   if(ret == PROBE_PENDING)
+   {
+      optionMessage = "Checking broker IP. Reload for the result";
+      return true;
+   } //if
+   if(ret == PROBE_BUSY)
+   {
+      optionMessage = "Still checking other addresses. Try again";
+      return false;
+   } //if
+   amProbeResult result; // Answered from the cache, or at once.
+   brokerProbe.lookup((uint32_t)tmpIp, PROBE_TCP, PROBE_MQTT_PORT, millis(), &result);
+   result.status = ret; // lookup() forgets PROBE_ERROR answers that never went on the wire.
+   _brokerChecked(&result, nullptr);
+   return ret == PROBE_UP;
+} //aaWebService::newMqttBrokerIp()
+
+/**
+ * @brief Accept or reject a new broker IP address once the check of it is answered.
+ * @param result Answer to the check.
+ * @param arg Not used.
+===================================================================================================*/
+void aaWebService::_brokerChecked(const amProbeResult* result, void* arg)
+{
+   (void)arg;
+   IPAddress tmpIp(result->ip); 
+   if(result->ip != (uint32_t)checkingBrokerIp) return; // Another address was entered since.
+   Serial.print("<aaWebService::_brokerChecked> MQTT port of "); Serial.print(tmpIp); 
+   Serial.print(" answered "); Serial.print(result->status); Serial.print(" after "); Serial.print(result->rttMs); Serial.println("ms");
+   if(result->status != PROBE_UP)
+   {
+      Serial.println("<aaWebService::_brokerChecked> No broker listens at the new IP address. It has been discarded.");
       optionMessage = "Broker IP rejected. Keeping Old Address";
    } //if
    else
    {
-      Serial.print("<aaWebService::newMqttBrokerIp> MQTT broker IP will change to "); Serial.println(tmpIp);
+      Serial.print("<aaWebService::_brokerChecked> MQTT broker IP will change to "); Serial.println(tmpIp);
       optionMessage = "Broker IP successfully updated";
       newBrokerIp = tmpIp; // Store new broker IP to be collected by main later.
       haveNewBrokerIp = true; // Signal that new broker IP is available.
    } //else
-   return ret;
-} //aaWebService::newMqttBrokerIp()
+   _defineOptionPage(titleName); // Show the answer on the next reload.
+} //aaWebService::_brokerChecked()
 
 /**
  * @brief Get new broker IP address.
@@ -353,6 +436,7 @@ IPAddress aaWebService::getBrokerIP()
 bool aaWebService::checkForClientRequest()
 {
    server.handleClient();
+   brokerProbe.poll(millis()); // Calls _brokerChecked() when a check is answered.
    if(haveNewBrokerIp == true)
    {
       haveNewBrokerIp = false;
@@ -14,9 +14,17 @@
 #include <WiFiClient.h> // Communicating with web browser. Comes with Platform.io.
 #include <WebServer.h> // Hosting an HTTP server on the ESP32. Comes with Platform.io.
 #include <ESPmDNS.h> // Redirecting of incoming cient requests. Comes with Platform.io.
-#include <ESP32Ping.h> // Verify IP addresses. https://github.com/marian-craciunescu/ESP32Ping
+#include <amProbe.h> // Check for a broker without blocking the web server.
 #include <aaFormat.h> // Convert datatypes.
 
+/************************************************************************************
+ * @section aaWebServiceDefs Definitions.
+ ************************************************************************************/
+#define BROKER_PROBE_TIMEOUT_MS 2000 // Longest to wait for a new broker to accept a connection.
+#define BROKER_PROBE_TTL_MS 10000 // Answers reused for a broker entered again within this time.
+#define STATUS_REFRESH_S 5 // Seconds between reloads of the status web page.
+typedef void (*aaWebStatusFn)(String &page); // Adds the body of the status web page, as plain text.
+
 /************************************************************************************
  * @section aaWebServiceVars Global variables.
  ************************************************************************************/
@@ -43,13 +51,16 @@ class aaWebService
       bool connectStatus(); // Returns the status of the WiFi connection.
       static bool newMqttBrokerIp(const char* address); // Handle new IP address for broker from web.
       IPAddress getBrokerIP(); // Get new broker IP address.
+      void setStatusPage(aaWebStatusFn fn); // Say what goes on the status web page.
    private:
+      static void _brokerChecked(const amProbeResult* result, void* arg); // Answer to the check of a new broker IP address.
       void _cfgLoginPageHandler(); // Configure the main web page handler.
       void _cfgOptionPageHandler(); // Configure the option web page handler.
       void _cfgCfgPageHandler(); // Configure the configuration web page handler.
       void _cfgOtaPageHandler(); // Configure the OTA web page handler.
       void _cfgSetMqttPageHandler(); // Configure the set MQTT web page handler.
       void _cfgSelectBinaryPageHandler(); // Configuure the select binary web page handler.
+      void _cfgStatusPageHandler(); // Configure the status web page handler.
       void _defineStyleSheet(); // Defines style sheet used for all web pages. 
       void _defineLoginPage(const char* nameForTitles); //  Define login web page;
       static void _defineOptionPage(const char* nameForTitles); // Define options web page
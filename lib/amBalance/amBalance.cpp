@@ -0,0 +1,94 @@
+/*************************************************************************************************************************************
+ * @file amBalance.cpp
+ * @author va3wam
+ * @brief Control step for the balance loop of the two wheeled robot.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Added balanceCascadeStep()
+ *************************************************************************************************************************************/
+#include <amBalance.h> // Header file for linking.
+
+/**
+ * @brief Work out the motor command for one control cycle.
+ * @details Drives the wheels under the centre of mass: lean forward and the wheels accelerate
+ * forward. The wheel speed term lets the robot lean back to stop rather than drift off.
+ * @param gains Controller gains and limits.
+ * @param input Pitch, pitch rate and wheel speed for this cycle.
+ * @return Motor command and fallen flag.
+===================================================================================================*/
+balanceOutput balanceStep(const balanceGains &gains, const balanceInput &input)
+{
+   balanceOutput output = {0.0f, false};
+   if(input.pitch > gains.maxTilt || input.pitch < -gains.maxTilt) // Past saving. Let it lie.
+   {
+      output.fallen = true;
+      return output;
+   } // if
+   float command = gains.kpAngle * input.pitch + gains.kdAngle * input.pitchRate + gains.kpSpeed * input.wheelSpeed;
+   if(command > gains.maxCommand)
+   {
+      command = gains.maxCommand;
+   } // if
+   else if(command < -gains.maxCommand)
+   {
+      command = -gains.maxCommand;
+   } // else if
+   output.command = command;
+   return output;
+} // balanceStep()
+
+/**
+ * @brief Work out the motor command for one control cycle with the cascaded PID loops.
+ * @details The speed loop picks a lean that will bring the wheels to targetSpeed, and the angle
+ * loop drives the wheels under the centre of mass to hold that lean. Leaning further forward than
+ * the target needs the wheels to accelerate forward, which is the opposite sign to a normal PID
+ * output, so the angle loop output is negated. Both loops start again once the robot has fallen.
+ * @param pid Controller state. Must be called at BALANCE_CASCADE_HZ.
+ * @param gains Only maxTilt is used. Loop gains are fixed in balanceAngleLoop and balanceSpeedLoop.
+ * @param input Pitch and wheel speed for this cycle.
+ * @param targetSpeed Wheel speed wanted in metres/second.
+ * @return Motor command and fallen flag.
+===================================================================================================*/
+balanceOutput balanceCascadeStep(balanceCascade &pid, const balanceGains &gains, const balanceInput &input, float targetSpeed)
+{
+   balanceOutput output = {0.0f, false};
+   if(input.pitch > gains.maxTilt || input.pitch < -gains.maxTilt) // Past saving. Let it lie.
+   {
+      pid.reset(input.wheelSpeed, input.pitch);
+      output.fallen = true;
+      return output;
+   } // if
+   output.command = -pid.update(targetSpeed, input.wheelSpeed, input.pitch);
+   return output;
+} // balanceCascadeStep()
+
+/**
+ * @brief Convert a motor command to a value for the MD25 speed registers.
+ * @param command Motor command. Clamped to -128..127.
+ * @return 0 (full reverse), 128 (stop), 255 (full forward).
+===================================================================================================*/
+uint8_t balanceToSpeed(float command)
+{
+   int32_t speed = (int32_t)(command + ((command < 0.0f) ? -0.5f : 0.5f)); // Round to nearest.
+   if(speed > 127)
+   {
+      speed = 127;
+   } // if
+   else if(speed < -128)
+   {
+      speed = -128;
+   } // else if
+   return (uint8_t)(speed + 128);
+} // balanceToSpeed()
@@ -0,0 +1,93 @@
+/*************************************************************************************************************************************
+ * @file amBalance.h
+ * @author va3wam
+ * @brief Control step for the balance loop of the two wheeled robot.
+ * @details balanceStep() is a pure function. It turns one set of sensor readings into one motor command and touches nothing else,
+ * so the same code runs in the firmware balance task and in host tests against a simulated plant.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Added the cascaded speed/angle PID controller
+ *************************************************************************************************************************************/
+#ifndef amBalance_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amBalance_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <amPid.h> // Compile time PID controller and cascade.
+
+/*! Gains and limits for the balance controller. */
+struct balanceGains
+{
+   float kpAngle; ///< Command per radian of pitch.
+   float kdAngle; ///< Command per radian/second of pitch rate.
+   float kpSpeed; ///< Command per metre/second of wheel speed.
+   float maxTilt; ///< Pitch (radians) beyond which the robot is treated as fallen.
+   float maxCommand; ///< Largest command magnitude sent to the motors.
+}; // struct
+
+#define BALANCE_DEFAULT_GAINS {250.0f, 20.0f, 10.0f, 0.6f, 127.0f} // Starting point for tuning. See test_balance.
+
+/*! What the controller needs to know about the robot this cycle. */
+struct balanceInput
+{
+   float pitch; ///< Lean in radians. Positive leans forward.
+   float pitchRate; ///< Pitch rate in radians/second.
+   float wheelSpeed; ///< Average wheel speed in metres/second. Positive is forward.
+}; // struct
+
+/*! What the controller wants the motors to do this cycle. */
+struct balanceOutput
+{
+   float command; ///< Motor command, -maxCommand (full reverse) to maxCommand (full forward).
+   bool fallen; ///< Pitch is beyond maxTilt. Command is 0.
+}; // struct
+
+/*! Inner loop of the cascade. Holds the pitch the speed loop asks for. Output is the motor command, negated. */
+struct balanceAngleLoop
+{
+   static constexpr float kp = 250.0f; ///< Command per radian of pitch error.
+   static constexpr float ki = 0.0f; ///< The speed loop integral takes care of a centre of mass offset.
+   static constexpr float kd = 20.0f; ///< Command per radian/second of pitch rate.
+   static constexpr float dt = 0.005f; ///< Runs every balance cycle at 200Hz.
+   static constexpr float outMin = -127.0f; ///< Full forward, once negated.
+   static constexpr float outMax = 127.0f; ///< Full reverse, once negated.
+   static constexpr float iMin = 0.0f; ///< Not used.
+   static constexpr float iMax = 0.0f; ///< Not used.
+   static constexpr float slewRate = 0.0f; ///< No limit. The pendulum needs every bit of response it can get.
+}; // struct
+
+/*! Outer loop of the cascade. Holds the wheel speed by leaning. Output is the target pitch in radians. */
+struct balanceSpeedLoop
+{
+   static constexpr float kp = 0.04f; ///< Radians of lean per metre/second of speed error.
+   static constexpr float ki = 0.01f; ///< Trims out a centre of mass that is not over the axle.
+   static constexpr float kd = 0.0f; ///< Not used.
+   static constexpr float dt = 0.02f; ///< Runs every fourth balance cycle.
+   static constexpr float outMin = -0.2f; ///< Never ask for more lean than this.
+   static constexpr float outMax = 0.2f; ///< Never ask for more lean than this.
+   static constexpr float iMin = -0.1f; ///< Largest offset the integral can trim.
+   static constexpr float iMax = 0.1f; ///< Largest offset the integral can trim.
+   static constexpr float slewRate = 1.0f; ///< Radians/second. Stops a speed step from snapping the target lean.
+}; // struct
+
+typedef amPidCascade<balanceSpeedLoop, balanceAngleLoop> balanceCascade; // Speed loop cascaded into the angle loop.
+
+#define BALANCE_CASCADE_HZ 200 // Balance loop rate the cascade gains were designed for.
+
+balanceOutput balanceStep(const balanceGains &gains, const balanceInput &input); // One control step.
+balanceOutput balanceCascadeStep(balanceCascade &pid, const balanceGains &gains, const balanceInput &input, float targetSpeed); // One cascade step.
+uint8_t balanceToSpeed(float command); // Motor command as an MD25 mode 0/2 speed register value.
+
+#endif // End of precompiler protected code block
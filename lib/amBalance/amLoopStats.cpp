@@ -0,0 +1,162 @@
+/*************************************************************************************************************************************
+ * @file amLoopStats.cpp
+ * @author va3wam
+ * @brief Timing statistics for a fixed rate loop.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <amLoopStats.h> // Header file for linking.
+
+/**
+ * @brief This is the constructor for this class.
+ * @param periodUs Nominal loop period in microseconds.
+===================================================================================================*/
+amLoopStats::amLoopStats(uint32_t periodUs) : _periodUs(periodUs)
+{
+
+} // amLoopStats::amLoopStats()
+
+/**
+ * @brief Change the nominal period.
+ * @param periodUs Nominal loop period in microseconds.
+===================================================================================================*/
+void amLoopStats::setPeriod(uint32_t periodUs)
+{
+   _periodUs = periodUs;
+   reset();
+} // amLoopStats::setPeriod()
+
+/**
+ * @brief Report the nominal period.
+ * @return Nominal loop period in microseconds.
+===================================================================================================*/
+uint32_t amLoopStats::getPeriod()
+{
+   return _periodUs;
+} // amLoopStats::getPeriod()
+
+/**
+ * @brief Add one cycle to the statistics.
+ * @details Jitter is measured between the wake up times of consecutive cycles so the first cycle
+ * after a reset only contributes its execution time.
+ * @param startUs micros() when the cycle woke.
+ * @param endUs micros() when the cycle finished.
+===================================================================================================*/
+void amLoopStats::record(uint32_t startUs, uint32_t endUs)
+{
+   uint32_t exec = endUs - startUs; // Unsigned maths copes with micros() wrapping.
+   _execLastUs = exec;
+   _execTotalUs += exec;
+   if(exec > _execMaxUs)
+   {
+      _execMaxUs = exec;
+   } // if
+   if(exec > _periodUs) // Next tick arrived before this cycle finished.
+   {
+      _overruns++;
+   } // if
+   if(_cycles > 0)
+   {
+      uint32_t period = startUs - _lastStartUs;
+      uint32_t jitter = (period > _periodUs) ? period - _periodUs : _periodUs - period;
+      if(jitter > _jitterMaxUs)
+      {
+         _jitterMaxUs = jitter;
+      } // if
+   } // if
+   _lastStartUs = startUs;
+   _cycles++;
+} // amLoopStats::record()
+
+/**
+ * @brief Count timer ticks that went by without a cycle running.
+ * @param ticks Number of ticks missed.
+===================================================================================================*/
+void amLoopStats::recordMissed(uint32_t ticks)
+{
+   _overruns += ticks;
+} // amLoopStats::recordMissed()
+
+/**
+ * @brief Clear the statistics.
+===================================================================================================*/
+void amLoopStats::reset()
+{
+   _cycles = 0;
+   _lastStartUs = 0;
+   _execLastUs = 0;
+   _execMaxUs = 0;
+   _execTotalUs = 0;
+   _jitterMaxUs = 0;
+   _overruns = 0;
+} // amLoopStats::reset()
+
+/**
+ * @brief Report how many cycles have been recorded.
+ * @return Cycles since the last reset.
+===================================================================================================*/
+uint32_t amLoopStats::getCycles()
+{
+   return _cycles;
+} // amLoopStats::getCycles()
+
+/**
+ * @brief Report the execution time of the latest cycle.
+ * @return Microseconds.
+===================================================================================================*/
+uint32_t amLoopStats::getExecLastUs()
+{
+   return _execLastUs;
+} // amLoopStats::getExecLastUs()
+
+/**
+ * @brief Report the longest execution time.
+ * @return Microseconds.
+===================================================================================================*/
+uint32_t amLoopStats::getExecMaxUs()
+{
+   return _execMaxUs;
+} // amLoopStats::getExecMaxUs()
+
+/**
+ * @brief Report the mean execution time.
+ * @return Microseconds. 0 before the first cycle.
+===================================================================================================*/
+uint32_t amLoopStats::getExecAvgUs()
+{
+   if(_cycles == 0)
+   {
+      return 0;
+   } // if
+   return (uint32_t)(_execTotalUs / _cycles);
+} // amLoopStats::getExecAvgUs()
+
+/**
+ * @brief Report the worst difference between the measured and nominal period.
+ * @return Microseconds.
+===================================================================================================*/
+uint32_t amLoopStats::getJitterMaxUs()
+{
+   return _jitterMaxUs;
+} // amLoopStats::getJitterMaxUs()
+
+/**
+ * @brief Report how many cycles overran the period plus how many ticks were missed.
+ * @return Overrun count.
+===================================================================================================*/
+uint32_t amLoopStats::getOverruns()
+{
+   return _overruns;
+} // amLoopStats::getOverruns()
@@ -0,0 +1,58 @@
+/*************************************************************************************************************************************
+ * @file amLoopStats.h
+ * @author va3wam
+ * @brief Timing statistics for a fixed rate loop.
+ * @details The loop calls record() once per cycle with the time it woke and the time it finished. From that the class keeps the
+ * execution time of each cycle, the worst case jitter of the wake up time against the nominal period and a count of overruns
+ * (cycles that took longer than the period plus ticks that were missed altogether). Times are in microseconds and wrap safely.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amLoopStats_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amLoopStats_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+
+/*************************************************************************************************************************************
+ * @class Execution time, jitter and overrun counts for a fixed rate loop.
+ *************************************************************************************************************************************/
+class amLoopStats
+{
+   public:
+      amLoopStats(uint32_t periodUs); // Class constructor.
+      void setPeriod(uint32_t periodUs); // Change the nominal period. Clears the statistics.
+      uint32_t getPeriod(); // Nominal period in microseconds.
+      void record(uint32_t startUs, uint32_t endUs); // Add one cycle.
+      void recordMissed(uint32_t ticks); // Add timer ticks that were never serviced.
+      void reset(); // Clear the statistics.
+      uint32_t getCycles(); // Cycles recorded.
+      uint32_t getExecLastUs(); // Execution time of the latest cycle.
+      uint32_t getExecMaxUs(); // Longest execution time.
+      uint32_t getExecAvgUs(); // Mean execution time.
+      uint32_t getJitterMaxUs(); // Worst difference between the measured and nominal period.
+      uint32_t getOverruns(); // Cycles that ran past the period plus missed ticks.
+   private:
+      uint32_t _periodUs; // Nominal period.
+      uint32_t _cycles = 0; // Cycles recorded.
+      uint32_t _lastStartUs = 0; // When the previous cycle woke.
+      uint32_t _execLastUs = 0; // Execution time of the latest cycle.
+      uint32_t _execMaxUs = 0; // Longest execution time.
+      uint64_t _execTotalUs = 0; // Sum of execution times for the mean.
+      uint32_t _jitterMaxUs = 0; // Worst period error.
+      uint32_t _overruns = 0; // Overruns and missed ticks.
+}; // class amLoopStats
+
+#endif // End of precompiler protected code block
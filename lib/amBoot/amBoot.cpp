@@ -0,0 +1,352 @@
+/*************************************************************************************************************************************
+ * @file amBoot.cpp
+ * @author va3wam
+ * @brief Boot profiler and dependency aware start up sequence.
+ * @details See amBoot.h.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Hook run by each phase task before it is deleted
+ * 2026-10-17 va3wam Milestones after a failed phase are not reached
+ *************************************************************************************************************************************/
+#include <amBoot.h> // Header file for linking.
+#include <stdio.h> // snprintf().
+#include <string.h> // memset().
+#if defined(ARDUINO) || defined(ZIPPY_NATIVE) // Tasks and micros() only exist on Arduino targets and the host shims.
+#include <Arduino.h> // micros().
+#include <freertos/FreeRTOS.h> // FreeRTOS types.
+#include <freertos/task.h> // One task per phase.
+#endif
+
+/**
+ * @brief This is the constructor for this class. The sequence starts empty.
+===================================================================================================*/
+amBoot::amBoot() : _ended(0)
+{
+   memset(_phases, 0, sizeof(_phases));
+} // amBoot::amBoot()
+
+/**
+ * @brief Add a phase to the graph.
+ * @param name Short name for the report. Must outlive this object.
+ * @param fn What the phase does. nullptr makes it a milestone.
+ * @param arg Handed to fn.
+ * @param after BOOT_AFTER() mask of the phases it comes after. Only phases already added.
+ * @param core Core to run it on, or BOOT_ANY_CORE.
+ * @return Phase id, or BOOT_NO_PHASE if the table is full or after names a phase not yet added.
+===================================================================================================*/
+uint8_t amBoot::add(const char* name, amBootFn fn, void* arg, uint32_t after, int8_t core)
+{
+   if(_count >= BOOT_MAX_PHASES || (after >> _count) != 0) return BOOT_NO_PHASE;
+   for(uint8_t i = 0; i < _count; i++)
+   {
+      if((after & BOOT_AFTER(i)) && !_phases[i].inGraph) return BOOT_NO_PHASE; // Records are not part of the graph.
+   } // for
+   amBootPhase &phase = _phases[_count];
+   phase.name = name;
+   phase.fn = fn;
+   phase.arg = arg;
+   phase.after = after;
+   phase.core = core;
+   phase.inGraph = true;
+   phase.state = BOOT_PENDING;
+   phase.id = _count;
+   phase.owner = this;
+   return _count++;
+} // amBoot::add()
+
+/**
+ * @brief Add something timed outside the graph, e.g. setup() work before run() or WiFi getting an address.
+ * @param name Short name for the report. Must outlive this object.
+ * @param startUs micros() when it started.
+ * @param endUs micros() when it ended.
+ * @return Record id, or BOOT_NO_PHASE if the table is full.
+===================================================================================================*/
+uint8_t amBoot::record(const char* name, uint32_t startUs, uint32_t endUs)
+{
+   if(_count >= BOOT_MAX_PHASES) return BOOT_NO_PHASE;
+   amBootPhase &phase = _phases[_count];
+   phase.name = name;
+   phase.inGraph = false;
+   phase.state = BOOT_DONE;
+   phase.startUs = startUs;
+   phase.endUs = endUs;
+   phase.id = _count;
+   phase.owner = this;
+   return _count++;
+} // amBoot::record()
+
+/**
+ * @brief Set the times of a phase without running it. Used to simulate a boot from known phase costs.
+ * @param id Phase id.
+ * @param startUs When it started.
+ * @param endUs When it ended.
+===================================================================================================*/
+void amBoot::setTimes(uint8_t id, uint32_t startUs, uint32_t endUs)
+{
+   if(id >= _count) return;
+   _phases[id].startUs = startUs;
+   _phases[id].endUs = endUs;
+   _phases[id].state = BOOT_DONE;
+} // amBoot::setTimes()
+
+/**
+ * @brief Work out the longest chain of phases through the graph.
+ * @details Phases only come after phases added before them, so one pass in the order added visits every phase after all of its
+ * predecessors. Each phase can start once the last of them has ended, and the latest finish over the whole graph is the length
+ * of the critical path. Following back through the predecessor that ended last marks the phases on it.
+===================================================================================================*/
+void amBoot::_findCriticalPath()
+{
+   uint32_t finish[BOOT_MAX_PHASES]; // Earliest each phase could end.
+   uint8_t via[BOOT_MAX_PHASES]; // Predecessor that ended last.
+   uint8_t last = BOOT_NO_PHASE; // Phase that ends the critical path.
+   _criticalUs = 0;
+   _criticalMask = 0;
+   for(uint8_t i = 0; i < _count; i++)
+   {
+      finish[i] = 0;
+      via[i] = BOOT_NO_PHASE;
+      if(!_phases[i].inGraph) continue;
+      uint32_t start = 0;
+      for(uint8_t d = 0; d < i; d++)
+      {
+         if((_phases[i].after & BOOT_AFTER(d)) && finish[d] >= start)
+         {
+            start = finish[d];
+            via[i] = d;
+         } // if
+      } // for
+      finish[i] = start + (_phases[i].endUs - _phases[i].startUs);
+      if(last == BOOT_NO_PHASE || finish[i] > _criticalUs)
+      {
+         _criticalUs = finish[i];
+         last = i;
+      } // if
+   } // for
+   for(uint8_t i = last; i != BOOT_NO_PHASE; i = via[i])
+   {
+      _criticalMask |= BOOT_AFTER(i);
+   } // for
+} // amBoot::_findCriticalPath()
+
+/**
+ * @brief Length of the critical path: the shortest the graph could take with every phase starting as soon as it may.
+ * @return uint32_t Microseconds.
+===================================================================================================*/
+uint32_t amBoot::getCriticalPathUs()
+{
+   _findCriticalPath();
+   return _criticalUs;
+} // amBoot::getCriticalPathUs()
+
+/**
+ * @brief Say whether a phase is on the critical path. Making it faster would make the boot faster.
+ * @param id Phase id.
+ * @return bool True if it is.
+===================================================================================================*/
+bool amBoot::isCritical(uint8_t id)
+{
+   _findCriticalPath();
+   return id < _count && (_criticalMask & BOOT_AFTER(id)) != 0;
+} // amBoot::isCritical()
+
+/**
+ * @brief Time the graph would take with its phases one after another, as setup() used to run them.
+ * @return uint32_t Microseconds.
+===================================================================================================*/
+uint32_t amBoot::getSerialUs()
+{
+   uint32_t total = 0;
+   for(uint8_t i = 0; i < _count; i++)
+   {
+      if(_phases[i].inGraph) total += _phases[i].endUs - _phases[i].startUs;
+   } // for
+   return total;
+} // amBoot::getSerialUs()
+
+/**
+ * @brief Time the graph actually took.
+ * @return uint32_t Microseconds from the first graph phase starting to the last one ending. 0 before run().
+===================================================================================================*/
+uint32_t amBoot::getWallUs()
+{
+   bool any = false;
+   uint32_t first = 0;
+   uint32_t last = 0;
+   for(uint8_t i = 0; i < _count; i++)
+   {
+      if(!_phases[i].inGraph || _phases[i].state < BOOT_DONE) continue;
+      if(!any || (int32_t)(_phases[i].startUs - first) < 0) first = _phases[i].startUs;
+      if(!any || (int32_t)(_phases[i].endUs - last) > 0) last = _phases[i].endUs;
+      any = true;
+   } // for
+   return any ? last - first : 0;
+} // amBoot::getWallUs()
+
+/**
+ * @brief Write a one line breakdown of the boot.
+ * @details Totals first, then each entry as name@start+length in ms, start counted from reset. Phases on the critical path are
+ * marked with *, phases that failed with !, and records, which are outside the graph, with ~. Entries that do not fit are left
+ * off and the line ends in ... instead.
+ * @param buf Where to write it.
+ * @param len Size of buf.
+ * @return size_t Characters written, not counting the 0.
+===================================================================================================*/
+size_t amBoot::report(char* buf, size_t len)
+{
+   if(buf == nullptr || len == 0) return 0;
+   uint32_t critical = getCriticalPathUs();
+   uint32_t wall = getWallUs();
+   uint32_t serial = getSerialUs();
+   int used = snprintf(buf, len, "boot %lu.%lu ms, critical path %lu.%lu ms, serial %lu.%lu ms:",
+                       (unsigned long)(wall / 1000), (unsigned long)(wall % 1000 / 100),
+                       (unsigned long)(critical / 1000), (unsigned long)(critical % 1000 / 100),
+                       (unsigned long)(serial / 1000), (unsigned long)(serial % 1000 / 100));
+   if(used < 0 || (size_t)used >= len) return len - 1;
+   for(uint8_t i = 0; i < _count; i++)
+   {
+      const amBootPhase &p = _phases[i];
+      uint32_t lengthUs = p.endUs - p.startUs;
+      const char* mark = !p.inGraph ? "~" : (p.state == BOOT_FAILED) ? "!" : (_criticalMask & BOOT_AFTER(i)) ? "*" : "";
+      char entry[48];
+      int n = snprintf(entry, sizeof(entry), " %s%s@%lu+%lu.%lu", p.name, mark, (unsigned long)(p.startUs / 1000),
+                       (unsigned long)(lengthUs / 1000), (unsigned long)(lengthUs % 1000 / 100));
+      if(n < 0) continue;
+      if((size_t)(used + n) + 4 >= len) // Keep room for " ..." and the 0.
+      {
+         used += snprintf(buf + used, len - used, " ...");
+         break;
+      } // if
+      memcpy(buf + used, entry, n + 1);
+      used += n;
+   } // for
+   return (size_t)used;
+} // amBoot::report()
+
+#if defined(ARDUINO) || defined(ZIPPY_NATIVE)
+/**
+ * @brief FreeRTOS task body. Runs one phase and deletes its own task.
+ * @param param The amBootPhase to run.
+===================================================================================================*/
+void amBoot::_phaseTask(void* param)
+{
+   amBootPhase* phase = (amBootPhase*)param;
+   amBootTaskEndFn taskEnd = phase->owner->_taskEnd; // Copied first. The sequence may be gone once run() has returned.
+   phase->owner->_runPhase(phase);
+   if(taskEnd != nullptr)
+   {
+      taskEnd();
+   } // if
+   vTaskDelete(NULL); // Tasks must not return.
+} // amBoot::_phaseTask()
+
+/**
+ * @brief Say whether a milestone was reached.
+ * @param phase The milestone.
+ * @return bool True if every phase it comes after worked.
+===================================================================================================*/
+bool amBoot::_reached(amBootPhase* phase)
+{
+   for(uint8_t i = 0; i < phase->id; i++)
+   {
+      if((phase->after & BOOT_AFTER(i)) && _phases[i].state != BOOT_DONE) return false;
+   } // for
+   return true;
+} // amBoot::_reached()
+
+/**
+ * @brief Time a phase, then tell run() it has ended.
+ * @param phase The phase to run.
+===================================================================================================*/
+void amBoot::_runPhase(amBootPhase* phase)
+{
+   phase->startUs = micros();
+   bool ok = (phase->fn == nullptr) ? _reached(phase) : phase->fn(phase->arg);
+   phase->endUs = micros();
+   phase->state = ok ? BOOT_DONE : BOOT_FAILED;
+   _ended.fetch_or(BOOT_AFTER(phase->id)); // Publishes the times above to run().
+   if(_runner != nullptr)
+   {
+      xTaskNotifyGive((TaskHandle_t)_runner);
+   } // if
+} // amBoot::_runPhase()
+
+/**
+ * @brief Run the graph.
+ * @details Every phase whose predecessors have all ended is started in a task of its own, pinned to its core if it has one.
+ * Milestones are ended by run() itself, and fail if any phase they come after failed. If a task cannot be created the phase runs in the caller instead, so the boot still
+ * completes, only more slowly. The caller sleeps while phases run and is woken as each one ends.
+ * @param stackBytes Stack for each phase task.
+ * @param priority Priority of each phase task.
+ * @return bool True if every phase said it worked.
+===================================================================================================*/
+bool amBoot::run(uint32_t stackBytes, uint8_t priority)
+{
+   _runner = (void*)xTaskGetCurrentTaskHandle(); // nullptr when not called from a task, as setup() on the host.
+   uint32_t graph = 0; // Every graph phase.
+   for(uint8_t i = 0; i < _count; i++)
+   {
+      if(_phases[i].inGraph) graph |= BOOT_AFTER(i);
+   } // for
+   uint32_t started = 0; // Phases started so far.
+   uint32_t ended = _ended.load();
+   while(ended != graph)
+   {
+      bool progress = false; // A milestone or an inline phase ended, so look again before sleeping.
+      for(uint8_t i = 0; i < _count; i++)
+      {
+         amBootPhase &p = _phases[i];
+         if(!p.inGraph || (started & BOOT_AFTER(i)) || (p.after & ~ended) != 0) continue;
+         started |= BOOT_AFTER(i);
+         p.state = BOOT_RUNNING;
+         if(p.fn == nullptr)
+         {
+            _runPhase(&p); // Milestone. Ends now.
+            progress = true;
+            continue;
+         } // if
+         BaseType_t core = (p.core == BOOT_ANY_CORE) ? tskNO_AFFINITY : p.core;
+         if(xTaskCreatePinnedToCore(_phaseTask, p.name, stackBytes, &p, priority, NULL, core) == pdPASS)
+         {
+            _tasksStarted++;
+         } // if
+         else
+         {
+            _runPhase(&p); // No memory for a task. Run it here.
+            progress = true;
+         } // else
+      } // for
+      if(!progress)
+      {
+         if(_runner != nullptr)
+         {
+            ulTaskNotifyTake(pdTRUE, 1); // Woken as soon as a phase ends. The tick is a backstop.
+         } // if
+         else
+         {
+            vTaskDelay(1); // Cannot be notified. Look again each tick.
+         } // else
+      } // if
+      ended = _ended.load();
+   } // while
+   _runner = nullptr;
+   bool ok = true;
+   for(uint8_t i = 0; i < _count; i++)
+   {
+      if(_phases[i].inGraph && _phases[i].state != BOOT_DONE) ok = false;
+   } // for
+   return ok;
+} // amBoot::run()
+#endif // defined(ARDUINO) || defined(ZIPPY_NATIVE)
@@ -0,0 +1,123 @@
+/*************************************************************************************************************************************
+ * @file amBoot.h
+ * @author va3wam
+ * @brief Boot profiler and dependency aware start up sequence.
+ * @details Start up is split into phases. Each phase names the phases it must come after, and run() starts every phase whose
+ * predecessors have finished, each in its own FreeRTOS task, so phases that do not depend on each other run at the same time.
+ * The caller of run() only waits. Phases may only come after phases added before them, which keeps the graph free of cycles.
+ * A phase with no function is a milestone: it ends the moment the phases it comes after have ended, e.g. "ready to balance".
+ * It is only reached, BOOT_DONE, if all of them worked. Otherwise it ends as BOOT_FAILED.
+ *
+ * Every phase is timed with micros(). Things that happen outside the graph, such as setup() work before it or WiFi getting an
+ * address long after it, can be added with record(). getCriticalPathUs() works out the longest chain of phases through the
+ * graph from their times: the boot can never be faster than that however many phases run at once. Setting the times by hand
+ * with setTimes() and asking for the critical path is a simulation of a boot that has not happened.
+ * Example:
+ * @code
+ * amBoot boot;
+ * uint8_t scan = boot.add("scan", scanBus, nullptr, 0);
+ * uint8_t imu = boot.add("imu", initImu, nullptr, BOOT_AFTER(scan), 1); // On core 1.
+ * boot.add("wifi", startWifi, nullptr, 0); // Alongside the I2C phases.
+ * boot.milestone("ready", BOOT_AFTER(imu));
+ * boot.run(4096, 1); // Returns when every phase has ended.
+ * char text[384];
+ * boot.report(text, sizeof(text));
+ * @endcode
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Hook run by each phase task before it is deleted
+ * 2026-10-17 va3wam Milestones after a failed phase are not reached
+ *************************************************************************************************************************************/
+#ifndef amBoot_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amBoot_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <stddef.h> // size_t.
+#include <atomic> // Finished phases, handed from the phase tasks to run().
+
+#define BOOT_MAX_PHASES 16 // Phases and records. One bit each in a 32 bit mask with room to spare.
+#define BOOT_NO_PHASE 0xFF // Returned by add() and record() when the phase cannot be added.
+#define BOOT_ANY_CORE -1 // Phase may run on either core.
+#define BOOT_AFTER(id) (1UL << (id)) // Phase comes after phase id. OR several together.
+
+// Phase states.
+#define BOOT_PENDING 0 // Not started.
+#define BOOT_RUNNING 1 // Started, not ended.
+#define BOOT_DONE 2 // Ended and said it worked.
+#define BOOT_FAILED 3 // Ended and said it did not work, or a milestone not reached. Phases after it still run.
+
+typedef bool (*amBootFn)(void* arg); // One phase. Returns false if what it set up does not work.
+typedef void (*amBootTaskEndFn)(); // Called in each phase task just before it is deleted.
+
+class amBoot;
+
+/*! One phase of the start up sequence, or a record of something outside it. */
+struct amBootPhase
+{
+   const char* name; ///< Short name for the report. Not copied.
+   amBootFn fn; ///< What the phase does. nullptr for milestones and records.
+   void* arg; ///< Handed to fn.
+   uint32_t after; ///< BOOT_AFTER() mask of the phases this one waits for.
+   int8_t core; ///< Core to run on, or BOOT_ANY_CORE.
+   bool inGraph; ///< Added with add() or milestone(), not record().
+   volatile uint8_t state; ///< BOOT_ state.
+   uint32_t startUs; ///< micros() when it started.
+   uint32_t endUs; ///< micros() when it ended.
+   uint8_t id; ///< Index in the phase table.
+   amBoot* owner; ///< Sequence it belongs to.
+}; // struct amBootPhase
+
+/*************************************************************************************************************************************
+ * @class Boot profiler and dependency aware start up sequence.
+ *************************************************************************************************************************************/
+class amBoot
+{
+   public:
+      amBoot(); // Class constructor.
+      uint8_t add(const char* name, amBootFn fn, void* arg, uint32_t after, int8_t core = BOOT_ANY_CORE); // Add a phase.
+      uint8_t milestone(const char* name, uint32_t after) { return add(name, nullptr, nullptr, after); } // amBoot::milestone()
+      uint8_t record(const char* name, uint32_t startUs, uint32_t endUs); // Add something timed outside the graph.
+      void setTimes(uint8_t id, uint32_t startUs, uint32_t endUs); // Set a phase's times, e.g. to simulate a boot.
+      bool run(uint32_t stackBytes, uint8_t priority); // Run the graph. Returns when every phase has ended.
+      uint32_t getCriticalPathUs(); // Longest chain of phases through the graph.
+      bool isCritical(uint8_t id); // Phase is on the critical path.
+      uint32_t getSerialUs(); // Time the graph would take one phase after another.
+      uint32_t getWallUs(); // From the first graph phase starting to the last one ending.
+      size_t report(char* buf, size_t len); // One line breakdown for the console or MQTT.
+      uint8_t getCount() { return _count; } // amBoot::getCount()
+      const char* getName(uint8_t id) { return (id < _count) ? _phases[id].name : ""; } // amBoot::getName()
+      uint8_t getState(uint8_t id) { return (id < _count) ? _phases[id].state : BOOT_PENDING; } // amBoot::getState()
+      uint32_t getStartUs(uint8_t id) { return (id < _count) ? _phases[id].startUs : 0; } // amBoot::getStartUs()
+      uint32_t getEndUs(uint8_t id) { return (id < _count) ? _phases[id].endUs : 0; } // amBoot::getEndUs()
+      bool getInGraph(uint8_t id) { return (id < _count) ? _phases[id].inGraph : false; } // amBoot::getInGraph()
+      uint8_t getTasksStarted() { return _tasksStarted; } // Phases that ran in a task of their own.
+      void setTaskEnd(amBootTaskEndFn fn) { _taskEnd = fn; } // Let go of what a phase task holds, such as a log channel.
+   private:
+      static void _phaseTask(void* param); // FreeRTOS task body for one phase.
+      void _runPhase(amBootPhase* phase); // Time a phase and tell run() it has ended.
+      bool _reached(amBootPhase* phase); // Every phase a milestone comes after worked.
+      void _findCriticalPath(); // Work out the critical path from the phase times.
+      amBootPhase _phases[BOOT_MAX_PHASES]; // Phases and records, in the order added.
+      uint8_t _count = 0; // Entries used in _phases.
+      std::atomic<uint32_t> _ended; // BOOT_AFTER() mask of the graph phases that have ended.
+      void* _runner = nullptr; // Task waiting in run(). nullptr if run() was not called from a task.
+      uint32_t _criticalUs = 0; // Length of the critical path.
+      uint32_t _criticalMask = 0; // Phases on it.
+      uint8_t _tasksStarted = 0; // Phases that got a task of their own.
+      amBootTaskEndFn _taskEnd = nullptr; // Called by each phase task before it is deleted.
+}; // class amBoot
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,221 @@
+/*************************************************************************************************************************************
+ * @file amCmd.cpp
+ * @author va3wam
+ * @brief Allocation free parsing and dispatch of comma separated commands such as those that arrive over MQTT.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <limits.h> // LONG_MAX.
+#include <string.h> // strcmp(), strncmp().
+#include <amCmd.h> // Header file for linking.
+
+/**
+ * @brief Split a command into tokens in place.
+ * @details Letters are upper-cased, each comma is replaced by a 0 and spaces and tabs either side
+ * of a token are dropped, so every token is both a slice and a C string. The buffer needs room for
+ * one byte more than len, for the 0 that ends the last token.
+ * @param buffer Command text. Changed.
+ * @param len Characters in the command. Parsing also stops at a 0.
+ * @param args Where to put the tokens. args[0] is the command name.
+ * @param maxArgs Room in args.
+ * @param argCount Where to put the number of tokens found.
+ * @return false if there were more than maxArgs tokens. The first maxArgs are still filled in.
+===================================================================================================*/
+bool cmdTokenize(char* buffer, size_t len, cmdArg* args, uint8_t maxArgs, uint8_t* argCount)
+{
+   uint8_t count = 0;
+   size_t start = 0;
+   bool fits = true;
+   for(size_t i = 0; ; i++)
+   {
+      bool end = (i >= len || buffer[i] == '\0');
+      if(end == false && buffer[i] != ',')
+      {
+         if(buffer[i] >= 'a' && buffer[i] <= 'z')
+         {
+            buffer[i] -= 'a' - 'A';
+         } // if
+         continue;
+      } // if
+      size_t first = start;
+      size_t last = i; // One past the final character.
+      while(first < last && (buffer[first] == ' ' || buffer[first] == '\t'))
+      {
+         first++;
+      } // while
+      while(last > first && (buffer[last - 1] == ' ' || buffer[last - 1] == '\t'))
+      {
+         last--;
+      } // while
+      buffer[last] = '\0';
+      if(count < maxArgs)
+      {
+         args[count].text = &buffer[first];
+         args[count].len = (uint16_t)(last - first);
+         count++;
+      } // if
+      else
+      {
+         fits = false;
+      } // else
+      if(end == true)
+      {
+         break;
+      } // if
+      start = i + 1;
+   } // for
+   *argCount = count;
+   return fits;
+} // cmdTokenize()
+
+/**
+ * @brief Order a token against a table name, as strcmp() would.
+===================================================================================================*/
+static int cmdCompare(const cmdArg &arg, const char* name)
+{
+   int order = strncmp(arg.text, name, arg.len);
+   if(order != 0)
+   {
+      return order;
+   } // if
+   return (name[arg.len] == '\0') ? 0 : -1; // Name is longer, so the token sorts first.
+} // cmdCompare()
+
+/**
+ * @brief Look a command name up in a table by binary search.
+ * @param table Command table sorted by name. See cmdTableSorted().
+ * @param entries Rows in the table.
+ * @param name Token to look for.
+ * @return Matching row, or nullptr.
+===================================================================================================*/
+const cmdEntry* cmdFind(const cmdEntry* table, uint8_t entries, const cmdArg &name)
+{
+   uint8_t low = 0;
+   uint8_t high = entries;
+   while(low < high)
+   {
+      uint8_t mid = low + (high - low) / 2;
+      int order = cmdCompare(name, table[mid].name);
+      if(order == 0)
+      {
+         return &table[mid];
+      } // if
+      if(order < 0)
+      {
+         high = mid;
+      } // if
+      else
+      {
+         low = mid + 1;
+      } // else
+   } // while
+   return nullptr;
+} // cmdFind()
+
+/**
+ * @brief Check a command table is sorted, with no name given twice.
+ * @param table Command table.
+ * @param entries Rows in the table.
+ * @return true if cmdFind() can search it.
+===================================================================================================*/
+bool cmdTableSorted(const cmdEntry* table, uint8_t entries)
+{
+   for(uint8_t i = 1; i < entries; i++)
+   {
+      if(strcmp(table[i - 1].name, table[i].name) >= 0)
+      {
+         return false;
+      } // if
+   } // for
+   return true;
+} // cmdTableSorted()
+
+/**
+ * @brief Tokenize a command and run its handler.
+ * @param table Command table sorted by name.
+ * @param entries Rows in the table.
+ * @param buffer Command text, changed in place. Needs room for one byte more than len.
+ * @param len Characters in the command.
+ * @return CMD_OK or one of the other CMD_ status codes. A command with no name is CMD_EMPTY.
+===================================================================================================*/
+uint8_t cmdDispatch(const cmdEntry* table, uint8_t entries, char* buffer, size_t len)
+{
+   cmdArg args[CMD_MAX_ARGS];
+   uint8_t argCount;
+   if(cmdTokenize(buffer, len, args, CMD_MAX_ARGS, &argCount) == false)
+   {
+      return CMD_TOO_MANY_ARGS;
+   } // if
+   if(args[0].len == 0)
+   {
+      return CMD_EMPTY;
+   } // if
+   const cmdEntry* entry = cmdFind(table, entries, args[0]);
+   if(entry == nullptr)
+   {
+      return CMD_UNKNOWN;
+   } // if
+   return entry->handler(args, argCount) ? CMD_OK : CMD_FAILED;
+} // cmdDispatch()
+
+/**
+ * @brief Compare a token with a C string.
+ * @param arg Token.
+ * @param text Text to compare with. Case matters.
+ * @return true if they are the same.
+===================================================================================================*/
+bool cmdEquals(const cmdArg &arg, const char* text)
+{
+   return strncmp(arg.text, text, arg.len) == 0 && text[arg.len] == '\0';
+} // cmdEquals()
+
+/**
+ * @brief Read a token as a signed decimal number.
+ * @param arg Token.
+ * @param value Where to put the number. Left untouched if the token is not a number.
+ * @return false if the token is empty, has anything but an optional sign and digits, or overflows.
+===================================================================================================*/
+bool cmdToLong(const cmdArg &arg, long* value)
+{
+   uint16_t i = 0;
+   bool negative = false;
+   if(i < arg.len && (arg.text[i] == '-' || arg.text[i] == '+'))
+   {
+      negative = (arg.text[i] == '-');
+      i++;
+   } // if
+   if(i == arg.len)
+   {
+      return false;
+   } // if
+   unsigned long magnitude = 0;
+   unsigned long limit = negative ? (unsigned long)LONG_MAX + 1 : (unsigned long)LONG_MAX;
+   for(; i < arg.len; i++)
+   {
+      char c = arg.text[i];
+      if(c < '0' || c > '9')
+      {
+         return false;
+      } // if
+      unsigned long digit = (unsigned long)(c - '0');
+      if(magnitude > (limit - digit) / 10)
+      {
+         return false;
+      } // if
+      magnitude = magnitude * 10 + digit;
+   } // for
+   *value = negative ? (long)(0 - magnitude) : (long)magnitude;
+   return true;
+} // cmdToLong()
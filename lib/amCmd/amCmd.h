@@ -0,0 +1,62 @@
+/*************************************************************************************************************************************
+ * @file amCmd.h
+ * @author va3wam
+ * @brief Allocation free parsing and dispatch of comma separated commands such as those that arrive over MQTT.
+ * @details A command is a name followed by up to CMD_MAX_ARGS - 1 comma separated arguments, e.g. "rgb,255,0,10". cmdTokenize()
+ * works in place on the caller's buffer: it upper-cases it, ends each token with a 0 and hands back slices that point into it, so
+ * no String or heap memory is involved. cmdDispatch() finds the command with a binary search of a table sorted by name.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amCmd_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amCmd_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <stddef.h> // size_t.
+
+#define CMD_MAX_ARGS 20 // Command plus up to 19 arguments.
+
+// Status codes returned by cmdDispatch().
+#define CMD_OK 0 // Handler ran and reported success.
+#define CMD_EMPTY 1 // Nothing but separators and spaces.
+#define CMD_TOO_MANY_ARGS 2 // More than CMD_MAX_ARGS tokens. Nothing was run.
+#define CMD_UNKNOWN 3 // Name is not in the table.
+#define CMD_FAILED 4 // Handler ran and reported failure.
+
+/*! One token of a command. Points into the buffer given to cmdTokenize() and is also 0 terminated there. */
+struct cmdArg
+{
+   const char* text; ///< First character.
+   uint16_t len; ///< Characters, not counting the 0.
+}; // struct
+
+typedef bool (*cmdHandler)(const cmdArg* args, uint8_t argCount); // args[0] is the command name. Returns false on bad arguments.
+
+/*! Entry in a command table. Tables must be sorted by name, as strcmp() orders them. */
+struct cmdEntry
+{
+   const char* name; ///< Upper case command name.
+   cmdHandler handler; ///< Called with the tokens of the command.
+}; // struct
+
+bool cmdTokenize(char* buffer, size_t len, cmdArg* args, uint8_t maxArgs, uint8_t* argCount); // Split a command in place.
+const cmdEntry* cmdFind(const cmdEntry* table, uint8_t entries, const cmdArg &name); // Look a name up in a sorted table.
+bool cmdTableSorted(const cmdEntry* table, uint8_t entries); // Check a table is in the order cmdFind() needs.
+uint8_t cmdDispatch(const cmdEntry* table, uint8_t entries, char* buffer, size_t len); // Tokenize and run a command.
+bool cmdEquals(const cmdArg &arg, const char* text); // Compare a token with a C string.
+bool cmdToLong(const cmdArg &arg, long* value); // Read a token as a decimal number.
+
+#endif // End of precompiler protected code block
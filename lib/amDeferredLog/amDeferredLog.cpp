@@ -0,0 +1,417 @@
+/*************************************************************************************************************************************
+ * @file amDeferredLog.cpp
+ * @author va3wam
+ * @brief Deferred logging records, their text and their binary frames.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <amDeferredLog.h> // Header file for linking.
+#include <stdio.h> // snprintf().
+#include <string.h> // strlen(), memcpy().
+
+/*! Bounded text output for dlogFormat(). Always 0 terminated. */
+struct dlogText
+{
+   char* out; ///< Buffer.
+   size_t size; ///< Room in out.
+   size_t len; ///< Characters written.
+}; // struct
+
+/**
+ * @brief Append characters, cutting them short when the buffer is full.
+ * @param t Output.
+ * @param s Characters.
+ * @param n How many.
+===================================================================================================*/
+static void dlogPut(dlogText &t, const char* s, size_t n)
+{
+   if(t.len + 1 >= t.size)
+   {
+      return;
+   } // if
+   if(n > t.size - 1 - t.len)
+   {
+      n = t.size - 1 - t.len;
+   } // if
+   memcpy(t.out + t.len, s, n);
+   t.len += n;
+   t.out[t.len] = '\0';
+} // dlogPut()
+
+static void dlogPuts(dlogText &t, const char* s) { dlogPut(t, s, strlen(s)); } // dlogPuts()
+static void dlogPutc(dlogText &t, char c) { dlogPut(t, &c, 1); } // dlogPutc()
+
+/**
+ * @brief Append a number in the given base, upper case, as Arduino's Print does.
+ * @param t Output.
+ * @param value Number.
+ * @param base 2, 10 or 16.
+===================================================================================================*/
+static void dlogPutNumber(dlogText &t, uint64_t value, uint8_t base)
+{
+   char digits[65];
+   uint8_t i = sizeof(digits);
+   do
+   {
+      uint8_t d = value % base;
+      digits[--i] = (d < 10) ? '0' + d : 'A' + d - 10;
+      value /= base;
+   } while(value != 0); // do
+   dlogPut(t, &digits[i], sizeof(digits) - i);
+} // dlogPutNumber()
+
+/**
+ * @brief Append a signed decimal number.
+ * @param t Output.
+ * @param value Number.
+===================================================================================================*/
+static void dlogPutSigned(dlogText &t, int64_t value)
+{
+   if(value < 0)
+   {
+      dlogPutc(t, '-');
+      dlogPutNumber(t, 0 - (uint64_t)value, 10);
+      return;
+   } // if
+   dlogPutNumber(t, (uint64_t)value, 10);
+} // dlogPutSigned()
+
+/**
+ * @brief Start a record.
+ * @param rec Record to fill in.
+ * @param timeUs micros() when the call was made.
+ * @param level LOG_LEVEL_ value.
+ * @param format ArduinoLog style format string literal.
+===================================================================================================*/
+void dlogBegin(dlogRecord &rec, uint32_t timeUs, uint8_t level, const char* format)
+{
+   rec.timeUs = timeUs;
+   rec.level = level;
+   rec.argCount = 0;
+   rec.textUsed = 0;
+   rec.format = format;
+} // dlogBegin()
+
+/**
+ * @brief Record a signed argument.
+ * @param rec Record.
+ * @param value Argument.
+===================================================================================================*/
+void dlogAddInt(dlogRecord &rec, int64_t value)
+{
+   if(rec.argCount < DLOG_MAX_ARGS)
+   {
+      rec.tags[rec.argCount] = DLOG_ARG_INT;
+      rec.args[rec.argCount++].i = value;
+   } // if
+} // dlogAddInt()
+
+/**
+ * @brief Record an unsigned argument.
+ * @param rec Record.
+ * @param value Argument.
+===================================================================================================*/
+void dlogAddUint(dlogRecord &rec, uint64_t value)
+{
+   if(rec.argCount < DLOG_MAX_ARGS)
+   {
+      rec.tags[rec.argCount] = DLOG_ARG_UINT;
+      rec.args[rec.argCount++].u = value;
+   } // if
+} // dlogAddUint()
+
+/**
+ * @brief Record a floating point argument.
+ * @param rec Record.
+ * @param value Argument.
+===================================================================================================*/
+void dlogAddDouble(dlogRecord &rec, double value)
+{
+   if(rec.argCount < DLOG_MAX_ARGS)
+   {
+      rec.tags[rec.argCount] = DLOG_ARG_DOUBLE;
+      rec.args[rec.argCount++].d = value;
+   } // if
+} // dlogAddDouble()
+
+/**
+ * @brief Copy a text argument into the record.
+ * @details Text that does not fit in what is left of the text area is cut short. A null pointer is
+ * recorded as "(null)".
+ * @param rec Record.
+ * @param text 0 terminated text.
+===================================================================================================*/
+void dlogAddText(dlogRecord &rec, const char* text)
+{
+   if(rec.argCount >= DLOG_MAX_ARGS)
+   {
+      return;
+   } // if
+   if(text == NULL)
+   {
+      text = "(null)";
+   } // if
+   size_t room = (rec.textUsed < DLOG_TEXT_LEN) ? DLOG_TEXT_LEN - 1 - rec.textUsed : 0;
+   size_t n = strlen(text);
+   if(n > room)
+   {
+      n = room;
+   } // if
+   rec.tags[rec.argCount] = DLOG_ARG_TEXT;
+   rec.args[rec.argCount++].u = rec.textUsed;
+   memcpy(&rec.text[rec.textUsed], text, n);
+   rec.text[rec.textUsed + n] = '\0';
+   rec.textUsed += n + 1;
+} // dlogAddText()
+
+/**
+ * @brief Turn a record into the text ArduinoLog would have printed for the same call.
+ * @details The line starts with the level letter, as ArduinoLog does with showLevel on, and ends
+ * without a new line. Specifiers with no argument left print nothing.
+ * @param rec Record.
+ * @param showTime Start the line with the time in seconds.
+ * @param out Where to put the 0 terminated line.
+ * @param size Room in out. Longer lines are cut short.
+ * @return Characters in the line.
+===================================================================================================*/
+size_t dlogFormat(const dlogRecord &rec, bool showTime, char* out, size_t size)
+{
+   dlogText t = {out, size, 0};
+   if(size == 0)
+   {
+      return 0;
+   } // if
+   out[0] = '\0';
+   if(showTime == true)
+   {
+      char stamp[24];
+      snprintf(stamp, sizeof(stamp), "%lu.%06lu ", (unsigned long)(rec.timeUs / 1000000), (unsigned long)(rec.timeUs % 1000000));
+      dlogPuts(t, stamp);
+   } // if
+   if(rec.level >= 1 && rec.level <= 6)
+   {
+      dlogPutc(t, "FEWITV"[rec.level - 1]);
+      dlogPuts(t, ": ");
+   } // if
+   uint8_t next = 0;
+   for(const char* f = rec.format; *f != '\0'; f++)
+   {
+      if(*f != '%')
+      {
+         dlogPutc(t, *f);
+         continue;
+      } // if
+      char spec = *++f;
+      if(spec == '\0')
+      {
+         break;
+      } // if
+      if(spec == '%')
+      {
+         dlogPutc(t, '%');
+         continue;
+      } // if
+      if(next >= rec.argCount)
+      {
+         continue;
+      } // if
+      uint8_t tag = rec.tags[next];
+      int64_t i = (tag == DLOG_ARG_DOUBLE) ? (int64_t)rec.args[next].d : rec.args[next].i;
+      double d = (tag == DLOG_ARG_DOUBLE) ? rec.args[next].d : (tag == DLOG_ARG_INT) ? (double)rec.args[next].i : (double)rec.args[next].u;
+      const char* text = (tag == DLOG_ARG_TEXT) ? &rec.text[rec.args[next].u] : "";
+      next++;
+      switch(spec)
+      {
+         case 's': case 'S': case 'p':
+            dlogPuts(t, text);
+            break;
+         case 'd': case 'i': case 'l':
+            dlogPutSigned(t, (spec == 'l') ? i : (int32_t)i);
+            break;
+         case 'u':
+            dlogPutNumber(t, (tag == DLOG_ARG_UINT) ? rec.args[next - 1].u : (uint64_t)(uint32_t)i, 10);
+            break;
+         case 'x':
+            dlogPutNumber(t, (uint32_t)i, 16);
+            break;
+         case 'X':
+         {
+            uint16_t h = (uint16_t)i;
+            dlogPuts(t, (h < 0xF) ? "0x000" : (h < 0xFF) ? "0x00" : (h < 0xFFF) ? "0x0" : "0x"); // ArduinoLog pads this way.
+            dlogPutNumber(t, h, 16);
+            break;
+         } // case
+         case 'b': case 'B':
+            if(spec == 'B')
+            {
+               dlogPuts(t, "0b");
+            } // if
+            dlogPutNumber(t, (uint32_t)i, 2);
+            break;
+         case 'c':
+            dlogPutc(t, (char)i);
+            break;
+         case 'C':
+         {
+            char c = (char)i;
+            if(c >= 0x20 && c < 0x7F)
+            {
+               dlogPutc(t, c);
+            } // if
+            else
+            {
+               dlogPuts(t, (c < 0xF) ? "0x0" : "0x");
+               dlogPutNumber(t, (uint8_t)c, 16);
+            } // else
+            break;
+         } // case
+         case 't':
+            dlogPuts(t, (i == 1) ? "T" : "F");
+            break;
+         case 'T':
+            dlogPuts(t, (i == 1) ? "true" : "false");
+            break;
+         case 'D': case 'F':
+         {
+            char number[32];
+            snprintf(number, sizeof(number), "%.2f", d);
+            dlogPuts(t, number);
+            break;
+         } // case
+         default:
+            break;
+      } // switch
+   } // for
+   return t.len;
+} // dlogFormat()
+
+/**
+ * @brief Id a format string travels under in binary frames.
+ * @param format Format string.
+ * @return Its address, which is unique and fixed for the life of the firmware.
+===================================================================================================*/
+uint32_t dlogFormatId(const char* format)
+{
+   return (uint32_t)(uintptr_t)format;
+} // dlogFormatId()
+
+/**
+ * @brief Put a little endian number into a frame.
+ * @param p Where to put it. Moved past it.
+ * @param value Number.
+ * @param bytes Size of the number.
+===================================================================================================*/
+static void dlogPack(uint8_t* &p, uint64_t value, uint8_t bytes)
+{
+   for(uint8_t i = 0; i < bytes; i++)
+   {
+      *p++ = (uint8_t)(value >> (8 * i));
+   } // for
+} // dlogPack()
+
+/**
+ * @brief Build a frame that tells the decoder the text of a format string.
+ * @param id dlogFormatId() of the format.
+ * @param format Format string. Cut short if it does not fit in one frame.
+ * @param out Where to put the frame.
+ * @param size Room in out. DLOG_FRAME_MAX is always enough.
+ * @return Bytes in the frame, or 0 if it does not fit.
+===================================================================================================*/
+uint16_t dlogEncodeFormat(uint32_t id, const char* format, uint8_t* out, uint16_t size)
+{
+   size_t n = strlen(format);
+   if(n > DLOG_DECODER_FORMAT_LEN - 1)
+   {
+      n = DLOG_DECODER_FORMAT_LEN - 1;
+   } // if
+   if(size < 3 + 4 + n)
+   {
+      return 0;
+   } // if
+   uint8_t* p = out;
+   *p++ = DLOG_SYNC;
+   *p++ = DLOG_FRAME_FORMAT;
+   *p++ = (uint8_t)(4 + n);
+   dlogPack(p, id, 4);
+   memcpy(p, format, n);
+   return 3 + 4 + n;
+} // dlogEncodeFormat()
+
+/**
+ * @brief Build a frame that carries one record.
+ * @details Numbers take 8 bytes each. Text arguments take a length byte and their characters.
+ * @param rec Record.
+ * @param out Where to put the frame.
+ * @param size Room in out. DLOG_FRAME_MAX is always enough.
+ * @return Bytes in the frame, or 0 if it does not fit.
+===================================================================================================*/
+uint16_t dlogEncodeRecord(const dlogRecord &rec, uint8_t* out, uint16_t size)
+{
+   uint16_t len = 4 + 1 + 4 + 1;
+   for(uint8_t a = 0; a < rec.argCount; a++)
+   {
+      len += (rec.tags[a] == DLOG_ARG_TEXT) ? 2 + strlen(&rec.text[rec.args[a].u]) : 1 + 8;
+   } // for
+   if(size < 3 + len)
+   {
+      return 0;
+   } // if
+   uint8_t* p = out;
+   *p++ = DLOG_SYNC;
+   *p++ = DLOG_FRAME_RECORD;
+   *p++ = (uint8_t)len;
+   dlogPack(p, rec.timeUs, 4);
+   *p++ = rec.level;
+   dlogPack(p, dlogFormatId(rec.format), 4);
+   *p++ = rec.argCount;
+   for(uint8_t a = 0; a < rec.argCount; a++)
+   {
+      *p++ = rec.tags[a];
+      if(rec.tags[a] == DLOG_ARG_TEXT)
+      {
+         const char* text = &rec.text[rec.args[a].u];
+         uint8_t n = strlen(text);
+         *p++ = n;
+         memcpy(p, text, n);
+         p += n;
+      } // if
+      else
+      {
+         dlogPack(p, rec.args[a].u, 8);
+      } // else
+   } // for
+   return 3 + len;
+} // dlogEncodeRecord()
+
+/**
+ * @brief Build a frame that reports how many records have been dropped.
+ * @param dropped Total dropped so far.
+ * @param out Where to put the frame.
+ * @param size Room in out.
+ * @return Bytes in the frame, or 0 if it does not fit.
+===================================================================================================*/
+uint16_t dlogEncodeDropped(uint32_t dropped, uint8_t* out, uint16_t size)
+{
+   if(size < 3 + 4)
+   {
+      return 0;
+   } // if
+   uint8_t* p = out;
+   *p++ = DLOG_SYNC;
+   *p++ = DLOG_FRAME_DROPPED;
+   *p++ = 4;
+   dlogPack(p, dropped, 4);
+   return 3 + 4;
+} // dlogEncodeDropped()
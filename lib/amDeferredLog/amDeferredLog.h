@@ -0,0 +1,208 @@
+/*************************************************************************************************************************************
+ * @file amDeferredLog.h
+ * @author va3wam
+ * @brief Deferred logging. Log calls store a compact record and a low priority task turns it into text later.
+ * @details ArduinoLog formats every character into Serial on the caller's thread, so a log line costs the caller its UART time.
+ * Here the caller only fills in a dlogRecord (time, level, format string pointer and raw argument values) and pushes it onto an
+ * amDeferredLogChannel, a lock free ring with one producer. Text arguments are copied into the record because the caller's buffer
+ * may be gone by the time the record is read. The format string itself is not copied, so it must be a string literal. Whoever
+ * drains the channel either turns records into the same text ArduinoLog would print with dlogFormat(), or packs them into binary
+ * frames with the dlogEncode functions for capture over Serial, MQTT or flash. amDeferredLogDecoder turns captured frames back
+ * into text on the host. Records that do not fit in a full channel are counted, not lost silently. amDeferredLogChannels lends a
+ * fixed set of channels to tasks that come and go.
+ *
+ * Arguments are recorded by C++ type: signed and unsigned integers, floating point and C strings. Add an overload of dlogAdd()
+ * for any other type, such as Printable, that should be logged.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Channels lent to tasks and given back when they end
+ *************************************************************************************************************************************/
+#ifndef amDeferredLog_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amDeferredLog_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <stddef.h> // size_t.
+#include <type_traits> // std::enable_if.
+#include <atomic> // Channel ownership, handed from one task to the next.
+#include <amRing.h> // Lock free single producer, single consumer ring.
+
+#define DLOG_MAX_ARGS 8 // Arguments kept per record. Extra arguments are ignored.
+#define DLOG_TEXT_LEN 32 // Bytes shared by the text arguments of one record, 0 terminators included.
+#ifndef DLOG_RING_SLOTS
+#define DLOG_RING_SLOTS 16 // Records each channel holds. Must be a power of 2. Raise it if boot bursts are dropped.
+#endif
+#define DLOG_LINE_LEN 256 // Longest line dlogFormat() is asked to produce by the drain task and decoder.
+
+// Argument tags.
+#define DLOG_ARG_INT 0 // Signed integer.
+#define DLOG_ARG_UINT 1 // Unsigned integer or bool.
+#define DLOG_ARG_DOUBLE 2 // Floating point.
+#define DLOG_ARG_TEXT 3 // Copied into the record text area. Value is the offset of the text.
+
+// Binary frames. Each is DLOG_SYNC, a frame type, a payload length byte and the payload. Numbers are little endian.
+#define DLOG_SYNC 0xA5 // Start of every frame.
+#define DLOG_FRAME_FORMAT 1 // Format id (4), format text. Sent before the first record that uses the format.
+#define DLOG_FRAME_RECORD 2 // Time us (4), level (1), format id (4), argument count (1), then each argument.
+#define DLOG_FRAME_DROPPED 3 // Total records dropped so far (4).
+#define DLOG_FRAME_MAX 258 // Sync, type, length and the largest payload.
+
+/*! One deferred log call. */
+struct dlogRecord
+{
+   uint32_t timeUs; ///< micros() when the call was made.
+   uint8_t level; ///< LOG_LEVEL_ value.
+   uint8_t argCount; ///< Arguments recorded.
+   uint8_t textUsed; ///< Bytes of text in use.
+   const char* format; ///< ArduinoLog style format string. Must outlive the record.
+   uint8_t tags[DLOG_MAX_ARGS]; ///< DLOG_ARG_ tag of each argument.
+   union
+   {
+      int64_t i; ///< DLOG_ARG_INT.
+      uint64_t u; ///< DLOG_ARG_UINT and DLOG_ARG_TEXT.
+      double d; ///< DLOG_ARG_DOUBLE.
+   } args[DLOG_MAX_ARGS]; ///< Argument values.
+   char text[DLOG_TEXT_LEN]; ///< Text arguments, each 0 terminated.
+}; // struct
+
+void dlogBegin(dlogRecord &rec, uint32_t timeUs, uint8_t level, const char* format); // Start a record.
+void dlogAddInt(dlogRecord &rec, int64_t value); // Record a signed argument.
+void dlogAddUint(dlogRecord &rec, uint64_t value); // Record an unsigned argument.
+void dlogAddDouble(dlogRecord &rec, double value); // Record a floating point argument.
+void dlogAddText(dlogRecord &rec, const char* text); // Copy a text argument.
+size_t dlogFormat(const dlogRecord &rec, bool showTime, char* out, size_t size); // Record to ArduinoLog text.
+uint16_t dlogEncodeFormat(uint32_t id, const char* format, uint8_t* out, uint16_t size); // Format frame.
+uint16_t dlogEncodeRecord(const dlogRecord &rec, uint8_t* out, uint16_t size); // Record frame.
+uint16_t dlogEncodeDropped(uint32_t dropped, uint8_t* out, uint16_t size); // Dropped count frame.
+uint32_t dlogFormatId(const char* format); // Id a format string travels under in binary frames.
+
+/**
+ * @brief Record an argument. Picks the tag from the C++ type.
+===================================================================================================*/
+template <typename T> typename std::enable_if<std::is_enum<T>::value || (std::is_integral<T>::value && std::is_signed<T>::value)>::type
+dlogAdd(dlogRecord &rec, T value) { dlogAddInt(rec, (int64_t)value); } // dlogAdd()
+template <typename T> typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type
+dlogAdd(dlogRecord &rec, T value) { dlogAddUint(rec, (uint64_t)value); } // dlogAdd()
+template <typename T> typename std::enable_if<std::is_floating_point<T>::value>::type
+dlogAdd(dlogRecord &rec, T value) { dlogAddDouble(rec, (double)value); } // dlogAdd()
+inline void dlogAdd(dlogRecord &rec, const char* text) { dlogAddText(rec, text); } // dlogAdd()
+
+inline void dlogAddAll(dlogRecord &) {} // dlogAddAll() No arguments left.
+/**
+ * @brief Record every argument of a log call, in order.
+===================================================================================================*/
+template <typename T, typename... Args> void dlogAddAll(dlogRecord &rec, const T &first, const Args&... rest)
+{
+   dlogAdd(rec, first);
+   dlogAddAll(rec, rest...);
+} // dlogAddAll()
+
+/*************************************************************************************************************************************
+ * @class Queue of deferred log records written by one task and drained by one other task.
+ *************************************************************************************************************************************/
+class amDeferredLogChannel
+{
+   public:
+      /**
+       * @brief Queue a log call. Call from the one task that owns this channel.
+       * @param timeUs micros() now.
+       * @param level LOG_LEVEL_ value.
+       * @param format ArduinoLog style format string literal.
+       * @return false if the channel was full. The record is counted as dropped.
+      ============================================================================================*/
+      template <typename... Args> bool log(uint32_t timeUs, uint8_t level, const char* format, const Args&... args)
+      {
+         dlogRecord rec;
+         dlogBegin(rec, timeUs, level, format);
+         dlogAddAll(rec, args...);
+         return _ring.push(&rec, sizeof(rec));
+      } // amDeferredLogChannel::log()
+      bool take(dlogRecord* rec) { uint16_t len; return _ring.pop(rec, sizeof(*rec), &len); } // amDeferredLogChannel::take()
+      uint32_t getDropped() { return _ring.getRejected(); } // amDeferredLogChannel::getDropped()
+   private:
+      amRing<DLOG_RING_SLOTS, sizeof(dlogRecord), RING_REJECT> _ring; // Records waiting to be drained.
+}; // class amDeferredLogChannel
+
+/*************************************************************************************************************************************
+ * @class A fixed set of channels lent to tasks as they start logging and given back when they end.
+ * @details A task claims a free channel the first time it logs and must release it before it is deleted, so tasks that come and
+ * go during boot do not use up the channels the long lived tasks need. Each channel still has one producer at a time: the claim
+ * and the release order the old owner's records before the new owner's. Records a task left behind are drained as usual after
+ * it has gone.
+ * @tparam N Number of channels.
+ *************************************************************************************************************************************/
+template <uint8_t N> class amDeferredLogChannels
+{
+   public:
+      static_assert(N >= 1 && N <= 127, "Channel numbers must fit in an int8_t");
+      amDeferredLogChannels() { for(uint8_t c = 0; c < N; c++) _taken[c].store(false); } // Class constructor.
+      /**
+       * @brief Claim a free channel for the calling task.
+       * @return Channel number, or -1 if every channel is in use. The refusal is counted.
+      ============================================================================================*/
+      int8_t claim()
+      {
+         for(uint8_t c = 0; c < N; c++)
+         {
+            bool free = false;
+            if(_taken[c].compare_exchange_strong(free, true, std::memory_order_acquire) == true)
+            {
+               return (int8_t)c;
+            } // if
+         } // for
+         _refused.fetch_add(1, std::memory_order_relaxed);
+         return -1;
+      } // amDeferredLogChannels::claim()
+      void release(int8_t channel) { if(channel >= 0 && channel < N) _taken[channel].store(false, std::memory_order_release); } // amDeferredLogChannels::release()
+      amDeferredLogChannel& get(uint8_t channel) { return _channels[channel]; } // amDeferredLogChannels::get()
+      uint8_t getInUse() { uint8_t n = 0; for(uint8_t c = 0; c < N; c++) n += _taken[c].load() ? 1 : 0; return n; } // amDeferredLogChannels::getInUse()
+      uint32_t getRefused() { return _refused.load(); } // amDeferredLogChannels::getRefused()
+   private:
+      amDeferredLogChannel _channels[N]; // Records waiting to be drained.
+      std::atomic<bool> _taken[N]; // Channel is lent to a task.
+      std::atomic<uint32_t> _refused{0}; // Claims made while every channel was in use.
+}; // class amDeferredLogChannels
+
+#define DLOG_DECODER_FORMATS 256 // Format strings the decoder can remember.
+#define DLOG_DECODER_FORMAT_LEN 250 // Longest format string a frame can carry, 0 terminator included.
+
+typedef void (*dlogLineHandler)(const char* line, void* context); // Called with each decoded line.
+
+/*************************************************************************************************************************************
+ * @class Turns a captured stream of binary frames back into text. Host side. Bytes before the first sync are skipped.
+ *************************************************************************************************************************************/
+class amDeferredLogDecoder
+{
+   public:
+      amDeferredLogDecoder(dlogLineHandler handler, void* context, bool showTime = true); // Class constructor.
+      void feed(const uint8_t* data, size_t len); // Decode some more of the stream.
+      uint32_t getFrames() { return _frames; } // amDeferredLogDecoder::getFrames()
+      uint32_t getBadFrames() { return _badFrames; } // amDeferredLogDecoder::getBadFrames()
+   private:
+      void _frame(); // Act on the frame in _buffer.
+      const char* _lookup(uint32_t id); // Format text for an id.
+      dlogLineHandler _handler; // Where lines go.
+      void* _context; // Passed to _handler.
+      bool _showTime; // Put the time at the start of each line.
+      uint8_t _buffer[DLOG_FRAME_MAX]; // Frame being collected.
+      uint16_t _have = 0; // Bytes of it collected.
+      uint32_t _ids[DLOG_DECODER_FORMATS]; // Format ids seen.
+      char _formats[DLOG_DECODER_FORMATS][DLOG_DECODER_FORMAT_LEN]; // Format text for each id.
+      uint16_t _formatCount = 0; // Entries in use.
+      uint32_t _frames = 0; // Good frames decoded.
+      uint32_t _badFrames = 0; // Frames that made no sense.
+}; // class amDeferredLogDecoder
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,183 @@
+/*************************************************************************************************************************************
+ * @file amDeferredLogDecoder.cpp
+ * @author va3wam
+ * @brief Host side decoder for captured deferred log frames.
+ * @details Kept apart from amDeferredLog.cpp so that firmware that only writes frames does not carry the decoder's format table.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <amDeferredLog.h> // Header file for linking.
+#include <stdio.h> // snprintf().
+#include <string.h> // memcpy().
+
+/**
+ * @brief This is the constructor for this class.
+ * @param handler Called with each decoded line.
+ * @param context Passed to handler.
+ * @param showTime Put the time at the start of each line.
+===================================================================================================*/
+amDeferredLogDecoder::amDeferredLogDecoder(dlogLineHandler handler, void* context, bool showTime)
+   : _handler(handler), _context(context), _showTime(showTime)
+{
+
+} // amDeferredLogDecoder::amDeferredLogDecoder()
+
+/**
+ * @brief Read a little endian number out of a frame.
+ * @param p Where it starts.
+ * @param bytes Size of the number.
+ * @return Number.
+===================================================================================================*/
+static uint64_t dlogUnpack(const uint8_t* p, uint8_t bytes)
+{
+   uint64_t value = 0;
+   for(uint8_t i = 0; i < bytes; i++)
+   {
+      value |= (uint64_t)p[i] << (8 * i);
+   } // for
+   return value;
+} // dlogUnpack()
+
+/**
+ * @brief Decode some more of the stream. Frames may be split across calls.
+ * @param data Captured bytes.
+ * @param len Number of bytes.
+===================================================================================================*/
+void amDeferredLogDecoder::feed(const uint8_t* data, size_t len)
+{
+   for(size_t i = 0; i < len; i++)
+   {
+      if(_have == 0 && data[i] != DLOG_SYNC) // Between frames. Skip until the next one starts.
+      {
+         continue;
+      } // if
+      _buffer[_have++] = data[i];
+      if(_have >= 3 && _have == 3 + _buffer[2])
+      {
+         _frame();
+         _have = 0;
+      } // if
+   } // for
+} // amDeferredLogDecoder::feed()
+
+/**
+ * @brief Format text for an id.
+ * @param id dlogFormatId() of the format.
+ * @return The text, or NULL if no format frame for it has been seen.
+===================================================================================================*/
+const char* amDeferredLogDecoder::_lookup(uint32_t id)
+{
+   for(uint16_t f = 0; f < _formatCount; f++)
+   {
+      if(_ids[f] == id)
+      {
+         return _formats[f];
+      } // if
+   } // for
+   return NULL;
+} // amDeferredLogDecoder::_lookup()
+
+/**
+ * @brief Act on the complete frame in _buffer.
+===================================================================================================*/
+void amDeferredLogDecoder::_frame()
+{
+   const uint8_t* p = &_buffer[3];
+   uint8_t len = _buffer[2];
+   char line[DLOG_LINE_LEN];
+   if(_buffer[1] == DLOG_FRAME_FORMAT && len >= 4)
+   {
+      uint32_t id = dlogUnpack(p, 4);
+      const char* known = _lookup(id);
+      uint16_t slot = _formatCount;
+      if(known != NULL) // Sent again. The drain task forgets what it sent when its table fills.
+      {
+         slot = (known - _formats[0]) / DLOG_DECODER_FORMAT_LEN;
+      } // if
+      else if(_formatCount < DLOG_DECODER_FORMATS)
+      {
+         _formatCount++;
+      } // else if
+      else
+      {
+         _badFrames++;
+         return;
+      } // else
+      _ids[slot] = id;
+      memcpy(_formats[slot], p + 4, len - 4);
+      _formats[slot][len - 4] = '\0';
+      _frames++;
+      return;
+   } // if
+   if(_buffer[1] == DLOG_FRAME_DROPPED && len == 4)
+   {
+      snprintf(line, sizeof(line), "<amDeferredLogDecoder> %lu records dropped so far.", (unsigned long)dlogUnpack(p, 4));
+      _handler(line, _context);
+      _frames++;
+      return;
+   } // if
+   if(_buffer[1] != DLOG_FRAME_RECORD || len < 10)
+   {
+      _badFrames++;
+      return;
+   } // if
+   dlogRecord rec;
+   const char* format = _lookup(dlogUnpack(p + 5, 4));
+   dlogBegin(rec, dlogUnpack(p, 4), p[4], (format != NULL) ? format : "<amDeferredLogDecoder> Record with unknown format.");
+   uint8_t argCount = p[9];
+   if(argCount > DLOG_MAX_ARGS)
+   {
+      _badFrames++;
+      return;
+   } // if
+   const uint8_t* end = p + len;
+   p += 10;
+   for(uint8_t a = 0; a < argCount; a++)
+   {
+      if(p + 2 > end)
+      {
+         _badFrames++;
+         return;
+      } // if
+      uint8_t tag = *p++;
+      if(tag == DLOG_ARG_TEXT)
+      {
+         uint8_t n = *p++;
+         if(p + n > end)
+         {
+            _badFrames++;
+            return;
+         } // if
+         char text[DLOG_TEXT_LEN];
+         uint8_t copy = (n < DLOG_TEXT_LEN - 1) ? n : DLOG_TEXT_LEN - 1;
+         memcpy(text, p, copy);
+         text[copy] = '\0';
+         dlogAddText(rec, text);
+         p += n;
+         continue;
+      } // if
+      if(p + 8 > end || tag > DLOG_ARG_DOUBLE)
+      {
+         _badFrames++;
+         return;
+      } // if
+      rec.tags[rec.argCount] = tag;
+      rec.args[rec.argCount++].u = dlogUnpack(p, 8);
+      p += 8;
+   } // for
+   dlogFormat(rec, _showTime, line, sizeof(line));
+   _handler(line, _context);
+   _frames++;
+} // amDeferredLogDecoder::_frame()
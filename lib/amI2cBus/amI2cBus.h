@@ -0,0 +1,54 @@
+/*************************************************************************************************************************************
+ * @file amI2cBus.h
+ * @author va3wam
+ * @brief Register level I2C bus interface.
+ * @details Drivers talk to their devices through this interface rather than directly through TwoWire so that the same driver code
+ * can run against the real Wire/Wire1 buses on the robot or against a simulated bus on the host.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amI2cBus_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amI2cBus_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+
+// Transaction status codes. Values match those returned by TwoWire::endTransmission().
+#define I2C_OK 0 // Transaction completed.
+#define I2C_ERR_DATA_TOO_LONG 1 // Data too long to fit in transmit buffer.
+#define I2C_ERR_NACK_ADDR 2 // Received NACK on transmit of address.
+#define I2C_ERR_NACK_DATA 3 // Received NACK on transmit of data.
+#define I2C_ERR_OTHER 4 // Other bus error.
+#define I2C_ERR_TIMEOUT 5 // Device did not answer in time.
+
+/*************************************************************************************************************************************
+ * @class Register level access to devices on one I2C bus.
+ * @details Every call is one complete bus transaction. Register reads and writes start at the given register and rely on the
+ * device auto-incrementing its register pointer for multi-byte transfers.
+ *************************************************************************************************************************************/
+class amI2cBus
+{
+   public:
+      virtual ~amI2cBus() {} // Class destructor.
+      virtual uint8_t writeRegs(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t len) = 0; // Write len bytes from reg.
+      virtual uint8_t readRegs(uint8_t address, uint8_t reg, uint8_t* dest, uint8_t len) = 0; // Read len bytes from reg.
+      virtual uint8_t probe(uint8_t address) = 0; // Address only transaction. I2C_OK if a device ACKed.
+      uint8_t writeReg(uint8_t address, uint8_t reg, uint8_t value) // Write a single register.
+      {
+         return writeRegs(address, reg, &value, 1);
+      } // writeReg()
+}; // class amI2cBus
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,154 @@
+/*************************************************************************************************************************************
+ * @file amI2cRegistry.cpp
+ * @author va3wam
+ * @brief The I2C devices a robot expects, which bus each is on, and whether each answered.
+ * @details See amI2cRegistry.h.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <amI2cRegistry.h> // Header file for linking.
+
+/**
+ * @brief This is the constructor for this class. The device is not present until a probe finds it.
+ * @param type I2C_DEV_ type.
+ * @param bus Bus number, 0 for Wire and 1 for Wire1.
+ * @param address 7 bit I2C address.
+ * @param name Name for the log. Must outlive this object.
+===================================================================================================*/
+amI2cDevice::amI2cDevice(uint8_t type, uint8_t bus, uint8_t address, const char* name)
+   : _type(type), _bus(bus), _address(address), _name(name), _status(I2C_ERR_OTHER), _present(false)
+{
+
+} // amI2cDevice::amI2cDevice()
+
+/**
+ * @brief Record the outcome of a probe.
+ * @param status I2C_ status. I2C_OK means the device answered.
+===================================================================================================*/
+void amI2cDevice::setStatus(uint8_t status)
+{
+   _status = status;
+   _present = (status == I2C_OK);
+} // amI2cDevice::setStatus()
+
+/**
+ * @brief This is the constructor for this class. The registry starts empty.
+===================================================================================================*/
+amI2cRegistry::amI2cRegistry() : _count(0)
+{
+   for(uint8_t i = 0; i < I2C_MAX_DEVICES; i++)
+   {
+      _devices[i] = nullptr;
+   } // for
+} // amI2cRegistry::amI2cRegistry()
+
+/**
+ * @brief Add a device.
+ * @param device Device. Must outlive the registry.
+ * @return false if the registry is full, the address is out of range or another device already
+ * has the address on that bus.
+===================================================================================================*/
+bool amI2cRegistry::add(amI2cDevice* device)
+{
+   if(device == nullptr || _count >= I2C_MAX_DEVICES)
+   {
+      return false;
+   } // if
+   if(device->getAddress() < I2C_FIRST_ADDRESS || device->getAddress() > I2C_LAST_ADDRESS)
+   {
+      return false;
+   } // if
+   if(find(device->getBus(), device->getAddress()) != nullptr)
+   {
+      return false;
+   } // if
+   _devices[_count++] = device;
+   return true;
+} // amI2cRegistry::add()
+
+/**
+ * @brief Look up the device registered at an address.
+ * @param bus Bus number.
+ * @param address 7 bit I2C address.
+ * @return The device, or nullptr if none is registered there.
+===================================================================================================*/
+amI2cDevice* amI2cRegistry::find(uint8_t bus, uint8_t address)
+{
+   for(uint8_t i = 0; i < _count; i++)
+   {
+      if(_devices[i]->getBus() == bus && _devices[i]->getAddress() == address)
+      {
+         return _devices[i];
+      } // if
+   } // for
+   return nullptr;
+} // amI2cRegistry::find()
+
+/**
+ * @brief Probe the devices registered on a bus, and only those.
+ * @param bus Bus number.
+ * @param io The bus.
+ * @return Number of registered devices that answered.
+===================================================================================================*/
+uint8_t amI2cRegistry::probe(uint8_t bus, amI2cBus &io)
+{
+   uint8_t found = 0;
+   for(uint8_t i = 0; i < _count; i++)
+   {
+      if(_devices[i]->getBus() != bus)
+      {
+         continue;
+      } // if
+      _devices[i]->setStatus(io.probe(_devices[i]->getAddress()));
+      if(_devices[i]->isPresent())
+      {
+         found++;
+      } // if
+   } // for
+   return found;
+} // amI2cRegistry::probe()
+
+/**
+ * @brief Probe every address from I2C_FIRST_ADDRESS to I2C_LAST_ADDRESS on a bus.
+ * @details For diagnostics. Registered devices have their status updated on the way.
+ * @param bus Bus number.
+ * @param io The bus.
+ * @param found Called for each address that answers. May be nullptr.
+ * @param arg Handed to found.
+ * @return Number of addresses that answered.
+===================================================================================================*/
+uint8_t amI2cRegistry::sweep(uint8_t bus, amI2cBus &io, amI2cFoundFn found, void* arg)
+{
+   uint8_t count = 0;
+   for(uint8_t address = I2C_FIRST_ADDRESS; address <= I2C_LAST_ADDRESS; address++)
+   {
+      uint8_t status = io.probe(address);
+      amI2cDevice* device = find(bus, address);
+      if(device != nullptr)
+      {
+         device->setStatus(status);
+      } // if
+      if(status != I2C_OK)
+      {
+         continue;
+      } // if
+      count++;
+      if(found != nullptr)
+      {
+         found(bus, address, device, arg);
+      } // if
+   } // for
+   return count;
+} // amI2cRegistry::sweep()
@@ -0,0 +1,93 @@
+/*************************************************************************************************************************************
+ * @file amI2cRegistry.h
+ * @author va3wam
+ * @brief The I2C devices a robot expects, which bus each is on, and whether each answered.
+ * @details Each device is an amI2cDevice object declared by the code that drives it and added to the registry. At boot probe()
+ * checks only the addresses registered on a bus, a few transactions instead of 112. sweep() tries every address from 0x08 to 0x77
+ * and names what it finds from the registry, for diagnostics. Code asks the device object whether its device is there rather than
+ * reading a global flag.
+ * @code
+ * amI2cRegistry devices;
+ * amI2cDevice lcd(I2C_DEV_LCD, 0, 0x3F, "LCD");
+ * devices.add(&lcd);
+ * devices.probe(0, bus0);
+ * if(lcd.isPresent()) ...
+ * @endcode
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amI2cRegistry_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amI2cRegistry_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <amI2cBus.h> // Register level I2C bus interface.
+
+#define I2C_MAX_DEVICES 16 // Devices a registry can hold.
+#define I2C_FIRST_ADDRESS 0x08 // First address sweep() tries. Lower ones are reserved.
+#define I2C_LAST_ADDRESS 0x77 // Last address sweep() tries. Higher ones are reserved.
+
+// Device types.
+#define I2C_DEV_UNKNOWN 0 // Not registered.
+#define I2C_DEV_MD25 1 // MD25 motor controller.
+#define I2C_DEV_MPU6050 2 // MPU6050 accelerometer and gyro.
+#define I2C_DEV_LCD 3 // 16x2 character LCD behind a PCF8574.
+#define I2C_DEV_OLED 4 // SH1106 or SSD1306 OLED.
+#define I2C_DEV_PCA9685 5 // PCA9685 16 channel servo driver.
+
+/*************************************************************************************************************************************
+ * @class One device the robot expects on an I2C bus.
+ *************************************************************************************************************************************/
+class amI2cDevice
+{
+   public:
+      amI2cDevice(uint8_t type, uint8_t bus, uint8_t address, const char* name); // Class constructor.
+      bool isPresent() { return _present; } // amI2cDevice::isPresent()
+      uint8_t getType() { return _type; } // amI2cDevice::getType()
+      uint8_t getBus() { return _bus; } // amI2cDevice::getBus()
+      uint8_t getAddress() { return _address; } // amI2cDevice::getAddress()
+      const char* getName() { return _name; } // amI2cDevice::getName()
+      uint8_t getStatus() { return _status; } // amI2cDevice::getStatus()
+      void setStatus(uint8_t status); // Record the outcome of a probe.
+   private:
+      uint8_t _type; // I2C_DEV_ type.
+      uint8_t _bus; // Bus number, 0 for Wire and 1 for Wire1.
+      uint8_t _address; // 7 bit I2C address.
+      const char* _name; // Name for the log. Not copied.
+      uint8_t _status; // I2C_ status of the last probe. I2C_ERR_OTHER until probed.
+      bool _present; // Answered the last probe.
+}; // class amI2cDevice
+
+typedef void (*amI2cFoundFn)(uint8_t bus, uint8_t address, amI2cDevice* device, void* arg); // sweep() found an address. device is nullptr if unregistered.
+
+/*************************************************************************************************************************************
+ * @class The devices a robot expects on its I2C buses.
+ *************************************************************************************************************************************/
+class amI2cRegistry
+{
+   public:
+      amI2cRegistry(); // Class constructor.
+      bool add(amI2cDevice* device); // Add a device.
+      amI2cDevice* find(uint8_t bus, uint8_t address); // Device registered at an address. nullptr if none.
+      uint8_t probe(uint8_t bus, amI2cBus &io); // Probe the devices registered on a bus.
+      uint8_t sweep(uint8_t bus, amI2cBus &io, amI2cFoundFn found, void* arg); // Probe every address on a bus.
+      uint8_t getCount() { return _count; } // amI2cRegistry::getCount()
+      amI2cDevice* getDevice(uint8_t i) { return (i < _count) ? _devices[i] : nullptr; } // amI2cRegistry::getDevice()
+   private:
+      amI2cDevice* _devices[I2C_MAX_DEVICES]; // Devices in the order added.
+      uint8_t _count; // Entries used in _devices.
+}; // class amI2cRegistry
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,241 @@
+/*************************************************************************************************************************************
+ * @file amWireBus.cpp
+ * @author va3wam
+ * @brief amI2cBus implementation on top of the Arduino TwoWire class.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Also built against the host TwoWire shim (ZIPPY_NATIVE)
+ * 2026-10-17 va3wam Bounded reads, retries and stuck bus recovery, with error counters
+ *************************************************************************************************************************************/
+#if defined(ARDUINO) || defined(ZIPPY_NATIVE) // TwoWire only exists on Arduino targets and the host shims.
+
+#include <amWireBus.h> // Header file for linking.
+
+/**
+ * @brief This is the constructor for this class.
+ * @param wire The TwoWire bus (Wire or Wire1) to use. Start it with begin().
+===================================================================================================*/
+amWireBus::amWireBus(TwoWire &wire) : _wire(wire)
+{
+
+} // amWireBus::amWireBus()
+
+/**
+ * @brief Start the bus, first clocking free any device left holding SDA by a reset part way
+ * through a transaction.
+ * @param sda SDA pin.
+ * @param scl SCL pin.
+ * @param frequency Bus speed.
+ * @return true if TwoWire started.
+===================================================================================================*/
+bool amWireBus::begin(int sda, int scl, uint32_t frequency)
+{
+   _sda = sda; // Remembered for recovery.
+   _scl = scl;
+   _frequency = frequency;
+   pinMode(_sda, INPUT_PULLUP); // Look at SDA before TwoWire takes the pins.
+   if(digitalRead(_sda) == LOW) // A device is part way through sending a byte.
+   {
+      return recover(); // Starts TwoWire too.
+   } // if
+   bool ok = _wire.begin(_sda, _scl, _frequency); // Init the bus.
+   _wire.setTimeOut(I2C_WIRE_TIMEOUT_MS); // No transaction holds the caller longer than this.
+   return ok;
+} // amWireBus::begin()
+
+/**
+ * @brief Free a bus a device is holding by pulling SDA low.
+ * @details Takes the pins from TwoWire and pulses SCL until the device lets go of SDA, at most
+ * I2C_RECOVER_PULSES times, then sends a STOP so every device is idle, and starts TwoWire again.
+ * @return true if SDA is free.
+===================================================================================================*/
+bool amWireBus::recover()
+{
+   if(_sda < 0 || _scl < 0) // begin() was not called, so the pins are not known.
+   {
+      return false;
+   } // if
+   _recoveries++;
+   _wire.end(); // Let go of the pins.
+   pinMode(_sda, INPUT_PULLUP); // Only read SDA while the device may be driving it.
+   pinMode(_scl, OUTPUT_OPEN_DRAIN);
+   digitalWrite(_scl, HIGH);
+   for(uint8_t i = 0; i < I2C_RECOVER_PULSES && digitalRead(_sda) == LOW; i++)
+   {
+      digitalWrite(_scl, LOW); // Device moves on to its next bit.
+      delayMicroseconds(I2C_RECOVER_HALF_US);
+      digitalWrite(_scl, HIGH);
+      delayMicroseconds(I2C_RECOVER_HALF_US);
+   } // for
+   bool free = (digitalRead(_sda) == HIGH);
+   if(free) // STOP: SDA rises while SCL is high.
+   {
+      pinMode(_sda, OUTPUT_OPEN_DRAIN);
+      digitalWrite(_sda, LOW);
+      delayMicroseconds(I2C_RECOVER_HALF_US);
+      digitalWrite(_sda, HIGH);
+      delayMicroseconds(I2C_RECOVER_HALF_US);
+   } // if
+   else
+   {
+      _stuck++; // Nothing more can be done from this end.
+   } // else
+   _wire.begin(_sda, _scl, _frequency); // Give the pins back to TwoWire.
+   _wire.setTimeOut(I2C_WIRE_TIMEOUT_MS);
+   return free;
+} // amWireBus::recover()
+
+/**
+ * @brief Zero the error counters.
+===================================================================================================*/
+void amWireBus::resetCounters()
+{
+   _timeouts = 0;
+   _retried = 0;
+   _recoveries = 0;
+   _stuck = 0;
+   _failures = 0;
+} // amWireBus::resetCounters()
+
+/**
+ * @brief Count a failed transaction and decide whether to try it again, recovering the bus first
+ * if a device is holding SDA.
+ * @param status How the attempt ended.
+ * @param attempt Attempts made so far, less one.
+ * @return true to try again.
+===================================================================================================*/
+bool amWireBus::_retry(uint8_t status, uint8_t attempt)
+{
+   if(status == I2C_ERR_TIMEOUT)
+   {
+      _timeouts++;
+   } // if
+   if(status == I2C_ERR_NACK_ADDR || attempt >= _retries) // Nothing there, or out of tries.
+   {
+      _failures++;
+      return false;
+   } // if
+   _retried++;
+   if(_sda >= 0 && digitalRead(_sda) == LOW) // Idle bus has SDA high. Someone is holding it.
+   {
+      recover();
+   } // if
+   return true;
+} // amWireBus::_retry()
+
+/**
+ * @brief Write a block of registers in one transaction.
+ * @param address 7 bit I2C address of the device.
+ * @param reg First register to write.
+ * @param data Bytes to write.
+ * @param len Number of bytes to write.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amWireBus::_writeOnce(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t len)
+{
+   _wire.beginTransmission(address); // Request token to transmit on I2C bus.
+   _wire.write(reg); // Register pointer.
+   _wire.write(data, len); // Register values. Device auto-increments the pointer.
+   return _wire.endTransmission(); // Release the bus and report result.
+} // amWireBus::_writeOnce()
+
+/**
+ * @brief Read a block of registers in one transaction, waiting for the bytes no longer than the
+ * bus timeout.
+ * @param address 7 bit I2C address of the device.
+ * @param reg First register to read.
+ * @param dest Where to put the bytes read.
+ * @param len Number of bytes to read.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amWireBus::_readOnce(uint8_t address, uint8_t reg, uint8_t* dest, uint8_t len)
+{
+   _wire.beginTransmission(address); // Request token to transmit on I2C bus.
+   _wire.write(reg); // Register pointer.
+   uint8_t status = _wire.endTransmission(); // Release the bus.
+   if(status != I2C_OK) // Device did not take the register pointer.
+   {
+      return status;
+   } // if
+   uint32_t startUs = micros(); // Bounds the wait below.
+   _wire.requestFrom(address, len); // Returns once the bytes are in or the TwoWire timeout passes.
+   while(_wire.available() < len) // Short read. Give stragglers what is left of the timeout.
+   {
+      if((uint32_t)(micros() - startUs) >= I2C_WIRE_TIMEOUT_MS * 1000UL)
+      {
+         _wire.flush(); // Drop the partial read so the next one starts clean.
+         return I2C_ERR_TIMEOUT;
+      } // if
+      delayMicroseconds(I2C_RECOVER_HALF_US);
+   } // while
+   for(uint8_t i = 0; i < len; i++)
+   {
+      dest[i] = _wire.read(); // Move bytes out of the receive buffer.
+   } // for
+   return I2C_OK;
+} // amWireBus::_readOnce()
+
+/**
+ * @brief Write a block of registers, trying again on a timeout or a corrupted transfer.
+ * @param address 7 bit I2C address of the device.
+ * @param reg First register to write.
+ * @param data Bytes to write.
+ * @param len Number of bytes to write.
+ * @return I2C_OK or the I2C_ERR_ code of the last attempt.
+===================================================================================================*/
+uint8_t amWireBus::writeRegs(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t len)
+{
+   for(uint8_t attempt = 0; ; attempt++)
+   {
+      uint8_t status = _writeOnce(address, reg, data, len);
+      if(status == I2C_OK || _retry(status, attempt) == false)
+      {
+         return status;
+      } // if
+   } // for
+} // amWireBus::writeRegs()
+
+/**
+ * @brief Read a block of registers, trying again on a timeout or a corrupted transfer.
+ * @param address 7 bit I2C address of the device.
+ * @param reg First register to read.
+ * @param dest Where to put the bytes read.
+ * @param len Number of bytes to read.
+ * @return I2C_OK or the I2C_ERR_ code of the last attempt.
+===================================================================================================*/
+uint8_t amWireBus::readRegs(uint8_t address, uint8_t reg, uint8_t* dest, uint8_t len)
+{
+   for(uint8_t attempt = 0; ; attempt++)
+   {
+      uint8_t status = _readOnce(address, reg, dest, len);
+      if(status == I2C_OK || _retry(status, attempt) == false)
+      {
+         return status;
+      } // if
+   } // for
+} // amWireBus::readRegs()
+
+/**
+ * @brief Check for a device at the specified address. Never retried, as a NACK is the answer.
+ * @param address 7 bit I2C address of the device.
+ * @return I2C_OK if the device acknowledged its address.
+===================================================================================================*/
+uint8_t amWireBus::probe(uint8_t address)
+{
+   _wire.beginTransmission(address); // Address only transaction.
+   return _wire.endTransmission(); // 0 means a device ACKed.
+} // amWireBus::probe()
+
+#endif // defined(ARDUINO) || defined(ZIPPY_NATIVE)
@@ -0,0 +1,82 @@
+/*************************************************************************************************************************************
+ * @file amWireBus.h
+ * @author va3wam
+ * @brief amI2cBus implementation on top of the Arduino TwoWire class.
+ * @details Only built for Arduino targets. Host builds use the simulated bus in the amSim library instead.
+ *
+ * No call waits on the bus without a limit. TwoWire is given a timeout, and a read that comes back short is waited on only until
+ * that timeout has passed. A transaction that times out or is corrupted is tried again up to the retry limit; a NACK on the
+ * address is not, as it means nothing is there. Before a retry the SDA line is checked. A device that lost clocks part way
+ * through sending a byte holds SDA low and every later transaction fails, so the bus is taken off TwoWire, SCL is pulsed by
+ * hand until the device lets go of SDA (at most 9 pulses finish any byte and its ACK), a STOP is sent and TwoWire is started
+ * again. Timeouts, retries, recoveries, stuck buses and transactions given up on are counted.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Also built against the host TwoWire shim (ZIPPY_NATIVE)
+ * 2026-10-17 va3wam Bounded reads, retries and stuck bus recovery, with error counters
+ *************************************************************************************************************************************/
+#ifndef amWireBus_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amWireBus_h // Precompiler macro used for precompiler check.
+
+#if defined(ARDUINO) || defined(ZIPPY_NATIVE) // TwoWire only exists on Arduino targets and the host shims.
+
+#include <Arduino.h> // Arduino Core for ESP32. Comes with Platform.io.
+#include <Wire.h> // Required for I2C communication.
+#include <amI2cBus.h> // Register level I2C bus interface.
+
+#define I2C_WIRE_TIMEOUT_MS 10 // Longest a transaction may hold the caller. An 11 byte MD25 burst takes 1.3 ms at 100 kHz.
+#define I2C_WIRE_RETRIES 1 // Times a failed read or write is tried again.
+#define I2C_RECOVER_PULSES 9 // SCL pulses that finish any byte a device is part way through, ACK included.
+#define I2C_RECOVER_HALF_US 5 // Half an SCL period while recovering. 100 kHz.
+
+/*************************************************************************************************************************************
+ * @class Register level access to one of the ESP32 I2C buses (Wire or Wire1).
+ *************************************************************************************************************************************/
+class amWireBus : public amI2cBus
+{
+   public:
+      amWireBus(TwoWire &wire); // Class constructor.
+      bool begin(int sda, int scl, uint32_t frequency); // Free the bus if a device holds it, then start TwoWire.
+      uint8_t writeRegs(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t len); // Write len bytes from reg.
+      uint8_t readRegs(uint8_t address, uint8_t reg, uint8_t* dest, uint8_t len); // Read len bytes from reg.
+      uint8_t probe(uint8_t address); // Address only transaction.
+      bool recover(); // Clock a stuck device off SDA and send a STOP.
+      void setRetries(uint8_t retries) { _retries = retries; } // amWireBus::setRetries()
+      void resetCounters(); // Zero the error counters.
+      uint32_t getTimeouts() { return _timeouts; } // amWireBus::getTimeouts()
+      uint32_t getRetries() { return _retried; } // amWireBus::getRetries()
+      uint32_t getRecoveries() { return _recoveries; } // amWireBus::getRecoveries()
+      uint32_t getStuck() { return _stuck; } // amWireBus::getStuck()
+      uint32_t getFailures() { return _failures; } // amWireBus::getFailures()
+   private:
+      uint8_t _readOnce(uint8_t address, uint8_t reg, uint8_t* dest, uint8_t len); // One read transaction, bounded wait.
+      uint8_t _writeOnce(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t len); // One write transaction.
+      bool _retry(uint8_t status, uint8_t attempt); // Count a failure and decide whether to go again.
+      TwoWire &_wire; // The bus this object talks to.
+      int _sda = -1; // SDA pin. -1 until begin(), and no recovery without it.
+      int _scl = -1; // SCL pin.
+      uint32_t _frequency = 0; // Bus speed given to begin().
+      uint8_t _retries = I2C_WIRE_RETRIES; // Times a failed transaction is tried again.
+      uint32_t _timeouts = 0; // Transactions that timed out or came back short.
+      uint32_t _retried = 0; // Transactions tried again.
+      uint32_t _recoveries = 0; // Times SDA was found held and the bus was clocked free.
+      uint32_t _stuck = 0; // Recoveries that could not free SDA.
+      uint32_t _failures = 0; // Transactions that still failed after the last retry.
+}; // class amWireBus
+
+#endif // defined(ARDUINO) || defined(ZIPPY_NATIVE)
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,134 @@
+/*************************************************************************************************************************************
+ * @file amI2cMeter.cpp
+ * @author va3wam
+ * @brief Bus time, bytes and failures of each device on one I2C bus.
+ * @details See amI2cMeter.h.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <amI2cMeter.h> // Header file for linking.
+#include <amI2cBus.h> // I2C_ status codes.
+
+/**
+ * @brief This is the constructor for this class. No address has been seen.
+===================================================================================================*/
+amI2cMeter::amI2cMeter()
+{
+   reset();
+} // amI2cMeter::amI2cMeter()
+
+/**
+ * @brief Find the slot of an address, giving it one if it has none.
+ * @details Once all but the last slot are taken new addresses share the last one.
+ * @param address 7 bit I2C address.
+ * @return The slot.
+===================================================================================================*/
+amI2cAddressStats* amI2cMeter::_slotFor(uint8_t address)
+{
+   address &= 0x7F;
+   uint8_t slot = _index[address];
+   if(slot != 0)
+   {
+      return &_slots[slot - 1];
+   } // if
+   if(_count < I2C_METER_SLOTS - 1)
+   {
+      _slots[_count].address = address;
+      _index[address] = ++_count;
+      return &_slots[_count - 1];
+   } // if
+   if(_count < I2C_METER_SLOTS)
+   {
+      _slots[_count++].address = I2C_METER_OTHER; // First address that does not fit.
+   } // if
+   _index[address] = I2C_METER_SLOTS;
+   return &_slots[I2C_METER_SLOTS - 1];
+} // amI2cMeter::_slotFor()
+
+/**
+ * @brief Count a transaction that went on the bus.
+ * @param address 7 bit I2C address.
+ * @param bytes Bytes it clocked, address bytes included.
+ * @param status How it ended, I2C_OK or an I2C_ERR_ code.
+ * @param us Time it held the bus.
+===================================================================================================*/
+void amI2cMeter::record(uint8_t address, uint16_t bytes, uint8_t status, uint32_t us)
+{
+   amI2cAddressStats* s = _slotFor(address);
+   s->transactions++;
+   s->bytes += bytes;
+   s->busyUs += us;
+   s->time.record(us);
+   if(status == I2C_OK)
+   {
+      return;
+   } // if
+   if(status == I2C_ERR_NACK_ADDR || status == I2C_ERR_NACK_DATA)
+   {
+      s->nacks++;
+   } // if
+   else if(status == I2C_ERR_TIMEOUT)
+   {
+      s->timeouts++;
+   } // else if
+   else
+   {
+      s->errors++;
+   } // else
+} // amI2cMeter::record()
+
+/**
+ * @brief Count a transaction that waited too long for the bus and never went on it.
+ * @param address 7 bit I2C address.
+===================================================================================================*/
+void amI2cMeter::expire(uint8_t address)
+{
+   _slotFor(address)->timeouts++;
+} // amI2cMeter::expire()
+
+/**
+ * @brief Forget every address and its counts.
+===================================================================================================*/
+void amI2cMeter::reset()
+{
+   _count = 0;
+   for(uint8_t i = 0; i < sizeof(_index); i++)
+   {
+      _index[i] = 0;
+   } // for
+   for(uint8_t i = 0; i < I2C_METER_SLOTS; i++)
+   {
+      _slots[i].address = 0;
+      _slots[i].transactions = 0;
+      _slots[i].bytes = 0;
+      _slots[i].nacks = 0;
+      _slots[i].timeouts = 0;
+      _slots[i].errors = 0;
+      _slots[i].busyUs = 0;
+      _slots[i].time.reset();
+   } // for
+} // amI2cMeter::reset()
+
+/**
+ * @brief Look up the slot of an address.
+ * @param address 7 bit I2C address.
+ * @return The slot, which is the shared one if the address did not get its own, or nullptr if the
+ * address has not been seen since the last reset.
+===================================================================================================*/
+amI2cAddressStats* amI2cMeter::find(uint8_t address)
+{
+   uint8_t slot = _index[address & 0x7F];
+   return (slot == 0) ? nullptr : &_slots[slot - 1];
+} // amI2cMeter::find()
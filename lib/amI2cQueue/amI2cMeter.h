@@ -0,0 +1,70 @@
+/*************************************************************************************************************************************
+ * @file amI2cMeter.h
+ * @author va3wam
+ * @brief Bus time, bytes and failures of each device on one I2C bus.
+ * @details The queue of a bus records every transaction here as it comes off the bus: its address, the bytes it clocked, how it
+ * ended and how long it held the bus. Each address gets a slot the first time it is seen, found again through a table indexed by
+ * address, so recording is a lookup, a few increments and a histogram bucket, with no search and no lock. Addresses beyond the
+ * first I2C_METER_SLOTS - 1 share a last slot with the address I2C_METER_OTHER.
+ *
+ * Only the worker of the bus records. Readers on other tasks see counts that may be a transaction out of step with each other,
+ * which is fine for a report. Counts run from the last reset() and readers take differences between reports.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amI2cMeter_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amI2cMeter_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <amLogHistogram.h> // Bus time histograms.
+
+#define I2C_METER_SLOTS 16 // Addresses counted on one bus, the shared last slot included.
+#define I2C_METER_OTHER 0xFF // Address of the shared last slot.
+
+/*! What one address has cost its bus since the last reset. */
+struct amI2cAddressStats
+{
+   uint8_t address; ///< 7 bit I2C address, or I2C_METER_OTHER.
+   uint32_t transactions; ///< Transactions that went on the bus.
+   uint32_t bytes; ///< Bytes clocked on the bus, address bytes included.
+   uint32_t nacks; ///< Transactions NACKed on the address or on data.
+   uint32_t timeouts; ///< Transactions that timed out on the bus or waiting for it.
+   uint32_t errors; ///< Transactions that failed some other way.
+   uint32_t busyUs; ///< Time on the bus.
+   amLogHistogram time; ///< Time on the bus of each transaction.
+}; // struct amI2cAddressStats
+
+/*************************************************************************************************************************************
+ * @class Per address accounting of one I2C bus.
+ *************************************************************************************************************************************/
+class amI2cMeter
+{
+   public:
+      amI2cMeter(); // Class constructor.
+      void record(uint8_t address, uint16_t bytes, uint8_t status, uint32_t us); // Count a transaction that went on the bus.
+      void expire(uint8_t address); // Count a transaction that gave up waiting for the bus.
+      void reset(); // Forget every address.
+      amI2cAddressStats* find(uint8_t address); // Slot of an address. nullptr if it has not been seen.
+      uint8_t getCount() { return _count; } // amI2cMeter::getCount()
+      amI2cAddressStats* getStats(uint8_t i) { return (i < _count) ? &_slots[i] : nullptr; } // amI2cMeter::getStats()
+   private:
+      amI2cAddressStats* _slotFor(uint8_t address); // Slot of an address, given one if it is new.
+      uint8_t _index[128]; // Slot + 1 of each address, 0 for none.
+      amI2cAddressStats _slots[I2C_METER_SLOTS]; // In the order the addresses were first seen.
+      uint8_t _count; // Slots in use.
+}; // class amI2cMeter
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,458 @@
+/*************************************************************************************************************************************
+ * @file amI2cQueue.cpp
+ * @author va3wam
+ * @brief Prioritised I2C transaction queue with a worker task per bus.
+ * @details See amI2cQueue.h.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Count bus time, bytes and failures per address
+ *************************************************************************************************************************************/
+#if defined(ARDUINO) || defined(ZIPPY_NATIVE) // Tasks only exist on Arduino targets and the host shims.
+
+#include <amI2cQueue.h> // Header file for linking.
+#include <Arduino.h> // micros().
+#include <freertos/task.h> // Worker task.
+
+/**
+ * @brief This is the constructor for this class.
+ * @param bus Bus the transactions run on. Only the worker touches it once start() has been called.
+ * @param name Name of the worker task.
+===================================================================================================*/
+amI2cQueue::amI2cQueue(amI2cBus &bus, const char* name) : _bus(bus), _name(name)
+{
+   for(uint8_t i = 0; i < I2C_PRIORITIES; i++)
+   {
+      _head[i] = nullptr;
+      _tail[i] = nullptr;
+   } // for
+   resetStats(0);
+} // amI2cQueue::amI2cQueue()
+
+/**
+ * @brief Start the worker task.
+ * @details Anything queued before now is run by the worker as soon as it starts.
+ * @param stackBytes Stack for the worker.
+ * @param priority Task priority. Above every task that waits on the bus, so that a transaction
+ * that is ready goes straight onto it.
+ * @param core Core to run the worker on.
+ * @return true if the worker is running.
+===================================================================================================*/
+bool amI2cQueue::start(uint32_t stackBytes, uint8_t priority, int8_t core)
+{
+   if(_worker != nullptr)
+   {
+      return true;
+   } // if
+   TaskHandle_t worker = NULL;
+   if(xTaskCreatePinnedToCore(_workerTask, _name, stackBytes, this, priority, &worker, core) != pdPASS)
+   {
+      return false;
+   } // if
+   _worker = (void*)worker;
+   xTaskNotifyGive(worker); // Look at the lists once in case something was queued first.
+   return true;
+} // amI2cQueue::start()
+
+/**
+ * @brief Worker task. Runs transactions until there are none, then sleeps until one is submitted.
+ * @param param The queue.
+===================================================================================================*/
+void amI2cQueue::_workerTask(void* param)
+{
+   amI2cQueue* queue = (amI2cQueue*)param;
+   for(;;)
+   {
+      if(queue->runOne() == false)
+      {
+         ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // submit() gives one notification per transaction.
+      } // if
+   } // for
+} // amI2cQueue::_workerTask()
+
+/**
+ * @brief Queue a transaction.
+ * @details Fill in op, address, reg, len, data (or call and arg), priority, timeoutUs and, if
+ * wanted, done and context first. The transaction must not be touched again until its status
+ * is no longer I2C_PENDING or, if it has a done callback, until that has been called. Before
+ * start() the transaction, and anything ahead of it, runs before this returns.
+ * @param t Transaction.
+ * @return false if t is already queued or its priority is out of range.
+===================================================================================================*/
+bool amI2cQueue::submit(amI2cTransaction* t)
+{
+   if(t == nullptr || t->priority >= I2C_PRIORITIES)
+   {
+      return false;
+   } // if
+   t->next = nullptr;
+   t->submitUs = micros();
+   portENTER_CRITICAL(&_lock);
+   for(amI2cTransaction* q = _head[t->priority]; q != nullptr; q = q->next)
+   {
+      if(q == t)
+      {
+         portEXIT_CRITICAL(&_lock);
+         return false; // Submitted twice.
+      } // if
+   } // for
+   t->status = I2C_PENDING;
+   if(_tail[t->priority] == nullptr)
+   {
+      _head[t->priority] = t;
+   } // if
+   else
+   {
+      _tail[t->priority]->next = t;
+   } // else
+   _tail[t->priority] = t;
+   _queued++;
+   if(_queued > _maxQueued)
+   {
+      _maxQueued = _queued;
+   } // if
+   portEXIT_CRITICAL(&_lock);
+   if(_worker != nullptr)
+   {
+      xTaskNotifyGive((TaskHandle_t)_worker);
+   } // if
+   else
+   {
+      while(runOne() == true); // No worker yet. Run the queue dry here.
+   } // else
+   return true;
+} // amI2cQueue::submit()
+
+/**
+ * @brief Take a transaction back if it has not reached the bus.
+ * @details Its status becomes I2C_ERR_TIMEOUT and its done callback is not called.
+ * @param t Transaction.
+ * @return true if it was taken back. false if it is on the bus or has already ended.
+===================================================================================================*/
+bool amI2cQueue::cancel(amI2cTransaction* t)
+{
+   if(t == nullptr || t->priority >= I2C_PRIORITIES)
+   {
+      return false;
+   } // if
+   bool found = false;
+   portENTER_CRITICAL(&_lock);
+   amI2cTransaction* prev = nullptr;
+   for(amI2cTransaction* q = _head[t->priority]; q != nullptr; prev = q, q = q->next)
+   {
+      if(q != t)
+      {
+         continue;
+      } // if
+      if(prev == nullptr)
+      {
+         _head[t->priority] = t->next;
+      } // if
+      else
+      {
+         prev->next = t->next;
+      } // else
+      if(_tail[t->priority] == t)
+      {
+         _tail[t->priority] = prev;
+      } // if
+      _queued--;
+      _cancelled++;
+      t->status = I2C_ERR_TIMEOUT;
+      found = true;
+      break;
+   } // for
+   portEXIT_CRITICAL(&_lock);
+   return found;
+} // amI2cQueue::cancel()
+
+/**
+ * @brief Run the oldest transaction of the highest priority waiting.
+ * @details Called by the worker. Before start() it is called by submit() on the caller.
+ * @return false if nothing was waiting.
+===================================================================================================*/
+bool amI2cQueue::runOne()
+{
+   amI2cTransaction* t = nullptr;
+   portENTER_CRITICAL(&_lock);
+   for(uint8_t p = 0; p < I2C_PRIORITIES; p++)
+   {
+      if(_head[p] != nullptr)
+      {
+         t = _head[p];
+         _head[p] = t->next;
+         if(_head[p] == nullptr)
+         {
+            _tail[p] = nullptr;
+         } // if
+         _queued--;
+         break;
+      } // if
+   } // for
+   portEXIT_CRITICAL(&_lock);
+   if(t == nullptr)
+   {
+      return false;
+   } // if
+   uint8_t p = t->priority;
+   t->startUs = micros();
+   uint8_t status;
+   if(t->timeoutUs != 0 && t->startUs - t->submitUs > t->timeoutUs)
+   {
+      status = I2C_ERR_TIMEOUT; // Waited too long. The caller has given up on it.
+      t->endUs = t->startUs;
+      _timeouts[p]++;
+      _meter.expire(t->address);
+   } // if
+   else
+   {
+      status = _execute(t);
+      t->endUs = micros();
+      _busyUs += t->endUs - t->startUs;
+      _meter.record(t->address, wireBytes(t), status, t->endUs - t->startUs);
+      if(status != I2C_OK)
+      {
+         _errors[p]++;
+      } // if
+   } // else
+   _done[p]++;
+   _latency[p].record(t->endUs - t->submitUs);
+   amI2cDoneFn done = t->done; // t may be gone once its status is set.
+   t->status = status;
+   if(done != nullptr)
+   {
+      done(t);
+   } // if
+   return true;
+} // amI2cQueue::runOne()
+
+/**
+ * @brief Put one transaction on the bus.
+ * @param t Transaction.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amI2cQueue::_execute(amI2cTransaction* t)
+{
+   switch(t->op)
+   {
+      case I2C_OP_READ:
+         return _bus.readRegs(t->address, t->reg, t->data, t->len);
+      case I2C_OP_WRITE:
+         return _bus.writeRegs(t->address, t->reg, t->data, t->len);
+      case I2C_OP_PROBE:
+         return _bus.probe(t->address);
+      case I2C_OP_CALL:
+         return (t->call == nullptr) ? I2C_ERR_OTHER : t->call(t->arg);
+      default:
+         return I2C_ERR_OTHER;
+   } // switch
+} // amI2cQueue::_execute()
+
+/**
+ * @brief Work out how many bytes a transaction clocks on the bus, address bytes included.
+ * @details A read writes the register and then reads, so it sends the address twice. What a call
+ * puts on the bus is not known, so it counts nothing. Its time is still counted.
+ * @param t Transaction.
+ * @return Bytes.
+===================================================================================================*/
+uint16_t amI2cQueue::wireBytes(const amI2cTransaction* t)
+{
+   switch(t->op)
+   {
+      case I2C_OP_READ:
+         return 3 + t->len; // Address, register, address again, data.
+      case I2C_OP_WRITE:
+         return 2 + t->len; // Address, register, data.
+      case I2C_OP_PROBE:
+         return 1; // Address.
+      default:
+         return 0;
+   } // switch
+} // amI2cQueue::wireBytes()
+
+/**
+ * @brief Clear the counts and histograms.
+ * @param nowUs micros() now. Utilization is measured from here.
+===================================================================================================*/
+void amI2cQueue::resetStats(uint32_t nowUs)
+{
+   for(uint8_t i = 0; i < I2C_PRIORITIES; i++)
+   {
+      _done[i] = 0;
+      _errors[i] = 0;
+      _timeouts[i] = 0;
+      _latency[i].reset();
+   } // for
+   _cancelled = 0;
+   _busyUs = 0;
+   _maxQueued = _queued;
+   _sinceUs = nowUs;
+   _meter.reset();
+} // amI2cQueue::resetStats()
+
+/**
+ * @brief How much of the time since resetStats() the bus spent running transactions.
+ * @param nowUs micros() now.
+ * @return Tenths of a percent, 0 to 1000.
+===================================================================================================*/
+uint16_t amI2cQueue::getUtilization(uint32_t nowUs)
+{
+   uint32_t elapsed = nowUs - _sinceUs;
+   if(elapsed == 0)
+   {
+      return 0;
+   } // if
+   uint32_t permille = (uint32_t)((uint64_t)_busyUs * 1000 / elapsed);
+   return (permille > 1000) ? 1000 : permille;
+} // amI2cQueue::getUtilization()
+
+/**
+ * @brief This is the constructor for this class.
+ * @param queue Queue transactions go through.
+ * @param priority I2C_PRIO_ priority of every transaction.
+ * @param timeoutUs Longest a transaction may wait for the bus before it fails with I2C_ERR_TIMEOUT.
+===================================================================================================*/
+amI2cPort::amI2cPort(amI2cQueue &queue, uint8_t priority, uint32_t timeoutUs) : _queue(queue), _priority(priority), _timeoutUs(timeoutUs)
+{
+
+} // amI2cPort::amI2cPort()
+
+/**
+ * @brief This is the destructor for this class.
+===================================================================================================*/
+amI2cPort::~amI2cPort()
+{
+   if(_done != nullptr)
+   {
+      vSemaphoreDelete(_done);
+   } // if
+} // amI2cPort::~amI2cPort()
+
+/**
+ * @brief Done callback of port transactions. Wakes the task waiting in _transact().
+ * @param t Transaction.
+===================================================================================================*/
+void amI2cPort::_wake(amI2cTransaction* t)
+{
+   xSemaphoreGive((SemaphoreHandle_t)t->context);
+} // amI2cPort::_wake()
+
+/**
+ * @brief Submit a transaction and wait for it to end.
+ * @details If it has not reached the bus by the time its timeout is up it is taken back. One that
+ * is already on the bus is always waited for, since it lives on this task's stack.
+ * @param t Transaction with op, address, reg, len, data, call and arg filled in.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amI2cPort::_transact(amI2cTransaction &t)
+{
+   if(_done == nullptr)
+   {
+      _done = xSemaphoreCreateBinary();
+      if(_done == nullptr)
+      {
+         return I2C_ERR_OTHER;
+      } // if
+   } // if
+   t.priority = _priority;
+   t.timeoutUs = _timeoutUs;
+   t.done = _wake;
+   t.context = _done;
+   if(_queue.submit(&t) == false)
+   {
+      return I2C_ERR_OTHER;
+   } // if
+   TickType_t wait = (_timeoutUs == 0) ? portMAX_DELAY : (TickType_t)(_timeoutUs / 1000 / portTICK_PERIOD_MS + 2);
+   if(xSemaphoreTake(_done, wait) != pdTRUE)
+   {
+      if(_queue.cancel(&t) == true)
+      {
+         return I2C_ERR_TIMEOUT; // Never reached the bus.
+      } // if
+      xSemaphoreTake(_done, portMAX_DELAY); // On the bus now. Wait for it to come off.
+   } // if
+   return t.status;
+} // amI2cPort::_transact()
+
+/**
+ * @brief Write a block of registers in one transaction.
+ * @param address 7 bit I2C address of the device.
+ * @param reg First register to write.
+ * @param data Bytes to write.
+ * @param len Number of bytes to write.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amI2cPort::writeRegs(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t len)
+{
+   amI2cTransaction t = {};
+   t.op = I2C_OP_WRITE;
+   t.address = address;
+   t.reg = reg;
+   t.len = len;
+   t.data = (uint8_t*)data; // Only read for a write.
+   return _transact(t);
+} // amI2cPort::writeRegs()
+
+/**
+ * @brief Read a block of registers in one transaction.
+ * @param address 7 bit I2C address of the device.
+ * @param reg First register to read.
+ * @param dest Where to put the bytes read.
+ * @param len Number of bytes to read.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amI2cPort::readRegs(uint8_t address, uint8_t reg, uint8_t* dest, uint8_t len)
+{
+   amI2cTransaction t = {};
+   t.op = I2C_OP_READ;
+   t.address = address;
+   t.reg = reg;
+   t.len = len;
+   t.data = dest;
+   return _transact(t);
+} // amI2cPort::readRegs()
+
+/**
+ * @brief Check for a device at the specified address.
+ * @param address 7 bit I2C address of the device.
+ * @return I2C_OK if the device acknowledged its address.
+===================================================================================================*/
+uint8_t amI2cPort::probe(uint8_t address)
+{
+   amI2cTransaction t = {};
+   t.op = I2C_OP_PROBE;
+   t.address = address;
+   return _transact(t);
+} // amI2cPort::probe()
+
+/**
+ * @brief Run a function with the bus to itself.
+ * @details For drivers that talk to TwoWire directly. Keep fn short: nothing else gets onto the
+ * bus, whatever its priority, until it returns.
+ * @param address 7 bit I2C address of the device fn talks to. Its bus time is counted there.
+ * @param fn Function to run on the worker.
+ * @param arg Handed to fn.
+ * @return What fn returned, or I2C_ERR_TIMEOUT if it never got the bus.
+===================================================================================================*/
+uint8_t amI2cPort::call(uint8_t address, amI2cCallFn fn, void* arg)
+{
+   amI2cTransaction t = {};
+   t.op = I2C_OP_CALL;
+   t.address = address;
+   t.call = fn;
+   t.arg = arg;
+   return _transact(t);
+} // amI2cPort::call()
+
+#endif // defined(ARDUINO) || defined(ZIPPY_NATIVE)
@@ -0,0 +1,169 @@
+/*************************************************************************************************************************************
+ * @file amI2cQueue.h
+ * @author va3wam
+ * @brief Prioritised I2C transaction queue with a worker task per bus.
+ * @details Every transaction on a bus goes through its queue, so no two tasks ever meet half way through a TwoWire exchange. Each
+ * transaction is a descriptor owned by the submitter. A worker task takes them highest priority first, oldest first within a
+ * priority, and runs each one on the bus. A control loop transaction therefore waits for at most the one transaction already on the
+ * bus, never for the LCD or diagnostic traffic queued ahead of it. Nothing is interrupted part way.
+ *
+ * A transaction can be a register read, a register write, a probe or a call. A call runs a function on the worker with the bus to
+ * itself, for drivers such as LiquidCrystal_I2C that talk to TwoWire directly. A transaction that waited longer than its timeout
+ * before reaching the bus ends with I2C_ERR_TIMEOUT without touching the bus. When it ends the done callback, if there is one,
+ * runs on the worker. Each transaction is also counted against its address in the queue's amI2cMeter.
+ *
+ * amI2cPort wraps a queue as an amI2cBus at one priority. Drivers built on amI2cBus use it unchanged and each call waits for its
+ * transaction. A port belongs to one task at a time, so give each task that talks to a device a port of its own.
+ *
+ * Until start() is called a submitted transaction runs straight away on the caller, along with anything queued ahead of it. Only one
+ * task may use the queue until then.
+ * @code
+ * amWireBus wire0(Wire);
+ * amI2cQueue bus0(wire0, "i2c0");
+ * amI2cPort controlPort(bus0, I2C_PRIO_CONTROL);
+ * amMD25Driver md25(controlPort, 0x58);
+ * bus0.start(4096, 20, 1);
+ * @endcode
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Count bus time, bytes and failures per address
+ *************************************************************************************************************************************/
+#ifndef amI2cQueue_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amI2cQueue_h // Precompiler macro used for precompiler check.
+
+#if defined(ARDUINO) || defined(ZIPPY_NATIVE) // Tasks only exist on Arduino targets and the host shims.
+
+#include <stdint.h> // Fixed width integer types.
+#include <freertos/FreeRTOS.h> // Spinlock.
+#include <freertos/semphr.h> // Port completion.
+#include <amI2cBus.h> // Register level I2C bus interface.
+#include <amLogHistogram.h> // Latency histograms.
+#include <amI2cMeter.h> // Bus time of each address.
+
+// Priorities. Lower numbers go first.
+#define I2C_PRIO_CONTROL 0 // Balance loop. Served before anything else.
+#define I2C_PRIO_NORMAL 1 // Drive train moves and device set up.
+#define I2C_PRIO_DISPLAY 2 // LCD and OLEDs.
+#define I2C_PRIO_DIAG 3 // Scans and anything else that can wait.
+#define I2C_PRIORITIES 4 // Number of priorities.
+
+// Transaction types.
+#define I2C_OP_READ 0 // Read len bytes from reg into data.
+#define I2C_OP_WRITE 1 // Write len bytes from data to reg.
+#define I2C_OP_PROBE 2 // Address only. I2C_OK if a device answers.
+#define I2C_OP_CALL 3 // Run call(arg) with the bus to itself.
+
+#define I2C_PENDING 0xFF // Status while a transaction is queued or on the bus.
+#define I2C_PORT_TIMEOUT_US 50000 // Default wait for a port transaction to reach the bus.
+
+struct amI2cTransaction;
+typedef void (*amI2cDoneFn)(amI2cTransaction* t); // Transaction has ended. Runs on the worker.
+typedef uint8_t (*amI2cCallFn)(void* arg); // Body of an I2C_OP_CALL. Returns an I2C_ status.
+
+/*! One bus transaction. Owned by the submitter, which must not touch it again until it has ended. */
+struct amI2cTransaction
+{
+   uint8_t op; ///< I2C_OP_ type.
+   uint8_t address; ///< 7 bit I2C address. For a call, the device its bus time is charged to.
+   uint8_t reg; ///< First register.
+   uint8_t len; ///< Bytes to read or write.
+   uint8_t* data; ///< Bytes read, or bytes to write.
+   amI2cCallFn call; ///< Body of an I2C_OP_CALL.
+   void* arg; ///< Handed to call.
+   amI2cDoneFn done; ///< Called when it ends. May be nullptr.
+   void* context; ///< For the done callback.
+   uint8_t priority; ///< I2C_PRIO_ priority.
+   uint32_t timeoutUs; ///< Longest wait in the queue. 0 waits as long as it takes.
+   volatile uint8_t status; ///< I2C_PENDING, then I2C_OK or an I2C_ERR_ code. Set just before done is called.
+   uint32_t submitUs; ///< micros() when submitted.
+   uint32_t startUs; ///< micros() when it reached the bus.
+   uint32_t endUs; ///< micros() when it ended.
+   amI2cTransaction* next; ///< Queue link.
+}; // struct amI2cTransaction
+
+/*************************************************************************************************************************************
+ * @class Prioritised transaction queue and worker task for one I2C bus.
+ *************************************************************************************************************************************/
+class amI2cQueue
+{
+   public:
+      amI2cQueue(amI2cBus &bus, const char* name); // Class constructor.
+      bool start(uint32_t stackBytes, uint8_t priority, int8_t core); // Start the worker task.
+      bool submit(amI2cTransaction* t); // Queue a transaction.
+      bool cancel(amI2cTransaction* t); // Take a transaction back if it has not reached the bus.
+      bool runOne(); // Run the next transaction on this thread.
+      void resetStats(uint32_t nowUs); // Clear the counts and histograms.
+      uint16_t getUtilization(uint32_t nowUs); // Tenths of a percent of the time since resetStats() the bus was busy.
+      amLogHistogram &getLatency(uint8_t priority) { return _latency[priority % I2C_PRIORITIES]; } // amI2cQueue::getLatency()
+      uint32_t getDone(uint8_t priority) { return _done[priority % I2C_PRIORITIES]; } // amI2cQueue::getDone()
+      uint32_t getErrors(uint8_t priority) { return _errors[priority % I2C_PRIORITIES]; } // amI2cQueue::getErrors()
+      uint32_t getTimeouts(uint8_t priority) { return _timeouts[priority % I2C_PRIORITIES]; } // amI2cQueue::getTimeouts()
+      uint32_t getCancelled() { return _cancelled; } // amI2cQueue::getCancelled()
+      uint32_t getBusyUs() { return _busyUs; } // amI2cQueue::getBusyUs()
+      uint32_t getSinceUs() { return _sinceUs; } // amI2cQueue::getSinceUs()
+      uint8_t getQueued() { return _queued; } // amI2cQueue::getQueued()
+      uint8_t getMaxQueued() { return _maxQueued; } // amI2cQueue::getMaxQueued()
+      bool isStarted() { return _worker != nullptr; } // amI2cQueue::isStarted()
+      const char* getName() { return _name; } // amI2cQueue::getName()
+      amI2cMeter &getMeter() { return _meter; } // amI2cQueue::getMeter()
+      static uint16_t wireBytes(const amI2cTransaction* t); // Bytes a transaction clocks on the bus.
+   private:
+      static void _workerTask(void* param); // FreeRTOS task body.
+      uint8_t _execute(amI2cTransaction* t); // Put one transaction on the bus.
+      amI2cBus &_bus; // Bus the transactions run on.
+      const char* _name; // Task name.
+      portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED; // Guards the lists.
+      amI2cTransaction* _head[I2C_PRIORITIES]; // Oldest transaction of each priority.
+      amI2cTransaction* _tail[I2C_PRIORITIES]; // Newest transaction of each priority.
+      void* _worker = nullptr; // Worker task. nullptr until start().
+      uint8_t _queued = 0; // Transactions waiting.
+      uint8_t _maxQueued = 0; // Most waiting at once.
+      uint32_t _done[I2C_PRIORITIES]; // Transactions ended, including failures.
+      uint32_t _errors[I2C_PRIORITIES]; // Transactions the bus failed.
+      uint32_t _timeouts[I2C_PRIORITIES]; // Transactions that waited too long.
+      uint32_t _cancelled = 0; // Transactions taken back by cancel().
+      amLogHistogram _latency[I2C_PRIORITIES]; // Submit to end, per priority.
+      uint32_t _busyUs = 0; // Time spent on the bus since resetStats().
+      uint32_t _sinceUs = 0; // micros() at resetStats().
+      amI2cMeter _meter; // Bus time, bytes and failures of each address.
+}; // class amI2cQueue
+
+/*************************************************************************************************************************************
+ * @class An amI2cQueue seen as an amI2cBus at one priority. Each call waits for its transaction to end.
+ *************************************************************************************************************************************/
+class amI2cPort : public amI2cBus
+{
+   public:
+      amI2cPort(amI2cQueue &queue, uint8_t priority, uint32_t timeoutUs = I2C_PORT_TIMEOUT_US); // Class constructor.
+      ~amI2cPort(); // Class destructor.
+      uint8_t writeRegs(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t len); // Write len bytes from reg.
+      uint8_t readRegs(uint8_t address, uint8_t reg, uint8_t* dest, uint8_t len); // Read len bytes from reg.
+      uint8_t probe(uint8_t address); // Address only transaction.
+      uint8_t call(uint8_t address, amI2cCallFn fn, void* arg); // Run fn with the bus to itself. Its time is charged to address.
+      amI2cQueue &getQueue() { return _queue; } // amI2cPort::getQueue()
+      uint8_t getPriority() { return _priority; } // amI2cPort::getPriority()
+   private:
+      static void _wake(amI2cTransaction* t); // Done callback. Wakes the waiting task.
+      uint8_t _transact(amI2cTransaction &t); // Submit and wait.
+      amI2cQueue &_queue; // Queue transactions go through.
+      uint8_t _priority; // I2C_PRIO_ priority of every transaction.
+      uint32_t _timeoutUs; // Longest wait for the bus.
+      SemaphoreHandle_t _done = nullptr; // Given when a transaction ends. Made on first use.
+}; // class amI2cPort
+
+#endif // defined(ARDUINO) || defined(ZIPPY_NATIVE)
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,111 @@
+/*************************************************************************************************************************************
+ * @file amLogHistogram.cpp
+ * @author va3wam
+ * @brief Histogram of times in power of two buckets.
+ * @details See amLogHistogram.h.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <amLogHistogram.h> // Header file for linking.
+
+/**
+ * @brief This is the constructor for this class. The histogram starts empty.
+===================================================================================================*/
+amLogHistogram::amLogHistogram()
+{
+   reset();
+} // amLogHistogram::amLogHistogram()
+
+/**
+ * @brief Work out which bucket a time goes in.
+ * @param us Time in microseconds.
+ * @return Bucket, 0 to HIST_BUCKETS - 1.
+===================================================================================================*/
+uint8_t amLogHistogram::bucketOf(uint32_t us)
+{
+   if(us < 2)
+   {
+      return 0;
+   } // if
+   uint8_t bucket = 31 - __builtin_clz(us); // Highest bit set.
+   return (bucket < HIST_BUCKETS) ? bucket : HIST_BUCKETS - 1;
+} // amLogHistogram::bucketOf()
+
+/**
+ * @brief Longest time a bucket counts.
+ * @param bucket Bucket, 0 to HIST_BUCKETS - 1.
+ * @return Time in microseconds. The last bucket has no top, so UINT32_MAX.
+===================================================================================================*/
+uint32_t amLogHistogram::bucketTopUs(uint8_t bucket)
+{
+   if(bucket >= HIST_BUCKETS - 1)
+   {
+      return UINT32_MAX;
+   } // if
+   return (2UL << bucket) - 1;
+} // amLogHistogram::bucketTopUs()
+
+/**
+ * @brief Count one time.
+ * @param us Time in microseconds.
+===================================================================================================*/
+void amLogHistogram::record(uint32_t us)
+{
+   _buckets[bucketOf(us)]++;
+   _count++;
+   if(us > _maxUs)
+   {
+      _maxUs = us;
+   } // if
+} // amLogHistogram::record()
+
+/**
+ * @brief Clear the counts.
+===================================================================================================*/
+void amLogHistogram::reset()
+{
+   for(uint8_t i = 0; i < HIST_BUCKETS; i++)
+   {
+      _buckets[i] = 0;
+   } // for
+   _count = 0;
+   _maxUs = 0;
+} // amLogHistogram::reset()
+
+/**
+ * @brief Estimate a percentile.
+ * @param percent 1 to 100.
+ * @return Upper edge of the bucket the percentile falls in, no more than the longest time seen. 0 if
+ * nothing has been recorded.
+===================================================================================================*/
+uint32_t amLogHistogram::getPercentileUs(uint8_t percent)
+{
+   if(_count == 0)
+   {
+      return 0;
+   } // if
+   uint32_t wanted = (uint32_t)(((uint64_t)_count * percent + 99) / 100); // Times at or below the percentile, rounded up.
+   uint32_t seen = 0;
+   for(uint8_t i = 0; i < HIST_BUCKETS; i++)
+   {
+      seen += _buckets[i];
+      if(seen >= wanted && seen > 0)
+      {
+         uint32_t top = bucketTopUs(i);
+         return (top < _maxUs) ? top : _maxUs;
+      } // if
+   } // for
+   return _maxUs;
+} // amLogHistogram::getPercentileUs()
@@ -0,0 +1,52 @@
+/*************************************************************************************************************************************
+ * @file amLogHistogram.h
+ * @author va3wam
+ * @brief Histogram of times in power of two buckets.
+ * @details Bucket 0 counts times under 2us and bucket n times from 2^n up to 2^(n+1) us. The last bucket takes everything longer.
+ * Adding a time is a count leading zeros and an increment, cheap enough for every bus transaction. Percentiles come back as the
+ * upper edge of the bucket they fall in, so they are never more than a factor of two out and never optimistic.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amLogHistogram_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amLogHistogram_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+
+#define HIST_BUCKETS 16 // Buckets per histogram. The last one starts at 32.8ms.
+
+/*************************************************************************************************************************************
+ * @class Counts of times in power of two buckets, with the longest time seen.
+ *************************************************************************************************************************************/
+class amLogHistogram
+{
+   public:
+      amLogHistogram(); // Class constructor.
+      void record(uint32_t us); // Count one time.
+      void reset(); // Clear the counts.
+      uint32_t getPercentileUs(uint8_t percent); // Upper edge of the bucket the percentile falls in. 0 if empty.
+      uint32_t getCount() { return _count; } // amLogHistogram::getCount()
+      uint32_t getMaxUs() { return _maxUs; } // amLogHistogram::getMaxUs()
+      uint32_t getBucket(uint8_t bucket) { return (bucket < HIST_BUCKETS) ? _buckets[bucket] : 0; } // amLogHistogram::getBucket()
+      static uint8_t bucketOf(uint32_t us); // Bucket a time goes in.
+      static uint32_t bucketTopUs(uint8_t bucket); // Longest time counted in a bucket.
+   private:
+      uint32_t _buckets[HIST_BUCKETS]; // Counts.
+      uint32_t _count; // Times recorded.
+      uint32_t _maxUs; // Longest time recorded.
+}; // class amLogHistogram
+
+#endif // End of precompiler protected code block
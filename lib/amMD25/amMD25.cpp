@@ -18,6 +18,10 @@
  * 
  * YYYY-MM-DD Dev    Description
  * ---------- ------ -------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Reads and writes go through an amI2cBus. The while(Wire.available() < n) loops
+ *                   hung the robot for good if one byte went missing on the bus
+ * 2026-10-17 va3wam Removed 50ms delay from getEncoder1() and getEncoder2(). requestFrom() has 
+ *                   already finished the transfer when it returns
  * 2021-01-13 va3wam Renamed  Encoder1 and Encoder2 functions to getEncoder1 and getEncoder2 
  *                   respectively 
  * 2021-01-10 va3wam Program created
@@ -29,24 +33,40 @@
 
 /**
  * @brief This is the constructor for this class.
+ * @param bus Bus the MD25 is attached to.
 ===================================================================================================*/
-amMD25::amMD25()
+amMD25::amMD25(amI2cBus &bus) : _bus(bus), _status(I2C_OK)
 {
 
-} //amI2Cbus::amI2Cbus()
+} //amMD25::amMD25()
+
+/** 
+ * @brief How the last transfer with the MD25 ended
+ * @return I2C_OK or one of the I2C_ERR_ codes
+=================================================================================================== */
+uint8_t amMD25::getStatus()
+{
+  return(_status);
+} //amMD25::getStatus()
+
+/** 
+ * @brief Write one MD25 register
+ * @param reg Register to write
+ * @param value Value to write to it
+=================================================================================================== */
+void amMD25::_writeReg(uint8_t reg, uint8_t value)
+{
+  _status = _bus.writeReg(md25I2cAddress, reg, value); // One bounded transaction
+} //amMD25::_writeReg()
 
 /** 
  * @brief Function that gets the software version 
+ * @return Software revision, or 0 if the MD25 did not answer. See getStatus()
 =================================================================================================== */
 byte amMD25::getFirmwareVersion()
 {                                               
-//  Serial.println("<amMD25::getFirmwareVersion> Retrieving firmware version from MD25");
-  Wire.beginTransmission(md25I2cAddress); // Request token to transmit on I2C bus
-  Wire.write(MD25RegSoftwareRev); // Send byte to read software version as a single byte
-  Wire.endTransmission(); // End request for token
-  Wire.requestFrom(md25I2cAddress, 1); // Request 1 byte from MD25 address register
-  while(Wire.available() < 1); // Wait for reply to request for address to arrive
-  byte software = Wire.read(); // Read it in
+  byte software = 0;
+  _status = _bus.readRegs(md25I2cAddress, MD25RegSoftwareRev, &software, 1); // Gives up after the bus timeout
   return(software); // Return address to 
 } //getMD25FirmwareVersion()
 
@@ -67,33 +87,38 @@ void amMD25::cfgToConsole()
 =================================================================================================== */
 void amMD25::encoderReset()
 {                                       
-  Wire.beginTransmission(md25I2cAddress); // Start conversation with motor controller
-  Wire.write(MD25RegCmd); // Set up command register
-  Wire.write(MD25CmdResetEncoders); // Send command to reset motor encoders
-  Wire.endTransmission(); 
+  _writeReg(MD25RegCmd, MD25CmdResetEncoders); // Send command to reset motor encoders
 } //encodeReset()
 
+/** 
+ * @brief Read one encoder as a long
+ * @param reg First of its four registers, highest byte first
+ * @return Encoder count, or 0 if the MD25 did not answer. See getStatus()
+=================================================================================================== */
+long amMD25::_readEncoder(uint8_t reg)
+{
+  uint8_t raw[4] = {0, 0, 0, 0};
+  _status = _bus.readRegs(md25I2cAddress, reg, raw, 4); // Gives up after the bus timeout
+  if(_status != I2C_OK)
+  {
+    return(0);
+  } // if
+  long poss = raw[0]; // HH
+  poss <<= 8;
+  poss += raw[1]; // HL
+  poss <<= 8;
+  poss += raw[2]; // LH
+  poss <<= 8;
+  poss += raw[3]; // LL
+  return(poss);
+} //amMD25::_readEncoder()
+
 /** 
  * @brief Function to reads the value of encoder 1 as a long
 =================================================================================================== */
 long amMD25::getEncoder1()
 {                                            
-  Wire.beginTransmission(md25I2cAddress); // Send byte to get a reading from encoder 1
-  Wire.write(MD25RegEncoder1a);
-  Wire.endTransmission();
-  
-  Wire.requestFrom(md25I2cAddress, 4); // Request 4 bytes from MD25
-  while(Wire.available() < 4); // Wait for 4 bytes to arrive
-  long poss1 = Wire.read(); // First byte for encoder 1, HH.
-  poss1 <<= 8;
-  poss1 += Wire.read(); // Second byte for encoder 1, HL
-  poss1 <<= 8;
-  poss1 += Wire.read(); // Third byte for encoder 1, LH
-  poss1 <<= 8;
-  poss1 +=Wire.read(); // Fourth byte for encoder 1, LL
-
-  delay(50); // Wait for everything to make sure everything is sent  
-  return(poss1);
+  return(_readEncoder(MD25RegEncoder1a));
 } //encoder1()
 
 /** 
@@ -101,22 +126,7 @@ long amMD25::getEncoder1()
 =================================================================================================== */
 long amMD25::getEncoder2()
 {                                            
-  Wire.beginTransmission(md25I2cAddress);           
-  Wire.write(MD25RegEncoder2a);
-  Wire.endTransmission();
-  
-  Wire.requestFrom(md25I2cAddress, 4); // Request 4 bytes from MD25
-  while(Wire.available() < 4); // Wait for 4 bytes to become available
-  long poss2 = Wire.read();
-  poss2 <<= 8;
-  poss2 += Wire.read();                
-  poss2 <<= 8;
-  poss2 += Wire.read();                
-  poss2 <<= 8;
-  poss2 +=Wire.read();               
-  
-  delay(50); // Wait to make sure everything is sent   
-  return(poss2);
+  return(_readEncoder(MD25RegEncoder2a));
 } //encoder2()
 
 /** 
@@ -128,26 +138,14 @@ void amMD25::stopMotor(int motorNumber)
   switch(motorNumber)
   {
       case 0: // Left motor 
-         Wire.beginTransmission(md25I2cAddress);
-         Wire.write(MD25RegSpeed2);
-         Wire.write(128); // Sends a value of 128 to motor 2 this value stops the motor
-         Wire.endTransmission();
+         _writeReg(MD25RegSpeed2, 128); // Sends a value of 128 to motor 2 this value stops the motor
          break;
       case 1: // Right motor
-         Wire.beginTransmission(md25I2cAddress);
-         Wire.write(MD25RegSpeed1);
-         Wire.write(128); // Sends a value of 128 to motor 2 this value stops the motor
-         Wire.endTransmission();
+         _writeReg(MD25RegSpeed1, 128); // Sends a value of 128 to motor 1 this value stops the motor
          break;
       default: // Both motors
-         Wire.beginTransmission(md25I2cAddress);
-         Wire.write(MD25RegSpeed2);
-         Wire.write(128); // Sends a value of 128 to motor 2 this value stops the motor
-         Wire.endTransmission();
-         Wire.beginTransmission(md25I2cAddress);
-         Wire.write(MD25RegSpeed1);
-         Wire.write(128); // Sends a value of 128 to motor 2 this value stops the motor
-         Wire.endTransmission();
+         _writeReg(MD25RegSpeed2, 128); // Sends a value of 128 to motor 2 this value stops the motor
+         _writeReg(MD25RegSpeed1, 128); // Sends a value of 128 to motor 1 this value stops the motor
          break;
   } // switch
 }  //stopMotor()
@@ -164,39 +162,18 @@ void amMD25::spinMotor(int motorNumber, int speed)
   {
       case 0: // Left motor 
          Serial.println("<amMD25::spinMotor> Spin left motor");
-         Wire.beginTransmission(md25I2cAddress); // Request start transmit to the MD25 H-bridge
-         Wire.write(MD25RegMode); // Going to write to the mode register
-         Wire.write(0); // Writing 0 sets speed controls to 0 (Full Reverse), 128 (Stop), 255 (Full Forward)
-         Wire.endTransmission(); // End transmit
-   //      delay(1); // Give bus a breather
-         Wire.beginTransmission(md25I2cAddress); // Request start transmit to the MD25 H-bridge
-         Wire.write(MD25RegSpeed1); // Indicate motor1 speed register
-         Wire.write(speed); // 1-127 = backwards, 128 = stop, 129-255 = forward                                           
-         Wire.endTransmission(); // End transmit
+         _writeReg(MD25RegMode, 0); // Writing 0 sets speed controls to 0 (Full Reverse), 128 (Stop), 255 (Full Forward)
+         _writeReg(MD25RegSpeed1, speed); // 1-127 = backwards, 128 = stop, 129-255 = forward
          break;
       case 1: // Right motor 
          Serial.println("<amMD25::spinMotor> Spin right motor");
-         Wire.beginTransmission(md25I2cAddress); // Request start transmit to the MD25 H-bridge
-         Wire.write(MD25RegMode); // Going to write to the mode register
-         Wire.write(0); // Writing 0 sets speed controls to 0 (Full Reverse), 128 (Stop), 255 (Full Forward)
-         Wire.endTransmission(); // End transmit
-   //      delay(1); // Give bus a breather
-         Wire.beginTransmission(md25I2cAddress); // Request start transmit to the MD25 H-bridge
-         Wire.write(MD25RegSpeed2); // Indicate motor1 speed register
-         Wire.write(speed); // 1-127 = backwards, 128 = stop, 129-255 = forward                                           
-         Wire.endTransmission(); // End transmit
+         _writeReg(MD25RegMode, 0); // Writing 0 sets speed controls to 0 (Full Reverse), 128 (Stop), 255 (Full Forward)
+         _writeReg(MD25RegSpeed2, speed); // 1-127 = backwards, 128 = stop, 129-255 = forward
          break;
       default: // Both motors
          Serial.println("<amMD25::spinMotor> Spin both motors");
-         Wire.beginTransmission(md25I2cAddress); // Request start transmit to the MD25 H-bridge
-         Wire.write(MD25RegMode); // Going to write to the mode register
-         Wire.write(2); // Writing 2 to the mode register will make speed1 control both motors speed
-         Wire.endTransmission(); // End transmit
-   //      delay(1); // Give bus a breather
-         Wire.beginTransmission(md25I2cAddress); // Request start transmit to the MD25 H-bridge
-         Wire.write(MD25RegSpeed1); // Indicate motor1 speed register
-         Wire.write(speed); // 1-127 = backwards, 128 = stop, 129-255 = forward                                           
-         Wire.endTransmission(); // End transmit
+         _writeReg(MD25RegMode, 2); // Writing 2 to the mode register will make speed1 control both motors speed
+         _writeReg(MD25RegSpeed1, speed); // 1-127 = backwards, 128 = stop, 129-255 = forward
          break;
   } // switch
 } // spinMotor()
\ No newline at end of file
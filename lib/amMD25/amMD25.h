@@ -2,7 +2,7 @@
  * @file amMD25.h
  * @author va3wam
  * @brief MD25 dual h-bridge motorcontroller library 
- * @details I2C motor controller.
+ * @details I2C motor controller. Every transfer goes through an amI2cBus, so no call can wait on the bus forever.
  * @copyright Copyright (c) 2021 va3wam
  * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files 
  * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, 
@@ -16,45 +16,23 @@
  * 
  * YYYY-MM-DD Dev    Description
  * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Use the register map in amMD25Regs.h instead of a copy of it
+ * 2026-10-17 va3wam Talk to the MD25 through an amI2cBus instead of busy-waiting on Wire
  * 2021-01-08 va3wam Program created
  *************************************************************************************************************************************/
 #ifndef amMD25_h
 #define amMD25_h
 
 #include <main.h> // Header file for all libraries needed by this program.
-
-// Define MD25 registers 
-#define MD25RegSpeed1 (byte) 0x00 // Motor1 speed (mode 0,1) or both motors speed (mode 2,3)
-                                  // Cast as a byte to stop them being misinterperted as NULL. This is a bug with arduino 1
-#define MD25RegSpeed2 0x01 // Motor2 speed (mode 0,1) or turn (mode 2,3)
-#define MD25RegEncoder1a 0x02 // Byte 1 of encoder 1 
-#define MD25RegEncoder1b 0x03 // Byte 2 of encoder 1
-#define MD25RegEncoder1c 0x04 // Byte 3 of encoder 1
-#define MD25RegEncoder1d 0x05 // Byte 4 of encoder 1
-#define MD25RegEncoder2a 0x06 // Byte 1 of encoder 2
-#define MD25RegEncoder2b 0x07 // Byte 2 of encoder 2
-#define MD25RegEncoder2c 0x08 // Byte 3 of encoder 2
-#define MD25RegEncoder2d 0x09 // Byte 4 of encoder 2
-#define MD25RegBatteryVolts 0x0A // The supply battery voltatage
-#define MD25RegMotorCur1 0x0B // The current through motor 1 (Left)
-#define MD25RegMotorCur2 0x0C // The current through motor 2 (Right)
-#define MD25RegSoftwareRev 0x0D // Software Revision Number
-#define MD25RegMotorAccel 0x0E // Optional Acceleration register
-#define MD25RegMode 0x0F // Used to set the funtion of Speed1 and speed2 registers
-#define MD25RegCmd 0x10 // Used for reset of encoder counts and module address changes  
-
-// Define MD25 commands. Note changing I2C address commands not listed here
-#define MD25CmdResetEncoders 0x20 // Reset the motor encoder counters
-#define MD25CmdAutoSpeedRegOff 0x30 // Disable automatic speed regulation
-#define MD25CmdAutoSpeedRegOn 0x31 // Enable automatic speed regulation
-#define MD25CmdAutoTimeoutOff 0x32 // Disable automatic 2 second timeout of motors when no I2C activity
-#define MD25CmdAutoTimeoutOn 0x33 // Enable automatic 2 second timeout of motors when no I2C activity
+#include <amI2cBus.h> // Register level I2C bus interface with bounded transfers.
+#include <amMD25Regs.h> // MD25 register map, shared with amMD25Driver.
 
 // Define amMD25 class
 class amMD25
 {
   public:
-    amMD25(); // Constructor
+    amMD25(amI2cBus &bus); // Constructor
+    uint8_t getStatus(); // I2C_OK or the I2C_ERR_ code of the last transfer
     void cfgToConsole();
     byte getFirmwareVersion();
     void encoderReset();
@@ -64,6 +42,10 @@ class amMD25
     void motorTest();
     void spinMotor(int motorNumber, int speed);
   private:
+    long _readEncoder(uint8_t reg); // Read one 32 bit encoder
+    void _writeReg(uint8_t reg, uint8_t value); // Write one register
+    amI2cBus &_bus; // Bus the MD25 is attached to
+    uint8_t _status; // How the last transfer ended
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,281 @@
+/*************************************************************************************************************************************
+ * @file amMD25Driver.cpp
+ * @author va3wam
+ * @brief Register level driver for the MD25 dual h-bridge motor controller.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Added readTelemetrySnapshot()
+ * 2026-10-17 va3wam Added setAcceleration()
+ * 2026-10-17 va3wam Added the shared register shadow and setModeAndAcceleration()
+ *************************************************************************************************************************************/
+#include <amMD25Driver.h> // Header file for linking.
+
+/**
+ * @brief This is the constructor for this class.
+ * @param bus The I2C bus the MD25 is attached to.
+ * @param address 7 bit I2C address of the MD25 (0x58 by default).
+ * @param shadow Register shadow shared by every driver of this MD25. nullptr to send every write.
+===================================================================================================*/
+amMD25Driver::amMD25Driver(amI2cBus &bus, uint8_t address, amMD25Shadow* shadow) : _bus(bus), _address(address), _shadow(shadow)
+{
+
+} // amMD25Driver::amMD25Driver()
+
+/**
+ * @brief Report the I2C address of the controller.
+ * @return 7 bit I2C address.
+===================================================================================================*/
+uint8_t amMD25Driver::getAddress()
+{
+   return _address;
+} // amMD25Driver::getAddress()
+
+/**
+ * @brief Read the firmware version running on the MD25.
+ * @param version Where to put the version number.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMD25Driver::getFirmwareVersion(uint8_t* version)
+{
+   return _read(MD25RegSoftwareRev, version, 1);
+} // amMD25Driver::getFirmwareVersion()
+
+/**
+ * @brief Reset both motor encoder values to 0.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMD25Driver::resetEncoders()
+{
+   uint8_t command = MD25CmdResetEncoders;
+   return _write(MD25RegCmd, &command, 1, true);
+} // amMD25Driver::resetEncoders()
+
+/**
+ * @brief Set the meaning of the two speed registers.
+ * @param mode One of the MD25Mode values.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMD25Driver::setMode(uint8_t mode)
+{
+   return _write(MD25RegMode, &mode, 1, false);
+} // amMD25Driver::setMode()
+
+/**
+ * @brief Write the speed1 register.
+ * @param speed Motor1 speed (mode 0,1) or both motors speed (mode 2,3).
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMD25Driver::setSpeed1(uint8_t speed)
+{
+   return _write(MD25RegSpeed1, &speed, 1, false);
+} // amMD25Driver::setSpeed1()
+
+/**
+ * @brief Write the speed2 register.
+ * @param speed Motor2 speed (mode 0,1) or turn (mode 2,3).
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMD25Driver::setSpeed2(uint8_t speed)
+{
+   return _write(MD25RegSpeed2, &speed, 1, false);
+} // amMD25Driver::setSpeed2()
+
+/**
+ * @brief Write both speed registers in a single auto-increment transaction.
+ * @details With a shadow, only a speed that has changed goes out, as a one byte write.
+ * @param speed1 Value for the speed1 register.
+ * @param speed2 Value for the speed2 register.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMD25Driver::setSpeeds(uint8_t speed1, uint8_t speed2)
+{
+   uint8_t speeds[2] = {speed1, speed2};
+   return _write(MD25RegSpeed1, speeds, 2, false);
+} // amMD25Driver::setSpeeds()
+
+/**
+ * @brief Set how quickly the motors follow a change in the speed registers.
+ * @details The MD25 keeps the rate until it is powered off, so it must be set by whoever relies
+ * on it.
+ * @param rate MD25AccelSlowest to MD25AccelFastest. Clamped to that range.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMD25Driver::setAcceleration(uint8_t rate)
+{
+   rate = _clampAccel(rate);
+   return _write(MD25RegMotorAccel, &rate, 1, false);
+} // amMD25Driver::setAcceleration()
+
+/**
+ * @brief Set the acceleration rate and the mode in a single auto-increment transaction.
+ * @details The two registers sit next to each other, acceleration first. With a shadow, only the
+ * ones that have changed go out.
+ * @param mode One of the MD25Mode values.
+ * @param rate MD25AccelSlowest to MD25AccelFastest. Clamped to that range.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMD25Driver::setModeAndAcceleration(uint8_t mode, uint8_t rate)
+{
+   uint8_t values[2] = {_clampAccel(rate), mode};
+   return _write(MD25RegMotorAccel, values, 2, false);
+} // amMD25Driver::setModeAndAcceleration()
+
+/**
+ * @brief Keep an acceleration rate to the range the MD25 takes.
+ * @param rate Rate asked for.
+ * @return MD25AccelSlowest to MD25AccelFastest.
+===================================================================================================*/
+uint8_t amMD25Driver::_clampAccel(uint8_t rate)
+{
+   if(rate < MD25AccelSlowest)
+   {
+      return MD25AccelSlowest;
+   } // if
+   if(rate > MD25AccelFastest)
+   {
+      return MD25AccelFastest;
+   } // if
+   return rate;
+} // amMD25Driver::_clampAccel()
+
+/**
+ * @brief Stop both motors.
+ * @details 128 in both speed registers stops both motors in mode 0 and means full stop with no turn
+ * in mode 2. Always sent, even when the shadow says the motors are stopped already, as a stop must
+ * never be lost to a shadow that is wrong.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMD25Driver::stop()
+{
+   uint8_t speeds[2] = {MD25SpeedStop, MD25SpeedStop};
+   return _write(MD25RegSpeed1, speeds, 2, true);
+} // amMD25Driver::stop()
+
+/**
+ * @brief Read the 32 bit count of one encoder.
+ * @param motor MD25_MOTOR1 or MD25_MOTOR2.
+ * @param ticks Where to put the count. The MD25 sends the most significant byte first.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMD25Driver::readEncoder(uint8_t motor, int32_t* ticks)
+{
+   uint8_t raw[4];
+   uint8_t reg = (motor == MD25_MOTOR1) ? MD25RegEncoder1a : MD25RegEncoder2a;
+   uint8_t status = _read(reg, raw, 4);
+   if(status == I2C_OK)
+   {
+      *ticks = _toTicks(raw);
+   } // if
+   return status;
+} // amMD25Driver::readEncoder()
+
+/**
+ * @brief Read both encoders, battery volts and both motor currents in one transaction.
+ * @details The MD25 auto-increments its register pointer so registers 0x02 to 0x0C come back in a
+ * single 11 byte burst. This replaces five separate address/request round trips and gives values
+ * that were all sampled at the same moment.
+ * @param snapshot Where to put the readings. Left untouched if the read fails.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMD25Driver::readTelemetrySnapshot(md25Telemetry* snapshot)
+{
+   uint8_t raw[MD25_TELEMETRY_LEN];
+   uint8_t status = _read(MD25RegEncoder1a, raw, MD25_TELEMETRY_LEN);
+   if(status == I2C_OK)
+   {
+      snapshot->encoder1 = _toTicks(&raw[MD25RegEncoder1a - MD25RegEncoder1a]);
+      snapshot->encoder2 = _toTicks(&raw[MD25RegEncoder2a - MD25RegEncoder1a]);
+      snapshot->batteryVolts = raw[MD25RegBatteryVolts - MD25RegEncoder1a];
+      snapshot->motorCurrent1 = raw[MD25RegMotorCur1 - MD25RegEncoder1a];
+      snapshot->motorCurrent2 = raw[MD25RegMotorCur2 - MD25RegEncoder1a];
+   } // if
+   return status;
+} // amMD25Driver::readTelemetrySnapshot()
+
+/**
+ * @brief Assemble an encoder count from its four registers.
+ * @param raw Encoder bytes as read from the MD25, most significant byte first.
+ * @return Signed encoder count.
+===================================================================================================*/
+int32_t amMD25Driver::_toTicks(const uint8_t* raw)
+{
+   return (int32_t)(((uint32_t)raw[0] << 24) | ((uint32_t)raw[1] << 16) | ((uint32_t)raw[2] << 8) | raw[3]);
+} // amMD25Driver::_toTicks()
+
+/**
+ * @brief Read registers, telling the shadow the MD25 was heard from.
+ * @param reg First register.
+ * @param dest Where to put the values.
+ * @param len Number of registers.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMD25Driver::_read(uint8_t reg, uint8_t* dest, uint8_t len)
+{
+   uint8_t status = _bus.readRegs(_address, reg, dest, len);
+   if(status == I2C_OK && _shadow != nullptr)
+   {
+      _shadow->touch();
+   } // if
+   return status;
+} // amMD25Driver::_read()
+
+/**
+ * @brief Write a run of registers, leaving off the bus those the shadow says hold their value.
+ * @details Values the MD25 already holds at either end of the run are dropped and the rest goes
+ * out as one auto-increment transaction, so a run with nothing new costs no bus time at all. A
+ * value in the middle is rewritten with its neighbours rather than splitting the write in two.
+ * @param reg First register.
+ * @param values Values, one per register.
+ * @param len Number of registers. No more than MD25_SHADOW_REGS.
+ * @param force Send every value whatever the shadow says.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMD25Driver::_write(uint8_t reg, const uint8_t* values, uint8_t len, bool force)
+{
+   if(_shadow == nullptr)
+   {
+      return _bus.writeRegs(_address, reg, values, len);
+   } // if
+   uint8_t first = 0;
+   uint8_t last = len;
+   while(force == false && first < last && _shadow->isCurrent(reg + first, values[first]) == true)
+   {
+      first++;
+   } // while
+   while(force == false && last > first && _shadow->isCurrent(reg + last - 1, values[last - 1]) == true)
+   {
+      last--;
+   } // while
+   _shadow->countSuppressed(len - (last - first));
+   if(first == last) // Nothing new.
+   {
+      return I2C_OK;
+   } // if
+   uint32_t tickets[MD25_SHADOW_REGS];
+   for(uint8_t i = first; i < last; i++)
+   {
+      tickets[i - first] = _shadow->begin(reg + i);
+   } // for
+   uint8_t status = _bus.writeRegs(_address, reg + first, values + first, last - first);
+   for(uint8_t i = first; i < last; i++)
+   {
+      _shadow->end(reg + i, tickets[i - first], values[i], status == I2C_OK);
+   } // for
+   if(status == I2C_OK)
+   {
+      _shadow->touch();
+   } // if
+   return status;
+} // amMD25Driver::_write()
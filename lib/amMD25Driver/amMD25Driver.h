@@ -0,0 +1,76 @@
+/*************************************************************************************************************************************
+ * @file amMD25Driver.h
+ * @author va3wam
+ * @brief Register level driver for the MD25 dual h-bridge motor controller.
+ * @details Talks to the MD25 through an amI2cBus so that it runs unchanged on the robot and against the simulated MD25 on the host.
+ * Every method is at most a single bus transaction and returns an I2C_ status code rather than blocking or waiting. Drivers given
+ * the same amMD25Shadow leave off the bus any write of a value the MD25 already holds. See amMD25Shadow.h.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Added readTelemetrySnapshot()
+ * 2026-10-17 va3wam Added setAcceleration()
+ * 2026-10-17 va3wam Added the shared register shadow and setModeAndAcceleration()
+ *************************************************************************************************************************************/
+#ifndef amMD25Driver_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amMD25Driver_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <amI2cBus.h> // Register level I2C bus interface.
+#include <amMD25Regs.h> // MD25 register map.
+#include <amMD25Shadow.h> // What the writable registers hold.
+
+#define MD25_TELEMETRY_LEN (MD25RegMotorCur2 - MD25RegEncoder1a + 1) // Registers 0x02 to 0x0C read as one 11 byte burst.
+
+/*! Everything the MD25 measures, read in one bus transaction. */
+struct md25Telemetry
+{
+   int32_t encoder1; ///< Motor1 (left) encoder count.
+   int32_t encoder2; ///< Motor2 (right) encoder count.
+   uint8_t batteryVolts; ///< Supply voltage * 10.
+   uint8_t motorCurrent1; ///< Motor1 current * 10 (amps).
+   uint8_t motorCurrent2; ///< Motor2 current * 10 (amps).
+}; // struct
+
+/*************************************************************************************************************************************
+ * @class Register level access to one MD25 motor controller.
+ *************************************************************************************************************************************/
+class amMD25Driver
+{
+   public:
+      amMD25Driver(amI2cBus &bus, uint8_t address, amMD25Shadow* shadow = nullptr); // Class constructor.
+      uint8_t getAddress(); // I2C address of the controller.
+      uint8_t getFirmwareVersion(uint8_t* version); // Read the software revision register.
+      uint8_t resetEncoders(); // Set both encoder counts to 0.
+      uint8_t setMode(uint8_t mode); // Set the meaning of the speed registers.
+      uint8_t setSpeed1(uint8_t speed); // Write the speed1 register.
+      uint8_t setSpeed2(uint8_t speed); // Write the speed2 register.
+      uint8_t setSpeeds(uint8_t speed1, uint8_t speed2); // Write both speed registers in one transaction.
+      uint8_t setAcceleration(uint8_t rate); // How fast the motors follow the speed registers.
+      uint8_t setModeAndAcceleration(uint8_t mode, uint8_t rate); // Both in one transaction.
+      uint8_t stop(); // Stop both motors in modes 0 and 2.
+      uint8_t readEncoder(uint8_t motor, int32_t* ticks); // Read one 32 bit encoder count.
+      uint8_t readTelemetrySnapshot(md25Telemetry* snapshot); // Read encoders, volts and currents in one burst.
+   private:
+      int32_t _toTicks(const uint8_t* raw); // Assemble an encoder count from its four registers.
+      uint8_t _clampAccel(uint8_t rate); // Keep a rate to the range the MD25 takes.
+      uint8_t _read(uint8_t reg, uint8_t* dest, uint8_t len); // Read registers and tell the shadow.
+      uint8_t _write(uint8_t reg, const uint8_t* values, uint8_t len, bool force); // Write what the shadow says has changed.
+      amI2cBus &_bus; // Bus the controller is attached to.
+      uint8_t _address; // 7 bit I2C address of the controller.
+      amMD25Shadow* _shadow; // Shared register shadow, or nullptr.
+}; // class amMD25Driver
+
+#endif // End of precompiler protected code block
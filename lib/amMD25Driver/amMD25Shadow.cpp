@@ -0,0 +1,184 @@
+/*************************************************************************************************************************************
+ * @file amMD25Shadow.cpp
+ * @author va3wam
+ * @brief What the MD25's writable registers hold, so that writes of a value already there can be left off the bus.
+ * @details See amMD25Shadow.h.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <amMD25Shadow.h> // Header file for linking.
+
+// Layout of each register word.
+static const uint32_t SHADOW_VALUE = 0x000000FF; // Last value written.
+static const uint32_t SHADOW_KNOWN = 0x00000100; // The value is what the MD25 holds.
+static const uint32_t SHADOW_FLIGHT_ONE = 0x00000200; // One write on its way.
+static const uint32_t SHADOW_FLIGHT = 0x0000FE00; // Writes on their way.
+static const uint32_t SHADOW_BEGUN_ONE = 0x00010000; // One write begun.
+
+/**
+ * @brief This is the constructor for this class. Nothing is known until it has been written.
+ * @param clockMs Milliseconds since boot, e.g. a wrapper for millis(). nullptr for a shadow that never goes stale.
+===================================================================================================*/
+amMD25Shadow::amMD25Shadow(uint32_t (*clockMs)())
+   : _clockMs(clockMs), _lastMs(0), _quiet(false), _suppressed(0), _resyncs(0)
+{
+   for(uint8_t i = 0; i < MD25_SHADOW_REGS; i++)
+   {
+      _regs[i].store(0, std::memory_order_relaxed);
+   } // for
+   if(_clockMs != nullptr)
+   {
+      _lastMs.store(_clockMs(), std::memory_order_relaxed);
+   } // if
+} // amMD25Shadow::amMD25Shadow()
+
+/**
+ * @brief Where a register is kept in the shadow.
+ * @param reg MD25 register.
+ * @return 0 to MD25_SHADOW_REGS - 1, or MD25_SHADOW_NONE if the register is not shadowed.
+===================================================================================================*/
+uint8_t amMD25Shadow::slot(uint8_t reg)
+{
+   switch(reg)
+   {
+      case MD25RegSpeed1:
+         return 0;
+      case MD25RegSpeed2:
+         return 1;
+      case MD25RegMotorAccel:
+         return 2;
+      case MD25RegMode:
+         return 3;
+      default:
+         return MD25_SHADOW_NONE;
+   } // switch
+} // amMD25Shadow::slot()
+
+/**
+ * @brief Check whether the shadow has gone stale, and forget everything the first time it has.
+ * @return true if nothing has been heard from the MD25 for MD25_SHADOW_REFRESH_MS.
+===================================================================================================*/
+bool amMD25Shadow::_stale()
+{
+   if(_clockMs == nullptr || _clockMs() - _lastMs.load(std::memory_order_relaxed) < MD25_SHADOW_REFRESH_MS)
+   {
+      return false;
+   } // if
+   if(_quiet.exchange(true, std::memory_order_relaxed) == false) // First to notice.
+   {
+      invalidate();
+      _resyncs.fetch_add(1, std::memory_order_relaxed);
+   } // if
+   return true;
+} // amMD25Shadow::_stale()
+
+/**
+ * @brief Check whether a write can be left off the bus.
+ * @param reg MD25 register.
+ * @param value Value about to be written.
+ * @return true if the MD25 is known to hold value already and nobody is writing the register.
+===================================================================================================*/
+bool amMD25Shadow::isCurrent(uint8_t reg, uint8_t value)
+{
+   uint8_t i = slot(reg);
+   if(i == MD25_SHADOW_NONE || _stale() == true)
+   {
+      return false;
+   } // if
+   uint32_t word = _regs[i].load(std::memory_order_acquire);
+   return (word & (SHADOW_KNOWN | SHADOW_FLIGHT)) == SHADOW_KNOWN && (word & SHADOW_VALUE) == value;
+} // amMD25Shadow::isCurrent()
+
+/**
+ * @brief Note that a write is about to go out. Until it ends the register is not known.
+ * @param reg MD25 register.
+ * @return Ticket to hand to end(). Carries how many writes had begun and whether another was on its way.
+===================================================================================================*/
+uint32_t amMD25Shadow::begin(uint8_t reg)
+{
+   uint8_t i = slot(reg);
+   if(i == MD25_SHADOW_NONE)
+   {
+      return 0;
+   } // if
+   uint32_t word = _regs[i].load(std::memory_order_relaxed);
+   uint32_t next;
+   do
+   {
+      next = ((word & ~SHADOW_KNOWN) + SHADOW_FLIGHT_ONE + SHADOW_BEGUN_ONE);
+   } while(_regs[i].compare_exchange_weak(word, next, std::memory_order_acq_rel) == false);
+   bool alone = (word & SHADOW_FLIGHT) == 0;
+   return ((next / SHADOW_BEGUN_ONE) << 1) | (alone ? 1 : 0);
+} // amMD25Shadow::begin()
+
+/**
+ * @brief Note that a write has finished.
+ * @details The value is recorded only if the write succeeded and no other write of the register
+ * began or was on its way while it was.
+ * @param reg MD25 register.
+ * @param ticket What begin() returned.
+ * @param value Value written.
+ * @param ok The transaction succeeded.
+===================================================================================================*/
+void amMD25Shadow::end(uint8_t reg, uint32_t ticket, uint8_t value, bool ok)
+{
+   uint8_t i = slot(reg);
+   if(i == MD25_SHADOW_NONE)
+   {
+      return;
+   } // if
+   uint32_t word = _regs[i].load(std::memory_order_relaxed);
+   uint32_t next;
+   do
+   {
+      next = word - SHADOW_FLIGHT_ONE;
+      if(ok == true && (ticket & 1) == 1 && (word / SHADOW_BEGUN_ONE) == ((ticket >> 1) & 0xFFFF) && (next & SHADOW_FLIGHT) == 0)
+      {
+         next = (next & ~(SHADOW_KNOWN | SHADOW_VALUE)) | SHADOW_KNOWN | value;
+      } // if
+   } while(_regs[i].compare_exchange_weak(word, next, std::memory_order_acq_rel) == false);
+} // amMD25Shadow::end()
+
+/**
+ * @brief Note a successful transaction with the MD25, read or write.
+ * @details If the shadow had gone stale it is forgotten first, so a read after a long quiet spell
+ * does not make old values trusted again.
+===================================================================================================*/
+void amMD25Shadow::touch()
+{
+   if(_clockMs == nullptr)
+   {
+      return;
+   } // if
+   _stale();
+   _lastMs.store(_clockMs(), std::memory_order_relaxed);
+   _quiet.store(false, std::memory_order_relaxed);
+} // amMD25Shadow::touch()
+
+/**
+ * @brief Forget every register, e.g. after the MD25 may have been reset.
+ * @details Counts as a write begun on each register, so a write on its way does not record its
+ * value when it ends.
+===================================================================================================*/
+void amMD25Shadow::invalidate()
+{
+   for(uint8_t i = 0; i < MD25_SHADOW_REGS; i++)
+   {
+      uint32_t word = _regs[i].load(std::memory_order_relaxed);
+      while(_regs[i].compare_exchange_weak(word, (word & ~SHADOW_KNOWN) + SHADOW_BEGUN_ONE, std::memory_order_acq_rel) == false)
+      {
+      } // while
+   } // for
+} // amMD25Shadow::invalidate()
@@ -0,0 +1,68 @@
+/*************************************************************************************************************************************
+ * @file amMD25Shadow.h
+ * @author va3wam
+ * @brief What the MD25's writable registers hold, so that writes of a value already there can be left off the bus.
+ * @details Keeps speed1, speed2, acceleration and mode. One shadow is shared by every amMD25Driver that talks to the same MD25, so
+ * a write made through one driver is known to the others. A register is only trusted while nothing else is writing it: each one
+ * is a single atomic word holding its value, whether the value is known, how many writes are on their way and how many have been
+ * begun. A write forgets the value as it begins and records it as it ends only if it had the register to itself from start to
+ * finish, so two tasks writing the same register at once leave it unknown rather than wrong. No lock is taken.
+ *
+ * The MD25 stops its motors when it has heard nothing over I2C for 2 seconds. The shadow is told of every transaction and
+ * trusts nothing once MD25_SHADOW_REFRESH_MS has passed without one, so the first write after a quiet spell goes out in full. That
+ * keeps the watchdog fed by a caller that repeats the same speed, and puts the registers back if the watchdog has fired.
+ * Without a clock the shadow never goes stale.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amMD25Shadow_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amMD25Shadow_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <atomic> // std::atomic.
+#include <amMD25Regs.h> // MD25 register map.
+
+#define MD25_SHADOW_REGS 4 // Speed1, speed2, acceleration and mode.
+#define MD25_SHADOW_REFRESH_MS 1000 // Quiet time after which the shadow is not trusted. Half the MD25 watchdog.
+#define MD25_SHADOW_NONE 0xFF // Not a shadowed register.
+
+/*************************************************************************************************************************************
+ * @class Shadow of the MD25's writable registers.
+ *************************************************************************************************************************************/
+class amMD25Shadow
+{
+   public:
+      amMD25Shadow(uint32_t (*clockMs)() = nullptr); // Class constructor.
+      static uint8_t slot(uint8_t reg); // Index of a shadowed register, or MD25_SHADOW_NONE.
+      bool isCurrent(uint8_t reg, uint8_t value); // The MD25 is known to hold value.
+      uint32_t begin(uint8_t reg); // A write of reg is about to go out. Returns a ticket for end().
+      void end(uint8_t reg, uint32_t ticket, uint8_t value, bool ok); // The write is done.
+      void touch(); // A transaction with the MD25 succeeded. Feeds its watchdog.
+      void invalidate(); // Trust nothing until each register has been written again.
+      void countSuppressed(uint8_t regs) { _suppressed.fetch_add(regs, std::memory_order_relaxed); } // amMD25Shadow::countSuppressed()
+      uint32_t getSuppressed() { return _suppressed.load(std::memory_order_relaxed); } // amMD25Shadow::getSuppressed()
+      uint32_t getResyncs() { return _resyncs.load(std::memory_order_relaxed); } // amMD25Shadow::getResyncs()
+   private:
+      bool _stale(); // Too long since the last transaction.
+      std::atomic<uint32_t> _regs[MD25_SHADOW_REGS]; // Value, known, writes in flight and writes begun. See amMD25Shadow.cpp.
+      uint32_t (*_clockMs)(); // Milliseconds, or nullptr for a shadow that never goes stale.
+      std::atomic<uint32_t> _lastMs; // When the last transaction succeeded.
+      std::atomic<bool> _quiet; // Stale when last checked. Counts each resync once.
+      std::atomic<uint32_t> _suppressed; // Register writes left off the bus.
+      std::atomic<uint32_t> _resyncs; // Times the shadow went stale and was written again in full.
+}; // class amMD25Shadow
+
+#endif // End of precompiler protected code block
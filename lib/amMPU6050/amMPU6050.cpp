@@ -0,0 +1,232 @@
+/*************************************************************************************************************************************
+ * @file amMPU6050.cpp
+ * @author va3wam
+ * @brief Driver for the MPU6050 accelerometer and gyro.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <amMPU6050.h> // Header file for linking.
+
+/**
+ * @brief This is the constructor for this class.
+ * @param bus The I2C bus the MPU6050 is attached to.
+ * @param address 7 bit I2C address of the MPU6050.
+===================================================================================================*/
+amMPU6050::amMPU6050(amI2cBus &bus, uint8_t address) : _bus(bus), _address(address)
+{
+
+} // amMPU6050::amMPU6050()
+
+/**
+ * @brief Configure the chip and start filling the FIFO.
+ * @details Checks WHO_AM_I, wakes the chip on the gyro PLL clock, writes the sample rate, filter
+ * and range registers (0x19 to 0x1C) in one transaction, routes every sensor to the FIFO, enables
+ * the data ready interrupt and finally empties and enables the FIFO.
+ * @param dlpf One of the MPU6050_DLPF_ values.
+ * @param sampleRateDiv Sample rate = gyro output rate / (1 + sampleRateDiv).
+ * @param gyroRange One of the MPU6050_GYRO_ values.
+ * @param accelRange One of the MPU6050_ACCEL_ values.
+ * @return I2C_OK, MPU6050_ERR_ID or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMPU6050::begin(uint8_t dlpf, uint8_t sampleRateDiv, uint8_t gyroRange, uint8_t accelRange)
+{
+   uint8_t id;
+   uint8_t status = _bus.readRegs(_address, MPU6050RegWhoAmI, &id, 1);
+   if(status != I2C_OK)
+   {
+      return status;
+   } // if
+   if(id != MPU6050WhoAmI)
+   {
+      return MPU6050_ERR_ID;
+   } // if
+   status = _bus.writeReg(_address, MPU6050RegPwrMgmt1, MPU6050ClockPllGyroX); // Wake up.
+   if(status != I2C_OK)
+   {
+      return status;
+   } // if
+   _gyroRange = gyroRange & 0x03;
+   _accelRange = accelRange & 0x03;
+   uint8_t config[4] = {sampleRateDiv, (uint8_t)(dlpf & 0x07), (uint8_t)(_gyroRange << 3), (uint8_t)(_accelRange << 3)};
+   status = _bus.writeRegs(_address, MPU6050RegSmplrtDiv, config, 4); // SMPLRT_DIV, CONFIG, GYRO_CONFIG, ACCEL_CONFIG.
+   if(status != I2C_OK)
+   {
+      return status;
+   } // if
+   status = _bus.writeReg(_address, MPU6050RegFifoEn, MPU6050FifoSensors);
+   if(status != I2C_OK)
+   {
+      return status;
+   } // if
+   uint8_t interrupts[2] = {0x00, MPU6050IntDataReady}; // INT_PIN_CFG active high 50us pulse, INT_ENABLE data ready.
+   status = _bus.writeRegs(_address, MPU6050RegIntPinCfg, interrupts, 2);
+   if(status != I2C_OK)
+   {
+      return status;
+   } // if
+   _overflows = 0;
+   return resetFifo();
+} // amMPU6050::begin()
+
+/**
+ * @brief Throw away everything in the FIFO and start filling it again.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMPU6050::resetFifo()
+{
+   uint8_t status = _bus.writeReg(_address, MPU6050RegUserCtrl, MPU6050UserFifoReset); // Stop and empty.
+   if(status != I2C_OK)
+   {
+      return status;
+   } // if
+   return _bus.writeReg(_address, MPU6050RegUserCtrl, MPU6050UserFifoEnable); // Start again.
+} // amMPU6050::resetFifo()
+
+/**
+ * @brief Read how many bytes are waiting in the FIFO.
+ * @param count Where to put the byte count.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMPU6050::readFifoCount(uint16_t* count)
+{
+   uint8_t raw[2];
+   uint8_t status = _bus.readRegs(_address, MPU6050RegFifoCountH, raw, 2);
+   if(status == I2C_OK)
+   {
+      *count = ((uint16_t)raw[0] << 8) | raw[1];
+   } // if
+   return status;
+} // amMPU6050::readFifoCount()
+
+/**
+ * @brief Collect every whole sample waiting in the FIFO, oldest first.
+ * @details One transaction reads the FIFO count, then the samples come out MPU6050_BURST_SAMPLES
+ * at a time. A partly written sample is left for next time. A full FIFO means samples were lost
+ * and the byte stream may no longer line up with sample boundaries, so the FIFO is reset.
+ * @param samples Where to put the samples.
+ * @param max Room in samples. Anything beyond this stays in the FIFO.
+ * @param count Where to put the number of samples collected.
+ * @return I2C_OK, MPU6050_ERR_OVERFLOW or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMPU6050::drainFifo(mpu6050Sample* samples, uint16_t max, uint16_t* count)
+{
+   *count = 0;
+   uint16_t bytes;
+   uint8_t status = readFifoCount(&bytes);
+   if(status != I2C_OK)
+   {
+      return status;
+   } // if
+   if(bytes >= MPU6050_FIFO_SIZE) // Overflowed. Data no longer trustworthy.
+   {
+      _overflows++;
+      status = resetFifo();
+      return (status == I2C_OK) ? MPU6050_ERR_OVERFLOW : status;
+   } // if
+   uint16_t waiting = bytes / MPU6050_SAMPLE_LEN;
+   if(waiting > max)
+   {
+      waiting = max;
+   } // if
+   uint8_t raw[MPU6050_BURST_SAMPLES * MPU6050_SAMPLE_LEN];
+   while(*count < waiting)
+   {
+      uint16_t burst = waiting - *count;
+      if(burst > MPU6050_BURST_SAMPLES)
+      {
+         burst = MPU6050_BURST_SAMPLES;
+      } // if
+      status = _bus.readRegs(_address, MPU6050RegFifoRW, raw, burst * MPU6050_SAMPLE_LEN);
+      if(status != I2C_OK)
+      {
+         return status; // Samples collected so far are still good.
+      } // if
+      for(uint16_t i = 0; i < burst; i++)
+      {
+         _unpack(&raw[i * MPU6050_SAMPLE_LEN], &samples[*count]);
+         (*count)++;
+      } // for
+   } // while
+   return I2C_OK;
+} // amMPU6050::drainFifo()
+
+/**
+ * @brief Read the latest sample straight from the sensor registers in one 14 byte burst.
+ * @param sample Where to put the sample.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMPU6050::readSample(mpu6050Sample* sample)
+{
+   uint8_t raw[MPU6050_SAMPLE_LEN];
+   uint8_t status = _bus.readRegs(_address, MPU6050RegAccelXoutH, raw, MPU6050_SAMPLE_LEN);
+   if(status == I2C_OK)
+   {
+      _unpack(raw, sample);
+   } // if
+   return status;
+} // amMPU6050::readSample()
+
+/**
+ * @brief Read INT_STATUS. Reading it clears the interrupt flags.
+ * @param status Where to put the flags.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t amMPU6050::readInterruptStatus(uint8_t* status)
+{
+   return _bus.readRegs(_address, MPU6050RegIntStatus, status, 1);
+} // amMPU6050::readInterruptStatus()
+
+/**
+ * @brief Report how many times the FIFO has overflowed.
+ * @return Overflows since begin().
+===================================================================================================*/
+uint32_t amMPU6050::getOverflows()
+{
+   return _overflows;
+} // amMPU6050::getOverflows()
+
+/**
+ * @brief Report the gyro scale for the selected range.
+ * @return Raw counts per degree/second.
+===================================================================================================*/
+float amMPU6050::getGyroLsbPerDps()
+{
+   return 131.0f / (float)(1 << _gyroRange);
+} // amMPU6050::getGyroLsbPerDps()
+
+/**
+ * @brief Report the accelerometer scale for the selected range.
+ * @return Raw counts per g.
+===================================================================================================*/
+float amMPU6050::getAccelLsbPerG()
+{
+   return 16384.0f / (float)(1 << _accelRange);
+} // amMPU6050::getAccelLsbPerG()
+
+/**
+ * @brief Convert one sample from the chip's big-endian byte order.
+ * @param raw 14 bytes as read from the chip.
+ * @param sample Where to put the values.
+===================================================================================================*/
+void amMPU6050::_unpack(const uint8_t* raw, mpu6050Sample* sample)
+{
+   sample->accelX = (int16_t)((raw[0] << 8) | raw[1]);
+   sample->accelY = (int16_t)((raw[2] << 8) | raw[3]);
+   sample->accelZ = (int16_t)((raw[4] << 8) | raw[5]);
+   sample->temp = (int16_t)((raw[6] << 8) | raw[7]);
+   sample->gyroX = (int16_t)((raw[8] << 8) | raw[9]);
+   sample->gyroY = (int16_t)((raw[10] << 8) | raw[11]);
+   sample->gyroZ = (int16_t)((raw[12] << 8) | raw[13]);
+} // amMPU6050::_unpack()
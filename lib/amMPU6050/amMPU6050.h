@@ -0,0 +1,78 @@
+/*************************************************************************************************************************************
+ * @file amMPU6050.h
+ * @author va3wam
+ * @brief Driver for the MPU6050 accelerometer and gyro.
+ * @details The chip is set up to write every sample (accel, temperature and gyro, 14 bytes) to its on-chip FIFO at the output
+ * rate picked by the digital low pass filter and sample rate divider, and to raise its INT pin each time a sample is ready. The
+ * firmware uses that interrupt to know there is something to collect and then calls drainFifo(), which takes everything in the
+ * FIFO with one FIFO count read followed by as few burst reads as the bus buffer allows. No samples are dropped as long as the
+ * FIFO is drained before it fills (about 70ms at 1kHz). Talks to the chip through an amI2cBus so the register protocol can be
+ * checked on the host.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amMPU6050_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amMPU6050_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <amI2cBus.h> // Register level I2C bus interface.
+#include <amMPU6050Regs.h> // MPU6050 register map.
+
+#define MPU6050_ADDRESS 0x68 // Default 7 bit I2C address (AD0 low).
+#define MPU6050_BURST_SAMPLES 8 // Samples per FIFO burst. 112 bytes fits the 128 byte ESP32 Wire buffer.
+
+// Driver status codes. Follow on from the I2C_ codes.
+#define MPU6050_ERR_ID 16 // WHO_AM_I did not read back as an MPU6050.
+#define MPU6050_ERR_OVERFLOW 17 // FIFO filled before it was drained. Samples lost and the FIFO was reset.
+
+/*! One raw reading of every sensor, in the order the chip stores them. */
+struct mpu6050Sample
+{
+   int16_t accelX; ///< Raw accelerometer X.
+   int16_t accelY; ///< Raw accelerometer Y.
+   int16_t accelZ; ///< Raw accelerometer Z.
+   int16_t temp; ///< Raw die temperature. Celsius = temp / 340 + 36.53.
+   int16_t gyroX; ///< Raw gyro X.
+   int16_t gyroY; ///< Raw gyro Y.
+   int16_t gyroZ; ///< Raw gyro Z.
+}; // struct
+
+/*************************************************************************************************************************************
+ * @class Set up the MPU6050 FIFO and collect samples from it in bursts.
+ *************************************************************************************************************************************/
+class amMPU6050
+{
+   public:
+      amMPU6050(amI2cBus &bus, uint8_t address = MPU6050_ADDRESS); // Class constructor.
+      uint8_t begin(uint8_t dlpf, uint8_t sampleRateDiv, uint8_t gyroRange, uint8_t accelRange); // Configure and start the FIFO.
+      uint8_t resetFifo(); // Empty the FIFO.
+      uint8_t readFifoCount(uint16_t* count); // Bytes waiting in the FIFO.
+      uint8_t drainFifo(mpu6050Sample* samples, uint16_t max, uint16_t* count); // Collect whole samples from the FIFO.
+      uint8_t readSample(mpu6050Sample* sample); // Read the sensor registers directly.
+      uint8_t readInterruptStatus(uint8_t* status); // Read and clear INT_STATUS.
+      uint32_t getOverflows(); // FIFO overflows since begin().
+      float getGyroLsbPerDps(); // Raw gyro counts per degree/second.
+      float getAccelLsbPerG(); // Raw accelerometer counts per g.
+   private:
+      void _unpack(const uint8_t* raw, mpu6050Sample* sample); // Convert 14 big-endian bytes to a sample.
+      amI2cBus &_bus; // Bus the chip is attached to.
+      uint8_t _address; // 7 bit I2C address of the chip.
+      uint8_t _gyroRange = MPU6050_GYRO_250DPS; // Selected gyro range.
+      uint8_t _accelRange = MPU6050_ACCEL_2G; // Selected accelerometer range.
+      uint32_t _overflows = 0; // FIFO overflows.
+}; // class amMPU6050
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,73 @@
+/*************************************************************************************************************************************
+ * @file amMPU6050Regs.h
+ * @author va3wam
+ * @brief MPU6050 accelerometer and gyro register map.
+ * @details Only the registers used by amMPU6050 and the simulated MPU6050. Shared by both so they agree on the protocol.
+ * @note See the MPU-6000/MPU-6050 Register Map and Descriptions, revision 4.2.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amMPU6050Regs_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amMPU6050Regs_h // Precompiler macro used for precompiler check.
+
+// Define MPU6050 registers
+#define MPU6050RegSmplrtDiv 0x19 // Sample rate = gyro output rate / (1 + SMPLRT_DIV)
+#define MPU6050RegConfig 0x1A // Digital low pass filter (DLPF_CFG in bits 2:0)
+#define MPU6050RegGyroConfig 0x1B // Gyro full scale range (FS_SEL in bits 4:3)
+#define MPU6050RegAccelConfig 0x1C // Accelerometer full scale range (AFS_SEL in bits 4:3)
+#define MPU6050RegFifoEn 0x23 // Which sensor registers are written to the FIFO
+#define MPU6050RegIntPinCfg 0x37 // INT pin level, drive and latch settings
+#define MPU6050RegIntEnable 0x38 // Interrupt sources
+#define MPU6050RegIntStatus 0x3A // Interrupt status. Cleared by reading
+#define MPU6050RegAccelXoutH 0x3B // First of 14 sensor data registers (accel xyz, temp, gyro xyz)
+#define MPU6050RegUserCtrl 0x6A // FIFO enable and reset
+#define MPU6050RegPwrMgmt1 0x6B // Sleep, reset and clock source
+#define MPU6050RegFifoCountH 0x72 // FIFO byte count, high byte then low byte
+#define MPU6050RegFifoRW 0x74 // FIFO data. Reading it repeatedly pops the FIFO
+#define MPU6050RegWhoAmI 0x75 // Device identity
+
+// Register values
+#define MPU6050WhoAmI 0x68 // Expected contents of WHO_AM_I.
+#define MPU6050ClockPllGyroX 0x01 // PWR_MGMT_1 value. Awake, clocked from the X gyro PLL.
+#define MPU6050FifoSensors 0xF8 // FIFO_EN value. Temp, gyro x,y,z and accel x,y,z. 14 bytes per sample.
+#define MPU6050IntDataReady 0x01 // INT_ENABLE / INT_STATUS data ready bit.
+#define MPU6050IntFifoOverflow 0x10 // INT_ENABLE / INT_STATUS FIFO overflow bit.
+#define MPU6050UserFifoEnable 0x40 // USER_CTRL bit that enables the FIFO.
+#define MPU6050UserFifoReset 0x04 // USER_CTRL bit that empties the FIFO. Clears itself.
+
+// Digital low pass filter settings (accel/gyro bandwidth). Gyro output rate is 1kHz for all but MPU6050_DLPF_260HZ (8kHz).
+#define MPU6050_DLPF_260HZ 0 // No filtering.
+#define MPU6050_DLPF_184HZ 1 // 184/188Hz.
+#define MPU6050_DLPF_94HZ 2 // 94/98Hz.
+#define MPU6050_DLPF_44HZ 3 // 44/42Hz.
+#define MPU6050_DLPF_21HZ 4 // 21/20Hz.
+#define MPU6050_DLPF_10HZ 5 // 10Hz.
+#define MPU6050_DLPF_5HZ 6 // 5Hz.
+
+// Full scale ranges.
+#define MPU6050_GYRO_250DPS 0 // +/-250 degrees/second. 131 LSB per degree/second.
+#define MPU6050_GYRO_500DPS 1 // +/-500 degrees/second. 65.5 LSB per degree/second.
+#define MPU6050_GYRO_1000DPS 2 // +/-1000 degrees/second. 32.8 LSB per degree/second.
+#define MPU6050_GYRO_2000DPS 3 // +/-2000 degrees/second. 16.4 LSB per degree/second.
+#define MPU6050_ACCEL_2G 0 // +/-2g. 16384 LSB per g.
+#define MPU6050_ACCEL_4G 1 // +/-4g. 8192 LSB per g.
+#define MPU6050_ACCEL_8G 2 // +/-8g. 4096 LSB per g.
+#define MPU6050_ACCEL_16G 3 // +/-16g. 2048 LSB per g.
+
+#define MPU6050_SAMPLE_LEN 14 // Bytes per sample in the sensor registers and the FIFO.
+#define MPU6050_FIFO_SIZE 1024 // Bytes the FIFO holds.
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,251 @@
+/*************************************************************************************************************************************
+ * @file amMotion.cpp
+ * @author va3wam
+ * @brief Non-blocking motion engine for the MD25 drive train.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Final encoder counts read in one telemetry snapshot
+ *************************************************************************************************************************************/
+#include <amMotion.h> // Header file for linking.
+
+/**
+ * @brief This is the constructor for this class.
+ * @param md25 Motor controller that drives the wheels.
+===================================================================================================*/
+amMotion::amMotion(amMD25Driver &md25) : _md25(md25)
+{
+   _goal = {MOTION_BOTH, MD25SpeedStop, 0, 0};
+   _result = {MOTION_IDLE, 0, 0, 0, I2C_OK};
+} // amMotion::amMotion()
+
+/**
+ * @brief Set the function to call when a goal finishes.
+ * @param callback Called once per goal with the outcome. nullptr to disable.
+===================================================================================================*/
+void amMotion::onComplete(motionCallback callback)
+{
+   _callback = callback;
+} // amMotion::onComplete()
+
+/**
+ * @brief Set the minimum time between encoder reads while a goal is running.
+ * @param ms Poll interval in milliseconds.
+===================================================================================================*/
+void amMotion::setPollInterval(uint32_t ms)
+{
+   _pollIntervalMs = ms;
+} // amMotion::setPollInterval()
+
+/**
+ * @brief Set the time allowed for the motors to spin down before the final encoder reading.
+ * @param ms Settle time in milliseconds.
+===================================================================================================*/
+void amMotion::setSettleTime(uint32_t ms)
+{
+   _settleMs = ms;
+} // amMotion::setSettleTime()
+
+/**
+ * @brief Begin a new goal.
+ * @details Resets the encoders, selects the MD25 mode that suits the goal and writes both speed
+ * registers in one transaction so that the motor not in the goal is held stopped.
+ * @param goal Which motors, how fast and how far.
+ * @param now Current time in milliseconds (millis() on the robot).
+ * @return true if the goal was accepted, false if a goal is already running or the MD25 did not
+ * answer. getResult() holds the bus status in the latter case.
+===================================================================================================*/
+bool amMotion::start(const motionGoal &goal, uint32_t now)
+{
+   if(isBusy()) // Only one goal at a time.
+   {
+      return false;
+   } // if
+   _goal = goal;
+   _result = {MOTION_RUNNING, 0, 0, 0, I2C_OK};
+   _encoder = (goal.motors == MOTION_RIGHT) ? MD25_MOTOR2 : MD25_MOTOR1; // Left encoder decides for both motors.
+   _startTime = now;
+   _lastPoll = now;
+   uint8_t status = _md25.resetEncoders(); // Measure distance from here.
+   if(status == I2C_OK)
+   {
+      status = _md25.setMode((goal.motors == MOTION_BOTH) ? MD25ModeTurnUnsigned : MD25ModeUnsigned);
+   } // if
+   if(status == I2C_OK)
+   {
+      switch(goal.motors)
+      {
+         case MOTION_LEFT: // Motor1 at speed, motor2 held stopped.
+            status = _md25.setSpeeds(goal.speed, MD25SpeedStop);
+            break;
+         case MOTION_RIGHT: // Motor1 held stopped, motor2 at speed.
+            status = _md25.setSpeeds(MD25SpeedStop, goal.speed);
+            break;
+         default: // Both motors at speed with no turn.
+            status = _md25.setSpeeds(goal.speed, MD25SpeedStop);
+            break;
+      } // switch
+   } // if
+   if(status != I2C_OK) // Could not get the goal to the MD25.
+   {
+      _md25.stop(); // Best effort in case a speed made it through.
+      _finish(MOTION_FAULT, status, now);
+      return false;
+   } // if
+   _state = MOTION_RUNNING;
+   if(goal.distance <= 0) // Nothing to travel.
+   {
+      _stop(MOTION_DONE, now);
+   } // if
+   return true;
+} // amMotion::start()
+
+/**
+ * @brief Stop the current goal early.
+ * @param now Current time in milliseconds.
+===================================================================================================*/
+void amMotion::abort(uint32_t now)
+{
+   if(_state == MOTION_RUNNING)
+   {
+      _stop(MOTION_ABORTED, now);
+   } // if
+} // amMotion::abort()
+
+/**
+ * @brief Advance the current goal by one step.
+ * @details Call as often as you like. The encoder is only read once every poll interval so calling
+ * this from a fast loop() does not flood the bus.
+ * @param now Current time in milliseconds.
+ * @return The state after this step.
+===================================================================================================*/
+motionState amMotion::tick(uint32_t now)
+{
+   uint8_t status;
+   switch(_state)
+   {
+      case MOTION_RUNNING:
+      {
+         if(now - _lastPoll < _pollIntervalMs) // Not time for another reading yet.
+         {
+            break;
+         } // if
+         _lastPoll = now;
+         int32_t ticks;
+         status = _md25.readEncoder(_encoder, &ticks);
+         if(status != I2C_OK) // Lost contact with the MD25.
+         {
+            _md25.stop(); // Best effort.
+            _finish(MOTION_FAULT, status, now);
+            break;
+         } // if
+         if(ticks < 0) // Reverse goals count down.
+         {
+            ticks = -ticks;
+         } // if
+         if(ticks >= _goal.distance)
+         {
+            _stop(MOTION_DONE, now);
+         } // if
+         else if(_goal.timeoutMs != 0 && now - _startTime >= _goal.timeoutMs)
+         {
+            _stop(MOTION_TIMEOUT, now);
+         } // else if
+         break;
+      } // case
+      case MOTION_SETTLING:
+      {
+         if(now - _stopTime < _settleMs) // Motors still spinning down.
+         {
+            break;
+         } // if
+         md25Telemetry snapshot;
+         status = _md25.readTelemetrySnapshot(&snapshot); // Both encoders from the same moment.
+         if(status == I2C_OK)
+         {
+            _result.leftTicks = snapshot.encoder1;
+            _result.rightTicks = snapshot.encoder2;
+         } // if
+         _finish((status == I2C_OK) ? _finalState : MOTION_FAULT, status, now);
+         break;
+      } // case
+      default: // Idle or finished. Nothing to do.
+         break;
+   } // switch
+   return _state;
+} // amMotion::tick()
+
+/**
+ * @brief Report if a goal is in progress.
+ * @return true while running or settling.
+===================================================================================================*/
+bool amMotion::isBusy()
+{
+   return (_state == MOTION_RUNNING || _state == MOTION_SETTLING);
+} // amMotion::isBusy()
+
+/**
+ * @brief Report the current state.
+ * @return Current motionState.
+===================================================================================================*/
+motionState amMotion::getState()
+{
+   return _state;
+} // amMotion::getState()
+
+/**
+ * @brief Report the outcome of the last goal.
+ * @return Result of the last goal. Only complete once isBusy() is false.
+===================================================================================================*/
+const motionResult& amMotion::getResult()
+{
+   return _result;
+} // amMotion::getResult()
+
+/**
+ * @brief Stop the motors and wait for them to settle before reporting.
+ * @param finalState State to report once settled.
+ * @param now Current time in milliseconds.
+===================================================================================================*/
+void amMotion::_stop(motionState finalState, uint32_t now)
+{
+   uint8_t status = _md25.stop();
+   if(status != I2C_OK)
+   {
+      _finish(MOTION_FAULT, status, now);
+      return;
+   } // if
+   _finalState = finalState;
+   _stopTime = now;
+   _state = MOTION_SETTLING;
+   _result.state = MOTION_SETTLING;
+} // amMotion::_stop()
+
+/**
+ * @brief Record the outcome of the goal and call the completion callback.
+ * @param finalState How the goal ended.
+ * @param busStatus I2C_ status code of the last transaction.
+ * @param now Current time in milliseconds.
+===================================================================================================*/
+void amMotion::_finish(motionState finalState, uint8_t busStatus, uint32_t now)
+{
+   _state = finalState;
+   _result.state = finalState;
+   _result.busStatus = busStatus;
+   _result.elapsedMs = now - _startTime;
+   if(_callback != nullptr)
+   {
+      _callback(_result);
+   } // if
+} // amMotion::_finish()
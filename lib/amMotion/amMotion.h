@@ -0,0 +1,101 @@
+/*************************************************************************************************************************************
+ * @file amMotion.h
+ * @author va3wam
+ * @brief Non-blocking motion engine for the MD25 drive train.
+ * @details A move is described by a motionGoal (which motors, speed and encoder distance). start() sends the goal to the MD25 and
+ * returns straight away. tick() is then called from loop() or a timer task; each call moves the goal on by one step using a couple
+ * of short bus transactions at most, and never waits. When the goal finishes the engine stops the motors, waits for them to settle,
+ * records the final encoder counts and reports the outcome through getState() and the optional completion callback.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amMotion_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amMotion_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <amMD25Driver.h> // MD25 register level driver.
+
+#define MOTION_LEFT 0 // Move the left motor only.
+#define MOTION_RIGHT 1 // Move the right motor only.
+#define MOTION_BOTH 2 // Move both motors together.
+
+/*! States a motion goal moves through. */
+enum motionState
+{
+   MOTION_IDLE, ///< No goal has been started.
+   MOTION_RUNNING, ///< Motors driven, waiting for the encoder to reach the distance.
+   MOTION_SETTLING, ///< Motors told to stop, waiting for them to spin down.
+   MOTION_DONE, ///< Goal distance reached.
+   MOTION_TIMEOUT, ///< Goal distance not reached in the allowed time. Motors stopped.
+   MOTION_ABORTED, ///< Goal stopped early by abort(). Motors stopped.
+   MOTION_FAULT ///< Bus error talking to the MD25. Motors stopped if possible.
+}; // enum
+
+/*! A distance/speed goal for the drive train. */
+struct motionGoal
+{
+   uint8_t motors; ///< MOTION_LEFT, MOTION_RIGHT or MOTION_BOTH.
+   uint8_t speed; ///< 0 (full reverse), 128 (stop), 255 (full forward).
+   int32_t distance; ///< Encoder ticks to travel. Direction comes from speed.
+   uint32_t timeoutMs; ///< Give up after this long. 0 means never.
+}; // struct
+
+/*! Outcome of the last goal. */
+struct motionResult
+{
+   motionState state; ///< Final (or current) state of the goal.
+   int32_t leftTicks; ///< Left encoder count once the motors settled.
+   int32_t rightTicks; ///< Right encoder count once the motors settled.
+   uint32_t elapsedMs; ///< Time from start() to completion.
+   uint8_t busStatus; ///< I2C_ status code of the failing transaction for MOTION_FAULT.
+}; // struct
+
+typedef void (*motionCallback)(const motionResult &result); // Completion callback.
+
+/*************************************************************************************************************************************
+ * @class Run distance/speed goals on the MD25 one step at a time.
+ *************************************************************************************************************************************/
+class amMotion
+{
+   public:
+      amMotion(amMD25Driver &md25); // Class constructor.
+      void onComplete(motionCallback callback); // Function to call when a goal finishes.
+      void setPollInterval(uint32_t ms); // Minimum time between encoder reads.
+      void setSettleTime(uint32_t ms); // Time allowed for the motors to spin down.
+      bool start(const motionGoal &goal, uint32_t now); // Begin a new goal.
+      void abort(uint32_t now); // Stop the current goal early.
+      motionState tick(uint32_t now); // Advance the current goal by one step.
+      bool isBusy(); // True while a goal is running or settling.
+      motionState getState(); // Current state.
+      const motionResult& getResult(); // Outcome of the last goal.
+   private:
+      void _stop(motionState finalState, uint32_t now); // Stop motors and start settling.
+      void _finish(motionState finalState, uint8_t busStatus, uint32_t now); // Record outcome and call back.
+      amMD25Driver &_md25; // Motor controller.
+      motionCallback _callback = nullptr; // Completion callback.
+      motionGoal _goal; // Goal being run.
+      motionResult _result; // Outcome of the goal.
+      motionState _state = MOTION_IDLE; // Where the goal is at.
+      motionState _finalState = MOTION_IDLE; // State to report once the motors settle.
+      uint8_t _encoder = MD25_MOTOR1; // Encoder watched to decide when the distance is reached.
+      uint32_t _pollIntervalMs = 10; // Minimum time between encoder reads.
+      uint32_t _settleMs = 100; // Time allowed for the motors to spin down.
+      uint32_t _startTime = 0; // When the goal started.
+      uint32_t _stopTime = 0; // When the motors were told to stop.
+      uint32_t _lastPoll = 0; // When the encoder was last read.
+}; // class amMotion
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,146 @@
+/*************************************************************************************************************************************
+ * @file amOdometry.cpp
+ * @author va3wam
+ * @brief Wheel speeds and differential drive pose from the MD25 encoder counts.
+ * @details See amOdometry.h.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <math.h> // sinf(), cosf().
+#include <amOdometry.h> // Header file for linking.
+
+static const float ODOM_PI = 3.14159265f; // pi
+static const float ODOM_TWO_PI = 6.28318531f; // 2 pi
+
+/**
+ * @brief This is the constructor for this class.
+ * @param geometry Size of the drive train.
+===================================================================================================*/
+amOdometry::amOdometry(odometryGeometry geometry)
+{
+   setGeometry(geometry);
+   reset({0.0f, 0.0f, 0.0f});
+} // amOdometry::amOdometry()
+
+/**
+ * @brief Change the size of the drive train. Takes effect from the next update().
+ * @param geometry Size of the drive train.
+===================================================================================================*/
+void amOdometry::setGeometry(odometryGeometry geometry)
+{
+   _geometry = geometry;
+   _metresPerTick = ODOM_PI * geometry.wheelDiameter / geometry.ticksPerRev;
+} // amOdometry::setGeometry()
+
+/**
+ * @brief Start again from a known pose with both wheels stopped.
+ * @details The next update() only records the counts it is given, so the counts can be anything.
+ * @param pose Where the robot is now.
+===================================================================================================*/
+void amOdometry::reset(odometryPose pose)
+{
+   _pose = pose;
+   _distance = 0.0f;
+   _turned = 0.0f;
+   _seeded = false;
+   _left = {0, 0, 0, 0.0f};
+   _right = {0, 0, 0, 0.0f};
+} // amOdometry::reset()
+
+/**
+ * @brief Take a new count for one wheel and work out its speed.
+ * @param w The wheel.
+ * @param count Its encoder count.
+ * @param nowUs micros() when the count was read.
+ * @return Ticks moved since the last update.
+===================================================================================================*/
+int32_t amOdometry::_step(wheel &w, int32_t count, uint32_t nowUs)
+{
+   int32_t delta = (int32_t)((uint32_t)count - (uint32_t)w.count); // Right across the wrap.
+   w.count = count;
+   uint32_t sinceEdgeUs = nowUs - w.edgeUs; // Wraps with micros().
+   if(delta != 0) // Moved. Speed over the time since the count last changed.
+   {
+      int32_t ticks = (int32_t)((uint32_t)count - (uint32_t)w.edgeCount);
+      uint32_t spanUs = sinceEdgeUs;
+      if(spanUs >= ODOM_STOP_US) // Was standing still. Only this read interval counts.
+      {
+         ticks = delta;
+         spanUs = nowUs - _lastUs;
+      } // if
+      w.speed = (spanUs == 0) ? w.speed : ticks * _metresPerTick * 1000000.0f / spanUs;
+      w.edgeCount = count;
+      w.edgeUs = nowUs;
+      return delta;
+   } // if
+   if(sinceEdgeUs >= ODOM_STOP_US) // No tick for too long.
+   {
+      w.speed = 0.0f;
+      return 0;
+   } // if
+   float most = _metresPerTick * 1000000.0f / sinceEdgeUs; // A tick would have come by now at any faster speed.
+   if(w.speed > most)
+   {
+      w.speed = most;
+   } // if
+   else if(w.speed < -most)
+   {
+      w.speed = -most;
+   } // else if
+   return 0;
+} // amOdometry::_step()
+
+/**
+ * @brief Move the pose on by the encoder counts read since the last call.
+ * @param left Left encoder count (MD25 encoder 1), forwards positive.
+ * @param right Right encoder count (MD25 encoder 2), forwards positive.
+ * @param nowUs micros() when the counts were read.
+===================================================================================================*/
+void amOdometry::update(int32_t left, int32_t right, uint32_t nowUs)
+{
+   if(_seeded == false) // First counts. Nothing to measure from yet.
+   {
+      _left = {left, left, nowUs - ODOM_STOP_US, 0.0f}; // Taken as standing still.
+      _right = {right, right, nowUs - ODOM_STOP_US, 0.0f};
+      _lastUs = nowUs;
+      _seeded = true;
+      return;
+   } // if
+   int32_t dl = _step(_left, left, nowUs);
+   int32_t dr = _step(_right, right, nowUs);
+   _lastUs = nowUs;
+   if(dl == 0 && dr == 0) // Nothing to integrate.
+   {
+      return;
+   } // if
+   float sl = dl * _metresPerTick; // Metres each wheel moved.
+   float sr = dr * _metresPerTick;
+   float ds = (sl + sr) * 0.5f; // Centre of the robot.
+   float dh = (sr - sl) / _geometry.trackWidth; // Anticlockwise positive.
+   float mid = _pose.heading + dh * 0.5f; // Heading half way through the step.
+   _pose.x += ds * cosf(mid);
+   _pose.y += ds * sinf(mid);
+   _pose.heading += dh;
+   while(_pose.heading > ODOM_PI) // A long gap between reads can be more than a turn.
+   {
+      _pose.heading -= ODOM_TWO_PI;
+   } // while
+   while(_pose.heading <= -ODOM_PI)
+   {
+      _pose.heading += ODOM_TWO_PI;
+   } // while
+   _distance += ds;
+   _turned += dh;
+} // amOdometry::update()
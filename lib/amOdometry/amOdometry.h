@@ -0,0 +1,94 @@
+/*************************************************************************************************************************************
+ * @file amOdometry.h
+ * @author va3wam
+ * @brief Wheel speeds and differential drive pose from the MD25 encoder counts.
+ * @details Call update() with both encoder counts each time they are read. Tick deltas are taken with unsigned subtraction, so
+ * counts that wrap past INT32_MAX give the right step. Each wheel's speed is the ticks it has moved since its count last changed,
+ * over the time since then. At speed the count changes every read and this is the plain ticks over the read interval, good to a tick per read; at low
+ * speed, when a tick comes only every few reads, it spans the reads between ticks instead of showing bursts of one tick and zeros.
+ * While a wheel's count stands still its speed is held to no more than one tick over the time since the last tick, so it falls
+ * away smoothly, and it is 0 once ODOM_STOP_US has passed with no tick. The pose is integrated at the midpoint heading of each step.
+ * Positions are metres from where the pose was last reset, heading is radians, anticlockwise positive, kept to -pi to pi. The
+ * heading turned and the distance driven are also kept unwrapped, for moves that are measured in turns and metres.
+ *
+ * One update() is two subtractions, a handful of float multiplies and a sinf() and cosf() when the robot has moved. Only one task
+ * may call update() and reset(). Readers on other tasks can see a pose that is one update out of step between its fields.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amOdometry_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amOdometry_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+
+#define ODOM_STOP_US 500000 // A wheel with no tick for this long has stopped.
+
+/*! Size of the drive train. */
+struct odometryGeometry
+{
+   float wheelDiameter; ///< Metres.
+   float trackWidth; ///< Metres between the centres of the two wheels.
+   float ticksPerRev; ///< Encoder ticks per turn of a wheel.
+}; // struct
+
+/*! Where the robot is. */
+struct odometryPose
+{
+   float x; ///< Metres forward of where the pose was reset.
+   float y; ///< Metres to the left of where the pose was reset.
+   float heading; ///< Radians anticlockwise from the heading at reset, -pi to pi.
+}; // struct
+
+/*************************************************************************************************************************************
+ * @class Encoder odometry for a two wheeled differential drive.
+ *************************************************************************************************************************************/
+class amOdometry
+{
+   public:
+      amOdometry(odometryGeometry geometry); // Class constructor.
+      void setGeometry(odometryGeometry geometry); // Change the wheel size or spacing.
+      void reset(odometryPose pose); // Start again from a known pose. The next update() only takes the counts.
+      void update(int32_t left, int32_t right, uint32_t nowUs); // Both encoder counts, read at the same moment.
+      odometryPose getPose() { return _pose; } // amOdometry::getPose()
+      float getLeftSpeed() { return _left.speed; } // amOdometry::getLeftSpeed()
+      float getRightSpeed() { return _right.speed; } // amOdometry::getRightSpeed()
+      float getSpeed() { return (_left.speed + _right.speed) * 0.5f; } // amOdometry::getSpeed()
+      float getTurnRate() { return (_right.speed - _left.speed) / _geometry.trackWidth; } // amOdometry::getTurnRate()
+      float getDistance() { return _distance; } // amOdometry::getDistance()
+      float getTurned() { return _turned; } // amOdometry::getTurned()
+      float getMetresPerTick() { return _metresPerTick; } // amOdometry::getMetresPerTick()
+   private:
+      /*! Count and speed of one wheel. */
+      struct wheel
+      {
+         int32_t count; ///< Last count.
+         int32_t edgeCount; ///< Count when it last changed.
+         uint32_t edgeUs; ///< When it last changed.
+         float speed; ///< Metres/second.
+      }; // struct
+      int32_t _step(wheel &w, int32_t count, uint32_t nowUs); // Ticks moved since the last update, and the wheel's speed.
+      odometryGeometry _geometry; // Drive train size.
+      float _metresPerTick; // Wheel travel per tick.
+      bool _seeded = false; // An update() has given the starting counts.
+      uint32_t _lastUs = 0; // When update() was last called.
+      wheel _left; // Left wheel, MD25 encoder 1.
+      wheel _right; // Right wheel, MD25 encoder 2.
+      odometryPose _pose; // Integrated pose.
+      float _distance = 0.0f; // Metres driven by the centre of the robot, backwards negative.
+      float _turned = 0.0f; // Radians turned, not wrapped.
+}; // class amOdometry
+
+#endif // End of precompiler protected code block
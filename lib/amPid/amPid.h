@@ -0,0 +1,171 @@
+/*************************************************************************************************************************************
+ * @file amPid.h
+ * @author va3wam
+ * @brief PID controller and two loop cascade with the gains fixed at compile time.
+ * @details Gains, loop period and limits come from a traits struct of static constexpr members rather than variables, so each
+ * controller compiles down to straight-line arithmetic with the constants folded in and unused terms (ki or kd of 0, no slew
+ * limit) removed altogether. Float template parameters would need C++20, which the ESP32 toolchain does not have; a traits
+ * struct works from C++11. Example:
+ * @code
+ * struct angleGains
+ * {
+ *    static constexpr float kp = 8.0f, ki = 0.5f, kd = 0.2f; // Gains.
+ *    static constexpr float dt = 0.005f; // Loop period in seconds.
+ *    static constexpr float outMin = -1.0f, outMax = 1.0f; // Output clamp.
+ *    static constexpr float iMin = -0.5f, iMax = 0.5f; // Integrator clamp.
+ *    static constexpr float slewRate = 0.0f; // Largest output change per second. 0 for no limit.
+ * };
+ * amPid<angleGains> anglePid;
+ * @endcode
+ * Each controller has:
+ * - Integrator clamping plus conditional integration: the integrator stops growing while the output is saturated in the same
+ *   direction, so it does not wind up when the motors are at full power.
+ * - Derivative on measurement: a setpoint step does not kick the output.
+ * - Feed forward added to the output before clamping.
+ * - Output slew rate limit.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amPid_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amPid_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+
+/*************************************************************************************************************************************
+ * @class PID controller with compile time gains.
+ * @tparam G Traits struct with kp, ki, kd, dt, outMin, outMax, iMin, iMax and slewRate.
+ *************************************************************************************************************************************/
+template <typename G> class amPid
+{
+   public:
+      /**
+       * @brief Start again without a derivative or slew jump on the next update.
+       * @param measurement Current value of the process.
+       * @param output Output to continue from. Also preloads the integrator so the change is bumpless.
+      ===================================================================================================*/
+      void reset(float measurement = 0.0f, float output = 0.0f)
+      {
+         _lastMeasurement = measurement;
+         _output = output;
+         _integral = _clamp(output, G::iMin, G::iMax);
+      } // reset()
+
+      /**
+       * @brief Run the controller for one period.
+       * @param setpoint Wanted value.
+       * @param measurement Current value.
+       * @param feedForward Added to the output before it is clamped.
+       * @return Controller output.
+      ===================================================================================================*/
+      float update(float setpoint, float measurement, float feedForward = 0.0f)
+      {
+         float error = setpoint - measurement;
+         float output = G::kp * error + feedForward;
+         if(G::kd != 0.0f) // Derivative on measurement. Compiled out when kd is 0.
+         {
+            output -= (G::kd / G::dt) * (measurement - _lastMeasurement);
+         } // if
+         _lastMeasurement = measurement;
+         if(G::ki != 0.0f) // Compiled out when ki is 0.
+         {
+            float unclamped = output + _integral;
+            bool pushingHigh = unclamped >= G::outMax && error > 0.0f; // Saturated and error would make it worse.
+            bool pushingLow = unclamped <= G::outMin && error < 0.0f;
+            if(!pushingHigh && !pushingLow)
+            {
+               _integral = _clamp(_integral + (G::ki * G::dt) * error, G::iMin, G::iMax);
+            } // if
+            output += _integral;
+         } // if
+         output = _clamp(output, G::outMin, G::outMax);
+         if(G::slewRate > 0.0f) // Compiled out when there is no slew limit.
+         {
+            output = _clamp(output, _output - G::slewRate * G::dt, _output + G::slewRate * G::dt);
+         } // if
+         _output = output;
+         return output;
+      } // update()
+
+      float getOutput() const { return _output; } // Last output.
+      float getIntegral() const { return _integral; } // Integrator contribution to the output.
+
+   private:
+      static float _clamp(float value, float low, float high) { return (value < low) ? low : (value > high) ? high : value; } // Clamp.
+      float _integral = 0.0f; // Integrator contribution to the output.
+      float _lastMeasurement = 0.0f; // Measurement at the last update.
+      float _output = 0.0f; // Last output.
+}; // class amPid
+
+/*************************************************************************************************************************************
+ * @class Two PID loops in cascade.
+ * @details The outer loop's output is the inner loop's setpoint. The inner loop runs on every update(); the outer loop runs once
+ * every Outer::dt / Inner::dt updates, so both periods come from the gains and the ratio is fixed at compile time. For the robot
+ * the outer loop holds wheel speed and asks for a lean angle, and the inner loop holds that angle.
+ * @tparam Outer Traits struct for the outer (slower) loop.
+ * @tparam Inner Traits struct for the inner (faster) loop.
+ *************************************************************************************************************************************/
+template <typename Outer, typename Inner> class amPidCascade
+{
+   public:
+      static constexpr uint16_t RATIO = (uint16_t)(Outer::dt / Inner::dt + 0.5f); // Inner updates per outer update.
+      static_assert(RATIO >= 1, "Outer loop must not run faster than the inner loop");
+
+      /**
+       * @brief Start both loops again with empty integrators.
+       * @param outerMeasurement Current value of the outer process.
+       * @param innerMeasurement Current value of the inner process.
+      ===================================================================================================*/
+      void reset(float outerMeasurement = 0.0f, float innerMeasurement = 0.0f)
+      {
+         _outer.reset(outerMeasurement);
+         _inner.reset(innerMeasurement);
+         _innerSetpoint = 0.0f;
+         _count = 0;
+      } // reset()
+
+      /**
+       * @brief Run one inner period, and the outer loop if it is due.
+       * @param outerSetpoint Wanted value of the outer process.
+       * @param outerMeasurement Current value of the outer process.
+       * @param innerMeasurement Current value of the inner process.
+       * @param innerFeedForward Added to the inner loop output.
+       * @return Inner loop output.
+      ===================================================================================================*/
+      float update(float outerSetpoint, float outerMeasurement, float innerMeasurement, float innerFeedForward = 0.0f)
+      {
+         if(_count == 0)
+         {
+            _innerSetpoint = _outer.update(outerSetpoint, outerMeasurement);
+         } // if
+         if(++_count >= RATIO)
+         {
+            _count = 0;
+         } // if
+         return _inner.update(_innerSetpoint, innerMeasurement, innerFeedForward);
+      } // update()
+
+      float getInnerSetpoint() const { return _innerSetpoint; } // What the outer loop is asking for.
+      amPid<Outer>& outer() { return _outer; } // The outer loop.
+      amPid<Inner>& inner() { return _inner; } // The inner loop.
+
+   private:
+      amPid<Outer> _outer; // Slower loop.
+      amPid<Inner> _inner; // Faster loop.
+      float _innerSetpoint = 0.0f; // Latest outer loop output.
+      uint16_t _count = 0; // Inner updates since the outer loop last ran.
+}; // class amPidCascade
+
+#endif // End of precompiler protected code block
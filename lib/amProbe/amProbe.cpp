@@ -0,0 +1,345 @@
+/*************************************************************************************************************************************
+ * @file amProbe.cpp
+ * @author va3wam
+ * @brief Reachability checks that never block.
+ * @details See amProbe.h.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <amProbe.h> // Header file for linking.
+#include <string.h> // memset().
+#include <errno.h> // Why a socket call failed.
+#include <fcntl.h> // Non blocking sockets.
+#ifdef ARDUINO
+#include <lwip/sockets.h> // lwIP BSD sockets, the same ones ESP32Ping uses.
+#else
+#include <unistd.h> // close().
+#include <sys/socket.h> // BSD sockets.
+#include <sys/select.h> // select().
+#include <netinet/in.h> // sockaddr_in.
+#include <arpa/inet.h> // htons().
+#define closesocket close // Name lwIP uses.
+#endif
+
+#define PROBE_ECHO_LEN 16 // ICMP echo request, 8 byte header and 8 bytes of payload.
+#define PROBE_RECV_LEN 64 // Room for an IP header and the echo reply.
+
+/**
+ * @brief Internet checksum of an ICMP message.
+ * @param data Message, with its checksum field zero.
+ * @param len Bytes in the message. Even.
+ * @return uint16_t Checksum, ready to store as is.
+ =============================================================================*/
+static uint16_t checksum(const uint8_t* data, uint16_t len)
+{
+   uint32_t sum = 0;
+   for(uint16_t i = 0; i + 1 < len; i += 2)
+   {
+      sum += (uint16_t)((data[i] << 8) | data[i + 1]); // Big endian 16 bit words.
+   } // for
+   while(sum >> 16) { sum = (sum & 0xFFFF) + (sum >> 16); } // Fold the carries back in.
+   return htons((uint16_t)~sum);
+} // checksum()
+
+/**
+ * @brief This is the constructor for this class. Nothing is sent until probe().
+ * @param timeoutMs Longest to wait for an answer before calling it PROBE_TIMEOUT.
+ * @param ttlMs How long an answer is reused before the target is probed again.
+===================================================================================================*/
+amProbe::amProbe(uint32_t timeoutMs, uint32_t ttlMs)
+   : _timeoutMs(timeoutMs), _ttlMs(ttlMs), _id((uint16_t)(((uintptr_t)this >> 4) ^ 0x5A54))
+{
+   memset(_cache, 0, sizeof(_cache)); // Every entry PROBE_UNKNOWN.
+} // amProbe::amProbe()
+
+/**
+ * @brief This is the destructor for this class.
+===================================================================================================*/
+amProbe::~amProbe()
+{
+   cancel();
+} // amProbe::~amProbe()
+
+/**
+ * @brief Probe a target, unless it was probed less than ttlMs ago or is being probed now.
+ * @details A callback is only made for PROBE_PENDING. Any other answer is final and comes back straight away. A caller that
+ * joins a probe that already has a callback is not called back, and can use lookup() instead.
+ * @param ip Target, network byte order.
+ * @param kind PROBE_ICMP or PROBE_TCP.
+ * @param port Target port for PROBE_TCP.
+ * @param nowMs Current time.
+ * @param callback Called from poll() with the answer. May be nullptr.
+ * @param arg Passed back to callback.
+ * @return uint8_t PROBE_PENDING, PROBE_BUSY or the answer.
+===================================================================================================*/
+uint8_t amProbe::probe(uint32_t ip, uint8_t kind, uint16_t port, uint32_t nowMs, amProbeCallback callback, void* arg)
+{
+   if(kind == PROBE_ICMP) port = 0; // Every echo to a host is the same target.
+   amProbeSlot* inFlight = _find(ip, kind, port);
+   if(inFlight != nullptr) // Join the probe already under way.
+   {
+      _cacheHits++;
+      if(inFlight->callback == nullptr)
+      {
+         inFlight->callback = callback;
+         inFlight->arg = arg;
+      } // if
+      return PROBE_PENDING;
+   } // if
+   amProbeResult* known = _cached(ip, kind, port, nowMs);
+   if(known != nullptr) // Answered recently.
+   {
+      _cacheHits++;
+      return known->status;
+   } // if
+   if(ip == 0 || ip == 0xFFFFFFFF) return PROBE_ERROR; // 0.0.0.0 would reach ourselves. Neither is a host.
+   amProbeSlot* slot = nullptr;
+   for(uint8_t i = 0; i < PROBE_SLOTS && slot == nullptr; i++)
+   {
+      if(_slots[i].fd < 0) slot = &_slots[i];
+   } // for
+   if(slot == nullptr) return PROBE_BUSY;
+   slot->result.ip = ip;
+   slot->result.port = port;
+   slot->result.kind = kind;
+   slot->result.status = PROBE_PENDING;
+   slot->result.rttMs = 0;
+   slot->result.atMs = nowMs;
+   slot->startMs = nowMs;
+   slot->callback = callback;
+   slot->arg = arg;
+   uint8_t status = _open(*slot);
+   if(status != PROBE_PENDING) // Refused or failed on the spot, or loopback accepted at once.
+   {
+      _finish(*slot, status, nowMs);
+   } // if
+   return status;
+} // amProbe::probe()
+
+/**
+ * @brief Say what is known about a target without probing it.
+ * @param ip Target, network byte order.
+ * @param kind PROBE_ICMP or PROBE_TCP.
+ * @param port Target port for PROBE_TCP.
+ * @param nowMs Current time.
+ * @param result Filled in with the target and the answer, if not nullptr.
+ * @return uint8_t PROBE_PENDING, the answer of a probe less than ttlMs old, or PROBE_UNKNOWN.
+===================================================================================================*/
+uint8_t amProbe::lookup(uint32_t ip, uint8_t kind, uint16_t port, uint32_t nowMs, amProbeResult* result)
+{
+   if(kind == PROBE_ICMP) port = 0; // Every echo to a host is the same target.
+   amProbeResult found = {ip, port, kind, PROBE_UNKNOWN, 0, nowMs};
+   amProbeSlot* inFlight = _find(ip, kind, port);
+   amProbeResult* known = _cached(ip, kind, port, nowMs);
+   if(inFlight != nullptr) found = inFlight->result;
+   else if(known != nullptr) found = *known;
+   if(result != nullptr) *result = found;
+   return found.status;
+} // amProbe::lookup()
+
+/**
+ * @brief Look for answers to every probe in flight, time out the ones that took too long and call back with the results.
+ * @details Never waits. A callback may start another probe.
+ * @param nowMs Current time.
+===================================================================================================*/
+void amProbe::poll(uint32_t nowMs)
+{
+   for(uint8_t i = 0; i < PROBE_SLOTS; i++)
+   {
+      amProbeSlot &slot = _slots[i];
+      if(slot.fd < 0) continue; // Free.
+      uint8_t status = _check(slot);
+      if(status == PROBE_PENDING && nowMs - slot.startMs >= _timeoutMs) status = PROBE_TIMEOUT;
+      if(status == PROBE_PENDING) continue;
+      amProbeCallback callback = slot.callback;
+      void* arg = slot.arg;
+      _finish(slot, status, nowMs); // Frees the slot before the callback can reuse it.
+      amProbeResult result = slot.result;
+      if(callback != nullptr) callback(&result, arg);
+   } // for
+} // amProbe::poll()
+
+/**
+ * @brief Close every probe in flight. No callbacks are made and nothing is cached.
+===================================================================================================*/
+void amProbe::cancel()
+{
+   for(uint8_t i = 0; i < PROBE_SLOTS; i++)
+   {
+      if(_slots[i].fd >= 0) closesocket(_slots[i].fd);
+      _slots[i].fd = -1;
+   } // for
+} // amProbe::cancel()
+
+/**
+ * @brief Empty the cache so that the next probe of every target goes on the wire.
+===================================================================================================*/
+void amProbe::forget()
+{
+   memset(_cache, 0, sizeof(_cache));
+} // amProbe::forget()
+
+/**
+ * @brief Count the probes under way.
+ * @return uint8_t Slots in use.
+===================================================================================================*/
+uint8_t amProbe::getInFlight()
+{
+   uint8_t count = 0;
+   for(uint8_t i = 0; i < PROBE_SLOTS; i++)
+   {
+      if(_slots[i].fd >= 0) count++;
+   } // for
+   return count;
+} // amProbe::getInFlight()
+
+/**
+ * @brief Create a non blocking socket for a probe and send the echo, or start the connect.
+ * @param slot Probe, with its target filled in.
+ * @return uint8_t PROBE_PENDING once sent, or the answer if there already is one.
+===================================================================================================*/
+uint8_t amProbe::_open(amProbeSlot &slot)
+{
+   struct sockaddr_in to;
+   memset(&to, 0, sizeof(to));
+   to.sin_family = AF_INET;
+   to.sin_port = htons(slot.result.port);
+   to.sin_addr.s_addr = slot.result.ip;
+   if(slot.result.kind == PROBE_TCP) slot.fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+   else slot.fd = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+   if(slot.fd < 0) return PROBE_ERROR; // Out of sockets, or not allowed raw ones.
+   _sent++;
+   if(fcntl(slot.fd, F_SETFL, fcntl(slot.fd, F_GETFL, 0) | O_NONBLOCK) < 0) return PROBE_ERROR;
+   if(slot.result.kind == PROBE_TCP)
+   {
+      if(connect(slot.fd, (struct sockaddr*)&to, sizeof(to)) == 0) return PROBE_UP;
+      if(errno == EINPROGRESS) return PROBE_PENDING; // The usual case. poll() finds out how it went.
+      return (errno == ECONNREFUSED) ? PROBE_REFUSED : PROBE_ERROR;
+   } // if
+   uint8_t echo[PROBE_ECHO_LEN];
+   memset(echo, 0, sizeof(echo));
+   slot.seq = ++_seq;
+   echo[0] = 8; // Echo request.
+   echo[4] = _id >> 8; // Identifier, big endian.
+   echo[5] = _id & 0xFF;
+   echo[6] = slot.seq >> 8; // Sequence number, big endian.
+   echo[7] = slot.seq & 0xFF;
+   memcpy(&echo[8], &slot.startMs, sizeof(slot.startMs)); // Payload. Anything will do.
+   uint16_t sum = checksum(echo, sizeof(echo));
+   memcpy(&echo[2], &sum, sizeof(sum));
+   if(sendto(slot.fd, echo, sizeof(echo), 0, (struct sockaddr*)&to, sizeof(to)) != (int)sizeof(echo)) return PROBE_ERROR;
+   return PROBE_PENDING;
+} // amProbe::_open()
+
+/**
+ * @brief Look for the answer to a probe without waiting for it.
+ * @param slot Probe in flight.
+ * @return uint8_t PROBE_PENDING until there is an answer.
+===================================================================================================*/
+uint8_t amProbe::_check(amProbeSlot &slot)
+{
+   if(slot.result.kind == PROBE_TCP)
+   {
+      fd_set writable;
+      fd_set failed;
+      FD_ZERO(&writable);
+      FD_ZERO(&failed);
+      FD_SET(slot.fd, &writable);
+      FD_SET(slot.fd, &failed);
+      struct timeval noWait = {0, 0};
+      if(select(slot.fd + 1, nullptr, &writable, &failed, &noWait) <= 0) return PROBE_PENDING; // Connect not finished.
+      int err = 0;
+      socklen_t len = sizeof(err);
+      if(getsockopt(slot.fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0) return PROBE_ERROR;
+      if(err == 0) return PROBE_UP;
+      return (err == ECONNREFUSED) ? PROBE_REFUSED : PROBE_ERROR;
+   } // if
+   uint8_t buf[PROBE_RECV_LEN];
+   struct sockaddr_in from;
+   socklen_t fromLen = sizeof(from);
+   int len;
+   while((len = recvfrom(slot.fd, buf, sizeof(buf), 0, (struct sockaddr*)&from, &fromLen)) > 0) // Raw sockets see every ICMP message.
+   {
+      fromLen = sizeof(from);
+      if(from.sin_addr.s_addr != slot.result.ip) continue; // Someone else's.
+      int start = ((buf[0] >> 4) == 4) ? (buf[0] & 0x0F) * 4 : 0; // Skip the IP header, when the stack passes it on.
+      if(len < start + 8) continue; // Too short to be an echo reply.
+      const uint8_t* icmp = &buf[start];
+      if(icmp[0] != 0) continue; // Not an echo reply. Loopback also shows us our own request.
+      if(((icmp[4] << 8) | icmp[5]) != _id || ((icmp[6] << 8) | icmp[7]) != slot.seq) continue; // Another probe's.
+      return PROBE_UP;
+   } // while
+   return PROBE_PENDING;
+} // amProbe::_check()
+
+/**
+ * @brief Close a finished probe, count it and remember its answer in place of the oldest one. PROBE_ERROR is not remembered.
+ * @param slot Probe that has its answer.
+ * @param status PROBE_ answer.
+ * @param nowMs Current time.
+===================================================================================================*/
+void amProbe::_finish(amProbeSlot &slot, uint8_t status, uint32_t nowMs)
+{
+   if(slot.fd >= 0) closesocket(slot.fd);
+   slot.fd = -1;
+   slot.result.status = status;
+   slot.result.rttMs = nowMs - slot.startMs;
+   slot.result.atMs = nowMs;
+   if(status == PROBE_UP) _up++;
+   else _failed++;
+   if(status == PROBE_ERROR) return; // Says more about us than about the target. Try again next time.
+   amProbeResult* entry = &_cache[0];
+   for(uint8_t i = 0; i < PROBE_CACHE; i++)
+   {
+      amProbeResult &e = _cache[i];
+      if(e.status != PROBE_UNKNOWN && e.ip == slot.result.ip && e.kind == slot.result.kind && e.port == slot.result.port)
+      {
+         entry = &e; // Replace the old answer for this target.
+         break;
+      } // if
+      if(entry->status == PROBE_UNKNOWN) continue; // Already have an empty entry.
+      if(e.status == PROBE_UNKNOWN || nowMs - e.atMs > nowMs - entry->atMs) entry = &e; // Empty or older.
+   } // for
+   *entry = slot.result;
+} // amProbe::_finish()
+
+/**
+ * @brief Find the probe in flight for a target.
+ * @return amProbeSlot* Its slot, or nullptr if it is not being probed.
+===================================================================================================*/
+amProbeSlot* amProbe::_find(uint32_t ip, uint8_t kind, uint16_t port)
+{
+   for(uint8_t i = 0; i < PROBE_SLOTS; i++)
+   {
+      amProbeSlot &slot = _slots[i];
+      if(slot.fd >= 0 && slot.result.ip == ip && slot.result.kind == kind && slot.result.port == port) return &slot;
+   } // for
+   return nullptr;
+} // amProbe::_find()
+
+/**
+ * @brief Find a cached answer for a target that is still good.
+ * @return amProbeResult* The answer, or nullptr if there is none less than ttlMs old.
+===================================================================================================*/
+amProbeResult* amProbe::_cached(uint32_t ip, uint8_t kind, uint16_t port, uint32_t nowMs)
+{
+   for(uint8_t i = 0; i < PROBE_CACHE; i++)
+   {
+      amProbeResult &e = _cache[i];
+      if(e.status == PROBE_UNKNOWN || e.ip != ip || e.kind != kind || e.port != port) continue;
+      if(nowMs - e.atMs < _ttlMs) return &e;
+   } // for
+   return nullptr;
+} // amProbe::_cached()
@@ -0,0 +1,125 @@
+/*************************************************************************************************************************************
+ * @file amProbe.h
+ * @author va3wam
+ * @brief Reachability checks that never block.
+ * @details Probes hosts with an ICMP echo or with a TCP connect, e.g. to port 1883 to check that an MQTT broker is really listening
+ * rather than that something answers pings. Up to PROBE_SLOTS probes run at once, each on its own non blocking socket, and poll()
+ * moves them all along from loop(). Nothing waits: probe() sends and returns, poll() only looks at what has already arrived.
+ *
+ * Each answer is kept for ttlMs, except PROBE_ERROR, which is about us rather than the target. A probe of the same target within that time is answered from the cache without going on
+ * the wire, and one for a target already being probed joins it rather than starting another. probe() returns the answer when it
+ * already has one, otherwise PROBE_PENDING, and then the callback, if one was given, is called from poll() with the result. Callers
+ * that would rather ask later can use lookup() instead of a callback.
+ *
+ * Addresses are IPv4 in network byte order, as IPAddress converts to uint32_t. Times are passed in, in milliseconds, and wrap
+ * safely. Uses the BSD socket API, from lwIP on the ESP32 and from the operating system on the host, where the tests run it
+ * against loopback sockets.
+ * Example:
+ * @code
+ * amProbe brokerCheck(2000, 30000);
+ * if(brokerCheck.probe(ip, PROBE_TCP, PROBE_MQTT_PORT, millis(), onBrokerChecked) == PROBE_UP) { ... } // Answered from the cache.
+ * brokerCheck.poll(millis()); // From loop(). Calls onBrokerChecked() when the answer arrives.
+ * @endcode
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amProbe_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amProbe_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+
+#define PROBE_SLOTS 4 // Probes in flight at once. Each holds a socket, and lwIP has 10 to share with everything else.
+#define PROBE_CACHE 8 // Finished probes remembered.
+#define PROBE_MQTT_PORT 1883 // Where MQTT brokers listen.
+
+// Kinds of probe.
+#define PROBE_ICMP 0 // ICMP echo. Port is ignored.
+#define PROBE_TCP 1 // TCP connect, closed as soon as it is accepted.
+
+// Answers.
+#define PROBE_UNKNOWN 0 // Not probed, or the answer is older than ttlMs.
+#define PROBE_PENDING 1 // Probe under way.
+#define PROBE_UP 2 // Echo answered, or connection accepted.
+#define PROBE_REFUSED 3 // Host is there but nothing listens on the port.
+#define PROBE_TIMEOUT 4 // No answer within timeoutMs.
+#define PROBE_ERROR 5 // Could not be sent. No socket, no route or a bad address.
+#define PROBE_BUSY 6 // From probe() only. Every slot is in use. Try again later.
+
+/**
+ * @brief Outcome of one probe.
+ =============================================================================*/
+struct amProbeResult
+{
+   uint32_t ip; // Target, network byte order.
+   uint16_t port; // Target port. 0 for PROBE_ICMP.
+   uint8_t kind; // PROBE_ICMP or PROBE_TCP.
+   uint8_t status; // PROBE_ answer.
+   uint32_t rttMs; // Time to the answer, for PROBE_UP and PROBE_REFUSED.
+   uint32_t atMs; // When the answer came.
+}; // struct amProbeResult
+
+typedef void (*amProbeCallback)(const amProbeResult* result, void* arg); // Called from poll() when a pending probe finishes.
+
+/**
+ * @brief One probe in flight.
+ =============================================================================*/
+struct amProbeSlot
+{
+   amProbeResult result; // Target, and the answer once there is one.
+   int fd = -1; // Socket. -1 when the slot is free.
+   uint16_t seq = 0; // Echo sequence number, for PROBE_ICMP.
+   uint32_t startMs = 0; // When it was sent.
+   amProbeCallback callback = nullptr; // Who to tell.
+   void* arg = nullptr; // Passed back to callback.
+}; // struct amProbeSlot
+
+/*************************************************************************************************************************************
+ * @class Concurrent ICMP and TCP reachability probes with a cache of recent answers.
+ *************************************************************************************************************************************/
+class amProbe
+{
+   public:
+      amProbe(uint32_t timeoutMs, uint32_t ttlMs); // Class constructor.
+      ~amProbe(); // Class destructor. Closes the sockets of probes still in flight.
+      uint8_t probe(uint32_t ip, uint8_t kind, uint16_t port, uint32_t nowMs, amProbeCallback callback = nullptr, void* arg = nullptr); // Start a probe, or answer from the cache.
+      uint8_t lookup(uint32_t ip, uint8_t kind, uint16_t port, uint32_t nowMs, amProbeResult* result = nullptr); // What is known about a target, without probing.
+      void poll(uint32_t nowMs); // Move every probe in flight along.
+      void cancel(); // Drop every probe in flight without calling back.
+      void forget(); // Empty the cache.
+      uint8_t getInFlight(); // Probes under way.
+      uint32_t getSent() { return _sent; } // Probes put on the wire.
+      uint32_t getCacheHits() { return _cacheHits; } // Probes answered from the cache or joined to one in flight.
+      uint32_t getUp() { return _up; } // Probes answered with PROBE_UP.
+      uint32_t getFailed() { return _failed; } // Probes answered with anything else.
+   private:
+      uint8_t _open(amProbeSlot &slot); // Create the socket and send.
+      uint8_t _check(amProbeSlot &slot); // Look for an answer. PROBE_PENDING if none yet.
+      void _finish(amProbeSlot &slot, uint8_t status, uint32_t nowMs); // Close, count and remember.
+      amProbeSlot* _find(uint32_t ip, uint8_t kind, uint16_t port); // Slot probing a target. nullptr if none.
+      amProbeResult* _cached(uint32_t ip, uint8_t kind, uint16_t port, uint32_t nowMs); // Fresh cache entry. nullptr if none.
+      uint32_t _timeoutMs; // Longest to wait for an answer.
+      uint32_t _ttlMs; // How long an answer stays good.
+      amProbeSlot _slots[PROBE_SLOTS]; // Probes in flight.
+      amProbeResult _cache[PROBE_CACHE]; // Recent answers. PROBE_UNKNOWN marks an empty entry.
+      uint16_t _id; // Echo identifier, different for each instance.
+      uint16_t _seq = 0; // Last echo sequence number used.
+      uint32_t _sent = 0; // Probes put on the wire.
+      uint32_t _cacheHits = 0; // Probes answered without going on the wire.
+      uint32_t _up = 0; // PROBE_UP answers.
+      uint32_t _failed = 0; // Other answers.
+}; // class amProbe
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,168 @@
+/*************************************************************************************************************************************
+ * @file amReconnect.cpp
+ * @author va3wam
+ * @brief Connection state machine with jittered exponential backoff.
+ * @details See amReconnect.h.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <amReconnect.h> // Header file for linking.
+
+/**
+ * @brief This is the constructor for this class. Nothing happens until start().
+ * @param firstDelayMs Wait after the first failure.
+ * @param maxDelayMs Longest wait, however many failures.
+ * @param connectTimeoutMs Longest an attempt may take before poll() asks for it to be dropped.
+ * @param stableMs How long a connection must stay up to reset the backoff.
+ * @param seed Starting point of the jitter, e.g. from the MAC address. Different robots should use different seeds.
+===================================================================================================*/
+amReconnect::amReconnect(uint32_t firstDelayMs, uint32_t maxDelayMs, uint32_t connectTimeoutMs, uint32_t stableMs, uint32_t seed)
+   : _firstDelayMs(firstDelayMs), _maxDelayMs(maxDelayMs), _connectTimeoutMs(connectTimeoutMs), _stableMs(stableMs),
+     _seed(seed != 0 ? seed : 0x9E3779B9)
+{
+
+} // amReconnect::amReconnect()
+
+/**
+ * @brief Start connecting. The first attempt is due straight away.
+ * @param nowMs Current time.
+===================================================================================================*/
+void amReconnect::start(uint32_t nowMs)
+{
+   _state = RC_WAITING;
+   _sinceMs = nowMs;
+   _waitMs = 0;
+   _failures = 0;
+} // amReconnect::start()
+
+/**
+ * @brief Make no more attempts. A connection that is up is left to the owner.
+===================================================================================================*/
+void amReconnect::stop()
+{
+   _state = RC_IDLE;
+} // amReconnect::stop()
+
+/**
+ * @brief Say what to do now.
+ * @param nowMs Current time.
+ * @return RC_CONNECT when a wait is over, RC_ABORT when an attempt has run out of time, otherwise RC_NONE.
+===================================================================================================*/
+uint8_t amReconnect::poll(uint32_t nowMs)
+{
+   if(_state == RC_WAITING && nowMs - _sinceMs >= _waitMs)
+   {
+      _state = RC_CONNECTING;
+      _sinceMs = nowMs;
+      _attempts++;
+      return RC_CONNECT;
+   } // if
+   if(_state == RC_CONNECTING && nowMs - _sinceMs >= _connectTimeoutMs)
+   {
+      _timeouts++;
+      _schedule(nowMs); // Disconnect the owner's abort causes arrives while waiting and is ignored.
+      return RC_ABORT;
+   } // if
+   return RC_NONE;
+} // amReconnect::poll()
+
+/**
+ * @brief The attempt succeeded.
+ * @param nowMs Current time.
+===================================================================================================*/
+void amReconnect::connected(uint32_t nowMs)
+{
+   if(_state != RC_CONNECTING) // Late answer to an attempt already given up on.
+   {
+      return;
+   } // if
+   _state = RC_CONNECTED;
+   _sinceMs = nowMs;
+   _connects++;
+} // amReconnect::connected()
+
+/**
+ * @brief The attempt failed, e.g. refused, or the connection went down.
+ * @param nowMs Current time.
+===================================================================================================*/
+void amReconnect::disconnected(uint32_t nowMs)
+{
+   if(_state == RC_CONNECTED)
+   {
+      _drops++;
+      if(nowMs - _sinceMs >= _stableMs) // Worked for a good while. Come straight back.
+      {
+         _failures = 0;
+      } // if
+      _schedule(nowMs);
+   } // if
+   else if(_state == RC_CONNECTING)
+   {
+      _schedule(nowMs);
+   } // else if
+} // amReconnect::disconnected()
+
+/**
+ * @brief Time until the next attempt.
+ * @param nowMs Current time.
+ * @return Milliseconds, or 0 if not waiting or the attempt is due.
+===================================================================================================*/
+uint32_t amReconnect::getWaitMs(uint32_t nowMs)
+{
+   uint32_t waited = nowMs - _sinceMs;
+   if(_state != RC_WAITING || waited >= _waitMs)
+   {
+      return 0;
+   } // if
+   return _waitMs - waited;
+} // amReconnect::getWaitMs()
+
+/**
+ * @brief Count a failure and pick when to try again.
+ * @details The step doubles with each failure, capped at maxDelayMs. The wait is half the step plus
+ * a random part of the other half.
+ * @param nowMs Current time.
+===================================================================================================*/
+void amReconnect::_schedule(uint32_t nowMs)
+{
+   if(_failures < 255)
+   {
+      _failures++;
+   } // if
+   uint32_t step = _firstDelayMs;
+   for(uint8_t i = 1; i < _failures && step < _maxDelayMs; i++)
+   {
+      step *= 2;
+   } // for
+   if(step > _maxDelayMs)
+   {
+      step = _maxDelayMs;
+   } // if
+   uint32_t half = step / 2;
+   _waitMs = (step - half) + _random() % (half + 1);
+   _state = RC_WAITING;
+   _sinceMs = nowMs;
+} // amReconnect::_schedule()
+
+/**
+ * @brief Next number of a xorshift32 sequence. Plenty for spreading retries.
+===================================================================================================*/
+uint32_t amReconnect::_random()
+{
+   _seed ^= _seed << 13;
+   _seed ^= _seed >> 17;
+   _seed ^= _seed << 5;
+   return _seed;
+} // amReconnect::_random()
@@ -0,0 +1,93 @@
+/*************************************************************************************************************************************
+ * @file amReconnect.h
+ * @author va3wam
+ * @brief Connection state machine with jittered exponential backoff.
+ * @details Knows nothing of MQTT or TCP. The owner reports what happened with connected() and disconnected() and calls poll()
+ * regularly, and poll() answers with what to do: start a connection attempt, give up on one that is taking too long, or nothing.
+ * All times are passed in, in milliseconds, and wrap safely, so one task drives it and a test can play any sequence of events.
+ *
+ * A failed attempt, or a connection that drops before it has been up for stableMs, doubles the wait before the next attempt, from
+ * firstDelayMs up to maxDelayMs. A connection that stayed up that long starts the doubling again from firstDelayMs. Each wait is
+ * picked at random from the upper half of the current step so that robots that lost the same broker do not all return at once.
+ * Example:
+ * @code
+ * amReconnect link(1000, 60000, 5000, 30000, seed);
+ * link.start(millis());
+ * switch(link.poll(millis())) // From loop().
+ * {
+ *    case RC_CONNECT: client.connect(); break;
+ *    case RC_ABORT: client.disconnect(true); break;
+ * }
+ * link.connected(millis()); // From the client's connect and disconnect callbacks, handed over to the polling task.
+ * link.disconnected(millis());
+ * @endcode
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amReconnect_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amReconnect_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+
+// States.
+#define RC_IDLE 0 // Not started, or stopped.
+#define RC_WAITING 1 // Waiting out the backoff before the next attempt.
+#define RC_CONNECTING 2 // Attempt under way.
+#define RC_CONNECTED 3 // Connection up.
+
+// What poll() asks the owner to do.
+#define RC_NONE 0 // Nothing.
+#define RC_CONNECT 1 // Start a connection attempt.
+#define RC_ABORT 2 // Attempt took longer than connectTimeoutMs. Drop it. The next one is already scheduled.
+
+/*************************************************************************************************************************************
+ * @class When to connect, and when to give up on a connection attempt.
+ *************************************************************************************************************************************/
+class amReconnect
+{
+   public:
+      amReconnect(uint32_t firstDelayMs, uint32_t maxDelayMs, uint32_t connectTimeoutMs, uint32_t stableMs, uint32_t seed); // Class constructor.
+      void start(uint32_t nowMs); // Make the first attempt due now.
+      void stop(); // Make no more attempts.
+      uint8_t poll(uint32_t nowMs); // What to do now. RC_NONE, RC_CONNECT or RC_ABORT.
+      void connected(uint32_t nowMs); // The attempt succeeded.
+      void disconnected(uint32_t nowMs); // The attempt failed, or the connection dropped.
+      uint8_t getState() { return _state; } // amReconnect::getState()
+      uint32_t getWaitMs(uint32_t nowMs); // Time until the next attempt. 0 unless waiting.
+      uint8_t getFailures() { return _failures; } // Failed attempts and early drops since the last stable connection.
+      uint32_t getAttempts() { return _attempts; } // Attempts started.
+      uint32_t getConnects() { return _connects; } // Attempts that succeeded.
+      uint32_t getTimeouts() { return _timeouts; } // Attempts abandoned after connectTimeoutMs.
+      uint32_t getDrops() { return _drops; } // Connections that went down.
+   private:
+      void _schedule(uint32_t nowMs); // Count a failure and pick when to try again.
+      uint32_t _random(); // Next pseudo random number.
+      uint32_t _firstDelayMs; // First backoff step.
+      uint32_t _maxDelayMs; // Largest backoff step.
+      uint32_t _connectTimeoutMs; // Longest an attempt may take.
+      uint32_t _stableMs; // Connection that lasts this long resets the backoff.
+      uint32_t _seed; // Random state. Never 0.
+      uint8_t _state = RC_IDLE; // RC_ state.
+      uint32_t _sinceMs = 0; // When the current state began.
+      uint32_t _waitMs = 0; // Length of the current wait.
+      uint8_t _failures = 0; // Failures since the last stable connection.
+      uint32_t _attempts = 0; // Attempts started.
+      uint32_t _connects = 0; // Attempts that succeeded.
+      uint32_t _timeouts = 0; // Attempts abandoned.
+      uint32_t _drops = 0; // Connections that went down.
+}; // class amReconnect
+
+#endif // End of precompiler protected code block
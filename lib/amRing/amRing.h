@@ -0,0 +1,193 @@
+/*************************************************************************************************************************************
+ * @file amRing.h
+ * @author va3wam
+ * @brief Lock free single producer, single consumer ring of fixed size byte slots.
+ * @details One task pushes and one other task pops, with no lock between them: each slot carries a sequence number that the
+ * producer publishes with a release store once the slot is written and the consumer hands back with a release store once it has
+ * copied it out, so neither side ever sees a half written slot. Push and pop are O(1) and never block. The head and tail indexes
+ * sit on their own cache lines so the two sides do not fight over one line. When the ring is full the policy decides what gives:
+ * - RING_REJECT refuses the new entry and counts it.
+ * - RING_DROP_OLDEST discards the oldest entry to make room and counts that. The producer and consumer both claim the oldest entry
+ *   with a compare and swap on the head, so an entry is either delivered or counted as dropped, never both. In the rare case that
+ *   the consumer is part way through copying out the very slot the producer needs, the new entry is refused and counted instead.
+ * Example:
+ * @code
+ * amRing<8, 20, RING_DROP_OLDEST> commands; // 8 slots of up to 20 bytes.
+ * commands.push("TEST", 4); // From the network task.
+ * char buffer[20];
+ * uint16_t len;
+ * if(commands.pop(buffer, sizeof(buffer), &len) == true) { ... } // From loop().
+ * @endcode
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amRing_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amRing_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <string.h> // memcpy().
+#include <atomic> // std::atomic.
+
+#define RING_REJECT 0 // Full ring refuses new entries.
+#define RING_DROP_OLDEST 1 // Full ring discards its oldest entry to make room.
+#define RING_CACHE_LINE 64 // Bytes. Keeps the producer and consumer indexes apart. Harmless where lines are smaller.
+
+/*************************************************************************************************************************************
+ * @class Lock free single producer, single consumer ring.
+ * @tparam Capacity Number of slots. Must be a power of 2.
+ * @tparam SlotSize Largest entry in bytes.
+ * @tparam Policy RING_REJECT or RING_DROP_OLDEST.
+ *************************************************************************************************************************************/
+template <uint16_t Capacity, uint16_t SlotSize, uint8_t Policy = RING_REJECT> class amRing
+{
+   static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "amRing capacity must be a power of 2");
+   static_assert(Policy == RING_REJECT || Policy == RING_DROP_OLDEST, "amRing policy must be RING_REJECT or RING_DROP_OLDEST");
+   public:
+      amRing(); // Class constructor.
+      bool push(const void* data, uint16_t len); // Producer only. Add an entry.
+      bool pop(void* dest, uint16_t size, uint16_t* len); // Consumer only. Take the oldest entry.
+      bool isEmpty(); // No entries waiting.
+      uint16_t getCount(); // Entries waiting. Exact only when neither side is busy.
+      uint16_t getCapacity() { return Capacity; } // amRing::getCapacity()
+      uint16_t getSlotSize() { return SlotSize; } // amRing::getSlotSize()
+      uint32_t getPushed() { return _pushed.load(std::memory_order_relaxed); } // amRing::getPushed()
+      uint32_t getDropped() { return _dropped.load(std::memory_order_relaxed); } // amRing::getDropped()
+      uint32_t getRejected() { return _rejected.load(std::memory_order_relaxed); } // amRing::getRejected()
+   private:
+      struct slot
+      {
+         std::atomic<uint32_t> seq; // Position the slot is free for, or that position + 1 once it holds an entry.
+         uint16_t len; // Bytes held.
+         uint8_t data[SlotSize]; // Entry.
+      }; // struct
+      alignas(RING_CACHE_LINE) std::atomic<uint32_t> _head; // Next position to pop. Consumer's line.
+      alignas(RING_CACHE_LINE) std::atomic<uint32_t> _tail; // Next position to push. Producer's line.
+      std::atomic<uint32_t> _pushed; // Entries accepted. Written by the producer only.
+      std::atomic<uint32_t> _dropped; // Oldest entries discarded to make room. Written by the producer only.
+      std::atomic<uint32_t> _rejected; // New entries refused. Written by the producer only.
+      alignas(RING_CACHE_LINE) slot _slots[Capacity]; // Entries.
+}; // class amRing
+
+/**
+ * @brief This is the constructor for this class. The ring starts empty.
+===================================================================================================*/
+template <uint16_t Capacity, uint16_t SlotSize, uint8_t Policy> amRing<Capacity, SlotSize, Policy>::amRing()
+   : _head(0), _tail(0), _pushed(0), _dropped(0), _rejected(0)
+{
+   for(uint16_t i = 0; i < Capacity; i++)
+   {
+      _slots[i].seq.store(i, std::memory_order_relaxed);
+      _slots[i].len = 0;
+   } // for
+} // amRing::amRing()
+
+/**
+ * @brief Add an entry. Call from the producer only.
+ * @param data Bytes to copy in.
+ * @param len Number of bytes. Entries longer than SlotSize are refused.
+ * @return false if the entry was refused.
+===================================================================================================*/
+template <uint16_t Capacity, uint16_t SlotSize, uint8_t Policy> bool amRing<Capacity, SlotSize, Policy>::push(const void* data, uint16_t len)
+{
+   uint32_t tail = _tail.load(std::memory_order_relaxed); // Only this side writes it.
+   slot &s = _slots[tail & (Capacity - 1)];
+   if(len > SlotSize)
+   {
+      _rejected.store(_rejected.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return false;
+   } // if
+   if(s.seq.load(std::memory_order_acquire) != tail) // Slot still holds the entry from one lap ago.
+   {
+      if(Policy == RING_DROP_OLDEST)
+      {
+         uint32_t head = tail - Capacity;
+         if(_head.compare_exchange_strong(head, head + 1, std::memory_order_acq_rel)) // Beat the consumer to it.
+         {
+            _slots[head & (Capacity - 1)].seq.store(head + Capacity, std::memory_order_release);
+            _dropped.store(_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+         } // if
+      } // if
+      if(s.seq.load(std::memory_order_acquire) != tail) // Full, or the consumer is still copying this slot out.
+      {
+         _rejected.store(_rejected.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+         return false;
+      } // if
+   } // if
+   memcpy(s.data, data, len);
+   s.len = len;
+   s.seq.store(tail + 1, std::memory_order_release); // Publish the entry.
+   _tail.store(tail + 1, std::memory_order_relaxed);
+   _pushed.store(_pushed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+   return true;
+} // amRing::push()
+
+/**
+ * @brief Take the oldest entry. Call from the consumer only.
+ * @param dest Where to copy the entry.
+ * @param size Room in dest. A longer entry is cut short.
+ * @param len Where to put the number of bytes copied.
+ * @return false if the ring was empty.
+===================================================================================================*/
+template <uint16_t Capacity, uint16_t SlotSize, uint8_t Policy> bool amRing<Capacity, SlotSize, Policy>::pop(void* dest, uint16_t size, uint16_t* len)
+{
+   for(;;)
+   {
+      uint32_t head = _head.load(std::memory_order_acquire);
+      slot &s = _slots[head & (Capacity - 1)];
+      if(s.seq.load(std::memory_order_acquire) != head + 1) // Nothing published here yet.
+      {
+         return false;
+      } // if
+      if(Policy == RING_DROP_OLDEST)
+      {
+         if(_head.compare_exchange_strong(head, head + 1, std::memory_order_acq_rel) == false) // Producer dropped it first.
+         {
+            continue;
+         } // if
+      } // if
+      else
+      {
+         _head.store(head + 1, std::memory_order_relaxed); // Only this side writes it.
+      } // else
+      uint16_t n = (s.len < size) ? s.len : size;
+      memcpy(dest, s.data, n);
+      *len = n;
+      s.seq.store(head + Capacity, std::memory_order_release); // Hand the slot back to the producer.
+      return true;
+   } // for
+} // amRing::pop()
+
+/**
+ * @brief Check for waiting entries.
+ * @return true if there is nothing to pop.
+===================================================================================================*/
+template <uint16_t Capacity, uint16_t SlotSize, uint8_t Policy> bool amRing<Capacity, SlotSize, Policy>::isEmpty()
+{
+   uint32_t head = _head.load(std::memory_order_acquire);
+   return _slots[head & (Capacity - 1)].seq.load(std::memory_order_acquire) != head + 1;
+} // amRing::isEmpty()
+
+/**
+ * @brief Count waiting entries.
+ * @return Entries pushed and not yet popped or dropped.
+===================================================================================================*/
+template <uint16_t Capacity, uint16_t SlotSize, uint8_t Policy> uint16_t amRing<Capacity, SlotSize, Policy>::getCount()
+{
+   uint32_t count = _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+   return (count > Capacity) ? Capacity : (uint16_t)count;
+} // amRing::getCount()
+
+#endif // End of precompiler protected code block
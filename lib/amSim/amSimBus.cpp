@@ -0,0 +1,126 @@
+/*************************************************************************************************************************************
+ * @file amSimBus.cpp
+ * @author va3wam
+ * @brief Simulated I2C bus for host side testing.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <amSimBus.h> // Header file for linking.
+
+/**
+ * @brief This is the constructor for this class.
+===================================================================================================*/
+amSimBus::amSimBus()
+{
+   for(uint8_t i = 0; i < SIM_BUS_MAX_DEVICES; i++)
+   {
+      _devices[i] = nullptr;
+   } // for
+} // amSimBus::amSimBus()
+
+/**
+ * @brief Put a device on the bus.
+ * @param device Device to attach. Must outlive the bus.
+ * @return false if the bus is full.
+===================================================================================================*/
+bool amSimBus::attach(amSimDevice &device)
+{
+   if(_numDevices >= SIM_BUS_MAX_DEVICES)
+   {
+      return false;
+   } // if
+   _devices[_numDevices++] = &device;
+   return true;
+} // amSimBus::attach()
+
+/**
+ * @brief Write a block of registers in one transaction.
+ * @return I2C_OK or I2C_ERR_NACK_ADDR if nothing answers at the address.
+===================================================================================================*/
+uint8_t amSimBus::writeRegs(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t len)
+{
+   _transactions++;
+   amSimDevice* device = _find(address);
+   if(device == nullptr)
+   {
+      return I2C_ERR_NACK_ADDR;
+   } // if
+   _writes++;
+   _bytesWritten += len;
+   device->writeRegs(reg, data, len);
+   return I2C_OK;
+} // amSimBus::writeRegs()
+
+/**
+ * @brief Read a block of registers in one transaction.
+ * @return I2C_OK or I2C_ERR_NACK_ADDR if nothing answers at the address.
+===================================================================================================*/
+uint8_t amSimBus::readRegs(uint8_t address, uint8_t reg, uint8_t* dest, uint8_t len)
+{
+   _transactions++;
+   amSimDevice* device = _find(address);
+   if(device == nullptr)
+   {
+      return I2C_ERR_NACK_ADDR;
+   } // if
+   _reads++;
+   _bytesRead += len;
+   device->readRegs(reg, dest, len);
+   return I2C_OK;
+} // amSimBus::readRegs()
+
+/**
+ * @brief Check for a device at the specified address.
+ * @return I2C_OK if a device is attached at the address.
+===================================================================================================*/
+uint8_t amSimBus::probe(uint8_t address)
+{
+   _transactions++;
+   return (_find(address) == nullptr) ? I2C_ERR_NACK_ADDR : I2C_OK;
+} // amSimBus::probe()
+
+uint32_t amSimBus::getTransactions() { return _transactions; } // amSimBus::getTransactions()
+uint32_t amSimBus::getReads() { return _reads; } // amSimBus::getReads()
+uint32_t amSimBus::getWrites() { return _writes; } // amSimBus::getWrites()
+uint32_t amSimBus::getBytesRead() { return _bytesRead; } // amSimBus::getBytesRead()
+uint32_t amSimBus::getBytesWritten() { return _bytesWritten; } // amSimBus::getBytesWritten()
+
+/**
+ * @brief Zero all transaction and byte counters.
+===================================================================================================*/
+void amSimBus::resetCounters()
+{
+   _transactions = 0;
+   _reads = 0;
+   _writes = 0;
+   _bytesRead = 0;
+   _bytesWritten = 0;
+} // amSimBus::resetCounters()
+
+/**
+ * @brief Find the device attached at an address.
+ * @return The device or nullptr if nothing is attached there.
+===================================================================================================*/
+amSimDevice* amSimBus::_find(uint8_t address)
+{
+   for(uint8_t i = 0; i < _numDevices; i++)
+   {
+      if(_devices[i]->getAddress() == address)
+      {
+         return _devices[i];
+      } // if
+   } // for
+   return nullptr;
+} // amSimBus::_find()
@@ -0,0 +1,71 @@
+/*************************************************************************************************************************************
+ * @file amSimBus.h
+ * @author va3wam
+ * @brief Simulated I2C bus for host side testing.
+ * @details Implements amI2cBus by routing each transaction to a simulated device attached at the matching address. Counts
+ * transactions and bytes so tests can check how much bus time a driver uses.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amSimBus_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amSimBus_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <amI2cBus.h> // Register level I2C bus interface.
+
+#define SIM_BUS_MAX_DEVICES 8 // Most devices one simulated bus can hold.
+
+/*************************************************************************************************************************************
+ * @class A register mapped device that can be attached to an amSimBus.
+ *************************************************************************************************************************************/
+class amSimDevice
+{
+   public:
+      virtual ~amSimDevice() {} // Class destructor.
+      virtual uint8_t getAddress() = 0; // 7 bit I2C address the device answers to.
+      virtual void writeRegs(uint8_t reg, const uint8_t* data, uint8_t len) = 0; // Bus master wrote len bytes from reg.
+      virtual void readRegs(uint8_t reg, uint8_t* dest, uint8_t len) = 0; // Bus master read len bytes from reg.
+}; // class amSimDevice
+
+/*************************************************************************************************************************************
+ * @class Simulated I2C bus.
+ *************************************************************************************************************************************/
+class amSimBus : public amI2cBus
+{
+   public:
+      amSimBus(); // Class constructor.
+      bool attach(amSimDevice &device); // Put a device on the bus.
+      uint8_t writeRegs(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t len); // Write len bytes from reg.
+      uint8_t readRegs(uint8_t address, uint8_t reg, uint8_t* dest, uint8_t len); // Read len bytes from reg.
+      uint8_t probe(uint8_t address); // Address only transaction.
+      uint32_t getTransactions(); // Transactions of any kind since the last reset.
+      uint32_t getReads(); // Register read transactions since the last reset.
+      uint32_t getWrites(); // Register write transactions since the last reset.
+      uint32_t getBytesRead(); // Data bytes read since the last reset.
+      uint32_t getBytesWritten(); // Data bytes written since the last reset.
+      void resetCounters(); // Zero all counters.
+   private:
+      amSimDevice* _find(uint8_t address); // Device at address or nullptr.
+      amSimDevice* _devices[SIM_BUS_MAX_DEVICES]; // Attached devices.
+      uint8_t _numDevices = 0; // Number of attached devices.
+      uint32_t _transactions = 0; // Transactions of any kind.
+      uint32_t _reads = 0; // Register read transactions.
+      uint32_t _writes = 0; // Register write transactions.
+      uint32_t _bytesRead = 0; // Data bytes read.
+      uint32_t _bytesWritten = 0; // Data bytes written.
+}; // class amSimBus
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,295 @@
+/*************************************************************************************************************************************
+ * @file amSimMD25.cpp
+ * @author va3wam
+ * @brief Simulated MD25 motor controller for host side testing.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Added acceleration register ramping and externally driven encoders for amSimPlant
+ * 2026-10-17 va3wam Added the 2 second I2C watchdog
+ *************************************************************************************************************************************/
+#include <amSimMD25.h> // Header file for linking.
+
+/**
+ * @brief This is the constructor for this class.
+ * @param address 7 bit I2C address to answer to.
+===================================================================================================*/
+amSimMD25::amSimMD25(uint8_t address) : _address(address)
+{
+   for(uint8_t i = 0; i < MD25NumRegs; i++)
+   {
+      _regs[i] = 0;
+   } // for
+   _regs[MD25RegSpeed1] = MD25SpeedStop; // Power on state is stopped.
+   _regs[MD25RegSpeed2] = MD25SpeedStop;
+   _regs[MD25RegBatteryVolts] = 120; // 12.0V.
+   _regs[MD25RegSoftwareRev] = SIM_MD25_SOFTWARE_REV;
+   _regs[MD25RegMotorAccel] = 5; // Datasheet default.
+   _regs[MD25RegMode] = MD25ModeUnsigned;
+} // amSimMD25::amSimMD25()
+
+/**
+ * @brief Report the address the simulated controller answers to.
+===================================================================================================*/
+uint8_t amSimMD25::getAddress()
+{
+   return _address;
+} // amSimMD25::getAddress()
+
+/**
+ * @brief Handle a register write from the bus master.
+ * @details Only speed1, speed2, acceleration, mode and command are writable. Writes to the command
+ * register act on the command rather than storing it.
+===================================================================================================*/
+void amSimMD25::writeRegs(uint8_t reg, const uint8_t* data, uint8_t len)
+{
+   _quietMs = 0;
+   for(uint8_t i = 0; i < len; i++, reg++)
+   {
+      switch(reg)
+      {
+         case MD25RegSpeed1:
+         case MD25RegSpeed2:
+         case MD25RegMotorAccel:
+         case MD25RegMode:
+            _regs[reg] = data[i];
+            break;
+         case MD25RegCmd:
+            if(data[i] == MD25CmdResetEncoders)
+            {
+               _encoder[MD25_MOTOR1] = 0;
+               _encoder[MD25_MOTOR2] = 0;
+            } // if
+            else if(data[i] == MD25CmdAutoTimeoutOff || data[i] == MD25CmdAutoTimeoutOn)
+            {
+               _watchdog = (data[i] == MD25CmdAutoTimeoutOn);
+            } // else if
+            break;
+         default: // Read only register or off the end of the map.
+            break;
+      } // switch
+   } // for
+} // amSimMD25::writeRegs()
+
+/**
+ * @brief Handle a register read from the bus master.
+ * @details Both encoders are latched at the start of the read so a multi-byte read sees one
+ * consistent count.
+===================================================================================================*/
+void amSimMD25::readRegs(uint8_t reg, uint8_t* dest, uint8_t len)
+{
+   _quietMs = 0;
+   _latched[MD25_MOTOR1] = getEncoder(MD25_MOTOR1);
+   _latched[MD25_MOTOR2] = getEncoder(MD25_MOTOR2);
+   for(uint8_t i = 0; i < len; i++, reg++)
+   {
+      dest[i] = _regValue(reg);
+   } // for
+} // amSimMD25::readRegs()
+
+/**
+ * @brief Move simulated time forward.
+ * @details Wheels turn at a speed proportional to the signed motor output. With ramping on, the
+ * output steps towards the command by the acceleration register value every SIM_MD25_RAMP_MS, as
+ * the MD25 does: a value of 5 takes 1.275 seconds from full reverse to full forward.
+ * @param ms Milliseconds to advance.
+===================================================================================================*/
+void amSimMD25::advance(uint32_t ms)
+{
+   for(uint32_t i = 0; i < ms; i++)
+   {
+      if(_watchdog && ++_quietMs == SIM_MD25_WATCHDOG_MS) // Heard nothing for too long. Stop, once.
+      {
+         _regs[MD25RegSpeed1] = (_regs[MD25RegMode] & 1) ? 0 : MD25SpeedStop;
+         _regs[MD25RegSpeed2] = (_regs[MD25RegMode] & 1) ? 0 : MD25SpeedStop;
+         _watchdogTrips++;
+      } // if
+      if(_ramp && ++_rampMs >= SIM_MD25_RAMP_MS)
+      {
+         _rampMs = 0;
+         int16_t step = (_regs[MD25RegMotorAccel] == 0) ? 1 : _regs[MD25RegMotorAccel];
+         for(uint8_t motor = MD25_MOTOR1; motor <= MD25_MOTOR2; motor++)
+         {
+            int16_t target = getMotorCommand(motor);
+            if(_output[motor] < target)
+            {
+               _output[motor] = (target - _output[motor] < step) ? target : _output[motor] + step;
+            } // if
+            else if(_output[motor] > target)
+            {
+               _output[motor] = (_output[motor] - target < step) ? target : _output[motor] - step;
+            } // else if
+         } // for
+      } // if
+      for(uint8_t motor = MD25_MOTOR1; motor <= MD25_MOTOR2; motor++)
+      {
+         _encoder[motor] += getMotorOutput(motor) * _ticksPerUnit / 1000.0;
+      } // for
+   } // for
+} // amSimMD25::advance()
+
+/**
+ * @brief Turn acceleration ramping on or off.
+ * @details Off, the output follows the speed registers at once, which keeps tests of move timing
+ * simple. On, it starts from the current command.
+ * @param enable true to ramp.
+===================================================================================================*/
+void amSimMD25::setAccelRamp(bool enable)
+{
+   _ramp = enable;
+   _rampMs = 0;
+   _output[MD25_MOTOR1] = getMotorCommand(MD25_MOTOR1);
+   _output[MD25_MOTOR2] = getMotorCommand(MD25_MOTOR2);
+} // amSimMD25::setAccelRamp()
+
+/**
+ * @brief Turn the I2C watchdog on or off.
+ * @details The MD25 powers up with it on and stops both motors when it has had no I2C transaction
+ * for 2 seconds. Modelled by setting both speed registers to stop. Off by default
+ * here so that tests that leave the bus quiet are not surprised. The auto timeout commands turn it
+ * on and off as well.
+ * @param enable true to model the watchdog.
+===================================================================================================*/
+void amSimMD25::setWatchdog(bool enable)
+{
+   _watchdog = enable;
+   _quietMs = 0;
+} // amSimMD25::setWatchdog()
+
+/**
+ * @brief Set an encoder position directly.
+ * @details For a physics model that works out how far the wheel has turned. Use with
+ * setTicksPerUnit(0) so that advance() does not move the wheel as well.
+ * @param motor MD25_MOTOR1 or MD25_MOTOR2.
+ * @param ticks Position in ticks. The count reported is truncated toward 0.
+===================================================================================================*/
+void amSimMD25::setEncoderTicks(uint8_t motor, double ticks)
+{
+   _encoder[motor] = ticks;
+} // amSimMD25::setEncoderTicks()
+
+/**
+ * @brief Signed drive actually applied to a motor.
+ * @param motor MD25_MOTOR1 or MD25_MOTOR2.
+ * @return -128 (full reverse) to 127 (full forward). Same as getMotorCommand() unless ramping.
+===================================================================================================*/
+int16_t amSimMD25::getMotorOutput(uint8_t motor)
+{
+   return _ramp ? _output[motor] : getMotorCommand(motor);
+} // amSimMD25::getMotorOutput()
+
+/**
+ * @brief Set wheel speed per unit of motor command.
+ * @param ticksPerUnit Encoder ticks per second per speed unit. 0 simulates stalled wheels.
+===================================================================================================*/
+void amSimMD25::setTicksPerUnit(double ticksPerUnit)
+{
+   _ticksPerUnit = ticksPerUnit;
+} // amSimMD25::setTicksPerUnit()
+
+/**
+ * @brief Set the value of the battery volts register.
+ * @param tenthsOfVolts Battery voltage * 10.
+===================================================================================================*/
+void amSimMD25::setBatteryVolts(uint8_t tenthsOfVolts)
+{
+   _regs[MD25RegBatteryVolts] = tenthsOfVolts;
+} // amSimMD25::setBatteryVolts()
+
+/**
+ * @brief Set the value of the motor current registers.
+ * @param current1 Motor1 current * 10.
+ * @param current2 Motor2 current * 10.
+===================================================================================================*/
+void amSimMD25::setMotorCurrents(uint8_t current1, uint8_t current2)
+{
+   _regs[MD25RegMotorCur1] = current1;
+   _regs[MD25RegMotorCur2] = current2;
+} // amSimMD25::setMotorCurrents()
+
+/**
+ * @brief Raw value of a register, encoders included.
+===================================================================================================*/
+uint8_t amSimMD25::getReg(uint8_t reg)
+{
+   _latched[MD25_MOTOR1] = getEncoder(MD25_MOTOR1);
+   _latched[MD25_MOTOR2] = getEncoder(MD25_MOTOR2);
+   return _regValue(reg);
+} // amSimMD25::getReg()
+
+/**
+ * @brief Current whole tick count of an encoder.
+ * @param motor MD25_MOTOR1 or MD25_MOTOR2.
+===================================================================================================*/
+int32_t amSimMD25::getEncoder(uint8_t motor)
+{
+   double ticks = _encoder[motor];
+   return (int32_t)((ticks < 0) ? -(int64_t)(-ticks) : (int64_t)ticks); // Truncate toward 0 like a real counter.
+} // amSimMD25::getEncoder()
+
+/**
+ * @brief Signed drive the mode and speed registers give a motor.
+ * @details Modes 2 and 3 mix speed1 (speed) and speed2 (turn): motor1 = speed + turn,
+ * motor2 = speed - turn.
+ * @param motor MD25_MOTOR1 or MD25_MOTOR2.
+ * @return -128 (full reverse) to 127 (full forward).
+===================================================================================================*/
+int16_t amSimMD25::getMotorCommand(uint8_t motor)
+{
+   int16_t speed1;
+   int16_t speed2;
+   switch(_regs[MD25RegMode])
+   {
+      case MD25ModeSigned:
+      case MD25ModeTurnSigned:
+         speed1 = (int8_t)_regs[MD25RegSpeed1];
+         speed2 = (int8_t)_regs[MD25RegSpeed2];
+         break;
+      default:
+         speed1 = (int16_t)_regs[MD25RegSpeed1] - MD25SpeedStop;
+         speed2 = (int16_t)_regs[MD25RegSpeed2] - MD25SpeedStop;
+         break;
+   } // switch
+   int16_t command;
+   if(_regs[MD25RegMode] == MD25ModeTurnUnsigned || _regs[MD25RegMode] == MD25ModeTurnSigned)
+   {
+      command = (motor == MD25_MOTOR1) ? speed1 + speed2 : speed1 - speed2;
+   } // if
+   else
+   {
+      command = (motor == MD25_MOTOR1) ? speed1 : speed2;
+   } // else
+   if(command > 127) command = 127;
+   if(command < -128) command = -128;
+   return command;
+} // amSimMD25::getMotorCommand()
+
+/**
+ * @brief Register value as seen on the bus.
+ * @details Encoder registers return the latched counts, most significant byte first.
+===================================================================================================*/
+uint8_t amSimMD25::_regValue(uint8_t reg)
+{
+   if(reg >= MD25RegEncoder1a && reg <= MD25RegEncoder2d)
+   {
+      uint8_t motor = (reg < MD25RegEncoder2a) ? MD25_MOTOR1 : MD25_MOTOR2;
+      uint8_t shift = (3 - ((reg - MD25RegEncoder1a) % 4)) * 8;
+      return (uint8_t)((uint32_t)_latched[motor] >> shift);
+   } // if
+   if(reg < MD25NumRegs)
+   {
+      return _regs[reg];
+   } // if
+   return 0; // Off the end of the map.
+} // amSimMD25::_regValue()
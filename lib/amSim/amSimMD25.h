@@ -0,0 +1,75 @@
+/*************************************************************************************************************************************
+ * @file amSimMD25.h
+ * @author va3wam
+ * @brief Simulated MD25 motor controller for host side testing.
+ * @details Holds the MD25 register map and turns the speed and mode registers into encoder counts as simulated time passes. The
+ * register pointer auto-increments across reads and writes the same way the real controller does.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Added acceleration register ramping and externally driven encoders for amSimPlant
+ * 2026-10-17 va3wam Added the 2 second I2C watchdog
+ *************************************************************************************************************************************/
+#ifndef amSimMD25_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amSimMD25_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <amSimBus.h> // Simulated I2C bus.
+#include <amMD25Regs.h> // MD25 register map.
+
+#define SIM_MD25_ADDRESS 0x58 // Default 7 bit address of the MD25 (0xB0 >> 1).
+#define SIM_MD25_SOFTWARE_REV 9 // Value reported in the software revision register.
+#define SIM_MD25_TICKS_PER_UNIT 8.0 // Encoder ticks per second per speed unit. EMG30 is ~1020 ticks/s at full speed.
+#define SIM_MD25_RAMP_MS 25 // Output moves by the acceleration register value once per this many milliseconds.
+#define SIM_MD25_WATCHDOG_MS 2000 // Motors are stopped after this long with no I2C transaction.
+
+/*************************************************************************************************************************************
+ * @class Simulated MD25 dual h-bridge motor controller.
+ *************************************************************************************************************************************/
+class amSimMD25 : public amSimDevice
+{
+   public:
+      amSimMD25(uint8_t address = SIM_MD25_ADDRESS); // Class constructor.
+      uint8_t getAddress(); // 7 bit I2C address the device answers to.
+      void writeRegs(uint8_t reg, const uint8_t* data, uint8_t len); // Bus master wrote len bytes from reg.
+      void readRegs(uint8_t reg, uint8_t* dest, uint8_t len); // Bus master read len bytes from reg.
+      void advance(uint32_t ms); // Move simulated time forward.
+      void setTicksPerUnit(double ticksPerUnit); // Wheel speed per speed unit. 0 simulates stalled wheels.
+      void setAccelRamp(bool enable); // Ramp the output as the acceleration register says. Off by default.
+      void setWatchdog(bool enable); // Stop the motors after SIM_MD25_WATCHDOG_MS of I2C silence. Off by default.
+      uint32_t getWatchdogTrips() { return _watchdogTrips; } // amSimMD25::getWatchdogTrips()
+      void setEncoderTicks(uint8_t motor, double ticks); // Move a wheel, for a physics model that turns it.
+      void setBatteryVolts(uint8_t tenthsOfVolts); // Value of the battery volts register.
+      void setMotorCurrents(uint8_t current1, uint8_t current2); // Value of the motor current registers.
+      uint8_t getReg(uint8_t reg); // Raw register value.
+      int32_t getEncoder(uint8_t motor); // Current count of MD25_MOTOR1 or MD25_MOTOR2.
+      int16_t getMotorCommand(uint8_t motor); // Signed drive (-128 to 127) the mode and speed registers give a motor.
+      int16_t getMotorOutput(uint8_t motor); // Signed drive actually applied, after acceleration ramping.
+   private:
+      uint8_t _regValue(uint8_t reg); // Register value including live encoder bytes.
+      uint8_t _address; // 7 bit I2C address.
+      uint8_t _regs[MD25NumRegs]; // Register map.
+      double _encoder[2] = {0, 0}; // Encoder positions in ticks.
+      int32_t _latched[2] = {0, 0}; // Encoder counts latched at the start of a read.
+      double _ticksPerUnit = SIM_MD25_TICKS_PER_UNIT; // Wheel speed per speed unit.
+      bool _ramp = false; // Model the acceleration register.
+      int16_t _output[2] = {0, 0}; // Drive applied to each motor while ramping.
+      uint32_t _rampMs = 0; // Milliseconds towards the next ramp step.
+      bool _watchdog = false; // Model the I2C watchdog.
+      uint32_t _quietMs = 0; // Milliseconds since the last transaction.
+      uint32_t _watchdogTrips = 0; // Times the watchdog stopped the motors.
+}; // class amSimMD25
+
+#endif // End of precompiler protected code block
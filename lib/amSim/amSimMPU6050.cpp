@@ -0,0 +1,252 @@
+/*************************************************************************************************************************************
+ * @file amSimMPU6050.cpp
+ * @author va3wam
+ * @brief Simulated MPU6050 accelerometer and gyro for host side testing.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <amSimMPU6050.h> // Header file for linking.
+
+static const float SIM_MPU6050_GYRO_LSB[4] = {131.0f, 65.5f, 32.8f, 16.4f}; // LSB per degree/second for each FS_SEL.
+static const float SIM_MPU6050_ACCEL_LSB[4] = {16384.0f, 8192.0f, 4096.0f, 2048.0f}; // LSB per g for each AFS_SEL.
+
+/**
+ * @brief Convert a reading to a raw register value, saturating as the chip does.
+===================================================================================================*/
+static int16_t simMpuRaw(float value)
+{
+   if(value >= 32767.0f)
+   {
+      return 32767;
+   } // if
+   if(value <= -32768.0f)
+   {
+      return -32768;
+   } // if
+   return (int16_t)(value < 0.0f ? value - 0.5f : value + 0.5f);
+} // simMpuRaw()
+
+/**
+ * @brief This is the constructor for this class.
+ * @details Registers take their power on values. The chip starts asleep.
+ * @param address 7 bit I2C address to answer to.
+===================================================================================================*/
+amSimMPU6050::amSimMPU6050(uint8_t address) : _address(address)
+{
+   for(uint16_t i = 0; i < SIM_MPU6050_NUM_REGS; i++)
+   {
+      _regs[i] = 0;
+   } // for
+   _regs[MPU6050RegPwrMgmt1] = SIM_MPU6050_PWR_SLEEP;
+   _regs[MPU6050RegWhoAmI] = MPU6050WhoAmI;
+} // amSimMPU6050::amSimMPU6050()
+
+uint8_t amSimMPU6050::getAddress() { return _address; } // amSimMPU6050::getAddress()
+uint16_t amSimMPU6050::getFifoCount() { return _fifoCount; } // amSimMPU6050::getFifoCount()
+uint32_t amSimMPU6050::getSamples() { return _samples; } // amSimMPU6050::getSamples()
+uint8_t amSimMPU6050::getReg(uint8_t reg) { return (reg < SIM_MPU6050_NUM_REGS) ? _regs[reg] : 0; } // amSimMPU6050::getReg()
+
+/**
+ * @brief Bus master wrote a block of registers.
+ * @details The FIFO reset bit empties the FIFO and clears itself. Writes to the FIFO data register
+ * are ignored, as are writes past the end of the map.
+===================================================================================================*/
+void amSimMPU6050::writeRegs(uint8_t reg, const uint8_t* data, uint8_t len)
+{
+   for(uint8_t i = 0; i < len; i++, reg++)
+   {
+      if(reg >= SIM_MPU6050_NUM_REGS || reg == MPU6050RegFifoRW || reg == MPU6050RegWhoAmI)
+      {
+         continue;
+      } // if
+      _regs[reg] = data[i];
+      if(reg == MPU6050RegUserCtrl && (data[i] & MPU6050UserFifoReset) != 0)
+      {
+         _fifoHead = 0;
+         _fifoCount = 0;
+         _regs[reg] &= ~MPU6050UserFifoReset; // Clears itself.
+      } // if
+   } // for
+} // amSimMPU6050::writeRegs()
+
+/**
+ * @brief Bus master read a block of registers.
+ * @details Reads of the FIFO data register pop the FIFO without moving the register pointer.
+ * Reading INT_STATUS clears it.
+===================================================================================================*/
+void amSimMPU6050::readRegs(uint8_t reg, uint8_t* dest, uint8_t len)
+{
+   if(reg == MPU6050RegFifoRW)
+   {
+      for(uint8_t i = 0; i < len; i++)
+      {
+         dest[i] = _fifoPop();
+      } // for
+      return;
+   } // if
+   for(uint8_t i = 0; i < len; i++, reg++)
+   {
+      if(reg >= SIM_MPU6050_NUM_REGS)
+      {
+         dest[i] = 0;
+         continue;
+      } // if
+      if(reg == MPU6050RegFifoCountH)
+      {
+         dest[i] = (uint8_t)(_fifoCount >> 8);
+      } // if
+      else if(reg == MPU6050RegFifoCountH + 1)
+      {
+         dest[i] = (uint8_t)(_fifoCount & 0xFF);
+      } // else if
+      else
+      {
+         dest[i] = _regs[reg];
+      } // else
+      if(reg == MPU6050RegIntStatus)
+      {
+         _regs[reg] = 0; // Cleared by reading.
+      } // if
+   } // for
+} // amSimMPU6050::readRegs()
+
+/**
+ * @brief Set what the sensors feel. Scaled to raw counts using the configured ranges.
+ * @param accelX Acceleration along X in g. Likewise Y and Z.
+ * @param gyroX Rotation about X in degrees/second. Likewise Y and Z.
+===================================================================================================*/
+void amSimMPU6050::setMotion(float accelX, float accelY, float accelZ, float gyroX, float gyroY, float gyroZ)
+{
+   _accel[0] = accelX;
+   _accel[1] = accelY;
+   _accel[2] = accelZ;
+   _gyro[0] = gyroX;
+   _gyro[1] = gyroY;
+   _gyro[2] = gyroZ;
+   _useRaw = false;
+} // amSimMPU6050::setMotion()
+
+/**
+ * @brief Set what the sensors report, in raw counts, for callers that model noise and quantization.
+===================================================================================================*/
+void amSimMPU6050::setRaw(const int16_t accel[3], const int16_t gyro[3])
+{
+   for(uint8_t i = 0; i < 3; i++)
+   {
+      _rawAccel[i] = accel[i];
+      _rawGyro[i] = gyro[i];
+   } // for
+   _useRaw = true;
+} // amSimMPU6050::setRaw()
+
+/**
+ * @brief Sample rate set by SMPLRT_DIV and CONFIG.
+ * @return Samples per second. The gyro runs at 8kHz with the low pass filter off, 1kHz with it on.
+===================================================================================================*/
+uint32_t amSimMPU6050::getSampleRateHz()
+{
+   uint32_t gyroRate = ((_regs[MPU6050RegConfig] & 0x07) == MPU6050_DLPF_260HZ) ? 8000 : 1000;
+   return gyroRate / (1 + _regs[MPU6050RegSmplrtDiv]);
+} // amSimMPU6050::getSampleRateHz()
+
+/**
+ * @brief Move simulated time forward, taking every sample that falls in the interval.
+ * @param us Microseconds of simulated time.
+ * @return Number of samples taken. 0 while the chip is asleep.
+===================================================================================================*/
+uint16_t amSimMPU6050::advance(uint32_t us)
+{
+   if((_regs[MPU6050RegPwrMgmt1] & SIM_MPU6050_PWR_SLEEP) != 0)
+   {
+      _usToSample = 0;
+      return 0;
+   } // if
+   uint32_t period = 1000000 / getSampleRateHz();
+   if(_usToSample == 0) // Just woke up. First sample is one period away.
+   {
+      _usToSample = period;
+   } // if
+   uint16_t taken = 0;
+   while(us >= _usToSample)
+   {
+      us -= _usToSample;
+      _usToSample = period;
+      _sample();
+      taken++;
+   } // while
+   _usToSample -= us;
+   return taken;
+} // amSimMPU6050::advance()
+
+/**
+ * @brief Take one sample into the sensor registers and, if enabled, the FIFO.
+===================================================================================================*/
+void amSimMPU6050::_sample()
+{
+   int16_t raw[7];
+   float gyroLsb = SIM_MPU6050_GYRO_LSB[(_regs[MPU6050RegGyroConfig] >> 3) & 0x03];
+   float accelLsb = SIM_MPU6050_ACCEL_LSB[(_regs[MPU6050RegAccelConfig] >> 3) & 0x03];
+   for(uint8_t i = 0; i < 3; i++)
+   {
+      raw[i] = _useRaw ? _rawAccel[i] : simMpuRaw(_accel[i] * accelLsb);
+      raw[4 + i] = _useRaw ? _rawGyro[i] : simMpuRaw(_gyro[i] * gyroLsb);
+   } // for
+   raw[3] = SIM_MPU6050_TEMP_RAW;
+   for(uint8_t i = 0; i < 7; i++) // Big-endian, accel xyz, temp, gyro xyz.
+   {
+      _regs[MPU6050RegAccelXoutH + 2 * i] = (uint8_t)((uint16_t)raw[i] >> 8);
+      _regs[MPU6050RegAccelXoutH + 2 * i + 1] = (uint8_t)(raw[i] & 0xFF);
+   } // for
+   if((_regs[MPU6050RegUserCtrl] & MPU6050UserFifoEnable) != 0 && _regs[MPU6050RegFifoEn] == MPU6050FifoSensors)
+   {
+      for(uint8_t i = 0; i < MPU6050_SAMPLE_LEN; i++)
+      {
+         _fifoPush(_regs[MPU6050RegAccelXoutH + i]);
+      } // for
+   } // if
+   _regs[MPU6050RegIntStatus] |= MPU6050IntDataReady;
+   _samples++;
+} // amSimMPU6050::_sample()
+
+/**
+ * @brief Add one byte to the FIFO. A full FIFO drops its oldest byte and flags the overflow.
+===================================================================================================*/
+void amSimMPU6050::_fifoPush(uint8_t value)
+{
+   if(_fifoCount == MPU6050_FIFO_SIZE)
+   {
+      _fifoHead = (_fifoHead + 1) % MPU6050_FIFO_SIZE;
+      _fifoCount--;
+      _regs[MPU6050RegIntStatus] |= MPU6050IntFifoOverflow;
+   } // if
+   _fifo[(_fifoHead + _fifoCount) % MPU6050_FIFO_SIZE] = value;
+   _fifoCount++;
+} // amSimMPU6050::_fifoPush()
+
+/**
+ * @brief Take one byte from the FIFO.
+ * @return The oldest byte, or 0 if the FIFO is empty.
+===================================================================================================*/
+uint8_t amSimMPU6050::_fifoPop()
+{
+   if(_fifoCount == 0)
+   {
+      return 0;
+   } // if
+   uint8_t value = _fifo[_fifoHead];
+   _fifoHead = (_fifoHead + 1) % MPU6050_FIFO_SIZE;
+   _fifoCount--;
+   return value;
+} // amSimMPU6050::_fifoPop()
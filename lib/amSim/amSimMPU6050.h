@@ -0,0 +1,71 @@
+/*************************************************************************************************************************************
+ * @file amSimMPU6050.h
+ * @author va3wam
+ * @brief Simulated MPU6050 accelerometer and gyro for host side testing.
+ * @details Answers register reads and writes the way the chip does for the registers amMPU6050 uses. Each call to advance() adds
+ * the samples the configured sample rate would have produced to the sensor registers and, when enabled, the 1024 byte FIFO. Like
+ * the chip, a full FIFO drops its oldest bytes, so the byte stream no longer lines up with sample boundaries.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amSimMPU6050_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amSimMPU6050_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <amSimBus.h> // Simulated I2C bus.
+#include <amMPU6050Regs.h> // MPU6050 register map.
+
+#define SIM_MPU6050_ADDRESS 0x68 // Default 7 bit address (AD0 low).
+#define SIM_MPU6050_NUM_REGS 128 // Size of the register map.
+#define SIM_MPU6050_PWR_SLEEP 0x40 // PWR_MGMT_1 sleep bit. Set at power on.
+#define SIM_MPU6050_TEMP_RAW -3920 // Raw die temperature for 25C.
+
+/*************************************************************************************************************************************
+ * @class Simulated MPU6050 accelerometer and gyro.
+ *************************************************************************************************************************************/
+class amSimMPU6050 : public amSimDevice
+{
+   public:
+      amSimMPU6050(uint8_t address = SIM_MPU6050_ADDRESS); // Class constructor.
+      uint8_t getAddress(); // 7 bit I2C address the device answers to.
+      void writeRegs(uint8_t reg, const uint8_t* data, uint8_t len); // Bus master wrote len bytes from reg.
+      void readRegs(uint8_t reg, uint8_t* dest, uint8_t len); // Bus master read len bytes from reg.
+      void setMotion(float accelX, float accelY, float accelZ, float gyroX, float gyroY, float gyroZ); // What the sensors feel, in g and degrees/second.
+      void setRaw(const int16_t accel[3], const int16_t gyro[3]); // What the sensors report, in raw counts.
+      uint16_t advance(uint32_t us); // Move simulated time forward. Returns samples taken.
+      uint32_t getSampleRateHz(); // Rate set by SMPLRT_DIV and CONFIG.
+      uint16_t getFifoCount(); // Bytes waiting in the FIFO.
+      uint32_t getSamples(); // Samples taken since power on.
+      uint8_t getReg(uint8_t reg); // Raw register value.
+   private:
+      void _sample(); // Take one sample.
+      void _fifoPush(uint8_t value); // Add one byte to the FIFO.
+      uint8_t _fifoPop(); // Take one byte from the FIFO.
+      uint8_t _address; // 7 bit I2C address.
+      uint8_t _regs[SIM_MPU6050_NUM_REGS]; // Register map.
+      uint8_t _fifo[MPU6050_FIFO_SIZE]; // FIFO contents.
+      uint16_t _fifoHead = 0; // Next byte out.
+      uint16_t _fifoCount = 0; // Bytes held.
+      float _accel[3] = {0.0f, 0.0f, 1.0f}; // Accelerometer input in g.
+      float _gyro[3] = {0.0f, 0.0f, 0.0f}; // Gyro input in degrees/second.
+      bool _useRaw = false; // setRaw() was called after setMotion().
+      int16_t _rawAccel[3] = {0, 0, 0}; // Raw accelerometer input.
+      int16_t _rawGyro[3] = {0, 0, 0}; // Raw gyro input.
+      uint32_t _usToSample = 0; // Simulated time until the next sample. 0 while asleep.
+      uint32_t _samples = 0; // Samples taken since power on.
+}; // class amSimMPU6050
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,289 @@
+/*************************************************************************************************************************************
+ * @file amSimPlant.cpp
+ * @author va3wam
+ * @brief Simulated two wheel inverted pendulum for host side closed loop testing.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <math.h> // sin(), cos(), sqrt(), log().
+#include <amSimPlant.h> // Header file for linking.
+
+#define SIM_PLANT_RAD_TO_DEG 57.29577951308232 // 180 / pi.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// @brief amSimRandom
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief This is the constructor for this class.
+ * @param seed Starting point of the sequence. 0 is treated as 1.
+===================================================================================================*/
+amSimRandom::amSimRandom(uint32_t seed)
+{
+   this->seed(seed);
+} // amSimRandom::amSimRandom()
+
+/**
+ * @brief Start the sequence again.
+ * @param seed Starting point of the sequence. 0 is treated as 1.
+===================================================================================================*/
+void amSimRandom::seed(uint32_t seed)
+{
+   _state = (seed == 0) ? 1 : seed;
+} // amSimRandom::seed()
+
+/**
+ * @brief Next value from a xorshift32 generator.
+ * @return Any value except 0.
+===================================================================================================*/
+uint32_t amSimRandom::next()
+{
+   _state ^= _state << 13;
+   _state ^= _state >> 17;
+   _state ^= _state << 5;
+   return _state;
+} // amSimRandom::next()
+
+/**
+ * @brief Evenly spread value.
+ * @param low Smallest value returned.
+ * @param high Value never quite reached.
+ * @return Value from low up to high.
+===================================================================================================*/
+double amSimRandom::uniform(double low, double high)
+{
+   return low + (high - low) * (next() >> 8) / 16777216.0;
+} // amSimRandom::uniform()
+
+/**
+ * @brief Normally distributed value, by the Box-Muller transform.
+ * @param sigma Standard deviation.
+ * @return Value with mean 0.
+===================================================================================================*/
+double amSimRandom::gaussian(double sigma)
+{
+   double u1 = ((next() >> 8) + 1) / 16777217.0; // Never 0, so the log is finite.
+   double u2 = (next() >> 8) / 16777216.0;
+   return sigma * sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+} // amSimRandom::gaussian()
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// @brief amSimPlant
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief This is the constructor for this class.
+ * @details Takes over the MD25 encoders and turns on its acceleration ramp. The robot starts
+ * upright and at rest.
+ * @param md25 Motor controller driving the wheels. Motor1 is the left wheel.
+ * @param imu IMU mounted on the body, X forward and Z up.
+ * @param params Physical description of the robot.
+ * @param seed Starting point of the sensor noise.
+===================================================================================================*/
+amSimPlant::amSimPlant(amSimMD25 &md25, amSimMPU6050 &imu, const simPlantParams &params, uint32_t seed) : _md25(md25), _imu(imu), _p(params), _random(seed)
+{
+   _md25.setTicksPerUnit(0.0); // Wheels only move when the dynamics say so.
+   _md25.setAccelRamp(true);
+   reset(0.0);
+} // amSimPlant::amSimPlant()
+
+/**
+ * @brief Stand the robot on a new pitch with everything at rest.
+ * @param pitch Radians. Positive leans forward.
+ * @param pitchRate Radians/second.
+===================================================================================================*/
+void amSimPlant::reset(double pitch, double pitchRate)
+{
+   _pitch = pitch;
+   _pitchRate = pitchRate;
+   _pitchAccel = 0.0;
+   _wheel = 0.0;
+   _wheelRate = 0.0;
+   _wheelAccel = 0.0;
+   _yaw = 0.0;
+   _yawRate = 0.0;
+   _fallen = false;
+   _held = false;
+   _usToMs = 0;
+   _sense();
+} // amSimPlant::reset()
+
+/**
+ * @brief Move simulated time forward.
+ * @details Integrates in SIM_PLANT_STEP_US steps. The MD25 ramp moves on once per simulated
+ * millisecond and the MPU6050 samples whatever the body feels at the time.
+ * @param us Microseconds to advance.
+ * @return IMU samples taken, which is the number of data ready pulses the chip would have sent.
+===================================================================================================*/
+uint16_t amSimPlant::advance(uint32_t us)
+{
+   uint16_t samples = 0;
+   while(us > 0)
+   {
+      uint32_t step = (us < SIM_PLANT_STEP_US) ? us : SIM_PLANT_STEP_US;
+      _usToMs += step;
+      while(_usToMs >= 1000)
+      {
+         _usToMs -= 1000;
+         _md25.advance(1);
+      } // while
+      _step(step / 1000000.0);
+      _sense();
+      samples += _imu.advance(step);
+      us -= step;
+   } // while
+   return samples;
+} // amSimPlant::advance()
+
+/**
+ * @brief Push the body.
+ * @param pitchRate Radians/second added to the pitch rate at once.
+===================================================================================================*/
+void amSimPlant::nudge(double pitchRate)
+{
+   if(_fallen == false && _held == false)
+   {
+      _pitchRate += pitchRate;
+   } // if
+} // amSimPlant::nudge()
+
+/**
+ * @brief Put the robot on its stand, or back on the ground.
+ * @details On the stand the body does not move but the wheels spin freely in the air, so a move
+ * started before the controller takes over still finishes, and the encoders and the IMU keep
+ * reporting. Lets the estimators settle before the controller takes over, as they do on the robot
+ * while it sits on its stand with the motors disabled. Taken off, the wheels touch down at rest.
+ * @param held true to hold.
+===================================================================================================*/
+void amSimPlant::hold(bool held)
+{
+   _held = held;
+   _pitchRate = 0.0;
+   _pitchAccel = 0.0;
+   _wheelRate = 0.0;
+   _wheelAccel = 0.0;
+   _yawRate = 0.0;
+} // amSimPlant::hold()
+
+double amSimPlant::getPitch() { return _pitch; } // amSimPlant::getPitch()
+double amSimPlant::getPitchRate() { return _pitchRate; } // amSimPlant::getPitchRate()
+double amSimPlant::getPosition() { return _wheel * _p.wheelRadius; } // amSimPlant::getPosition()
+double amSimPlant::getSpeed() { return _wheelRate * _p.wheelRadius; } // amSimPlant::getSpeed()
+double amSimPlant::getYawRate() { return _yawRate; } // amSimPlant::getYawRate()
+bool amSimPlant::hasFallen() { return _fallen; } // amSimPlant::hasFallen()
+
+/**
+ * @brief Integrate the dynamics over one step.
+ * @details Pitch and mean wheel angle are the usual wheeled inverted pendulum pair, coupled through
+ * a 2x2 mass matrix that is solved every step. The motors push the wheels forward and the body
+ * back by the same torque. Yaw is driven by the difference between the two motor torques and is
+ * not coupled back into pitch. On the stand only the wheels move, and the yaw angle stands for
+ * how far they have turned apart. Semi-implicit Euler keeps the stiff back EMF damping stable.
+ * @param dt Seconds.
+===================================================================================================*/
+void amSimPlant::_step(double dt)
+{
+   double halfTrack = _p.trackWidth / 2.0 / _p.wheelRadius; // Wheel radians per radian of yaw.
+   double leftTorque = _motorTorque(MD25_MOTOR1, _wheelRate - _yawRate * halfTrack - _pitchRate);
+   double rightTorque = _motorTorque(MD25_MOTOR2, _wheelRate + _yawRate * halfTrack - _pitchRate);
+   double torque = leftTorque + rightTorque;
+   double r = _p.wheelRadius;
+   double l = _p.comHeight;
+   double mb = _p.bodyMass;
+   double a11 = (mb + _p.wheelMass) * r * r + _p.wheelInertia;
+   double yawAccel = (rightTorque - leftTorque) * halfTrack / _p.yawInertia;
+   if(_held == true) // Wheels spin in the air.
+   {
+      _wheelAccel = torque / _p.wheelInertia;
+      _pitchAccel = 0.0;
+      yawAccel = (rightTorque - leftTorque) / (_p.wheelInertia * halfTrack);
+   } // if
+   else if(_fallen == true) // Body is on the ground and only the wheels move.
+   {
+      _wheelAccel = torque / a11;
+      _pitchAccel = 0.0;
+   } // else if
+   else
+   {
+      double s = sin(_pitch);
+      double c = cos(_pitch);
+      double a12 = mb * r * l * c;
+      double a22 = mb * l * l + _p.bodyInertia;
+      double b1 = torque + mb * r * l * s * _pitchRate * _pitchRate;
+      double b2 = -torque + mb * SIM_PLANT_GRAVITY * l * s;
+      double det = a11 * a22 - a12 * a12;
+      _wheelAccel = (b1 * a22 - a12 * b2) / det;
+      _pitchAccel = (a11 * b2 - a12 * b1) / det;
+   } // else
+   _wheelRate += _wheelAccel * dt;
+   _pitchRate += _pitchAccel * dt;
+   _yawRate += yawAccel * dt;
+   _wheel += _wheelRate * dt;
+   _pitch += _pitchRate * dt;
+   _yaw += _yawRate * dt;
+   if(_fallen == false && (_pitch >= _p.fallAngle || _pitch <= -_p.fallAngle))
+   {
+      _pitch = (_pitch > 0.0) ? _p.fallAngle : -_p.fallAngle;
+      _pitchRate = 0.0;
+      _pitchAccel = 0.0;
+      _fallen = true;
+   } // if
+} // amSimPlant::_step()
+
+/**
+ * @brief Write what the sensors feel.
+ * @details The encoders count the wheel turning against the body, as they do on the motor shaft.
+ * The accelerometer feels the specific force at its mounting point, gravity and the body's own
+ * acceleration together, turned into chip axes with the same sign convention amTilt expects.
+===================================================================================================*/
+void amSimPlant::_sense()
+{
+   double halfTrack = _p.trackWidth / 2.0 / _p.wheelRadius;
+   double ticksPerRad = _p.ticksPerRev / (2.0 * M_PI);
+   _md25.setEncoderTicks(MD25_MOTOR1, (_wheel - _yaw * halfTrack - _pitch) * ticksPerRad);
+   _md25.setEncoderTicks(MD25_MOTOR2, (_wheel + _yaw * halfTrack - _pitch) * ticksPerRad);
+   double s = sin(_pitch);
+   double c = cos(_pitch);
+   double h = _p.imuHeight;
+   double fx = (_held ? 0.0 : _wheelAccel * _p.wheelRadius) + h * (_pitchAccel * c - _pitchRate * _pitchRate * s); // Forward.
+   double fz = -h * (_pitchAccel * s + _pitchRate * _pitchRate * c) + SIM_PLANT_GRAVITY; // Up.
+   double accelX = (fz * s - fx * c) / SIM_PLANT_GRAVITY + _random.gaussian(_p.accelNoise);
+   double accelY = _random.gaussian(_p.accelNoise);
+   double accelZ = (fx * s + fz * c) / SIM_PLANT_GRAVITY + _random.gaussian(_p.accelNoise);
+   double gyroX = _random.gaussian(_p.gyroNoise);
+   double gyroY = _pitchRate * SIM_PLANT_RAD_TO_DEG + _p.gyroBias + _random.gaussian(_p.gyroNoise);
+   double gyroZ = (_held ? 0.0 : _yawRate * SIM_PLANT_RAD_TO_DEG) + _random.gaussian(_p.gyroNoise);
+   _imu.setMotion(accelX, accelY, accelZ, gyroX, gyroY, gyroZ);
+} // amSimPlant::_sense()
+
+/**
+ * @brief Torque one geared motor puts on its wheel.
+ * @details The MD25 drive is treated as an average voltage. Current is what that voltage can push
+ * through the winding against the back EMF. The motor inductance is small enough to ignore.
+ * @param motor MD25_MOTOR1 or MD25_MOTOR2.
+ * @param rate Wheel speed relative to the body in radians/second.
+ * @return N.m at the wheel. Positive drives the wheel forward.
+===================================================================================================*/
+double amSimPlant::_motorTorque(uint8_t motor, double rate)
+{
+   double drive = _md25.getMotorOutput(motor) / 127.0;
+   if(drive < -1.0)
+   {
+      drive = -1.0;
+   } // if
+   double volts = drive * _md25.getReg(MD25RegBatteryVolts) / 10.0;
+   double amps = (volts - _p.motorKe * _p.gearRatio * rate) / _p.motorResistance;
+   return _p.gearRatio * _p.motorKt * amps - _p.gearFriction * rate;
+} // amSimPlant::_motorTorque()
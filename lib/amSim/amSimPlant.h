@@ -0,0 +1,113 @@
+/*************************************************************************************************************************************
+ * @file amSimPlant.h
+ * @author va3wam
+ * @brief Simulated two wheel inverted pendulum for host side closed loop testing.
+ * @details Models the Zippy chassis as a body pitching on an axle driven by two geared DC motors. The motors take their drive from
+ * a simulated MD25, with its acceleration register ramp, and the wheel angles go back into its encoder registers. What the body
+ * does is written to a simulated MPU6050 as the specific force and rate a chip mounted on the body would feel, with noise and gyro
+ * bias added, so the real drivers and filters see the same register traffic they do on the robot. Nothing here knows about time
+ * passing except advance(), so a run goes as fast as the host can compute it.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amSimPlant_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amSimPlant_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <amSimMD25.h> // Simulated MD25.
+#include <amSimMPU6050.h> // Simulated MPU6050.
+
+#define SIM_PLANT_STEP_US 250 // Integration step. Well inside the fastest motor time constant.
+#define SIM_PLANT_GRAVITY 9.81 // Metres/second/second.
+
+/*! Physical description of the robot. Defaults are the Zippy chassis with EMG30 motors. */
+struct simPlantParams
+{
+   double bodyMass = 1.6; ///< Kilograms above the axle, wheels and motor rotors excluded.
+   double comHeight = 0.2; ///< Metres from the axle to the body centre of mass.
+   double bodyInertia = 0.02; ///< Pitch inertia of the body about its centre of mass, kg.m^2.
+   double yawInertia = 0.015; ///< Inertia of the whole robot about the vertical axis, kg.m^2.
+   double wheelMass = 0.2; ///< Kilograms for both wheels together.
+   double wheelRadius = 0.05; ///< Metres.
+   double wheelInertia = 0.002; ///< Both wheels and both rotors seen through the gearbox, kg.m^2.
+   double trackWidth = 0.2; ///< Metres between the wheel contact points.
+   double gearRatio = 30.0; ///< Motor turns per wheel turn.
+   double motorKt = 0.0225; ///< Torque constant at the motor shaft, N.m/A.
+   double motorKe = 0.0225; ///< Back EMF constant at the motor shaft, V.s/rad.
+   double motorResistance = 4.8; ///< Ohms. EMG30 stalls at 2.5A on 12V.
+   double gearFriction = 0.005; ///< Viscous loss per gearbox at the wheel, N.m.s/rad.
+   double ticksPerRev = 360.0; ///< Encoder ticks per wheel turn.
+   double imuHeight = 0.1; ///< Metres from the axle to the MPU6050.
+   double gyroNoise = 0.05; ///< Gyro white noise per sample, degrees/second RMS.
+   double accelNoise = 0.004; ///< Accelerometer white noise per sample, g RMS.
+   double gyroBias = 0.5; ///< Constant pitch gyro offset, degrees/second.
+   double fallAngle = 0.9; ///< Pitch in radians at which the body hits the ground.
+}; // struct
+
+/*************************************************************************************************************************************
+ * @class Small repeatable random number generator, so a trial gives the same result on every machine.
+ *************************************************************************************************************************************/
+class amSimRandom
+{
+   public:
+      amSimRandom(uint32_t seed = 1); // Class constructor.
+      void seed(uint32_t seed); // Start the sequence again.
+      uint32_t next(); // Next raw 32 bit value.
+      double uniform(double low, double high); // Evenly spread between low and high.
+      double gaussian(double sigma); // Normal distribution with mean 0.
+   private:
+      uint32_t _state; // xorshift32 state. Never 0.
+}; // class amSimRandom
+
+/*************************************************************************************************************************************
+ * @class Simulated two wheel inverted pendulum wired to a simulated MD25 and MPU6050.
+ *************************************************************************************************************************************/
+class amSimPlant
+{
+   public:
+      amSimPlant(amSimMD25 &md25, amSimMPU6050 &imu, const simPlantParams &params, uint32_t seed = 1); // Class constructor.
+      void reset(double pitch, double pitchRate = 0.0); // Stand the robot at rest on a new pitch.
+      uint16_t advance(uint32_t us); // Move simulated time forward. Returns IMU samples taken.
+      void nudge(double pitchRate); // Push the body, as a sudden change of pitch rate.
+      void hold(bool held); // Hold the body still on a stand with the wheels in the air.
+      double getPitch(); // Radians. Positive leans forward.
+      double getPitchRate(); // Radians/second.
+      double getPosition(); // Metres travelled by the axle. Positive is forward.
+      double getSpeed(); // Axle speed in metres/second.
+      double getYawRate(); // Radians/second. Positive turns left.
+      bool hasFallen(); // Body has hit the ground.
+   private:
+      void _step(double dt); // Integrate the dynamics over one step.
+      void _sense(); // Write what the sensors feel to the MD25 encoders and MPU6050.
+      double _motorTorque(uint8_t motor, double rate); // Torque one motor puts on its wheel.
+      amSimMD25 &_md25; // Motor controller driving the wheels.
+      amSimMPU6050 &_imu; // IMU on the body.
+      simPlantParams _p; // Physical description.
+      amSimRandom _random; // Sensor noise.
+      double _pitch = 0.0; // Body pitch in radians.
+      double _pitchRate = 0.0; // Radians/second.
+      double _pitchAccel = 0.0; // Radians/second/second, from the last step.
+      double _wheel = 0.0; // Mean wheel angle in radians.
+      double _wheelRate = 0.0; // Radians/second.
+      double _wheelAccel = 0.0; // Radians/second/second, from the last step.
+      double _yaw = 0.0; // Heading in radians.
+      double _yawRate = 0.0; // Radians/second.
+      bool _fallen = false; // Body is on the ground.
+      bool _held = false; // Body is on its stand.
+      uint32_t _usToMs = 0; // Microseconds towards the next MD25 millisecond.
+}; // class amSimPlant
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,204 @@
+/*************************************************************************************************************************************
+ * @file amSimScriptBus.cpp
+ * @author va3wam
+ * @brief Scripted I2C bus for checking a driver's register protocol on the host.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <stdio.h> // snprintf().
+#include <string.h> // memcpy(), memcmp().
+#include <amSimScriptBus.h> // Header file for linking.
+
+/**
+ * @brief This is the constructor for this class.
+===================================================================================================*/
+amSimScriptBus::amSimScriptBus()
+{
+   clear();
+} // amSimScriptBus::amSimScriptBus()
+
+/**
+ * @brief Queue a register write the driver is expected to make.
+ * @param address Expected device address.
+ * @param reg Expected first register.
+ * @param data Bytes the driver must write.
+ * @param len Number of bytes.
+ * @param status Status to return to the driver.
+ * @return false if the script is full.
+===================================================================================================*/
+bool amSimScriptBus::expectWrite(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t len, uint8_t status)
+{
+   return _queue(STEP_WRITE, address, reg, data, len, status);
+} // amSimScriptBus::expectWrite()
+
+/**
+ * @brief Queue a single register write the driver is expected to make.
+ * @return false if the script is full.
+===================================================================================================*/
+bool amSimScriptBus::expectWriteReg(uint8_t address, uint8_t reg, uint8_t value, uint8_t status)
+{
+   return _queue(STEP_WRITE, address, reg, &value, 1, status);
+} // amSimScriptBus::expectWriteReg()
+
+/**
+ * @brief Queue a register read the driver is expected to make.
+ * @param address Expected device address.
+ * @param reg Expected first register.
+ * @param reply Bytes handed back to the driver.
+ * @param len Number of bytes the driver must ask for.
+ * @param status Status to return to the driver. The reply is only copied for I2C_OK.
+ * @return false if the script is full.
+===================================================================================================*/
+bool amSimScriptBus::expectRead(uint8_t address, uint8_t reg, const uint8_t* reply, uint8_t len, uint8_t status)
+{
+   return _queue(STEP_READ, address, reg, reply, len, status);
+} // amSimScriptBus::expectRead()
+
+/**
+ * @brief Queue an address only transaction the driver is expected to make.
+ * @return false if the script is full.
+===================================================================================================*/
+bool amSimScriptBus::expectProbe(uint8_t address, uint8_t status)
+{
+   return _queue(STEP_PROBE, address, 0, nullptr, 0, status);
+} // amSimScriptBus::expectProbe()
+
+/**
+ * @brief Check a write against the script.
+ * @return The scripted status, or I2C_ERR_OTHER if the write was not the one expected.
+===================================================================================================*/
+uint8_t amSimScriptBus::writeRegs(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t len)
+{
+   step* s = _next(STEP_WRITE, address, reg, len);
+   if(s == nullptr)
+   {
+      return I2C_ERR_OTHER;
+   } // if
+   if(memcmp(&_data[s->offset], data, len) != 0)
+   {
+      _fail("write data differs", address, reg, len);
+   } // if
+   return s->status;
+} // amSimScriptBus::writeRegs()
+
+/**
+ * @brief Check a read against the script and hand back the scripted reply.
+ * @return The scripted status, or I2C_ERR_OTHER if the read was not the one expected.
+===================================================================================================*/
+uint8_t amSimScriptBus::readRegs(uint8_t address, uint8_t reg, uint8_t* dest, uint8_t len)
+{
+   step* s = _next(STEP_READ, address, reg, len);
+   if(s == nullptr)
+   {
+      return I2C_ERR_OTHER;
+   } // if
+   if(s->status == I2C_OK)
+   {
+      memcpy(dest, &_data[s->offset], len);
+   } // if
+   return s->status;
+} // amSimScriptBus::readRegs()
+
+/**
+ * @brief Check an address only transaction against the script.
+ * @return The scripted status, or I2C_ERR_OTHER if the probe was not the one expected.
+===================================================================================================*/
+uint8_t amSimScriptBus::probe(uint8_t address)
+{
+   step* s = _next(STEP_PROBE, address, 0, 0);
+   return (s == nullptr) ? I2C_ERR_OTHER : s->status;
+} // amSimScriptBus::probe()
+
+/**
+ * @brief Report if the whole script has been played.
+ * @return true if every queued transaction has happened.
+===================================================================================================*/
+bool amSimScriptBus::isDone()
+{
+   return _nextStep == _numSteps;
+} // amSimScriptBus::isDone()
+
+uint8_t amSimScriptBus::getRemaining() { return _numSteps - _nextStep; } // amSimScriptBus::getRemaining()
+uint32_t amSimScriptBus::getFailures() { return _failures; } // amSimScriptBus::getFailures()
+const char* amSimScriptBus::getFailure() { return _failure; } // amSimScriptBus::getFailure()
+
+/**
+ * @brief Empty the script and clear any failures.
+===================================================================================================*/
+void amSimScriptBus::clear()
+{
+   _numSteps = 0;
+   _nextStep = 0;
+   _dataUsed = 0;
+   _failures = 0;
+   _failure[0] = '\0';
+} // amSimScriptBus::clear()
+
+/**
+ * @brief Add a step to the end of the script.
+ * @return false if there is no room for the step or its data.
+===================================================================================================*/
+bool amSimScriptBus::_queue(stepType type, uint8_t address, uint8_t reg, const uint8_t* data, uint8_t len, uint8_t status)
+{
+   if(_numSteps >= SIM_SCRIPT_MAX_STEPS || _dataUsed + len > SIM_SCRIPT_MAX_DATA)
+   {
+      return false;
+   } // if
+   step &s = _steps[_numSteps++];
+   s.type = type;
+   s.address = address;
+   s.reg = reg;
+   s.offset = _dataUsed;
+   s.len = len;
+   s.status = status;
+   if(len > 0)
+   {
+      memcpy(&_data[_dataUsed], data, len);
+      _dataUsed += len;
+   } // if
+   return true;
+} // amSimScriptBus::_queue()
+
+/**
+ * @brief Match a transaction against the next step of the script.
+ * @return The step, now consumed, or nullptr if the transaction was not the one expected.
+===================================================================================================*/
+amSimScriptBus::step* amSimScriptBus::_next(stepType type, uint8_t address, uint8_t reg, uint8_t len)
+{
+   if(_nextStep >= _numSteps)
+   {
+      _fail("unexpected transaction after end of script", address, reg, len);
+      return nullptr;
+   } // if
+   step* s = &_steps[_nextStep];
+   if(s->type != type || s->address != address || s->reg != reg || s->len != len)
+   {
+      _fail("transaction does not match script", address, reg, len);
+      return nullptr;
+   } // if
+   _nextStep++;
+   return s;
+} // amSimScriptBus::_next()
+
+/**
+ * @brief Count a failure and describe it if it is the first one.
+===================================================================================================*/
+void amSimScriptBus::_fail(const char* what, uint8_t address, uint8_t reg, uint8_t len)
+{
+   if(_failures++ == 0)
+   {
+      snprintf(_failure, SIM_SCRIPT_FAILURE_LEN, "step %u: %s (address 0x%02X, reg 0x%02X, len %u)", _nextStep, what, address, reg, len);
+   } // if
+} // amSimScriptBus::_fail()
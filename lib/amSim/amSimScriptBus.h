@@ -0,0 +1,76 @@
+/*************************************************************************************************************************************
+ * @file amSimScriptBus.h
+ * @author va3wam
+ * @brief Scripted I2C bus for checking a driver's register protocol on the host.
+ * @details A test queues the transactions it expects a driver to make, in order, along with the bytes each read should return
+ * and the status each transaction should report. The driver is then run against the bus. Any transaction that does not match
+ * the next one in the script is counted as a failure and described in getFailure(). Writes are checked byte for byte.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amSimScriptBus_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amSimScriptBus_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <amI2cBus.h> // Register level I2C bus interface.
+
+#define SIM_SCRIPT_MAX_STEPS 32 // Most transactions one script can hold.
+#define SIM_SCRIPT_MAX_DATA 2048 // Total bytes of write data and read replies one script can hold.
+#define SIM_SCRIPT_FAILURE_LEN 120 // Length of the failure description.
+
+/*************************************************************************************************************************************
+ * @class I2C bus that checks transactions against a script.
+ *************************************************************************************************************************************/
+class amSimScriptBus : public amI2cBus
+{
+   public:
+      amSimScriptBus(); // Class constructor.
+      bool expectWrite(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t len, uint8_t status = I2C_OK); // Queue a write.
+      bool expectWriteReg(uint8_t address, uint8_t reg, uint8_t value, uint8_t status = I2C_OK); // Queue a one byte write.
+      bool expectRead(uint8_t address, uint8_t reg, const uint8_t* reply, uint8_t len, uint8_t status = I2C_OK); // Queue a read.
+      bool expectProbe(uint8_t address, uint8_t status = I2C_OK); // Queue an address only transaction.
+      uint8_t writeRegs(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t len); // Write len bytes from reg.
+      uint8_t readRegs(uint8_t address, uint8_t reg, uint8_t* dest, uint8_t len); // Read len bytes from reg.
+      uint8_t probe(uint8_t address); // Address only transaction.
+      bool isDone(); // Every queued transaction has happened.
+      uint8_t getRemaining(); // Queued transactions not yet made.
+      uint32_t getFailures(); // Transactions that did not match the script.
+      const char* getFailure(); // Description of the first failure.
+      void clear(); // Empty the script and clear failures.
+   private:
+      enum stepType {STEP_WRITE, STEP_READ, STEP_PROBE}; // Kinds of transaction.
+      struct step
+      {
+         stepType type; // Kind of transaction.
+         uint8_t address; // Expected device address.
+         uint8_t reg; // Expected first register.
+         uint16_t offset; // Where the data for this step starts in _data.
+         uint8_t len; // Expected number of bytes.
+         uint8_t status; // Status to report.
+      }; // struct
+      bool _queue(stepType type, uint8_t address, uint8_t reg, const uint8_t* data, uint8_t len, uint8_t status); // Add a step.
+      step* _next(stepType type, uint8_t address, uint8_t reg, uint8_t len); // Check and consume the next step.
+      void _fail(const char* what, uint8_t address, uint8_t reg, uint8_t len); // Record a failure.
+      step _steps[SIM_SCRIPT_MAX_STEPS]; // The script.
+      uint8_t _data[SIM_SCRIPT_MAX_DATA]; // Write data to compare against and read replies.
+      uint8_t _numSteps = 0; // Steps queued.
+      uint8_t _nextStep = 0; // Next step expected.
+      uint16_t _dataUsed = 0; // Bytes of _data in use.
+      uint32_t _failures = 0; // Mismatched transactions.
+      char _failure[SIM_SCRIPT_FAILURE_LEN]; // First failure.
+}; // class amSimScriptBus
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,217 @@
+/*************************************************************************************************************************************
+ * @file amSimTrial.cpp
+ * @author va3wam
+ * @brief Closed loop balance trials against the simulated plant, run faster than real time and scored for gain tuning.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <math.h> // sqrt(), fabs().
+#include <atomic> // std::atomic.
+#include <thread> // std::thread.
+#include <vector> // std::vector.
+#include <amMD25Driver.h> // MD25 driver under test.
+#include <amMPU6050.h> // MPU6050 driver under test.
+#include <amTilt.h> // Pitch estimator under test.
+#include <amSimBus.h> // Simulated I2C bus.
+#include <amSimTrial.h> // Header file for linking.
+
+#define SIM_TRIAL_MAX_SAMPLES 32 // IMU samples drained per cycle. Same as IMU_MAX_SAMPLES.
+#define SIM_TRIAL_SAMPLE_PERIOD 0.001f // Seconds. initImu() sets 1kHz.
+#define SIM_TRIAL_GYRO_LSB_PER_DPS 65.5f // MPU6050_GYRO_500DPS.
+
+/**
+ * @brief Run one balance trial.
+ * @details The robot sits on its stand for settleSeconds so the Kalman filter can find the gyro
+ * bias, then is let go and the controller has seconds to keep it up. Each cycle follows
+ * balanceTask(): drain the FIFO, update the filter, read the encoders, step the controller and
+ * write the speed registers.
+ * @param gains Controller under test.
+ * @param config How to run the trial.
+ * @param seed Picks the starting lean, body mass, gyro bias and sensor noise.
+ * @return How the trial went.
+===================================================================================================*/
+simTrialResult simRunTrial(const balanceGains &gains, const simTrialConfig &config, uint32_t seed)
+{
+   amSimRandom random(seed);
+   simPlantParams params = config.plant;
+   params.bodyMass *= random.uniform(1.0 - config.massSpread, 1.0 + config.massSpread);
+   params.gyroBias = random.uniform(-config.maxGyroBias, config.maxGyroBias);
+   double initialPitch = random.uniform(-config.maxInitialPitch, config.maxInitialPitch);
+
+   amSimBus bus0;
+   amSimBus bus1;
+   amSimMD25 md25Sim;
+   amSimMPU6050 imuSim;
+   bus0.attach(md25Sim);
+   bus1.attach(imuSim);
+   amSimPlant plant(md25Sim, imuSim, params, random.next());
+   plant.reset(initialPitch);
+   plant.hold(true);
+
+   amMD25Driver md25(bus0, SIM_MD25_ADDRESS);
+   amMPU6050 imu(bus1, SIM_MPU6050_ADDRESS);
+   imu.begin(MPU6050_DLPF_44HZ, 0, MPU6050_GYRO_500DPS, MPU6050_ACCEL_4G); // As initImu().
+   md25.setMode(MD25ModeUnsigned); // As enableBalance().
+   if(config.md25Accel != 0)
+   {
+      bus0.writeRegs(SIM_MD25_ADDRESS, MD25RegMotorAccel, &config.md25Accel, 1);
+   } // if
+   amTiltKalman tilt(SIM_TRIAL_SAMPLE_PERIOD, SIM_TRIAL_GYRO_LSB_PER_DPS);
+   balanceCascade pid;
+   bool useCascade = config.cascade && config.loopHz == BALANCE_CASCADE_HZ;
+
+   uint32_t periodUs = 1000000 / config.loopHz;
+   uint32_t settleCycles = (uint32_t)(config.settleSeconds * config.loopHz);
+   uint32_t cycles = settleCycles + (uint32_t)(config.seconds * config.loopHz);
+   double metresPerTick = 2.0 * M_PI * params.wheelRadius / params.ticksPerRev;
+   mpu6050Sample samples[SIM_TRIAL_MAX_SAMPLES];
+   balanceInput input = {0.0f, 0.0f, 0.0f};
+   md25Telemetry last = {0, 0, 0, 0, 0};
+   bool haveLast = false;
+   double pitchSquares = 0.0;
+   double commandSquares = 0.0;
+   uint32_t upright = 0;
+   simTrialResult result = {false, 0.0, 0.0, 0.0, 0.0};
+   for(uint32_t cycle = 0; cycle < cycles; cycle++)
+   {
+      if(cycle == settleCycles)
+      {
+         plant.hold(false);
+         pid.reset(input.wheelSpeed, input.pitch);
+      } // if
+      plant.advance(periodUs);
+      uint16_t count = 0;
+      imu.drainFifo(samples, SIM_TRIAL_MAX_SAMPLES, &count);
+      if(count > 0)
+      {
+         tilt.updateBatch(samples, count);
+         input.pitch = tilt.getAngle();
+         input.pitchRate = tilt.getRate();
+      } // if
+      if(cycle < settleCycles) // On the stand. Motors off.
+      {
+         continue;
+      } // if
+      md25Telemetry snapshot;
+      if(md25.readTelemetrySnapshot(&snapshot) == I2C_OK)
+      {
+         if(haveLast == true)
+         {
+            double ticks = ((snapshot.encoder1 - last.encoder1) + (snapshot.encoder2 - last.encoder2)) / 2.0;
+            input.wheelSpeed = ticks * metresPerTick * config.loopHz;
+         } // if
+         last = snapshot;
+         haveLast = true;
+      } // if
+      balanceOutput output = useCascade ? balanceCascadeStep(pid, gains, input, config.targetSpeed) : balanceStep(gains, input);
+      md25.setSpeeds(output.fallen ? MD25SpeedStop : balanceToSpeed(output.command), output.fallen ? MD25SpeedStop : balanceToSpeed(output.command));
+      if(plant.hasFallen() == true)
+      {
+         result.fell = true;
+         break;
+      } // if
+      upright++;
+      pitchSquares += plant.getPitch() * plant.getPitch();
+      commandSquares += output.command * output.command;
+      if(fabs(plant.getPosition()) > result.maxDrift)
+      {
+         result.maxDrift = fabs(plant.getPosition());
+      } // if
+   } // for
+   result.uprightSeconds = (double)upright / config.loopHz;
+   if(upright > 0)
+   {
+      result.rmsPitch = sqrt(pitchSquares / upright);
+      result.rmsCommand = sqrt(commandSquares / upright);
+   } // if
+   return result;
+} // simRunTrial()
+
+/**
+ * @brief Boil a trial down to one number.
+ * @details A fall always costs more than any trial that stayed up, and an early fall more than a
+ * late one. A trial that stayed up costs its RMS pitch in degrees plus its drift in metres, with a
+ * little added for motor effort so that of two equally steady gain sets the calmer one wins.
+ * @param result How the trial went.
+ * @param config How it was run.
+ * @return Cost. Lower is better.
+===================================================================================================*/
+double simTrialCost(const simTrialResult &result, const simTrialConfig &config)
+{
+   if(result.fell == true)
+   {
+      return SIM_TRIAL_FALL_COST * (2.0 - result.uprightSeconds / config.seconds);
+   } // if
+   return result.rmsPitch * 57.29578 + result.maxDrift + 0.01 * result.rmsCommand;
+} // simTrialCost()
+
+/**
+ * @brief Run many trials of one gain set and score them.
+ * @details Trials use seeds firstSeed to firstSeed + trials - 1. Worker threads take the next
+ * unclaimed trial until none are left and keep each cost in its own slot, which are then added up
+ * in seed order, so the score is the same whatever the number of threads.
+ * @param gains Controller under test.
+ * @param config How to run each trial.
+ * @param trials Number of trials.
+ * @param firstSeed Seed of the first trial.
+ * @param threads Worker threads. 0 or 1 runs every trial on the calling thread.
+ * @return Mean and worst cost and the number of falls.
+===================================================================================================*/
+simScore simScoreGains(const balanceGains &gains, const simTrialConfig &config, uint32_t trials, uint32_t firstSeed, uint16_t threads)
+{
+   std::vector<double> costs(trials);
+   std::vector<uint8_t> fell(trials);
+   std::atomic<uint32_t> nextTrial(0);
+   auto worker = [&]()
+   {
+      for(uint32_t i = nextTrial++; i < trials; i = nextTrial++)
+      {
+         simTrialResult result = simRunTrial(gains, config, firstSeed + i);
+         costs[i] = simTrialCost(result, config);
+         fell[i] = result.fell;
+      } // for
+   }; // worker
+   if(threads <= 1)
+   {
+      worker();
+   } // if
+   else
+   {
+      std::vector<std::thread> pool;
+      for(uint16_t t = 0; t < threads; t++)
+      {
+         pool.emplace_back(worker);
+      } // for
+      for(std::thread &thread : pool)
+      {
+         thread.join();
+      } // for
+   } // else
+   simScore score = {0.0, 0.0, 0, trials};
+   for(uint32_t i = 0; i < trials; i++)
+   {
+      score.meanCost += costs[i];
+      score.falls += fell[i];
+      if(costs[i] > score.worstCost)
+      {
+         score.worstCost = costs[i];
+      } // if
+   } // for
+   if(trials > 0)
+   {
+      score.meanCost /= trials;
+   } // if
+   return score;
+} // simScoreGains()
@@ -0,0 +1,72 @@
+/*************************************************************************************************************************************
+ * @file amSimTrial.h
+ * @author va3wam
+ * @brief Closed loop balance trials against the simulated plant, run faster than real time and scored for gain tuning.
+ * @details A trial wires the real amMD25Driver, amMPU6050, amTiltKalman and amBalance code to an amSimPlant through simulated buses
+ * and steps them in lock step: the plant moves one balance period, then the loop senses, estimates, controls and actuates exactly
+ * as include/balance.h does on the robot. Each trial draws its own starting lean, body mass and gyro bias from its seed, so a set of
+ * trials is repeatable, and simScoreGains() spreads a set across threads without changing the answer.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amSimTrial_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amSimTrial_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <amBalance.h> // Balance controller under test.
+#include <amSimPlant.h> // Simulated robot.
+
+#define SIM_TRIAL_FALL_COST 100.0 // Cost of a fall, before the share of the trial that was lost is added.
+
+/*! How a trial is run. */
+struct simTrialConfig
+{
+   double seconds = 10.0; ///< Simulated time the controller has to keep the robot up.
+   double settleSeconds = 1.0; ///< Time on the stand, motors off, before the controller takes over.
+   uint16_t loopHz = 200; ///< Balance loop rate.
+   bool cascade = false; ///< Use balanceCascadeStep(). Only at BALANCE_CASCADE_HZ, as on the robot.
+   float targetSpeed = 0.0f; ///< Wheel speed the cascade is asked to hold, metres/second.
+   double maxInitialPitch = 0.05; ///< Starting lean is drawn from +/- this, radians.
+   double massSpread = 0.1; ///< Body mass is drawn from +/- this share of plant.bodyMass.
+   double maxGyroBias = 1.0; ///< Gyro bias is drawn from +/- this, degrees/second.
+   uint8_t md25Accel = 0; ///< Value for the MD25 acceleration register. 0 leaves the power on value.
+   simPlantParams plant; ///< Robot before the random changes.
+}; // struct
+
+/*! How one trial went. */
+struct simTrialResult
+{
+   bool fell; ///< Robot hit the ground.
+   double uprightSeconds; ///< Time from release to the fall, or the whole trial.
+   double rmsPitch; ///< Radians while upright.
+   double maxDrift; ///< Furthest the axle got from where it started, metres.
+   double rmsCommand; ///< Motor command while upright, -127 to 127.
+}; // struct
+
+/*! How a gain set did over many trials. */
+struct simScore
+{
+   double meanCost; ///< Average of simTrialCost(). Lower is better.
+   double worstCost; ///< Highest single trial cost.
+   uint32_t falls; ///< Trials that ended on the ground.
+   uint32_t trials; ///< Trials run.
+}; // struct
+
+simTrialResult simRunTrial(const balanceGains &gains, const simTrialConfig &config, uint32_t seed); // Run one trial.
+double simTrialCost(const simTrialResult &result, const simTrialConfig &config); // Single figure of merit. Lower is better.
+simScore simScoreGains(const balanceGains &gains, const simTrialConfig &config, uint32_t trials, uint32_t firstSeed, uint16_t threads); // Run many trials.
+
+#endif // End of precompiler protected code block
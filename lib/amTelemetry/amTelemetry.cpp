@@ -0,0 +1,392 @@
+/*************************************************************************************************************************************
+ * @file amTelemetry.cpp
+ * @author va3wam
+ * @brief Batching MQTT telemetry publisher with precomputed topics and send window backpressure.
+ * @details See amTelemetry.h.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Add reserve() so samples can be serialized straight into the batch frame
+ *************************************************************************************************************************************/
+#include <string.h> // memcpy(), strlen().
+#include <amTelemetry.h> // Header file for linking.
+
+static_assert(TLM_FRAME_LEN >= TLM_BATCH_HEADER + TLM_SAMPLE_HEADER + TLM_MAX_SAMPLE, "TLM_FRAME_LEN must hold the largest sample");
+static_assert(TLM_FRAME_LEN <= 0xFFFF, "TLM_FRAME_LEN must fit in 16 bits");
+
+/**
+ * @brief Work out the size of the MQTT PUBLISH packet that carries a payload.
+ * @details Fixed header byte, remaining length (1 to 4 bytes), topic length and topic, packet id
+ * for QoS 1 and 2, then the payload.
+ * @param topicLen Characters in the topic.
+ * @param payloadLen Bytes of payload.
+ * @param qos Quality of service.
+ * @return Bytes on the wire, not counting TCP/IP headers.
+===================================================================================================*/
+size_t tlmWireSize(size_t topicLen, size_t payloadLen, uint8_t qos)
+{
+   size_t remaining = 2 + topicLen + ((qos > 0) ? 2 : 0) + payloadLen;
+   size_t lengthBytes = 1;
+   for(size_t r = remaining; r > 127; r >>= 7)
+   {
+      lengthBytes++;
+   } // for
+   return 1 + lengthBytes + remaining;
+} // tlmWireSize()
+
+/**
+ * @brief Check and read the header of a batch frame.
+ * @param frame Received payload.
+ * @param len Bytes in frame.
+ * @param header Where to put the header.
+ * @return false if frame is too short or of another version.
+===================================================================================================*/
+bool tlmReadHeader(const uint8_t* frame, size_t len, tlmBatchHeader* header)
+{
+   if(len < TLM_BATCH_HEADER || frame[0] != TLM_BATCH_VERSION)
+   {
+      return false;
+   } // if
+   header->version = frame[0];
+   header->count = frame[1];
+   header->sequence = (uint16_t)(frame[2] | (frame[3] << 8));
+   header->startMs = (uint32_t)frame[4] | ((uint32_t)frame[5] << 8) | ((uint32_t)frame[6] << 16) | ((uint32_t)frame[7] << 24);
+   return true;
+} // tlmReadHeader()
+
+/**
+ * @brief Step through the samples of a batch frame.
+ * @param frame Received payload.
+ * @param len Bytes in frame.
+ * @param offset Set to TLM_BATCH_HEADER for the first sample. Moved past each sample found.
+ * @param sample Where to put the sample. Its data points into frame.
+ * @return false at the end of the frame, or if the next sample runs past it.
+===================================================================================================*/
+bool tlmNextSample(const uint8_t* frame, size_t len, size_t* offset, tlmSample* sample)
+{
+   size_t at = *offset;
+   if(at + TLM_SAMPLE_HEADER > len)
+   {
+      return false;
+   } // if
+   uint8_t n = frame[at + 2];
+   if(at + TLM_SAMPLE_HEADER + n > len)
+   {
+      return false;
+   } // if
+   sample->offsetMs = (uint16_t)(frame[at] | (frame[at + 1] << 8));
+   sample->len = n;
+   sample->data = frame + at + TLM_SAMPLE_HEADER;
+   *offset = at + TLM_SAMPLE_HEADER + n;
+   return true;
+} // tlmNextSample()
+
+/**
+ * @brief This is the constructor for this class. No topics are registered.
+ * @param send Hands a packet to the MQTT client.
+ * @param ready Asks whether a packet of a given size can be written now. nullptr means always.
+ * @param context Passed back to send and ready.
+===================================================================================================*/
+amTelemetry::amTelemetry(tlmSend send, tlmReady ready, void* context)
+   : _sendFn(send), _readyFn(ready), _context(context), _streamCount(0), _eventCount(0)
+{
+   memset(&_stats, 0, sizeof(_stats));
+} // amTelemetry::amTelemetry()
+
+/**
+ * @brief Register a batched topic.
+ * @param prefix Start of the topic, e.g. the top of the tree. May be nullptr.
+ * @param name Rest of the topic.
+ * @param intervalMs Longest a sample waits before its batch is sent. 0 sends every sample on its own.
+ * @return Stream number for sample(), or -1 if the table is full or the topic too long.
+===================================================================================================*/
+int8_t amTelemetry::addStream(const char* prefix, const char* name, uint16_t intervalMs)
+{
+   if(_streamCount >= TLM_MAX_STREAMS)
+   {
+      return -1;
+   } // if
+   stream &s = _streams[_streamCount];
+   if(_setTopic(s.t, prefix, name) == false)
+   {
+      return -1;
+   } // if
+   s.intervalMs = intervalMs;
+   s.startMs = 0;
+   s.sequence = 0;
+   s.used = 0;
+   s.count = 0;
+   return (int8_t)_streamCount++;
+} // amTelemetry::addStream()
+
+/**
+ * @brief Register an unbatched topic.
+ * @param prefix Start of the topic, e.g. the top of the tree. May be nullptr.
+ * @param name Rest of the topic.
+ * @return Number for event(), or -1 if the table is full or the topic too long.
+===================================================================================================*/
+int8_t amTelemetry::addEvents(const char* prefix, const char* name)
+{
+   if(_eventCount >= TLM_MAX_EVENTS || _setTopic(_events[_eventCount], prefix, name) == false)
+   {
+      return -1;
+   } // if
+   return (int8_t)_eventCount++;
+} // amTelemetry::addEvents()
+
+/**
+ * @brief Add a sample to a stream's batch.
+ * @param stream Number from addStream().
+ * @param nowMs Time of the sample.
+ * @param data Sample bytes, copied.
+ * @param len Bytes of data.
+ * @return TLM_OK or TLM_BAD_ID. Held and dropped batches are counted, not reported.
+===================================================================================================*/
+uint8_t amTelemetry::sample(int8_t stream, uint32_t nowMs, const void* data, uint8_t len)
+{
+   uint8_t* dest = reserve(stream, nowMs, len);
+   if(dest == nullptr)
+   {
+      return TLM_BAD_ID;
+   } // if
+   memcpy(dest, data, len);
+   if(_streams[stream].intervalMs == 0)
+   {
+      _sendBatch(_streams[stream]);
+   } // if
+   return TLM_OK;
+} // amTelemetry::sample()
+
+/**
+ * @brief Make room for a sample in a stream's batch, so that it can be serialized in place.
+ * @details A batch covers intervalMs from its first sample. A sample that falls after that, or
+ * that would not fit, or that would be more than 65535ms after the first sample, sends the batch
+ * first and starts the next one. A batch the window will not take yet is held and keeps growing,
+ * until it is full, when it is dropped to make way for the new sample. The caller must fill in all
+ * len bytes before the next call on this publisher. Streams with an interval of 0 are sent by the
+ * next call, not by this one, so use sample() for those.
+ * @param stream Number from addStream().
+ * @param nowMs Time of the sample.
+ * @param len Bytes of sample.
+ * @return Where to write the sample, or nullptr if there is no such stream.
+===================================================================================================*/
+uint8_t* amTelemetry::reserve(int8_t stream, uint32_t nowMs, uint8_t len)
+{
+   if(stream < 0 || stream >= _streamCount)
+   {
+      return nullptr;
+   } // if
+   amTelemetry::stream &s = _streams[stream];
+   if(s.count > 0)
+   {
+      bool full = s.used + TLM_SAMPLE_HEADER + len > TLM_FRAME_LEN || s.count == 255 || nowMs - s.startMs > 0xFFFF;
+      if((full || nowMs - s.startMs >= s.intervalMs) && _sendBatch(s) == false && full)
+      {
+         _dropBatch(s);
+      } // if
+   } // if
+   if(s.count == 0)
+   {
+      s.startMs = nowMs;
+      s.used = TLM_BATCH_HEADER;
+   } // if
+   uint16_t offsetMs = (uint16_t)(nowMs - s.startMs);
+   uint8_t* dest = &s.frame[s.used + TLM_SAMPLE_HEADER];
+   s.frame[s.used] = (uint8_t)offsetMs;
+   s.frame[s.used + 1] = (uint8_t)(offsetMs >> 8);
+   s.frame[s.used + 2] = len;
+   s.used += TLM_SAMPLE_HEADER + len;
+   s.count++;
+   _stats.samples++;
+   return dest;
+} // amTelemetry::reserve()
+
+/**
+ * @brief Send an event now, at QoS 1.
+ * @param id Number from addEvents().
+ * @param payload Bytes to send.
+ * @param len Bytes of payload.
+ * @return TLM_OK, TLM_BAD_ID, TLM_TOO_BIG, TLM_BUSY or TLM_SEND_FAILED.
+===================================================================================================*/
+uint8_t amTelemetry::event(int8_t id, const void* payload, size_t len)
+{
+   if(id < 0 || id >= _eventCount)
+   {
+      return TLM_BAD_ID;
+   } // if
+   if(len > TLM_FRAME_LEN)
+   {
+      return TLM_TOO_BIG;
+   } // if
+   uint8_t status;
+   if(_send(_events[id], TLM_QOS_EVENT, (const uint8_t*)payload, len, &status) == false)
+   {
+      _stats.droppedEvents++;
+      return status;
+   } // if
+   _stats.events++;
+   return TLM_OK;
+} // amTelemetry::event()
+
+/**
+ * @brief Send a text event now, at QoS 1.
+ * @param id Number from addEvents().
+ * @param text 0 terminated text. The 0 is not sent.
+ * @return As event().
+===================================================================================================*/
+uint8_t amTelemetry::event(int8_t id, const char* text)
+{
+   return event(id, text, strlen(text));
+} // amTelemetry::event()
+
+/**
+ * @brief Send the batches whose interval is up. Call often, e.g. from loop().
+ * @param nowMs Time now.
+===================================================================================================*/
+void amTelemetry::poll(uint32_t nowMs)
+{
+   for(uint8_t i = 0; i < _streamCount; i++)
+   {
+      stream &s = _streams[i];
+      if(s.count > 0 && nowMs - s.startMs >= s.intervalMs)
+      {
+         _sendBatch(s);
+      } // if
+   } // for
+} // amTelemetry::poll()
+
+/**
+ * @brief Send every batch that has samples, due or not. Batches the window cannot take are held.
+===================================================================================================*/
+void amTelemetry::flush()
+{
+   for(uint8_t i = 0; i < _streamCount; i++)
+   {
+      if(_streams[i].count > 0)
+      {
+         _sendBatch(_streams[i]);
+      } // if
+   } // for
+} // amTelemetry::flush()
+
+/**
+ * @brief Full topic of a stream.
+ * @param stream Number from addStream().
+ * @return Topic, or nullptr if there is no such stream.
+===================================================================================================*/
+const char* amTelemetry::getStreamTopic(int8_t stream) const
+{
+   return (stream >= 0 && stream < _streamCount) ? _streams[stream].t.name : nullptr;
+} // amTelemetry::getStreamTopic()
+
+/**
+ * @brief Full topic of an event topic.
+ * @param id Number from addEvents().
+ * @return Topic, or nullptr if there is no such event topic.
+===================================================================================================*/
+const char* amTelemetry::getEventTopic(int8_t id) const
+{
+   return (id >= 0 && id < _eventCount) ? _events[id].name : nullptr;
+} // amTelemetry::getEventTopic()
+
+/**
+ * @brief Samples waiting in a stream's batch.
+ * @param stream Number from addStream().
+ * @return Samples not yet sent, 0 if there is no such stream.
+===================================================================================================*/
+uint8_t amTelemetry::getPending(int8_t stream) const
+{
+   return (stream >= 0 && stream < _streamCount) ? _streams[stream].count : 0;
+} // amTelemetry::getPending()
+
+/**
+ * @brief Join a prefix and a name into a topic.
+ * @return false if the result would not fit in TLM_TOPIC_LEN.
+===================================================================================================*/
+bool amTelemetry::_setTopic(topic &t, const char* prefix, const char* name)
+{
+   size_t prefixLen = (prefix != nullptr) ? strlen(prefix) : 0;
+   size_t nameLen = strlen(name);
+   if(prefixLen + nameLen + 1 > TLM_TOPIC_LEN)
+   {
+      return false;
+   } // if
+   if(prefixLen > 0)
+   {
+      memcpy(t.name, prefix, prefixLen);
+   } // if
+   memcpy(t.name + prefixLen, name, nameLen + 1); // With its 0.
+   t.len = (uint8_t)(prefixLen + nameLen);
+   return true;
+} // amTelemetry::_setTopic()
+
+/**
+ * @brief Hand a packet to the client if the send window can take all of it.
+ * @param status Where to put TLM_BUSY or TLM_SEND_FAILED when it was not sent.
+ * @return true if the client took it.
+===================================================================================================*/
+bool amTelemetry::_send(const topic &t, uint8_t qos, const uint8_t* payload, size_t len, uint8_t* status)
+{
+   size_t wire = tlmWireSize(t.len, len, qos);
+   if(_readyFn != nullptr && _readyFn(_context, wire) == false)
+   {
+      *status = TLM_BUSY;
+      return false;
+   } // if
+   if(_sendFn(_context, t.name, qos, payload, len) == false)
+   {
+      *status = TLM_SEND_FAILED;
+      return false;
+   } // if
+   _stats.wireBytes += wire;
+   return true;
+} // amTelemetry::_send()
+
+/**
+ * @brief Fill in the header of a batch and try to send it.
+ * @return false if the batch is still held.
+===================================================================================================*/
+bool amTelemetry::_sendBatch(stream &s)
+{
+   s.frame[0] = TLM_BATCH_VERSION;
+   s.frame[1] = s.count;
+   s.frame[2] = (uint8_t)s.sequence;
+   s.frame[3] = (uint8_t)(s.sequence >> 8);
+   s.frame[4] = (uint8_t)s.startMs;
+   s.frame[5] = (uint8_t)(s.startMs >> 8);
+   s.frame[6] = (uint8_t)(s.startMs >> 16);
+   s.frame[7] = (uint8_t)(s.startMs >> 24);
+   uint8_t status;
+   if(_send(s.t, TLM_QOS_STREAM, s.frame, s.used, &status) == false)
+   {
+      _stats.deferred++;
+      return false;
+   } // if
+   _stats.batches++;
+   s.sequence++;
+   s.count = 0;
+   s.used = 0;
+   return true;
+} // amTelemetry::_sendBatch()
+
+/**
+ * @brief Throw a held batch away. Its sequence number is used up so the receiver sees the gap.
+===================================================================================================*/
+void amTelemetry::_dropBatch(stream &s)
+{
+   _stats.droppedSamples += s.count;
+   s.sequence++;
+   s.count = 0;
+   s.used = 0;
+} // amTelemetry::_dropBatch()
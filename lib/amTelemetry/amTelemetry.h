@@ -0,0 +1,159 @@
+/*************************************************************************************************************************************
+ * @file amTelemetry.h
+ * @author va3wam
+ * @brief Batching MQTT telemetry publisher with precomputed topics and send window backpressure.
+ * @details Every topic is built once, when it is registered, so publishing never touches a string. Samples on a stream are
+ * appended to one framed payload per stream and sent together, at QoS 0, when the stream's interval is up or the frame is full.
+ * Events are sent straight away at QoS 1. Nothing is handed to the MQTT client unless the ready callback says the TCP send
+ * window can take the whole packet now, so a slow link shows up here, in the counters, instead of as a growing queue inside the
+ * client:
+ * - A stream batch that cannot go is held and retried. If it fills up while still held, it is dropped, the sequence number still
+ *   advances so the receiver can see the gap, and the new sample starts the next batch. Fresh data beats old data.
+ * - An event that cannot go is refused with TLM_BUSY and counted. The caller decides whether it matters.
+ * A batch frame is, little endian:
+ * | Bytes | Field                                                      |
+ * |:-----:|:-----------------------------------------------------------|
+ * |   1   | TLM_BATCH_VERSION                                          |
+ * |   1   | Samples in the frame                                       |
+ * |   2   | Sequence number. One per batch sent or dropped             |
+ * |   4   | Time of the first sample, ms                               |
+ * | 3 + n | Per sample: ms after the first sample (2), length (1), data |
+ * Sample data is opaque here. tlmReadHeader() and tlmNextSample() take a frame apart again.
+ * One task owns an amTelemetry. Nothing in it is locked.
+ * Example:
+ * @code
+ * amTelemetry telemetry(mqttSend, mqttReady, nullptr);
+ * int8_t tilt = telemetry.addStream("agingApprentice/", "zippy/tilt", 100); // Batches of up to 100ms.
+ * telemetry.sample(tilt, millis(), &reading, sizeof(reading)); // As often as readings come.
+ * tlmEncodeState(state, telemetry.reserve(tilt, millis(), TLM_STATE_LEN)); // Or serialize straight into the batch.
+ * telemetry.poll(millis()); // From loop(). Sends batches whose time is up.
+ * @endcode
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Add reserve() so samples can be serialized straight into the batch frame
+ *************************************************************************************************************************************/
+#ifndef amTelemetry_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amTelemetry_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <stddef.h> // size_t.
+
+#ifndef TLM_FRAME_LEN
+#define TLM_FRAME_LEN 384 // Bytes in one batch frame. With its topic this must fit MQTT_OUT_BUFFER_SIZE to stay off the heap.
+#endif
+#define TLM_MAX_STREAMS 3 // Batched topics.
+#define TLM_MAX_EVENTS 4 // Unbatched topics.
+#define TLM_TOPIC_LEN 64 // Longest topic, including the 0.
+#define TLM_BATCH_VERSION 1 // First byte of every batch frame.
+#define TLM_BATCH_HEADER 8 // Bytes before the first sample.
+#define TLM_SAMPLE_HEADER 3 // Bytes before the data of each sample.
+#define TLM_MAX_SAMPLE 255 // Largest sample. Its length is one byte.
+#define TLM_QOS_STREAM 0 // Lost samples are replaced by newer ones. Not worth a PUBACK each.
+#define TLM_QOS_EVENT 1 // Events are rare and each one matters.
+
+// Status codes returned by sample() and event().
+#define TLM_OK 0 // Added to the batch, or handed to the client.
+#define TLM_BAD_ID 1 // No such stream or event topic.
+#define TLM_TOO_BIG 2 // Event longer than TLM_FRAME_LEN.
+#define TLM_BUSY 3 // Send window full. The event was not sent.
+#define TLM_SEND_FAILED 4 // The client refused it, e.g. not connected.
+
+typedef bool (*tlmSend)(void* context, const char* topic, uint8_t qos, const uint8_t* payload, size_t len); // true if the client took it.
+typedef bool (*tlmReady)(void* context, size_t wireBytes); // true if a packet of wireBytes can be written now.
+
+/*! Counters since the publisher was made. */
+struct tlmStats
+{
+   uint32_t samples; ///< Samples added to a batch.
+   uint32_t batches; ///< Batches sent.
+   uint32_t events; ///< Events sent.
+   uint32_t droppedSamples; ///< Samples thrown away in batches that could not be sent in time.
+   uint32_t droppedEvents; ///< Events refused with TLM_BUSY or TLM_SEND_FAILED.
+   uint32_t deferred; ///< Times a due batch was held back because the window was full.
+   uint32_t wireBytes; ///< MQTT packet bytes handed to the client.
+}; // struct
+
+/*! Header of a batch frame, as tlmReadHeader() finds it. */
+struct tlmBatchHeader
+{
+   uint8_t version; ///< TLM_BATCH_VERSION.
+   uint8_t count; ///< Samples in the frame.
+   uint16_t sequence; ///< Batch number.
+   uint32_t startMs; ///< Time of the first sample.
+}; // struct
+
+/*! One sample of a batch frame, as tlmNextSample() finds it. Points into the frame. */
+struct tlmSample
+{
+   uint16_t offsetMs; ///< Time after the first sample of the batch.
+   uint8_t len; ///< Bytes of data.
+   const uint8_t* data; ///< Sample data.
+}; // struct
+
+size_t tlmWireSize(size_t topicLen, size_t payloadLen, uint8_t qos); // Bytes of the MQTT PUBLISH packet that carries a payload.
+bool tlmReadHeader(const uint8_t* frame, size_t len, tlmBatchHeader* header); // Check and read the header of a batch frame.
+bool tlmNextSample(const uint8_t* frame, size_t len, size_t* offset, tlmSample* sample); // Step through the samples of a batch frame.
+
+/*************************************************************************************************************************************
+ * @class Publisher of batched streams and single events.
+ *************************************************************************************************************************************/
+class amTelemetry
+{
+   public:
+      amTelemetry(tlmSend send, tlmReady ready, void* context); // Class constructor. ready may be nullptr.
+      int8_t addStream(const char* prefix, const char* name, uint16_t intervalMs); // Register a batched topic. -1 if it cannot.
+      int8_t addEvents(const char* prefix, const char* name); // Register an unbatched topic. -1 if it cannot.
+      uint8_t sample(int8_t stream, uint32_t nowMs, const void* data, uint8_t len); // Add a sample to a stream's batch.
+      uint8_t* reserve(int8_t stream, uint32_t nowMs, uint8_t len); // Make room for a sample and return where to write it.
+      uint8_t event(int8_t id, const void* payload, size_t len); // Send an event now.
+      uint8_t event(int8_t id, const char* text); // Send a text event now.
+      void poll(uint32_t nowMs); // Send batches whose interval is up.
+      void flush(); // Send every batch that has samples, due or not.
+      const char* getStreamTopic(int8_t stream) const; // Full topic of a stream, or nullptr.
+      const char* getEventTopic(int8_t id) const; // Full topic of an event topic, or nullptr.
+      uint8_t getPending(int8_t stream) const; // Samples waiting in a stream's batch.
+      tlmStats getStats() const { return _stats; } // amTelemetry::getStats()
+   private:
+      struct topic
+      {
+         char name[TLM_TOPIC_LEN]; // Full topic.
+         uint8_t len; // Characters in name.
+      }; // struct
+      struct stream
+      {
+         topic t; // Where batches go.
+         uint16_t intervalMs; // Longest a sample waits in the batch.
+         uint32_t startMs; // Time of the first sample in the batch.
+         uint16_t sequence; // Number of the batch being filled.
+         uint16_t used; // Bytes of frame in use, header included.
+         uint8_t count; // Samples in the batch.
+         uint8_t frame[TLM_FRAME_LEN]; // Batch being filled.
+      }; // struct
+      bool _setTopic(topic &t, const char* prefix, const char* name); // Join prefix and name into t.
+      bool _send(const topic &t, uint8_t qos, const uint8_t* payload, size_t len, uint8_t* status); // Check the window and send.
+      bool _sendBatch(stream &s); // Try to send a batch. false if it is still held.
+      void _dropBatch(stream &s); // Throw a held batch away.
+      tlmSend _sendFn; // Hands packets to the MQTT client.
+      tlmReady _readyFn; // Asks whether the send window has room.
+      void* _context; // Passed back to _sendFn and _readyFn.
+      stream _streams[TLM_MAX_STREAMS]; // Batched topics.
+      topic _events[TLM_MAX_EVENTS]; // Unbatched topics.
+      uint8_t _streamCount; // Streams registered.
+      uint8_t _eventCount; // Event topics registered.
+      tlmStats _stats; // Counters.
+}; // class amTelemetry
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,299 @@
+/*************************************************************************************************************************************
+ * @file amTelemetrySchema.cpp
+ * @author va3wam
+ * @brief Binary telemetry samples: robot state at the streaming rate and robot health once a second.
+ * @details See amTelemetrySchema.h.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Add the I2C sample
+ *************************************************************************************************************************************/
+#include <stdio.h> // snprintf().
+#include <amTelemetrySchema.h> // Header file for linking.
+
+/**
+ * @brief Write a 16 bit value, least significant byte first.
+ * @return Where the next field goes.
+===================================================================================================*/
+static uint8_t* put16(uint8_t* out, uint16_t value)
+{
+   out[0] = (uint8_t)value;
+   out[1] = (uint8_t)(value >> 8);
+   return out + 2;
+} // put16()
+
+/**
+ * @brief Write a 32 bit value, least significant byte first.
+ * @return Where the next field goes.
+===================================================================================================*/
+static uint8_t* put32(uint8_t* out, uint32_t value)
+{
+   out[0] = (uint8_t)value;
+   out[1] = (uint8_t)(value >> 8);
+   out[2] = (uint8_t)(value >> 16);
+   out[3] = (uint8_t)(value >> 24);
+   return out + 4;
+} // put32()
+
+/**
+ * @brief Read a 16 bit value written by put16().
+===================================================================================================*/
+static uint16_t get16(const uint8_t* in)
+{
+   return (uint16_t)(in[0] | (in[1] << 8));
+} // get16()
+
+/**
+ * @brief Read a 32 bit value written by put32().
+===================================================================================================*/
+static uint32_t get32(const uint8_t* in)
+{
+   return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+} // get32()
+
+/**
+ * @brief Scale a value to fixed point.
+ * @param value Value in its own units, e.g. degrees.
+ * @param unitsPerOne Fixed point steps per unit, e.g. 100 for 0.01 degree.
+ * @return Nearest step, clamped to the int16_t range.
+===================================================================================================*/
+int16_t tlmFixed16(float value, float unitsPerOne)
+{
+   float scaled = value * unitsPerOne;
+   if(!(scaled > -32768.0f)) // Also catches NaN.
+   {
+      return (scaled != scaled) ? 0 : -32768;
+   } // if
+   if(scaled > 32767.0f)
+   {
+      return 32767;
+   } // if
+   return (int16_t)(scaled + ((scaled < 0) ? -0.5f : 0.5f));
+} // tlmFixed16()
+
+/**
+ * @brief Clamp a count or time to 16 bits.
+===================================================================================================*/
+uint16_t tlmClamp16(uint32_t value)
+{
+   return (value > 0xFFFF) ? 0xFFFF : (uint16_t)value;
+} // tlmClamp16()
+
+/**
+ * @brief Write a state sample.
+ * @param state Sample.
+ * @param out Where to write it. Needs TLM_STATE_LEN bytes, e.g. from amTelemetry::reserve().
+===================================================================================================*/
+void tlmEncodeState(const tlmState &state, uint8_t* out)
+{
+   *out++ = TLM_SCHEMA_STATE;
+   out = put16(out, (uint16_t)state.pitch);
+   out = put16(out, (uint16_t)state.pitchRate);
+   out = put16(out, (uint16_t)state.wheelSpeed1);
+   out = put16(out, (uint16_t)state.wheelSpeed2);
+   out = put32(out, (uint32_t)state.encoder1);
+   out = put32(out, (uint32_t)state.encoder2);
+   *out++ = state.batteryVolts;
+   *out++ = state.motorCurrent1;
+   *out++ = state.motorCurrent2;
+   out = put16(out, state.execUs);
+   *out = state.flags;
+} // tlmEncodeState()
+
+/**
+ * @brief Write a health sample.
+ * @param health Sample.
+ * @param out Where to write it. Needs TLM_HEALTH_LEN bytes.
+===================================================================================================*/
+void tlmEncodeHealth(const tlmHealth &health, uint8_t* out)
+{
+   *out++ = TLM_SCHEMA_HEALTH;
+   out = put32(out, health.uptimeMs);
+   out = put32(out, health.freeHeap);
+   out = put32(out, health.minFreeHeap);
+   out = put32(out, health.maxAllocHeap);
+   out = put16(out, health.loopPeriodUs);
+   out = put16(out, health.loopExecMaxUs);
+   out = put16(out, health.loopJitterMaxUs);
+   out = put32(out, health.loopOverruns);
+   out = put32(out, health.telemetryDropped);
+   put32(out, health.stateLost);
+} // tlmEncodeHealth()
+
+/**
+ * @brief Write an I2C sample.
+ * @param i2c Sample.
+ * @param out Where to write it. Needs TLM_I2C_LEN bytes.
+===================================================================================================*/
+void tlmEncodeI2c(const tlmI2c &i2c, uint8_t* out)
+{
+   *out++ = TLM_SCHEMA_I2C;
+   *out++ = i2c.bus;
+   *out++ = i2c.address;
+   out = put32(out, i2c.transactions);
+   out = put32(out, i2c.bytes);
+   out = put32(out, i2c.nacks);
+   out = put32(out, i2c.timeouts);
+   out = put32(out, i2c.errors);
+   out = put32(out, i2c.busyUs);
+   out = put32(out, i2c.maxUs);
+   for(uint8_t i = 0; i < TLM_I2C_BUCKETS; i++)
+   {
+      out = put32(out, i2c.buckets[i]);
+   } // for
+} // tlmEncodeI2c()
+
+/**
+ * @brief Read a state sample.
+ * @param in Sample, schema id first.
+ * @param len Bytes of sample. Bytes past TLM_STATE_LEN, from a later version, are ignored.
+ * @param state Where to put it.
+ * @return false if it is not a state sample or is too short.
+===================================================================================================*/
+bool tlmDecodeState(const uint8_t* in, size_t len, tlmState* state)
+{
+   if(len < TLM_STATE_LEN || in[0] != TLM_SCHEMA_STATE)
+   {
+      return false;
+   } // if
+   state->pitch = (int16_t)get16(in + 1);
+   state->pitchRate = (int16_t)get16(in + 3);
+   state->wheelSpeed1 = (int16_t)get16(in + 5);
+   state->wheelSpeed2 = (int16_t)get16(in + 7);
+   state->encoder1 = (int32_t)get32(in + 9);
+   state->encoder2 = (int32_t)get32(in + 13);
+   state->batteryVolts = in[17];
+   state->motorCurrent1 = in[18];
+   state->motorCurrent2 = in[19];
+   state->execUs = get16(in + 20);
+   state->flags = in[22];
+   return true;
+} // tlmDecodeState()
+
+/**
+ * @brief Read a health sample.
+ * @param in Sample, schema id first.
+ * @param len Bytes of sample. Bytes past TLM_HEALTH_LEN, from a later version, are ignored.
+ * @param health Where to put it.
+ * @return false if it is not a health sample or is too short.
+===================================================================================================*/
+bool tlmDecodeHealth(const uint8_t* in, size_t len, tlmHealth* health)
+{
+   if(len < TLM_HEALTH_LEN || in[0] != TLM_SCHEMA_HEALTH)
+   {
+      return false;
+   } // if
+   health->uptimeMs = get32(in + 1);
+   health->freeHeap = get32(in + 5);
+   health->minFreeHeap = get32(in + 9);
+   health->maxAllocHeap = get32(in + 13);
+   health->loopPeriodUs = get16(in + 17);
+   health->loopExecMaxUs = get16(in + 19);
+   health->loopJitterMaxUs = get16(in + 21);
+   health->loopOverruns = get32(in + 23);
+   health->telemetryDropped = get32(in + 27);
+   health->stateLost = get32(in + 31);
+   return true;
+} // tlmDecodeHealth()
+
+/**
+ * @brief Read an I2C sample.
+ * @param in Sample, schema id first.
+ * @param len Bytes of sample. Bytes past TLM_I2C_LEN, from a later version, are ignored.
+ * @param i2c Where to put it.
+ * @return false if it is not an I2C sample or is too short.
+===================================================================================================*/
+bool tlmDecodeI2c(const uint8_t* in, size_t len, tlmI2c* i2c)
+{
+   if(len < TLM_I2C_LEN || in[0] != TLM_SCHEMA_I2C)
+   {
+      return false;
+   } // if
+   i2c->bus = in[1];
+   i2c->address = in[2];
+   i2c->transactions = get32(in + 3);
+   i2c->bytes = get32(in + 7);
+   i2c->nacks = get32(in + 11);
+   i2c->timeouts = get32(in + 15);
+   i2c->errors = get32(in + 19);
+   i2c->busyUs = get32(in + 23);
+   i2c->maxUs = get32(in + 27);
+   for(uint8_t i = 0; i < TLM_I2C_BUCKETS; i++)
+   {
+      i2c->buckets[i] = get32(in + 31 + 4 * i);
+   } // for
+   return true;
+} // tlmDecodeI2c()
+
+/**
+ * @brief Column names for tlmFormatSample().
+ * @param schema Schema id.
+ * @return Comma separated names, or nullptr for a schema this build does not know.
+===================================================================================================*/
+const char* tlmFormatHeader(uint8_t schema)
+{
+   switch(schema)
+   {
+      case TLM_SCHEMA_STATE: return "pitch_deg,pitch_rate_dps,speed1_mps,speed2_mps,encoder1,encoder2,battery_v,current1_a,current2_a,exec_us,balancing,fallen";
+      case TLM_SCHEMA_HEALTH: return "uptime_ms,free_heap,min_free_heap,max_alloc_heap,period_us,exec_max_us,jitter_max_us,overruns,telemetry_dropped,state_lost";
+      case TLM_SCHEMA_I2C: return "bus,address,transactions,bytes,nacks,timeouts,errors,busy_us,max_us,"
+                                  "lt2us,lt4us,lt8us,lt16us,lt32us,lt64us,lt128us,lt256us,lt512us,lt1024us,lt2048us,lt4096us,lt8192us,lt16384us,lt32768us,ge32768us";
+      default: return nullptr;
+   } // switch
+} // tlmFormatHeader()
+
+/**
+ * @brief Write one sample as comma separated values in its natural units, e.g. degrees and volts.
+ * @param in Sample, schema id first.
+ * @param len Bytes of sample.
+ * @param out Where to write the text.
+ * @param size Room in out.
+ * @return Characters written, not counting the 0, or 0 for a sample of unknown schema or too short.
+===================================================================================================*/
+size_t tlmFormatSample(const uint8_t* in, size_t len, char* out, size_t size)
+{
+   int n = 0;
+   tlmState state;
+   tlmHealth health;
+   tlmI2c i2c;
+   if(tlmDecodeState(in, len, &state) == true)
+   {
+      n = snprintf(out, size, "%.2f,%.1f,%.3f,%.3f,%ld,%ld,%.1f,%.1f,%.1f,%u,%u,%u", state.pitch / 100.0, state.pitchRate / 10.0,
+                   state.wheelSpeed1 / 1000.0, state.wheelSpeed2 / 1000.0, (long)state.encoder1, (long)state.encoder2,
+                   state.batteryVolts / 10.0, state.motorCurrent1 / 10.0, state.motorCurrent2 / 10.0, (unsigned)state.execUs,
+                   (unsigned)((state.flags & TLM_STATE_BALANCING) != 0), (unsigned)((state.flags & TLM_STATE_FALLEN) != 0));
+   } // if
+   else if(tlmDecodeHealth(in, len, &health) == true)
+   {
+      n = snprintf(out, size, "%lu,%lu,%lu,%lu,%u,%u,%u,%lu,%lu,%lu", (unsigned long)health.uptimeMs, (unsigned long)health.freeHeap,
+                   (unsigned long)health.minFreeHeap, (unsigned long)health.maxAllocHeap, (unsigned)health.loopPeriodUs,
+                   (unsigned)health.loopExecMaxUs, (unsigned)health.loopJitterMaxUs, (unsigned long)health.loopOverruns,
+                   (unsigned long)health.telemetryDropped, (unsigned long)health.stateLost);
+   } // else if
+   else if(tlmDecodeI2c(in, len, &i2c) == true)
+   {
+      n = snprintf(out, size, "%u,0x%02X,%lu,%lu,%lu,%lu,%lu,%lu,%lu", (unsigned)i2c.bus, (unsigned)i2c.address,
+                   (unsigned long)i2c.transactions, (unsigned long)i2c.bytes, (unsigned long)i2c.nacks, (unsigned long)i2c.timeouts,
+                   (unsigned long)i2c.errors, (unsigned long)i2c.busyUs, (unsigned long)i2c.maxUs);
+      for(uint8_t i = 0; i < TLM_I2C_BUCKETS && n > 0 && (size_t)n < size; i++)
+      {
+         n += snprintf(out + n, size - n, ",%lu", (unsigned long)i2c.buckets[i]);
+      } // for
+   } // else if
+   if(n <= 0)
+   {
+      return 0;
+   } // if
+   return ((size_t)n < size) ? (size_t)n : size - 1;
+} // tlmFormatSample()
@@ -0,0 +1,131 @@
+/*************************************************************************************************************************************
+ * @file amTelemetrySchema.h
+ * @author va3wam
+ * @brief Binary telemetry samples: robot state at the streaming rate, robot health once a second and I2C bus use.
+ * @details Each sample starts with a schema id byte followed by packed little endian fields in fixed point, so a sample means the
+ * same on the robot, the host and any other reader and needs no float encoding. The samples travel inside the batch frames of
+ * amTelemetry. Schemas only ever grow at the end: a reader takes the fields it knows from a sample at least as long as its schema
+ * and ignores the rest, and a field that has to change meaning gets a new schema id instead.
+ * State sample, TLM_SCHEMA_STATE, TLM_STATE_LEN bytes:
+ * | Bytes | Field                                | Units       |
+ * |:-----:|:-------------------------------------|:------------|
+ * |   1   | TLM_SCHEMA_STATE                     |             |
+ * |   2   | Pitch                                | 0.01 degree |
+ * |   2   | Pitch rate                           | 0.1 deg/s   |
+ * |  2+2  | Left, right wheel speed              | mm/s        |
+ * |  4+4  | Left, right encoder count            | ticks       |
+ * |   1   | Battery                              | 0.1 V       |
+ * |  1+1  | Left, right motor current            | 0.1 A       |
+ * |   2   | Balance cycle execution time         | us          |
+ * |   1   | Flags, TLM_STATE_xxx                 |             |
+ * Health sample, TLM_SCHEMA_HEALTH, TLM_HEALTH_LEN bytes:
+ * | Bytes | Field                                              | Units |
+ * |:-----:|:---------------------------------------------------|:------|
+ * |   1   | TLM_SCHEMA_HEALTH                                  |       |
+ * |   4   | Uptime                                             | ms    |
+ * |  4x3  | Free heap, lowest free heap, largest block         | bytes |
+ * |  2x3  | Balance period, worst execution time, worst jitter | us    |
+ * |   4   | Balance overruns                                   |       |
+ * |   4   | Telemetry samples dropped                          |       |
+ * |   4   | State samples lost before batching                 |       |
+ * I2C sample, TLM_SCHEMA_I2C, TLM_I2C_LEN bytes, one per address on a bus. Counts run from the last reset of the bus statistics:
+ * | Bytes | Field                                                     | Units |
+ * |:-----:|:----------------------------------------------------------|:------|
+ * |   1   | TLM_SCHEMA_I2C                                            |       |
+ * |  1+1  | Bus, 7 bit address. 0xFF for addresses sharing a count    |       |
+ * |   4   | Transactions                                              |       |
+ * |   4   | Bytes on the bus, address bytes included                  | bytes |
+ * |  4x3  | NACKs, timeouts, other errors                             |       |
+ * |  4+4  | Time on the bus, longest transaction                      | us    |
+ * | 4x16  | Transactions taking under 2us, then 2^n to 2^(n+1)-1 us   |       |
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Add the I2C sample
+ *************************************************************************************************************************************/
+#ifndef amTelemetrySchema_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amTelemetrySchema_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <stddef.h> // size_t.
+
+#define TLM_SCHEMA_STATE 1 // First byte of a state sample.
+#define TLM_SCHEMA_HEALTH 2 // First byte of a health sample.
+#define TLM_SCHEMA_I2C 3 // First byte of an I2C sample.
+#define TLM_STATE_LEN 23 // Bytes in a state sample.
+#define TLM_HEALTH_LEN 35 // Bytes in a health sample.
+#define TLM_I2C_LEN 95 // Bytes in an I2C sample.
+#define TLM_I2C_BUCKETS 16 // Bus time histogram buckets in an I2C sample.
+#define TLM_STATE_BALANCING 0x01 // Flag. Balance loop is driving the motors.
+#define TLM_STATE_FALLEN 0x02 // Flag. Balance loop thinks the robot has fallen over.
+
+/*! Robot state, in the units it is sent in. */
+struct tlmState
+{
+   int16_t pitch; ///< 0.01 degree.
+   int16_t pitchRate; ///< 0.1 degree/second.
+   int16_t wheelSpeed1; ///< Left wheel, mm/second.
+   int16_t wheelSpeed2; ///< Right wheel, mm/second.
+   int32_t encoder1; ///< Left encoder, ticks.
+   int32_t encoder2; ///< Right encoder, ticks.
+   uint8_t batteryVolts; ///< 0.1 volt.
+   uint8_t motorCurrent1; ///< Left motor, 0.1 amp.
+   uint8_t motorCurrent2; ///< Right motor, 0.1 amp.
+   uint16_t execUs; ///< Time the balance cycle took.
+   uint8_t flags; ///< TLM_STATE_xxx.
+}; // struct
+
+/*! Robot health, in the units it is sent in. */
+struct tlmHealth
+{
+   uint32_t uptimeMs; ///< Time since boot.
+   uint32_t freeHeap; ///< Heap free now.
+   uint32_t minFreeHeap; ///< Least heap there has been free since boot.
+   uint32_t maxAllocHeap; ///< Largest block that could be allocated now.
+   uint16_t loopPeriodUs; ///< Balance loop period.
+   uint16_t loopExecMaxUs; ///< Longest balance cycle.
+   uint16_t loopJitterMaxUs; ///< Worst balance period error.
+   uint32_t loopOverruns; ///< Balance cycles that overran or were missed.
+   uint32_t telemetryDropped; ///< Samples amTelemetry dropped for want of send window.
+   uint32_t stateLost; ///< State samples that never reached the batch.
+}; // struct
+
+/*! What one I2C address has cost its bus, in the units it is sent in. */
+struct tlmI2c
+{
+   uint8_t bus; ///< Bus number.
+   uint8_t address; ///< 7 bit address, or 0xFF for addresses sharing a count.
+   uint32_t transactions; ///< Transactions that went on the bus.
+   uint32_t bytes; ///< Bytes on the bus, address bytes included.
+   uint32_t nacks; ///< Transactions NACKed.
+   uint32_t timeouts; ///< Transactions that timed out on the bus or waiting for it.
+   uint32_t errors; ///< Transactions that failed some other way.
+   uint32_t busyUs; ///< Time on the bus.
+   uint32_t maxUs; ///< Longest transaction.
+   uint32_t buckets[TLM_I2C_BUCKETS]; ///< Transactions by time on the bus. Bucket 0 under 2us, bucket n 2^n to 2^(n+1)-1 us.
+}; // struct
+
+int16_t tlmFixed16(float value, float unitsPerOne); // Scale to fixed point, clamped to the int16_t range.
+uint16_t tlmClamp16(uint32_t value); // Clamp to the uint16_t range.
+void tlmEncodeState(const tlmState &state, uint8_t* out); // Write a state sample. out needs TLM_STATE_LEN bytes.
+void tlmEncodeHealth(const tlmHealth &health, uint8_t* out); // Write a health sample. out needs TLM_HEALTH_LEN bytes.
+void tlmEncodeI2c(const tlmI2c &i2c, uint8_t* out); // Write an I2C sample. out needs TLM_I2C_LEN bytes.
+bool tlmDecodeState(const uint8_t* in, size_t len, tlmState* state); // Read a state sample.
+bool tlmDecodeHealth(const uint8_t* in, size_t len, tlmHealth* health); // Read a health sample.
+bool tlmDecodeI2c(const uint8_t* in, size_t len, tlmI2c* i2c); // Read an I2C sample.
+size_t tlmFormatSample(const uint8_t* in, size_t len, char* out, size_t size); // One sample as comma separated values.
+const char* tlmFormatHeader(uint8_t schema); // Column names for tlmFormatSample(), or nullptr.
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,71 @@
+/*************************************************************************************************************************************
+ * @file amQ16.h
+ * @author va3wam
+ * @brief Q16.16 fixed point helpers.
+ * @details A q16 is an int32_t holding value * 65536, giving +/-32768 with a resolution of 0.000015. Everything here is inline
+ * integer arithmetic so it is safe in interrupt handlers, where the ESP32 does not save the FPU registers.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amQ16_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amQ16_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+
+typedef int32_t q16; // Q16.16 fixed point number.
+
+#define Q16_ONE ((q16) 65536) // 1.0
+#define Q16_PI ((q16) 205887) // pi
+#define Q16_HALF_PI ((q16) 102944) // pi / 2
+#define Q16_QUARTER_PI ((q16) 51472) // pi / 4
+
+inline q16 q16FromFloat(float value) { return (q16)(value * 65536.0f + ((value < 0.0f) ? -0.5f : 0.5f)); } // float to q16.
+inline float q16ToFloat(q16 value) { return (float)value / 65536.0f; } // q16 to float.
+inline q16 q16Mul(q16 a, q16 b) { return (q16)(((int64_t)a * b) >> 16); } // a * b.
+inline q16 q16Div(q16 a, q16 b) { return (q16)(((int64_t)a * 65536) / b); } // a / b. b must not be 0.
+
+/**
+ * @brief Four quadrant arctangent of y / x.
+ * @details Reduces to |z| <= 1 and uses atan(z) ~ pi/4 z - z (|z| - 1)(0.2447 + 0.0663 |z|), which is
+ * within 0.0015 radians (0.09 degrees) of the true value. Takes raw sensor counts or q16 values
+ * alike as only the ratio matters.
+ * @param y Opposite side.
+ * @param x Adjacent side.
+ * @return Angle in radians as a q16, -pi to pi. 0 when both are 0.
+===================================================================================================*/
+inline q16 q16Atan2(int32_t y, int32_t x)
+{
+   if(x == 0 && y == 0)
+   {
+      return 0;
+   } // if
+   int64_t ay = (y < 0) ? -(int64_t)y : y;
+   int64_t ax = (x < 0) ? -(int64_t)x : x;
+   bool swap = ay > ax; // Keep the ratio at or below 1.
+   q16 z = swap ? (q16)((ax << 16) / ay) : (q16)((ay << 16) / ax); // 0 to 1.
+   q16 angle = q16Mul(Q16_QUARTER_PI, z) + q16Mul(q16Mul(z, Q16_ONE - z), (q16)16037 + q16Mul((q16)4345, z)); // 0.2447, 0.0663.
+   if(swap)
+   {
+      angle = Q16_HALF_PI - angle;
+   } // if
+   if(x < 0)
+   {
+      angle = Q16_PI - angle;
+   } // if
+   return (y < 0) ? -angle : angle;
+} // q16Atan2()
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,359 @@
+/*************************************************************************************************************************************
+ * @file amTilt.cpp
+ * @author va3wam
+ * @brief Pitch estimators for the balance loop.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <math.h> // atan2f().
+#include <amTilt.h> // Header file for linking.
+
+#define TILT_RAD_PER_DEG 0.017453292f // pi / 180.
+#define TILT_KALMAN_MAX_STEPS 200000 // Most covariance updates used to find the steady state gains.
+
+/**
+ * @brief Pick one accelerometer axis out of a raw sample.
+===================================================================================================*/
+static int16_t accelAxis(const mpu6050Sample &sample, uint8_t axis)
+{
+   return (axis == TILT_AXIS_X) ? sample.accelX : (axis == TILT_AXIS_Y) ? sample.accelY : sample.accelZ;
+} // accelAxis()
+
+/**
+ * @brief Pick one gyro axis out of a raw sample.
+===================================================================================================*/
+static int16_t gyroAxis(const mpu6050Sample &sample, uint8_t axis)
+{
+   return (axis == TILT_AXIS_X) ? sample.gyroX : (axis == TILT_AXIS_Y) ? sample.gyroY : sample.gyroZ;
+} // gyroAxis()
+
+/**
+ * @brief Gyro scale for the fixed point filters.
+ * @return Radians/second per raw count * 2^48, signed for the mounting.
+===================================================================================================*/
+static int64_t rateScaleQ48(float gyroLsbPerDps, int8_t sign)
+{
+   double radPerLsb = TILT_RAD_PER_DEG / (double)gyroLsbPerDps;
+   return (int64_t)(radPerLsb * 281474976710656.0 * sign); // 2^48.
+} // rateScaleQ48()
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// @brief amTiltComplementary
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief This is the constructor for this class.
+ * @param dt Seconds between samples.
+ * @param timeConstant Seconds over which the accelerometer corrects gyro drift. Longer trusts the
+ * gyro more.
+ * @param gyroLsbPerDps Gyro scale. See amMPU6050::getGyroLsbPerDps().
+ * @param mounting How the sensor sits on the robot.
+===================================================================================================*/
+amTiltComplementary::amTiltComplementary(float dt, float timeConstant, float gyroLsbPerDps, tiltMounting mounting)
+   : _dt(dt), _alpha(timeConstant / (timeConstant + dt)), _radPerLsb(TILT_RAD_PER_DEG / gyroLsbPerDps * mounting.gyroSign), _mounting(mounting)
+{
+
+} // amTiltComplementary::amTiltComplementary()
+
+/**
+ * @brief Start again from a known angle.
+ * @param angle Radians.
+===================================================================================================*/
+void amTiltComplementary::reset(float angle)
+{
+   _angle = angle;
+   _rate = 0.0f;
+} // amTiltComplementary::reset()
+
+/**
+ * @brief Run the filter for one sample.
+ * @param accelAngle Pitch from the accelerometer in radians.
+ * @param rate Pitch rate from the gyro in radians/second.
+ * @return Estimated pitch in radians.
+===================================================================================================*/
+float amTiltComplementary::update(float accelAngle, float rate)
+{
+   _rate = rate;
+   _angle = _alpha * (_angle + rate * _dt) + (1.0f - _alpha) * accelAngle;
+   return _angle;
+} // amTiltComplementary::update()
+
+/**
+ * @brief Run the filter over a batch of raw samples.
+ * @param samples Raw samples, oldest first, as returned by amMPU6050::drainFifo().
+ * @param count Number of samples.
+ * @return Estimated pitch after the last sample.
+===================================================================================================*/
+float amTiltComplementary::updateBatch(const mpu6050Sample* samples, uint16_t count)
+{
+   for(uint16_t i = 0; i < count; i++)
+   {
+      float accelAngle = atan2f(accelAxis(samples[i], _mounting.forwardAxis), accelAxis(samples[i], _mounting.upAxis));
+      update(accelAngle, gyroAxis(samples[i], _mounting.gyroAxis) * _radPerLsb);
+   } // for
+   return _angle;
+} // amTiltComplementary::updateBatch()
+
+float amTiltComplementary::getAngle() { return _angle; } // amTiltComplementary::getAngle()
+float amTiltComplementary::getRate() { return _rate; } // amTiltComplementary::getRate()
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// @brief amTiltComplementaryQ16
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief This is the constructor for this class. Uses floats to set up, integers from then on.
+ * @param dt Seconds between samples.
+ * @param timeConstant Seconds over which the accelerometer corrects gyro drift.
+ * @param gyroLsbPerDps Gyro scale. See amMPU6050::getGyroLsbPerDps().
+ * @param mounting How the sensor sits on the robot.
+===================================================================================================*/
+amTiltComplementaryQ16::amTiltComplementaryQ16(float dt, float timeConstant, float gyroLsbPerDps, tiltMounting mounting)
+   : _mounting(mounting)
+{
+   _dt = (int64_t)((double)dt * 4294967296.0); // 2^32.
+   _beta = (int32_t)((double)dt / (timeConstant + dt) * 1073741824.0); // 2^30.
+   _rateScale = rateScaleQ48(gyroLsbPerDps, mounting.gyroSign);
+} // amTiltComplementaryQ16::amTiltComplementaryQ16()
+
+/**
+ * @brief Start again from a known angle.
+ * @param angle Radians.
+===================================================================================================*/
+void amTiltComplementaryQ16::reset(q16 angle)
+{
+   _angle = angle;
+   _angleAcc = (int64_t)angle * 65536;
+   _rate = 0;
+} // amTiltComplementaryQ16::reset()
+
+/**
+ * @brief Run the filter for one sample.
+ * @details Same maths as the float filter written as angle = predicted + beta * (accel - predicted).
+ * @param accelAngle Pitch from the accelerometer in radians.
+ * @param rate Pitch rate from the gyro in radians/second.
+ * @return Estimated pitch in radians.
+===================================================================================================*/
+q16 amTiltComplementaryQ16::update(q16 accelAngle, q16 rate)
+{
+   _rate = rate;
+   _angleAcc += ((int64_t)rate * _dt) >> 16; // Gyro path.
+   int64_t error = ((int64_t)accelAngle * 65536) - _angleAcc; // Accelerometer path. 2^32 scaled.
+   _angleAcc += (error >> 16) * _beta >> 14;
+   _angle = (q16)(_angleAcc >> 16);
+   return _angle;
+} // amTiltComplementaryQ16::update()
+
+/**
+ * @brief Run the filter over a batch of raw samples using integer maths only.
+ * @param samples Raw samples, oldest first, as returned by amMPU6050::drainFifo().
+ * @param count Number of samples.
+ * @return Estimated pitch after the last sample.
+===================================================================================================*/
+q16 amTiltComplementaryQ16::updateBatch(const mpu6050Sample* samples, uint16_t count)
+{
+   for(uint16_t i = 0; i < count; i++)
+   {
+      q16 accelAngle = q16Atan2(accelAxis(samples[i], _mounting.forwardAxis), accelAxis(samples[i], _mounting.upAxis));
+      update(accelAngle, (q16)(((int64_t)gyroAxis(samples[i], _mounting.gyroAxis) * _rateScale) >> 32));
+   } // for
+   return _angle;
+} // amTiltComplementaryQ16::updateBatch()
+
+q16 amTiltComplementaryQ16::getAngle() { return _angle; } // amTiltComplementaryQ16::getAngle()
+q16 amTiltComplementaryQ16::getRate() { return _rate; } // amTiltComplementaryQ16::getRate()
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// @brief amTiltKalman
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief This is the constructor for this class.
+ * @param dt Seconds between samples.
+ * @param gyroLsbPerDps Gyro scale. See amMPU6050::getGyroLsbPerDps().
+ * @param mounting How the sensor sits on the robot.
+ * @param noise Process and measurement noise.
+===================================================================================================*/
+amTiltKalman::amTiltKalman(float dt, float gyroLsbPerDps, tiltMounting mounting, tiltKalmanNoise noise)
+   : _dt(dt), _radPerLsb(TILT_RAD_PER_DEG / gyroLsbPerDps * mounting.gyroSign), _mounting(mounting), _noise(noise)
+{
+   reset(0.0f);
+} // amTiltKalman::amTiltKalman()
+
+/**
+ * @brief Start again from a known angle with no bias.
+ * @param angle Radians.
+===================================================================================================*/
+void amTiltKalman::reset(float angle)
+{
+   _angle = angle;
+   _bias = 0.0f;
+   _rate = 0.0f;
+   _p[0][0] = 0.0f;
+   _p[0][1] = 0.0f;
+   _p[1][0] = 0.0f;
+   _p[1][1] = 0.0f;
+} // amTiltKalman::reset()
+
+/**
+ * @brief Run the filter for one sample.
+ * @param accelAngle Pitch from the accelerometer in radians.
+ * @param rate Pitch rate from the gyro in radians/second.
+ * @return Estimated pitch in radians.
+===================================================================================================*/
+float amTiltKalman::update(float accelAngle, float rate)
+{
+   _rate = rate - _bias; // Predict.
+   _angle += _dt * _rate;
+   _p[0][0] += _dt * (_dt * _p[1][1] - _p[0][1] - _p[1][0] + _noise.qAngle);
+   _p[0][1] -= _dt * _p[1][1];
+   _p[1][0] -= _dt * _p[1][1];
+   _p[1][1] += _noise.qBias * _dt;
+   float s = _p[0][0] + _noise.rMeasure; // Correct.
+   float k0 = _p[0][0] / s;
+   float k1 = _p[1][0] / s;
+   float y = accelAngle - _angle;
+   _angle += k0 * y;
+   _bias += k1 * y;
+   float p00 = _p[0][0];
+   float p01 = _p[0][1];
+   _p[0][0] -= k0 * p00;
+   _p[0][1] -= k0 * p01;
+   _p[1][0] -= k1 * p00;
+   _p[1][1] -= k1 * p01;
+   return _angle;
+} // amTiltKalman::update()
+
+/**
+ * @brief Run the filter over a batch of raw samples.
+ * @param samples Raw samples, oldest first, as returned by amMPU6050::drainFifo().
+ * @param count Number of samples.
+ * @return Estimated pitch after the last sample.
+===================================================================================================*/
+float amTiltKalman::updateBatch(const mpu6050Sample* samples, uint16_t count)
+{
+   for(uint16_t i = 0; i < count; i++)
+   {
+      float accelAngle = atan2f(accelAxis(samples[i], _mounting.forwardAxis), accelAxis(samples[i], _mounting.upAxis));
+      update(accelAngle, gyroAxis(samples[i], _mounting.gyroAxis) * _radPerLsb);
+   } // for
+   return _angle;
+} // amTiltKalman::updateBatch()
+
+float amTiltKalman::getAngle() { return _angle; } // amTiltKalman::getAngle()
+float amTiltKalman::getRate() { return _rate; } // amTiltKalman::getRate()
+float amTiltKalman::getBias() { return _bias; } // amTiltKalman::getBias()
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// @brief amTiltKalmanQ16
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief This is the constructor for this class.
+ * @details Runs the covariance update with the given noise settings until the gains stop changing.
+ * Those steady state gains are what the float filter settles to after its first few seconds, and
+ * using them from the start keeps update() to integer multiplies and shifts.
+ * @param dt Seconds between samples.
+ * @param gyroLsbPerDps Gyro scale. See amMPU6050::getGyroLsbPerDps().
+ * @param mounting How the sensor sits on the robot.
+ * @param noise Process and measurement noise.
+===================================================================================================*/
+amTiltKalmanQ16::amTiltKalmanQ16(float dt, float gyroLsbPerDps, tiltMounting mounting, tiltKalmanNoise noise)
+   : _mounting(mounting)
+{
+   double p00 = 0.0, p01 = 0.0, p10 = 0.0, p11 = 0.0;
+   double k0 = 0.0, k1 = 0.0;
+   for(uint32_t i = 0; i < TILT_KALMAN_MAX_STEPS; i++)
+   {
+      p00 += dt * (dt * p11 - p01 - p10 + noise.qAngle);
+      p01 -= dt * p11;
+      p10 -= dt * p11;
+      p11 += noise.qBias * dt;
+      double s = p00 + noise.rMeasure;
+      double newK0 = p00 / s;
+      double newK1 = p10 / s;
+      double a00 = p00;
+      double a01 = p01;
+      p00 -= newK0 * a00;
+      p01 -= newK0 * a01;
+      p10 -= newK1 * a00;
+      p11 -= newK1 * a01;
+      bool settled = fabs(newK0 - k0) < 1e-12 && fabs(newK1 - k1) < 1e-12;
+      k0 = newK0;
+      k1 = newK1;
+      if(settled)
+      {
+         break;
+      } // if
+   } // for
+   _k0 = (int32_t)(k0 * 1073741824.0); // 2^30.
+   _k1 = (int32_t)(k1 * 1073741824.0);
+   _dt = (int64_t)((double)dt * 4294967296.0); // 2^32.
+   _rateScale = rateScaleQ48(gyroLsbPerDps, mounting.gyroSign);
+   reset(0);
+} // amTiltKalmanQ16::amTiltKalmanQ16()
+
+/**
+ * @brief Start again from a known angle with no bias.
+ * @param angle Radians.
+===================================================================================================*/
+void amTiltKalmanQ16::reset(q16 angle)
+{
+   _angle = angle;
+   _angleAcc = (int64_t)angle * 65536;
+   _bias = 0;
+   _biasAcc = 0;
+   _rate = 0;
+} // amTiltKalmanQ16::reset()
+
+/**
+ * @brief Run the filter for one sample.
+ * @param accelAngle Pitch from the accelerometer in radians.
+ * @param rate Pitch rate from the gyro in radians/second.
+ * @return Estimated pitch in radians.
+===================================================================================================*/
+q16 amTiltKalmanQ16::update(q16 accelAngle, q16 rate)
+{
+   _rate = rate - _bias; // Predict.
+   _angleAcc += ((int64_t)_rate * _dt) >> 16;
+   int64_t error = (((int64_t)accelAngle * 65536) - _angleAcc) >> 16; // Correct. Back to 2^16 scaled.
+   _angleAcc += (error * _k0) >> 14;
+   _biasAcc += (error * _k1) >> 14;
+   _angle = (q16)(_angleAcc >> 16);
+   _bias = (q16)(_biasAcc >> 16);
+   return _angle;
+} // amTiltKalmanQ16::update()
+
+/**
+ * @brief Run the filter over a batch of raw samples using integer maths only.
+ * @param samples Raw samples, oldest first, as returned by amMPU6050::drainFifo().
+ * @param count Number of samples.
+ * @return Estimated pitch after the last sample.
+===================================================================================================*/
+q16 amTiltKalmanQ16::updateBatch(const mpu6050Sample* samples, uint16_t count)
+{
+   for(uint16_t i = 0; i < count; i++)
+   {
+      q16 accelAngle = q16Atan2(accelAxis(samples[i], _mounting.forwardAxis), accelAxis(samples[i], _mounting.upAxis));
+      update(accelAngle, (q16)(((int64_t)gyroAxis(samples[i], _mounting.gyroAxis) * _rateScale) >> 32));
+   } // for
+   return _angle;
+} // amTiltKalmanQ16::updateBatch()
+
+q16 amTiltKalmanQ16::getAngle() { return _angle; } // amTiltKalmanQ16::getAngle()
+q16 amTiltKalmanQ16::getRate() { return _rate; } // amTiltKalmanQ16::getRate()
+q16 amTiltKalmanQ16::getBias() { return _bias; } // amTiltKalmanQ16::getBias()
+float amTiltKalmanQ16::getAngleGain() { return (float)_k0 / 1073741824.0f; } // amTiltKalmanQ16::getAngleGain()
+float amTiltKalmanQ16::getBiasGain() { return (float)_k1 / 1073741824.0f; } // amTiltKalmanQ16::getBiasGain()
@@ -0,0 +1,155 @@
+/*************************************************************************************************************************************
+ * @file amTilt.h
+ * @author va3wam
+ * @brief Pitch estimators for the balance loop.
+ * @details Two filters that fuse the accelerometer tilt (noisy but drift free) with the gyro rate (smooth but drifting):
+ * - Complementary filter: integrates the gyro and pulls towards the accelerometer angle with a fixed time constant.
+ * - Kalman filter: tracks angle and gyro bias, so a constant gyro offset is learned and removed.
+ * Each comes as a float class and a Q16.16 fixed point class with the same interface. The float classes suit the balance task;
+ * the Q16 classes use integer arithmetic only once constructed, for use in interrupt handlers where the ESP32 does not save the
+ * FPU registers. The Q16 Kalman filter runs with the steady state gains, worked out in the constructor, so its update is a handful
+ * of multiplies. updateBatch() takes a whole MPU6050 FIFO drain at once. Angles are radians, positive leaning forward.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amTilt_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amTilt_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <amQ16.h> // Q16.16 fixed point helpers.
+#include <amMPU6050.h> // mpu6050Sample.
+
+#define TILT_AXIS_X 0 // Sensor X axis.
+#define TILT_AXIS_Y 1 // Sensor Y axis.
+#define TILT_AXIS_Z 2 // Sensor Z axis.
+
+/*! How the MPU6050 is mounted on the robot. */
+struct tiltMounting
+{
+   uint8_t forwardAxis; ///< Accelerometer axis pointing forward when upright.
+   uint8_t upAxis; ///< Accelerometer axis pointing up when upright.
+   uint8_t gyroAxis; ///< Gyro axis the robot pitches about.
+   int8_t gyroSign; ///< 1 if that gyro axis reads positive when leaning forward, -1 if negative.
+}; // struct
+
+#define TILT_DEFAULT_MOUNTING {TILT_AXIS_X, TILT_AXIS_Z, TILT_AXIS_Y, 1} // Chip flat, X forward.
+
+/*! Kalman filter noise settings. */
+struct tiltKalmanNoise
+{
+   float qAngle; ///< Process noise of the angle.
+   float qBias; ///< Process noise of the gyro bias.
+   float rMeasure; ///< Measurement noise of the accelerometer angle.
+}; // struct
+
+#define TILT_DEFAULT_KALMAN_NOISE {0.001f, 0.003f, 0.03f} // Usual starting point for an MPU6050.
+
+/*************************************************************************************************************************************
+ * @class Complementary filter, float.
+ *************************************************************************************************************************************/
+class amTiltComplementary
+{
+   public:
+      amTiltComplementary(float dt, float timeConstant, float gyroLsbPerDps, tiltMounting mounting = TILT_DEFAULT_MOUNTING); // Constructor.
+      void reset(float angle); // Start again from a known angle.
+      float update(float accelAngle, float rate); // One sample. Returns the angle.
+      float updateBatch(const mpu6050Sample* samples, uint16_t count); // Raw samples, oldest first. Returns the angle.
+      float getAngle(); // Latest angle in radians.
+      float getRate(); // Latest pitch rate in radians/second.
+   private:
+      float _dt; // Seconds between samples.
+      float _alpha; // Weight given to the gyro path.
+      float _radPerLsb; // Gyro scale.
+      tiltMounting _mounting; // Sensor axes.
+      float _angle = 0.0f; // Estimated pitch.
+      float _rate = 0.0f; // Latest pitch rate.
+}; // class amTiltComplementary
+
+/*************************************************************************************************************************************
+ * @class Complementary filter, Q16.16.
+ *************************************************************************************************************************************/
+class amTiltComplementaryQ16
+{
+   public:
+      amTiltComplementaryQ16(float dt, float timeConstant, float gyroLsbPerDps, tiltMounting mounting = TILT_DEFAULT_MOUNTING); // Constructor.
+      void reset(q16 angle); // Start again from a known angle.
+      q16 update(q16 accelAngle, q16 rate); // One sample. Returns the angle.
+      q16 updateBatch(const mpu6050Sample* samples, uint16_t count); // Raw samples, oldest first. Returns the angle.
+      q16 getAngle(); // Latest angle in radians.
+      q16 getRate(); // Latest pitch rate in radians/second.
+   private:
+      int64_t _dt; // Seconds between samples * 2^32.
+      int32_t _beta; // Weight given to the accelerometer path (1 - alpha) * 2^30.
+      int64_t _rateScale; // Raw gyro count to radians/second * 2^48.
+      tiltMounting _mounting; // Sensor axes.
+      int64_t _angleAcc = 0; // Estimated pitch * 2^32. Extra bits stop small steps being lost.
+      q16 _angle = 0; // Estimated pitch.
+      q16 _rate = 0; // Latest pitch rate.
+}; // class amTiltComplementaryQ16
+
+/*************************************************************************************************************************************
+ * @class Two state (angle, gyro bias) Kalman filter, float.
+ *************************************************************************************************************************************/
+class amTiltKalman
+{
+   public:
+      amTiltKalman(float dt, float gyroLsbPerDps, tiltMounting mounting = TILT_DEFAULT_MOUNTING, tiltKalmanNoise noise = TILT_DEFAULT_KALMAN_NOISE); // Constructor.
+      void reset(float angle); // Start again from a known angle with no bias.
+      float update(float accelAngle, float rate); // One sample. Returns the angle.
+      float updateBatch(const mpu6050Sample* samples, uint16_t count); // Raw samples, oldest first. Returns the angle.
+      float getAngle(); // Latest angle in radians.
+      float getRate(); // Latest bias corrected pitch rate in radians/second.
+      float getBias(); // Estimated gyro bias in radians/second.
+   private:
+      float _dt; // Seconds between samples.
+      float _radPerLsb; // Gyro scale.
+      tiltMounting _mounting; // Sensor axes.
+      tiltKalmanNoise _noise; // Noise settings.
+      float _angle = 0.0f; // Estimated pitch.
+      float _bias = 0.0f; // Estimated gyro bias.
+      float _rate = 0.0f; // Bias corrected rate.
+      float _p[2][2]; // Error covariance.
+}; // class amTiltKalman
+
+/*************************************************************************************************************************************
+ * @class Two state (angle, gyro bias) steady state Kalman filter, Q16.16.
+ *************************************************************************************************************************************/
+class amTiltKalmanQ16
+{
+   public:
+      amTiltKalmanQ16(float dt, float gyroLsbPerDps, tiltMounting mounting = TILT_DEFAULT_MOUNTING, tiltKalmanNoise noise = TILT_DEFAULT_KALMAN_NOISE); // Constructor.
+      void reset(q16 angle); // Start again from a known angle with no bias.
+      q16 update(q16 accelAngle, q16 rate); // One sample. Returns the angle.
+      q16 updateBatch(const mpu6050Sample* samples, uint16_t count); // Raw samples, oldest first. Returns the angle.
+      q16 getAngle(); // Latest angle in radians.
+      q16 getRate(); // Latest bias corrected pitch rate in radians/second.
+      q16 getBias(); // Estimated gyro bias in radians/second.
+      float getAngleGain(); // Steady state gain applied to the angle.
+      float getBiasGain(); // Steady state gain applied to the bias.
+   private:
+      int64_t _dt; // Seconds between samples * 2^32.
+      int32_t _k0; // Steady state angle gain * 2^30.
+      int32_t _k1; // Steady state bias gain * 2^30.
+      int64_t _rateScale; // Raw gyro count to radians/second * 2^48.
+      tiltMounting _mounting; // Sensor axes.
+      int64_t _angleAcc = 0; // Estimated pitch * 2^32. Extra bits stop small steps being lost.
+      int64_t _biasAcc = 0; // Estimated gyro bias * 2^32.
+      q16 _angle = 0; // Estimated pitch.
+      q16 _bias = 0; // Estimated gyro bias.
+      q16 _rate = 0; // Bias corrected rate.
+}; // class amTiltKalmanQ16
+
+#endif // End of precompiler protected code block
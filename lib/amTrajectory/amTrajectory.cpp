@@ -0,0 +1,276 @@
+/*************************************************************************************************************************************
+ * @file amTrajectory.cpp
+ * @author va3wam
+ * @brief Trapezoidal and S-curve velocity profiles, and a queue of straight and turn segments that runs them.
+ * @details See amTrajectory.h.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <math.h> // sqrtf(), powf(), fabsf(), isfinite().
+#include <amTrajectory.h> // Header file for linking.
+
+/**
+ * @brief This is the constructor for this class. The profile starts as a move of no distance.
+===================================================================================================*/
+amProfile::amProfile()
+{
+} // amProfile::amProfile()
+
+/**
+ * @brief Work out the phases of a rest to rest move.
+ * @details The peak speed is vMax if the move is long enough, otherwise the highest speed the move
+ * can reach and still stop in time. An S-curve that cannot reach vMax before aMax would be needed
+ * peaks at a lower acceleration instead.
+ * @param shape PROFILE_TRAPEZOID or PROFILE_SCURVE.
+ * @param distance How far to move. Negative moves backwards.
+ * @param limits Speed, acceleration and jerk limits. All must be above 0. jMax is only needed for PROFILE_SCURVE.
+ * @return false if the shape or limits are not usable. The profile is then a move of no distance.
+===================================================================================================*/
+bool amProfile::plan(uint8_t shape, float distance, const profileLimits &limits)
+{
+   _phases = 0;
+   _end[0] = _end[1] = _end[2] = 0.0f;
+   _duration = 0.0f;
+   _distance = 0.0f;
+   _peak = 0.0f;
+   if(shape > PROFILE_SCURVE || !(limits.vMax > 0.0f) || !(limits.aMax > 0.0f) || (shape == PROFILE_SCURVE && !(limits.jMax > 0.0f)) || isfinite(distance) == false)
+   {
+      return false;
+   } // if
+   _distance = distance;
+   _sign = (distance < 0.0f) ? -1.0f : 1.0f;
+   float d = fabsf(distance);
+   if(d == 0.0f)
+   {
+      return true;
+   } // if
+   float v = limits.vMax;
+   float a = limits.aMax;
+   if(shape == PROFILE_TRAPEZOID)
+   {
+      float ramp = v / a; // Seconds to get up to speed, and to stop.
+      float cruise = d / v - ramp;
+      if(v * v > d * a) // Has to start slowing down before it gets to vMax.
+      {
+         v = sqrtf(d * a);
+         ramp = v / a;
+         cruise = 0.0f;
+      } // if
+      _addPhase(ramp, a, 0.0f);
+      _addPhase(cruise, 0.0f, 0.0f);
+      _addPhase(ramp, -a, 0.0f);
+      return true;
+   } // if
+   float j = limits.jMax;
+   bool aReached = true; // Acceleration gets to aMax.
+   if(v * j < a * a) // Reaches vMax before the jerk ramp gets to aMax.
+   {
+      a = sqrtf(v * j);
+      aReached = false;
+   } // if
+   float cruise = d / v - (v / a + a / j);
+   if(cruise < 0.0f) // Getting up to vMax and back down again is further than the move.
+   {
+      a = limits.aMax;
+      aReached = true;
+      float aj = a / j;
+      v = 0.5f * a * (sqrtf(aj * aj + 4.0f * d / a) - aj); // Solves d = v * (v / a + a / j) with aMax reached.
+      if(v * j < a * a) // Not even aMax is reached. d = 2 * v^1.5 / sqrt(j).
+      {
+         v = powf(0.5f * d * sqrtf(j), 2.0f / 3.0f);
+         a = sqrtf(v * j);
+         aReached = false;
+      } // if
+      cruise = 0.0f;
+   } // if
+   float ramp = a / j; // Seconds to ramp acceleration on or off.
+   float hold = aReached ? v / a - ramp : 0.0f; // Seconds at constant acceleration.
+   _addPhase(ramp, 0.0f, j);
+   _addPhase(hold, a, 0.0f);
+   _addPhase(ramp, a, -j);
+   _addPhase(cruise, 0.0f, 0.0f);
+   _addPhase(ramp, 0.0f, -j);
+   _addPhase(hold, -a, 0.0f);
+   _addPhase(ramp, -a, j);
+   return true;
+} // amProfile::plan()
+
+/**
+ * @brief Append a phase that starts where the last one ended.
+ * @details Phases of no length, such as the cruise of a move that never reaches vMax, are left out.
+ * @param length Seconds.
+ * @param accel Acceleration at the start of the phase.
+ * @param jerk Jerk throughout the phase.
+===================================================================================================*/
+void amProfile::_addPhase(float length, float accel, float jerk)
+{
+   if(!(length > 0.0f) || _phases >= PROFILE_MAX_PHASES)
+   {
+      return;
+   } // if
+   _phase[_phases++] = {_end[0], _end[1], _end[2], accel, jerk};
+   float t = length;
+   _end[0] += t;
+   _end[1] += t * (_end[2] + t * (accel * 0.5f + t * jerk / 6.0f));
+   _end[2] += t * (accel + t * jerk * 0.5f);
+   _duration = _end[0];
+   if(_end[2] > _peak)
+   {
+      _peak = _end[2];
+   } // if
+} // amProfile::_addPhase()
+
+/**
+ * @brief Where the move is at a moment of its run.
+ * @details Finds the phase with a scan of at most PROFILE_MAX_PHASES start times, then evaluates
+ * its cubic. Before the start the move is at rest at 0 and after the end at rest at its distance.
+ * @param t Seconds since the move started.
+ * @return Position, velocity and acceleration, with the sign of the distance.
+===================================================================================================*/
+profilePoint amProfile::at(float t) const
+{
+   if(_phases == 0 || !(t > 0.0f))
+   {
+      return {0.0f, 0.0f, 0.0f};
+   } // if
+   if(t >= _duration)
+   {
+      return {_distance, 0.0f, 0.0f}; // Exactly there, whatever rounding the phases picked up.
+   } // if
+   uint8_t i = _phases - 1;
+   while(i > 0 && _phase[i].start > t)
+   {
+      i--;
+   } // while
+   const phase &ph = _phase[i];
+   float dt = t - ph.start;
+   float position = ph.position + dt * (ph.velocity + dt * (ph.accel * 0.5f + dt * ph.jerk / 6.0f));
+   float velocity = ph.velocity + dt * (ph.accel + dt * ph.jerk * 0.5f);
+   float accel = ph.accel + dt * ph.jerk;
+   return {_sign * position, _sign * velocity, _sign * accel};
+} // amProfile::at()
+
+/**
+ * @brief This is the constructor for this class. The path starts empty.
+ * @param straight Limits for straight segments, metres.
+ * @param turn Limits for turns, radians.
+===================================================================================================*/
+amPath::amPath(profileLimits straight, profileLimits turn)
+   : _straight(straight), _turn(turn), _busy(false), _stopRequested(false), _started(0), _finished(0), _stopped(0)
+{
+} // amPath::amPath()
+
+/**
+ * @brief Queue a segment behind any already waiting. Call from the producer only.
+ * @param segment Segment to run.
+ * @return false if the segment is not valid or the queue is full.
+===================================================================================================*/
+bool amPath::add(const pathSegment &segment)
+{
+   if(segment.kind > PATH_TURN || segment.shape > PROFILE_SCURVE || isfinite(segment.amount) == false || _queue.push(&segment, sizeof(segment)) == false)
+   {
+      _rejected++;
+      return false;
+   } // if
+   return true;
+} // amPath::add()
+
+/**
+ * @brief Drop the running segment and every segment queued.
+ * @details Takes effect at the next tick(), which returns a setpoint of 0 from then on. Segments
+ * added before that tick are dropped as well.
+===================================================================================================*/
+void amPath::stop()
+{
+   _stopRequested.store(true, std::memory_order_release);
+} // amPath::stop()
+
+/**
+ * @brief Take the next segment off the queue and plan it.
+ * @param startUs When it starts.
+ * @return false if there was nothing queued.
+===================================================================================================*/
+bool amPath::_next(uint32_t startUs)
+{
+   pathSegment segment;
+   uint16_t len;
+   while(_queue.pop(&segment, sizeof(segment), &len) == true)
+   {
+      if(_profile.plan(segment.shape, segment.amount, (segment.kind == PATH_TURN) ? _turn : _straight) == false)
+      {
+         _stopped.fetch_add(1, std::memory_order_relaxed); // Limits not usable. Skip it.
+         continue;
+      } // if
+      _kind = segment.kind;
+      _startUs = startUs;
+      _durationUs = (uint32_t)(_profile.getDuration() * 1000000.0f + 0.5f);
+      _started.fetch_add(1, std::memory_order_relaxed);
+      _busy.store(true, std::memory_order_relaxed);
+      return true;
+   } // while
+   _busy.store(false, std::memory_order_relaxed);
+   return false;
+} // amPath::_next()
+
+/**
+ * @brief Setpoint for now. Call from the consumer only, once per control cycle.
+ * @details A segment that has run its time is counted as finished and the next one starts at the
+ * moment it ended, not at this tick, so a path takes the sum of its segment times however coarse
+ * the ticks are. A segment added while the path is idle starts now.
+ * @param nowUs micros().
+ * @return Speed and turn rate to drive at. All 0 with active false when there is nothing to run.
+===================================================================================================*/
+pathSetpoint amPath::tick(uint32_t nowUs)
+{
+   pathSetpoint setpoint = {0.0f, 0.0f, 0.0f, 0.0f, false};
+   if(_stopRequested.exchange(false, std::memory_order_acquire) == true)
+   {
+      uint32_t dropped = isBusy() ? 1 : 0;
+      pathSegment segment;
+      uint16_t len;
+      while(_queue.pop(&segment, sizeof(segment), &len) == true)
+      {
+         dropped++;
+      } // while
+      _stopped.fetch_add(dropped, std::memory_order_relaxed);
+      _busy.store(false, std::memory_order_relaxed);
+      return setpoint;
+   } // if
+   if(isBusy() == false && _next(nowUs) == false)
+   {
+      return setpoint;
+   } // if
+   while(nowUs - _startUs >= _durationUs) // Segment has run its time. Wraps with micros().
+   {
+      _finished.fetch_add(1, std::memory_order_relaxed);
+      if(_next(_startUs + _durationUs) == false)
+      {
+         return setpoint;
+      } // if
+   } // while
+   profilePoint point = _profile.at((nowUs - _startUs) * 0.000001f);
+   if(_kind == PATH_TURN)
+   {
+      setpoint.turnRate = point.velocity;
+      setpoint.turnAccel = point.accel;
+   } // if
+   else
+   {
+      setpoint.speed = point.velocity;
+      setpoint.accel = point.accel;
+   } // else
+   setpoint.active = true;
+   return setpoint;
+} // amPath::tick()
@@ -0,0 +1,153 @@
+/*************************************************************************************************************************************
+ * @file amTrajectory.h
+ * @author va3wam
+ * @brief Trapezoidal and S-curve velocity profiles, and a queue of straight and turn segments that runs them.
+ * @details amProfile plans a rest to rest move of a given distance under a speed, acceleration and, for the S-curve, jerk limit.
+ * The plan is at most seven phases of constant jerk, each holding the position, velocity and acceleration it starts with, so
+ * at() is a short scan of the phase start times and one cubic: the same few multiplies for every tick, with no table to fill.
+ * - PROFILE_TRAPEZOID ramps acceleration on and off in a step. Velocity is continuous, acceleration is not.
+ * - PROFILE_SCURVE ramps acceleration at jMax. Velocity and acceleration are both continuous.
+ * A move too short to reach vMax peaks lower and has no cruise. A move too short to reach aMax peaks lower still.
+ *
+ * amPath takes segments from one task and runs them, one after another, from the task that calls tick(). A straight segment is
+ * metres, profiled as the speed of the middle of the robot. A turn is radians on the spot, anticlockwise positive, profiled as the
+ * turn rate. Every segment starts and ends at rest, and each starts on the tick its last one ended, timed from when that one
+ * started, so the timing of a path does not drift with the tick rate.
+ * @code
+ * amPath path({0.3f, 0.5f, 2.0f}, {1.5f, 3.0f, 15.0f}); // Straight m/s, m/s/s, m/s/s/s. Turn rad/s, rad/s/s, rad/s/s/s.
+ * path.add({PATH_STRAIGHT, PROFILE_SCURVE, 0.5f}); // From loop().
+ * path.add({PATH_TURN, PROFILE_TRAPEZOID, 1.57f});
+ * pathSetpoint sp = path.tick(micros()); // Every control cycle.
+ * @endcode
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amTrajectory_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amTrajectory_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <atomic> // std::atomic.
+#include <amRing.h> // Lock free queue of segments.
+
+#define PROFILE_TRAPEZOID 0 // Constant acceleration ramps. Acceleration steps.
+#define PROFILE_SCURVE 1 // Jerk limited ramps. Acceleration is continuous.
+#define PROFILE_MAX_PHASES 7 // Jerk up, hold, down, cruise, then the same again slowing down.
+#define PATH_STRAIGHT 0 // Segment is a distance in metres.
+#define PATH_TURN 1 // Segment is a turn on the spot in radians.
+#define PATH_QUEUE 16 // Segments that can wait behind the one running. Power of 2.
+
+/*! Limits a profile must keep to. */
+struct profileLimits
+{
+   float vMax; ///< Largest speed. Units/second.
+   float aMax; ///< Largest acceleration. Units/second/second.
+   float jMax; ///< Largest jerk. Units/second/second/second. Not used by PROFILE_TRAPEZOID.
+}; // struct
+
+/*! Where a profile is at one moment. */
+struct profilePoint
+{
+   float position; ///< Units from the start.
+   float velocity; ///< Units/second.
+   float accel; ///< Units/second/second.
+}; // struct
+
+/*! One move of a path. */
+struct pathSegment
+{
+   uint8_t kind; ///< PATH_STRAIGHT or PATH_TURN.
+   uint8_t shape; ///< PROFILE_TRAPEZOID or PROFILE_SCURVE.
+   float amount; ///< Metres, backwards negative, or radians, anticlockwise positive.
+}; // struct
+
+/*! What a path wants from the drive train this tick. */
+struct pathSetpoint
+{
+   float speed; ///< Metres/second of the middle of the robot.
+   float accel; ///< Metres/second/second.
+   float turnRate; ///< Radians/second, anticlockwise positive.
+   float turnAccel; ///< Radians/second/second.
+   bool active; ///< A segment is running.
+}; // struct
+
+/*************************************************************************************************************************************
+ * @class Rest to rest velocity profile.
+ *************************************************************************************************************************************/
+class amProfile
+{
+   public:
+      amProfile(); // Class constructor.
+      bool plan(uint8_t shape, float distance, const profileLimits &limits); // Work out the phases of a move.
+      profilePoint at(float t) const; // Where the move is t seconds after it started.
+      float getDuration() { return _duration; } // amProfile::getDuration()
+      float getDistance() { return _distance; } // amProfile::getDistance()
+      float getPeakVelocity() { return _peak; } // amProfile::getPeakVelocity()
+      uint8_t getPhases() { return _phases; } // amProfile::getPhases()
+   private:
+      /*! One stretch of constant jerk. */
+      struct phase
+      {
+         float start; ///< Seconds from the start of the move.
+         float position; ///< Position at start.
+         float velocity; ///< Velocity at start.
+         float accel; ///< Acceleration at start.
+         float jerk; ///< Jerk throughout.
+      }; // struct
+      void _addPhase(float length, float accel, float jerk); // Append a phase, carrying on from the end of the last.
+      phase _phase[PROFILE_MAX_PHASES]; // Phases in time order. Always positive going, see _sign.
+      uint8_t _phases = 0; // Phases in use.
+      float _end[3] = {0.0f, 0.0f, 0.0f}; // Time, position and velocity at the end of the last phase added.
+      float _duration = 0.0f; // Seconds.
+      float _distance = 0.0f; // Signed distance.
+      float _sign = 1.0f; // -1 for a negative distance.
+      float _peak = 0.0f; // Largest speed reached.
+}; // class amProfile
+
+/*************************************************************************************************************************************
+ * @class Queue of straight and turn segments, run one after another.
+ * @details add() is for one producer task and tick() for one consumer task. stop() may be called from either.
+ *************************************************************************************************************************************/
+class amPath
+{
+   public:
+      amPath(profileLimits straight, profileLimits turn); // Class constructor.
+      bool add(const pathSegment &segment); // Producer only. Queue a segment.
+      void stop(); // Drop the running segment and everything queued, at the next tick().
+      pathSetpoint tick(uint32_t nowUs); // Consumer only. Setpoint for now.
+      bool isBusy() { return _busy.load(std::memory_order_relaxed); } // amPath::isBusy()
+      uint16_t getQueued() { return _queue.getCount(); } // amPath::getQueued()
+      uint32_t getStarted() { return _started.load(std::memory_order_relaxed); } // amPath::getStarted()
+      uint32_t getFinished() { return _finished.load(std::memory_order_relaxed); } // amPath::getFinished()
+      uint32_t getStopped() { return _stopped.load(std::memory_order_relaxed); } // amPath::getStopped()
+      uint32_t getRejected() { return _rejected; } // amPath::getRejected()
+   private:
+      bool _next(uint32_t startUs); // Plan the next queued segment.
+      amRing<PATH_QUEUE, sizeof(pathSegment)> _queue; // Segments waiting.
+      profileLimits _straight; // Limits for PATH_STRAIGHT.
+      profileLimits _turn; // Limits for PATH_TURN.
+      amProfile _profile; // Segment running.
+      uint8_t _kind = PATH_STRAIGHT; // Kind of segment running.
+      uint32_t _startUs = 0; // When the segment running started.
+      uint32_t _durationUs = 0; // How long it runs.
+      std::atomic<bool> _busy; // A segment is running.
+      std::atomic<bool> _stopRequested; // stop() has been called.
+      std::atomic<uint32_t> _started; // Segments started.
+      std::atomic<uint32_t> _finished; // Segments run to the end.
+      std::atomic<uint32_t> _stopped; // Segments dropped by stop(), running or queued.
+      uint32_t _rejected = 0; // Segments add() refused. Producer only.
+}; // class amPath
+
+#endif // End of precompiler protected code block
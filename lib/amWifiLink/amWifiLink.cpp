@@ -0,0 +1,199 @@
+/*************************************************************************************************************************************
+ * @file amWifiLink.cpp
+ * @author va3wam
+ * @brief WiFi bring up state machine: fast connect to the last access point, scan only when that fails.
+ * @details See amWifiLink.h.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <amWifiLink.h> // Header file for linking.
+
+/**
+ * @brief This is the constructor for this class. Nothing happens until start().
+ * @param fastTimeoutMs Longest a fast connect may take before falling back to a scan.
+ * @param attemptTimeoutMs Longest a scan and the join that follows it may take together.
+ * @param firstRetryMs Wait after the first failed scan or join.
+ * @param maxRetryMs Longest wait, however many failures.
+===================================================================================================*/
+amWifiLink::amWifiLink(uint32_t fastTimeoutMs, uint32_t attemptTimeoutMs, uint32_t firstRetryMs, uint32_t maxRetryMs)
+   : _fastTimeoutMs(fastTimeoutMs), _attemptTimeoutMs(attemptTimeoutMs), _firstRetryMs(firstRetryMs), _maxRetryMs(maxRetryMs),
+     _retryMs(firstRetryMs)
+{
+
+} // amWifiLink::amWifiLink()
+
+/**
+ * @brief Start bringing the link up. The first action is due straight away.
+ * @param nowMs Current time. Time to IP is measured from here.
+ * @param haveCache True if the owner remembers the access point it last got an address from.
+===================================================================================================*/
+void amWifiLink::start(uint32_t nowMs, bool haveCache)
+{
+   _haveCache = haveCache;
+   _everUp = false;
+   _firstByFast = false;
+   _startMs = nowMs;
+   _attemptMs = nowMs;
+   _timeToIpMs = 0;
+   _retryMs = _firstRetryMs;
+   _failures = 0;
+   if(haveCache) _enter(WF_FAST, WF_FAST_CONNECT, nowMs);
+   else _enter(WF_SCANNING, WF_SCAN, nowMs);
+} // amWifiLink::start()
+
+/**
+ * @brief Make no more attempts. A connection that is up is left to the owner.
+===================================================================================================*/
+void amWifiLink::stop()
+{
+   _state = WF_IDLE;
+   _pending = WF_NONE;
+} // amWifiLink::stop()
+
+/**
+ * @brief Say what to do now.
+ * @param nowMs Current time.
+ * @return uint8_t WF_NONE, or the WF_ action to take.
+===================================================================================================*/
+uint8_t amWifiLink::poll(uint32_t nowMs)
+{
+   if(_pending != WF_NONE) // Decided on the last event.
+   {
+      uint8_t action = _pending;
+      _pending = WF_NONE;
+      if(action == WF_FAST_CONNECT) _fastConnects++;
+      if(action == WF_SCAN) _scans++;
+      return action;
+   } // if
+   switch(_state)
+   {
+      case WF_FAST:
+         if(nowMs - _sinceMs < _fastTimeoutMs) return WF_NONE;
+         _attemptMs = nowMs; // Remembered access point did not answer. Scan straight away.
+         _enter(WF_SCANNING, WF_SCAN, nowMs);
+         return WF_ABORT;
+      case WF_SCANNING:
+      case WF_JOINING:
+         if(nowMs - _attemptMs < _attemptTimeoutMs) return WF_NONE;
+         _backoff(nowMs);
+         return WF_ABORT;
+      case WF_WAITING:
+         if(nowMs - _sinceMs < _waitMs) return WF_NONE;
+         _attemptMs = nowMs;
+         _enter(WF_SCANNING, WF_NONE, nowMs);
+         _scans++;
+         return WF_SCAN;
+      default:
+         return WF_NONE;
+   } // switch
+} // amWifiLink::poll()
+
+/**
+ * @brief The scan has finished. Join what it found, or wait and scan again.
+ * @param nowMs Current time.
+ * @param found True if a known access point was seen.
+===================================================================================================*/
+void amWifiLink::scanDone(uint32_t nowMs, bool found)
+{
+   if(_state != WF_SCANNING || _pending != WF_NONE) return; // Not a scan we asked for.
+   if(found) _enter(WF_JOINING, WF_JOIN, nowMs);
+   else _backoff(nowMs);
+} // amWifiLink::scanDone()
+
+/**
+ * @brief Have an IP address. Takes the link up however it got there, and resets the backoff.
+ * @param nowMs Current time.
+===================================================================================================*/
+void amWifiLink::gotIp(uint32_t nowMs)
+{
+   if(_state == WF_UP || _state == WF_IDLE) return;
+   if(!_everUp) // First address since start().
+   {
+      _everUp = true;
+      _timeToIpMs = nowMs - _startMs;
+      _firstByFast = (_state == WF_FAST);
+   } // if
+   if(_state == WF_FAST) _fastWins++;
+   _retryMs = _firstRetryMs;
+   _failures = 0;
+   _enter(WF_UP, WF_NONE, nowMs);
+} // amWifiLink::gotIp()
+
+/**
+ * @brief The connection went down, or an attempt to make one was turned away.
+ * @details A lost connection goes back to the fast connect. A fast connect that is turned away falls back to a scan without
+ * waiting for its timeout, and a join that is turned away waits out the backoff. Anything else is the echo of an attempt
+ * that has already been given up on.
+ * @param nowMs Current time.
+===================================================================================================*/
+void amWifiLink::lost(uint32_t nowMs)
+{
+   if(_pending != WF_NONE) return; // Belongs to the attempt before the one about to start.
+   switch(_state)
+   {
+      case WF_UP:
+         _losses++;
+         _attemptMs = nowMs;
+         if(_haveCache) _enter(WF_FAST, WF_FAST_CONNECT, nowMs);
+         else _enter(WF_SCANNING, WF_SCAN, nowMs);
+         break;
+      case WF_FAST:
+         _attemptMs = nowMs;
+         _enter(WF_SCANNING, WF_SCAN, nowMs);
+         break;
+      case WF_JOINING:
+         _backoff(nowMs);
+         break;
+      default:
+         break;
+   } // switch
+} // amWifiLink::lost()
+
+/**
+ * @brief Say how long until the next scan.
+ * @param nowMs Current time.
+ * @return uint32_t Milliseconds to go. 0 unless waiting.
+===================================================================================================*/
+uint32_t amWifiLink::getWaitMs(uint32_t nowMs)
+{
+   if(_state != WF_WAITING) return 0;
+   uint32_t waited = nowMs - _sinceMs;
+   return (waited >= _waitMs) ? 0 : _waitMs - waited;
+} // amWifiLink::getWaitMs()
+
+/**
+ * @brief Change state.
+ * @param state WF_ state to enter.
+ * @param pending WF_ action for the next poll() to hand out, or WF_NONE.
+ * @param nowMs Current time.
+===================================================================================================*/
+void amWifiLink::_enter(uint8_t state, uint8_t pending, uint32_t nowMs)
+{
+   _state = state;
+   _pending = pending;
+   _sinceMs = nowMs;
+} // amWifiLink::_enter()
+
+/**
+ * @brief Count a failed scan or join and wait before the next scan, twice as long as last time up to maxRetryMs.
+ * @param nowMs Current time.
+===================================================================================================*/
+void amWifiLink::_backoff(uint32_t nowMs)
+{
+   if(_failures < 255) _failures++;
+   _waitMs = _retryMs;
+   _retryMs = (_retryMs > _maxRetryMs / 2) ? _maxRetryMs : _retryMs * 2;
+   _enter(WF_WAITING, WF_NONE, nowMs);
+} // amWifiLink::_backoff()
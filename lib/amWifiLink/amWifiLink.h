@@ -0,0 +1,112 @@
+/*************************************************************************************************************************************
+ * @file amWifiLink.h
+ * @author va3wam
+ * @brief WiFi bring up state machine: fast connect to the last access point, scan only when that fails.
+ * @details Knows nothing of the radio. The owner reports what happened with scanDone(), gotIp() and lost() and calls poll()
+ * regularly, and poll() answers with what to do next. All times are passed in, in milliseconds, and wrap safely.
+ *
+ * When the owner has the BSSID and channel of the access point it last got an address from, the first attempt goes straight
+ * to it on that one channel, which takes a fraction of a second instead of the seconds a scan of every channel takes. Only if
+ * that fails, or there is nothing remembered, does a scan start. A scan that finds no known access point, or a join that does
+ * not get an address within attemptTimeoutMs, waits before scanning again, twice as long each time from firstRetryMs up to
+ * maxRetryMs. Losing the connection goes back to the fast connect.
+ * Example:
+ * @code
+ * amWifiLink link(3000, 15000, 1000, 60000);
+ * link.start(millis(), haveCachedAp);
+ * switch(link.poll(millis())) // From loop().
+ * {
+ *    case WF_FAST_CONNECT: WiFi.begin(ssid, password, cachedChannel, cachedBssid); break;
+ *    case WF_SCAN: WiFi.scanNetworks(true); break;
+ *    case WF_JOIN: WiFi.begin(ssid, password, foundChannel, foundBssid); break;
+ *    case WF_ABORT: WiFi.disconnect(); break;
+ * }
+ * link.scanDone(millis(), foundKnownAp); // Once WiFi.scanComplete() has an answer.
+ * link.gotIp(millis()); // From the WiFi events, handed over to the polling task.
+ * link.lost(millis());
+ * @endcode
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef amWifiLink_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define amWifiLink_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+
+// States.
+#define WF_IDLE 0 // Not started, or stopped.
+#define WF_FAST 1 // Joining the remembered access point on its channel, without a scan.
+#define WF_SCANNING 2 // Scanning every channel for known access points.
+#define WF_JOINING 3 // Joining the best known access point the scan found.
+#define WF_UP 4 // Have an IP address.
+#define WF_WAITING 5 // Waiting out the backoff before the next scan.
+
+// What poll() asks the owner to do.
+#define WF_NONE 0 // Nothing.
+#define WF_FAST_CONNECT 1 // Join the remembered access point.
+#define WF_SCAN 2 // Start a scan that does not wait for the answer.
+#define WF_JOIN 3 // Join the access point the scan picked.
+#define WF_ABORT 4 // Attempt took too long. Stop it. What comes next is already decided.
+
+/*************************************************************************************************************************************
+ * @class When to fast connect, scan and join.
+ *************************************************************************************************************************************/
+class amWifiLink
+{
+   public:
+      amWifiLink(uint32_t fastTimeoutMs, uint32_t attemptTimeoutMs, uint32_t firstRetryMs, uint32_t maxRetryMs); // Class constructor.
+      void start(uint32_t nowMs, bool haveCache); // Begin with a fast connect if there is an access point remembered.
+      void stop(); // Make no more attempts.
+      void setCache(bool haveCache) { _haveCache = haveCache; } // amWifiLink::setCache()
+      uint8_t poll(uint32_t nowMs); // What to do now. One of the WF_ actions.
+      void scanDone(uint32_t nowMs, bool found); // The scan finished. found is true if it saw a known access point.
+      void gotIp(uint32_t nowMs); // Have an IP address.
+      void lost(uint32_t nowMs); // The connection, or the attempt to make one, went down.
+      uint8_t getState() { return _state; } // amWifiLink::getState()
+      uint32_t getWaitMs(uint32_t nowMs); // Time until the next scan. 0 unless waiting.
+      uint32_t getTimeToIpMs() { return _timeToIpMs; } // From start() to the first IP address. 0 until then.
+      bool getFastWasUsed() { return _firstByFast; } // The first IP address came from a fast connect.
+      uint8_t getFailures() { return _failures; } // Scans and joins that failed since the last IP address.
+      uint32_t getFastConnects() { return _fastConnects; } // Fast connects tried.
+      uint32_t getFastWins() { return _fastWins; } // Fast connects that got an IP address.
+      uint32_t getScans() { return _scans; } // Scans started.
+      uint32_t getLosses() { return _losses; } // Connections that went down.
+   private:
+      void _enter(uint8_t state, uint8_t pending, uint32_t nowMs); // Change state, with an action to hand out on the next poll().
+      void _backoff(uint32_t nowMs); // Count a failure and wait before scanning again.
+      uint32_t _fastTimeoutMs; // Longest a fast connect may take.
+      uint32_t _attemptTimeoutMs; // Longest a scan and join may take together.
+      uint32_t _firstRetryMs; // First backoff step.
+      uint32_t _maxRetryMs; // Largest backoff step.
+      uint32_t _retryMs; // Next backoff step.
+      uint32_t _waitMs = 0; // Length of the current wait.
+      uint8_t _state = WF_IDLE; // WF_ state.
+      uint8_t _pending = WF_NONE; // Action for the next poll().
+      bool _haveCache = false; // Owner remembers an access point.
+      bool _everUp = false; // Had an IP address since start().
+      bool _firstByFast = false; // The first came from a fast connect.
+      uint32_t _startMs = 0; // When start() was called.
+      uint32_t _sinceMs = 0; // When the current state began.
+      uint32_t _attemptMs = 0; // When the current scan and join began.
+      uint32_t _timeToIpMs = 0; // From start() to the first IP address.
+      uint8_t _failures = 0; // Failures since the last IP address.
+      uint32_t _fastConnects = 0; // Fast connects tried.
+      uint32_t _fastWins = 0; // Fast connects that got an IP address.
+      uint32_t _scans = 0; // Scans started.
+      uint32_t _losses = 0; // Connections that went down.
+}; // class amWifiLink
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,147 @@
+/*************************************************************************************************************************************
+ * @file Arduino.h
+ * @author va3wam
+ * @brief Host stand-in for the Arduino Core for ESP32.
+ * @details Only used by [env:native]. Just enough of the core (String, Print, Serial, time, GPIO, ledc, ESP) for src/main.cpp,
+ * the include/ headers and the libraries they use to build and run on Linux. Time comes from the host clock. GPIO and ledc keep their
+ * state in memory so the firmware reads back what it wrote; input pins read HIGH unless a test sets them with hostSetPin().
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef Arduino_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define Arduino_h // Precompiler macro used for precompiler check.
+
+#ifndef ARDUINO
+#define ARDUINO 10805 // Third party libraries pick their Arduino 1.x code paths from this.
+#endif
+
+#include <stdint.h> // Fixed width integer types.
+#include <stddef.h> // size_t.
+#include <stdlib.h> // atoi(), abs().
+#include <string.h> // memcpy(), strlen().
+#include <stdio.h> // snprintf().
+#include <math.h> // Floating point maths.
+#include <algorithm> // std::min(), std::max().
+#include <binary.h> // B0 to B11111111.
+#include <WString.h> // Arduino String.
+#include <Print.h> // Print and Printable.
+#include <IPAddress.h> // IPv4 address.
+#include <freertos/FreeRTOS.h> // Tasks and notifications.
+
+typedef uint8_t byte; // Arduino byte.
+typedef bool boolean; // Arduino boolean.
+
+using std::min; // Arduino min().
+using std::max; // Arduino max().
+
+#define HIGH 0x1 // Pin level.
+#define LOW 0x0 // Pin level.
+#define INPUT 0x01 // pinMode() value.
+#define OUTPUT 0x02 // pinMode() value.
+#define PULLUP 0x04 // pinMode() value.
+#define INPUT_PULLUP 0x05 // pinMode() value.
+#define PULLDOWN 0x08 // pinMode() value.
+#define INPUT_PULLDOWN 0x09 // pinMode() value.
+#define OPEN_DRAIN 0x10 // pinMode() value.
+#define OUTPUT_OPEN_DRAIN 0x12 // pinMode() value. Drives LOW, lets go for HIGH.
+#define RISING 0x01 // attachInterrupt() mode.
+#define FALLING 0x02 // attachInterrupt() mode.
+#define CHANGE 0x03 // attachInterrupt() mode.
+#define PI 3.1415926535897932384626433832795 // Arduino PI.
+#define HALF_PI 1.5707963267948966192313216916398 // Arduino HALF_PI.
+#define TWO_PI 6.283185307179586476925286766559 // Arduino TWO_PI.
+#define DEG_TO_RAD 0.017453292519943295769236907684886 // Arduino DEG_TO_RAD.
+#define RAD_TO_DEG 57.295779513082320876798154814105 // Arduino RAD_TO_DEG.
+#define IRAM_ATTR // Code placement attribute. Means nothing on the host.
+#define PROGMEM // Flash placement attribute. Means nothing on the host.
+#define NUM_DIGITAL_PINS 40 // ESP32 GPIO count.
+#define digitalPinToInterrupt(p) (((p) < NUM_DIGITAL_PINS) ? (p) : -1) // ESP32 maps interrupts 1:1 to pins.
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt))) // Arduino constrain().
+
+/*************************************************************************************************************************************
+ * @class Serial port. Writes to stdout.
+ *************************************************************************************************************************************/
+class HardwareSerial : public Print
+{
+   public:
+      void begin(unsigned long baud) { _baud = baud; } // Remember the baud rate.
+      void end() {} // Nothing to release.
+      uint32_t baudRate() { return _baud; } // Baud rate passed to begin().
+      int available() { return 0; } // Nothing is ever typed.
+      int read() { return -1; } // Nothing is ever typed.
+      void flush(); // Flush stdout.
+      size_t write(uint8_t c); // Send one character to stdout.
+      size_t write(const uint8_t* buffer, size_t size); // Send a block to stdout.
+      using Print::write; // Keep the other Print::write() overloads.
+      operator bool() { return true; } // Port is always ready.
+   private:
+      unsigned long _baud = 0; // Baud rate passed to begin().
+}; // class HardwareSerial
+
+extern HardwareSerial Serial; // Console.
+
+/*************************************************************************************************************************************
+ * @class Chip details reported by ESP.
+ *************************************************************************************************************************************/
+class EspClass
+{
+   public:
+      const char* getSdkVersion() { return "host"; } // IDF version string.
+      const char* getChipModel() { return "host"; } // Chip model.
+      uint8_t getChipRevision() { return 0; } // Silicon revision.
+      uint8_t getChipCores() { return 2; } // Pretend to be dual core like the ESP32.
+      uint32_t getCpuFreqMHz() { return 240; } // Nominal ESP32 clock.
+      uint32_t getSketchSize() { return 0; } // No flash image on the host.
+      uint32_t getFreeSketchSpace() { return 0; } // No flash image on the host.
+      uint32_t getFreeHeap() { return 0; } // Not tracked on the host.
+      uint32_t getHeapSize() { return 0; } // Not tracked on the host.
+      uint32_t getMinFreeHeap() { return 0; } // Not tracked on the host.
+      uint32_t getMaxAllocHeap() { return 0x7FFFFFFF; } // Not tracked on the host. Large, so nothing is refused for want of heap.
+      uint32_t getCycleCount(); // Host clock in 240MHz ticks.
+      uint64_t getEfuseMac() { return 0x0000DEADBEEF0000ULL; } // Fixed fake MAC.
+      void restart(); // Ends the host process.
+}; // class EspClass
+
+extern EspClass ESP; // Chip details.
+
+unsigned long millis(); // Milliseconds since the program started.
+unsigned long micros(); // Microseconds since the program started.
+void delay(uint32_t ms); // Sleep the calling thread.
+void delayMicroseconds(uint32_t us); // Sleep the calling thread.
+void yield(); // Let other threads run.
+void pinMode(uint8_t pin, uint8_t mode); // Set a pin direction.
+void digitalWrite(uint8_t pin, uint8_t value); // Set an output pin.
+int digitalRead(uint8_t pin); // Read a pin.
+uint16_t analogRead(uint8_t pin); // Read a pin. Always 0 on the host.
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode); // Call isr when the pin changes.
+void detachInterrupt(uint8_t pin); // Stop calling the pin's isr.
+double ledcSetup(uint8_t channel, double freq, uint8_t resolutionBits); // Configure a PWM channel.
+void ledcAttachPin(uint8_t pin, uint8_t channel); // Drive a pin from a PWM channel.
+void ledcDetachPin(uint8_t pin); // Stop driving a pin from PWM.
+void ledcWrite(uint8_t channel, uint32_t duty); // Set a PWM channel duty cycle.
+uint32_t ledcRead(uint8_t channel); // Duty cycle last written to a PWM channel.
+long random(long howBig); // Arduino random().
+long random(long howSmall, long howBig); // Arduino random().
+void randomSeed(unsigned long seed); // Arduino randomSeed().
+long map(long x, long inMin, long inMax, long outMin, long outMax); // Arduino map().
+uint32_t getCpuFrequencyMhz(); // CPU clock. Always 240 on the host.
+
+// Host only. Lets the host runner and tests drive what the firmware sees.
+void hostSetPin(uint8_t pin, uint8_t value); // Drive an input pin. Runs its interrupt if the edge matches.
+void hostHoldPin(uint8_t pin, bool held); // Hold a shared open drain line LOW whatever the firmware writes, as a stuck device would.
+void hostOnPinWrite(void (*fn)(uint8_t pin, uint8_t value)); // Watch every digitalWrite(). nullptr to stop.
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,129 @@
+/*************************************************************************************************************************************
+ * @file AsyncMqttClient.h
+ * @author va3wam
+ * @brief Host stand-in for https://github.com/marvinroger/async-mqtt-client.
+ * @details There is no broker on the host. connect() only records that a connection was asked for. The host runner or a test
+ * plays the broker with hostAccept(), hostDrop() and hostDeliver() on hostClient(), which call the firmware's callbacks exactly as
+ * the real client does, and can look at what the firmware published through getPublishCount() and getLastTopic()/getLastPayload().
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Added hostClient() for clients a test cannot name, e.g. the one inside aaMqtt
+ *************************************************************************************************************************************/
+#ifndef AsyncMqttClient_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define AsyncMqttClient_h // Precompiler macro used for precompiler check.
+
+#include <functional> // Callback types, as the real client uses.
+#include <Arduino.h> // Host Arduino core.
+
+/*! Why the connection was lost. Same values as the real client. */
+enum class AsyncMqttClientDisconnectReason : uint8_t
+{
+   TCP_DISCONNECTED = 0,
+   MQTT_UNACCEPTABLE_PROTOCOL_VERSION = 1,
+   MQTT_IDENTIFIER_REJECTED = 2,
+   MQTT_SERVER_UNAVAILABLE = 3,
+   MQTT_MALFORMED_CREDENTIALS = 4,
+   MQTT_NOT_AUTHORIZED = 5,
+   ESP8266_NOT_ENOUGH_SPACE = 6,
+   TLS_BAD_FINGERPRINT = 7
+}; // enum
+
+/*! Details of a received message. */
+struct AsyncMqttClientMessageProperties
+{
+   uint8_t qos; ///< Quality of service.
+   bool dup; ///< Redelivery.
+   bool retain; ///< Retained message.
+}; // struct
+
+/*! Occupancy of one of the real client's packet pools. */
+struct AsyncMqttClientPoolStats
+{
+   uint16_t slots; ///< Blocks in the pool.
+   uint16_t inUse; ///< Blocks handed out right now.
+   uint16_t highWater; ///< Most blocks ever handed out at the same time.
+   uint32_t fallbacks; ///< Requests that went to the heap instead.
+}; // struct
+
+namespace AsyncMqttClientInternals
+{
+   typedef std::function<void(bool sessionPresent)> OnConnectUserCallback;
+   typedef std::function<void(AsyncMqttClientDisconnectReason reason)> OnDisconnectUserCallback;
+   typedef std::function<void(uint16_t packetId, uint8_t qos)> OnSubscribeUserCallback;
+   typedef std::function<void(uint16_t packetId)> OnUnsubscribeUserCallback;
+   typedef std::function<void(char* topic, char* payload, AsyncMqttClientMessageProperties properties, size_t len, size_t index, size_t total)> OnMessageUserCallback;
+   typedef std::function<void(uint16_t packetId)> OnPublishUserCallback;
+} // namespace AsyncMqttClientInternals
+
+/*************************************************************************************************************************************
+ * @class MQTT client with a pretend broker.
+ *************************************************************************************************************************************/
+class AsyncMqttClient
+{
+   public:
+      AsyncMqttClient() { hostClient() = this; } // Becomes the client hostClient() returns.
+      ~AsyncMqttClient() { if(hostClient() == this) { hostClient() = nullptr; } } // Forget ourselves.
+      AsyncMqttClient& setKeepAlive(uint16_t keepAlive) { (void)keepAlive; return *this; } // Ignored.
+      AsyncMqttClient& setClientId(const char* clientId) { (void)clientId; return *this; } // Ignored.
+      AsyncMqttClient& setCleanSession(bool cleanSession) { (void)cleanSession; return *this; } // Ignored.
+      AsyncMqttClient& setCredentials(const char* username, const char* password = nullptr) { (void)username; (void)password; return *this; } // Ignored.
+      AsyncMqttClient& setWill(const char* topic, uint8_t qos, bool retain, const char* payload = nullptr, size_t length = 0) { (void)topic; (void)qos; (void)retain; (void)payload; (void)length; return *this; } // Ignored.
+      AsyncMqttClient& setServer(IPAddress ip, uint16_t port) { _ip = ip; _port = port; return *this; } // Broker address.
+      AsyncMqttClient& setServer(const char* host, uint16_t port) { (void)host; _port = port; return *this; } // Broker address.
+      AsyncMqttClient& onConnect(AsyncMqttClientInternals::OnConnectUserCallback callback) { _onConnect = callback; return *this; } // Connected callback.
+      AsyncMqttClient& onDisconnect(AsyncMqttClientInternals::OnDisconnectUserCallback callback) { _onDisconnect = callback; return *this; } // Disconnected callback.
+      AsyncMqttClient& onSubscribe(AsyncMqttClientInternals::OnSubscribeUserCallback callback) { _onSubscribe = callback; return *this; } // Subscribed callback.
+      AsyncMqttClient& onUnsubscribe(AsyncMqttClientInternals::OnUnsubscribeUserCallback callback) { _onUnsubscribe = callback; return *this; } // Unsubscribed callback.
+      AsyncMqttClient& onMessage(AsyncMqttClientInternals::OnMessageUserCallback callback) { _onMessage = callback; return *this; } // Message callback.
+      AsyncMqttClient& onPublish(AsyncMqttClientInternals::OnPublishUserCallback callback) { _onPublish = callback; return *this; } // Published callback.
+      bool connected() const { return _connected; } // True while the pretend broker has accepted us.
+      void connect() { _connecting = true; } // Ask for a connection. See hostAccept().
+      void disconnect(bool force = false); // Drop the connection.
+      uint16_t subscribe(const char* topic, uint8_t qos); // Subscribe. Acknowledged straight away when connected.
+      uint16_t unsubscribe(const char* topic); // Unsubscribe. Acknowledged straight away when connected.
+      uint16_t publish(const char* topic, uint8_t qos, bool retain, const char* payload = nullptr, size_t length = 0, bool dup = false, uint16_t messageId = 0); // Publish.
+      bool clearQueue() { return true; } // Nothing queued.
+      bool isSendReady(size_t length) const { (void)length; return _connected; } // Nothing is ever queued, so only the connection counts.
+      static AsyncMqttClientPoolStats getPacketPoolStats() { return AsyncMqttClientPoolStats{0, 0, 0, 0}; } // No pools on the host stand-in.
+      static AsyncMqttClientPoolStats getBufferPoolStats() { return AsyncMqttClientPoolStats{0, 0, 0, 0}; } // No pools on the host stand-in.
+      static AsyncMqttClient*& hostClient() { static AsyncMqttClient* last = nullptr; return last; } // Host only. Most recently made client.
+      void hostAccept(); // Host only. Broker accepts a pending connect().
+      void hostDrop(AsyncMqttClientDisconnectReason reason = AsyncMqttClientDisconnectReason::TCP_DISCONNECTED); // Host only. Broker goes away.
+      void hostDeliver(const char* topic, const char* payload); // Host only. Broker sends a message.
+      bool hostIsConnecting() const { return _connecting; } // Host only. connect() called and not yet answered.
+      uint32_t getPublishCount() const { return _publishCount; } // Host only. Messages published.
+      uint32_t getPublishBytes() const { return _publishBytes; } // Host only. Topic and payload bytes published.
+      const String& getLastTopic() const { return _lastTopic; } // Host only. Topic of the last publish.
+      const String& getLastPayload() const { return _lastPayload; } // Host only. Payload of the last publish.
+   private:
+      AsyncMqttClientInternals::OnConnectUserCallback _onConnect; // Connected callback.
+      AsyncMqttClientInternals::OnDisconnectUserCallback _onDisconnect; // Disconnected callback.
+      AsyncMqttClientInternals::OnSubscribeUserCallback _onSubscribe; // Subscribed callback.
+      AsyncMqttClientInternals::OnUnsubscribeUserCallback _onUnsubscribe; // Unsubscribed callback.
+      AsyncMqttClientInternals::OnMessageUserCallback _onMessage; // Message callback.
+      AsyncMqttClientInternals::OnPublishUserCallback _onPublish; // Published callback.
+      IPAddress _ip; // Broker address.
+      uint16_t _port = 1883; // Broker port.
+      bool _connecting = false; // connect() called and not yet answered.
+      bool _connected = false; // Pretend broker accepted us.
+      uint16_t _nextPacketId = 1; // Packet id for the next subscribe/publish.
+      uint32_t _publishCount = 0; // Messages published.
+      uint32_t _publishBytes = 0; // Topic and payload bytes published.
+      String _lastTopic; // Topic of the last publish.
+      String _lastPayload; // Payload of the last publish.
+}; // class AsyncMqttClient
+
+#endif // End of precompiler protected code block
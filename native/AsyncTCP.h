@@ -0,0 +1,105 @@
+/*************************************************************************************************************************************
+ * @file AsyncTCP.h
+ * @author va3wam
+ * @brief Host stand-in for https://github.com/me-no-dev/AsyncTCP.
+ * @details Nothing goes on the wire. connect() only records the request. A test plays the server through the most recently made
+ * client, hostClient(): hostAccept() and hostClose() fire the connect and disconnect handlers, hostReceive() feeds bytes to the data
+ * handler and the bytes the client sends are counted without being kept, so sending never allocates. hostSetWindow() shrinks
+ * the send window to play a slow link.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef AsyncTCP_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define AsyncTCP_h // Precompiler macro used for precompiler check.
+
+#include <functional> // Handler types, as the real library uses.
+#include <Arduino.h> // Host Arduino core.
+
+#define ASYNC_WRITE_FLAG_COPY 0x01 // Same values as the real library.
+#define ASYNC_WRITE_FLAG_MORE 0x02 // Same values as the real library.
+#define HOST_TCP_WINDOW 5744 // What space() reports. Same as the ESP32 default TCP window.
+
+class AsyncClient; // Defined below.
+
+typedef std::function<void(void*, AsyncClient*)> AcConnectHandler; // Connect, disconnect and poll.
+typedef std::function<void(void*, AsyncClient*, size_t len, uint32_t time)> AcAckHandler; // Bytes acknowledged.
+typedef std::function<void(void*, AsyncClient*, void* data, size_t len)> AcDataHandler; // Bytes received.
+
+/*************************************************************************************************************************************
+ * @class TCP client with a pretend server.
+ *************************************************************************************************************************************/
+class AsyncClient
+{
+   public:
+      AsyncClient() { hostClient() = this; } // Becomes the client hostClient() returns.
+      ~AsyncClient() { if(hostClient() == this) { hostClient() = nullptr; } } // Forget ourselves.
+      bool connect(IPAddress ip, uint16_t port) { (void)ip; (void)port; _connecting = true; return true; } // See hostAccept().
+      bool connect(const char* host, uint16_t port) { (void)host; (void)port; _connecting = true; return true; } // See hostAccept().
+      void close(bool now = false) { (void)now; hostClose(); } // Drop the connection.
+      bool connected() { return _connected; } // True between hostAccept() and close().
+      size_t space() { return _connected ? _window : 0; } // Window only fills when a test says so. See hostSetWindow().
+      size_t add(const char* data, size_t size, uint8_t apiflags = ASYNC_WRITE_FLAG_COPY) { (void)data; (void)apiflags; _sentBytes += size; return size; } // Count the bytes.
+      bool send() { _sends++; return true; } // Nothing to flush.
+      void setRxTimeout(uint32_t timeout) { (void)timeout; } // Ignored.
+      void setNoDelay(bool nodelay) { (void)nodelay; } // Ignored.
+      void onConnect(AcConnectHandler cb, void* arg = 0) { _onConnect = cb; _onConnectArg = arg; } // Connected handler.
+      void onDisconnect(AcConnectHandler cb, void* arg = 0) { _onDisconnect = cb; _onDisconnectArg = arg; } // Disconnected handler.
+      void onAck(AcAckHandler cb, void* arg = 0) { _onAck = cb; _onAckArg = arg; } // Acknowledged handler.
+      void onData(AcDataHandler cb, void* arg = 0) { _onData = cb; _onDataArg = arg; } // Received handler.
+      void onPoll(AcConnectHandler cb, void* arg = 0) { _onPoll = cb; _onPollArg = arg; } // Poll handler.
+      static AsyncClient*& hostClient() { static AsyncClient* last = nullptr; return last; } // Host only. Most recently made client.
+      void hostAccept() // Host only. Server accepts a pending connect().
+      {
+         _connecting = false;
+         _connected = true;
+         if(_onConnect) { _onConnect(_onConnectArg, this); } // if
+      } // hostAccept()
+      void hostClose() // Host only. Connection goes away.
+      {
+         bool wasUp = _connected || _connecting;
+         _connecting = false;
+         _connected = false;
+         if(wasUp && _onDisconnect) { _onDisconnect(_onDisconnectArg, this); } // if
+      } // hostClose()
+      void hostReceive(const void* data, size_t len) // Host only. Server sends bytes.
+      {
+         if(_onData) { _onData(_onDataArg, this, const_cast<void*>(data), len); } // if
+         if(_onAck) { _onAck(_onAckArg, this, 0, 0); } // if
+      } // hostReceive()
+      void hostPoll() { if(_onPoll) { _onPoll(_onPollArg, this); } } // Host only. What the real stack does every 125ms.
+      bool hostIsConnecting() const { return _connecting; } // Host only. connect() called and not yet answered.
+      void hostSetWindow(size_t window) { _window = window; } // Host only. What space() reports while connected.
+      uint32_t hostSentBytes() const { return _sentBytes; } // Host only. Bytes passed to add().
+      uint32_t hostSends() const { return _sends; } // Host only. Calls to send().
+   private:
+      AcConnectHandler _onConnect; // Connected handler.
+      AcConnectHandler _onDisconnect; // Disconnected handler.
+      AcAckHandler _onAck; // Acknowledged handler.
+      AcDataHandler _onData; // Received handler.
+      AcConnectHandler _onPoll; // Poll handler.
+      void* _onConnectArg = nullptr; // Passed back to _onConnect.
+      void* _onDisconnectArg = nullptr; // Passed back to _onDisconnect.
+      void* _onAckArg = nullptr; // Passed back to _onAck.
+      void* _onDataArg = nullptr; // Passed back to _onData.
+      void* _onPollArg = nullptr; // Passed back to _onPoll.
+      bool _connecting = false; // connect() called and not yet answered.
+      bool _connected = false; // Pretend server accepted us.
+      uint32_t _sentBytes = 0; // Bytes passed to add().
+      uint32_t _sends = 0; // Calls to send().
+      size_t _window = HOST_TCP_WINDOW; // Room in the pretend send window.
+}; // class AsyncClient
+
+#endif // End of precompiler protected code block
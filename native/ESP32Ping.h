@@ -0,0 +1,48 @@
+/*************************************************************************************************************************************
+ * @file ESP32Ping.h
+ * @author va3wam
+ * @brief Host stand-in for https://github.com/marian-craciunescu/ESP32Ping.
+ * @details Nothing is sent. Addresses registered with hostSetReachable() answer; everything else times out.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef ESP32Ping_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define ESP32Ping_h // Precompiler macro used for precompiler check.
+
+#include <Arduino.h> // Host Arduino core.
+
+#define HOST_PING_MAX_HOSTS 8 // Most reachable addresses the host remembers.
+
+/*************************************************************************************************************************************
+ * @class ICMP echo.
+ *************************************************************************************************************************************/
+class PingClass
+{
+   public:
+      bool ping(IPAddress dest, byte count = 5); // True if dest is reachable.
+      bool ping(const char* host, byte count = 5) { (void)host; (void)count; return false; } // Names never resolve on the host.
+      float averageTime() { return _averageTime; } // Round trip of the last successful ping in ms.
+      void hostSetReachable(IPAddress address, float rttMs = 1.0f); // Host only. Make an address answer.
+   private:
+      IPAddress _reachable[HOST_PING_MAX_HOSTS]; // Addresses that answer.
+      float _rtt[HOST_PING_MAX_HOSTS]; // Their round trip times.
+      uint8_t _numReachable = 0; // Entries used.
+      float _averageTime = 0.0f; // Round trip of the last successful ping.
+}; // class PingClass
+
+extern PingClass Ping; // ICMP echo.
+
+#endif // End of precompiler protected code block
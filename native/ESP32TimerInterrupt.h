@@ -0,0 +1,48 @@
+/*************************************************************************************************************************************
+ * @file ESP32TimerInterrupt.h
+ * @author va3wam
+ * @brief Host stand-in for https://github.com/khoih-prog/ESP32TimerInterrupt.
+ * @details A thread sleeps until each deadline and then calls the callback, so the period is as steady as the host scheduler
+ * allows. Deadlines advance by whole periods, as the hardware timer's alarm does, so a late callback does not shift later ones.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef ESP32TimerInterrupt_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define ESP32TimerInterrupt_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+
+typedef void (*timerCallback)(); // Timer interrupt handler.
+
+/*************************************************************************************************************************************
+ * @class Periodic timer interrupt.
+ *************************************************************************************************************************************/
+class ESP32Timer
+{
+   public:
+      ESP32Timer(uint8_t timerNo) : _timerNo(timerNo) {} // Class constructor.
+      ~ESP32Timer(); // Class destructor. Stops the thread.
+      bool attachInterruptInterval(uint64_t intervalUs, timerCallback callback); // Start calling callback every intervalUs.
+      bool attachInterrupt(float frequency, timerCallback callback); // Start calling callback at frequency Hz.
+      void detachInterrupt(); // Stop calling the callback.
+      void stopTimer() { detachInterrupt(); } // Stop calling the callback.
+      uint8_t getTimerNo() { return _timerNo; } // Hardware timer number.
+   private:
+      uint8_t _timerNo; // Hardware timer number.
+      struct hostTimerThread* _thread = nullptr; // Thread running the callback.
+}; // class ESP32Timer
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,39 @@
+/*************************************************************************************************************************************
+ * @file ESPmDNS.h
+ * @author va3wam
+ * @brief Host stand-in for the ESP32 mDNS responder. Nothing is advertised on the host.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef ESPmDNS_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define ESPmDNS_h // Precompiler macro used for precompiler check.
+
+#include <Arduino.h> // Host Arduino core.
+
+/*************************************************************************************************************************************
+ * @class mDNS responder.
+ *************************************************************************************************************************************/
+class MDNSResponder
+{
+   public:
+      bool begin(const char* hostName) { return hostName != nullptr; } // Start answering for hostName.
+      void end() {} // Stop answering.
+      bool addService(const char* service, const char* proto, uint16_t port) { (void)service; (void)proto; (void)port; return true; } // Advertise.
+}; // class MDNSResponder
+
+extern MDNSResponder MDNS; // mDNS responder.
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,51 @@
+/*************************************************************************************************************************************
+ * @file IPAddress.h
+ * @author va3wam
+ * @brief Host stand-in for the Arduino IPAddress class.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef IPAddress_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define IPAddress_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <WString.h> // Arduino String.
+#include <Print.h> // Printable.
+
+/*************************************************************************************************************************************
+ * @class IPv4 address.
+ *************************************************************************************************************************************/
+class IPAddress : public Printable
+{
+   public:
+      IPAddress() : IPAddress(0, 0, 0, 0) {} // 0.0.0.0.
+      IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _bytes{a, b, c, d} {} // From four octets.
+      IPAddress(uint32_t address); // From network order uint32_t, as the ESP32 core does.
+      IPAddress(const uint8_t* address) : IPAddress(address[0], address[1], address[2], address[3]) {} // From four bytes.
+      bool fromString(const char* address); // Parse dotted decimal.
+      bool fromString(const String &address) { return fromString(address.c_str()); } // Parse dotted decimal.
+      String toString() const; // Dotted decimal.
+      operator uint32_t() const; // Network order uint32_t.
+      uint8_t operator[](int index) const { return _bytes[index]; } // One octet.
+      uint8_t& operator[](int index) { return _bytes[index]; } // One octet.
+      bool operator==(const IPAddress &rhs) const { return (uint32_t)*this == (uint32_t)rhs; } // Same address.
+      bool operator!=(const IPAddress &rhs) const { return !(*this == rhs); } // Different address.
+      size_t printTo(Print &p) const { return p.print(toString()); } // Dotted decimal.
+   private:
+      uint8_t _bytes[4]; // Octets, most significant first.
+}; // class IPAddress
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,57 @@
+/*************************************************************************************************************************************
+ * @file Preferences.h
+ * @author va3wam
+ * @brief Host stand-in for the ESP32 Preferences (NVS) class.
+ * @details Keys live in memory for the life of the process, shared by every Preferences object like the real NVS partition.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef Preferences_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define Preferences_h // Precompiler macro used for precompiler check.
+
+#include <Arduino.h> // Host Arduino core.
+
+/*************************************************************************************************************************************
+ * @class Key/value store in one namespace.
+ *************************************************************************************************************************************/
+class Preferences
+{
+   public:
+      bool begin(const char* name, bool readOnly = false); // Open a namespace.
+      void end() { _open = false; } // Close the namespace.
+      bool clear(); // Remove every key in the namespace.
+      bool remove(const char* key); // Remove one key.
+      bool isKey(const char* key); // True if the key exists.
+      size_t putString(const char* key, const char* value); // Store a string.
+      size_t putString(const char* key, const String &value) { return putString(key, value.c_str()); } // Store a string.
+      String getString(const char* key, const String defaultValue = String()); // Read a string.
+      size_t putUInt(const char* key, uint32_t value); // Store a number.
+      uint32_t getUInt(const char* key, uint32_t defaultValue = 0); // Read a number.
+      size_t putInt(const char* key, int32_t value) { return putUInt(key, (uint32_t)value); } // Store a number.
+      int32_t getInt(const char* key, int32_t defaultValue = 0) { return (int32_t)getUInt(key, (uint32_t)defaultValue); } // Read a number.
+      size_t putBool(const char* key, bool value) { return putUInt(key, value ? 1 : 0); } // Store a flag.
+      bool getBool(const char* key, bool defaultValue = false) { return getUInt(key, defaultValue ? 1 : 0) != 0; } // Read a flag.
+      size_t putBytes(const char* key, const void* value, size_t len); // Store a blob.
+      size_t getBytes(const char* key, void* buf, size_t maxLen); // Read a blob.
+      size_t getBytesLength(const char* key); // Size of a blob.
+   private:
+      String _key(const char* key); // Namespace qualified key.
+      String _name; // Namespace.
+      bool _open = false; // begin() called.
+      bool _readOnly = false; // Opened read only.
+}; // class Preferences
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,75 @@
+/*************************************************************************************************************************************
+ * @file Print.h
+ * @author va3wam
+ * @brief Host stand-in for the Arduino Print and Printable classes.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef Print_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define Print_h // Precompiler macro used for precompiler check.
+
+#ifndef ARDUINO
+#define ARDUINO 10805 // Libraries that include Print.h before Arduino.h still pick their Arduino 1.x code paths.
+#endif
+
+#include <stdint.h> // Fixed width integer types.
+#include <stddef.h> // size_t.
+#include <WString.h> // Arduino String.
+
+class Print; // Defined below.
+
+/*************************************************************************************************************************************
+ * @class Something that knows how to print itself.
+ *************************************************************************************************************************************/
+class Printable
+{
+   public:
+      virtual ~Printable() {} // Class destructor.
+      virtual size_t printTo(Print &p) const = 0; // Print to p.
+}; // class Printable
+
+/*************************************************************************************************************************************
+ * @class Text output. Subclasses supply write(uint8_t).
+ *************************************************************************************************************************************/
+class Print
+{
+   public:
+      virtual ~Print() {} // Class destructor.
+      virtual size_t write(uint8_t c) = 0; // Send one byte.
+      virtual size_t write(const uint8_t* buffer, size_t size); // Send a block.
+      size_t write(const char* str); // Send a C string.
+      size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); } // Send a block.
+      virtual void flush() {} // Wait for output to finish.
+      size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))); // Formatted output.
+      size_t print(const __FlashStringHelper* s) { return write((const char*)s); } // F() string.
+      size_t print(const String &s) { return write(s.c_str()); } // String.
+      size_t print(const char* s) { return write(s); } // C string.
+      size_t print(char c) { return write((uint8_t)c); } // One character.
+      size_t print(unsigned char n, int base = DEC) { return print((unsigned long)n, base); } // Number.
+      size_t print(int n, int base = DEC) { return print((long)n, base); } // Number.
+      size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); } // Number.
+      size_t print(long n, int base = DEC); // Number.
+      size_t print(unsigned long n, int base = DEC); // Number.
+      size_t print(long long n, int base = DEC) { return print((long)n, base); } // Number.
+      size_t print(unsigned long long n, int base = DEC) { return print((unsigned long)n, base); } // Number.
+      size_t print(double n, int digits = 2); // Number.
+      size_t print(const Printable &p) { return p.printTo(*this); } // Printable.
+      size_t println() { return write("\r\n"); } // End of line.
+      template <typename T> size_t println(const T &value) { size_t n = print(value); return n + println(); } // Value then end of line.
+      template <typename T> size_t println(const T &value, int format) { size_t n = print(value, format); return n + println(); } // Value then end of line.
+}; // class Print
+
+#endif // End of precompiler protected code block
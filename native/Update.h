@@ -0,0 +1,46 @@
+/*************************************************************************************************************************************
+ * @file Update.h
+ * @author va3wam
+ * @brief Host stand-in for the ESP32 OTA Update class. Images are counted and thrown away.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef Update_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define Update_h // Precompiler macro used for precompiler check.
+
+#include <Arduino.h> // Host Arduino core.
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF // Size not known in advance.
+
+/*************************************************************************************************************************************
+ * @class Firmware update writer.
+ *************************************************************************************************************************************/
+class UpdateClass
+{
+   public:
+      bool begin(size_t size = UPDATE_SIZE_UNKNOWN) { (void)size; _written = 0; return true; } // Start an update.
+      size_t write(uint8_t* data, size_t len) { (void)data; _written += len; return len; } // Take some of the image.
+      bool end(bool evenIfRemaining = false) { (void)evenIfRemaining; return true; } // Finish the update.
+      bool hasError() { return false; } // Never fails on the host.
+      void printError(Print &out) { out.println("No error"); } // Describe the last error.
+      size_t progress() { return _written; } // Bytes taken.
+   private:
+      size_t _written = 0; // Bytes taken.
+}; // class UpdateClass
+
+extern UpdateClass Update; // Firmware update writer.
+
+#endif // End of precompiler protected code block
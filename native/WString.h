@@ -0,0 +1,108 @@
+/*************************************************************************************************************************************
+ * @file WString.h
+ * @author va3wam
+ * @brief Host stand-in for the Arduino String class, built on std::string.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef WString_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define WString_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <string> // Storage.
+
+class __FlashStringHelper; // F() strings. Plain const char* on the host.
+
+#define DEC 10 // Number base.
+#define HEX 16 // Number base.
+#define OCT 8 // Number base.
+#define BIN 2 // Number base.
+
+/*************************************************************************************************************************************
+ * @class Arduino String.
+ *************************************************************************************************************************************/
+class String
+{
+   public:
+      String(const char* cstr = ""); // From a C string.
+      String(const __FlashStringHelper* fstr); // From an F() string.
+      String(const std::string &str) : _s(str) {} // From a std::string.
+      String(char c); // One character.
+      String(unsigned char value, unsigned char base = 10); // Number.
+      String(int value, unsigned char base = 10); // Number.
+      String(unsigned int value, unsigned char base = 10); // Number.
+      String(long value, unsigned char base = 10); // Number.
+      String(unsigned long value, unsigned char base = 10); // Number.
+      String(float value, unsigned char decimals = 2); // Number.
+      String(double value, unsigned char decimals = 2); // Number.
+      const char* c_str() const { return _s.c_str(); } // NUL terminated contents.
+      unsigned int length() const { return _s.length(); } // Characters held.
+      bool isEmpty() const { return _s.empty(); } // True if no characters.
+      bool reserve(unsigned int size) { _s.reserve(size); return true; } // Preallocate.
+      bool concat(const String &s) { _s += s._s; return true; } // Append.
+      String& operator+=(const String &rhs) { _s += rhs._s; return *this; } // Append.
+      String& operator+=(const char* rhs) { _s += rhs; return *this; } // Append.
+      String& operator+=(char rhs) { _s += rhs; return *this; } // Append.
+      String& operator+=(int rhs) { return *this += String(rhs); } // Append.
+      String& operator+=(unsigned int rhs) { return *this += String(rhs); } // Append.
+      String& operator+=(long rhs) { return *this += String(rhs); } // Append.
+      String& operator+=(unsigned long rhs) { return *this += String(rhs); } // Append.
+      bool equals(const String &s) const { return _s == s._s; } // Same contents.
+      bool equalsIgnoreCase(const String &s) const; // Same contents ignoring case.
+      bool operator==(const String &rhs) const { return _s == rhs._s; } // Same contents.
+      bool operator==(const char* rhs) const { return _s == rhs; } // Same contents.
+      bool operator!=(const String &rhs) const { return _s != rhs._s; } // Different contents.
+      bool operator!=(const char* rhs) const { return _s != rhs; } // Different contents.
+      bool operator<(const String &rhs) const { return _s < rhs._s; } // Sort order.
+      char charAt(unsigned int index) const { return (index < _s.length()) ? _s[index] : 0; } // One character.
+      char operator[](unsigned int index) const { return charAt(index); } // One character.
+      char& operator[](unsigned int index) { return _s[index]; } // One character.
+      char* begin() { return &_s[0]; } // First character, for std algorithms.
+      char* end() { return &_s[0] + _s.length(); } // One past the last character.
+      const char* begin() const { return _s.c_str(); } // First character, for std algorithms.
+      const char* end() const { return _s.c_str() + _s.length(); } // One past the last character.
+      void setCharAt(unsigned int index, char c) { if(index < _s.length()) _s[index] = c; } // Replace one character.
+      bool startsWith(const String &prefix) const { return _s.compare(0, prefix._s.length(), prefix._s) == 0; } // Prefix test.
+      bool endsWith(const String &suffix) const; // Suffix test.
+      int indexOf(char c, unsigned int from = 0) const; // First position of c or -1.
+      int indexOf(const String &s, unsigned int from = 0) const; // First position of s or -1.
+      int lastIndexOf(char c) const; // Last position of c or -1.
+      String substring(unsigned int from) const; // Tail.
+      String substring(unsigned int from, unsigned int to) const; // Characters from..to-1.
+      void replace(const String &find, const String &with); // Replace every find with with.
+      void remove(unsigned int index, unsigned int count = (unsigned int)-1); // Delete characters.
+      void toUpperCase(); // In place.
+      void toLowerCase(); // In place.
+      void trim(); // Strip leading and trailing white space.
+      long toInt() const; // Leading integer or 0.
+      float toFloat() const; // Leading number or 0.
+      double toDouble() const; // Leading number or 0.
+      void toCharArray(char* buf, unsigned int bufsize, unsigned int index = 0) const; // Copy out, NUL terminated.
+      void getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index = 0) const; // Copy out, NUL terminated.
+      friend String operator+(const String &lhs, const String &rhs) { return String(lhs._s + rhs._s); } // Join.
+      friend String operator+(const String &lhs, const char* rhs) { return String(lhs._s + rhs); } // Join.
+      friend String operator+(const char* lhs, const String &rhs) { return String(lhs + rhs._s); } // Join.
+      friend String operator+(const String &lhs, char rhs) { return String(lhs._s + rhs); } // Join.
+      friend String operator+(const String &lhs, int rhs) { return lhs + String(rhs); } // Join.
+      friend String operator+(const String &lhs, unsigned int rhs) { return lhs + String(rhs); } // Join.
+      friend String operator+(const String &lhs, long rhs) { return lhs + String(rhs); } // Join.
+      friend String operator+(const String &lhs, unsigned long rhs) { return lhs + String(rhs); } // Join.
+      friend String operator+(const String &lhs, double rhs) { return lhs + String(rhs); } // Join.
+   private:
+      std::string _s; // Contents.
+}; // class String
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,103 @@
+/*************************************************************************************************************************************
+ * @file WebServer.h
+ * @author va3wam
+ * @brief Host stand-in for the ESP32 WebServer class.
+ * @details No socket is opened. Handlers are recorded, and hostRequest() runs the one registered for a method and URI as though a
+ * browser had asked for it, keeping the response code and body for the caller to look at.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef WebServer_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define WebServer_h // Precompiler macro used for precompiler check.
+
+#include <functional> // Handler type, as the real server uses.
+#include <Arduino.h> // Host Arduino core.
+
+#define HOST_WEB_MAX_HANDLERS 16 // Most URIs one server can handle.
+#define HOST_WEB_MAX_ARGS 4 // Most arguments one request can carry.
+
+/*! HTTP request methods. */
+enum HTTPMethod
+{
+   HTTP_ANY,
+   HTTP_GET,
+   HTTP_HEAD,
+   HTTP_POST,
+   HTTP_PUT,
+   HTTP_PATCH,
+   HTTP_DELETE,
+   HTTP_OPTIONS
+}; // enum
+
+/*! Upload progress. */
+enum HTTPUploadStatus
+{
+   UPLOAD_FILE_START,
+   UPLOAD_FILE_WRITE,
+   UPLOAD_FILE_END,
+   UPLOAD_FILE_ABORTED
+}; // enum
+
+#define HTTP_UPLOAD_BUFLEN 1436 // Same as the ESP32 core.
+
+/*! One chunk of a file upload. */
+typedef struct
+{
+   HTTPUploadStatus status; ///< Where the upload is at.
+   String filename; ///< Name of the uploaded file.
+   String name; ///< Form field name.
+   String type; ///< MIME type.
+   size_t totalSize; ///< Bytes so far.
+   size_t currentSize; ///< Bytes in buf.
+   uint8_t buf[HTTP_UPLOAD_BUFLEN]; ///< This chunk.
+} HTTPUpload; // struct
+
+/*************************************************************************************************************************************
+ * @class HTTP server.
+ *************************************************************************************************************************************/
+class WebServer
+{
+   public:
+      typedef std::function<void(void)> THandlerFunction; // Request handler.
+      WebServer(int port = 80) : _port(port) {} // Class constructor.
+      void begin() { _running = true; } // Start listening.
+      void close() { _running = false; } // Stop listening.
+      void handleClient() {} // No clients on the host.
+      void on(const String &uri, HTTPMethod method, THandlerFunction handler); // Handle a URI.
+      void on(const String &uri, HTTPMethod method, THandlerFunction handler, THandlerFunction uploadHandler); // Handle a URI with uploads.
+      void sendHeader(const String &name, const String &value, bool first = false) { (void)name; (void)value; (void)first; } // Ignored.
+      void send(int code, const char* contentType = nullptr, const String &content = String()); // Respond.
+      void send(int code, const String &contentType, const String &content) { send(code, contentType.c_str(), content); } // Respond.
+      String arg(const String &name); // Value of a request argument.
+      bool hasArg(const String &name); // True if the request has the argument.
+      HTTPUpload& upload() { return _upload; } // Current upload chunk.
+      int hostRequest(HTTPMethod method, const char* uri, const char* argName = nullptr, const char* argValue = nullptr); // Host only. Run a handler.
+      const String& hostLastBody() { return _lastBody; } // Host only. Body of the last response.
+   private:
+      int _port; // TCP port.
+      bool _running = false; // begin() called.
+      String _uri[HOST_WEB_MAX_HANDLERS]; // Handled URIs.
+      HTTPMethod _method[HOST_WEB_MAX_HANDLERS]; // Their methods.
+      THandlerFunction _handler[HOST_WEB_MAX_HANDLERS]; // Their handlers.
+      uint8_t _numHandlers = 0; // Entries used.
+      String _argName; // Argument of the request being handled.
+      String _argValue; // Its value.
+      int _lastCode = 0; // Code of the last response.
+      String _lastBody; // Body of the last response.
+      HTTPUpload _upload; // Current upload chunk.
+}; // class WebServer
+
+#endif // End of precompiler protected code block
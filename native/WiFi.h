@@ -0,0 +1,168 @@
+/*************************************************************************************************************************************
+ * @file WiFi.h
+ * @author va3wam
+ * @brief Host stand-in for the ESP32 WiFi class.
+ * @details The host has no radio. By default a scan finds nothing, so the firmware takes its no network path. The host runner
+ * can call hostSetAccessPoint() to make one access point appear; connecting to it then succeeds with a fixed address, which
+ * lets the network code paths run without real sockets behind them. Scans and joins finish straight away unless hostSetTimes()
+ * gives them a duration, in which case asynchronous scans and joins finish, and fire their events, on the first status call
+ * after that much time has passed. A join that names a channel or BSSID other than the access point's fails.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Asynchronous scans, joins by channel and BSSID, and scan and join times
+ *************************************************************************************************************************************/
+#ifndef WiFi_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define WiFi_h // Precompiler macro used for precompiler check.
+
+#include <Arduino.h> // Host Arduino core.
+
+#define WIFI_STA 1 // Station mode. Same value as WIFI_MODE_STA.
+#define WIFI_SCAN_RUNNING (-1) // scanComplete() while an asynchronous scan is under way.
+#define WIFI_SCAN_FAILED (-2) // scanComplete() with no scan started, or after scanDelete().
+#define HOST_AP_CHANNEL 6 // Channel the host access point starts on.
+
+/*! Connection status. Same values as the ESP32 core. */
+typedef enum
+{
+   WL_NO_SHIELD = 255,
+   WL_IDLE_STATUS = 0,
+   WL_NO_SSID_AVAIL = 1,
+   WL_SCAN_COMPLETED = 2,
+   WL_CONNECTED = 3,
+   WL_CONNECT_FAILED = 4,
+   WL_CONNECTION_LOST = 5,
+   WL_DISCONNECTED = 6
+} wl_status_t; // enum
+
+/*! Access point security. Same values as ESP-IDF. */
+typedef enum
+{
+   WIFI_AUTH_OPEN = 0,
+   WIFI_AUTH_WEP,
+   WIFI_AUTH_WPA_PSK,
+   WIFI_AUTH_WPA2_PSK,
+   WIFI_AUTH_WPA_WPA2_PSK,
+   WIFI_AUTH_WPA2_ENTERPRISE,
+   WIFI_AUTH_MAX
+} wifi_auth_mode_t; // enum
+
+/*! WiFi events. Same values as ESP-IDF 3.x system_event_id_t. */
+typedef enum
+{
+   SYSTEM_EVENT_WIFI_READY = 0,
+   SYSTEM_EVENT_SCAN_DONE,
+   SYSTEM_EVENT_STA_START,
+   SYSTEM_EVENT_STA_STOP,
+   SYSTEM_EVENT_STA_CONNECTED,
+   SYSTEM_EVENT_STA_DISCONNECTED,
+   SYSTEM_EVENT_STA_AUTHMODE_CHANGE,
+   SYSTEM_EVENT_STA_GOT_IP,
+   SYSTEM_EVENT_STA_LOST_IP,
+   SYSTEM_EVENT_STA_WPS_ER_SUCCESS,
+   SYSTEM_EVENT_STA_WPS_ER_FAILED,
+   SYSTEM_EVENT_STA_WPS_ER_TIMEOUT,
+   SYSTEM_EVENT_STA_WPS_ER_PIN,
+   SYSTEM_EVENT_AP_START,
+   SYSTEM_EVENT_AP_STOP,
+   SYSTEM_EVENT_AP_STACONNECTED,
+   SYSTEM_EVENT_AP_STADISCONNECTED,
+   SYSTEM_EVENT_AP_STAIPASSIGNED,
+   SYSTEM_EVENT_AP_PROBEREQRECVED,
+   SYSTEM_EVENT_GOT_IP6,
+   SYSTEM_EVENT_ETH_START,
+   SYSTEM_EVENT_ETH_STOP,
+   SYSTEM_EVENT_ETH_CONNECTED,
+   SYSTEM_EVENT_ETH_DISCONNECTED,
+   SYSTEM_EVENT_ETH_GOT_IP,
+   SYSTEM_EVENT_MAX
+} system_event_id_t; // enum
+
+#define SYSTEM_EVENT_AP_STA_GOT_IP6 SYSTEM_EVENT_GOT_IP6 // Old name.
+
+typedef system_event_id_t WiFiEvent_t; // Event id.
+typedef struct { uint8_t reason; } WiFiEventInfo_t; // Event details. Only a disconnect reason on the host.
+typedef void (*WiFiEventFuncCb)(WiFiEvent_t event, WiFiEventInfo_t info); // Event handler.
+
+/*************************************************************************************************************************************
+ * @class ESP32 WiFi station.
+ *************************************************************************************************************************************/
+class WiFiClass
+{
+   public:
+      int16_t scanNetworks(bool async = false, bool showHidden = false, bool passive = false, uint32_t maxMsPerChan = 300); // Access points found, or WIFI_SCAN_RUNNING.
+      int16_t scanComplete(); // Access points found by the last scan, WIFI_SCAN_RUNNING or WIFI_SCAN_FAILED.
+      void scanDelete() { _scan = WIFI_SCAN_FAILED; } // Forget the last scan.
+      String SSID(); // Connected access point name.
+      String SSID(uint8_t index); // Name of a scanned access point.
+      int32_t RSSI(); // Signal strength of the connected access point.
+      int32_t RSSI(uint8_t index); // Signal strength of a scanned access point.
+      uint8_t* BSSID() { return isConnected() ? _apBssid : nullptr; } // Connected access point hardware address.
+      uint8_t* BSSID(uint8_t index) { return (index == 0 && _apSsid.length() > 0) ? _apBssid : nullptr; } // Scanned access point hardware address.
+      int32_t channel() { return isConnected() ? _apChannel : 0; } // Connected access point channel.
+      int32_t channel(uint8_t index) { return (index == 0) ? _apChannel : 0; } // Scanned access point channel.
+      wifi_auth_mode_t encryptionType(uint8_t index); // Security of a scanned access point.
+      wl_status_t begin(const char* ssid, const char* passphrase = nullptr, int32_t channel = 0, const uint8_t* bssid = nullptr, bool connect = true); // Start connecting.
+      uint8_t waitForConnectResult(); // Status once connecting has finished.
+      bool disconnect(bool wifiOff = false); // Drop the connection.
+      bool reconnect(); // Connect again to the last access point.
+      bool isConnected() { return status() == WL_CONNECTED; } // True once connected.
+      wl_status_t status(); // Connection status.
+      IPAddress localIP() { return isConnected() ? _localIP : IPAddress(); } // Address given by the access point.
+      String macAddress() { return String("DE:AD:BE:EF:00:00"); } // Fixed fake MAC.
+      void onEvent(WiFiEventFuncCb callback) { _callback = callback; } // Event handler.
+      bool setHostname(const char* hostname) { _hostname = hostname; return true; } // Station host name.
+      const char* getHostname() { return _hostname.c_str(); } // Station host name.
+      bool mode(uint8_t m) { (void)m; return true; } // Station/AP mode. Ignored.
+      bool setAutoReconnect(bool autoReconnect) { (void)autoReconnect; return true; } // Ignored.
+      bool enableIpV6() { return true; } // Ignored.
+      bool softAP(const char* ssid, const char* passphrase = nullptr) { (void)ssid; (void)passphrase; return false; } // No AP mode.
+      bool softAPenableIpV6() { return true; } // Ignored.
+      void hostSetAccessPoint(const char* ssid, int32_t rssi, IPAddress localIP); // Host only. Make one access point visible.
+      void hostSetChannel(uint8_t channel) { _apChannel = channel; } // Host only. Move the access point to another channel.
+      void hostSetTimes(uint32_t scanMs, uint32_t joinMs, uint32_t channelJoinMs); // Host only. How long scans and joins take.
+      void hostDrop(); // Host only. Access point drops us.
+      uint32_t hostScans() { return _scans; } // Host only. Scans started.
+      uint32_t hostJoins() { return _joins; } // Host only. Joins started.
+      int32_t hostLastJoinChannel() { return _lastJoinChannel; } // Host only. Channel the last join named. 0 for any.
+   private:
+      void _event(WiFiEvent_t event); // Call the event handler.
+      void _finishJoin(); // Connect, or fail, as decided by begin().
+      wl_status_t _status = WL_IDLE_STATUS; // Connection status.
+      String _apSsid; // Access point the host pretends to see. Empty for none.
+      int32_t _apRssi = -127; // Its signal strength.
+      uint8_t _apBssid[6] = {0x02, 0x00, 0x5E, 0x00, 0x00, 0x01}; // Its hardware address.
+      int32_t _apChannel = HOST_AP_CHANNEL; // Its channel.
+      IPAddress _localIP; // Address given when connected.
+      String _hostname = "esp32"; // Station host name.
+      WiFiEventFuncCb _callback = nullptr; // Event handler.
+      uint32_t _scanMs = 0; // How long a scan takes.
+      uint32_t _joinMs = 0; // How long a join on every channel takes.
+      uint32_t _channelJoinMs = 0; // How long a join on one named channel takes.
+      int16_t _scan = WIFI_SCAN_FAILED; // What scanComplete() says once the scan is done.
+      bool _scanning = false; // Asynchronous scan under way.
+      uint32_t _scanStartMs = 0; // When it started.
+      bool _joining = false; // Join under way.
+      bool _joinWillWork = false; // How it will end.
+      uint32_t _joinStartMs = 0; // When it started.
+      uint32_t _joinTakesMs = 0; // How long it takes.
+      uint32_t _scans = 0; // Scans started.
+      uint32_t _joins = 0; // Joins started.
+      int32_t _lastJoinChannel = 0; // Channel the last join named.
+}; // class WiFiClass
+
+extern WiFiClass WiFi; // WiFi station.
+
+#endif // End of precompiler protected code block
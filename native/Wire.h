@@ -0,0 +1,83 @@
+/*************************************************************************************************************************************
+ * @file Wire.h
+ * @author va3wam
+ * @brief Host stand-in for the Arduino TwoWire I2C class, backed by a simulated bus.
+ * @details The host runner attaches an amI2cBus (normally an amSimBus full of simulated devices) to Wire and Wire1 with
+ * hostAttachBus(). A write of just the register number followed by requestFrom() becomes one readRegs(); a longer write becomes
+ * writeRegs(); an empty write is a probe. Every transaction holds the bus lock, and TwoWire is BasicLockable so the host runner
+ * can hold the same lock while it moves simulated time forward.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef TwoWire_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define TwoWire_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+#include <stddef.h> // size_t.
+#include <mutex> // Bus lock.
+#include <amI2cBus.h> // Register level I2C bus interface and status codes.
+
+#define I2C_BUFFER_LENGTH 128 // Same as the ESP32 core.
+
+/*************************************************************************************************************************************
+ * @class I2C bus master.
+ *************************************************************************************************************************************/
+class TwoWire
+{
+   public:
+      TwoWire(uint8_t busNum) : _busNum(busNum) {} // Class constructor.
+      void hostAttachBus(amI2cBus* bus) { _bus = bus; } // Host only. Put a simulated bus behind this TwoWire.
+      bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0); // Start the bus.
+      bool end() { return true; } // Stop the bus.
+      void setClock(uint32_t frequency) { _frequency = frequency; } // Bus speed.
+      uint32_t getClock() { return _frequency; } // Bus speed.
+      void setTimeOut(uint16_t timeOutMillis) { _timeOutMillis = timeOutMillis; } // Transaction timeout.
+      uint16_t getTimeOut() { return _timeOutMillis; } // Transaction timeout.
+      void beginTransmission(uint8_t address); // Start collecting a write.
+      void beginTransmission(int address) { beginTransmission((uint8_t)address); } // Start collecting a write.
+      uint8_t endTransmission(bool sendStop = true); // Send the collected write.
+      uint8_t requestFrom(uint8_t address, uint8_t quantity, bool sendStop = true); // Read from the register set by the last write.
+      uint8_t requestFrom(int address, int quantity, int sendStop = 1) { return requestFrom((uint8_t)address, (uint8_t)quantity, sendStop != 0); } // Read.
+      size_t write(uint8_t data); // Add one byte to the write.
+      size_t write(const uint8_t* data, size_t quantity); // Add bytes to the write.
+      size_t write(int data) { return write((uint8_t)data); } // Add one byte to the write.
+      int available() { return _rxLength - _rxIndex; } // Bytes left from requestFrom().
+      int read() { return (_rxIndex < _rxLength) ? _rxBuffer[_rxIndex++] : -1; } // Next byte from requestFrom().
+      int peek() { return (_rxIndex < _rxLength) ? _rxBuffer[_rxIndex] : -1; } // Next byte without taking it.
+      void flush() { _rxIndex = _rxLength = _txLength = 0; } // Drop buffered data.
+      void lock() { _lock.lock(); } // Hold the bus.
+      void unlock() { _lock.unlock(); } // Release the bus.
+   private:
+      uint8_t _busNum; // 0 for Wire, 1 for Wire1.
+      amI2cBus* _bus = nullptr; // Simulated bus. Nothing answers if not attached.
+      std::recursive_mutex _lock; // One transaction at a time.
+      uint32_t _frequency = 100000; // Bus speed.
+      uint16_t _timeOutMillis = 50; // Transaction timeout.
+      uint8_t _txAddress = 0; // Address of the write being collected.
+      uint8_t _txBuffer[I2C_BUFFER_LENGTH]; // Write being collected.
+      uint16_t _txLength = 0; // Bytes collected.
+      bool _regPointerValid = false; // Last write set a register pointer for requestFrom().
+      uint8_t _regPointerAddress = 0; // Device the register pointer was set on.
+      uint8_t _regPointer = 0; // Register the next requestFrom() starts at.
+      uint8_t _rxBuffer[I2C_BUFFER_LENGTH]; // Bytes from the last requestFrom().
+      uint16_t _rxLength = 0; // Bytes received.
+      uint16_t _rxIndex = 0; // Next byte for read().
+}; // class TwoWire
+
+extern TwoWire Wire; // I2C bus 0.
+extern TwoWire Wire1; // I2C bus 1.
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,31 @@
+/*************************************************************************************************************************************
+ * @file esp32-hal-log.h
+ * @author va3wam
+ * @brief Host stand-in for the logging macros of the Arduino Core for ESP32.
+ * @details Core debug output is compiled out, as it is in the firmware at the default core debug level.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef esp32_hal_log_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define esp32_hal_log_h // Precompiler macro used for precompiler check.
+
+#define log_e(format, ...) do {} while(0) // Error.
+#define log_w(format, ...) do {} while(0) // Warning.
+#define log_i(format, ...) do {} while(0) // Information.
+#define log_d(format, ...) do {} while(0) // Debug.
+#define log_v(format, ...) do {} while(0) // Verbose.
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,71 @@
+/*************************************************************************************************************************************
+ * @file FreeRTOS.h
+ * @author va3wam
+ * @brief Host stand-in for the parts of FreeRTOS the firmware uses.
+ * @details Each task is a std::thread. Core affinity and priority are recorded but not enforced; the host scheduler decides.
+ * Task notifications are a counter and a condition variable per task. hostStopTasks() makes every blocked task return from its
+ * function so that the host runner can exit cleanly.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef FreeRTOS_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define FreeRTOS_h // Precompiler macro used for precompiler check.
+
+#include <stdint.h> // Fixed width integer types.
+
+typedef int BaseType_t; // Signed word.
+typedef unsigned int UBaseType_t; // Unsigned word.
+typedef uint32_t TickType_t; // Ticks of portTICK_PERIOD_MS.
+typedef struct hostTask* TaskHandle_t; // One host thread.
+typedef void (*TaskFunction_t)(void*); // Task entry point.
+
+#define pdFALSE 0 // FreeRTOS false.
+#define pdTRUE 1 // FreeRTOS true.
+#define pdFAIL pdFALSE // FreeRTOS failure.
+#define pdPASS pdTRUE // FreeRTOS success.
+#define portMAX_DELAY (TickType_t)0xffffffffUL // Wait forever.
+#define portTICK_PERIOD_MS 1 // ESP32 runs FreeRTOS at 1kHz.
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms) / portTICK_PERIOD_MS) // Milliseconds to ticks.
+#define configMAX_PRIORITIES 25 // Same as the ESP32 build.
+#define tskNO_AFFINITY 0x7FFFFFFF // Run on either core.
+#define portYIELD_FROM_ISR() // Nothing to do. The notified thread is already runnable.
+
+typedef struct { uint32_t owner; uint32_t count; } portMUX_TYPE; // Spinlock. The host uses one lock for every critical section.
+#define portMUX_INITIALIZER_UNLOCKED {0, 0} // Unlocked spinlock.
+#define portENTER_CRITICAL(mux) vPortEnterCritical(mux) // Start a critical section.
+#define portEXIT_CRITICAL(mux) vPortExitCritical(mux) // End a critical section.
+#define portENTER_CRITICAL_ISR(mux) vPortEnterCritical(mux) // Same, from an ISR.
+#define portEXIT_CRITICAL_ISR(mux) vPortExitCritical(mux) // Same, from an ISR.
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth, void* parameter,
+                                   UBaseType_t priority, TaskHandle_t* created, BaseType_t coreId); // Start a task thread.
+BaseType_t xTaskCreate(TaskFunction_t code, const char* name, uint32_t stackDepth, void* parameter, UBaseType_t priority,
+                       TaskHandle_t* created); // Start a task thread on either core.
+void vTaskDelete(TaskHandle_t task); // End the calling task. Only NULL (self) is supported.
+void vTaskDelay(TickType_t ticks); // Sleep the calling thread.
+TickType_t xTaskGetTickCount(); // Ticks since the program started.
+TaskHandle_t xTaskGetCurrentTaskHandle(); // Task the caller is running in. NULL for the loop() thread.
+BaseType_t xPortGetCoreID(); // Core the task was pinned to. 1 for the loop() thread.
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait); // Wait for notifications.
+BaseType_t xTaskNotifyGive(TaskHandle_t task); // Add one to a task's notification count.
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken); // Same, from an ISR.
+void vPortEnterCritical(portMUX_TYPE* mux); // Keep every other task out until vPortExitCritical(). Nests.
+void vPortExitCritical(portMUX_TYPE* mux); // Let other tasks back in.
+
+// Host only.
+void hostStopTasks(); // Make every task return, then join them.
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,37 @@
+/*************************************************************************************************************************************
+ * @file semphr.h
+ * @author va3wam
+ * @brief Host stand-in for FreeRTOS semaphores.
+ * @details Mutexes and binary semaphores are provided. A mutex is a std::mutex, so like a FreeRTOS mutex it must not be taken twice by
+ * the same task. A binary semaphore may be given by one thread and taken by another, with a timeout.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Added binary semaphores
+ *************************************************************************************************************************************/
+#ifndef semphr_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define semphr_h // Precompiler macro used for precompiler check.
+
+#include <freertos/FreeRTOS.h> // Host FreeRTOS.
+
+typedef struct hostSemaphore* SemaphoreHandle_t; // One mutex or binary semaphore.
+
+SemaphoreHandle_t xSemaphoreCreateMutex(); // Create an unlocked mutex.
+SemaphoreHandle_t xSemaphoreCreateBinary(); // Create an empty binary semaphore.
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait); // Lock or take. Mutexes only wait for portMAX_DELAY; other waits try once.
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore); // Unlock or give.
+void vSemaphoreDelete(SemaphoreHandle_t semaphore); // Free the semaphore.
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,39 @@
+/*************************************************************************************************************************************
+ * @file timers.h
+ * @author va3wam
+ * @brief Host stand-in for FreeRTOS software timers.
+ * @details Callbacks run on their own thread rather than the timer service task, which is close enough for the firmware's one
+ * shot reconnect timers.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef timers_h // Start of precompiler check to avoid dupicate inclusion of this code block.
+
+#define timers_h // Precompiler macro used for precompiler check.
+
+#include <freertos/FreeRTOS.h> // Host FreeRTOS.
+
+typedef struct hostTimer* TimerHandle_t; // One software timer.
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t timer); // Expiry callback.
+
+TimerHandle_t xTimerCreate(const char* name, TickType_t period, UBaseType_t autoReload, void* timerId,
+                           TimerCallbackFunction_t callback); // Create a stopped timer.
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticksToWait); // Start or restart.
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticksToWait); // Stop.
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t ticksToWait); // Restart the period.
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer); // True while running.
+void* pvTimerGetTimerID(TimerHandle_t timer); // ID passed to xTimerCreate().
+
+#endif // End of precompiler protected code block
@@ -0,0 +1,481 @@
+/*************************************************************************************************************************************
+ * @file hostArduino.cpp
+ * @author va3wam
+ * @brief Host stand-in for the Arduino Core for ESP32: String, Print, IPAddress, Serial, ESP, time and GPIO.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <Arduino.h> // Host Arduino core.
+#include <stdarg.h> // printf() arguments.
+#include <ctype.h> // toupper(), isspace().
+#include <chrono> // Host clock.
+#include <thread> // sleep_for().
+#include <mutex> // GPIO state lock.
+
+HardwareSerial Serial; // Console.
+EspClass ESP; // Chip details.
+
+////// /// @brief String //////
+
+String::String(const char* cstr) : _s(cstr ? cstr : "") {} // String::String()
+String::String(const __FlashStringHelper* fstr) : _s(fstr ? (const char*)fstr : "") {} // String::String()
+String::String(char c) : _s(1, c) {} // String::String()
+String::String(unsigned char value, unsigned char base) : String((unsigned long)value, base) {} // String::String()
+String::String(int value, unsigned char base) : String((long)value, base) {} // String::String()
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {} // String::String()
+String::String(float value, unsigned char decimals) : String((double)value, decimals) {} // String::String()
+
+/**
+ * @brief Signed number in any base from 2 to 36.
+===================================================================================================*/
+String::String(long value, unsigned char base)
+{
+   if(value < 0 && base == 10)
+   {
+      _s = "-" + String((unsigned long)(-(value + 1)) + 1, base)._s;
+   } // if
+   else
+   {
+      _s = String((unsigned long)value, base)._s;
+   } // else
+} // String::String()
+
+/**
+ * @brief Unsigned number in any base from 2 to 36.
+===================================================================================================*/
+String::String(unsigned long value, unsigned char base)
+{
+   char buf[8 * sizeof(unsigned long) + 1];
+   char* p = &buf[sizeof(buf) - 1];
+   *p = 0;
+   if(base < 2)
+   {
+      base = 10;
+   } // if
+   do
+   {
+      unsigned long digit = value % base;
+      *--p = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+      value /= base;
+   } while(value != 0); // do
+   _s = p;
+} // String::String()
+
+/**
+ * @brief Number with a fixed number of decimal places.
+===================================================================================================*/
+String::String(double value, unsigned char decimals)
+{
+   char buf[64];
+   snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+   _s = buf;
+} // String::String()
+
+/**
+ * @brief Compare ignoring case.
+===================================================================================================*/
+bool String::equalsIgnoreCase(const String &s) const
+{
+   if(_s.length() != s._s.length())
+   {
+      return false;
+   } // if
+   for(size_t i = 0; i < _s.length(); i++)
+   {
+      if(toupper((unsigned char)_s[i]) != toupper((unsigned char)s._s[i]))
+      {
+         return false;
+      } // if
+   } // for
+   return true;
+} // String::equalsIgnoreCase()
+
+bool String::endsWith(const String &suffix) const { return _s.length() >= suffix._s.length() && _s.compare(_s.length() - suffix._s.length(), suffix._s.length(), suffix._s) == 0; } // String::endsWith()
+int String::indexOf(char c, unsigned int from) const { size_t i = _s.find(c, from); return (i == std::string::npos) ? -1 : (int)i; } // String::indexOf()
+int String::indexOf(const String &s, unsigned int from) const { size_t i = _s.find(s._s, from); return (i == std::string::npos) ? -1 : (int)i; } // String::indexOf()
+int String::lastIndexOf(char c) const { size_t i = _s.rfind(c); return (i == std::string::npos) ? -1 : (int)i; } // String::lastIndexOf()
+String String::substring(unsigned int from) const { return (from >= _s.length()) ? String() : String(_s.substr(from)); } // String::substring()
+
+/**
+ * @brief Characters from..to-1. The ends are swapped if to is before from, as Arduino does.
+===================================================================================================*/
+String String::substring(unsigned int from, unsigned int to) const
+{
+   if(from > to)
+   {
+      unsigned int tmp = from;
+      from = to;
+      to = tmp;
+   } // if
+   if(from >= _s.length())
+   {
+      return String();
+   } // if
+   return String(_s.substr(from, to - from));
+} // String::substring()
+
+/**
+ * @brief Replace every occurence of find.
+===================================================================================================*/
+void String::replace(const String &find, const String &with)
+{
+   if(find._s.empty())
+   {
+      return;
+   } // if
+   size_t pos = 0;
+   while((pos = _s.find(find._s, pos)) != std::string::npos)
+   {
+      _s.replace(pos, find._s.length(), with._s);
+      pos += with._s.length();
+   } // while
+} // String::replace()
+
+void String::remove(unsigned int index, unsigned int count) { if(index < _s.length()) _s.erase(index, count); } // String::remove()
+void String::toUpperCase() { for(auto &c : _s) c = (char)toupper((unsigned char)c); } // String::toUpperCase()
+void String::toLowerCase() { for(auto &c : _s) c = (char)tolower((unsigned char)c); } // String::toLowerCase()
+long String::toInt() const { return atol(_s.c_str()); } // String::toInt()
+float String::toFloat() const { return (float)atof(_s.c_str()); } // String::toFloat()
+double String::toDouble() const { return atof(_s.c_str()); } // String::toDouble()
+
+/**
+ * @brief Strip leading and trailing white space.
+===================================================================================================*/
+void String::trim()
+{
+   size_t first = 0;
+   while(first < _s.length() && isspace((unsigned char)_s[first]))
+   {
+      first++;
+   } // while
+   size_t last = _s.length();
+   while(last > first && isspace((unsigned char)_s[last - 1]))
+   {
+      last--;
+   } // while
+   _s = _s.substr(first, last - first);
+} // String::trim()
+
+/**
+ * @brief Copy the contents out, NUL terminated and truncated to fit.
+===================================================================================================*/
+void String::toCharArray(char* buf, unsigned int bufsize, unsigned int index) const
+{
+   if(bufsize == 0 || buf == nullptr)
+   {
+      return;
+   } // if
+   size_t n = (index < _s.length()) ? _s.length() - index : 0;
+   if(n > bufsize - 1)
+   {
+      n = bufsize - 1;
+   } // if
+   memcpy(buf, _s.c_str() + ((index < _s.length()) ? index : 0), n);
+   buf[n] = 0;
+} // String::toCharArray()
+
+void String::getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index) const { toCharArray((char*)buf, bufsize, index); } // String::getBytes()
+
+////// /// @brief Print //////
+
+/**
+ * @brief Send a block one byte at a time. Subclasses can do better.
+===================================================================================================*/
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+   size_t n = 0;
+   while(size--)
+   {
+      n += write(*buffer++);
+   } // while
+   return n;
+} // Print::write()
+
+size_t Print::write(const char* str) { return (str == nullptr) ? 0 : write((const uint8_t*)str, strlen(str)); } // Print::write()
+
+/**
+ * @brief Formatted output.
+===================================================================================================*/
+size_t Print::printf(const char* format, ...)
+{
+   char buf[256];
+   va_list args;
+   va_start(args, format);
+   int len = vsnprintf(buf, sizeof(buf), format, args);
+   va_end(args);
+   if(len < 0)
+   {
+      return 0;
+   } // if
+   if((size_t)len < sizeof(buf))
+   {
+      return write((const uint8_t*)buf, len);
+   } // if
+   std::string big(len + 1, '\0'); // Too long for the stack buffer.
+   va_start(args, format);
+   vsnprintf(&big[0], big.size(), format, args);
+   va_end(args);
+   return write((const uint8_t*)big.c_str(), len);
+} // Print::printf()
+
+/**
+ * @brief Signed number. Bases other than 10 print the two's complement, as Arduino does.
+===================================================================================================*/
+size_t Print::print(long n, int base)
+{
+   if(base == 10)
+   {
+      return print(String(n, 10));
+   } // if
+   return print(String((unsigned long)n, base));
+} // Print::print()
+
+size_t Print::print(unsigned long n, int base) { return print(String(n, (unsigned char)base)); } // Print::print()
+size_t Print::print(double n, int digits) { return print(String(n, (unsigned char)digits)); } // Print::print()
+
+////// /// @brief IPAddress //////
+
+IPAddress::IPAddress(uint32_t address) : _bytes{(uint8_t)address, (uint8_t)(address >> 8), (uint8_t)(address >> 16), (uint8_t)(address >> 24)} {} // IPAddress::IPAddress()
+IPAddress::operator uint32_t() const { return (uint32_t)_bytes[0] | ((uint32_t)_bytes[1] << 8) | ((uint32_t)_bytes[2] << 16) | ((uint32_t)_bytes[3] << 24); } // IPAddress::operator uint32_t()
+
+/**
+ * @brief Parse dotted decimal.
+ * @return false if address is not four numbers from 0 to 255 separated by dots.
+===================================================================================================*/
+bool IPAddress::fromString(const char* address)
+{
+   unsigned int part[4];
+   char tail;
+   if(address == nullptr || sscanf(address, "%u.%u.%u.%u%c", &part[0], &part[1], &part[2], &part[3], &tail) != 4)
+   {
+      return false;
+   } // if
+   for(int i = 0; i < 4; i++)
+   {
+      if(part[i] > 255)
+      {
+         return false;
+      } // if
+      _bytes[i] = (uint8_t)part[i];
+   } // for
+   return true;
+} // IPAddress::fromString()
+
+/**
+ * @brief Dotted decimal.
+===================================================================================================*/
+String IPAddress::toString() const
+{
+   char buf[16];
+   snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _bytes[0], _bytes[1], _bytes[2], _bytes[3]);
+   return String(buf);
+} // IPAddress::toString()
+
+////// /// @brief HardwareSerial //////
+
+void HardwareSerial::flush() { fflush(stdout); } // HardwareSerial::flush()
+size_t HardwareSerial::write(uint8_t c) { return (fputc(c, stdout) == EOF) ? 0 : 1; } // HardwareSerial::write()
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) { return fwrite(buffer, 1, size, stdout); } // HardwareSerial::write()
+
+////// /// @brief Time //////
+
+static const std::chrono::steady_clock::time_point hostStart = std::chrono::steady_clock::now(); // Host "power on".
+
+/**
+ * @brief Microseconds since start up, as a 64 bit count.
+===================================================================================================*/
+static uint64_t hostMicros()
+{
+   return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - hostStart).count();
+} // hostMicros()
+
+unsigned long millis() { return (uint32_t)(hostMicros() / 1000); } // Wraps at 32 bits like the ESP32.
+unsigned long micros() { return (uint32_t)hostMicros(); } // Wraps at 32 bits like the ESP32.
+uint32_t EspClass::getCycleCount() { return (uint32_t)(hostMicros() * 240); } // 240MHz.
+void delay(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); } // delay()
+void delayMicroseconds(uint32_t us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); } // delayMicroseconds()
+void yield() { std::this_thread::yield(); } // yield()
+
+/**
+ * @brief Restart the chip. On the host this ends the process.
+===================================================================================================*/
+void EspClass::restart()
+{
+   fflush(stdout);
+   std::_Exit(0);
+} // EspClass::restart()
+
+////// /// @brief GPIO //////
+
+#define HOST_LEDC_CHANNELS 16 // ESP32 LEDC channel count.
+
+static std::mutex hostPinLock; // Pin state is touched from loop(), tasks and the host runner.
+static uint8_t hostPinMode[NUM_DIGITAL_PINS]; // pinMode() per pin.
+static uint8_t hostPinLevel[NUM_DIGITAL_PINS]; // Level per pin.
+static void (*hostPinIsr[NUM_DIGITAL_PINS])(void); // attachInterrupt() handler per pin.
+static int hostPinIsrMode[NUM_DIGITAL_PINS]; // attachInterrupt() mode per pin.
+static bool hostPinHeld[NUM_DIGITAL_PINS]; // Held LOW from outside. See hostHoldPin().
+static void (*hostPinWriteHook)(uint8_t pin, uint8_t value) = nullptr; // See hostOnPinWrite().
+static uint32_t hostLedcDuty[HOST_LEDC_CHANNELS]; // ledcWrite() per channel.
+
+/**
+ * @brief Set a pin direction. Pulled up inputs read HIGH until hostSetPin() says otherwise.
+===================================================================================================*/
+void pinMode(uint8_t pin, uint8_t mode)
+{
+   if(pin >= NUM_DIGITAL_PINS)
+   {
+      return;
+   } // if
+   std::lock_guard<std::mutex> guard(hostPinLock);
+   hostPinMode[pin] = mode;
+   if((mode & PULLUP) != 0)
+   {
+      hostPinLevel[pin] = HIGH;
+   } // if
+} // pinMode()
+
+/**
+ * @brief Set an output pin, then tell the hostOnPinWrite() watcher.
+===================================================================================================*/
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+   if(pin >= NUM_DIGITAL_PINS)
+   {
+      return;
+   } // if
+   void (*hook)(uint8_t, uint8_t);
+   {
+      std::lock_guard<std::mutex> guard(hostPinLock);
+      hostPinLevel[pin] = value ? HIGH : LOW;
+      hook = hostPinWriteHook;
+   } // guard
+   if(hook != nullptr) // Outside the lock, as the watcher may hold or set pins.
+   {
+      hook(pin, value ? HIGH : LOW);
+   } // if
+} // digitalWrite()
+
+/**
+ * @brief Read a pin. A held pin reads LOW whatever was written to it.
+===================================================================================================*/
+int digitalRead(uint8_t pin)
+{
+   if(pin >= NUM_DIGITAL_PINS)
+   {
+      return LOW;
+   } // if
+   std::lock_guard<std::mutex> guard(hostPinLock);
+   return hostPinHeld[pin] ? LOW : hostPinLevel[pin];
+} // digitalRead()
+
+uint16_t analogRead(uint8_t pin) { (void)pin; return 0; } // analogRead()
+
+/**
+ * @brief Call isr on the chosen edges of pin. See hostSetPin().
+===================================================================================================*/
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode)
+{
+   if(pin < NUM_DIGITAL_PINS)
+   {
+      std::lock_guard<std::mutex> guard(hostPinLock);
+      hostPinIsr[pin] = isr;
+      hostPinIsrMode[pin] = mode;
+   } // if
+} // attachInterrupt()
+
+/**
+ * @brief Stop calling the pin's isr.
+===================================================================================================*/
+void detachInterrupt(uint8_t pin)
+{
+   if(pin < NUM_DIGITAL_PINS)
+   {
+      std::lock_guard<std::mutex> guard(hostPinLock);
+      hostPinIsr[pin] = nullptr;
+   } // if
+} // detachInterrupt()
+
+/**
+ * @brief Drive an input pin from outside the firmware.
+ * @details Runs the pin's interrupt handler on the calling thread if the level change matches the
+ * mode given to attachInterrupt().
+ * @param pin GPIO number.
+ * @param value HIGH or LOW.
+===================================================================================================*/
+void hostSetPin(uint8_t pin, uint8_t value)
+{
+   if(pin >= NUM_DIGITAL_PINS)
+   {
+      return;
+   } // if
+   void (*isr)(void) = nullptr;
+   {
+      std::lock_guard<std::mutex> guard(hostPinLock);
+      uint8_t old = hostPinLevel[pin];
+      hostPinLevel[pin] = value ? HIGH : LOW;
+      bool rising = (old == LOW && hostPinLevel[pin] == HIGH);
+      bool falling = (old == HIGH && hostPinLevel[pin] == LOW);
+      int mode = hostPinIsrMode[pin];
+      if((rising && (mode == RISING || mode == CHANGE)) || (falling && (mode == FALLING || mode == CHANGE)))
+      {
+         isr = hostPinIsr[pin];
+      } // if
+   } // guard
+   if(isr != nullptr) // Outside the lock, as the ISR may read pins.
+   {
+      isr();
+   } // if
+} // hostSetPin()
+
+/**
+ * @brief Hold a pin LOW from outside, as a device would hold a shared open drain line.
+ * @details While held, digitalRead() gives LOW whatever the firmware writes, the way SDA reads when
+ * a device is stuck part way through sending a byte.
+ * @param pin GPIO number.
+ * @param held true to hold LOW, false to let go.
+===================================================================================================*/
+void hostHoldPin(uint8_t pin, bool held)
+{
+   if(pin < NUM_DIGITAL_PINS)
+   {
+      std::lock_guard<std::mutex> guard(hostPinLock);
+      hostPinHeld[pin] = held;
+   } // if
+} // hostHoldPin()
+
+/**
+ * @brief Have a function called after every digitalWrite(), on the writing thread.
+ * @param fn Called with the pin and the level written. nullptr to stop.
+===================================================================================================*/
+void hostOnPinWrite(void (*fn)(uint8_t pin, uint8_t value))
+{
+   std::lock_guard<std::mutex> guard(hostPinLock);
+   hostPinWriteHook = fn;
+} // hostOnPinWrite()
+
+double ledcSetup(uint8_t channel, double freq, uint8_t resolutionBits) { (void)channel; (void)resolutionBits; return freq; } // ledcSetup()
+void ledcAttachPin(uint8_t pin, uint8_t channel) { (void)pin; (void)channel; } // ledcAttachPin()
+void ledcDetachPin(uint8_t pin) { (void)pin; } // ledcDetachPin()
+void ledcWrite(uint8_t channel, uint32_t duty) { if(channel < HOST_LEDC_CHANNELS) hostLedcDuty[channel] = duty; } // ledcWrite()
+uint32_t ledcRead(uint8_t channel) { return (channel < HOST_LEDC_CHANNELS) ? hostLedcDuty[channel] : 0; } // ledcRead()
+
+////// /// @brief Maths //////
+
+long random(long howBig) { return (howBig <= 0) ? 0 : rand() % howBig; } // random()
+long random(long howSmall, long howBig) { return (howSmall >= howBig) ? howSmall : howSmall + random(howBig - howSmall); } // random()
+void randomSeed(unsigned long seed) { srand((unsigned int)seed); } // randomSeed()
+long map(long x, long inMin, long inMax, long outMin, long outMax) { return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin; } // map()
+uint32_t getCpuFrequencyMhz() { return 240; } // getCpuFrequencyMhz()
@@ -0,0 +1,46 @@
+/*************************************************************************************************************************************
+ * @file hostAsyncMqttClient.cpp
+ * @author va3wam
+ * @brief The real AsyncMqttClient, built for the host against native/AsyncTCP.h.
+ * @details [env:native] builds the firmware against the stand-in in native/AsyncMqttClient.h, so this file is left out of it by
+ * build_src_filter. Tests that want the real client, packet for packet, include it after hostArduino.cpp and hostFreeRTOS.cpp and
+ * play the broker through AsyncClient::hostClient().
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#ifndef ESP32
+#define ESP32 1 // The library's ESP32 paths: FreeRTOS mutex and portMUX pool locks.
+#endif
+#ifndef ARDUINO_ARCH_ESP32
+#define ARDUINO_ARCH_ESP32 1 // As above.
+#endif
+#include "../lib/AsyncMqttClient-0.9.0/src/AsyncMqttClient.cpp"
+#include "../lib/AsyncMqttClient-0.9.0/src/AsyncMqttClient/Packets/ConnAckPacket.cpp"
+#include "../lib/AsyncMqttClient-0.9.0/src/AsyncMqttClient/Packets/PingRespPacket.cpp"
+#include "../lib/AsyncMqttClient-0.9.0/src/AsyncMqttClient/Packets/PubAckPacket.cpp"
+#include "../lib/AsyncMqttClient-0.9.0/src/AsyncMqttClient/Packets/PubCompPacket.cpp"
+#include "../lib/AsyncMqttClient-0.9.0/src/AsyncMqttClient/Packets/PubRecPacket.cpp"
+#include "../lib/AsyncMqttClient-0.9.0/src/AsyncMqttClient/Packets/PubRelPacket.cpp"
+#include "../lib/AsyncMqttClient-0.9.0/src/AsyncMqttClient/Packets/PublishPacket.cpp"
+#include "../lib/AsyncMqttClient-0.9.0/src/AsyncMqttClient/Packets/SubAckPacket.cpp"
+#include "../lib/AsyncMqttClient-0.9.0/src/AsyncMqttClient/Packets/UnsubAckPacket.cpp"
+#include "../lib/AsyncMqttClient-0.9.0/src/AsyncMqttClient/Packets/Out/Connect.cpp"
+#include "../lib/AsyncMqttClient-0.9.0/src/AsyncMqttClient/Packets/Out/Disconn.cpp"
+#include "../lib/AsyncMqttClient-0.9.0/src/AsyncMqttClient/Packets/Out/OutPacket.cpp"
+#include "../lib/AsyncMqttClient-0.9.0/src/AsyncMqttClient/Packets/Out/PingReq.cpp"
+#include "../lib/AsyncMqttClient-0.9.0/src/AsyncMqttClient/Packets/Out/PubAck.cpp"
+#include "../lib/AsyncMqttClient-0.9.0/src/AsyncMqttClient/Packets/Out/Publish.cpp"
+#include "../lib/AsyncMqttClient-0.9.0/src/AsyncMqttClient/Packets/Out/Subscribe.cpp"
+#include "../lib/AsyncMqttClient-0.9.0/src/AsyncMqttClient/Packets/Out/Unsubscribe.cpp"
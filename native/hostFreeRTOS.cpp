@@ -0,0 +1,514 @@
+/*************************************************************************************************************************************
+ * @file hostFreeRTOS.cpp
+ * @author va3wam
+ * @brief Host stand-in for FreeRTOS tasks, notifications, software timers, semaphores and critical sections, and for the ESP32 hardware
+ * timer interrupt.
+ * @details Every task, software timer and hardware timer is a std::thread. They all wait on one lock and condition variable,
+ * which is plenty for the handful of threads the firmware starts. hostStopTasks() wakes them all with a stop flag set; a task
+ * blocked in ulTaskNotifyTake() or vTaskDelay() then unwinds out of its function so that it can be joined.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam hostStopTasks() frees the tasks it has joined
+ * 2026-10-17 va3wam Added binary semaphores
+ *************************************************************************************************************************************/
+#include <Arduino.h> // Host Arduino core.
+#include <freertos/FreeRTOS.h> // Host FreeRTOS.
+#include <freertos/timers.h> // Host software timers.
+#include <freertos/semphr.h> // Host mutexes.
+#include <ESP32TimerInterrupt.h> // Host hardware timer.
+#include <algorithm> // std::find().
+#include <atomic> // Stop flag.
+#include <chrono> // Deadlines.
+#include <condition_variable> // Waiting.
+#include <mutex> // Shared state.
+#include <string> // Task names.
+#include <thread> // Tasks.
+#include <vector> // Thread registry.
+
+/*! One FreeRTOS task. */
+struct hostTask
+{
+   std::string name; ///< Name given to xTaskCreate().
+   BaseType_t coreId; ///< Core given to xTaskCreatePinnedToCore().
+   uint32_t notifications = 0; ///< Notification count.
+   std::thread thread; ///< Thread running the task.
+}; // struct
+
+/*! One FreeRTOS software timer. */
+struct hostTimer
+{
+   std::string name; ///< Name given to xTimerCreate().
+   TickType_t period; ///< Period in ticks.
+   bool autoReload; ///< Restart after expiring.
+   void* id; ///< ID given to xTimerCreate().
+   TimerCallbackFunction_t callback; ///< Expiry callback.
+   bool active = false; ///< Counting down.
+   std::chrono::steady_clock::time_point deadline; ///< When it expires.
+   std::thread thread; ///< Thread running the callback.
+}; // struct
+
+/*! Thread behind one ESP32Timer. */
+struct hostTimerThread
+{
+   std::atomic<bool> stop{false}; ///< Set by detachInterrupt().
+   std::thread thread; ///< Thread calling the callback.
+}; // struct
+
+/*! One FreeRTOS mutex or binary semaphore. */
+struct hostSemaphore
+{
+   std::mutex mutex; ///< The lock, for a mutex.
+   bool binary = false; ///< Binary semaphore rather than a mutex.
+   bool given = false; ///< Binary semaphore is available. Guarded by hostLock.
+}; // struct
+
+struct hostTaskStop {}; // Thrown into a blocked task to make it return.
+
+static std::recursive_mutex hostCritical; // Held inside portENTER_CRITICAL(). One for all spinlocks, like a single core.
+static std::mutex hostLock; // Guards everything below.
+static std::condition_variable hostWake; // Notified on any change.
+static std::atomic<bool> hostStopping{false}; // hostStopTasks() called.
+static std::vector<hostTask*> hostTasks; // Every task created.
+static std::vector<hostTimer*> hostTimers; // Every software timer created.
+static std::vector<hostTimerThread*> hostTimerThreads; // Every ESP32Timer callback thread running.
+static thread_local hostTask* hostCurrentTask = nullptr; // Task running on this thread.
+
+/**
+ * @brief Thread body for a task. Returns quietly if the task is told to stop.
+===================================================================================================*/
+static void hostTaskMain(hostTask* task, TaskFunction_t code, void* parameter)
+{
+   hostCurrentTask = task;
+   try
+   {
+      code(parameter);
+   } // try
+   catch(const hostTaskStop &)
+   {
+   } // catch
+} // hostTaskMain()
+
+/**
+ * @brief Start a task.
+ * @details Stack depth and priority are accepted for compatibility but the host scheduler decides
+ * where and when the thread runs. The core is only remembered for xPortGetCoreID().
+ * @return pdPASS.
+===================================================================================================*/
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth, void* parameter,
+                                   UBaseType_t priority, TaskHandle_t* created, BaseType_t coreId)
+{
+   (void)stackDepth;
+   (void)priority;
+   hostTask* task = new hostTask();
+   task->name = (name != nullptr) ? name : "";
+   task->coreId = coreId;
+   {
+      std::lock_guard<std::mutex> guard(hostLock);
+      hostTasks.push_back(task);
+      if(created != nullptr)
+      {
+         *created = task; // Before the thread starts, so an ISR can notify it straight away.
+      } // if
+   } // guard
+   task->thread = std::thread(hostTaskMain, task, code, parameter);
+   return pdPASS;
+} // xTaskCreatePinnedToCore()
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char* name, uint32_t stackDepth, void* parameter, UBaseType_t priority, TaskHandle_t* created) { return xTaskCreatePinnedToCore(code, name, stackDepth, parameter, priority, created, tskNO_AFFINITY); } // xTaskCreate()
+TaskHandle_t xTaskGetCurrentTaskHandle() { return hostCurrentTask; } // xTaskGetCurrentTaskHandle()
+BaseType_t xPortGetCoreID() { return (hostCurrentTask == nullptr || hostCurrentTask->coreId == tskNO_AFFINITY) ? 1 : hostCurrentTask->coreId; } // xPortGetCoreID()
+TickType_t xTaskGetTickCount() { return (TickType_t)(millis() / portTICK_PERIOD_MS); } // xTaskGetTickCount()
+
+/**
+ * @brief End the calling task.
+===================================================================================================*/
+void vTaskDelete(TaskHandle_t task)
+{
+   if(task == nullptr || task == hostCurrentTask)
+   {
+      throw hostTaskStop(); // Unwinds to hostTaskMain(). The thread is joined by hostStopTasks().
+   } // if
+} // vTaskDelete()
+
+/**
+ * @brief Sleep the calling thread. Returns early, by unwinding, if the host is stopping.
+===================================================================================================*/
+void vTaskDelay(TickType_t ticks)
+{
+   std::unique_lock<std::mutex> guard(hostLock);
+   hostWake.wait_for(guard, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), [] { return hostStopping.load(); });
+   if(hostStopping && hostCurrentTask != nullptr)
+   {
+      throw hostTaskStop();
+   } // if
+} // vTaskDelay()
+
+/**
+ * @brief Wait for the calling task's notification count to be non zero.
+ * @param clearCountOnExit pdTRUE to zero the count, pdFALSE to take one.
+ * @param ticksToWait How long to wait. portMAX_DELAY waits forever.
+ * @return The count before it was cleared or decremented. 0 on timeout.
+===================================================================================================*/
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait)
+{
+   hostTask* task = hostCurrentTask;
+   if(task == nullptr)
+   {
+      return 0; // Not called from a task.
+   } // if
+   std::unique_lock<std::mutex> guard(hostLock);
+   auto ready = [task] { return task->notifications > 0 || hostStopping.load(); };
+   if(ticksToWait == portMAX_DELAY)
+   {
+      hostWake.wait(guard, ready);
+   } // if
+   else
+   {
+      hostWake.wait_for(guard, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), ready);
+   } // else
+   if(hostStopping)
+   {
+      throw hostTaskStop();
+   } // if
+   uint32_t count = task->notifications;
+   if(count > 0)
+   {
+      task->notifications = (clearCountOnExit == pdTRUE) ? 0 : count - 1;
+   } // if
+   return count;
+} // ulTaskNotifyTake()
+
+/**
+ * @brief Add one to a task's notification count.
+ * @return pdPASS.
+===================================================================================================*/
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+   if(task != nullptr)
+   {
+      std::lock_guard<std::mutex> guard(hostLock);
+      task->notifications++;
+   } // if
+   hostWake.notify_all();
+   return pdPASS;
+} // xTaskNotifyGive()
+
+/**
+ * @brief Add one to a task's notification count from an interrupt.
+===================================================================================================*/
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken)
+{
+   xTaskNotifyGive(task);
+   if(higherPriorityTaskWoken != nullptr)
+   {
+      *higherPriorityTaskWoken = pdTRUE;
+   } // if
+} // vTaskNotifyGiveFromISR()
+
+/**
+ * @brief Thread body for a software timer.
+===================================================================================================*/
+static void hostTimerMain(hostTimer* timer)
+{
+   std::unique_lock<std::mutex> guard(hostLock);
+   while(!hostStopping)
+   {
+      if(!timer->active)
+      {
+         hostWake.wait(guard);
+         continue;
+      } // if
+      if(hostWake.wait_until(guard, timer->deadline) == std::cv_status::no_timeout)
+      {
+         continue; // Something changed. Look again.
+      } // if
+      if(!timer->active || std::chrono::steady_clock::now() < timer->deadline)
+      {
+         continue; // Stopped or restarted while waiting.
+      } // if
+      if(timer->autoReload)
+      {
+         timer->deadline += std::chrono::milliseconds(timer->period * portTICK_PERIOD_MS);
+      } // if
+      else
+      {
+         timer->active = false;
+      } // else
+      guard.unlock(); // Callback may start or stop timers.
+      timer->callback(timer);
+      guard.lock();
+   } // while
+} // hostTimerMain()
+
+/**
+ * @brief Create a stopped software timer.
+===================================================================================================*/
+TimerHandle_t xTimerCreate(const char* name, TickType_t period, UBaseType_t autoReload, void* timerId, TimerCallbackFunction_t callback)
+{
+   hostTimer* timer = new hostTimer();
+   timer->name = (name != nullptr) ? name : "";
+   timer->period = period;
+   timer->autoReload = (autoReload == pdTRUE);
+   timer->id = timerId;
+   timer->callback = callback;
+   {
+      std::lock_guard<std::mutex> guard(hostLock);
+      hostTimers.push_back(timer);
+   } // guard
+   timer->thread = std::thread(hostTimerMain, timer);
+   return timer;
+} // xTimerCreate()
+
+/**
+ * @brief Start or restart a software timer.
+ * @return pdPASS, or pdFAIL for a NULL timer.
+===================================================================================================*/
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticksToWait)
+{
+   (void)ticksToWait;
+   if(timer == nullptr)
+   {
+      return pdFAIL;
+   } // if
+   {
+      std::lock_guard<std::mutex> guard(hostLock);
+      timer->active = true;
+      timer->deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timer->period * portTICK_PERIOD_MS);
+   } // guard
+   hostWake.notify_all();
+   return pdPASS;
+} // xTimerStart()
+
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t ticksToWait) { return xTimerStart(timer, ticksToWait); } // xTimerReset()
+void* pvTimerGetTimerID(TimerHandle_t timer) { return (timer == nullptr) ? nullptr : timer->id; } // pvTimerGetTimerID()
+
+/**
+ * @brief Stop a software timer.
+ * @return pdPASS, or pdFAIL for a NULL timer.
+===================================================================================================*/
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticksToWait)
+{
+   (void)ticksToWait;
+   if(timer == nullptr)
+   {
+      return pdFAIL;
+   } // if
+   {
+      std::lock_guard<std::mutex> guard(hostLock);
+      timer->active = false;
+   } // guard
+   hostWake.notify_all();
+   return pdPASS;
+} // xTimerStop()
+
+/**
+ * @brief True while a software timer is counting down.
+===================================================================================================*/
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer)
+{
+   if(timer == nullptr)
+   {
+      return pdFALSE;
+   } // if
+   std::lock_guard<std::mutex> guard(hostLock);
+   return timer->active ? pdTRUE : pdFALSE;
+} // xTimerIsTimerActive()
+
+/**
+ * @brief Make every task and software timer return, then join their threads and free the tasks.
+ * @details Call from the thread that runs setup() and loop(), never from a task.
+===================================================================================================*/
+void hostStopTasks()
+{
+   {
+      std::lock_guard<std::mutex> guard(hostLock);
+      hostStopping = true;
+   } // guard
+   hostWake.notify_all();
+   for(hostTask* task : hostTasks)
+   {
+      if(task->thread.joinable())
+      {
+         task->thread.join();
+      } // if
+      delete task;
+   } // for
+   hostTasks.clear();
+   for(hostTimer* timer : hostTimers)
+   {
+      if(timer->thread.joinable())
+      {
+         timer->thread.join();
+      } // if
+   } // for
+   std::vector<hostTimerThread*> running;
+   {
+      std::lock_guard<std::mutex> guard(hostLock);
+      running = hostTimerThreads;
+   } // guard
+   for(hostTimerThread* t : running)
+   {
+      t->stop = true;
+      if(t->thread.joinable())
+      {
+         t->thread.join();
+      } // if
+   } // for
+} // hostStopTasks()
+
+/**
+ * @brief Create an unlocked mutex.
+===================================================================================================*/
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new hostSemaphore(); } // xSemaphoreCreateMutex()
+
+/**
+ * @brief Create an empty binary semaphore.
+===================================================================================================*/
+SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+   hostSemaphore* semaphore = new hostSemaphore();
+   semaphore->binary = true;
+   return semaphore;
+} // xSemaphoreCreateBinary()
+
+/**
+ * @brief Lock a mutex or take a binary semaphore.
+ * @details A mutex waits for portMAX_DELAY only. Any other wait tries once, which is all the
+ * libraries the host builds ask for. A binary semaphore waits as long as it is told to, from a task
+ * or from any other thread, and unwinds a task if the host is stopping.
+ * @return pdTRUE if the mutex or semaphore was taken.
+===================================================================================================*/
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait)
+{
+   if(semaphore->binary)
+   {
+      std::unique_lock<std::mutex> guard(hostLock);
+      auto ready = [semaphore] { return semaphore->given || hostStopping.load(); };
+      if(ticksToWait == portMAX_DELAY)
+      {
+         hostWake.wait(guard, ready);
+      } // if
+      else
+      {
+         hostWake.wait_for(guard, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), ready);
+      } // else
+      if(hostStopping && hostCurrentTask != nullptr)
+      {
+         throw hostTaskStop();
+      } // if
+      bool taken = semaphore->given;
+      semaphore->given = false;
+      return taken ? pdTRUE : pdFALSE;
+   } // if
+   if(ticksToWait == portMAX_DELAY)
+   {
+      semaphore->mutex.lock();
+      return pdTRUE;
+   } // if
+   return semaphore->mutex.try_lock() ? pdTRUE : pdFALSE;
+} // xSemaphoreTake()
+
+/**
+ * @brief Unlock a mutex or give a binary semaphore.
+ * @return pdFALSE if the binary semaphore had already been given.
+===================================================================================================*/
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+   if(semaphore->binary)
+   {
+      bool wasGiven;
+      {
+         std::lock_guard<std::mutex> guard(hostLock);
+         wasGiven = semaphore->given;
+         semaphore->given = true;
+      } // guard
+      hostWake.notify_all();
+      return wasGiven ? pdFALSE : pdTRUE;
+   } // if
+   semaphore->mutex.unlock();
+   return pdTRUE;
+} // xSemaphoreGive()
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) { delete semaphore; } // vSemaphoreDelete()
+void vPortEnterCritical(portMUX_TYPE* mux) { (void)mux; hostCritical.lock(); } // vPortEnterCritical()
+void vPortExitCritical(portMUX_TYPE* mux) { (void)mux; hostCritical.unlock(); } // vPortExitCritical()
+
+////// /// @brief ESP32Timer //////
+
+/**
+ * @brief Class destructor. Stops the callback thread.
+===================================================================================================*/
+ESP32Timer::~ESP32Timer()
+{
+   detachInterrupt();
+} // ESP32Timer::~ESP32Timer()
+
+/**
+ * @brief Call callback every intervalUs until detachInterrupt().
+ * @details Deadlines advance by whole periods from the first one so that late calls do not
+ * push the later ones back, as with the hardware alarm. Replaces any earlier interval.
+ * @return true.
+===================================================================================================*/
+bool ESP32Timer::attachInterruptInterval(uint64_t intervalUs, timerCallback callback)
+{
+   detachInterrupt();
+   hostTimerThread* t = new hostTimerThread();
+   t->thread = std::thread([t, intervalUs, callback]
+   {
+      auto period = std::chrono::microseconds(intervalUs);
+      auto deadline = std::chrono::steady_clock::now() + period;
+      while(!t->stop && !hostStopping)
+      {
+         std::this_thread::sleep_until(deadline);
+         if(t->stop || hostStopping)
+         {
+            break;
+         } // if
+         callback();
+         deadline += period;
+      } // while
+   });
+   {
+      std::lock_guard<std::mutex> guard(hostLock);
+      hostTimerThreads.push_back(t);
+   } // guard
+   _thread = t;
+   return true;
+} // ESP32Timer::attachInterruptInterval()
+
+bool ESP32Timer::attachInterrupt(float frequency, timerCallback callback) { return attachInterruptInterval((uint64_t)(1000000.0f / frequency), callback); } // ESP32Timer::attachInterrupt()
+
+/**
+ * @brief Stop calling the callback and join its thread.
+===================================================================================================*/
+void ESP32Timer::detachInterrupt()
+{
+   if(_thread == nullptr)
+   {
+      return;
+   } // if
+   if(!hostStopping) // After hostStopTasks() this may be a global destructor running after the registry is gone.
+   {
+      std::lock_guard<std::mutex> guard(hostLock);
+      hostTimerThreads.erase(std::find(hostTimerThreads.begin(), hostTimerThreads.end(), _thread));
+   } // if
+   _thread->stop = true;
+   if(_thread->thread.joinable())
+   {
+      _thread->thread.join();
+   } // if
+   delete _thread;
+   _thread = nullptr;
+} // ESP32Timer::detachInterrupt()
@@ -0,0 +1,179 @@
+/*************************************************************************************************************************************
+ * @file hostMain.cpp
+ * @author va3wam
+ * @brief Run the firmware's setup() and loop() on the host against simulated I2C devices.
+ * @details Bus0 carries a simulated MD25 and an LCD that accepts anything written to it. Bus1 carries a simulated MPU6050 whose
+ * data ready pin is pulsed each time it takes a sample, so the balance task sees the same sequence of events it does on the robot.
+ * The simulated devices move forward in real time between calls to loop(). WiFi sees no access points unless ZIPPY_HOST_SSID names
+ * one, so by default the firmware takes its offline boot path.
+ *
+ * Setting ZIPPY_HOST_PLANT puts the simulated robot of amSimPlant between the MD25 and the MPU6050 and hands the motors to the
+ * balance loop as soon as the boot self test move has finished. Until then the robot sits on its stand. The value of
+ * ZIPPY_HOST_PLANT is the lean in radians the robot is put down at.
+ *
+ * Usage: firmware [seconds]. The run time can also be set with ZIPPY_HOST_SECONDS. The default is 10 seconds.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Added ZIPPY_HOST_PLANT
+ *************************************************************************************************************************************/
+#include <Arduino.h> // Host Arduino core.
+#include <Wire.h> // Host I2C buses.
+#include <WiFi.h> // Host WiFi.
+#include <stdlib.h> // atof(), getenv().
+#include <amSimBus.h> // Simulated I2C bus.
+#include <amSimMD25.h> // Simulated MD25.
+#include <amSimMPU6050.h> // Simulated MPU6050.
+#include <amSimPlant.h> // Simulated robot.
+
+void setup(); // Firmware, in src/main.cpp.
+void loop(); // Firmware, in src/main.cpp.
+bool enableBalance(bool enable); // Firmware, in include/balance.h.
+
+#define HOST_LCD_ADDRESS 0x3F // LCD16x2 in i2c.h.
+#define HOST_IMU_INT_PIN 36 // imuInterruptPin (A4) in zippy_gpio_pins.h.
+#define HOST_DEFAULT_SECONDS 10.0 // Run time when none is given.
+#define HOST_BALANCE_RETRY_MS 500 // How often to ask the balance loop to take the motors.
+
+/*************************************************************************************************************************************
+ * @class Simulated device that acknowledges every transaction and reads back zeros.
+ *************************************************************************************************************************************/
+class hostSinkDevice : public amSimDevice
+{
+   public:
+      hostSinkDevice(uint8_t address) : _address(address) {} // Class constructor.
+      uint8_t getAddress() { return _address; } // 7 bit I2C address the device answers to.
+      void writeRegs(uint8_t reg, const uint8_t* data, uint8_t len) { (void)reg; (void)data; (void)len; } // Ignored.
+      void readRegs(uint8_t reg, uint8_t* dest, uint8_t len) { (void)reg; for(uint8_t i = 0; i < len; i++) dest[i] = 0; } // Zeros.
+   private:
+      uint8_t _address; // 7 bit I2C address.
+}; // class hostSinkDevice
+
+static amSimBus hostBus0; // Behind Wire.
+static amSimBus hostBus1; // Behind Wire1.
+static amSimMD25 hostMd25; // Motor controller on bus0.
+static hostSinkDevice hostLcd(HOST_LCD_ADDRESS); // LCD on bus0.
+static amSimMPU6050 hostImu; // IMU on bus1.
+static amSimPlant* hostPlant = nullptr; // Robot joining the MD25 to the IMU. Only with ZIPPY_HOST_PLANT.
+
+/**
+ * @brief Move the simulated devices forward to now.
+ * @details Bus locks are held while the devices change so that a task in the middle of a
+ * transaction never sees half an update. Each IMU sample raises and drops the data ready pin. With
+ * the plant both buses are locked together because it moves the MD25 and the IMU as one.
+ * @param lastUs micros() when the devices were last advanced. Updated.
+===================================================================================================*/
+static void hostAdvanceDevices(uint32_t &lastUs)
+{
+   uint32_t nowUs = micros();
+   uint32_t elapsedUs = nowUs - lastUs;
+   if(elapsedUs < 1000) // MD25 moves in whole milliseconds.
+   {
+      return;
+   } // if
+   uint32_t ms = elapsedUs / 1000;
+   lastUs += ms * 1000;
+   uint16_t samples;
+   if(hostPlant != nullptr)
+   {
+      Wire.lock();
+      Wire1.lock();
+      samples = hostPlant->advance(ms * 1000);
+      Wire1.unlock();
+      Wire.unlock();
+   } // if
+   else
+   {
+      Wire.lock();
+      hostMd25.advance(ms);
+      Wire.unlock();
+      Wire1.lock();
+      samples = hostImu.advance(ms * 1000);
+      Wire1.unlock();
+   } // else
+   for(uint16_t i = 0; i < samples; i++)
+   {
+      hostSetPin(HOST_IMU_INT_PIN, HIGH);
+      hostSetPin(HOST_IMU_INT_PIN, LOW);
+   } // for
+} // hostAdvanceDevices()
+
+/**
+ * @brief Host entry point. Runs setup() once and loop() until the run time is up.
+ * @return 0.
+===================================================================================================*/
+int main(int argc, char** argv)
+{
+   double seconds = HOST_DEFAULT_SECONDS;
+   const char* envSeconds = getenv("ZIPPY_HOST_SECONDS");
+   if(argc > 1)
+   {
+      seconds = atof(argv[1]);
+   } // if
+   else if(envSeconds != nullptr)
+   {
+      seconds = atof(envSeconds);
+   } // else if
+   const char* ssid = getenv("ZIPPY_HOST_SSID");
+   if(ssid != nullptr)
+   {
+      WiFi.hostSetAccessPoint(ssid, -50, IPAddress(192, 168, 2, 50));
+   } // if
+   hostBus0.attach(hostMd25);
+   hostBus0.attach(hostLcd);
+   hostBus1.attach(hostImu);
+   Wire.hostAttachBus(&hostBus0);
+   Wire1.hostAttachBus(&hostBus1);
+   const char* lean = getenv("ZIPPY_HOST_PLANT");
+   if(lean != nullptr)
+   {
+      static simPlantParams params;
+      static amSimPlant plant(hostMd25, hostImu, params);
+      plant.reset(atof(lean));
+      plant.hold(true); // On the stand until the balance loop has the motors.
+      hostPlant = &plant;
+   } // if
+   setup();
+   uint32_t lastUs = micros();
+   uint32_t endMs = millis() + (uint32_t)(seconds * 1000.0);
+   uint32_t nextBalanceMs = millis();
+   bool onStand = (hostPlant != nullptr);
+   while((int32_t)(millis() - endMs) < 0)
+   {
+      hostAdvanceDevices(lastUs);
+      loop();
+      if(onStand == true && (int32_t)(millis() - nextBalanceMs) >= 0)
+      {
+         nextBalanceMs += HOST_BALANCE_RETRY_MS;
+         if(enableBalance(true) == true) // Refused while the self test move is running.
+         {
+            Wire.lock();
+            Wire1.lock();
+            hostPlant->hold(false);
+            Wire1.unlock();
+            Wire.unlock();
+            onStand = false;
+         } // if
+      } // if
+   } // while
+   hostStopTasks();
+   printf("<hostMain> Ran %.1f s. Bus0 %u transactions, bus1 %u transactions, %u IMU samples.\n", seconds,
+          (unsigned)hostBus0.getTransactions(), (unsigned)hostBus1.getTransactions(), (unsigned)hostImu.getSamples());
+   if(hostPlant != nullptr)
+   {
+      printf("<hostMain> Robot %s. Pitch %.3f rad, travelled %.3f m.\n", hostPlant->hasFallen() ? "fell" : "stayed up",
+             hostPlant->getPitch(), hostPlant->getPosition());
+   } // if
+   return 0;
+} // main()
@@ -0,0 +1,574 @@
+/*************************************************************************************************************************************
+ * @file hostNetwork.cpp
+ * @author va3wam
+ * @brief Host stand-ins for WiFi, Preferences, ping, mDNS, OTA update, the web server and the MQTT client.
+ * @details None of these touch the real network. WiFi sees no access points until hostSetAccessPoint() is called, so by default
+ * the firmware boots exactly as it does on a robot out of range of every known network. Preferences live in memory for the life
+ * of the process, shared by every Preferences object as NVS is on the ESP32.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Asynchronous WiFi scans, joins by channel and BSSID, and scan and join times
+ *************************************************************************************************************************************/
+#include <WiFi.h> // Host WiFi.
+#include <Preferences.h> // Host NVS.
+#include <ESP32Ping.h> // Host ping.
+#include <ESPmDNS.h> // Host mDNS.
+#include <Update.h> // Host OTA update.
+#include <WebServer.h> // Host web server.
+#include <AsyncMqttClient.h> // Host MQTT client.
+#include <string.h> // memcpy(), strlen().
+#include <map> // Preferences store.
+#include <mutex> // Preferences lock.
+#include <string> // Preferences store.
+
+WiFiClass WiFi; // WiFi station.
+PingClass Ping; // ICMP echo.
+MDNSResponder MDNS; // mDNS responder.
+UpdateClass Update; // Firmware update writer.
+
+////// /// @brief WiFiClass //////
+
+/**
+ * @brief Make one access point visible to scanNetworks() and begin().
+ * @param ssid Access point name. Should be one of the names in known_networks.h.
+ * @param rssi Signal strength in dBm.
+ * @param localIP Address the access point hands out.
+===================================================================================================*/
+void WiFiClass::hostSetAccessPoint(const char* ssid, int32_t rssi, IPAddress localIP)
+{
+   _apSsid = ssid;
+   _apRssi = rssi;
+   _localIP = localIP;
+} // WiFiClass::hostSetAccessPoint()
+
+/**
+ * @brief Set how long scans and joins take. All 0, the default, makes them finish inside the call that starts them.
+ * @param scanMs Asynchronous scan of every channel.
+ * @param joinMs Join that names no channel, so searches every channel first.
+ * @param channelJoinMs Join that names the channel, whether it works or not.
+===================================================================================================*/
+void WiFiClass::hostSetTimes(uint32_t scanMs, uint32_t joinMs, uint32_t channelJoinMs)
+{
+   _scanMs = scanMs;
+   _joinMs = joinMs;
+   _channelJoinMs = channelJoinMs;
+} // WiFiClass::hostSetTimes()
+
+/**
+ * @brief Scan for the access point.
+ * @param async Return WIFI_SCAN_RUNNING at once and let scanComplete() give the answer.
+ * @return Access points found, or WIFI_SCAN_RUNNING.
+===================================================================================================*/
+int16_t WiFiClass::scanNetworks(bool async, bool showHidden, bool passive, uint32_t maxMsPerChan)
+{
+   (void)showHidden;
+   (void)passive;
+   (void)maxMsPerChan;
+   _scans++;
+   _scan = (_apSsid.length() > 0) ? 1 : 0;
+   if(!async)
+   {
+      return _scan;
+   } // if
+   _scanning = true;
+   _scanStartMs = millis();
+   return scanComplete();
+} // WiFiClass::scanNetworks()
+
+/**
+ * @brief Answer of the last scan, once it has taken as long as hostSetTimes() says.
+ * @return Access points found, WIFI_SCAN_RUNNING, or WIFI_SCAN_FAILED if there is no scan.
+===================================================================================================*/
+int16_t WiFiClass::scanComplete()
+{
+   if(_scanning && millis() - _scanStartMs >= _scanMs)
+   {
+      _scanning = false;
+      _event(SYSTEM_EVENT_SCAN_DONE);
+   } // if
+   return _scanning ? WIFI_SCAN_RUNNING : _scan;
+} // WiFiClass::scanComplete()
+
+String WiFiClass::SSID() { return isConnected() ? _apSsid : String(); } // WiFiClass::SSID()
+String WiFiClass::SSID(uint8_t index) { return (index == 0) ? _apSsid : String(); } // WiFiClass::SSID()
+int32_t WiFiClass::RSSI() { return isConnected() ? _apRssi : 0; } // WiFiClass::RSSI()
+int32_t WiFiClass::RSSI(uint8_t index) { return (index == 0) ? _apRssi : 0; } // WiFiClass::RSSI()
+wifi_auth_mode_t WiFiClass::encryptionType(uint8_t index) { return (index == 0) ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN; } // WiFiClass::encryptionType()
+bool WiFiClass::reconnect() { return begin(_apSsid.c_str()) == WL_CONNECTED; } // WiFiClass::reconnect()
+
+/**
+ * @brief Wait for the join under way to finish.
+ * @return Connection status.
+===================================================================================================*/
+uint8_t WiFiClass::waitForConnectResult()
+{
+   while(_joining)
+   {
+      delay(1);
+      status();
+   } // while
+   return _status;
+} // WiFiClass::waitForConnectResult()
+
+/**
+ * @brief Connection status. Finishes a join that has taken as long as hostSetTimes() says.
+===================================================================================================*/
+wl_status_t WiFiClass::status()
+{
+   if(_joining && millis() - _joinStartMs >= _joinTakesMs)
+   {
+      _finishJoin();
+   } // if
+   return _status;
+} // WiFiClass::status()
+
+/**
+ * @brief Start connecting to the access point. Finishes before returning unless hostSetTimes() gave joins a duration.
+ * @param ssid Access point name.
+ * @param passphrase Not checked.
+ * @param channel Channel to look on. 0 for every channel.
+ * @param bssid Hardware address of the access point to join. nullptr for any with the name.
+ * @param connect Not used.
+ * @return Connection status. WL_CONNECTED, WL_NO_SSID_AVAIL, or WL_DISCONNECTED while the join is under way.
+===================================================================================================*/
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase, int32_t channel, const uint8_t* bssid, bool connect)
+{
+   (void)passphrase;
+   (void)connect;
+   _joins++;
+   _lastJoinChannel = channel;
+   _event(SYSTEM_EVENT_STA_START);
+   _joinWillWork = _apSsid.length() > 0 && ssid != nullptr && _apSsid == ssid;
+   _joinWillWork = _joinWillWork && (channel == 0 || channel == _apChannel);
+   _joinWillWork = _joinWillWork && (bssid == nullptr || memcmp(bssid, _apBssid, sizeof(_apBssid)) == 0);
+   _joining = true;
+   _joinStartMs = millis();
+   _joinTakesMs = (channel == 0) ? _joinMs : _channelJoinMs;
+   _status = WL_DISCONNECTED;
+   return status();
+} // WiFiClass::begin()
+
+/**
+ * @brief End the join under way the way begin() decided.
+===================================================================================================*/
+void WiFiClass::_finishJoin()
+{
+   _joining = false;
+   if(!_joinWillWork)
+   {
+      _status = WL_NO_SSID_AVAIL;
+      _event(SYSTEM_EVENT_STA_DISCONNECTED);
+      return;
+   } // if
+   _status = WL_CONNECTED;
+   _event(SYSTEM_EVENT_STA_CONNECTED);
+   _event(SYSTEM_EVENT_STA_GOT_IP);
+} // WiFiClass::_finishJoin()
+
+/**
+ * @brief Drop the connection, or give up on the join under way.
+ * @param wifiOff Not used.
+ * @return true.
+===================================================================================================*/
+bool WiFiClass::disconnect(bool wifiOff)
+{
+   (void)wifiOff;
+   _joining = false;
+   if(_status == WL_CONNECTED)
+   {
+      _status = WL_DISCONNECTED;
+      _event(SYSTEM_EVENT_STA_DISCONNECTED);
+   } // if
+   return true;
+} // WiFiClass::disconnect()
+
+/**
+ * @brief Access point drops us, as when it reboots or we go out of range.
+===================================================================================================*/
+void WiFiClass::hostDrop()
+{
+   if(_status == WL_CONNECTED)
+   {
+      _status = WL_CONNECTION_LOST;
+      _event(SYSTEM_EVENT_STA_DISCONNECTED);
+   } // if
+} // WiFiClass::hostDrop()
+
+/**
+ * @brief Call the event handler, if there is one.
+===================================================================================================*/
+void WiFiClass::_event(WiFiEvent_t event)
+{
+   if(_callback != nullptr)
+   {
+      WiFiEventInfo_t info = {0};
+      _callback(event, info);
+   } // if
+} // WiFiClass::_event()
+
+////// /// @brief Preferences //////
+
+static std::map<std::string, std::string> hostNvs; // Every key of every namespace.
+static std::mutex hostNvsLock; // Guards hostNvs.
+
+/**
+ * @brief Open a namespace.
+ * @return true.
+===================================================================================================*/
+bool Preferences::begin(const char* name, bool readOnly)
+{
+   _name = name;
+   _readOnly = readOnly;
+   _open = true;
+   return true;
+} // Preferences::begin()
+
+String Preferences::_key(const char* key) { return _name + "/" + key; } // Preferences::_key()
+
+/**
+ * @brief Remove every key in the namespace.
+ * @return false if the namespace is not open for writing.
+===================================================================================================*/
+bool Preferences::clear()
+{
+   if(!_open || _readOnly)
+   {
+      return false;
+   } // if
+   std::lock_guard<std::mutex> guard(hostNvsLock);
+   std::string prefix = (_name + "/").c_str();
+   for(auto it = hostNvs.begin(); it != hostNvs.end();)
+   {
+      it = (it->first.compare(0, prefix.size(), prefix) == 0) ? hostNvs.erase(it) : std::next(it);
+   } // for
+   return true;
+} // Preferences::clear()
+
+/**
+ * @brief Remove one key.
+ * @return false if the namespace is not open for writing or the key did not exist.
+===================================================================================================*/
+bool Preferences::remove(const char* key)
+{
+   if(!_open || _readOnly)
+   {
+      return false;
+   } // if
+   std::lock_guard<std::mutex> guard(hostNvsLock);
+   return hostNvs.erase(_key(key).c_str()) > 0;
+} // Preferences::remove()
+
+/**
+ * @brief True if the key exists in the namespace.
+===================================================================================================*/
+bool Preferences::isKey(const char* key)
+{
+   std::lock_guard<std::mutex> guard(hostNvsLock);
+   return _open && hostNvs.count(_key(key).c_str()) > 0;
+} // Preferences::isKey()
+
+/**
+ * @brief Store a blob.
+ * @return Bytes stored. 0 if the namespace is not open for writing.
+===================================================================================================*/
+size_t Preferences::putBytes(const char* key, const void* value, size_t len)
+{
+   if(!_open || _readOnly)
+   {
+      return 0;
+   } // if
+   std::lock_guard<std::mutex> guard(hostNvsLock);
+   hostNvs[_key(key).c_str()] = std::string((const char*)value, len);
+   return len;
+} // Preferences::putBytes()
+
+/**
+ * @brief Size of a blob.
+ * @return Bytes stored under the key. 0 if there is no such key.
+===================================================================================================*/
+size_t Preferences::getBytesLength(const char* key)
+{
+   std::lock_guard<std::mutex> guard(hostNvsLock);
+   auto it = hostNvs.find(_key(key).c_str());
+   return (!_open || it == hostNvs.end()) ? 0 : it->second.size();
+} // Preferences::getBytesLength()
+
+/**
+ * @brief Read a blob.
+ * @return Bytes copied. 0 if there is no such key or it does not fit in maxLen.
+===================================================================================================*/
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen)
+{
+   std::lock_guard<std::mutex> guard(hostNvsLock);
+   auto it = hostNvs.find(_key(key).c_str());
+   if(!_open || it == hostNvs.end() || it->second.size() > maxLen)
+   {
+      return 0;
+   } // if
+   memcpy(buf, it->second.data(), it->second.size());
+   return it->second.size();
+} // Preferences::getBytes()
+
+size_t Preferences::putString(const char* key, const char* value) { return putBytes(key, value, strlen(value)); } // Preferences::putString()
+size_t Preferences::putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); } // Preferences::putUInt()
+
+/**
+ * @brief Read a string.
+ * @return The stored string, or defaultValue if there is no such key.
+===================================================================================================*/
+String Preferences::getString(const char* key, const String defaultValue)
+{
+   std::lock_guard<std::mutex> guard(hostNvsLock);
+   auto it = hostNvs.find(_key(key).c_str());
+   return (!_open || it == hostNvs.end()) ? defaultValue : String(it->second.c_str());
+} // Preferences::getString()
+
+/**
+ * @brief Read a number.
+ * @return The stored number, or defaultValue if there is no such key.
+===================================================================================================*/
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue)
+{
+   uint32_t value;
+   return (getBytes(key, &value, sizeof(value)) == sizeof(value)) ? value : defaultValue;
+} // Preferences::getUInt()
+
+////// /// @brief PingClass //////
+
+/**
+ * @brief Make an address answer pings.
+ * @param address Address that should answer.
+ * @param rttMs Round trip time to report.
+===================================================================================================*/
+void PingClass::hostSetReachable(IPAddress address, float rttMs)
+{
+   if(_numReachable < HOST_PING_MAX_HOSTS)
+   {
+      _reachable[_numReachable] = address;
+      _rtt[_numReachable] = rttMs;
+      _numReachable++;
+   } // if
+} // PingClass::hostSetReachable()
+
+/**
+ * @brief Ping an address.
+ * @details Answers at once. Real pings take about a second each when nothing answers, which is
+ * not worth waiting for on the host.
+ * @param dest Address to ping.
+ * @param count Not used.
+ * @return true if dest was made reachable with hostSetReachable() and WiFi is connected.
+===================================================================================================*/
+bool PingClass::ping(IPAddress dest, byte count)
+{
+   (void)count;
+   if(!WiFi.isConnected())
+   {
+      return false;
+   } // if
+   for(uint8_t i = 0; i < _numReachable; i++)
+   {
+      if((uint32_t)_reachable[i] == (uint32_t)dest)
+      {
+         _averageTime = _rtt[i];
+         return true;
+      } // if
+   } // for
+   return false;
+} // PingClass::ping()
+
+////// /// @brief WebServer //////
+
+/**
+ * @brief Handle requests for a URI.
+===================================================================================================*/
+void WebServer::on(const String &uri, HTTPMethod method, THandlerFunction handler)
+{
+   if(_numHandlers < HOST_WEB_MAX_HANDLERS)
+   {
+      _uri[_numHandlers] = uri;
+      _method[_numHandlers] = method;
+      _handler[_numHandlers] = handler;
+      _numHandlers++;
+   } // if
+} // WebServer::on()
+
+/**
+ * @brief Handle requests for a URI. Uploads are not simulated so uploadHandler is never called.
+===================================================================================================*/
+void WebServer::on(const String &uri, HTTPMethod method, THandlerFunction handler, THandlerFunction uploadHandler)
+{
+   (void)uploadHandler;
+   on(uri, method, handler);
+} // WebServer::on()
+
+/**
+ * @brief Record the response to the request being handled.
+===================================================================================================*/
+void WebServer::send(int code, const char* contentType, const String &content)
+{
+   (void)contentType;
+   _lastCode = code;
+   _lastBody = content;
+} // WebServer::send()
+
+String WebServer::arg(const String &name) { return (name == _argName) ? _argValue : String(); } // WebServer::arg()
+bool WebServer::hasArg(const String &name) { return _argName.length() > 0 && name == _argName; } // WebServer::hasArg()
+
+/**
+ * @brief Run the handler for a request as if a browser had sent it.
+ * @param method Request method.
+ * @param uri Request URI.
+ * @param argName Optional request argument.
+ * @param argValue Its value.
+ * @return HTTP code sent by the handler. 404 if no handler matched.
+===================================================================================================*/
+int WebServer::hostRequest(HTTPMethod method, const char* uri, const char* argName, const char* argValue)
+{
+   _argName = (argName != nullptr) ? argName : "";
+   _argValue = (argValue != nullptr) ? argValue : "";
+   _lastCode = 404;
+   _lastBody = "";
+   for(uint8_t i = 0; i < _numHandlers; i++)
+   {
+      if(_running && _uri[i] == uri && (_method[i] == HTTP_ANY || _method[i] == method))
+      {
+         _handler[i]();
+         break;
+      } // if
+   } // for
+   return _lastCode;
+} // WebServer::hostRequest()
+
+////// /// @brief AsyncMqttClient //////
+
+/**
+ * @brief Broker accepts a pending connect().
+===================================================================================================*/
+void AsyncMqttClient::hostAccept()
+{
+   if(!_connecting)
+   {
+      return;
+   } // if
+   _connecting = false;
+   _connected = true;
+   if(_onConnect)
+   {
+      _onConnect(false);
+   } // if
+} // AsyncMqttClient::hostAccept()
+
+/**
+ * @brief Broker goes away.
+===================================================================================================*/
+void AsyncMqttClient::hostDrop(AsyncMqttClientDisconnectReason reason)
+{
+   bool wasUp = _connected || _connecting;
+   _connecting = false;
+   _connected = false;
+   if(wasUp && _onDisconnect)
+   {
+      _onDisconnect(reason);
+   } // if
+} // AsyncMqttClient::hostDrop()
+
+void AsyncMqttClient::disconnect(bool force) { (void)force; hostDrop(AsyncMqttClientDisconnectReason::TCP_DISCONNECTED); } // AsyncMqttClient::disconnect()
+
+/**
+ * @brief Broker sends a message on a topic.
+===================================================================================================*/
+void AsyncMqttClient::hostDeliver(const char* topic, const char* payload)
+{
+   if(!_connected || !_onMessage)
+   {
+      return;
+   } // if
+   String t(topic);
+   String p(payload);
+   AsyncMqttClientMessageProperties properties = {0, false, false};
+   _onMessage((char*)t.c_str(), (char*)p.c_str(), properties, p.length(), 0, p.length());
+} // AsyncMqttClient::hostDeliver()
+
+/**
+ * @brief Subscribe to a topic.
+ * @return Packet id, or 0 if not connected.
+===================================================================================================*/
+uint16_t AsyncMqttClient::subscribe(const char* topic, uint8_t qos)
+{
+   (void)topic;
+   if(!_connected)
+   {
+      return 0;
+   } // if
+   uint16_t id = _nextPacketId++;
+   if(_onSubscribe)
+   {
+      _onSubscribe(id, qos);
+   } // if
+   return id;
+} // AsyncMqttClient::subscribe()
+
+/**
+ * @brief Unsubscribe from a topic.
+ * @return Packet id, or 0 if not connected.
+===================================================================================================*/
+uint16_t AsyncMqttClient::unsubscribe(const char* topic)
+{
+   (void)topic;
+   if(!_connected)
+   {
+      return 0;
+   } // if
+   uint16_t id = _nextPacketId++;
+   if(_onUnsubscribe)
+   {
+      _onUnsubscribe(id);
+   } // if
+   return id;
+} // AsyncMqttClient::unsubscribe()
+
+/**
+ * @brief Publish a message. Counted and kept for inspection, then dropped.
+ * @param length Payload length. 0 means payload is a C string.
+ * @return Packet id for QoS 1 and 2, 1 for QoS 0, or 0 if not connected.
+===================================================================================================*/
+uint16_t AsyncMqttClient::publish(const char* topic, uint8_t qos, bool retain, const char* payload, size_t length, bool dup, uint16_t messageId)
+{
+   (void)retain;
+   (void)dup;
+   (void)messageId;
+   if(!_connected)
+   {
+      return 0;
+   } // if
+   if(payload != nullptr && length == 0)
+   {
+      length = strlen(payload);
+   } // if
+   _publishCount++;
+   _publishBytes += strlen(topic) + length;
+   _lastTopic = topic;
+   _lastPayload = (payload != nullptr) ? String(std::string(payload, length).c_str()) : String();
+   if(qos == 0)
+   {
+      return 1;
+   } // if
+   uint16_t id = _nextPacketId++;
+   if(_onPublish)
+   {
+      _onPublish(id);
+   } // if
+   return id;
+} // AsyncMqttClient::publish()
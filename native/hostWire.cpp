@@ -0,0 +1,151 @@
+/*************************************************************************************************************************************
+ * @file hostWire.cpp
+ * @author va3wam
+ * @brief Host stand-in for the ESP32 TwoWire I2C master.
+ * @details Turns the byte stream of a TwoWire transaction back into the register level calls of an amI2cBus so that simulated
+ * devices written for the host tests answer the firmware unchanged. A write with no data is a probe, a write of one byte only
+ * sets the register pointer, and a longer write is a register write starting at its first byte. requestFrom() reads from the last
+ * register pointer set on that address.
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <Wire.h> // Header file for linking.
+#include <string.h> // memcpy().
+
+TwoWire Wire(0); // I2C bus 0.
+TwoWire Wire1(1); // I2C bus 1.
+
+/**
+ * @brief Start the bus.
+ * @param sda Not used.
+ * @param scl Not used.
+ * @param frequency Bus speed. 0 keeps the current speed.
+ * @return true.
+===================================================================================================*/
+bool TwoWire::begin(int sda, int scl, uint32_t frequency)
+{
+   (void)sda;
+   (void)scl;
+   if(frequency != 0)
+   {
+      _frequency = frequency;
+   } // if
+   return true;
+} // TwoWire::begin()
+
+/**
+ * @brief Start collecting a write to a device.
+ * @param address 7 bit I2C address of the device.
+===================================================================================================*/
+void TwoWire::beginTransmission(uint8_t address)
+{
+   std::lock_guard<std::recursive_mutex> guard(_lock);
+   _txAddress = address;
+   _txLength = 0;
+} // TwoWire::beginTransmission()
+
+/**
+ * @brief Add one byte to the write being collected.
+ * @return 1, or 0 if the transmit buffer is full.
+===================================================================================================*/
+size_t TwoWire::write(uint8_t data)
+{
+   std::lock_guard<std::recursive_mutex> guard(_lock);
+   if(_txLength >= I2C_BUFFER_LENGTH)
+   {
+      return 0;
+   } // if
+   _txBuffer[_txLength++] = data;
+   return 1;
+} // TwoWire::write()
+
+/**
+ * @brief Add bytes to the write being collected.
+ * @return Number of bytes that fitted in the transmit buffer.
+===================================================================================================*/
+size_t TwoWire::write(const uint8_t* data, size_t quantity)
+{
+   std::lock_guard<std::recursive_mutex> guard(_lock);
+   size_t n = 0;
+   while(n < quantity && write(data[n]) == 1)
+   {
+      n++;
+   } // while
+   return n;
+} // TwoWire::write()
+
+/**
+ * @brief Send the collected write to the simulated bus.
+ * @param sendStop Not used. Every transaction on the host is complete.
+ * @return I2C_OK or one of the I2C_ERR_ codes.
+===================================================================================================*/
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+   (void)sendStop;
+   std::lock_guard<std::recursive_mutex> guard(_lock);
+   if(_bus == nullptr)
+   {
+      return I2C_ERR_NACK_ADDR; // Nothing on the bus.
+   } // if
+   uint8_t status;
+   if(_txLength == 0)
+   {
+      status = _bus->probe(_txAddress);
+   } // if
+   else if(_txLength == 1)
+   {
+      status = _bus->probe(_txAddress);
+      if(status == I2C_OK)
+      {
+         _regPointerValid = true;
+         _regPointerAddress = _txAddress;
+         _regPointer = _txBuffer[0];
+      } // if
+   } // else if
+   else
+   {
+      status = _bus->writeRegs(_txAddress, _txBuffer[0], &_txBuffer[1], (uint8_t)(_txLength - 1));
+      _regPointerValid = false; // Device has moved its pointer past the data.
+   } // else
+   _txLength = 0;
+   return status;
+} // TwoWire::endTransmission()
+
+/**
+ * @brief Read from the register set by the last one byte write to this address.
+ * @param address 7 bit I2C address of the device.
+ * @param quantity Number of bytes to read.
+ * @param sendStop Not used.
+ * @return Number of bytes received. 0 if the device did not answer.
+===================================================================================================*/
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, bool sendStop)
+{
+   (void)sendStop;
+   std::lock_guard<std::recursive_mutex> guard(_lock);
+   _rxIndex = 0;
+   _rxLength = 0;
+   if(_bus == nullptr || quantity > I2C_BUFFER_LENGTH)
+   {
+      return 0;
+   } // if
+   uint8_t reg = (_regPointerValid && _regPointerAddress == address) ? _regPointer : 0;
+   if(_bus->readRegs(address, reg, _rxBuffer, quantity) != I2C_OK)
+   {
+      return 0;
+   } // if
+   _regPointerValid = false; // Device has moved its pointer past the data.
+   _rxLength = quantity;
+   return quantity;
+} // TwoWire::requestFrom()
@@ -0,0 +1,81 @@
+/*************************************************************************************************************************************
+ * @file dlogDecode.cpp
+ * @author va3wam
+ * @brief Turn a binary deferred log capture back into text.
+ * @details Reads frames written by the drain task in include/deferredLog.h after setDeferredLogBinary(true), from a file or from
+ * stdin, and prints one line per record. Text and other bytes between frames, such as boot messages, are skipped.
+ *
+ * Build: g++ -std=gnu++17 -I lib/amRing -I lib/amDeferredLog native/tools/dlogDecode.cpp lib/amDeferredLog/amDeferredLog.cpp \
+ *   lib/amDeferredLog/amDeferredLogDecoder.cpp -o dlogDecode
+ * Usage: dlogDecode [capture file] [--no-time]
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ *************************************************************************************************************************************/
+#include <stdio.h> // fopen(), fread(), puts().
+#include <string.h> // strcmp().
+#include <amDeferredLog.h> // Deferred log frames and decoder.
+
+/**
+ * @brief Print one decoded line.
+ * @param line Text of the line.
+ * @param context Not used.
+===================================================================================================*/
+static void printLine(const char* line, void*)
+{
+   puts(line);
+} // printLine()
+
+/**
+ * @brief Decode a capture file, or stdin, to stdout.
+ * @return 0 on success, 1 if the file could not be opened.
+===================================================================================================*/
+int main(int argc, char** argv)
+{
+   const char* path = NULL;
+   bool showTime = true;
+   for(int a = 1; a < argc; a++)
+   {
+      if(strcmp(argv[a], "--no-time") == 0)
+      {
+         showTime = false;
+      } // if
+      else
+      {
+         path = argv[a];
+      } // else
+   } // for
+   FILE* in = (path == NULL) ? stdin : fopen(path, "rb");
+   if(in == NULL)
+   {
+      fprintf(stderr, "dlogDecode: cannot open %s\n", path);
+      return 1;
+   } // if
+   static amDeferredLogDecoder d(printLine, NULL, showTime); // Static. The format table is too big for the stack.
+   uint8_t buffer[4096];
+   size_t n;
+   while((n = fread(buffer, 1, sizeof(buffer), in)) > 0)
+   {
+      d.feed(buffer, n);
+   } // while
+   if(d.getBadFrames() > 0)
+   {
+      fprintf(stderr, "dlogDecode: %lu frames decoded, %lu could not be read.\n", (unsigned long)d.getFrames(), (unsigned long)d.getBadFrames());
+   } // if
+   if(in != stdin)
+   {
+      fclose(in);
+   } // if
+   return 0;
+} // main()
@@ -0,0 +1,175 @@
+/*************************************************************************************************************************************
+ * @file tlmDecode.cpp
+ * @author va3wam
+ * @brief Turn recorded telemetry batches back into comma separated values.
+ * @details Reads one MQTT message per line, topic then payload in hex, as written by mosquitto_sub -v -F '%t %x', from a file or
+ * from stdin. Prints one line per sample: topic, time in ms since boot, then the sample's fields in their natural units. A column
+ * header line is printed whenever the schema changes from the line before. Messages that are not batch frames, such as the text on
+ * the events topic, and samples of a schema this build does not know are skipped and counted. Batches missing from a topic's
+ * sequence are reported on stderr.
+ *
+ * Record: mosquitto_sub -h <broker> -v -F '%t %x' -t 'agingApprentice/+/state' -t 'agingApprentice/+/health' \
+ *   -t 'agingApprentice/+/i2c' > capture.txt
+ * Build: g++ -std=gnu++17 -I lib/amTelemetry native/tools/tlmDecode.cpp lib/amTelemetry/amTelemetry.cpp \
+ *   lib/amTelemetry/amTelemetrySchema.cpp -o tlmDecode
+ * Usage: tlmDecode [capture file]
+ * @copyright Copyright (c) 2021 va3wam
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * YYYY-MM-DD Dev    Description
+ * ---------- ------ -----------------------------------------------------------------------------------------------------------------
+ * 2026-10-17 va3wam Program created
+ * 2026-10-17 va3wam Room for I2C samples
+ *************************************************************************************************************************************/
+#include <stdio.h> // fopen(), fgets(), printf().
+#include <string.h> // strchr(), strcmp(), strncpy().
+#include <amTelemetry.h> // Batch frames.
+#include <amTelemetrySchema.h> // Sample layouts.
+
+#define TOPICS 16 // Topics whose sequence numbers are followed.
+#define LINE_LEN (TLM_TOPIC_LEN + 2 * 1024 + 4) // Topic, space, hex payload, new line and 0.
+
+/*! Sequence number follower for one topic. */
+struct topicSequence
+{
+   char topic[TLM_TOPIC_LEN]; ///< Full topic.
+   uint16_t next; ///< Sequence number expected next.
+   uint32_t batches; ///< Batches seen.
+   uint32_t missing; ///< Batches missing from the sequence.
+}; // struct
+
+static topicSequence topics[TOPICS]; // Topics seen so far.
+static uint8_t topicCount = 0; // Entries in topics.
+
+/**
+ * @brief Find a topic's sequence follower, adding it the first time.
+ * @return nullptr if the table is full.
+===================================================================================================*/
+static topicSequence* findTopic(const char* topic)
+{
+   for(uint8_t i = 0; i < topicCount; i++)
+   {
+      if(strcmp(topics[i].topic, topic) == 0)
+      {
+         return &topics[i];
+      } // if
+   } // for
+   if(topicCount == TOPICS)
+   {
+      return nullptr;
+   } // if
+   topicSequence* t = &topics[topicCount++];
+   strncpy(t->topic, topic, sizeof(t->topic) - 1);
+   t->topic[sizeof(t->topic) - 1] = 0;
+   t->batches = 0;
+   t->missing = 0;
+   return t;
+} // findTopic()
+
+/**
+ * @brief Value of one hex digit.
+ * @return -1 if c is not a hex digit.
+===================================================================================================*/
+static int hexDigit(char c)
+{
+   if(c >= '0' && c <= '9') return c - '0';
+   if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+   if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+   return -1;
+} // hexDigit()
+
+/**
+ * @brief Turn hex text into bytes. Stops at the first character that is not a hex digit.
+ * @return Bytes written.
+===================================================================================================*/
+static size_t fromHex(const char* hex, uint8_t* out, size_t size)
+{
+   size_t n = 0;
+   while(n < size && hexDigit(hex[0]) >= 0 && hexDigit(hex[1]) >= 0)
+   {
+      out[n++] = (uint8_t)((hexDigit(hex[0]) << 4) | hexDigit(hex[1]));
+      hex += 2;
+   } // while
+   return n;
+} // fromHex()
+
+/**
+ * @brief Decode a capture file, or stdin, to stdout.
+ * @return 0 on success, 1 if the file could not be opened.
+===================================================================================================*/
+int main(int argc, char** argv)
+{
+   FILE* in = (argc < 2) ? stdin : fopen(argv[1], "r");
+   if(in == NULL)
+   {
+      fprintf(stderr, "tlmDecode: cannot open %s\n", argv[1]);
+      return 1;
+   } // if
+   static char line[LINE_LEN]; // One message.
+   uint8_t frame[1024]; // Its payload.
+   char text[384]; // One sample as text. I2C samples are the longest.
+   uint8_t lastSchema = 0; // Schema of the last line printed.
+   unsigned long skippedMessages = 0;
+   unsigned long skippedSamples = 0;
+   while(fgets(line, sizeof(line), in) != NULL)
+   {
+      char* space = strchr(line, ' ');
+      tlmBatchHeader header;
+      size_t len = (space == NULL) ? 0 : fromHex(space + 1, frame, sizeof(frame));
+      if(space == NULL || tlmReadHeader(frame, len, &header) == false)
+      {
+         skippedMessages++;
+         continue;
+      } // if
+      *space = 0; // Line now holds just the topic.
+      topicSequence* t = findTopic(line);
+      if(t != nullptr)
+      {
+         if(t->batches > 0 && header.sequence != t->next)
+         {
+            uint16_t gap = (uint16_t)(header.sequence - t->next);
+            t->missing += gap;
+            fprintf(stderr, "tlmDecode: %s missing %u batches before sequence %u.\n", line, (unsigned)gap, (unsigned)header.sequence);
+         } // if
+         t->next = (uint16_t)(header.sequence + 1);
+         t->batches++;
+      } // if
+      size_t offset = TLM_BATCH_HEADER;
+      tlmSample sample;
+      while(tlmNextSample(frame, len, &offset, &sample) == true)
+      {
+         if(sample.len == 0 || tlmFormatSample(sample.data, sample.len, text, sizeof(text)) == 0)
+         {
+            skippedSamples++;
+            continue;
+         } // if
+         if(sample.data[0] != lastSchema)
+         {
+            lastSchema = sample.data[0];
+            printf("topic,time_ms,%s\n", tlmFormatHeader(lastSchema));
+         } // if
+         printf("%s,%lu,%s\n", line, (unsigned long)(header.startMs + sample.offsetMs), text);
+      } // while
+   } // while
+   for(uint8_t i = 0; i < topicCount; i++)
+   {
+      fprintf(stderr, "tlmDecode: %s %lu batches, %lu missing.\n", topics[i].topic, (unsigned long)topics[i].batches, (unsigned long)topics[i].missing);
+   } // for
+   if(skippedMessages > 0 || skippedSamples > 0)
+   {
+      fprintf(stderr, "tlmDecode: skipped %lu messages that were not batches and %lu samples of unknown schema.\n", skippedMessages, skippedSamples);
+   } // if
+   if(in != stdin)
+   {
+      fclose(in);
+   } // if
+   return 0;
+} // main()
@@ -46,15 +46,15 @@ unsigned long timer; // Milli count for next action.
  * =================================================================================*/
 void checkBoot()
 {
-   Log.traceln("<checkBoot> Checking boot status flags."); 
-   if(networkConnected == true && mqttBrokerConnected == true && lcdConnected == true && mobilityStatus == true)
+   LOG_TRACELN(LOG_MOD_MAIN, "<checkBoot> Checking boot status flags."); 
+   if(networkConnected == true && mqttBrokerConnected == true && lcdDevice.isPresent() == true && mobilityStatus == true)
    {
-      Log.verboseln("<checkBoot> Bootup was normal. Set RGB LED to normal colour."); 
+      LOG_VERBOSELN(LOG_MOD_MAIN, "<checkBoot> Bootup was normal. Set RGB LED to normal colour."); 
       setStdRgbColour(BLUE); // Indicates that bootup was normal.
    } // if
    else
    {
-      Log.verboseln("<checkBoot> Bootup had an issue. Set RGB LED to warning colour."); 
+      LOG_VERBOSELN(LOG_MOD_MAIN, "<checkBoot> Bootup had an issue. Set RGB LED to warning colour."); 
       setStdRgbColour(YELLOW); // Indicates that there was a bootup issue.
    } // else
 } // checkBoot
@@ -64,70 +64,28 @@ void checkBoot()
  * ==========================================================================*/
 void setup() 
 {
+   uint32_t setupUs = micros(); // Start of setup() for the boot profile.
    setupSerial(); // Set serial baud rate. 
-   Log.begin(LOG_LEVEL_VERBOSE, &Serial, true);
-   Log.traceln("<setup> Start of setup.");  
-   Log.verboseln("<setup> Initialize I2C buses."); 
-   Wire.begin(I2C_BUS0_SDA, I2C_BUS0_SCL, I2C_BUS0_SPEED); // Init I2C bus0.
-   Wire1.begin(I2C_BUS1_SDA, I2C_BUS1_SCL, I2C_BUS1_SPEED); // Init I2C bus1.
-   Log.verboseln("<setup> Initialize status RGB LED."); 
+   Log.begin(LOG_LEVEL_MIN, &Serial, true); // Nothing more detailed than LOG_LEVEL_MIN is compiled in.
+   startDeferredLog(&Serial); // Drain task for LOG_DEFERRED builds. Does nothing otherwise.
+   LOG_TRACELN(LOG_MOD_MAIN, "<setup> Start of setup.");  
+   LOG_VERBOSELN(LOG_MOD_MAIN, "<setup> Initialize I2C buses."); 
+   wire0Bus.begin(I2C_BUS0_SDA, I2C_BUS0_SCL, I2C_BUS0_SPEED); // Init I2C bus0, freeing it first if a device holds SDA.
+   wire1Bus.begin(I2C_BUS1_SDA, I2C_BUS1_SCL, I2C_BUS1_SPEED); // Init I2C bus1, freeing it first if a device holds SDA.
+   initI2c(); // Expected devices and a worker task per bus.
+   LOG_VERBOSELN(LOG_MOD_MAIN, "<setup> Initialize status RGB LED."); 
    setupStatusLed(); // Configure the status LED on the reset button.
    setStdRgbColour(WHITE); // Indicates that boot up is in progress.
-   Log.verboseln("<setup> Initialize limit switches."); 
+   LOG_VERBOSELN(LOG_MOD_MAIN, "<setup> Initialize limit switches."); 
    setupLimitSwitches(); // Configure limit switches.
-   Log.verboseln("<setup> Set up wifi connection."); 
-   network.connect(); // Start WiFi connection.
-   if(network.areWeConnected() == true) // If we are on the WiFi network.
-   {
-      networkConnected = true;
-      Log.noticeln("<setup> Connection to network successfully estabished.");
-      Log.verboseln("<setup> Initialize local web services."); 
-      startWebServer(); // Start up web server.
-      Log.verboseln("<setup> Initialize MQTT broker connection."); 
-      bool tmp = connectToMqttBroker(network); // Connect to MQTT broker.
-      if(tmp == true) // If we found an MQTT broker.
-      {
-         mqttBrokerConnected = true;
-         Log.noticeln("<setup> Connection to MQTT broker successfully established.");
-      } // if
-      else // If we did not find a valid MQTT broker.
-      {
-         mqttBrokerConnected = false;
-         Log.errorln("<setup> Connected to MQTT broker failed.");
-      } // else
-   } // if
-   else // If we are NOT on the WiFi network.
-   {
-      networkConnected = false;
-      Log.errorln("<setup> Not connencted to the network. No MQTT or web interface.");
-   } // else
-   Log.verboseln("<setup> Look for I2C devices."); 
-   scanBus0(); // Scan bus0 and show connected devices.
-   scanBus1(); // Scan bus1 and show connected devices.
-   if(lcdConnected == true) // If an LCD was found on the I2C bus.
-   {
-      Log.traceln("<setup> Initialize LCD.");
-      initLcd();
-   } // if
-   else // If an OLED was NOT found on the I2C bus.
-   {
-      Log.warningln("<setup> LED not connencted to I2C bus. No LED messages to be issued.");
-   } //else
-   if(motorControllerConnected == true) // If servo drivers found on I2C bus.
-   {
-      Log.traceln("<setup> Initialize DC motor driver.");
-      mobilityStatus = initMobility(); // Initialize drive motors. 
-   } // if
-   else // If servo drivers found on I2C bus.
-   {
-      Log.errorln("<setup> Motor driver not connencted to I2C bus. No motion is possible.");
-      mobilityStatus = false;
-   } //else
-   Log.verboseln("<setup> Display robot configuration in console trace."); 
+   boot.record("early", setupUs, micros()); // Everything above, before the phases start.
+   LOG_VERBOSELN(LOG_MOD_MAIN, "<setup> Run start up phases: WiFi, I2C devices, motors, IMU, balance loop and LCD."); 
+   runBootSequence(); // Independent phases run side by side. Returns when all have ended.
+   LOG_VERBOSELN(LOG_MOD_MAIN, "<setup> Display robot configuration in console trace."); 
    showCfgDetails(); // Show all configuration details in one summary.
-   Log.verboseln("<setup> Review status flags to see how boot sequence went."); 
+   LOG_VERBOSELN(LOG_MOD_MAIN, "<setup> Review status flags to see how boot sequence went."); 
    checkBoot();
-   Log.traceln("<setup> End of setup."); 
+   LOG_TRACELN(LOG_MOD_MAIN, "<setup> End of setup."); 
    timer = millis(); // Timer for motor driver signalling.
 } // setup()
 
@@ -136,7 +94,12 @@ void setup()
  * ==========================================================================*/
 void loop() 
 {
+   checkWifiLink(); // Bring WiFi up and start the network services once it is.
    checkLimitSwitches(); // Make update to status LED on reset button.
-//   monitorWebServer(); // Handle any pending web client requests. 
-//   checkMqtt(); // Check the MQTT message queue for incoming commands.
+   checkMobility(); // Advance any drive train move in progress.
+   checkMqttLink(); // Reconnect to the broker when it goes away.
+   checkTelemetry(); // Send telemetry batches that are due.
+   checkBootReport(); // Send the boot profile once the broker is there.
+   monitorWebServer(); // Handle any pending web client requests. 
+   checkMqtt(); // Run any commands that came in from the broker.
 } // loop()  
\ No newline at end of file
@@ -0,0 +1,258 @@
+// Host side tests for the balance control step against a simulated inverted pendulum, and for the loop timing statistics.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <math.h>
+#include <amBalance.h>
+#include <amLoopStats.h>
+
+// Simple cart and pendulum model of the robot. The motor command sets wheel acceleration.
+const float GRAVITY = 9.81f; // m/s^2.
+const float COM_HEIGHT = 0.2f; // Axle to centre of mass in metres.
+const float ACCEL_PER_UNIT = 0.1f; // Wheel acceleration in m/s^2 per unit of motor command.
+
+struct plant
+{
+    float pitch; // Radians, positive leans forward.
+    float pitchRate; // Radians/second.
+    float wheelSpeed; // Metres/second.
+    float position; // Metres travelled.
+};
+
+void plantStep(plant &p, float command, float dt)
+{
+    float accel = command * ACCEL_PER_UNIT;
+    float pitchAccel = (GRAVITY * sinf(p.pitch) - accel * cosf(p.pitch)) / COM_HEIGHT;
+    p.pitchRate += pitchAccel * dt;
+    p.pitch += p.pitchRate * dt;
+    p.wheelSpeed += accel * dt;
+    p.position += p.wheelSpeed * dt;
+}
+
+// Run the control step in closed loop for seconds at rateHz. Returns true if the robot never fell.
+bool runClosedLoop(plant &p, const balanceGains &gains, float rateHz, float seconds)
+{
+    float dt = 1.0f / rateHz;
+    int cycles = (int)(seconds * rateHz);
+    for(int i = 0; i < cycles; i++)
+    {
+        balanceInput input = {p.pitch, p.pitchRate, p.wheelSpeed};
+        balanceOutput output = balanceStep(gains, input);
+        if(output.fallen)
+        {
+            return false;
+        }
+        plantStep(p, output.command, dt);
+    }
+    return true;
+}
+
+// Same again with the cascaded PID controller at BALANCE_CASCADE_HZ.
+bool runCascade(plant &p, float targetSpeed, float seconds, float comOffset = 0.0f)
+{
+    balanceGains gains = BALANCE_DEFAULT_GAINS;
+    balanceCascade pid;
+    pid.reset(p.wheelSpeed, p.pitch);
+    float dt = 1.0f / BALANCE_CASCADE_HZ;
+    int cycles = (int)(seconds * BALANCE_CASCADE_HZ);
+    for(int i = 0; i < cycles; i++)
+    {
+        balanceInput input = {p.pitch, p.pitchRate, p.wheelSpeed};
+        balanceOutput output = balanceCascadeStep(pid, gains, input, targetSpeed);
+        if(output.fallen)
+        {
+            return false;
+        }
+        p.pitch += comOffset; // Centre of mass not over the axle.
+        plantStep(p, output.command, dt);
+        p.pitch -= comOffset;
+    }
+    return true;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_upright_and_still_commands_nothing(void)
+{
+    balanceGains gains = BALANCE_DEFAULT_GAINS;
+    balanceInput input = {0.0f, 0.0f, 0.0f};
+    balanceOutput output = balanceStep(gains, input);
+    TEST_ASSERT_FALSE(output.fallen);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, output.command);
+}
+
+void test_lean_forward_drives_forward(void)
+{
+    balanceGains gains = BALANCE_DEFAULT_GAINS;
+    balanceInput input = {0.05f, 0.0f, 0.0f};
+    TEST_ASSERT_GREATER_THAN(0, (int)balanceStep(gains, input).command);
+    input.pitch = -0.05f;
+    TEST_ASSERT_LESS_THAN(0, (int)balanceStep(gains, input).command);
+}
+
+void test_command_is_clamped(void)
+{
+    balanceGains gains = BALANCE_DEFAULT_GAINS;
+    balanceInput input = {0.5f, 5.0f, 0.0f};
+    TEST_ASSERT_EQUAL_FLOAT(gains.maxCommand, balanceStep(gains, input).command);
+    input = {-0.5f, -5.0f, 0.0f};
+    TEST_ASSERT_EQUAL_FLOAT(-gains.maxCommand, balanceStep(gains, input).command);
+}
+
+void test_past_max_tilt_is_fallen(void)
+{
+    balanceGains gains = BALANCE_DEFAULT_GAINS;
+    balanceInput input = {gains.maxTilt + 0.01f, 0.0f, 0.0f};
+    balanceOutput output = balanceStep(gains, input);
+    TEST_ASSERT_TRUE(output.fallen);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, output.command);
+}
+
+void test_speed_conversion(void)
+{
+    TEST_ASSERT_EQUAL_UINT8(128, balanceToSpeed(0.0f));
+    TEST_ASSERT_EQUAL_UINT8(255, balanceToSpeed(127.0f));
+    TEST_ASSERT_EQUAL_UINT8(0, balanceToSpeed(-128.0f));
+    TEST_ASSERT_EQUAL_UINT8(255, balanceToSpeed(500.0f));
+    TEST_ASSERT_EQUAL_UINT8(129, balanceToSpeed(0.6f));
+    TEST_ASSERT_EQUAL_UINT8(127, balanceToSpeed(-0.6f));
+}
+
+void test_uncontrolled_plant_falls(void)
+{
+    balanceGains gains = BALANCE_DEFAULT_GAINS;
+    gains.kpAngle = 0.0f;
+    gains.kdAngle = 0.0f;
+    gains.kpSpeed = 0.0f;
+    plant p = {0.05f, 0.0f, 0.0f, 0.0f};
+    TEST_ASSERT_FALSE(runClosedLoop(p, gains, 200.0f, 2.0f));
+}
+
+void test_recovers_from_lean_at_200hz(void)
+{
+    balanceGains gains = BALANCE_DEFAULT_GAINS;
+    plant p = {0.1f, 0.0f, 0.0f, 0.0f};
+    TEST_ASSERT_TRUE(runClosedLoop(p, gains, 200.0f, 5.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, p.pitch);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.0f, p.wheelSpeed);
+}
+
+void test_recovers_from_push_at_1khz(void)
+{
+    balanceGains gains = BALANCE_DEFAULT_GAINS;
+    plant p = {0.0f, 1.0f, 0.0f, 0.0f};
+    TEST_ASSERT_TRUE(runClosedLoop(p, gains, 1000.0f, 5.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, p.pitch);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.0f, p.wheelSpeed);
+}
+
+void test_cascade_recovers_from_lean(void)
+{
+    plant p = {0.1f, 0.0f, 0.0f, 0.0f};
+    TEST_ASSERT_TRUE(runCascade(p, 0.0f, 10.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, p.pitch);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.0f, p.wheelSpeed);
+}
+
+void test_cascade_trims_com_offset(void)
+{
+    plant p = {0.0f, 0.0f, 0.0f, 0.0f};
+    TEST_ASSERT_TRUE(runCascade(p, 0.0f, 30.0f, 0.03f));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -0.03f, p.pitch); // Leans back to put the centre of mass over the axle.
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.0f, p.wheelSpeed);
+}
+
+void test_cascade_follows_speed_target(void)
+{
+    plant p = {0.0f, 0.0f, 0.0f, 0.0f};
+    TEST_ASSERT_TRUE(runCascade(p, 0.3f, 20.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.3f, p.wheelSpeed);
+}
+
+void test_stats_exec_time(void)
+{
+    amLoopStats stats(5000);
+    stats.record(0, 100);
+    stats.record(5000, 5300);
+    stats.record(10000, 10200);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.getCycles());
+    TEST_ASSERT_EQUAL_UINT32(200, stats.getExecLastUs());
+    TEST_ASSERT_EQUAL_UINT32(300, stats.getExecMaxUs());
+    TEST_ASSERT_EQUAL_UINT32(200, stats.getExecAvgUs());
+    TEST_ASSERT_EQUAL_UINT32(0, stats.getJitterMaxUs());
+    TEST_ASSERT_EQUAL_UINT32(0, stats.getOverruns());
+}
+
+void test_stats_jitter_both_directions(void)
+{
+    amLoopStats stats(1000);
+    stats.record(0, 10);
+    stats.record(1040, 1050); // 40us late.
+    stats.record(1990, 2000); // 50us early.
+    stats.record(3000, 3010);
+    TEST_ASSERT_EQUAL_UINT32(50, stats.getJitterMaxUs()); // Periods were 1040, 950 and 1010.
+}
+
+void test_stats_overruns(void)
+{
+    amLoopStats stats(1000);
+    stats.record(0, 1500); // Ran past the next tick.
+    stats.recordMissed(2); // Timer fired twice with no cycle.
+    TEST_ASSERT_EQUAL_UINT32(3, stats.getOverruns());
+    stats.setPeriod(2000);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.getOverruns());
+    TEST_ASSERT_EQUAL_UINT32(2000, stats.getPeriod());
+}
+
+void test_stats_survive_micros_wrap(void)
+{
+    amLoopStats stats(1000);
+    stats.record(0xFFFFFF00u, 0xFFFFFF64u);
+    stats.record(0x000002E8u, 0x0000034Cu); // 1000us later, across the wrap.
+    TEST_ASSERT_EQUAL_UINT32(100, stats.getExecMaxUs());
+    TEST_ASSERT_EQUAL_UINT32(0, stats.getJitterMaxUs());
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_upright_and_still_commands_nothing);
+    RUN_TEST(test_lean_forward_drives_forward);
+    RUN_TEST(test_command_is_clamped);
+    RUN_TEST(test_past_max_tilt_is_fallen);
+    RUN_TEST(test_speed_conversion);
+    RUN_TEST(test_uncontrolled_plant_falls);
+    RUN_TEST(test_recovers_from_lean_at_200hz);
+    RUN_TEST(test_recovers_from_push_at_1khz);
+    RUN_TEST(test_cascade_recovers_from_lean);
+    RUN_TEST(test_cascade_trims_com_offset);
+    RUN_TEST(test_cascade_follows_speed_target);
+    RUN_TEST(test_stats_exec_time);
+    RUN_TEST(test_stats_jitter_both_directions);
+    RUN_TEST(test_stats_overruns);
+    RUN_TEST(test_stats_survive_micros_wrap);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+void setup()
+{
+    delay(2000); // service delay
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,268 @@
+// Tests for the boot profiler and the dependency aware start up sequence.
+// The graph, critical path and report are checked on both targets with phase times set by hand. The last of those is a
+// simulation of the robot's own boot: the phases of setup() with rough ESP32 costs, one after another as setup() used to run
+// them and as a graph. On the host run() is then tried with real tasks, checking that independent phases overlap and that no
+// phase starts before the phases it comes after have ended, that a milestone after a failed phase is not reached, and that each
+// phase task runs the task end hook.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <amBoot.h>
+
+#ifdef ZIPPY_NATIVE
+// run() needs the host stand-ins of micros() and FreeRTOS tasks. Tests do not build native/ on their own.
+#include "../../native/hostArduino.cpp"
+#include "../../native/hostFreeRTOS.cpp"
+#endif
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Phases may only come after phases added before them and records, which are outside the graph, cannot be waited for.
+void test_add_rejects_bad_order(void)
+{
+    amBoot boot;
+    uint8_t a = boot.add("a", nullptr, nullptr, 0);
+    TEST_ASSERT_EQUAL_UINT8(0, a);
+    TEST_ASSERT_EQUAL_UINT8(BOOT_NO_PHASE, boot.add("b", nullptr, nullptr, BOOT_AFTER(1)));
+    uint8_t r = boot.record("serial", 0, 100);
+    TEST_ASSERT_EQUAL_UINT8(BOOT_NO_PHASE, boot.add("c", nullptr, nullptr, BOOT_AFTER(r)));
+    TEST_ASSERT_EQUAL_UINT8(2, boot.add("c", nullptr, nullptr, BOOT_AFTER(a)));
+    while (boot.getCount() < BOOT_MAX_PHASES) boot.record("x", 0, 0);
+    TEST_ASSERT_EQUAL_UINT8(BOOT_NO_PHASE, boot.add("full", nullptr, nullptr, 0));
+    TEST_ASSERT_EQUAL_UINT8(BOOT_NO_PHASE, boot.record("full", 0, 0));
+}
+
+// The critical path is the longest chain through the graph, not the longest phase or the sum of them.
+void test_critical_path(void)
+{
+    amBoot boot;
+    uint8_t a = boot.add("a", nullptr, nullptr, 0);
+    uint8_t b = boot.add("b", nullptr, nullptr, BOOT_AFTER(a));
+    uint8_t c = boot.add("c", nullptr, nullptr, 0);
+    uint8_t d = boot.add("d", nullptr, nullptr, BOOT_AFTER(b) | BOOT_AFTER(c));
+    uint8_t r = boot.record("wifi", 0, 5000000); // Outside the graph. Never on the critical path.
+    boot.setTimes(a, 0, 300);
+    boot.setTimes(b, 300, 500);
+    boot.setTimes(c, 500, 1100); // Longest phase, but its chain is shorter.
+    boot.setTimes(d, 1100, 1200);
+    TEST_ASSERT_EQUAL_UINT32(700, boot.getCriticalPathUs());
+    TEST_ASSERT_TRUE(boot.isCritical(c));
+    TEST_ASSERT_TRUE(boot.isCritical(d));
+    TEST_ASSERT_FALSE(boot.isCritical(a));
+    TEST_ASSERT_FALSE(boot.isCritical(b));
+    TEST_ASSERT_FALSE(boot.isCritical(r));
+    TEST_ASSERT_EQUAL_UINT32(1200, boot.getSerialUs());
+    TEST_ASSERT_EQUAL_UINT32(1200, boot.getWallUs());
+}
+
+// The report gives the totals, then each entry with its marks, and ends in ... rather than overrunning.
+void test_report(void)
+{
+    amBoot boot;
+    uint8_t a = boot.add("scan", nullptr, nullptr, 0);
+    uint8_t b = boot.add("lcd", nullptr, nullptr, BOOT_AFTER(a));
+    boot.record("wifi", 1000, 2501000);
+    boot.setTimes(a, 300000, 342500);
+    boot.setTimes(b, 342500, 1442500);
+    char text[160];
+    size_t n = boot.report(text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("boot 1142.5 ms, critical path 1142.5 ms, serial 1142.5 ms: scan*@300+42.5 lcd*@342+1100.0 wifi~@1+2500.0", text);
+    TEST_ASSERT_EQUAL_UINT32(strlen(text), n);
+    char small[64];
+    n = boot.report(small, sizeof(small));
+    TEST_ASSERT_TRUE(n < sizeof(small));
+    TEST_ASSERT_EQUAL_UINT32(strlen(small), n);
+    TEST_ASSERT_EQUAL_STRING(" ...", small + n - 4);
+}
+
+// The robot's own boot with rough ESP32 costs in microseconds. setup() used to do all of it one phase after another, waiting
+// on WiFi and the broker as well. As a graph the two I2C buses and the network start up side by side, and the LCD, whose
+// driver sleeps for over a second, comes last on bus0 so that it holds up nothing the balance loop needs.
+void test_simulate_robot_boot(void)
+{
+    amBoot boot;
+    uint8_t net = boot.add("net", nullptr, nullptr, 0);
+    uint8_t scan0 = boot.add("scan0", nullptr, nullptr, 0);
+    uint8_t scan1 = boot.add("scan1", nullptr, nullptr, 0);
+    uint8_t motors = boot.add("motors", nullptr, nullptr, BOOT_AFTER(scan0));
+    uint8_t imu = boot.add("imu", nullptr, nullptr, BOOT_AFTER(scan1), 1);
+    uint8_t balance = boot.add("balance", nullptr, nullptr, BOOT_AFTER(imu), 1);
+    uint8_t ready = boot.milestone("ready", BOOT_AFTER(motors) | BOOT_AFTER(balance));
+    uint8_t lcd = boot.add("lcd", nullptr, nullptr, BOOT_AFTER(motors));
+    struct { uint8_t id; uint32_t us; } cost[] =
+    {
+        {net, 120000}, // WiFi driver start and the NVS read. The connection itself is left to loop().
+        {scan0, 3000}, // The 12 addresses registered on bus0 at 100kHz, most of them with nothing there.
+        {scan1, 300}, // The IMU's one address at 400kHz.
+        {motors, 3000}, // MD25 version read and the start of the self-test move.
+        {imu, 12000}, // MPU6050 registers and FIFO.
+        {balance, 1000}, // Task and timer.
+        {ready, 0},
+        {lcd, 1160000}, // LiquidCrystal_I2C::init() sleeps 1050ms.
+    };
+    uint32_t serial = 0;
+    for (uint8_t i = 0; i < sizeof(cost) / sizeof(cost[0]); i++)
+    {
+        boot.setTimes(cost[i].id, serial, serial + cost[i].us); // One after another.
+        serial += cost[i].us;
+    }
+    TEST_ASSERT_EQUAL_UINT32(serial, boot.getSerialUs());
+    TEST_ASSERT_EQUAL_UINT32(3000 + 3000 + 1160000, boot.getCriticalPathUs());
+    TEST_ASSERT_TRUE(boot.isCritical(lcd));
+    TEST_ASSERT_FALSE(boot.isCritical(net));
+    amBoot toReady; // The same graph without the LCD: how long until the robot can balance.
+    net = toReady.add("net", nullptr, nullptr, 0);
+    scan0 = toReady.add("scan0", nullptr, nullptr, 0);
+    scan1 = toReady.add("scan1", nullptr, nullptr, 0);
+    motors = toReady.add("motors", nullptr, nullptr, BOOT_AFTER(scan0));
+    imu = toReady.add("imu", nullptr, nullptr, BOOT_AFTER(scan1), 1);
+    balance = toReady.add("balance", nullptr, nullptr, BOOT_AFTER(imu), 1);
+    toReady.milestone("ready", BOOT_AFTER(motors) | BOOT_AFTER(balance));
+    for (uint8_t i = 0; i < 7; i++) toReady.setTimes(i, 0, cost[i].us);
+    TEST_ASSERT_EQUAL_UINT32(120000, toReady.getCriticalPathUs()); // The network start, alongside the rest.
+    char text[384];
+    boot.report(text, sizeof(text));
+    TEST_MESSAGE(text);
+    snprintf(text, sizeof(text), "ready to balance after %lu us as a graph, %lu us plus the wait for WiFi in the old setup() order",
+             (unsigned long)toReady.getCriticalPathUs(), (unsigned long)serial);
+    TEST_MESSAGE(text);
+}
+
+#ifdef ZIPPY_NATIVE
+// Phase for the run() tests. Sleeps for its argument in ms.
+bool sleepPhase(void* arg)
+{
+    delay((uint32_t)(uintptr_t)arg);
+    return true;
+}
+
+// Phase that says it did not work.
+bool failPhase(void*)
+{
+    return false;
+}
+
+// Independent phases overlap, dependent ones wait, and the boot takes about as long as the critical path.
+void test_run_overlaps(void)
+{
+    amBoot boot;
+    uint8_t a = boot.add("a", sleepPhase, (void*)(uintptr_t)60, 0);
+    uint8_t b = boot.add("b", sleepPhase, (void*)(uintptr_t)60, 0);
+    uint8_t c = boot.add("c", sleepPhase, (void*)(uintptr_t)30, BOOT_AFTER(a));
+    uint8_t d = boot.add("d", sleepPhase, (void*)(uintptr_t)60, 0, 1);
+    uint8_t m = boot.milestone("m", BOOT_AFTER(c) | BOOT_AFTER(b));
+    uint32_t start = micros();
+    TEST_ASSERT_TRUE(boot.run(4096, 1));
+    uint32_t took = micros() - start;
+    TEST_ASSERT_EQUAL_UINT8(4, boot.getTasksStarted());
+    TEST_ASSERT_TRUE((int32_t)(boot.getStartUs(c) - boot.getEndUs(a)) >= 0);
+    TEST_ASSERT_TRUE((int32_t)(boot.getStartUs(m) - boot.getEndUs(c)) >= 0);
+    TEST_ASSERT_TRUE((int32_t)(boot.getStartUs(m) - boot.getEndUs(b)) >= 0);
+    TEST_ASSERT_TRUE(boot.getStartUs(b) - start < 20000); // Did not wait for a.
+    TEST_ASSERT_TRUE(boot.getStartUs(d) - start < 20000);
+    TEST_ASSERT_TRUE(boot.getSerialUs() >= 210000);
+    TEST_ASSERT_TRUE(took < 150000); // About 90ms. Well short of the 210ms one after another.
+    TEST_ASSERT_TRUE(boot.getWallUs() <= took);
+    TEST_ASSERT_TRUE(boot.getCriticalPathUs() >= 90000);
+    TEST_ASSERT_TRUE(boot.getWallUs() < boot.getCriticalPathUs() + 40000);
+    TEST_ASSERT_TRUE(boot.isCritical(a));
+    TEST_ASSERT_TRUE(boot.isCritical(c));
+}
+
+// A phase that fails is reported, and the phases after it still run.
+void test_run_failure(void)
+{
+    amBoot boot;
+    uint8_t a = boot.add("a", failPhase, nullptr, 0);
+    uint8_t b = boot.add("b", sleepPhase, (void*)(uintptr_t)1, BOOT_AFTER(a));
+    TEST_ASSERT_FALSE(boot.run(4096, 1));
+    TEST_ASSERT_EQUAL_UINT8(BOOT_FAILED, boot.getState(a));
+    TEST_ASSERT_EQUAL_UINT8(BOOT_DONE, boot.getState(b));
+    char text[128];
+    boot.report(text, sizeof(text));
+    TEST_ASSERT_NOT_NULL(strstr(text, " a!@"));
+}
+
+// A milestone is only reached if every phase it comes after worked. One that is not reached fails the milestones after it.
+void test_run_milestone_not_reached(void)
+{
+    amBoot boot;
+    uint8_t good = boot.add("good", sleepPhase, (void*)(uintptr_t)1, 0);
+    uint8_t bad = boot.add("bad", failPhase, nullptr, 0);
+    uint8_t reached = boot.milestone("reached", BOOT_AFTER(good));
+    uint8_t ready = boot.milestone("ready", BOOT_AFTER(good) | BOOT_AFTER(bad));
+    uint8_t later = boot.milestone("later", BOOT_AFTER(ready));
+    TEST_ASSERT_FALSE(boot.run(4096, 1));
+    TEST_ASSERT_EQUAL_UINT8(BOOT_DONE, boot.getState(reached));
+    TEST_ASSERT_EQUAL_UINT8(BOOT_FAILED, boot.getState(ready));
+    TEST_ASSERT_EQUAL_UINT8(BOOT_FAILED, boot.getState(later));
+    TEST_ASSERT_TRUE((int32_t)(boot.getStartUs(ready) - boot.getEndUs(bad)) >= 0); // Still waited for the failed phase.
+}
+
+std::atomic<uint8_t> taskEnds(0); // Calls to countTaskEnd().
+
+// Task end hook for the test below.
+void countTaskEnd()
+{
+    taskEnds++;
+}
+
+// Every phase task runs the task end hook before it is deleted. Milestones have no task and do not.
+void test_run_task_end(void)
+{
+    amBoot boot;
+    uint8_t a = boot.add("a", sleepPhase, (void*)(uintptr_t)1, 0);
+    boot.add("b", sleepPhase, (void*)(uintptr_t)1, 0);
+    boot.add("c", failPhase, nullptr, BOOT_AFTER(a));
+    boot.milestone("m", BOOT_AFTER(a));
+    boot.setTaskEnd(countTaskEnd);
+    boot.run(4096, 1);
+    delay(20); // The last task may still be on its way out when run() returns.
+    TEST_ASSERT_EQUAL_UINT8(3, boot.getTasksStarted());
+    TEST_ASSERT_EQUAL_UINT8(3, taskEnds.load());
+}
+#endif
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_add_rejects_bad_order);
+    RUN_TEST(test_critical_path);
+    RUN_TEST(test_report);
+    RUN_TEST(test_simulate_robot_boot);
+#ifdef ZIPPY_NATIVE
+    RUN_TEST(test_run_overlaps);
+    RUN_TEST(test_run_failure);
+    RUN_TEST(test_run_milestone_not_reached);
+    RUN_TEST(test_run_task_end);
+#endif
+    return UNITY_END();
+}
+
+#ifndef ZIPPY_NATIVE
+#include <Arduino.h>
+
+void setup()
+{
+    delay(2000); // Give the board time to open the serial port.
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    int failures = runUnityTests();
+    hostStopTasks(); // Join the phase task threads.
+    return failures;
+}
+#endif
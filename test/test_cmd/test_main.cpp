@@ -0,0 +1,247 @@
+// Host side tests and benchmark for the amCmd command tokenizer and dispatch table.
+// The benchmark counts heap allocations by replacing the global operator new, so any String or std::string that sneaks into the
+// command path shows up as a failure.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <amCmd.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+uint64_t nowNs() { return (uint64_t)micros() * 1000; }
+#else
+#include <chrono>
+uint64_t nowNs() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+#endif
+
+volatile uint32_t allocations = 0; // Calls to operator new.
+
+void* operator new(size_t size)
+{
+    allocations++;
+    void* p = malloc(size ? size : 1);
+    if(p == nullptr) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+uint8_t lastArgCount; // What the last handler was given.
+long lastValue;
+
+bool handleLed(const cmdArg* arg, uint8_t argCount) { lastArgCount = argCount; return argCount == 2 && cmdToLong(arg[1], &lastValue); }
+bool handleRgb(const cmdArg*, uint8_t argCount) { lastArgCount = argCount; return argCount == 4; }
+bool handleStop(const cmdArg*, uint8_t argCount) { lastArgCount = argCount; return true; }
+bool handleTest(const cmdArg*, uint8_t argCount) { lastArgCount = argCount; return true; }
+
+const cmdEntry table[] = {{"LED", handleLed}, {"RGB", handleRgb}, {"STOP", handleStop}, {"TEST", handleTest}};
+const uint8_t entries = sizeof(table) / sizeof(table[0]);
+
+void setUp(void)
+{
+    lastArgCount = 0;
+    lastValue = 0;
+}
+
+void tearDown(void)
+{
+}
+
+void test_tokenize_splits_upper_cases_and_trims(void)
+{
+    char buffer[] = " rgb , 255,0 ,\t10";
+    cmdArg args[CMD_MAX_ARGS];
+    uint8_t count;
+    TEST_ASSERT_TRUE(cmdTokenize(buffer, strlen(buffer), args, CMD_MAX_ARGS, &count));
+    TEST_ASSERT_EQUAL_UINT8(4, count);
+    TEST_ASSERT_EQUAL_STRING("RGB", args[0].text); // Slices are 0 terminated in place.
+    TEST_ASSERT_EQUAL_UINT16(3, args[0].len);
+    TEST_ASSERT_EQUAL_STRING("255", args[1].text);
+    TEST_ASSERT_EQUAL_STRING("0", args[2].text);
+    TEST_ASSERT_EQUAL_STRING("10", args[3].text);
+    TEST_ASSERT_TRUE(args[0].text >= buffer && args[3].text < buffer + sizeof(buffer)); // No copies.
+}
+
+void test_tokenize_keeps_empty_arguments(void)
+{
+    char buffer[] = "a,,b,";
+    cmdArg args[CMD_MAX_ARGS];
+    uint8_t count;
+    TEST_ASSERT_TRUE(cmdTokenize(buffer, strlen(buffer), args, CMD_MAX_ARGS, &count));
+    TEST_ASSERT_EQUAL_UINT8(4, count);
+    TEST_ASSERT_EQUAL_UINT16(0, args[1].len);
+    TEST_ASSERT_EQUAL_STRING("B", args[2].text);
+    TEST_ASSERT_EQUAL_UINT16(0, args[3].len);
+}
+
+void test_tokenize_stops_at_len(void)
+{
+    char buffer[] = "test,1xxxxx"; // An MQTT payload is not 0 terminated. Only the first 6 characters are the command.
+    cmdArg args[CMD_MAX_ARGS];
+    uint8_t count;
+    TEST_ASSERT_TRUE(cmdTokenize(buffer, 6, args, CMD_MAX_ARGS, &count));
+    TEST_ASSERT_EQUAL_UINT8(2, count);
+    TEST_ASSERT_EQUAL_STRING("1", args[1].text);
+    TEST_ASSERT_EQUAL_UINT8('x', buffer[7]); // Nothing past len + 1 is touched.
+}
+
+void test_tokenize_reports_too_many_arguments(void)
+{
+    char buffer[] = "a,1,2,3,4";
+    cmdArg args[3];
+    uint8_t count;
+    TEST_ASSERT_FALSE(cmdTokenize(buffer, strlen(buffer), args, 3, &count));
+    TEST_ASSERT_EQUAL_UINT8(3, count);
+    TEST_ASSERT_EQUAL_STRING("2", args[2].text);
+}
+
+void test_find_uses_whole_names(void)
+{
+    TEST_ASSERT_TRUE(cmdTableSorted(table, entries));
+    for(uint8_t i = 0; i < entries; i++)
+    {
+        cmdArg name = {table[i].name, (uint16_t)strlen(table[i].name)};
+        TEST_ASSERT_TRUE(cmdFind(table, entries, name) == &table[i]);
+    }
+    const char* misses[] = {"", "A", "LE", "LEDS", "RGBA", "STO", "TESTS", "ZZZ"};
+    for(const char* miss : misses)
+    {
+        cmdArg name = {miss, (uint16_t)strlen(miss)};
+        TEST_ASSERT_NULL(cmdFind(table, entries, name));
+    }
+    cmdArg prefix = {"TESTING", 4}; // A slice of a longer buffer.
+    TEST_ASSERT_TRUE(cmdFind(table, entries, prefix) == &table[3]);
+}
+
+void test_table_sorted_check(void)
+{
+    const cmdEntry unsorted[] = {{"RGB", handleRgb}, {"LED", handleLed}};
+    const cmdEntry twice[] = {{"LED", handleLed}, {"LED", handleLed}};
+    TEST_ASSERT_FALSE(cmdTableSorted(unsorted, 2));
+    TEST_ASSERT_FALSE(cmdTableSorted(twice, 2));
+    TEST_ASSERT_TRUE(cmdTableSorted(table, 0));
+}
+
+void test_to_long(void)
+{
+    long value = 99;
+    char text[32];
+    cmdArg arg = {text, 0};
+    const char* good[] = {"0", "42", "-17", "+8"};
+    const long expect[] = {0, 42, -17, 8};
+    for(int i = 0; i < 4; i++)
+    {
+        arg.text = good[i];
+        arg.len = strlen(good[i]);
+        TEST_ASSERT_TRUE(cmdToLong(arg, &value));
+        TEST_ASSERT_EQUAL_INT32(expect[i], value);
+    }
+    const char* bad[] = {"", "-", "1a", " 1", "0x10", "1.5"};
+    for(const char* b : bad)
+    {
+        value = 99;
+        arg.text = b;
+        arg.len = strlen(b);
+        TEST_ASSERT_FALSE(cmdToLong(arg, &value));
+        TEST_ASSERT_EQUAL_INT32(99, value);
+    }
+    snprintf(text, sizeof(text), "%ld", LONG_MAX);
+    arg.text = text;
+    arg.len = strlen(text);
+    TEST_ASSERT_TRUE(cmdToLong(arg, &value));
+    TEST_ASSERT_TRUE(value == LONG_MAX);
+    snprintf(text, sizeof(text), "%ld", LONG_MIN);
+    arg.len = strlen(text);
+    TEST_ASSERT_TRUE(cmdToLong(arg, &value));
+    TEST_ASSERT_TRUE(value == LONG_MIN);
+    snprintf(text, sizeof(text), "%ld0", LONG_MAX);
+    arg.len = strlen(text);
+    TEST_ASSERT_FALSE(cmdToLong(arg, &value));
+}
+
+void test_dispatch_status_codes(void)
+{
+    char led[] = "led,-3";
+    TEST_ASSERT_EQUAL_UINT8(CMD_OK, cmdDispatch(table, entries, led, strlen(led)));
+    TEST_ASSERT_EQUAL_INT32(-3, lastValue);
+    char bad[] = "Led,x";
+    TEST_ASSERT_EQUAL_UINT8(CMD_FAILED, cmdDispatch(table, entries, bad, strlen(bad)));
+    char unknown[] = "fly,1";
+    TEST_ASSERT_EQUAL_UINT8(CMD_UNKNOWN, cmdDispatch(table, entries, unknown, strlen(unknown)));
+    char empty[] = "  ";
+    TEST_ASSERT_EQUAL_UINT8(CMD_EMPTY, cmdDispatch(table, entries, empty, strlen(empty)));
+    char many[64] = "test";
+    for(int i = 0; i < CMD_MAX_ARGS; i++) strcat(many, ",1");
+    lastArgCount = 0;
+    TEST_ASSERT_EQUAL_UINT8(CMD_TOO_MANY_ARGS, cmdDispatch(table, entries, many, strlen(many)));
+    TEST_ASSERT_EQUAL_UINT8(0, lastArgCount); // Handler not run.
+    char most[64] = "test";
+    for(int i = 1; i < CMD_MAX_ARGS; i++) strcat(most, ",1");
+    TEST_ASSERT_EQUAL_UINT8(CMD_OK, cmdDispatch(table, entries, most, strlen(most)));
+    TEST_ASSERT_EQUAL_UINT8(CMD_MAX_ARGS, lastArgCount);
+}
+
+// Reports messages per second and checks the whole path makes no heap allocations.
+void test_benchmark_messages_per_second(void)
+{
+    const char* messages[] = {"test", "rgb,255,128,0", "LED,1", "stop", "led,banana", "unknown,1,2,3"};
+    const uint32_t rounds = 180000; // Whole passes through messages.
+    char buffer[32];
+    uint32_t ok = 0;
+    uint32_t before = allocations;
+    uint64_t start = nowNs();
+    for(uint32_t i = 0; i < rounds; i++)
+    {
+        const char* message = messages[i % 6];
+        size_t len = strlen(message);
+        memcpy(buffer, message, len + 1); // Fresh copy each time, as from the queue.
+        ok += (cmdDispatch(table, entries, buffer, len) == CMD_OK);
+    }
+    uint64_t elapsed = nowNs() - start;
+    uint32_t made = allocations - before;
+    TEST_ASSERT_EQUAL_UINT32(rounds / 6 * 4, ok); // Four of the six messages succeed.
+    TEST_ASSERT_EQUAL_UINT32(0, made);
+    char msg[120];
+    snprintf(msg, sizeof(msg), "%.0f messages/s, %.1f ns/message, %.2f heap allocations/message", rounds * 1e9 / elapsed,
+             (double)elapsed / rounds, (double)made / rounds);
+    TEST_MESSAGE(msg);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_tokenize_splits_upper_cases_and_trims);
+    RUN_TEST(test_tokenize_keeps_empty_arguments);
+    RUN_TEST(test_tokenize_stops_at_len);
+    RUN_TEST(test_tokenize_reports_too_many_arguments);
+    RUN_TEST(test_find_uses_whole_names);
+    RUN_TEST(test_table_sorted_check);
+    RUN_TEST(test_to_long);
+    RUN_TEST(test_dispatch_status_codes);
+    RUN_TEST(test_benchmark_messages_per_second);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+    delay(2000); // service delay
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runUnityTests();
+}
+#endif
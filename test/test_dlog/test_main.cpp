@@ -0,0 +1,347 @@
+// Host side tests and benchmark for amDeferredLog.
+// Deferred records are checked against what ArduinoLog itself prints for the same call, sent through the binary frames and the
+// decoder, and pushed from one thread while another drains them. Tasks that come and go take turns with a few channels. The
+// benchmark compares what a log call costs its caller.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <ArduinoLog.h>
+#include <amDeferredLog.h>
+
+// native/Arduino.h defines ARDUINO for ArduinoLog, so the host is told apart by ZIPPY_NATIVE here.
+#ifndef ZIPPY_NATIVE
+#include <Arduino.h>
+uint64_t nowNs() { return (uint64_t)micros() * 1000; }
+#else
+#include <chrono>
+#include <thread>
+#include "../../native/hostArduino.cpp" // Host Arduino core for ArduinoLog. Tests do not build native/ on their own.
+uint64_t nowNs() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+#endif
+
+// Collects what ArduinoLog prints.
+class capturePrint : public Print
+{
+    public:
+        size_t write(uint8_t c) override { text += (char)c; return 1; }
+        std::string text;
+};
+
+capturePrint capture; // ArduinoLog output.
+std::string decoded; // Decoder output, one line per record.
+
+void collectLine(const char* line, void*)
+{
+    decoded += line;
+    decoded += "\n";
+}
+
+// Text dlogFormat() gives for a call, with the new line ArduinoLog ends it with.
+template <typename... Args> std::string deferredText(uint8_t level, const char* format, const Args&... args)
+{
+    dlogRecord rec;
+    dlogBegin(rec, 0, level, format);
+    dlogAddAll(rec, args...);
+    char line[DLOG_LINE_LEN];
+    dlogFormat(rec, false, line, sizeof(line));
+    return std::string(line) + "\n";
+}
+
+void setUp(void)
+{
+    Log.begin(LOG_LEVEL_VERBOSE, &capture, true);
+    capture.text.clear();
+    decoded.clear();
+}
+
+void tearDown(void)
+{
+}
+
+void test_text_matches_arduinolog(void)
+{
+    Log.verboseln("<t> d=%d l=%l u=%u x=%x X=%X b=%b B=%B", -5, -70000L, 4000000000UL, 255, 0x1F, 5, 6);
+    TEST_ASSERT_EQUAL_STRING(capture.text.c_str(), deferredText(LOG_LEVEL_VERBOSE, "<t> d=%d l=%l u=%u x=%x X=%X b=%b B=%B",
+                             -5, -70000L, 4000000000UL, 255, 0x1F, 5, 6).c_str());
+    capture.text.clear();
+    Log.noticeln("<t> c=%c C=%C C=%C t=%t T=%T T=%T s=%s F=%F 100%%", 'A', 'B', '\n', true, true, false, "hi", 1.5);
+    TEST_ASSERT_EQUAL_STRING(capture.text.c_str(), deferredText(LOG_LEVEL_NOTICE, "<t> c=%c C=%C C=%C t=%t T=%T T=%T s=%s F=%F 100%%",
+                             'A', 'B', '\n', true, true, false, "hi", 1.5).c_str());
+    capture.text.clear();
+    Log.errorln("<t> No arguments.");
+    TEST_ASSERT_EQUAL_STRING(capture.text.c_str(), deferredText(LOG_LEVEL_ERROR, "<t> No arguments.").c_str());
+}
+
+void test_text_copied_and_cut_short(void)
+{
+    char buffer[64] = "first";
+    dlogRecord rec;
+    dlogBegin(rec, 0, LOG_LEVEL_WARNING, "%s %s %d");
+    dlogAddAll(rec, buffer, "0123456789012345678901234567890123456789", 7);
+    strcpy(buffer, "changed"); // Caller reuses its buffer before the record is drained.
+    char line[DLOG_LINE_LEN];
+    dlogFormat(rec, false, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("W: first 0123456789012345678901234 7", line); // 32 byte text area, terminators included.
+    TEST_ASSERT_EQUAL_UINT8(3, rec.argCount);
+}
+
+void test_extra_arguments_ignored_and_missing_print_nothing(void)
+{
+    TEST_ASSERT_EQUAL_STRING("V: 1 2 3 4 5 6 7 8 9=\n", deferredText(LOG_LEVEL_VERBOSE, "%d %d %d %d %d %d %d %d 9=%d", 1, 2, 3, 4, 5, 6, 7, 8, 9).c_str());
+    TEST_ASSERT_EQUAL_STRING("V: a= b=\n", deferredText(LOG_LEVEL_VERBOSE, "a=%d b=%s").c_str());
+    char small[8];
+    dlogRecord rec;
+    dlogBegin(rec, 0, LOG_LEVEL_VERBOSE, "long line");
+    TEST_ASSERT_EQUAL_UINT32(7, dlogFormat(rec, false, small, sizeof(small)));
+    TEST_ASSERT_EQUAL_STRING("V: long", small);
+}
+
+void test_full_channel_counts_drops(void)
+{
+    static amDeferredLogChannel channel;
+    for(uint8_t i = 0; i < DLOG_RING_SLOTS + 4; i++)
+    {
+        channel.log(i, LOG_LEVEL_TRACE, "<t> %d", i);
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, channel.getDropped());
+    dlogRecord rec;
+    for(uint8_t i = 0; i < DLOG_RING_SLOTS; i++) // Oldest kept, newest dropped.
+    {
+        TEST_ASSERT_TRUE(channel.take(&rec));
+        TEST_ASSERT_EQUAL_UINT32(i, rec.timeUs);
+    }
+    TEST_ASSERT_FALSE(channel.take(&rec));
+}
+
+void test_binary_frames_decode_to_same_text(void)
+{
+    const char* formatA = "<t> Encoder = %l, speed = %d, ok = %T";
+    const char* formatB = "<t> Broker %s at %F";
+    uint8_t stream[1024];
+    uint16_t len = 0;
+    const char* noise = "boot text that is not a frame\r\n";
+    memcpy(stream, noise, strlen(noise));
+    len += strlen(noise);
+    std::string expected;
+    dlogRecord rec;
+    char line[DLOG_LINE_LEN];
+    len += dlogEncodeFormat(dlogFormatId(formatA), formatA, &stream[len], sizeof(stream) - len);
+    len += dlogEncodeFormat(dlogFormatId(formatB), formatB, &stream[len], sizeof(stream) - len);
+    for(int32_t i = 0; i < 3; i++)
+    {
+        dlogBegin(rec, 1000000 + i * 250, LOG_LEVEL_VERBOSE, formatA);
+        dlogAddAll(rec, -123456 * i, (uint8_t)(128 + i), i == 1);
+        len += dlogEncodeRecord(rec, &stream[len], sizeof(stream) - len);
+        dlogFormat(rec, true, line, sizeof(line));
+        expected += std::string(line) + "\n";
+        dlogBegin(rec, 2000000 + i, LOG_LEVEL_NOTICE, formatB);
+        dlogAddAll(rec, "192.168.2.21", 0.25 * i);
+        len += dlogEncodeRecord(rec, &stream[len], sizeof(stream) - len);
+        dlogFormat(rec, true, line, sizeof(line));
+        expected += std::string(line) + "\n";
+    }
+    len += dlogEncodeDropped(42, &stream[len], sizeof(stream) - len);
+    expected += "<amDeferredLogDecoder> 42 records dropped so far.\n";
+    static amDeferredLogDecoder decoder(collectLine, NULL);
+    for(uint16_t i = 0; i < len; i++) // A byte at a time, as from a serial port.
+    {
+        decoder.feed(&stream[i], 1);
+    }
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), decoded.c_str());
+    TEST_ASSERT_EQUAL_UINT32(9, decoder.getFrames());
+    TEST_ASSERT_EQUAL_UINT32(0, decoder.getBadFrames());
+    TEST_ASSERT_TRUE(expected.find("1.000250 V: <t> Encoder = -123456, speed = 129, ok = true") != std::string::npos);
+}
+
+void test_record_with_unknown_format_still_decoded(void)
+{
+    uint8_t frame[DLOG_FRAME_MAX];
+    dlogRecord rec;
+    dlogBegin(rec, 5, LOG_LEVEL_ERROR, "never sent %d");
+    dlogAddAll(rec, 1);
+    static amDeferredLogDecoder decoder(collectLine, NULL, false);
+    decoder.feed(frame, dlogEncodeRecord(rec, frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL_STRING("E: <amDeferredLogDecoder> Record with unknown format.\n", decoded.c_str());
+}
+
+#ifdef ZIPPY_NATIVE
+const uint32_t STRESS_RECORDS = 200000; // Records logged by the stress test.
+
+void test_stress_one_logger_one_drain(void)
+{
+    static amDeferredLogChannel channel;
+    std::atomic<bool> done(false);
+    std::thread logger([&done]()
+    {
+        for(uint32_t i = 0; i < STRESS_RECORDS; i++)
+        {
+            channel.log(i, LOG_LEVEL_VERBOSE, "<stress> %u %s", i, "payload");
+        }
+        done.store(true);
+    });
+    dlogRecord rec;
+    uint32_t received = 0;
+    uint32_t outOfOrder = 0;
+    uint32_t bad = 0;
+    int64_t last = -1;
+    for(;;)
+    {
+        bool finished = done.load();
+        if(channel.take(&rec) == true)
+        {
+            received++;
+            if((int64_t)rec.timeUs <= last) outOfOrder++;
+            if(rec.argCount != 2 || rec.args[0].u != rec.timeUs || strcmp(&rec.text[rec.args[1].u], "payload") != 0) bad++;
+            last = rec.timeUs;
+        }
+        else if(finished == true)
+        {
+            break;
+        }
+        else
+        {
+            std::this_thread::yield(); // Let the logger run on a single core host.
+        }
+    }
+    logger.join();
+    TEST_ASSERT_EQUAL_UINT32(0, outOfOrder);
+    TEST_ASSERT_EQUAL_UINT32(0, bad);
+    TEST_ASSERT_EQUAL_UINT32(STRESS_RECORDS, received + channel.getDropped());
+}
+
+const uint8_t POOL_CHANNELS = 3; // Channels shared by the come and go test.
+const uint8_t POOL_TASKS = 8; // Tasks alive at once in each wave. More than there are channels.
+const uint8_t POOL_WAVES = 6; // Waves of tasks, each started after the last has ended.
+const uint32_t POOL_RECORDS = 2000; // Records logged by each task.
+
+// Tasks that start, log and end, as the boot phases do, take turns with fewer channels than tasks. No channel ever has two
+// owners, a task that finds none free is refused rather than sharing one, and every channel is free again once they have ended.
+void test_tasks_come_and_go_through_fewer_channels(void)
+{
+    static amDeferredLogChannels<POOL_CHANNELS> pool;
+    static std::atomic<uint8_t> owners[POOL_CHANNELS];
+    std::atomic<uint32_t> logged(0);
+    std::atomic<uint32_t> refused(0);
+    std::atomic<uint32_t> shared(0);
+    std::atomic<uint32_t> received(0);
+    std::atomic<bool> done(false);
+    std::thread drain([&done, &received]()
+    {
+        dlogRecord rec;
+        while(done.load() == false)
+        {
+            for(uint8_t c = 0; c < POOL_CHANNELS; c++)
+            {
+                while(pool.get(c).take(&rec) == true) received++;
+            }
+            std::this_thread::yield();
+        }
+    });
+    for(uint8_t wave = 0; wave < POOL_WAVES; wave++)
+    {
+        std::thread tasks[POOL_TASKS];
+        for(uint8_t t = 0; t < POOL_TASKS; t++)
+        {
+            tasks[t] = std::thread([&]()
+            {
+                int8_t channel = pool.claim();
+                if(channel < 0)
+                {
+                    refused++; // Would log straight to Log.
+                    return;
+                }
+                if(owners[channel].fetch_add(1) != 0) shared++;
+                for(uint32_t i = 0; i < POOL_RECORDS; i++)
+                {
+                    if(pool.get(channel).log(i, LOG_LEVEL_VERBOSE, "<pool> %u", i) == true) logged++;
+                    if((i & 63) == 0) std::this_thread::yield(); // Let the other tasks in.
+                }
+                owners[channel].fetch_sub(1);
+                pool.release(channel);
+            });
+        }
+        for(uint8_t t = 0; t < POOL_TASKS; t++)
+        {
+            tasks[t].join();
+        }
+        TEST_ASSERT_EQUAL_UINT8(0, pool.getInUse());
+    }
+    done.store(true);
+    drain.join();
+    dlogRecord rec;
+    for(uint8_t c = 0; c < POOL_CHANNELS; c++)
+    {
+        while(pool.get(c).take(&rec) == true) received++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, shared.load());
+    TEST_ASSERT_EQUAL_UINT32(refused.load(), pool.getRefused());
+    TEST_ASSERT_TRUE(POOL_TASKS * POOL_WAVES - refused.load() >= POOL_WAVES); // Every wave got channels back from the last.
+    TEST_ASSERT_EQUAL_UINT32(logged.load(), received.load()); // Records left by tasks that ended were still drained.
+    int8_t later = pool.claim(); // A task started long after boot still gets a channel.
+    TEST_ASSERT_TRUE(later >= 0);
+    pool.release(later);
+}
+#endif
+
+// Not a pass/fail test. Reports what one log line costs the task that logs it.
+void test_benchmark_caller_cost(void)
+{
+    const uint32_t lines = 100000;
+    static amDeferredLogChannel channel;
+    dlogRecord rec;
+    uint64_t start = nowNs();
+    for(uint32_t i = 0; i < lines; i++)
+    {
+        channel.log(i, LOG_LEVEL_VERBOSE, "<balanceTask> pitch = %F, rate = %F, command = %d", 0.01 * i, -0.5, (int)i);
+        channel.take(&rec); // Keep the channel from filling. Not part of what the caller pays on the robot.
+    }
+    float deferredNs = (float)(nowNs() - start) / lines;
+    start = nowNs();
+    for(uint32_t i = 0; i < lines; i++)
+    {
+        capture.text.clear();
+        Log.verboseln("<balanceTask> pitch = %F, rate = %F, command = %d", 0.01 * i, -0.5, (int)i);
+    }
+    float immediateNs = (float)(nowNs() - start) / lines;
+    float uartUs = capture.text.size() * 10 * 1e6f / 115200; // 10 bits per byte on the wire.
+    char msg[200];
+    snprintf(msg, sizeof(msg), "ns/line for the caller: deferred %.0f, ArduinoLog into memory %.0f, plus %.0f us of UART time at 115200 baud for %u bytes",
+             deferredNs, immediateNs, uartUs, (unsigned)capture.text.size());
+    TEST_MESSAGE(msg);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_text_matches_arduinolog);
+    RUN_TEST(test_text_copied_and_cut_short);
+    RUN_TEST(test_extra_arguments_ignored_and_missing_print_nothing);
+    RUN_TEST(test_full_channel_counts_drops);
+    RUN_TEST(test_binary_frames_decode_to_same_text);
+    RUN_TEST(test_record_with_unknown_format_still_decoded);
+#ifdef ZIPPY_NATIVE
+    RUN_TEST(test_stress_one_logger_one_drain);
+    RUN_TEST(test_tasks_come_and_go_through_fewer_channels);
+#endif
+    RUN_TEST(test_benchmark_caller_cost);
+    return UNITY_END();
+}
+
+#ifndef ZIPPY_NATIVE
+void setup()
+{
+    delay(2000); // service delay
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runUnityTests();
+}
+#endif
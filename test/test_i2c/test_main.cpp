@@ -0,0 +1,489 @@
+// Tests for the I2C device registry, the prioritised transaction queue and its per address meter, against a fake bus that logs
+// every transaction. The registry must probe only the addresses it was given and sweep every address only when asked. The queue
+// must serve higher priorities first and each priority oldest first, time out transactions that wait too long, take back ones that
+// have not reached the bus and keep its latency histograms. The meter must count each address apart and cost well under 1us a
+// transaction, which the benchmark measures.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <string.h>
+#include <atomic>
+#include <amI2cRegistry.h>
+#include <amI2cQueue.h>
+#include <amLogHistogram.h>
+#include <amI2cMeter.h>
+#include <Arduino.h>
+#include <freertos/task.h>
+
+#ifdef ZIPPY_NATIVE
+// The queue needs the host stand-ins of micros() and FreeRTOS tasks. Tests do not build native/ on their own.
+#include "../../native/hostArduino.cpp"
+#include "../../native/hostFreeRTOS.cpp"
+#endif
+
+// Bus with devices at chosen addresses that logs the address of every transaction in the order they reach it.
+class fakeBus : public amI2cBus
+{
+    public:
+        bool present[128] = {};
+        uint8_t log[64];
+        std::atomic<uint8_t> count{0};
+        uint16_t probes = 0;
+        uint8_t regs[4];
+        void reset()
+        {
+            memset(present, 0, sizeof(present));
+            count = 0;
+            probes = 0;
+            const uint8_t start[] = {0x11, 0x22, 0x33, 0x44};
+            memcpy(regs, start, sizeof(regs));
+        }
+        uint8_t writeRegs(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t len)
+        {
+            note(address);
+            if(!present[address]) return I2C_ERR_NACK_ADDR;
+            memcpy(regs + reg, data, len);
+            return I2C_OK;
+        }
+        uint8_t readRegs(uint8_t address, uint8_t reg, uint8_t* dest, uint8_t len)
+        {
+            note(address);
+            if(!present[address]) return I2C_ERR_NACK_ADDR;
+            memcpy(dest, regs + reg, len);
+            return I2C_OK;
+        }
+        uint8_t probe(uint8_t address)
+        {
+            note(address);
+            probes++;
+            return present[address] ? I2C_OK : I2C_ERR_NACK_ADDR;
+        }
+    private:
+        void note(uint8_t address)
+        {
+            uint8_t n = count.load();
+            if(n < sizeof(log)) log[n] = address;
+            count.store(n + 1);
+        }
+};
+
+fakeBus bus;
+std::atomic<bool> holding{false}; // blockBus() has the bus.
+std::atomic<bool> release{false}; // Let blockBus() return.
+std::atomic<uint8_t> ended{0}; // Transactions whose done callback has run.
+
+void setUp(void)
+{
+    bus.reset();
+    holding = false;
+    release = false;
+    ended = 0;
+}
+
+void tearDown(void)
+{
+}
+
+// Call that keeps the bus until release is set, so that transactions pile up behind it.
+uint8_t blockBus(void*)
+{
+    holding = true;
+    while(!release) delay(1);
+    return I2C_OK;
+}
+
+void countEnded(amI2cTransaction*)
+{
+    ended++;
+}
+
+// Put a blocking call on a started queue and wait for it to reach the bus.
+void holdBus(amI2cQueue &queue, amI2cTransaction &blocker)
+{
+    memset(&blocker, 0, sizeof(blocker));
+    blocker.op = I2C_OP_CALL;
+    blocker.call = blockBus;
+    blocker.priority = I2C_PRIO_DIAG;
+    TEST_ASSERT_TRUE(queue.submit(&blocker));
+    while(!holding) delay(1);
+}
+
+// Probe of address at a priority, counted by countEnded() when it ends.
+void makeProbe(amI2cTransaction &t, uint8_t address, uint8_t priority, uint32_t timeoutUs = 0)
+{
+    memset(&t, 0, sizeof(t));
+    t.op = I2C_OP_PROBE;
+    t.address = address;
+    t.priority = priority;
+    t.timeoutUs = timeoutUs;
+    t.done = countEnded;
+}
+
+// Only the registered addresses on the bus asked for are probed, and each device knows whether it answered.
+void test_registry_probes_only_expected(void)
+{
+    amI2cRegistry registry;
+    amI2cDevice md25(I2C_DEV_MD25, 0, 0x58, "MD25");
+    amI2cDevice lcd(I2C_DEV_LCD, 0, 0x3F, "LCD");
+    amI2cDevice oled(I2C_DEV_OLED, 0, 0x3C, "OLED");
+    amI2cDevice imu(I2C_DEV_MPU6050, 1, 0x68, "MPU6050");
+    TEST_ASSERT_TRUE(registry.add(&md25));
+    TEST_ASSERT_TRUE(registry.add(&lcd));
+    TEST_ASSERT_TRUE(registry.add(&oled));
+    TEST_ASSERT_TRUE(registry.add(&imu));
+    bus.present[0x58] = true;
+    bus.present[0x3F] = true;
+    bus.present[0x68] = true; // Answers on this fake bus, but the MPU6050 is registered on bus 1.
+    TEST_ASSERT_EQUAL_UINT8(2, registry.probe(0, bus));
+    TEST_ASSERT_EQUAL_UINT16(3, bus.probes);
+    TEST_ASSERT_TRUE(md25.isPresent());
+    TEST_ASSERT_TRUE(lcd.isPresent());
+    TEST_ASSERT_FALSE(oled.isPresent());
+    TEST_ASSERT_EQUAL_UINT8(I2C_ERR_NACK_ADDR, oled.getStatus());
+    TEST_ASSERT_FALSE(imu.isPresent()); // Not probed yet.
+    TEST_ASSERT_TRUE(registry.find(1, 0x68) == &imu);
+    TEST_ASSERT_TRUE(registry.find(0, 0x68) == nullptr);
+}
+
+// Duplicates, reserved addresses and a full registry are refused.
+void test_registry_add_rejects(void)
+{
+    amI2cRegistry registry;
+    amI2cDevice a(I2C_DEV_LCD, 0, 0x3F, "a");
+    amI2cDevice same(I2C_DEV_LCD, 0, 0x3F, "same");
+    amI2cDevice otherBus(I2C_DEV_LCD, 1, 0x3F, "other bus");
+    amI2cDevice reserved(I2C_DEV_UNKNOWN, 0, 0x78, "reserved");
+    TEST_ASSERT_TRUE(registry.add(&a));
+    TEST_ASSERT_FALSE(registry.add(&same));
+    TEST_ASSERT_TRUE(registry.add(&otherBus));
+    TEST_ASSERT_FALSE(registry.add(&reserved));
+    TEST_ASSERT_FALSE(registry.add(nullptr));
+    amI2cDevice* filler[I2C_MAX_DEVICES];
+    uint8_t added = registry.getCount();
+    for(uint8_t i = 0; added < I2C_MAX_DEVICES; i++, added++)
+    {
+        filler[i] = new amI2cDevice(I2C_DEV_UNKNOWN, 2, 0x10 + i, "filler");
+        TEST_ASSERT_TRUE(registry.add(filler[i]));
+    }
+    amI2cDevice late(I2C_DEV_UNKNOWN, 2, 0x60, "late");
+    TEST_ASSERT_FALSE(registry.add(&late));
+    for(uint8_t i = 0; i < I2C_MAX_DEVICES - 2; i++) delete filler[i];
+}
+
+uint8_t sweepFound[8];
+amI2cDevice* sweepDevice[8];
+uint8_t sweepCount = 0;
+
+void onFound(uint8_t bus, uint8_t address, amI2cDevice* device, void* arg)
+{
+    TEST_ASSERT_EQUAL_UINT8(0, bus);
+    TEST_ASSERT_TRUE(arg == &sweepCount);
+    sweepFound[sweepCount] = address;
+    sweepDevice[sweepCount++] = device;
+}
+
+// A sweep tries every address from 0x08 to 0x77 and names the registered ones.
+void test_registry_sweep(void)
+{
+    amI2cRegistry registry;
+    amI2cDevice md25(I2C_DEV_MD25, 0, 0x58, "MD25");
+    amI2cDevice oled(I2C_DEV_OLED, 0, 0x3C, "OLED");
+    registry.add(&md25);
+    registry.add(&oled);
+    bus.present[0x58] = true;
+    bus.present[0x21] = true; // Not registered.
+    bus.present[0x05] = true; // Reserved. Never tried.
+    sweepCount = 0;
+    TEST_ASSERT_EQUAL_UINT8(2, registry.sweep(0, bus, onFound, &sweepCount));
+    TEST_ASSERT_EQUAL_UINT16(I2C_LAST_ADDRESS - I2C_FIRST_ADDRESS + 1, bus.probes);
+    TEST_ASSERT_EQUAL_UINT8(0x21, sweepFound[0]);
+    TEST_ASSERT_TRUE(sweepDevice[0] == nullptr);
+    TEST_ASSERT_EQUAL_UINT8(0x58, sweepFound[1]);
+    TEST_ASSERT_TRUE(sweepDevice[1] == &md25);
+    TEST_ASSERT_TRUE(md25.isPresent());
+    TEST_ASSERT_FALSE(oled.isPresent());
+}
+
+// Buckets are powers of two and percentiles are the top of the bucket, capped at the longest time seen.
+void test_histogram(void)
+{
+    TEST_ASSERT_EQUAL_UINT8(0, amLogHistogram::bucketOf(0));
+    TEST_ASSERT_EQUAL_UINT8(0, amLogHistogram::bucketOf(1));
+    TEST_ASSERT_EQUAL_UINT8(1, amLogHistogram::bucketOf(2));
+    TEST_ASSERT_EQUAL_UINT8(1, amLogHistogram::bucketOf(3));
+    TEST_ASSERT_EQUAL_UINT8(10, amLogHistogram::bucketOf(1024));
+    TEST_ASSERT_EQUAL_UINT8(HIST_BUCKETS - 1, amLogHistogram::bucketOf(4000000));
+    amLogHistogram h;
+    TEST_ASSERT_EQUAL_UINT32(0, h.getPercentileUs(50));
+    for(uint8_t i = 0; i < 99; i++) h.record(100); // Bucket 6, 64 to 127us.
+    h.record(5000); // Bucket 12.
+    TEST_ASSERT_EQUAL_UINT32(100, h.getCount());
+    TEST_ASSERT_EQUAL_UINT32(99, h.getBucket(6));
+    TEST_ASSERT_EQUAL_UINT32(127, h.getPercentileUs(50));
+    TEST_ASSERT_EQUAL_UINT32(127, h.getPercentileUs(99));
+    TEST_ASSERT_EQUAL_UINT32(5000, h.getPercentileUs(100)); // Top of bucket 12 is 8191, but nothing took that long.
+    TEST_ASSERT_EQUAL_UINT32(5000, h.getMaxUs());
+    h.reset();
+    TEST_ASSERT_EQUAL_UINT32(0, h.getCount());
+}
+
+// Before start() a port runs its transactions on the caller, so drivers work during early setup().
+void test_port_runs_inline_before_start(void)
+{
+    amI2cQueue queue(bus, "i2c");
+    amI2cPort port(queue, I2C_PRIO_NORMAL);
+    bus.present[0x58] = true;
+    uint8_t value[2] = {0, 0};
+    TEST_ASSERT_EQUAL_UINT8(I2C_OK, port.readRegs(0x58, 1, value, 2));
+    TEST_ASSERT_EQUAL_UINT8(0x22, value[0]);
+    TEST_ASSERT_EQUAL_UINT8(0x33, value[1]);
+    uint8_t write = 0x99;
+    TEST_ASSERT_EQUAL_UINT8(I2C_OK, port.writeRegs(0x58, 3, &write, 1));
+    TEST_ASSERT_EQUAL_UINT8(0x99, bus.regs[3]);
+    TEST_ASSERT_EQUAL_UINT8(I2C_ERR_NACK_ADDR, port.probe(0x20));
+    TEST_ASSERT_EQUAL_UINT32(3, queue.getDone(I2C_PRIO_NORMAL));
+    TEST_ASSERT_EQUAL_UINT32(1, queue.getErrors(I2C_PRIO_NORMAL));
+    TEST_ASSERT_EQUAL_UINT32(3, queue.getLatency(I2C_PRIO_NORMAL).getCount());
+}
+
+// Queued behind a busy bus, control goes first, then normal, display and diagnostics, each oldest first.
+void test_queue_priority_order(void)
+{
+    static amI2cQueue queue(bus, "i2c"); // Static since its worker outlives the test.
+    TEST_ASSERT_TRUE(queue.start(4096, 2, 1));
+    amI2cTransaction blocker;
+    holdBus(queue, blocker);
+    amI2cTransaction t[6];
+    makeProbe(t[0], 0x3F, I2C_PRIO_DISPLAY);
+    makeProbe(t[1], 0x10, I2C_PRIO_DIAG);
+    makeProbe(t[2], 0x58, I2C_PRIO_NORMAL);
+    makeProbe(t[3], 0x68, I2C_PRIO_CONTROL);
+    makeProbe(t[4], 0x3E, I2C_PRIO_DISPLAY);
+    makeProbe(t[5], 0x69, I2C_PRIO_CONTROL);
+    for(uint8_t i = 0; i < 6; i++) TEST_ASSERT_TRUE(queue.submit(&t[i]));
+    TEST_ASSERT_FALSE(queue.submit(&t[5])); // Already queued.
+    TEST_ASSERT_EQUAL_UINT8(6, queue.getQueued());
+    TEST_ASSERT_EQUAL_UINT8(I2C_PENDING, t[3].status);
+    release = true;
+    while(ended < 6) delay(1);
+    TEST_ASSERT_EQUAL_UINT8(6, bus.count.load());
+    const uint8_t expected[] = {0x68, 0x69, 0x58, 0x3F, 0x3E, 0x10};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, bus.log, 6);
+    TEST_ASSERT_EQUAL_UINT8(I2C_ERR_NACK_ADDR, t[3].status);
+    TEST_ASSERT_EQUAL_UINT8(0, queue.getQueued());
+    TEST_ASSERT_EQUAL_UINT8(6, queue.getMaxQueued());
+    TEST_ASSERT_EQUAL_UINT32(2, queue.getDone(I2C_PRIO_CONTROL));
+    TEST_ASSERT_EQUAL_UINT32(2, queue.getDone(I2C_PRIO_DIAG)); // The blocker and one probe.
+    TEST_ASSERT_TRUE(queue.getLatency(I2C_PRIO_DIAG).getMaxUs() > queue.getLatency(I2C_PRIO_CONTROL).getMaxUs());
+    TEST_ASSERT_TRUE(queue.getUtilization(micros()) > 0);
+}
+
+// A transaction that waits longer than its timeout ends without touching the bus. One without a timeout still runs.
+void test_queue_timeout(void)
+{
+    static amI2cQueue queue(bus, "i2c");
+    queue.start(4096, 2, 1);
+    amI2cTransaction blocker;
+    holdBus(queue, blocker);
+    amI2cTransaction late, patient;
+    makeProbe(late, 0x58, I2C_PRIO_NORMAL, 2000);
+    makeProbe(patient, 0x59, I2C_PRIO_NORMAL);
+    queue.submit(&late);
+    queue.submit(&patient);
+    delay(10);
+    release = true;
+    while(ended < 2) delay(1);
+    TEST_ASSERT_EQUAL_UINT8(I2C_ERR_TIMEOUT, late.status);
+    TEST_ASSERT_EQUAL_UINT8(I2C_ERR_NACK_ADDR, patient.status);
+    TEST_ASSERT_EQUAL_UINT8(1, bus.count.load()); // Only the patient probe.
+    TEST_ASSERT_EQUAL_UINT8(0x59, bus.log[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, queue.getTimeouts(I2C_PRIO_NORMAL));
+    amI2cAddressStats* s = queue.getMeter().find(0x58);
+    TEST_ASSERT_NOT_NULL(s);
+    TEST_ASSERT_EQUAL_UINT32(1, s->timeouts);
+    TEST_ASSERT_EQUAL_UINT32(0, s->transactions); // Never on the bus.
+}
+
+// A transaction still in the queue can be taken back. One that has ended cannot.
+void test_queue_cancel(void)
+{
+    static amI2cQueue queue(bus, "i2c");
+    queue.start(4096, 2, 1);
+    amI2cTransaction blocker;
+    holdBus(queue, blocker);
+    amI2cTransaction a, b, c;
+    makeProbe(a, 0x50, I2C_PRIO_NORMAL);
+    makeProbe(b, 0x51, I2C_PRIO_NORMAL);
+    makeProbe(c, 0x52, I2C_PRIO_NORMAL);
+    queue.submit(&a);
+    queue.submit(&b);
+    queue.submit(&c);
+    TEST_ASSERT_TRUE(queue.cancel(&b)); // From the middle of the list.
+    TEST_ASSERT_TRUE(queue.cancel(&c)); // From the end.
+    TEST_ASSERT_FALSE(queue.cancel(&c));
+    TEST_ASSERT_EQUAL_UINT8(I2C_ERR_TIMEOUT, b.status);
+    TEST_ASSERT_TRUE(queue.submit(&c)); // Can go again.
+    release = true;
+    while(ended < 2) delay(1);
+    TEST_ASSERT_EQUAL_UINT8(2, bus.count.load());
+    TEST_ASSERT_EQUAL_UINT8(0x50, bus.log[0]);
+    TEST_ASSERT_EQUAL_UINT8(0x52, bus.log[1]);
+    TEST_ASSERT_FALSE(queue.cancel(&a));
+    TEST_ASSERT_EQUAL_UINT32(2, queue.getCancelled()); // b and the first c.
+}
+
+// A port gives up on a bus it cannot get in time and takes its transaction back.
+void test_port_timeout(void)
+{
+    static amI2cQueue queue(bus, "i2c");
+    queue.start(4096, 2, 1);
+    amI2cPort port(queue, I2C_PRIO_CONTROL, 2000);
+    bus.present[0x68] = true;
+    amI2cTransaction blocker;
+    holdBus(queue, blocker);
+    uint32_t start = micros();
+    TEST_ASSERT_EQUAL_UINT8(I2C_ERR_TIMEOUT, port.probe(0x68));
+    TEST_ASSERT_TRUE(micros() - start >= 2000);
+    TEST_ASSERT_EQUAL_UINT32(1, queue.getCancelled());
+    release = true;
+    TEST_ASSERT_EQUAL_UINT8(I2C_OK, port.probe(0x68)); // Bus free again.
+    TEST_ASSERT_EQUAL_UINT8(1, bus.count.load());
+}
+
+// Each address is counted apart, failures by kind, and addresses past the table share its last slot.
+void test_meter_counts_per_address(void)
+{
+    amI2cMeter meter;
+    TEST_ASSERT_NULL(meter.find(0x58));
+    meter.record(0x58, 5, I2C_OK, 300);
+    meter.record(0x58, 5, I2C_ERR_NACK_DATA, 200);
+    meter.record(0x3F, 0, I2C_OK, 5000);
+    meter.record(0x3F, 1, I2C_ERR_NACK_ADDR, 100);
+    meter.record(0x3F, 1, I2C_ERR_TIMEOUT, 20000);
+    meter.record(0x3F, 1, I2C_ERR_OTHER, 10);
+    meter.expire(0x58);
+    TEST_ASSERT_EQUAL_UINT8(2, meter.getCount());
+    amI2cAddressStats* md25 = meter.find(0x58);
+    TEST_ASSERT_TRUE(md25 == meter.getStats(0));
+    TEST_ASSERT_EQUAL_UINT8(0x58, md25->address);
+    TEST_ASSERT_EQUAL_UINT32(2, md25->transactions);
+    TEST_ASSERT_EQUAL_UINT32(10, md25->bytes);
+    TEST_ASSERT_EQUAL_UINT32(1, md25->nacks);
+    TEST_ASSERT_EQUAL_UINT32(1, md25->timeouts);
+    TEST_ASSERT_EQUAL_UINT32(500, md25->busyUs);
+    TEST_ASSERT_EQUAL_UINT32(2, md25->time.getCount());
+    TEST_ASSERT_EQUAL_UINT32(1, md25->time.getBucket(8)); // 300us.
+    amI2cAddressStats* lcd = meter.find(0x3F);
+    TEST_ASSERT_EQUAL_UINT32(4, lcd->transactions);
+    TEST_ASSERT_EQUAL_UINT32(1, lcd->nacks);
+    TEST_ASSERT_EQUAL_UINT32(1, lcd->timeouts);
+    TEST_ASSERT_EQUAL_UINT32(1, lcd->errors);
+    TEST_ASSERT_EQUAL_UINT32(20000, lcd->time.getMaxUs());
+    for(uint8_t a = 0x10; meter.getCount() < I2C_METER_SLOTS - 1; a++) meter.record(a, 1, I2C_OK, 50);
+    meter.record(0x70, 1, I2C_OK, 50); // No slot of its own left.
+    meter.record(0x71, 1, I2C_OK, 50);
+    TEST_ASSERT_EQUAL_UINT8(I2C_METER_SLOTS, meter.getCount());
+    amI2cAddressStats* other = meter.find(0x70);
+    TEST_ASSERT_TRUE(other == meter.find(0x71));
+    TEST_ASSERT_EQUAL_UINT8(I2C_METER_OTHER, other->address);
+    TEST_ASSERT_EQUAL_UINT32(2, other->transactions);
+    TEST_ASSERT_EQUAL_UINT32(4, meter.find(0x3F)->transactions); // Untouched.
+    meter.reset();
+    TEST_ASSERT_EQUAL_UINT8(0, meter.getCount());
+    TEST_ASSERT_NULL(meter.find(0x70));
+}
+
+uint8_t lcdCall(void*)
+{
+    delay(2);
+    return I2C_OK;
+}
+
+// The queue charges every transaction to its address with the bytes it put on the bus, calls included.
+void test_queue_meters_transactions(void)
+{
+    amI2cQueue queue(bus, "i2c");
+    amI2cPort port(queue, I2C_PRIO_NORMAL);
+    bus.present[0x58] = true;
+    uint8_t value[2];
+    port.readRegs(0x58, 1, value, 2);
+    port.writeRegs(0x58, 1, value, 2);
+    port.probe(0x20);
+    TEST_ASSERT_EQUAL_UINT8(I2C_OK, port.call(0x3F, lcdCall, nullptr));
+    amI2cMeter &meter = queue.getMeter();
+    TEST_ASSERT_EQUAL_UINT8(3, meter.getCount());
+    amI2cAddressStats* md25 = meter.find(0x58);
+    TEST_ASSERT_EQUAL_UINT32(2, md25->transactions);
+    TEST_ASSERT_EQUAL_UINT32(5 + 4, md25->bytes); // Address, register, address, 2 bytes. Address, register, 2 bytes.
+    TEST_ASSERT_EQUAL_UINT32(1, meter.find(0x20)->nacks);
+    TEST_ASSERT_EQUAL_UINT32(1, meter.find(0x20)->bytes);
+    amI2cAddressStats* lcd = meter.find(0x3F);
+    TEST_ASSERT_EQUAL_UINT32(0, lcd->bytes); // Unknown for a call.
+    TEST_ASSERT_TRUE(lcd->busyUs >= 2000);
+    TEST_ASSERT_EQUAL_UINT32(queue.getBusyUs(), md25->busyUs + meter.find(0x20)->busyUs + lcd->busyUs);
+    queue.resetStats(micros());
+    TEST_ASSERT_EQUAL_UINT8(0, meter.getCount());
+}
+
+// Metering is cheap enough to leave on: a record costs well under 1us, here and on the ESP32.
+void test_meter_benchmark(void)
+{
+    static const uint32_t RECORDS = 200000;
+    static const uint8_t ADDRESSES[] = {0x58, 0x3F, 0x3C, 0x3D, 0x40, 0x68};
+    static const uint8_t STATUS[] = {I2C_OK, I2C_OK, I2C_OK, I2C_ERR_NACK_ADDR};
+    amI2cMeter meter;
+    amI2cTransaction t = {};
+    t.op = I2C_OP_READ;
+    uint32_t start = micros();
+    for(uint32_t i = 0; i < RECORDS; i++)
+    {
+        t.len = i & 7;
+        meter.record(ADDRESSES[i % sizeof(ADDRESSES)], amI2cQueue::wireBytes(&t), STATUS[i & 3], 100 + (i & 1023));
+    }
+    uint32_t elapsedUs = micros() - start;
+    uint32_t total = 0;
+    for(uint8_t i = 0; i < meter.getCount(); i++) total += meter.getStats(i)->transactions;
+    TEST_ASSERT_EQUAL_UINT32(RECORDS, total);
+    TEST_ASSERT_EQUAL_UINT8(sizeof(ADDRESSES), meter.getCount());
+    char text[96];
+    snprintf(text, sizeof(text), "%lu records in %lu us, %lu ns each", (unsigned long)RECORDS, (unsigned long)elapsedUs,
+             (unsigned long)((uint64_t)elapsedUs * 1000 / RECORDS));
+    TEST_MESSAGE(text);
+    TEST_ASSERT_TRUE((uint64_t)elapsedUs * 1000 / RECORDS < 1000);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_registry_probes_only_expected);
+    RUN_TEST(test_registry_add_rejects);
+    RUN_TEST(test_registry_sweep);
+    RUN_TEST(test_histogram);
+    RUN_TEST(test_port_runs_inline_before_start);
+    RUN_TEST(test_queue_priority_order);
+    RUN_TEST(test_queue_timeout);
+    RUN_TEST(test_queue_cancel);
+    RUN_TEST(test_port_timeout);
+    RUN_TEST(test_meter_counts_per_address);
+    RUN_TEST(test_queue_meters_transactions);
+    RUN_TEST(test_meter_benchmark);
+    return UNITY_END();
+}
+
+#ifndef ZIPPY_NATIVE
+void setup()
+{
+    delay(2000); // Give the board time to open the serial port.
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    int failures = runUnityTests();
+    hostStopTasks(); // Join the queue worker threads.
+    return failures;
+}
+#endif
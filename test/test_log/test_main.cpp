@@ -0,0 +1,152 @@
+// Host side tests and benchmark for the compile time log filter in include/logLevels.h.
+// A stand-in control cycle logs at verbose and trace with an argument that costs a read, like the encoder reads and ledcRead()
+// calls that used to sit in log arguments. With the run time level at notice the cycle is run with its module compiled at
+// verbose (filtered at run time, as before) and at notice (filtered at compile time) to show what the compile time filter saves.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <stdio.h>
+#include <logLevels.h>
+
+// native/Arduino.h defines ARDUINO for ArduinoLog, so the host is told apart by ZIPPY_NATIVE here.
+#ifndef ZIPPY_NATIVE
+#include <Arduino.h>
+uint64_t nowNs() { return (uint64_t)micros() * 1000; }
+#else
+#include <chrono>
+#include "../../native/hostArduino.cpp" // Host Arduino core for ArduinoLog. Tests do not build native/ on their own.
+uint64_t nowNs() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+#endif
+
+#define LOG_MOD_HOT_RUNTIME LOG_LEVEL_VERBOSE // Module compiled with every call in. Run time level does the filtering.
+#define LOG_MOD_HOT_COMPILED LOG_LEVEL_NOTICE // Module compiled with verbose and trace calls removed.
+
+// Counts the bytes logged.
+class countingPrint : public Print
+{
+    public:
+        size_t write(uint8_t) override { bytes++; return 1; }
+        uint32_t bytes = 0;
+};
+
+countingPrint sink; // Where the log goes.
+volatile uint32_t reads = 0; // Arguments evaluated. Stands in for an I2C transaction.
+
+int32_t readEncoder()
+{
+    reads = reads + 1;
+    return (int32_t)reads;
+}
+
+// One pass of a control loop with the logging a module like mobility.h has in it.
+template <int Module> uint32_t controlCycle(uint32_t i)
+{
+    LOG_TRACELN(Module, "<controlCycle> Start of cycle %l.", i);
+    uint32_t command = i * 2654435761u >> 24; // Stand-in for the control maths.
+    LOG_VERBOSELN(Module, "<controlCycle> Left encoder = %l, right encoder = %l, command = %d", readEncoder(), readEncoder(), command);
+    if(command == 0x100) // Never true. Keeps a notice call on the path without printing it.
+    {
+        LOG_NOTICELN(Module, "<controlCycle> Command out of range.");
+    }
+    return command;
+}
+
+void setUp(void)
+{
+    Log.begin(LOG_LEVEL_NOTICE, &sink, true);
+    sink.bytes = 0;
+    reads = 0;
+}
+
+void tearDown(void)
+{
+}
+
+void test_enabled_table(void)
+{
+    TEST_ASSERT_TRUE(LOG_ENABLED(LOG_LEVEL_NOTICE, LOG_LEVEL_ERROR));
+    TEST_ASSERT_TRUE(LOG_ENABLED(LOG_LEVEL_NOTICE, LOG_LEVEL_NOTICE));
+    TEST_ASSERT_FALSE(LOG_ENABLED(LOG_LEVEL_NOTICE, LOG_LEVEL_TRACE));
+    TEST_ASSERT_FALSE(LOG_ENABLED(LOG_LEVEL_SILENT, LOG_LEVEL_FATAL));
+    TEST_ASSERT_TRUE(LOG_ENABLED(LOG_LEVEL_VERBOSE, LOG_LEVEL_VERBOSE)); // Default LOG_LEVEL_MIN keeps everything.
+}
+
+void test_compiled_out_calls_skip_arguments(void)
+{
+    for(uint32_t i = 0; i < 100; i++)
+    {
+        controlCycle<LOG_MOD_HOT_COMPILED>(i);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, reads);
+    TEST_ASSERT_EQUAL_UINT32(0, sink.bytes);
+}
+
+void test_runtime_filtered_calls_still_evaluate_arguments(void)
+{
+    for(uint32_t i = 0; i < 100; i++)
+    {
+        controlCycle<LOG_MOD_HOT_RUNTIME>(i);
+    }
+    TEST_ASSERT_EQUAL_UINT32(200, reads); // Two reads per cycle for a line nobody sees.
+    TEST_ASSERT_EQUAL_UINT32(0, sink.bytes);
+}
+
+void test_enabled_calls_print(void)
+{
+    Log.setLevel(LOG_LEVEL_VERBOSE);
+    controlCycle<LOG_MOD_HOT_RUNTIME>(1);
+    TEST_ASSERT_EQUAL_UINT32(2, reads);
+    TEST_ASSERT_GREATER_THAN_UINT32(40, sink.bytes);
+    uint32_t before = sink.bytes;
+    LOG_WARNINGLN(LOG_MOD_HOT_COMPILED, "<test> Warnings pass a notice module.");
+    TEST_ASSERT_GREATER_THAN_UINT32(before, sink.bytes);
+}
+
+// Not a pass/fail test. Reports the cost of one control cycle with its logging filtered each way.
+template <int Module> float nsPerCycle()
+{
+    const uint32_t cycles = 1000000;
+    volatile uint32_t sum = 0;
+    uint64_t start = nowNs();
+    for(uint32_t i = 0; i < cycles; i++)
+    {
+        sum = sum + controlCycle<Module>(i);
+    }
+    return (float)(nowNs() - start) / cycles;
+}
+
+void test_benchmark_ns_per_cycle(void)
+{
+    float runtime = nsPerCycle<LOG_MOD_HOT_RUNTIME>();
+    float compiled = nsPerCycle<LOG_MOD_HOT_COMPILED>();
+    char msg[160];
+    snprintf(msg, sizeof(msg), "ns/cycle with verbose and trace filtered at run time %.1f, at compile time %.1f", runtime, compiled);
+    TEST_MESSAGE(msg);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_enabled_table);
+    RUN_TEST(test_compiled_out_calls_skip_arguments);
+    RUN_TEST(test_runtime_filtered_calls_still_evaluate_arguments);
+    RUN_TEST(test_enabled_calls_print);
+    RUN_TEST(test_benchmark_ns_per_cycle);
+    return UNITY_END();
+}
+
+#ifndef ZIPPY_NATIVE
+void setup()
+{
+    delay(2000); // service delay
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runUnityTests();
+}
+#endif
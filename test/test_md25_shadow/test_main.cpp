@@ -0,0 +1,309 @@
+// Host side tests for the MD25 register shadow. A scripted bus checks byte for byte which writes amMD25Driver still sends: values
+// the MD25 already holds are left off, changed neighbours go out as one auto-increment write, stop() always goes out and a failed
+// write is not trusted. Against the simulated MD25 with its watchdog on, a quiet bus makes the next write go out in full, and a
+// caller repeating the same speed keeps the watchdog fed. Two threads writing through their own drivers must never leave the
+// shadow claiming a value the MD25 does not hold. The workload test counts bus0 writes for a balance loop and motion engine with
+// and without the shadow.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <stdio.h>
+#include <mutex>
+#include <thread>
+#include <amSimScriptBus.h>
+#include <amSimBus.h>
+#include <amSimMD25.h>
+#include <amMD25Driver.h>
+#include <amMotion.h>
+
+amSimScriptBus script;
+uint32_t fakeMs = 0; // Clock handed to the shadows that need one.
+uint32_t fakeClock() { return fakeMs; }
+
+// amSimBus behind a lock, so two threads can share it.
+class lockedBus : public amI2cBus
+{
+    public:
+        lockedBus(amSimBus &bus) : _bus(bus) {}
+        uint8_t writeRegs(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t len)
+        {
+            std::lock_guard<std::mutex> hold(_lock);
+            return _bus.writeRegs(address, reg, data, len);
+        }
+        uint8_t readRegs(uint8_t address, uint8_t reg, uint8_t* dest, uint8_t len)
+        {
+            std::lock_guard<std::mutex> hold(_lock);
+            return _bus.readRegs(address, reg, dest, len);
+        }
+        uint8_t probe(uint8_t address)
+        {
+            std::lock_guard<std::mutex> hold(_lock);
+            return _bus.probe(address);
+        }
+    private:
+        amSimBus &_bus;
+        std::mutex _lock;
+};
+
+void setUp(void)
+{
+    script.clear();
+    fakeMs = 0;
+}
+
+void tearDown(void)
+{
+}
+
+// A value the MD25 already holds is not written again. A changed one is.
+void test_unchanged_writes_suppressed(void)
+{
+    amMD25Shadow shadow;
+    amMD25Driver md25(script, SIM_MD25_ADDRESS, &shadow);
+    script.expectWriteReg(SIM_MD25_ADDRESS, MD25RegMode, MD25ModeTurnUnsigned);
+    script.expectWriteReg(SIM_MD25_ADDRESS, MD25RegMode, MD25ModeUnsigned);
+    script.expectWriteReg(SIM_MD25_ADDRESS, MD25RegSpeed2, 140);
+    TEST_ASSERT_EQUAL(I2C_OK, md25.setMode(MD25ModeTurnUnsigned));
+    TEST_ASSERT_EQUAL(I2C_OK, md25.setMode(MD25ModeTurnUnsigned));
+    TEST_ASSERT_EQUAL(I2C_OK, md25.setMode(MD25ModeUnsigned));
+    TEST_ASSERT_EQUAL(I2C_OK, md25.setSpeed2(140));
+    TEST_ASSERT_EQUAL(I2C_OK, md25.setSpeed2(140));
+    TEST_ASSERT_TRUE(script.isDone());
+    TEST_ASSERT_EQUAL_MESSAGE(0, script.getFailures(), script.getFailure());
+    TEST_ASSERT_EQUAL_UINT32(2, shadow.getSuppressed());
+}
+
+// Neighbouring registers go out together, trimmed to the ones that changed.
+void test_adjacent_writes_coalesced(void)
+{
+    amMD25Shadow shadow;
+    amMD25Driver md25(script, SIM_MD25_ADDRESS, &shadow);
+    uint8_t both[2] = {150, 160};
+    uint8_t config[2] = {MD25AccelFastest, MD25ModeUnsigned};
+    script.expectWrite(SIM_MD25_ADDRESS, MD25RegSpeed1, both, 2);
+    script.expectWriteReg(SIM_MD25_ADDRESS, MD25RegSpeed2, 161); // Only speed2 changed.
+    script.expectWriteReg(SIM_MD25_ADDRESS, MD25RegSpeed1, 151); // Only speed1 changed.
+    script.expectWrite(SIM_MD25_ADDRESS, MD25RegMotorAccel, config, 2);
+    script.expectWriteReg(SIM_MD25_ADDRESS, MD25RegMode, MD25ModeTurnUnsigned); // Acceleration unchanged.
+    md25.setSpeeds(150, 160);
+    md25.setSpeeds(150, 161);
+    md25.setSpeeds(151, 161);
+    md25.setSpeeds(151, 161);
+    md25.setModeAndAcceleration(MD25ModeUnsigned, MD25AccelFastest);
+    md25.setModeAndAcceleration(MD25ModeTurnUnsigned, MD25AccelFastest);
+    md25.setAcceleration(MD25AccelFastest);
+    TEST_ASSERT_TRUE(script.isDone());
+    TEST_ASSERT_EQUAL_MESSAGE(0, script.getFailures(), script.getFailure());
+}
+
+// stop() goes out even when the shadow says the motors are stopped.
+void test_stop_always_sent(void)
+{
+    amMD25Shadow shadow;
+    amMD25Driver md25(script, SIM_MD25_ADDRESS, &shadow);
+    uint8_t stop[2] = {MD25SpeedStop, MD25SpeedStop};
+    script.expectWrite(SIM_MD25_ADDRESS, MD25RegSpeed1, stop, 2);
+    script.expectWrite(SIM_MD25_ADDRESS, MD25RegSpeed1, stop, 2);
+    md25.stop();
+    md25.setSpeeds(MD25SpeedStop, MD25SpeedStop); // Suppressed.
+    md25.stop();
+    TEST_ASSERT_TRUE(script.isDone());
+    TEST_ASSERT_EQUAL_MESSAGE(0, script.getFailures(), script.getFailure());
+}
+
+// A write that failed may or may not have reached the MD25, so the same value is sent again.
+void test_failed_write_not_trusted(void)
+{
+    amMD25Shadow shadow;
+    amMD25Driver md25(script, SIM_MD25_ADDRESS, &shadow);
+    script.expectWriteReg(SIM_MD25_ADDRESS, MD25RegSpeed1, 200);
+    script.expectWriteReg(SIM_MD25_ADDRESS, MD25RegSpeed1, 210, I2C_ERR_NACK_DATA);
+    script.expectWriteReg(SIM_MD25_ADDRESS, MD25RegSpeed1, 210);
+    TEST_ASSERT_EQUAL(I2C_OK, md25.setSpeed1(200));
+    TEST_ASSERT_EQUAL(I2C_ERR_NACK_DATA, md25.setSpeed1(210));
+    TEST_ASSERT_EQUAL(I2C_OK, md25.setSpeed1(210));
+    md25.setSpeed1(210); // Now known.
+    TEST_ASSERT_TRUE(script.isDone());
+    TEST_ASSERT_EQUAL_MESSAGE(0, script.getFailures(), script.getFailure());
+}
+
+// Drivers on different ports of the same MD25 share one shadow. Without one, every write goes out.
+void test_shared_between_drivers(void)
+{
+    amMD25Shadow shadow;
+    amMD25Driver loopSide(script, SIM_MD25_ADDRESS, &shadow);
+    amMD25Driver controlSide(script, SIM_MD25_ADDRESS, &shadow);
+    amMD25Driver plain(script, SIM_MD25_ADDRESS);
+    script.expectWriteReg(SIM_MD25_ADDRESS, MD25RegMode, MD25ModeUnsigned);
+    script.expectWriteReg(SIM_MD25_ADDRESS, MD25RegMode, MD25ModeUnsigned);
+    loopSide.setMode(MD25ModeUnsigned);
+    controlSide.setMode(MD25ModeUnsigned);
+    plain.setMode(MD25ModeUnsigned);
+    TEST_ASSERT_TRUE(script.isDone());
+    TEST_ASSERT_EQUAL_MESSAGE(0, script.getFailures(), script.getFailure());
+}
+
+// After a quiet spell long enough for the watchdog to stop the motors, the same speeds go out again and the motors restart.
+void test_resync_after_watchdog(void)
+{
+    amSimBus bus;
+    amSimMD25 sim;
+    sim.setWatchdog(true);
+    bus.attach(sim);
+    amMD25Shadow shadow(fakeClock);
+    amMD25Driver md25(bus, SIM_MD25_ADDRESS, &shadow);
+    md25.setSpeeds(200, 60);
+    fakeMs += 2500;
+    sim.advance(2500);
+    TEST_ASSERT_EQUAL_UINT32(1, sim.getWatchdogTrips());
+    TEST_ASSERT_EQUAL_UINT8(MD25SpeedStop, sim.getReg(MD25RegSpeed1));
+    bus.resetCounters();
+    md25.setSpeeds(200, 60);
+    TEST_ASSERT_EQUAL_UINT32(1, bus.getWrites());
+    TEST_ASSERT_EQUAL_UINT32(2, bus.getBytesWritten());
+    TEST_ASSERT_EQUAL_UINT8(200, sim.getReg(MD25RegSpeed1));
+    TEST_ASSERT_EQUAL_UINT8(60, sim.getReg(MD25RegSpeed2));
+    TEST_ASSERT_EQUAL_UINT32(1, shadow.getResyncs());
+    md25.setSpeeds(200, 60);
+    TEST_ASSERT_EQUAL_UINT32(1, bus.getWrites()); // Trusted again.
+}
+
+// A read after a quiet spell does not make old values trusted again.
+void test_read_after_quiet_does_not_trust(void)
+{
+    amSimBus bus;
+    amSimMD25 sim;
+    sim.setWatchdog(true);
+    bus.attach(sim);
+    amMD25Shadow shadow(fakeClock);
+    amMD25Driver md25(bus, SIM_MD25_ADDRESS, &shadow);
+    md25.setSpeeds(200, 200);
+    fakeMs += 3000;
+    sim.advance(3000);
+    md25Telemetry snapshot;
+    TEST_ASSERT_EQUAL(I2C_OK, md25.readTelemetrySnapshot(&snapshot));
+    bus.resetCounters();
+    md25.setSpeeds(200, 200);
+    TEST_ASSERT_EQUAL_UINT32(1, bus.getWrites());
+    TEST_ASSERT_EQUAL_UINT8(200, sim.getReg(MD25RegSpeed1));
+}
+
+// A caller that only ever repeats the same speed still talks to the MD25 often enough to keep the watchdog from firing.
+void test_repeated_speed_feeds_watchdog(void)
+{
+    amSimBus bus;
+    amSimMD25 sim;
+    sim.setWatchdog(true);
+    bus.attach(sim);
+    amMD25Shadow shadow(fakeClock);
+    amMD25Driver md25(bus, SIM_MD25_ADDRESS, &shadow);
+    for(uint32_t ms = 0; ms < 10000; ms += 100)
+    {
+        md25.setSpeeds(180, 180);
+        fakeMs += 100;
+        sim.advance(100);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, sim.getWatchdogTrips());
+    TEST_ASSERT_EQUAL_UINT8(180, sim.getReg(MD25RegSpeed1));
+    TEST_ASSERT_TRUE(bus.getWrites() <= 11); // About one a second instead of ten.
+}
+
+// Two threads write speed1 through their own drivers. Whenever the shadow claims a value, the MD25 must hold it.
+void test_concurrent_writers_never_wrong(void)
+{
+    amSimBus sim;
+    amSimMD25 md25;
+    sim.attach(md25);
+    lockedBus bus(sim);
+    amMD25Shadow shadow;
+    amMD25Driver a(bus, SIM_MD25_ADDRESS, &shadow);
+    amMD25Driver b(bus, SIM_MD25_ADDRESS, &shadow);
+    uint32_t wrong = 0;
+    for(int round = 0; round < 200; round++)
+    {
+        std::thread ta([&]() { for(int i = 0; i < 200; i++) a.setSpeed1((uint8_t)(100 + (i & 3))); });
+        std::thread tb([&]() { for(int i = 0; i < 200; i++) b.setSpeed1((uint8_t)(100 + ((i + 1) & 3))); });
+        ta.join();
+        tb.join();
+        for(int v = 0; v < 256; v++)
+        {
+            if(shadow.isCurrent(MD25RegSpeed1, (uint8_t)v) && md25.getReg(MD25RegSpeed1) != v)
+            {
+                wrong++;
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, wrong);
+}
+
+// Two seconds of bus0 MD25 traffic: the balance loop at 200 Hz sending speeds that settle and step, and loop() starting a
+// motion engine move every half second, each of which sets the mode again. Writes counted with and without a shadow.
+uint32_t runWorkload(amMD25Shadow* shadow)
+{
+    amSimBus bus;
+    amSimMD25 sim;
+    bus.attach(sim);
+    amMD25Driver md25(bus, SIM_MD25_ADDRESS, shadow);
+    amMotion motion(md25);
+    for(uint32_t ms = 0; ms < 2000; ms++)
+    {
+        sim.advance(1);
+        motion.tick(ms);
+        if(ms % 500 == 0 && motion.isBusy() == false)
+        {
+            motion.start({MOTION_BOTH, 150, 20, 0}, ms);
+        }
+        if(ms % 5 == 0)
+        {
+            uint32_t cycle = ms / 5;
+            uint8_t command = (uint8_t)(128 + ((cycle / 40) % 3) * 4); // Holds for 40 cycles, then steps.
+            uint8_t steer = (cycle % 80 < 20) ? 2 : 0; // Turns now and then.
+            md25.setSpeeds(command - steer, command + steer);
+        }
+    }
+    return bus.getWrites();
+}
+
+void test_workload_transaction_counts(void)
+{
+    amMD25Shadow shadow;
+    uint32_t before = runWorkload(nullptr);
+    uint32_t after = runWorkload(&shadow);
+    char msg[128];
+    snprintf(msg, sizeof(msg), "MD25 writes without shadow: %lu, with shadow: %lu, register writes suppressed: %lu", (unsigned long)before,
+             (unsigned long)after, (unsigned long)shadow.getSuppressed());
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(after * 4 < before);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_unchanged_writes_suppressed);
+    RUN_TEST(test_adjacent_writes_coalesced);
+    RUN_TEST(test_stop_always_sent);
+    RUN_TEST(test_failed_write_not_trusted);
+    RUN_TEST(test_shared_between_drivers);
+    RUN_TEST(test_resync_after_watchdog);
+    RUN_TEST(test_read_after_quiet_does_not_trust);
+    RUN_TEST(test_repeated_speed_feeds_watchdog);
+    RUN_TEST(test_concurrent_writers_never_wrong);
+    RUN_TEST(test_workload_transaction_counts);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+    delay(2000); // Give the board time to open the serial port.
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main(void)
+{
+    return runUnityTests();
+}
+#endif
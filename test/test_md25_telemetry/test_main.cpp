@@ -0,0 +1,146 @@
+// Host side tests for amMD25Driver::readTelemetrySnapshot() against a simulated MD25 register map and fixed register bytes.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <amSimBus.h>
+#include <amSimMD25.h>
+#include <amSimScriptBus.h>
+#include <amMD25Driver.h>
+
+amSimBus bus;
+amSimMD25* sim;
+amMD25Driver* md25;
+
+void setUp(void)
+{
+    bus = amSimBus();
+    sim = new amSimMD25();
+    bus.attach(*sim);
+    md25 = new amMD25Driver(bus, SIM_MD25_ADDRESS);
+}
+
+void tearDown(void)
+{
+    delete md25;
+    delete sim;
+}
+
+// Spin motor1 forward and motor2 backward so the encoders hold different values.
+void spinApart(uint32_t ms)
+{
+    md25->setMode(MD25ModeUnsigned);
+    md25->setSpeeds(200, 60);
+    sim->advance(ms);
+    md25->stop();
+}
+
+void test_snapshot_decodes_every_field(void)
+{
+    spinApart(50);
+    sim->setBatteryVolts(118);
+    sim->setMotorCurrents(14, 23);
+    md25Telemetry snapshot = {0, 0, 0, 0, 0};
+    TEST_ASSERT_EQUAL(I2C_OK, md25->readTelemetrySnapshot(&snapshot));
+    TEST_ASSERT_EQUAL_INT32(sim->getEncoder(MD25_MOTOR1), snapshot.encoder1);
+    TEST_ASSERT_EQUAL_INT32(sim->getEncoder(MD25_MOTOR2), snapshot.encoder2);
+    TEST_ASSERT_EQUAL_UINT8(118, snapshot.batteryVolts);
+    TEST_ASSERT_EQUAL_UINT8(14, snapshot.motorCurrent1);
+    TEST_ASSERT_EQUAL_UINT8(23, snapshot.motorCurrent2);
+}
+
+void test_snapshot_handles_negative_counts(void)
+{
+    spinApart(50);
+    md25Telemetry snapshot;
+    md25->readTelemetrySnapshot(&snapshot);
+    TEST_ASSERT_GREATER_THAN(0, snapshot.encoder1);
+    TEST_ASSERT_LESS_THAN(0, snapshot.encoder2);
+}
+
+void test_snapshot_is_one_transaction(void)
+{
+    md25Telemetry snapshot;
+    bus.resetCounters();
+    md25->readTelemetrySnapshot(&snapshot);
+    TEST_ASSERT_EQUAL_UINT32(1, bus.getTransactions());
+    TEST_ASSERT_EQUAL_UINT32(1, bus.getReads());
+    TEST_ASSERT_EQUAL_UINT32(MD25_TELEMETRY_LEN, bus.getBytesRead());
+}
+
+void test_snapshot_cuts_transactions_fivefold(void)
+{
+    int32_t ticks;
+    uint8_t value;
+    bus.resetCounters();
+    md25->readEncoder(MD25_MOTOR1, &ticks); // The way mobility.h used to read everything.
+    md25->readEncoder(MD25_MOTOR2, &ticks);
+    bus.readRegs(SIM_MD25_ADDRESS, MD25RegBatteryVolts, &value, 1);
+    bus.readRegs(SIM_MD25_ADDRESS, MD25RegMotorCur1, &value, 1);
+    bus.readRegs(SIM_MD25_ADDRESS, MD25RegMotorCur2, &value, 1);
+    uint32_t separate = bus.getTransactions();
+    md25Telemetry snapshot;
+    bus.resetCounters();
+    md25->readTelemetrySnapshot(&snapshot);
+    TEST_ASSERT_EQUAL_UINT32(5 * bus.getTransactions(), separate);
+}
+
+// Fixed register bytes, so every field must come from its own offset. Encoder2 is negative and must be sign extended.
+void test_snapshot_decodes_register_offsets(void)
+{
+    amSimScriptBus script;
+    amMD25Driver scripted(script, SIM_MD25_ADDRESS);
+    const uint8_t reply[MD25_TELEMETRY_LEN] = {0x00, 0x01, 0x02, 0x03, // Encoder1 = 66051, most significant byte first.
+                                               0xFF, 0xFF, 0xFE, 0x0C, // Encoder2 = -500.
+                                               0x76, 0x0E, 0x17}; // 11.8 V, then motor1 and motor2 currents.
+    script.expectRead(SIM_MD25_ADDRESS, MD25RegEncoder1a, reply, MD25_TELEMETRY_LEN);
+    md25Telemetry snapshot = {0, 0, 0, 0, 0};
+    TEST_ASSERT_EQUAL(I2C_OK, scripted.readTelemetrySnapshot(&snapshot));
+    TEST_ASSERT_EQUAL_UINT32(0, script.getFailures());
+    TEST_ASSERT_TRUE(script.isDone());
+    TEST_ASSERT_EQUAL_INT32(66051, snapshot.encoder1);
+    TEST_ASSERT_EQUAL_INT32(-500, snapshot.encoder2);
+    TEST_ASSERT_EQUAL_UINT8(118, snapshot.batteryVolts);
+    TEST_ASSERT_EQUAL_UINT8(14, snapshot.motorCurrent1);
+    TEST_ASSERT_EQUAL_UINT8(23, snapshot.motorCurrent2);
+}
+
+void test_missing_controller_leaves_snapshot_untouched(void)
+{
+    amMD25Driver absent(bus, SIM_MD25_ADDRESS + 1);
+    md25Telemetry snapshot = {7, 8, 9, 10, 11};
+    TEST_ASSERT_EQUAL(I2C_ERR_NACK_ADDR, absent.readTelemetrySnapshot(&snapshot));
+    TEST_ASSERT_EQUAL_INT32(7, snapshot.encoder1);
+    TEST_ASSERT_EQUAL_INT32(8, snapshot.encoder2);
+    TEST_ASSERT_EQUAL_UINT8(9, snapshot.batteryVolts);
+    TEST_ASSERT_EQUAL_UINT8(10, snapshot.motorCurrent1);
+    TEST_ASSERT_EQUAL_UINT8(11, snapshot.motorCurrent2);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_snapshot_decodes_every_field);
+    RUN_TEST(test_snapshot_handles_negative_counts);
+    RUN_TEST(test_snapshot_is_one_transaction);
+    RUN_TEST(test_snapshot_cuts_transactions_fivefold);
+    RUN_TEST(test_snapshot_decodes_register_offsets);
+    RUN_TEST(test_missing_controller_leaves_snapshot_untouched);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+void setup()
+{
+    delay(2000); // service delay
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runUnityTests();
+}
+#endif
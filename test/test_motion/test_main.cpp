@@ -0,0 +1,192 @@
+// Host side tests for the amMotion engine against a simulated MD25 register map.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <amSimBus.h>
+#include <amSimMD25.h>
+#include <amMD25Driver.h>
+#include <amMotion.h>
+
+amSimBus bus;
+amSimMD25* sim;
+amMD25Driver* md25;
+amMotion* motion;
+uint32_t now;
+int callbacks;
+motionResult lastResult;
+
+void onDone(const motionResult &result)
+{
+    callbacks++;
+    lastResult = result;
+}
+
+// Step the simulated MD25 and the engine together 1 ms at a time.
+motionState runFor(uint32_t ms)
+{
+    for(uint32_t i = 0; i < ms; i++)
+    {
+        now++;
+        sim->advance(1);
+        motion->tick(now);
+    }
+    return motion->getState();
+}
+
+void setUp(void)
+{
+    bus = amSimBus();
+    sim = new amSimMD25();
+    bus.attach(*sim);
+    md25 = new amMD25Driver(bus, SIM_MD25_ADDRESS);
+    motion = new amMotion(*md25);
+    motion->onComplete(onDone);
+    now = 1000;
+    callbacks = 0;
+    lastResult = {MOTION_IDLE, 0, 0, 0, I2C_OK};
+}
+
+void tearDown(void)
+{
+    delete motion;
+    delete md25;
+    delete sim;
+}
+
+void test_start_returns_without_blocking(void)
+{
+    motionGoal goal = {MOTION_BOTH, 180, 100, 0};
+    TEST_ASSERT_TRUE(motion->start(goal, now));
+    TEST_ASSERT_EQUAL(MOTION_RUNNING, motion->getState());
+    TEST_ASSERT_TRUE(motion->isBusy());
+    TEST_ASSERT_EQUAL(MD25ModeTurnUnsigned, sim->getReg(MD25RegMode));
+    TEST_ASSERT_EQUAL(180, sim->getReg(MD25RegSpeed1));
+    TEST_ASSERT_EQUAL(MD25SpeedStop, sim->getReg(MD25RegSpeed2));
+    TEST_ASSERT_EQUAL(0, callbacks);
+}
+
+void test_both_motors_reach_distance(void)
+{
+    motionGoal goal = {MOTION_BOTH, 180, 100, 0};
+    motion->start(goal, now);
+    TEST_ASSERT_EQUAL(MOTION_DONE, runFor(1000));
+    TEST_ASSERT_EQUAL(1, callbacks);
+    TEST_ASSERT_EQUAL(MOTION_DONE, lastResult.state);
+    TEST_ASSERT_GREATER_OR_EQUAL(100, lastResult.leftTicks);
+    TEST_ASSERT_GREATER_OR_EQUAL(100, lastResult.rightTicks);
+    TEST_ASSERT_EQUAL(0, sim->getMotorCommand(MD25_MOTOR1)); // Stopped.
+    TEST_ASSERT_EQUAL(0, sim->getMotorCommand(MD25_MOTOR2));
+}
+
+void test_overshoot_bounded_by_poll_interval(void)
+{
+    motionGoal goal = {MOTION_BOTH, 180, 100, 0};
+    motion->setSettleTime(0);
+    motion->start(goal, now);
+    runFor(1000);
+    // 52 units * 8 ticks/s/unit = 416 ticks/s, so one 10 ms poll interval is ~4 ticks.
+    TEST_ASSERT_INT_WITHIN(5, 100, lastResult.leftTicks);
+}
+
+void test_single_motor_holds_other_stopped(void)
+{
+    motionGoal goal = {MOTION_RIGHT, 200, 50, 0};
+    motion->start(goal, now);
+    TEST_ASSERT_EQUAL(MD25ModeUnsigned, sim->getReg(MD25RegMode));
+    TEST_ASSERT_EQUAL(0, sim->getMotorCommand(MD25_MOTOR1));
+    TEST_ASSERT_EQUAL(MOTION_DONE, runFor(1000));
+    TEST_ASSERT_EQUAL(0, lastResult.leftTicks);
+    TEST_ASSERT_GREATER_OR_EQUAL(50, lastResult.rightTicks);
+}
+
+void test_reverse_goal_counts_down(void)
+{
+    motionGoal goal = {MOTION_LEFT, 60, 80, 0};
+    motion->start(goal, now);
+    TEST_ASSERT_EQUAL(MOTION_DONE, runFor(1000));
+    TEST_ASSERT_LESS_OR_EQUAL(-80, lastResult.leftTicks);
+}
+
+void test_stalled_wheels_time_out_and_stop(void)
+{
+    sim->setTicksPerUnit(0);
+    motionGoal goal = {MOTION_BOTH, 180, 100, 500};
+    motion->start(goal, now);
+    TEST_ASSERT_EQUAL(MOTION_SETTLING, runFor(505));
+    TEST_ASSERT_EQUAL(MD25SpeedStop, sim->getReg(MD25RegSpeed1));
+    TEST_ASSERT_EQUAL(MOTION_TIMEOUT, runFor(200));
+    TEST_ASSERT_EQUAL(1, callbacks);
+    TEST_ASSERT_EQUAL(MOTION_TIMEOUT, lastResult.state);
+}
+
+void test_encoder_polled_at_interval(void)
+{
+    motionGoal goal = {MOTION_BOTH, 129, 100000, 0};
+    motion->start(goal, now);
+    bus.resetCounters();
+    runFor(100); // tick() called 100 times.
+    TEST_ASSERT_EQUAL(10, bus.getReads());
+}
+
+void test_second_goal_rejected_while_busy(void)
+{
+    motionGoal goal = {MOTION_BOTH, 180, 100, 0};
+    TEST_ASSERT_TRUE(motion->start(goal, now));
+    TEST_ASSERT_FALSE(motion->start(goal, now));
+    runFor(1000);
+    TEST_ASSERT_TRUE(motion->start(goal, now));
+}
+
+void test_abort_stops_motors(void)
+{
+    motionGoal goal = {MOTION_BOTH, 180, 100000, 0};
+    motion->start(goal, now);
+    runFor(50);
+    motion->abort(now);
+    TEST_ASSERT_EQUAL(0, sim->getMotorCommand(MD25_MOTOR1));
+    TEST_ASSERT_EQUAL(MOTION_ABORTED, runFor(200));
+}
+
+void test_missing_controller_faults(void)
+{
+    amSimBus emptyBus;
+    amMD25Driver absent(emptyBus, SIM_MD25_ADDRESS);
+    amMotion engine(absent);
+    motionGoal goal = {MOTION_BOTH, 180, 100, 0};
+    TEST_ASSERT_FALSE(engine.start(goal, now));
+    TEST_ASSERT_EQUAL(MOTION_FAULT, engine.getState());
+    TEST_ASSERT_EQUAL(I2C_ERR_NACK_ADDR, engine.getResult().busStatus);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_start_returns_without_blocking);
+    RUN_TEST(test_both_motors_reach_distance);
+    RUN_TEST(test_overshoot_bounded_by_poll_interval);
+    RUN_TEST(test_single_motor_holds_other_stopped);
+    RUN_TEST(test_reverse_goal_counts_down);
+    RUN_TEST(test_stalled_wheels_time_out_and_stop);
+    RUN_TEST(test_encoder_polled_at_interval);
+    RUN_TEST(test_second_goal_rejected_while_busy);
+    RUN_TEST(test_abort_stops_motors);
+    RUN_TEST(test_missing_controller_faults);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+void setup()
+{
+    delay(2000); // service delay
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runUnityTests();
+}
+#endif
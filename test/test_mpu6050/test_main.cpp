@@ -0,0 +1,254 @@
+// Host side tests for the amMPU6050 register protocol against a scripted I2C bus.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <amSimScriptBus.h>
+#include <amSimBus.h>
+#include <amSimMPU6050.h>
+#include <amMPU6050.h>
+
+amSimScriptBus bus;
+amMPU6050* imu;
+
+// Build the 14 FIFO bytes for a sample whose fields all start at base and count up by one.
+void makeSample(uint8_t* raw, int16_t base)
+{
+    for(int i = 0; i < 7; i++)
+    {
+        int16_t value = base + i;
+        raw[i * 2] = (uint8_t)((uint16_t)value >> 8);
+        raw[i * 2 + 1] = (uint8_t)value;
+    }
+}
+
+void expectFifoCount(uint16_t bytes)
+{
+    uint8_t count[2] = {(uint8_t)(bytes >> 8), (uint8_t)bytes};
+    bus.expectRead(MPU6050_ADDRESS, MPU6050RegFifoCountH, count, 2);
+}
+
+// Queue a FIFO burst holding samples first..first+n-1. Sample k has base value k * 10.
+void expectBurst(uint16_t first, uint16_t n)
+{
+    uint8_t raw[MPU6050_BURST_SAMPLES * MPU6050_SAMPLE_LEN];
+    for(uint16_t i = 0; i < n; i++)
+    {
+        makeSample(&raw[i * MPU6050_SAMPLE_LEN], (int16_t)((first + i) * 10));
+    }
+    bus.expectRead(MPU6050_ADDRESS, MPU6050RegFifoRW, raw, n * MPU6050_SAMPLE_LEN);
+}
+
+void setUp(void)
+{
+    bus.clear();
+    imu = new amMPU6050(bus);
+}
+
+void tearDown(void)
+{
+    delete imu;
+}
+
+void assertScriptPlayed(void)
+{
+    TEST_ASSERT_EQUAL_MESSAGE(0, bus.getFailures(), bus.getFailure());
+    TEST_ASSERT_TRUE_MESSAGE(bus.isDone(), "driver stopped before the end of the script");
+}
+
+void test_begin_configures_fifo_and_interrupt(void)
+{
+    uint8_t id = MPU6050WhoAmI;
+    uint8_t config[4] = {0, MPU6050_DLPF_44HZ, MPU6050_GYRO_500DPS << 3, MPU6050_ACCEL_4G << 3};
+    uint8_t interrupts[2] = {0x00, MPU6050IntDataReady};
+    bus.expectRead(MPU6050_ADDRESS, MPU6050RegWhoAmI, &id, 1);
+    bus.expectWriteReg(MPU6050_ADDRESS, MPU6050RegPwrMgmt1, MPU6050ClockPllGyroX);
+    bus.expectWrite(MPU6050_ADDRESS, MPU6050RegSmplrtDiv, config, 4);
+    bus.expectWriteReg(MPU6050_ADDRESS, MPU6050RegFifoEn, MPU6050FifoSensors);
+    bus.expectWrite(MPU6050_ADDRESS, MPU6050RegIntPinCfg, interrupts, 2);
+    bus.expectWriteReg(MPU6050_ADDRESS, MPU6050RegUserCtrl, MPU6050UserFifoReset);
+    bus.expectWriteReg(MPU6050_ADDRESS, MPU6050RegUserCtrl, MPU6050UserFifoEnable);
+    TEST_ASSERT_EQUAL(I2C_OK, imu->begin(MPU6050_DLPF_44HZ, 0, MPU6050_GYRO_500DPS, MPU6050_ACCEL_4G));
+    assertScriptPlayed();
+    TEST_ASSERT_EQUAL_FLOAT(65.5f, imu->getGyroLsbPerDps());
+    TEST_ASSERT_EQUAL_FLOAT(8192.0f, imu->getAccelLsbPerG());
+}
+
+void test_begin_rejects_wrong_chip(void)
+{
+    uint8_t id = 0x72; // Something else at 0x68.
+    bus.expectRead(MPU6050_ADDRESS, MPU6050RegWhoAmI, &id, 1);
+    TEST_ASSERT_EQUAL(MPU6050_ERR_ID, imu->begin(MPU6050_DLPF_44HZ, 0, MPU6050_GYRO_250DPS, MPU6050_ACCEL_2G));
+    assertScriptPlayed();
+}
+
+void test_begin_reports_missing_chip(void)
+{
+    uint8_t id = 0;
+    bus.expectRead(MPU6050_ADDRESS, MPU6050RegWhoAmI, &id, 1, I2C_ERR_NACK_ADDR);
+    TEST_ASSERT_EQUAL(I2C_ERR_NACK_ADDR, imu->begin(MPU6050_DLPF_44HZ, 0, MPU6050_GYRO_250DPS, MPU6050_ACCEL_2G));
+    assertScriptPlayed();
+}
+
+void test_empty_fifo_costs_one_transaction(void)
+{
+    mpu6050Sample samples[4];
+    uint16_t count = 99;
+    expectFifoCount(0);
+    TEST_ASSERT_EQUAL(I2C_OK, imu->drainFifo(samples, 4, &count));
+    TEST_ASSERT_EQUAL_UINT16(0, count);
+    assertScriptPlayed();
+}
+
+void test_drain_reads_whole_samples_in_bursts(void)
+{
+    mpu6050Sample samples[20];
+    uint16_t count;
+    expectFifoCount(10 * MPU6050_SAMPLE_LEN + 5); // Ten samples and part of an eleventh.
+    expectBurst(0, MPU6050_BURST_SAMPLES);
+    expectBurst(MPU6050_BURST_SAMPLES, 10 - MPU6050_BURST_SAMPLES);
+    TEST_ASSERT_EQUAL(I2C_OK, imu->drainFifo(samples, 20, &count));
+    assertScriptPlayed();
+    TEST_ASSERT_EQUAL_UINT16(10, count);
+    for(uint16_t k = 0; k < count; k++)
+    {
+        TEST_ASSERT_EQUAL_INT16(k * 10, samples[k].accelX);
+        TEST_ASSERT_EQUAL_INT16(k * 10 + 3, samples[k].temp);
+        TEST_ASSERT_EQUAL_INT16(k * 10 + 6, samples[k].gyroZ);
+    }
+}
+
+void test_drain_stops_at_caller_limit(void)
+{
+    mpu6050Sample samples[3];
+    uint16_t count;
+    expectFifoCount(6 * MPU6050_SAMPLE_LEN);
+    expectBurst(0, 3);
+    TEST_ASSERT_EQUAL(I2C_OK, imu->drainFifo(samples, 3, &count));
+    assertScriptPlayed();
+    TEST_ASSERT_EQUAL_UINT16(3, count);
+}
+
+void test_negative_values_unpack(void)
+{
+    mpu6050Sample samples[1];
+    uint16_t count;
+    expectFifoCount(MPU6050_SAMPLE_LEN);
+    uint8_t raw[MPU6050_SAMPLE_LEN];
+    makeSample(raw, -3); // -3, -2, -1, 0, 1, 2, 3.
+    bus.expectRead(MPU6050_ADDRESS, MPU6050RegFifoRW, raw, MPU6050_SAMPLE_LEN);
+    imu->drainFifo(samples, 1, &count);
+    assertScriptPlayed();
+    TEST_ASSERT_EQUAL_INT16(-3, samples[0].accelX);
+    TEST_ASSERT_EQUAL_INT16(-1, samples[0].accelZ);
+    TEST_ASSERT_EQUAL_INT16(3, samples[0].gyroZ);
+}
+
+void test_overflow_resets_fifo(void)
+{
+    mpu6050Sample samples[4];
+    uint16_t count;
+    expectFifoCount(MPU6050_FIFO_SIZE);
+    bus.expectWriteReg(MPU6050_ADDRESS, MPU6050RegUserCtrl, MPU6050UserFifoReset);
+    bus.expectWriteReg(MPU6050_ADDRESS, MPU6050RegUserCtrl, MPU6050UserFifoEnable);
+    TEST_ASSERT_EQUAL(MPU6050_ERR_OVERFLOW, imu->drainFifo(samples, 4, &count));
+    assertScriptPlayed();
+    TEST_ASSERT_EQUAL_UINT16(0, count);
+    TEST_ASSERT_EQUAL_UINT32(1, imu->getOverflows());
+}
+
+void test_bus_error_mid_drain_keeps_earlier_samples(void)
+{
+    mpu6050Sample samples[12];
+    uint16_t count;
+    uint8_t junk[4 * MPU6050_SAMPLE_LEN] = {0};
+    expectFifoCount(12 * MPU6050_SAMPLE_LEN);
+    expectBurst(0, MPU6050_BURST_SAMPLES);
+    bus.expectRead(MPU6050_ADDRESS, MPU6050RegFifoRW, junk, 4 * MPU6050_SAMPLE_LEN, I2C_ERR_TIMEOUT);
+    TEST_ASSERT_EQUAL(I2C_ERR_TIMEOUT, imu->drainFifo(samples, 12, &count));
+    assertScriptPlayed();
+    TEST_ASSERT_EQUAL_UINT16(MPU6050_BURST_SAMPLES, count);
+}
+
+void test_read_sample_is_one_14_byte_burst(void)
+{
+    mpu6050Sample sample;
+    uint8_t raw[MPU6050_SAMPLE_LEN];
+    makeSample(raw, 1000);
+    bus.expectRead(MPU6050_ADDRESS, MPU6050RegAccelXoutH, raw, MPU6050_SAMPLE_LEN);
+    TEST_ASSERT_EQUAL(I2C_OK, imu->readSample(&sample));
+    assertScriptPlayed();
+    TEST_ASSERT_EQUAL_INT16(1000, sample.accelX);
+    TEST_ASSERT_EQUAL_INT16(1004, sample.gyroX);
+}
+
+void test_script_catches_wrong_register(void)
+{
+    uint8_t reply = 0;
+    bus.expectRead(MPU6050_ADDRESS, MPU6050RegIntStatus, &reply, 1);
+    uint16_t count;
+    TEST_ASSERT_EQUAL(I2C_ERR_OTHER, imu->readFifoCount(&count)); // Not what the script expected.
+    TEST_ASSERT_EQUAL(1, bus.getFailures());
+    TEST_ASSERT_FALSE(bus.isDone());
+}
+
+// End to end against the simulated chip used by the host firmware build rather than a script.
+void test_driver_against_simulated_chip(void)
+{
+    amSimBus simBus;
+    amSimMPU6050 chip;
+    simBus.attach(chip);
+    amMPU6050 driver(simBus);
+    TEST_ASSERT_EQUAL_UINT8(0, chip.advance(5000)); // Asleep until begin().
+    TEST_ASSERT_EQUAL_UINT8(I2C_OK, driver.begin(MPU6050_DLPF_44HZ, 0, MPU6050_GYRO_500DPS, MPU6050_ACCEL_4G));
+    TEST_ASSERT_EQUAL_UINT32(1000, chip.getSampleRateHz());
+    chip.setMotion(0.5f, 0.0f, 1.0f, 0.0f, -10.0f, 0.0f);
+    TEST_ASSERT_EQUAL_UINT16(5, chip.advance(5000));
+    mpu6050Sample samples[8];
+    uint16_t count = 0;
+    TEST_ASSERT_EQUAL_UINT8(I2C_OK, driver.drainFifo(samples, 8, &count));
+    TEST_ASSERT_EQUAL_UINT16(5, count);
+    TEST_ASSERT_EQUAL_INT16(4096, samples[4].accelX);
+    TEST_ASSERT_EQUAL_INT16(8192, samples[4].accelZ);
+    TEST_ASSERT_EQUAL_INT16(-655, samples[4].gyroY);
+    TEST_ASSERT_EQUAL_UINT16(0, chip.getFifoCount());
+    chip.advance(100000); // 100 samples is more than the FIFO holds.
+    TEST_ASSERT_EQUAL_UINT16(MPU6050_FIFO_SIZE, chip.getFifoCount());
+    TEST_ASSERT_EQUAL_UINT8(MPU6050_ERR_OVERFLOW, driver.drainFifo(samples, 8, &count));
+    TEST_ASSERT_EQUAL_UINT16(0, chip.getFifoCount());
+    TEST_ASSERT_EQUAL_UINT32(1, driver.getOverflows());
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_configures_fifo_and_interrupt);
+    RUN_TEST(test_begin_rejects_wrong_chip);
+    RUN_TEST(test_begin_reports_missing_chip);
+    RUN_TEST(test_empty_fifo_costs_one_transaction);
+    RUN_TEST(test_drain_reads_whole_samples_in_bursts);
+    RUN_TEST(test_drain_stops_at_caller_limit);
+    RUN_TEST(test_negative_values_unpack);
+    RUN_TEST(test_overflow_resets_fifo);
+    RUN_TEST(test_bus_error_mid_drain_keeps_earlier_samples);
+    RUN_TEST(test_read_sample_is_one_14_byte_burst);
+    RUN_TEST(test_script_catches_wrong_register);
+    RUN_TEST(test_driver_against_simulated_chip);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+void setup()
+{
+    delay(2000); // service delay
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runUnityTests();
+}
+#endif
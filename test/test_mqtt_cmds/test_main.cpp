@@ -0,0 +1,122 @@
+// Host side tests for the commands of include/mqttBroker.h, run through processCmd() as checkMqtt() runs them.
+// The firmware headers are built here against the host shims, with a simulated MD25 behind Wire, so BALANCE really asks the
+// MD25 for the balance loop's mode and PATH really fills the trajectory queue of the balance loop. Host only, the board has a
+// real MD25 on its bus.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+
+#ifdef ZIPPY_NATIVE
+#include <main.h>
+#include <amSimBus.h>
+#include <amSimMD25.h>
+// The firmware is not built for tests. Build the host shims it runs on here.
+#include "../../native/hostArduino.cpp"
+#include "../../native/hostFreeRTOS.cpp"
+#include "../../native/hostWire.cpp"
+#include "../../native/hostNetwork.cpp"
+
+void checkBoot() {} // In src/main.cpp, which tests do not build. Only called once WiFi is up.
+
+amSimBus bus0; // Behind Wire.
+amSimMD25 md25Sim; // Motor controller on bus0.
+
+// Run one command the way checkMqtt() does, from a copy with room for the 0 cmdTokenize() may add.
+bool runCmd(const char* text)
+{
+    char cmd[COMMAND_MAX_LENGTH + 1];
+    strncpy(cmd, text, COMMAND_MAX_LENGTH);
+    cmd[COMMAND_MAX_LENGTH] = '\0';
+    return processCmd(cmd, strlen(cmd));
+}
+
+void setUp(void)
+{
+    enableBalance(false);
+    stopPath();
+    balancePath.tick(micros()); // Takes the dropped path off the queue.
+}
+
+void tearDown(void)
+{
+}
+
+// With the balance loop off every segment is refused and nothing is queued.
+void test_path_refused_while_balance_off(void)
+{
+    TEST_ASSERT_FALSE(balanceEnabled);
+    TEST_ASSERT_FALSE(runCmd("PATH,STRAIGHT,500"));
+    TEST_ASSERT_EQUAL_UINT8(0, balancePath.getQueued());
+}
+
+// BALANCE,ON puts the MD25 in the mode and acceleration the loop needs, then PATH queues every segment it was given.
+void test_path_queued_after_balance_on(void)
+{
+    TEST_ASSERT_TRUE(runCmd("balance,on"));
+    TEST_ASSERT_TRUE(balanceEnabled);
+    TEST_ASSERT_EQUAL_UINT8(MD25ModeUnsigned, md25Sim.getReg(MD25RegMode));
+    TEST_ASSERT_EQUAL_UINT8(MD25AccelFastest, md25Sim.getReg(MD25RegMotorAccel));
+    uint32_t before = balancePath.getQueued();
+    TEST_ASSERT_TRUE(runCmd("PATH,STRAIGHT,500,TURN,90,TRAPEZOID,STRAIGHT,-500"));
+    TEST_ASSERT_EQUAL_UINT8(before + 3, balancePath.getQueued());
+    TEST_ASSERT_TRUE(runCmd("PATH,STOP"));
+    balancePath.tick(micros());
+    TEST_ASSERT_EQUAL_UINT8(0, balancePath.getQueued());
+}
+
+// A bad segment anywhere in the command means none of it is queued.
+void test_bad_path_queues_nothing(void)
+{
+    TEST_ASSERT_TRUE(runCmd("BALANCE,ON"));
+    TEST_ASSERT_FALSE(runCmd("PATH,STRAIGHT,500,SIDEWAYS,100"));
+    TEST_ASSERT_EQUAL_UINT8(0, balancePath.getQueued());
+}
+
+// BALANCE,OFF takes the motors back and stops them. Anything but ON or OFF is refused.
+void test_balance_off_and_bad_arguments(void)
+{
+    TEST_ASSERT_TRUE(runCmd("BALANCE,ON"));
+    TEST_ASSERT_TRUE(runCmd("BALANCE,OFF"));
+    TEST_ASSERT_FALSE(balanceEnabled);
+    TEST_ASSERT_EQUAL_UINT8(MD25SpeedStop, md25Sim.getReg(MD25RegSpeed1));
+    TEST_ASSERT_EQUAL_UINT8(MD25SpeedStop, md25Sim.getReg(MD25RegSpeed2));
+    TEST_ASSERT_FALSE(runCmd("BALANCE"));
+    TEST_ASSERT_FALSE(runCmd("BALANCE,MAYBE"));
+    TEST_ASSERT_FALSE(balanceEnabled);
+}
+
+#endif
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+#ifdef ZIPPY_NATIVE
+    RUN_TEST(test_path_refused_while_balance_off);
+    RUN_TEST(test_path_queued_after_balance_on);
+    RUN_TEST(test_bad_path_queues_nothing);
+    RUN_TEST(test_balance_off_and_bad_arguments);
+#endif
+    return UNITY_END();
+}
+
+#ifndef ZIPPY_NATIVE
+void setup()
+{
+    delay(2000); // Give the board time to open the serial port.
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    Log.begin(LOG_LEVEL_WARNING, &Serial, true);
+    bus0.attach(md25Sim);
+    Wire.hostAttachBus(&bus0);
+    initI2c(); // Bus workers the MD25 port goes through.
+    int failures = runUnityTests();
+    hostStopTasks();
+    return failures;
+}
+#endif
@@ -0,0 +1,297 @@
+// Tests for the packet pools of AsyncMqttClient.
+// The pool itself is checked on both targets. On the host the real client is built against the AsyncTCP stand-in, a broker is
+// played through it, and every call to operator new is counted while a mix of packets goes both ways.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef ZIPPY_NATIVE
+#include <AsyncMqttClient.h>
+#else
+#include <new>
+// The library is not built for [env:native], where native/AsyncMqttClient.h stands in for it. Build the real one here.
+#include "../../native/hostArduino.cpp"
+#include "../../native/hostFreeRTOS.cpp"
+#include "../../native/hostAsyncMqttClient.cpp"
+
+// Every allocation made through operator new while counting is on.
+static bool countHeap = false;
+static uint32_t heapCalls = 0;
+
+void* operator new(size_t size)
+{
+    if (countHeap) heapCalls++;
+    void* p = malloc(size ? size : 1);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    if (countHeap && p != nullptr) heapCalls++;
+    free(p); // Pairs with the malloc() above.
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    operator delete(p);
+}
+#endif
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Blocks are handed out until the pool is empty, then requests go to the heap and are counted.
+void test_pool_hands_out_blocks_then_falls_back(void)
+{
+    AsyncMqttClientInternals::Pool<32, 4> pool;
+    void* block[5];
+    for (int i = 0; i < 5; i++) block[i] = pool.allocate(24);
+    AsyncMqttClientPoolStats stats = pool.stats();
+    TEST_ASSERT_EQUAL_UINT16(4, stats.slots);
+    TEST_ASSERT_EQUAL_UINT16(4, stats.inUse);
+    TEST_ASSERT_EQUAL_UINT16(4, stats.highWater);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.fallbacks);
+    for (int i = 0; i < 4; i++) TEST_ASSERT_TRUE(pool.owns(block[i]));
+    TEST_ASSERT_FALSE(pool.owns(block[4]));
+    for (int i = 0; i < 5; i++) pool.release(block[i]);
+    stats = pool.stats();
+    TEST_ASSERT_EQUAL_UINT16(0, stats.inUse);
+    TEST_ASSERT_EQUAL_UINT16(4, stats.highWater);
+}
+
+// A request bigger than a block never takes one.
+void test_pool_large_request_goes_to_heap(void)
+{
+    AsyncMqttClientInternals::Pool<32, 4> pool;
+    void* big = pool.allocate(33);
+    TEST_ASSERT_FALSE(pool.owns(big));
+    TEST_ASSERT_EQUAL_UINT16(0, pool.stats().inUse);
+    TEST_ASSERT_EQUAL_UINT32(1, pool.stats().fallbacks);
+    memset(big, 0xA5, 33);
+    pool.release(big);
+    void* small = pool.allocate(32);
+    TEST_ASSERT_TRUE(pool.owns(small));
+    pool.release(small);
+}
+
+#ifdef ZIPPY_NATIVE
+AsyncMqttClient client; // Client under test, talking to the broker played below.
+static uint32_t messages = 0; // Complete messages passed to onMessage.
+static uint32_t published = 0; // Acknowledgements passed to onPublish.
+static char lastPayload[64] = ""; // Payload of the last complete message.
+
+void onMessage(char* topic, char* payload, AsyncMqttClientMessageProperties properties, size_t len, size_t index, size_t total)
+{
+    (void)topic;
+    (void)properties;
+    if (index + len > sizeof(lastPayload) - 1) return;
+    memcpy(lastPayload + index, payload, len);
+    if (index + len == total)
+    {
+        lastPayload[total] = 0;
+        messages++;
+    }
+}
+
+void onPublish(uint16_t packetId)
+{
+    (void)packetId;
+    published++;
+}
+
+// Broker sends bytes, all at once or one at a time.
+void receive(const uint8_t* data, size_t len, bool byteByByte)
+{
+    if (!byteByByte)
+    {
+        AsyncClient::hostClient()->hostReceive(data, len);
+        return;
+    }
+    for (size_t i = 0; i < len; i++) AsyncClient::hostClient()->hostReceive(data + i, 1);
+}
+
+// Adds an acknowledgement for packetId to a stream. Returns its length.
+size_t ack(uint8_t* dest, uint8_t firstByte, uint16_t packetId)
+{
+    dest[0] = firstByte;
+    dest[1] = 2;
+    dest[2] = packetId >> 8;
+    dest[3] = packetId & 0xFF;
+    return 4;
+}
+
+// Adds a PUBLISH to a stream. Returns its length.
+size_t publishPacket(uint8_t* dest, uint8_t qos, uint16_t packetId, const char* topic, const char* payload)
+{
+    size_t topicLen = strlen(topic);
+    size_t payloadLen = strlen(payload);
+    size_t n = 0;
+    dest[n++] = 0x30 | (qos << 1);
+    dest[n++] = 2 + topicLen + (qos ? 2 : 0) + payloadLen;
+    dest[n++] = 0;
+    dest[n++] = topicLen;
+    memcpy(dest + n, topic, topicLen);
+    n += topicLen;
+    if (qos)
+    {
+        dest[n++] = packetId >> 8;
+        dest[n++] = packetId & 0xFF;
+    }
+    memcpy(dest + n, payload, payloadLen);
+    return n + payloadLen;
+}
+
+// Connect and subscribe, as aaMqtt does.
+void connectClient(void)
+{
+    static const uint8_t CONNACK[] = {0x20, 0x02, 0x00, 0x00};
+    client.connect();
+    AsyncClient::hostClient()->hostAccept();
+    receive(CONNACK, sizeof(CONNACK), false);
+    uint16_t id = client.subscribe("zippy/commands", 1);
+    uint8_t suback[] = {0x90, 0x03, (uint8_t)(id >> 8), (uint8_t)(id & 0xFF), 0x01};
+    receive(suback, sizeof(suback), false);
+}
+
+// One round of steady state traffic: our QoS 0, 1 and 2 publishes with their acknowledgements, the broker's QoS 0, 1 and 2
+// publishes with theirs, and a ping response. The broker answers each of our packets as it reaches the head of the queue.
+void trafficRound(uint16_t incomingId, bool byteByByte)
+{
+    uint8_t stream[256];
+    size_t n = 0;
+    uint16_t q1 = client.publish("zippy/telemetry", 1, false, "{\"pitch\":1.25,\"speed\":310}");
+    client.publish("zippy/health", 0, false, "ok");
+    n += ack(stream + n, 0x40, q1);
+    n += publishPacket(stream + n, 0, 0, "zippy/commands", "TEST");
+    n += publishPacket(stream + n, 1, incomingId, "zippy/commands", "RGB,1,2,3");
+    stream[n++] = 0xD0;
+    stream[n++] = 0x00;
+    receive(stream, n, byteByByte);
+    n = publishPacket(stream, 2, incomingId + 1, "zippy/commands", "TEST");
+    n += ack(stream + n, 0x62, incomingId + 1);
+    receive(stream, n, byteByByte);
+    uint16_t q2 = client.publish("zippy/telemetry", 2, false, "{\"pitch\":1.50}");
+    n = ack(stream, 0x50, q2);
+    receive(stream, n, byteByByte);
+    n = ack(stream, 0x70, q2);
+    receive(stream, n, byteByByte);
+}
+
+// After the first round the pools are warm, and from then on nothing goes to the heap.
+void test_steady_state_traffic_uses_no_heap(void)
+{
+    client.setServer(IPAddress(192, 168, 0, 2), 1883);
+    client.setClientId("zippy");
+    client.onMessage(onMessage);
+    client.onPublish(onPublish);
+    connectClient();
+    TEST_ASSERT_TRUE(client.connected());
+    trafficRound(100, false);
+    heapCalls = 0;
+    messages = 0;
+    published = 0;
+    uint32_t sentBefore = AsyncClient::hostClient()->hostSentBytes();
+    countHeap = true;
+    for (uint16_t i = 0; i < 200; i++) trafficRound(200 + 2 * i, (i & 1) != 0);
+    countHeap = false;
+    char text[120];
+    snprintf(text, sizeof(text), "200 rounds, %u messages in, %u acknowledged out, %u bytes sent, %u heap calls.",
+             (unsigned)messages, (unsigned)published, (unsigned)(AsyncClient::hostClient()->hostSentBytes() - sentBefore),
+             (unsigned)heapCalls);
+    TEST_MESSAGE(text);
+    TEST_ASSERT_EQUAL_UINT32(0, heapCalls);
+    TEST_ASSERT_EQUAL_UINT32(600, messages);
+    TEST_ASSERT_EQUAL_UINT32(400, published);
+    TEST_ASSERT_EQUAL_STRING("TEST", lastPayload);
+    AsyncMqttClientPoolStats packets = AsyncMqttClient::getPacketPoolStats();
+    AsyncMqttClientPoolStats buffers = AsyncMqttClient::getBufferPoolStats();
+    snprintf(text, sizeof(text), "Packet pool high water %u of %u, buffer pool high water %u of %u.", packets.highWater,
+             packets.slots, buffers.highWater, buffers.slots);
+    TEST_MESSAGE(text);
+    TEST_ASSERT_EQUAL_UINT16(0, packets.inUse);
+    TEST_ASSERT_EQUAL_UINT16(0, buffers.inUse);
+    TEST_ASSERT_EQUAL_UINT32(0, packets.fallbacks);
+}
+
+// A QoS 2 message sent again before its PUBREL is only passed on once.
+void test_qos2_redelivery_reported_once(void)
+{
+    uint8_t stream[64];
+    size_t n = publishPacket(stream, 2, 900, "zippy/commands", "RGB,9,9,9");
+    messages = 0;
+    receive(stream, n, false);
+    stream[0] |= 0x08; // DUP.
+    receive(stream, n, false);
+    TEST_ASSERT_EQUAL_UINT32(1, messages);
+    n = ack(stream, 0x62, 900); // Each delivery got its own PUBREC, so the broker releases twice.
+    receive(stream, n, false);
+    receive(stream, n, false);
+    TEST_ASSERT_EQUAL_UINT16(0, AsyncMqttClient::getPacketPoolStats().inUse);
+}
+
+// A payload bigger than a pool buffer is still sent whole, from the heap.
+void test_oversize_publish_uses_heap(void)
+{
+    char payload[MQTT_OUT_BUFFER_SIZE + 64];
+    memset(payload, 'x', sizeof(payload) - 1);
+    payload[sizeof(payload) - 1] = 0;
+    uint32_t fallbacks = AsyncMqttClient::getBufferPoolStats().fallbacks;
+    uint32_t sentBefore = AsyncClient::hostClient()->hostSentBytes();
+    client.publish("zippy/big", 0, false, payload);
+    uint32_t expected = 1 + 2 + 2 + strlen("zippy/big") + strlen(payload); // Two byte remaining length.
+    TEST_ASSERT_EQUAL_UINT32(expected, AsyncClient::hostClient()->hostSentBytes() - sentBefore);
+    TEST_ASSERT_EQUAL_UINT32(fallbacks + 1, AsyncMqttClient::getBufferPoolStats().fallbacks);
+    TEST_ASSERT_EQUAL_UINT16(0, AsyncMqttClient::getBufferPoolStats().inUse);
+}
+
+// Packets queued when the link drops go back to the pool when the queue is cleared.
+void test_queue_returns_packets_to_pool(void)
+{
+    for (int i = 0; i < 4; i++) client.publish("zippy/telemetry", 1, false, "queued");
+    TEST_ASSERT_EQUAL_UINT16(4, AsyncMqttClient::getPacketPoolStats().inUse);
+    client.disconnect(true);
+    TEST_ASSERT_FALSE(client.connected());
+    TEST_ASSERT_TRUE(client.clearQueue());
+    TEST_ASSERT_EQUAL_UINT16(0, AsyncMqttClient::getPacketPoolStats().inUse);
+    TEST_ASSERT_EQUAL_UINT16(0, AsyncMqttClient::getBufferPoolStats().inUse);
+}
+#endif
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_pool_hands_out_blocks_then_falls_back);
+    RUN_TEST(test_pool_large_request_goes_to_heap);
+#ifdef ZIPPY_NATIVE
+    RUN_TEST(test_steady_state_traffic_uses_no_heap);
+    RUN_TEST(test_qos2_redelivery_reported_once);
+    RUN_TEST(test_oversize_publish_uses_heap);
+    RUN_TEST(test_queue_returns_packets_to_pool);
+#endif
+    return UNITY_END();
+}
+
+#ifndef ZIPPY_NATIVE
+void setup()
+{
+    delay(2000); // Give the serial monitor time to attach.
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,263 @@
+// Tests for amOdometry against synthetic encoder streams: wheels driven at known speeds are sampled at the balance loop rate, the
+// counts they would show are fed in, and the pose and speeds are checked against the exact answer. Covers straight runs, turns on
+// the spot, a full circle that must close, counts that wrap past INT32_MAX, a wheel so slow that most reads see no tick, and a
+// stop. The benchmark times one update per control tick, which must stay well under 10 us.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <amOdometry.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+uint64_t nowNs() { return (uint64_t)micros() * 1000; }
+#else
+#include <chrono>
+uint64_t nowNs() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+#endif
+
+const odometryGeometry GEOMETRY = {0.1f, 0.2f, 360.0f}; // 100 mm wheels 200 mm apart, MD25 encoders.
+const uint32_t TICK_US = 5000; // 200 Hz balance loop.
+const float PI_F = 3.14159265f;
+
+// Wheels turning at set speeds, giving the whole encoder counts they would show.
+struct driveSim
+{
+    double left = 0; // Ticks, not rounded.
+    double right = 0;
+    int32_t start = 0; // Count the encoders start from.
+    uint32_t us = 0;
+    void run(amOdometry &odo, float leftMps, float rightMps, float seconds)
+    {
+        double tpm = GEOMETRY.ticksPerRev / (PI_F * GEOMETRY.wheelDiameter); // Ticks per metre.
+        uint32_t steps = (uint32_t)(seconds * 1000000.0f / TICK_US + 0.5f);
+        if(us == 0) odo.update(start, start, us); // Starting counts.
+        for(uint32_t i = 0; i < steps; i++)
+        {
+            us += TICK_US;
+            left += leftMps * tpm * TICK_US / 1000000.0;
+            right += rightMps * tpm * TICK_US / 1000000.0;
+            odo.update((int32_t)((uint32_t)start + (uint32_t)(int32_t)floor(left)), (int32_t)((uint32_t)start + (uint32_t)(int32_t)floor(right)), us);
+        }
+    }
+};
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// The first update only takes the counts, whatever they are.
+void test_first_update_only_seeds(void)
+{
+    amOdometry odo(GEOMETRY);
+    odo.update(123456, -98765, 1000);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, odo.getPose().x);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, odo.getSpeed());
+    odo.update(123456 + 36, -98765 + 36, 1000 + TICK_US);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 36 * odo.getMetresPerTick(), odo.getPose().x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 36 * odo.getMetresPerTick() * 200, odo.getSpeed());
+}
+
+// Both wheels at 0.5 m/s for 2 s is a metre straight ahead.
+void test_straight_line(void)
+{
+    amOdometry odo(GEOMETRY);
+    driveSim sim;
+    sim.run(odo, 0.5f, 0.5f, 2.0f);
+    odometryPose p = odo.getPose();
+    TEST_ASSERT_FLOAT_WITHIN(0.002f, 1.0f, p.x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, p.y);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, p.heading);
+    TEST_ASSERT_FLOAT_WITHIN(0.002f, 1.0f, odo.getDistance());
+    float tick = odo.getMetresPerTick() * 1000000.0f / TICK_US; // One tick in one read.
+    TEST_ASSERT_FLOAT_WITHIN(tick, 0.5f, odo.getSpeed());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, odo.getTurnRate());
+    float sum = 0;
+    for(uint16_t i = 0; i < 400; i++) // Back half of it, at half the speed.
+    {
+        sim.run(odo, -0.25f, -0.25f, TICK_US / 1000000.0f);
+        sum += odo.getSpeed();
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.003f, 0.5f, odo.getPose().x);
+    TEST_ASSERT_FLOAT_WITHIN(tick, -0.25f, odo.getSpeed());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -0.25f, sum / 400); // Right on average.
+}
+
+// Wheels in opposite directions turn on the spot: a quarter turn left, then more than two turns right, crossing +-pi.
+void test_turn_on_the_spot(void)
+{
+    amOdometry odo(GEOMETRY);
+    driveSim sim;
+    float rim = PI_F * GEOMETRY.trackWidth / 4.0f; // Each wheel's travel for a quarter turn.
+    sim.run(odo, -rim, rim, 1.0f);
+    odometryPose p = odo.getPose();
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, PI_F / 2, p.heading);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, p.x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, p.y);
+    TEST_ASSERT_FLOAT_WITHIN(0.25f, PI_F / 2, odo.getTurnRate()); // 0.9 ticks a read, so within a tick of the last read.
+    sim.run(odo, 3 * rim, -3 * rim, 1.5f); // Three quarter turns a second to the right for 1.5 s, so 2.25 turns.
+    p = odo.getPose();
+    TEST_ASSERT_FLOAT_WITHIN(0.03f, PI_F / 4, p.heading); // -1.75 pi wrapped to -pi..pi.
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, -1.75f * PI_F, odo.getTurned());
+    TEST_ASSERT_FLOAT_WITHIN(0.002f, 0.0f, odo.getDistance());
+}
+
+// Driving round a circle of 0.5 m radius comes back to where it started, pointing the same way.
+void test_circle_closes(void)
+{
+    amOdometry odo(GEOMETRY);
+    driveSim sim;
+    const float R = 0.5f;
+    const float V = 0.4f; // Centre speed.
+    float w = V / R; // Radians a second.
+    float half = GEOMETRY.trackWidth / 2;
+    float seconds = 2 * PI_F / w;
+    sim.run(odo, w * (R - half), w * (R + half), seconds / 4); // A quarter: ends at (R, R) pointing left.
+    odometryPose p = odo.getPose();
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, R, p.x);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, R, p.y);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, PI_F / 2, p.heading);
+    sim.run(odo, w * (R - half), w * (R + half), seconds * 3 / 4);
+    p = odo.getPose();
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, p.x);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, p.y);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 0.0f, p.heading);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 2 * PI_F, odo.getTurned());
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 2 * PI_F * R, odo.getDistance());
+}
+
+// Counts that run through INT32_MAX into negative numbers are still steps forward.
+void test_counts_wrap(void)
+{
+    amOdometry odo(GEOMETRY);
+    driveSim sim;
+    sim.start = INT32_MAX - 1000;
+    sim.run(odo, 0.5f, 0.5f, 2.0f); // About 1146 ticks, so through the wrap.
+    TEST_ASSERT_FLOAT_WITHIN(0.002f, 1.0f, odo.getPose().x);
+    TEST_ASSERT_FLOAT_WITHIN(odo.getMetresPerTick() * 1000000.0f / TICK_US, 0.5f, odo.getSpeed());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, odo.getPose().heading);
+}
+
+// At 20 ticks a second only one read in ten sees a tick. Speed comes from the time between ticks, so it is steady rather than a
+// spike on every tenth read, and it falls away once the ticks stop.
+void test_slow_wheel_timing(void)
+{
+    amOdometry odo(GEOMETRY);
+    float mps = 20 * odo.getMetresPerTick(); // 20 ticks a second.
+    driveSim sim;
+    sim.run(odo, mps, mps, 1.0f); // Settle.
+    float lo = 1e9f;
+    float hi = -1e9f;
+    for(uint16_t i = 0; i < 200; i++)
+    {
+        sim.run(odo, mps, mps, TICK_US / 1000000.0f);
+        if(odo.getLeftSpeed() < lo) lo = odo.getLeftSpeed();
+        if(odo.getLeftSpeed() > hi) hi = odo.getLeftSpeed();
+    }
+    TEST_ASSERT_FLOAT_WITHIN(mps * 0.15f, mps, hi);
+    TEST_ASSERT_TRUE(lo > mps * 0.8f); // A per read estimate would swing between 0 and 10 times the speed.
+    char msg[96];
+    snprintf(msg, sizeof(msg), "20 ticks/s at 200 Hz reads: %.4f to %.4f m/s, true %.4f", lo, hi, mps);
+    TEST_MESSAGE(msg);
+    sim.run(odo, 0, 0, 0.2f); // Stopped. No tick for 200 ms: no more than a tick in that time.
+    TEST_ASSERT_TRUE(odo.getLeftSpeed() <= odo.getMetresPerTick() / 0.2f + 1e-6f);
+    TEST_ASSERT_TRUE(odo.getLeftSpeed() > 0.0f);
+    sim.run(odo, 0, 0, ODOM_STOP_US / 1000000.0f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, odo.getLeftSpeed());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, odo.getSpeed());
+}
+
+// A wheel starting from rest gets its speed from the read interval, not from the time it sat still.
+void test_start_from_rest(void)
+{
+    amOdometry odo(GEOMETRY);
+    driveSim sim;
+    sim.run(odo, 0, 0, 2.0f);
+    sim.run(odo, 0.5f, 0.5f, 0.05f);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.5f, odo.getSpeed());
+}
+
+// reset() puts the robot at a given pose. The counts after it are new starting counts.
+void test_reset_to_pose(void)
+{
+    amOdometry odo(GEOMETRY);
+    driveSim sim;
+    sim.run(odo, 0.5f, 0.5f, 1.0f);
+    odo.reset({1.0f, 2.0f, PI_F / 2});
+    sim.run(odo, 0.5f, 0.5f, 1.0f);
+    odometryPose p = odo.getPose();
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 1.0f, p.x);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 2.5f, p.y);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.5f, odo.getDistance());
+}
+
+// Wider wheels or a wider track change the pose from the same counts.
+void test_geometry(void)
+{
+    amOdometry odo({0.2f, 0.4f, 360.0f});
+    odo.update(0, 0, 0);
+    odo.update(360, 360, TICK_US);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, PI_F * 0.2f, odo.getPose().x);
+    odo.setGeometry(GEOMETRY);
+    odo.update(360 - 36, 360 + 36, 2 * TICK_US);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 2 * 36 * odo.getMetresPerTick() / GEOMETRY.trackWidth, odo.getPose().heading);
+}
+
+// One update per control tick, driving a curve so that the trig runs every time.
+void test_benchmark_update(void)
+{
+    const uint32_t UPDATES = 200000;
+    amOdometry odo(GEOMETRY);
+    int32_t l = 0;
+    int32_t r = 0;
+    uint64_t start = nowNs();
+    for(uint32_t i = 0; i < UPDATES; i++)
+    {
+        l += 3;
+        r += 4 + (i & 1);
+        odo.update(l, r, i * TICK_US);
+    }
+    uint64_t ns = (nowNs() - start) / UPDATES;
+    char msg[64];
+    snprintf(msg, sizeof(msg), "ns/update: %lu", (unsigned long)ns);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(odo.getDistance() > 0.0f);
+    TEST_ASSERT_TRUE(ns < 10000);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_first_update_only_seeds);
+    RUN_TEST(test_straight_line);
+    RUN_TEST(test_turn_on_the_spot);
+    RUN_TEST(test_circle_closes);
+    RUN_TEST(test_counts_wrap);
+    RUN_TEST(test_slow_wheel_timing);
+    RUN_TEST(test_start_from_rest);
+    RUN_TEST(test_reset_to_pose);
+    RUN_TEST(test_geometry);
+    RUN_TEST(test_benchmark_update);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+    delay(2000); // Give the board time to open the serial port.
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main(void)
+{
+    return runUnityTests();
+}
+#endif
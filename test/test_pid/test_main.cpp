@@ -0,0 +1,314 @@
+// Host side step response tests and benchmark for the amPid controller and cascade.
+// The plant is a first order lag (a motor speed loop is close enough to one) so the expected responses can be worked out by hand.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <amPid.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+uint32_t nowCycles() { return ESP.getCycleCount(); }
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+uint64_t nowCycles() { return __rdtsc(); } // Time stamp counter. Close to core cycles on modern parts.
+#else
+#include <chrono>
+uint64_t nowCycles() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+#endif
+
+const float PLANT_GAIN = 2.0f; // Output per unit of input at steady state.
+const float PLANT_TAU = 0.1f; // Plant time constant in seconds.
+
+// First order lag advanced by one controller period.
+float plantStep(float y, float u, float dt)
+{
+    return y + (PLANT_GAIN * u - y) * dt / PLANT_TAU;
+}
+
+struct piGains // Well damped PI for the lag plant at 1kHz.
+{
+    static constexpr float kp = 1.0f, ki = 10.0f, kd = 0.0f, dt = 0.001f;
+    static constexpr float outMin = -1.0f, outMax = 1.0f, iMin = -1.0f, iMax = 1.0f, slewRate = 0.0f;
+};
+
+struct pidGains // Same with a derivative term.
+{
+    static constexpr float kp = 1.0f, ki = 10.0f, kd = 0.01f, dt = 0.001f;
+    static constexpr float outMin = -1.0f, outMax = 1.0f, iMin = -1.0f, iMax = 1.0f, slewRate = 0.0f;
+};
+
+struct pOnlyGains // Proportional only, wide limits.
+{
+    static constexpr float kp = 2.0f, ki = 0.0f, kd = 0.0f, dt = 0.001f;
+    static constexpr float outMin = -100.0f, outMax = 100.0f, iMin = 0.0f, iMax = 0.0f, slewRate = 0.0f;
+};
+
+struct slewGains // Proportional with a 10 unit/second slew limit.
+{
+    static constexpr float kp = 2.0f, ki = 0.0f, kd = 0.0f, dt = 0.001f;
+    static constexpr float outMin = -100.0f, outMax = 100.0f, iMin = 0.0f, iMax = 0.0f, slewRate = 10.0f;
+};
+
+struct outerGains // 4 times slower than piGains.
+{
+    static constexpr float kp = 1.0f, ki = 0.0f, kd = 0.0f, dt = 0.004f;
+    static constexpr float outMin = -1.0f, outMax = 1.0f, iMin = 0.0f, iMax = 0.0f, slewRate = 0.0f;
+};
+
+// Run pid against the plant for seconds. Reports overshoot past setpoint and the time to get within 2% and stay there.
+template <typename G> float stepResponse(amPid<G> &pid, float setpoint, float seconds, float* overshoot, float* settleTime)
+{
+    float y = 0.0f;
+    *overshoot = 0.0f;
+    *settleTime = -1.0f;
+    int steps = (int)(seconds / G::dt);
+    for(int i = 0; i < steps; i++)
+    {
+        y = plantStep(y, pid.update(setpoint, y), G::dt);
+        if(y - setpoint > *overshoot)
+        {
+            *overshoot = y - setpoint;
+        }
+        bool inside = fabsf(y - setpoint) <= 0.02f * fabsf(setpoint);
+        if(inside && *settleTime < 0.0f)
+        {
+            *settleTime = (i + 1) * G::dt;
+        }
+        else if(!inside)
+        {
+            *settleTime = -1.0f;
+        }
+    }
+    return y;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_p_only_has_textbook_offset(void)
+{
+    amPid<pOnlyGains> pid;
+    float overshoot, settle;
+    float y = stepResponse(pid, 1.0f, 2.0f, &overshoot, &settle);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.8f, y); // Kp*K / (1 + Kp*K) = 4/5.
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, pid.getIntegral()); // ki of 0 never touches the integrator.
+}
+
+void test_pi_step_reaches_setpoint(void)
+{
+    amPid<piGains> pid;
+    float overshoot, settle;
+    float y = stepResponse(pid, 0.5f, 2.0f, &overshoot, &settle);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.5f, y);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.05f, overshoot); // Under 10%.
+    TEST_ASSERT_GREATER_THAN_FLOAT(0.0f, settle);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.5f, settle);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.25f, pid.getIntegral()); // Whole steady state output comes from the integrator.
+}
+
+void test_no_derivative_kick_on_setpoint_step(void)
+{
+    amPid<pidGains> pid;
+    pid.reset(0.0f);
+    float out = pid.update(0.5f, 0.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 0.5f + 10.0f * 0.001f * 0.5f, out); // P and one step of I. No kd * step / dt.
+    out = pid.update(0.5f, 0.01f);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.5f, out); // Derivative opposes the measurement moving.
+}
+
+void test_output_clamped(void)
+{
+    amPid<piGains> pid;
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, pid.update(10.0f, 0.0f));
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, pid.update(-10.0f, 0.0f));
+}
+
+void test_anti_windup_while_saturated(void)
+{
+    amPid<piGains> pid;
+    for(int i = 0; i < 5000; i++) // 5 seconds asking for more than the plant can give.
+    {
+        pid.update(10.0f, 0.0f);
+    }
+    TEST_ASSERT_LESS_OR_EQUAL_FLOAT(0.0f + 0.01f, pid.getIntegral()); // Stopped growing as soon as the output hit the limit.
+    float overshoot, settle;
+    float y = stepResponse(pid, 0.5f, 2.0f, &overshoot, &settle); // Back to a reachable setpoint.
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.5f, y);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.05f, overshoot);
+}
+
+void test_integrator_clamped(void)
+{
+    amPid<piGains> pid;
+    for(int i = 0; i < 5000; i++) // Plant stuck. Error small enough not to saturate the output at first.
+    {
+        pid.update(0.2f, 0.0f);
+    }
+    TEST_ASSERT_LESS_OR_EQUAL_FLOAT(piGains::iMax, pid.getIntegral());
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, pid.getOutput());
+}
+
+void test_slew_limit(void)
+{
+    amPid<slewGains> pid;
+    float last = 0.0f;
+    for(int i = 0; i < 100; i++)
+    {
+        float out = pid.update(10.0f, 0.0f);
+        TEST_ASSERT_FLOAT_WITHIN(0.0001f, slewGains::slewRate * slewGains::dt, out - last); // 0.01 per update.
+        last = out;
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 1.0f, last);
+}
+
+void test_feed_forward_added(void)
+{
+    amPid<pOnlyGains> pid;
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 2.0f * 0.5f + 3.0f, pid.update(0.5f, 0.0f, 3.0f));
+}
+
+void test_reset_is_bumpless(void)
+{
+    amPid<pidGains> pid;
+    pid.reset(0.3f, 0.6f); // Take over a plant already at 0.3 with 0.6 applied.
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.6f, pid.update(0.3f, 0.3f));
+}
+
+void test_cascade_runs_outer_loop_at_its_own_rate(void)
+{
+    amPidCascade<outerGains, piGains> cascade;
+    TEST_ASSERT_EQUAL_UINT16(4, (amPidCascade<outerGains, piGains>::RATIO));
+    cascade.update(0.5f, 0.0f, 0.0f);
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, cascade.getInnerSetpoint());
+    cascade.update(0.5f, 0.2f, 0.0f); // Outer measurement moved but the outer loop is not due.
+    cascade.update(0.5f, 0.2f, 0.0f);
+    cascade.update(0.5f, 0.2f, 0.0f);
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, cascade.getInnerSetpoint());
+    cascade.update(0.5f, 0.2f, 0.0f); // Fifth update is the second outer update.
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 0.3f, cascade.getInnerSetpoint());
+}
+
+void test_cascade_step_response(void)
+{
+    // Outer loop holds the integral of the plant output (a position) using the inner loop to hold the plant output (a speed).
+    amPidCascade<outerGains, piGains> cascade;
+    float speed = 0.0f, position = 0.0f;
+    for(int i = 0; i < 5000; i++)
+    {
+        float u = cascade.update(0.5f, position, speed);
+        speed = plantStep(speed, u, piGains::dt);
+        position += speed * piGains::dt;
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.5f, position);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, speed);
+}
+
+// Same sums with the gains in variables, to show what fixing them at compile time buys.
+struct runtimeGains
+{
+    float kp, ki, kd, dt, outMin, outMax, iMin, iMax, slewRate;
+};
+
+struct runtimePid
+{
+    runtimeGains g;
+    float integral = 0.0f, lastMeasurement = 0.0f, output = 0.0f;
+    static float clamp(float v, float lo, float hi) { return (v < lo) ? lo : (v > hi) ? hi : v; }
+    float update(float setpoint, float measurement, float feedForward = 0.0f)
+    {
+        float error = setpoint - measurement;
+        float out = g.kp * error + feedForward - (g.kd / g.dt) * (measurement - lastMeasurement);
+        lastMeasurement = measurement;
+        float unclamped = out + integral;
+        if(!(unclamped >= g.outMax && error > 0.0f) && !(unclamped <= g.outMin && error < 0.0f))
+        {
+            integral = clamp(integral + g.ki * g.dt * error, g.iMin, g.iMax);
+        }
+        out = clamp(out + integral, g.outMin, g.outMax);
+        if(g.slewRate > 0.0f)
+        {
+            out = clamp(out, output - g.slewRate * g.dt, output + g.slewRate * g.dt);
+        }
+        output = out;
+        return out;
+    }
+};
+
+const int BENCH_UPDATES = 100000;
+volatile float benchInput = 0.25f; // Volatile so the compiler cannot fold the loops away.
+volatile float benchSink;
+
+template <typename P> float cyclesPerUpdate(P &pid)
+{
+    float measurement = 0.0f;
+    auto start = nowCycles();
+    for(int i = 0; i < BENCH_UPDATES; i++)
+    {
+        measurement = plantStep(measurement, pid.update(benchInput, measurement), 0.001f);
+    }
+    auto elapsed = nowCycles() - start;
+    benchSink = measurement;
+    return (float)elapsed / BENCH_UPDATES;
+}
+
+void test_benchmark_cycles_per_update(void)
+{
+    amPid<piGains> pi;
+    amPid<pidGains> pidc;
+    runtimePid runtime;
+    runtime.g = {pidGains::kp, pidGains::ki, pidGains::kd, pidGains::dt, pidGains::outMin, pidGains::outMax, pidGains::iMin, pidGains::iMax, pidGains::slewRate};
+    amPidCascade<outerGains, piGains> cascade;
+    float measurement = 0.0f;
+    auto start = nowCycles();
+    for(int i = 0; i < BENCH_UPDATES; i++)
+    {
+        measurement = plantStep(measurement, cascade.update(benchInput, measurement, measurement), 0.001f);
+    }
+    float cascadeCycles = (float)(nowCycles() - start) / BENCH_UPDATES;
+    benchSink = measurement;
+    char msg[160];
+    snprintf(msg, sizeof(msg), "cycles/update (incl. plant): PI %.1f, PID %.1f, PID runtime gains %.1f, cascade %.1f",
+             cyclesPerUpdate(pi), cyclesPerUpdate(pidc), cyclesPerUpdate(runtime), cascadeCycles);
+    TEST_MESSAGE(msg);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_p_only_has_textbook_offset);
+    RUN_TEST(test_pi_step_reaches_setpoint);
+    RUN_TEST(test_no_derivative_kick_on_setpoint_step);
+    RUN_TEST(test_output_clamped);
+    RUN_TEST(test_anti_windup_while_saturated);
+    RUN_TEST(test_integrator_clamped);
+    RUN_TEST(test_slew_limit);
+    RUN_TEST(test_feed_forward_added);
+    RUN_TEST(test_reset_is_bumpless);
+    RUN_TEST(test_cascade_runs_outer_loop_at_its_own_rate);
+    RUN_TEST(test_cascade_step_response);
+    RUN_TEST(test_benchmark_cycles_per_update);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+    delay(2000); // service delay
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runUnityTests();
+}
+#endif
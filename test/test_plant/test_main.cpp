@@ -0,0 +1,261 @@
+// Host side tests for the simulated balancing robot in amSimPlant and the closed loop trials in amSimTrial.
+// The plant is checked against things that can be worked out by hand (how fast it falls, what the sensors read at rest, how the
+// MD25 ramps) before the trials are trusted to say anything about controller gains.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <amSimBus.h>
+#include <amSimMD25.h>
+#include <amSimMPU6050.h>
+#include <amSimPlant.h>
+#include <amSimTrial.h>
+#include <amMPU6050.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+uint64_t nowNs() { return (uint64_t)micros() * 1000; }
+#else
+#include <chrono>
+uint64_t nowNs() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+#endif
+
+// Gains found with simScoreGains() for the default plant with the MD25 acceleration register at 10.
+const balanceGains TUNED_GAINS = {1800.0f, 20.0f, 150.0f, 0.6f, 127.0f};
+const uint8_t FASTEST_ACCEL = 10; // Quickest ramp the MD25 datasheet allows.
+
+amSimBus bus;
+amSimMD25* md25;
+amSimMPU6050* chip;
+amMPU6050* imu;
+simPlantParams params;
+
+void setUp(void)
+{
+    bus = amSimBus();
+    md25 = new amSimMD25();
+    chip = new amSimMPU6050();
+    bus.attach(*md25);
+    bus.attach(*chip);
+    imu = new amMPU6050(bus, SIM_MPU6050_ADDRESS);
+    imu->begin(MPU6050_DLPF_44HZ, 0, MPU6050_GYRO_500DPS, MPU6050_ACCEL_4G);
+    params = simPlantParams();
+}
+
+void tearDown(void)
+{
+    delete imu;
+    delete chip;
+    delete md25;
+}
+
+// Most recent sample from the FIFO. Returns the number of samples that were waiting.
+uint16_t latestSample(mpu6050Sample* sample)
+{
+    mpu6050Sample samples[32];
+    uint16_t count = 0;
+    imu->drainFifo(samples, 32, &count);
+    if(count > 0)
+    {
+        *sample = samples[count - 1];
+    }
+    return count;
+}
+
+void test_random_is_repeatable_and_normal(void)
+{
+    amSimRandom a(42);
+    amSimRandom b(42);
+    double sum = 0.0;
+    double squares = 0.0;
+    const int n = 100000;
+    for(int i = 0; i < n; i++)
+    {
+        double x = a.gaussian(2.0);
+        TEST_ASSERT_TRUE(x == b.gaussian(2.0));
+        sum += x;
+        squares += x * x;
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 0.0, sum / n);
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 2.0, sqrt(squares / n));
+    amSimRandom zero(0); // Would stick at 0 without the guard.
+    TEST_ASSERT_NOT_EQUAL(0, zero.next());
+}
+
+void test_md25_ramp_follows_accel_register(void)
+{
+    md25->setAccelRamp(true);
+    uint8_t speeds[2] = {255, 255};
+    bus.writeRegs(SIM_MD25_ADDRESS, MD25RegSpeed1, speeds, 2);
+    TEST_ASSERT_EQUAL_INT16(127, md25->getMotorCommand(MD25_MOTOR1));
+    md25->advance(624);
+    TEST_ASSERT_EQUAL_INT16(120, md25->getMotorOutput(MD25_MOTOR1)); // 5 every 25ms at the power on value.
+    md25->advance(26);
+    TEST_ASSERT_EQUAL_INT16(127, md25->getMotorOutput(MD25_MOTOR1)); // Last step stops at the command.
+    uint8_t accel = FASTEST_ACCEL;
+    bus.writeRegs(SIM_MD25_ADDRESS, MD25RegMotorAccel, &accel, 1);
+    bus.writeRegs(SIM_MD25_ADDRESS, MD25RegSpeed1, (const uint8_t[]){0}, 1);
+    md25->advance(650);
+    TEST_ASSERT_EQUAL_INT16(-128, md25->getMotorOutput(MD25_MOTOR1)); // Full forward to full reverse in 26 steps.
+    TEST_ASSERT_EQUAL_INT16(127, md25->getMotorOutput(MD25_MOTOR2));
+    md25->setAccelRamp(false);
+    bus.writeRegs(SIM_MD25_ADDRESS, MD25RegSpeed2, (const uint8_t[]){128}, 1);
+    TEST_ASSERT_EQUAL_INT16(0, md25->getMotorOutput(MD25_MOTOR2)); // Follows at once when off.
+}
+
+void test_upright_at_rest_stays_put_and_feels_gravity(void)
+{
+    params.gyroNoise = 0.0;
+    params.accelNoise = 0.0;
+    amSimPlant plant(*md25, *chip, params);
+    TEST_ASSERT_EQUAL_UINT16(1000, plant.advance(1000000));
+    imu->resetFifo(); // A second of samples is more than the FIFO holds.
+    plant.advance(10000);
+    TEST_ASSERT_EQUAL_FLOAT(0.0, plant.getPitch());
+    TEST_ASSERT_FALSE(plant.hasFallen());
+    mpu6050Sample sample;
+    TEST_ASSERT_GREATER_THAN_UINT16(0, latestSample(&sample));
+    TEST_ASSERT_EQUAL_INT16(0, sample.accelX);
+    TEST_ASSERT_EQUAL_INT16(8192, sample.accelZ);
+    TEST_ASSERT_EQUAL_INT16(33, sample.gyroY); // 0.5 degrees/second of bias at 65.5 LSB.
+}
+
+void test_open_loop_falls_like_a_pendulum(void)
+{
+    amSimPlant plant(*md25, *chip, params);
+    plant.reset(0.05);
+    uint32_t ms = 0;
+    while(plant.hasFallen() == false && ms < 5000)
+    {
+        plant.advance(1000);
+        ms++;
+    }
+    // Small angle growth rate is sqrt(m g l / (m l^2 + I)), about 6/s, so 0.05 to 0.9 radians takes about 0.6s.
+    TEST_ASSERT_UINT32_WITHIN(150, 650, ms);
+    TEST_ASSERT_EQUAL_FLOAT(params.fallAngle, plant.getPitch()); // Fell forward and lies still.
+    plant.advance(1000000); // Shorted motors brake the wheels to a stop.
+    imu->resetFifo();
+    plant.advance(10000);
+    mpu6050Sample sample;
+    TEST_ASSERT_GREATER_THAN_UINT16(0, latestSample(&sample));
+    TEST_ASSERT_FLOAT_WITHIN(0.02, params.fallAngle, atan2((double)sample.accelX, (double)sample.accelZ));
+}
+
+void test_encoders_count_wheel_turns(void)
+{
+    params.fallAngle = 0.01; // Lies on its face straight away, so the wheels spin free of the body.
+    amSimPlant plant(*md25, *chip, params);
+    plant.reset(0.02);
+    plant.advance(1000);
+    TEST_ASSERT_TRUE(plant.hasFallen());
+    int32_t start = md25->getEncoder(MD25_MOTOR1);
+    double startPosition = plant.getPosition();
+    md25->setAccelRamp(false);
+    bus.writeRegs(SIM_MD25_ADDRESS, MD25RegSpeed1, (const uint8_t[]){255, 255}, 2);
+    plant.advance(2000000);
+    // No load speed is battery volts / (ke * gear ratio) less a little gear friction, about 0.88 m/s on 5cm wheels.
+    TEST_ASSERT_FLOAT_WITHIN(0.03, 0.86, plant.getSpeed());
+    double ticks = (plant.getPosition() - startPosition) / (2.0 * M_PI * params.wheelRadius) * params.ticksPerRev;
+    TEST_ASSERT_INT32_WITHIN(1, (int32_t)ticks, md25->getEncoder(MD25_MOTOR1) - start);
+    TEST_ASSERT_EQUAL_INT32(md25->getEncoder(MD25_MOTOR1), md25->getEncoder(MD25_MOTOR2)); // Straight line, no yaw.
+    TEST_ASSERT_EQUAL_FLOAT(0.0, plant.getYawRate());
+}
+
+void test_uneven_motors_turn_the_robot(void)
+{
+    params.fallAngle = 0.01;
+    amSimPlant plant(*md25, *chip, params);
+    plant.reset(0.02);
+    md25->setAccelRamp(false);
+    bus.writeRegs(SIM_MD25_ADDRESS, MD25RegSpeed1, (const uint8_t[]){128, 255}, 2);
+    plant.advance(500000);
+    TEST_ASSERT_GREATER_THAN_FLOAT(0.5, plant.getYawRate()); // Right wheel forward turns left.
+    TEST_ASSERT_GREATER_THAN_INT32(md25->getEncoder(MD25_MOTOR1), md25->getEncoder(MD25_MOTOR2));
+}
+
+void test_closed_loop_balances_with_tuned_gains(void)
+{
+    simTrialConfig config;
+    config.md25Accel = FASTEST_ACCEL;
+    simTrialResult result = simRunTrial(TUNED_GAINS, config, 7);
+    TEST_ASSERT_FALSE(result.fell);
+    TEST_ASSERT_EQUAL_FLOAT(config.seconds, result.uprightSeconds);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.03, result.rmsPitch);
+    TEST_ASSERT_LESS_THAN_FLOAT(1.5, result.maxDrift); // balanceStep() holds speed, not position, so some wander is expected.
+}
+
+void test_tuned_gains_beat_defaults(void)
+{
+    simTrialConfig config;
+    config.md25Accel = FASTEST_ACCEL;
+    config.seconds = 5.0;
+    balanceGains defaults = BALANCE_DEFAULT_GAINS;
+    simScore tuned = simScoreGains(TUNED_GAINS, config, 16, 1, 1);
+    simScore original = simScoreGains(defaults, config, 16, 1, 1);
+    TEST_ASSERT_EQUAL_UINT32(0, tuned.falls);
+    TEST_ASSERT_GREATER_THAN_UINT32(tuned.falls, original.falls);
+    TEST_ASSERT_LESS_THAN_FLOAT(original.meanCost, tuned.meanCost);
+    TEST_ASSERT_LESS_THAN_FLOAT(SIM_TRIAL_FALL_COST, tuned.worstCost);
+}
+
+void test_threaded_score_matches_serial(void)
+{
+    simTrialConfig config;
+    config.md25Accel = FASTEST_ACCEL;
+    config.seconds = 2.0;
+    simScore serial = simScoreGains(TUNED_GAINS, config, 12, 50, 1);
+    simScore threaded = simScoreGains(TUNED_GAINS, config, 12, 50, 4);
+    TEST_ASSERT_TRUE(serial.meanCost == threaded.meanCost); // Bit for bit, not just close.
+    TEST_ASSERT_TRUE(serial.worstCost == threaded.worstCost);
+    TEST_ASSERT_EQUAL_UINT32(serial.falls, threaded.falls);
+    TEST_ASSERT_EQUAL_UINT32(12, threaded.trials);
+}
+
+// Not a pass/fail test. Reports how much faster than real time a trial runs.
+void test_benchmark_trial_speed(void)
+{
+    simTrialConfig config;
+    config.md25Accel = FASTEST_ACCEL;
+    const uint32_t trials = 8;
+    uint64_t start = nowNs();
+    simScoreGains(TUNED_GAINS, config, trials, 1, 1);
+    double wallSeconds = (nowNs() - start) / 1e9;
+    double simSeconds = trials * (config.seconds + config.settleSeconds);
+    char msg[160];
+    snprintf(msg, sizeof(msg), "%.1f ms per %.0f s trial, %.0fx real time on one thread", wallSeconds * 1000.0 / trials,
+             config.seconds + config.settleSeconds, simSeconds / wallSeconds);
+    TEST_MESSAGE(msg);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_random_is_repeatable_and_normal);
+    RUN_TEST(test_md25_ramp_follows_accel_register);
+    RUN_TEST(test_upright_at_rest_stays_put_and_feels_gravity);
+    RUN_TEST(test_open_loop_falls_like_a_pendulum);
+    RUN_TEST(test_encoders_count_wheel_turns);
+    RUN_TEST(test_uneven_motors_turn_the_robot);
+    RUN_TEST(test_closed_loop_balances_with_tuned_gains);
+    RUN_TEST(test_tuned_gains_beat_defaults);
+    RUN_TEST(test_threaded_score_matches_serial);
+    RUN_TEST(test_benchmark_trial_speed);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+    delay(2000); // service delay
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,290 @@
+// Tests for the amProbe reachability checks, run against real sockets on the loopback interface.
+// Listeners stand in for an MQTT broker that is up, a closed port for one that is down, and on the host a listener whose accept
+// queue is full for one that never answers. The clock is played by the test, one millisecond per pass, so timeouts and the cache
+// are checked without waiting for them. The ICMP check needs raw sockets, so root, and is skipped without them.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <amProbe.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <WiFi.h>
+#include <lwip/sockets.h>
+void pause1ms() { delay(1); }
+#else
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#define closesocket close
+void pause1ms() { usleep(1000); }
+#endif
+
+static const uint32_t TIMEOUT_MS = 2000;
+static const uint32_t TTL_MS = 30000;
+
+static uint32_t nowMs = 0; // Clock played by the test.
+
+// What the callback was told.
+struct callbackLog
+{
+    uint8_t calls;
+    amProbeResult last;
+};
+
+void onResult(const amProbeResult* result, void* arg)
+{
+    callbackLog* log = (callbackLog*)arg;
+    log->calls++;
+    log->last = *result;
+}
+
+// 127.0.0.<host> in network byte order.
+uint32_t loopback(uint8_t host)
+{
+    return htonl(0x7F000000 | host);
+}
+
+// Listening TCP socket on a free port. Returns the socket and sets port, or returns -1.
+int listener(uint32_t ip, int backlog, uint16_t &port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = ip;
+    addr.sin_port = 0;
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, backlog) != 0)
+    {
+        closesocket(fd);
+        return -1;
+    }
+    socklen_t len = sizeof(addr);
+    getsockname(fd, (struct sockaddr*)&addr, &len);
+    port = ntohs(addr.sin_port);
+    return fd;
+}
+
+// Port nothing listens on.
+uint16_t closedPort()
+{
+    uint16_t port;
+    int fd = listener(loopback(1), 1, port);
+    if (fd >= 0) closesocket(fd);
+    return port;
+}
+
+// Poll, a millisecond at a time, until no probe is in flight or limitMs has passed.
+void settle(amProbe &probes, uint32_t limitMs)
+{
+    for (uint32_t i = 0; i < limitMs && probes.getInFlight() > 0; i++)
+    {
+        pause1ms();
+        probes.poll(++nowMs);
+    }
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// A listener is found, and whoever asked is called back once if the answer did not come straight away.
+void test_tcp_finds_listener(void)
+{
+    uint16_t port;
+    int server = listener(loopback(1), 4, port);
+    TEST_ASSERT_TRUE(server >= 0);
+    amProbe probes(TIMEOUT_MS, TTL_MS);
+    callbackLog log = {};
+    uint8_t first = probes.probe(loopback(1), PROBE_TCP, port, nowMs, onResult, &log);
+    TEST_ASSERT_TRUE(first == PROBE_PENDING || first == PROBE_UP);
+    settle(probes, 500);
+    amProbeResult result;
+    TEST_ASSERT_EQUAL_UINT8(PROBE_UP, probes.lookup(loopback(1), PROBE_TCP, port, nowMs, &result));
+    TEST_ASSERT_EQUAL_UINT16(port, result.port);
+    TEST_ASSERT_EQUAL_UINT8(first == PROBE_PENDING ? 1 : 0, log.calls);
+    if (log.calls == 1)
+    {
+        TEST_ASSERT_EQUAL_UINT8(PROBE_UP, log.last.status);
+        TEST_ASSERT_EQUAL_UINT32(loopback(1), log.last.ip);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, probes.getSent());
+    TEST_ASSERT_EQUAL_UINT32(1, probes.getUp());
+    TEST_ASSERT_EQUAL_UINT8(0, probes.getInFlight());
+    closesocket(server);
+}
+
+// A host with nothing on the port is told apart from one that does not answer.
+void test_tcp_closed_port_refused(void)
+{
+    uint16_t port = closedPort();
+    amProbe probes(TIMEOUT_MS, TTL_MS);
+    probes.probe(loopback(1), PROBE_TCP, port, nowMs);
+    settle(probes, 500);
+    TEST_ASSERT_EQUAL_UINT8(PROBE_REFUSED, probes.lookup(loopback(1), PROBE_TCP, port, nowMs));
+    TEST_ASSERT_EQUAL_UINT32(1, probes.getFailed());
+}
+
+// Several targets are probed at once and each gets its own answer.
+void test_several_targets_at_once(void)
+{
+    uint16_t ports[PROBE_SLOTS - 1];
+    int servers[PROBE_SLOTS - 1];
+    for (uint8_t i = 0; i < PROBE_SLOTS - 1; i++)
+    {
+        servers[i] = listener(loopback(1), 4, ports[i]);
+        TEST_ASSERT_TRUE(servers[i] >= 0);
+    }
+    uint16_t closed = closedPort();
+    amProbe probes(TIMEOUT_MS, TTL_MS);
+    callbackLog log = {};
+    for (uint8_t i = 0; i < PROBE_SLOTS - 1; i++) probes.probe(loopback(1), PROBE_TCP, ports[i], nowMs, onResult, &log);
+    probes.probe(loopback(1), PROBE_TCP, closed, nowMs, onResult, &log);
+    settle(probes, 500);
+    for (uint8_t i = 0; i < PROBE_SLOTS - 1; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT8(PROBE_UP, probes.lookup(loopback(1), PROBE_TCP, ports[i], nowMs));
+        closesocket(servers[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT8(PROBE_REFUSED, probes.lookup(loopback(1), PROBE_TCP, closed, nowMs));
+    TEST_ASSERT_EQUAL_UINT32(PROBE_SLOTS, probes.getSent());
+    TEST_ASSERT_EQUAL_UINT32(PROBE_SLOTS - 1, probes.getUp());
+}
+
+// An answer is reused until it is ttlMs old, then the target is probed again.
+void test_cache_answers_within_ttl(void)
+{
+    uint16_t port;
+    int server = listener(loopback(1), 4, port);
+    TEST_ASSERT_TRUE(server >= 0);
+    amProbe probes(TIMEOUT_MS, TTL_MS);
+    probes.probe(loopback(1), PROBE_TCP, port, nowMs);
+    settle(probes, 500);
+    uint32_t answeredMs = nowMs;
+    closesocket(server); // Broker goes away, but the cache has not noticed yet.
+    callbackLog log = {};
+    TEST_ASSERT_EQUAL_UINT8(PROBE_UP, probes.probe(loopback(1), PROBE_TCP, port, answeredMs + TTL_MS - 1, onResult, &log));
+    TEST_ASSERT_EQUAL_UINT32(1, probes.getSent());
+    TEST_ASSERT_EQUAL_UINT32(1, probes.getCacheHits());
+    TEST_ASSERT_EQUAL_UINT8(0, log.calls);
+    nowMs = answeredMs + TTL_MS;
+    TEST_ASSERT_EQUAL_UINT8(PROBE_UNKNOWN, probes.lookup(loopback(1), PROBE_TCP, port, nowMs));
+    probes.probe(loopback(1), PROBE_TCP, port, nowMs);
+    settle(probes, 500);
+    TEST_ASSERT_EQUAL_UINT8(PROBE_REFUSED, probes.lookup(loopback(1), PROBE_TCP, port, nowMs));
+    TEST_ASSERT_EQUAL_UINT32(2, probes.getSent());
+    probes.forget();
+    TEST_ASSERT_EQUAL_UINT8(PROBE_UNKNOWN, probes.lookup(loopback(1), PROBE_TCP, port, nowMs));
+}
+
+// Addresses that are not hosts are turned away without using a socket.
+void test_bad_address_not_sent(void)
+{
+    amProbe probes(TIMEOUT_MS, TTL_MS);
+    TEST_ASSERT_EQUAL_UINT8(PROBE_ERROR, probes.probe(0, PROBE_TCP, PROBE_MQTT_PORT, nowMs));
+    TEST_ASSERT_EQUAL_UINT8(PROBE_ERROR, probes.probe(0xFFFFFFFF, PROBE_ICMP, 0, nowMs));
+    TEST_ASSERT_EQUAL_UINT32(0, probes.getSent());
+    TEST_ASSERT_EQUAL_UINT8(0, probes.getInFlight());
+}
+
+#ifndef ARDUINO
+// Targets that never answer time out together, a second ask joins the probe under way and a fifth target finds no free slot.
+// Linux leaves connects to a listener whose accept queue is full unanswered, which plays a broker that has hung.
+void test_silent_targets_time_out(void)
+{
+    uint16_t port;
+    int server = listener(htonl(INADDR_ANY), 0, port);
+    TEST_ASSERT_TRUE(server >= 0);
+    int filler = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP); // Takes the only place in the accept queue.
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = loopback(1);
+    addr.sin_port = htons(port);
+    TEST_ASSERT_EQUAL_INT(0, connect(filler, (struct sockaddr*)&addr, sizeof(addr)));
+    amProbe probes(TIMEOUT_MS, TTL_MS);
+    callbackLog log = {};
+    uint32_t startMs = nowMs;
+    for (uint8_t i = 0; i < PROBE_SLOTS; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT8(PROBE_PENDING, probes.probe(loopback(2 + i), PROBE_TCP, port, nowMs, onResult, &log));
+    }
+    TEST_ASSERT_EQUAL_UINT8(PROBE_PENDING, probes.probe(loopback(2), PROBE_TCP, port, nowMs));
+    TEST_ASSERT_EQUAL_UINT8(PROBE_BUSY, probes.probe(loopback(2 + PROBE_SLOTS), PROBE_TCP, port, nowMs));
+    TEST_ASSERT_EQUAL_UINT32(PROBE_SLOTS, probes.getSent());
+    TEST_ASSERT_EQUAL_UINT32(1, probes.getCacheHits());
+    for (uint8_t i = 0; i < 20; i++)
+    {
+        pause1ms();
+        probes.poll(++nowMs);
+    }
+    TEST_ASSERT_EQUAL_UINT8(PROBE_SLOTS, probes.getInFlight());
+    TEST_ASSERT_EQUAL_UINT8(PROBE_PENDING, probes.lookup(loopback(2), PROBE_TCP, port, nowMs));
+    probes.poll(startMs + TIMEOUT_MS - 1);
+    TEST_ASSERT_EQUAL_UINT8(0, log.calls);
+    probes.poll(startMs + TIMEOUT_MS);
+    TEST_ASSERT_EQUAL_UINT8(PROBE_SLOTS, log.calls);
+    TEST_ASSERT_EQUAL_UINT8(PROBE_TIMEOUT, log.last.status);
+    TEST_ASSERT_EQUAL_UINT32(TIMEOUT_MS, log.last.rttMs);
+    TEST_ASSERT_EQUAL_UINT8(0, probes.getInFlight());
+    TEST_ASSERT_EQUAL_UINT8(PROBE_TIMEOUT, probes.lookup(loopback(2), PROBE_TCP, port, startMs + TIMEOUT_MS));
+    nowMs = startMs + TIMEOUT_MS;
+    closesocket(filler);
+    closesocket(server);
+}
+
+// An echo to ourselves is answered. Raw sockets need root, so this is skipped without it.
+void test_icmp_echo_on_loopback(void)
+{
+    int raw = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+    if (raw < 0) TEST_IGNORE_MESSAGE("No raw sockets without root");
+    closesocket(raw);
+    amProbe probes(TIMEOUT_MS, TTL_MS);
+    callbackLog log = {};
+    TEST_ASSERT_EQUAL_UINT8(PROBE_PENDING, probes.probe(loopback(1), PROBE_ICMP, PROBE_MQTT_PORT, nowMs, onResult, &log));
+    settle(probes, 500);
+    TEST_ASSERT_EQUAL_UINT8(1, log.calls);
+    TEST_ASSERT_EQUAL_UINT8(PROBE_UP, log.last.status);
+    TEST_ASSERT_EQUAL_UINT16(0, log.last.port);
+    TEST_ASSERT_EQUAL_UINT8(PROBE_UP, probes.lookup(loopback(1), PROBE_ICMP, 0, nowMs));
+}
+#endif
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_tcp_finds_listener);
+    RUN_TEST(test_tcp_closed_port_refused);
+    RUN_TEST(test_several_targets_at_once);
+    RUN_TEST(test_cache_answers_within_ttl);
+    RUN_TEST(test_bad_address_not_sent);
+#ifndef ARDUINO
+    RUN_TEST(test_silent_targets_time_out);
+    RUN_TEST(test_icmp_echo_on_loopback);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+    delay(2000); // service delay
+    WiFi.mode(WIFI_STA); // Starts lwIP, which the loopback interface belongs to.
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runUnityTests();
+}
+#endif
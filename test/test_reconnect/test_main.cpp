@@ -0,0 +1,319 @@
+// Tests for the MQTT connection state machine and the reconnect, backoff and held message handling of aaMqtt.
+// amReconnect is checked on both targets by feeding it events and times. On the host aaMqtt itself is then run against a stand-in
+// broker, played through native/AsyncMqttClient.h, that refuses connections, accepts the TCP connection but never answers, drops
+// connections soon after accepting them, and comes back after a long outage.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <amReconnect.h>
+
+#ifdef ZIPPY_NATIVE
+// aaMqtt talks to the host stand-ins of WiFi and the MQTT client. Tests do not build native/ on their own.
+#include "../../native/hostArduino.cpp"
+#include "../../native/hostFreeRTOS.cpp"
+#include "../../native/hostNetwork.cpp"
+#include <aaMqtt.h>
+#endif
+
+static const uint32_t FIRST_MS = 1000;
+static const uint32_t MAX_MS = 60000;
+static const uint32_t TIMEOUT_MS = 5000;
+static const uint32_t STABLE_MS = 30000;
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Step of the backoff after a number of failures in a row.
+uint32_t stepAfter(uint8_t failures)
+{
+    uint32_t step = FIRST_MS;
+    for (uint8_t i = 1; i < failures && step < MAX_MS; i++) step *= 2;
+    return step < MAX_MS ? step : MAX_MS;
+}
+
+// The first attempt is due at once and nothing else happens until it is answered or runs out of time.
+void test_first_attempt_at_once(void)
+{
+    amReconnect link(FIRST_MS, MAX_MS, TIMEOUT_MS, STABLE_MS, 1234);
+    TEST_ASSERT_EQUAL_UINT8(RC_IDLE, link.getState());
+    TEST_ASSERT_EQUAL_UINT8(RC_NONE, link.poll(100));
+    link.start(100);
+    TEST_ASSERT_EQUAL_UINT8(RC_CONNECT, link.poll(100));
+    TEST_ASSERT_EQUAL_UINT8(RC_CONNECTING, link.getState());
+    TEST_ASSERT_EQUAL_UINT8(RC_NONE, link.poll(100 + TIMEOUT_MS - 1));
+    link.connected(200);
+    TEST_ASSERT_EQUAL_UINT8(RC_CONNECTED, link.getState());
+    TEST_ASSERT_EQUAL_UINT8(RC_NONE, link.poll(1000000));
+    TEST_ASSERT_EQUAL_UINT32(1, link.getAttempts());
+    TEST_ASSERT_EQUAL_UINT32(1, link.getConnects());
+    TEST_ASSERT_EQUAL_UINT8(0, link.getFailures());
+}
+
+// Refused attempts wait twice as long each time, up to the cap, each wait in the top half of its step.
+void test_backoff_doubles_to_cap(void)
+{
+    amReconnect link(FIRST_MS, MAX_MS, TIMEOUT_MS, STABLE_MS, 99);
+    uint32_t now = 0;
+    link.start(now);
+    for (uint8_t failure = 1; failure <= 12; failure++)
+    {
+        TEST_ASSERT_EQUAL_UINT8(RC_CONNECT, link.poll(now));
+        link.disconnected(now); // Refused.
+        TEST_ASSERT_EQUAL_UINT8(RC_WAITING, link.getState());
+        uint32_t wait = link.getWaitMs(now);
+        uint32_t step = stepAfter(failure);
+        TEST_ASSERT_UINT32_WITHIN(step / 4, step * 3 / 4, wait); // step/2 to step.
+        TEST_ASSERT_EQUAL_UINT8(RC_NONE, link.poll(now + wait - 1));
+        now += wait;
+    }
+    TEST_ASSERT_EQUAL_UINT8(12, link.getFailures());
+    TEST_ASSERT_EQUAL_UINT32(12, link.getAttempts());
+}
+
+// An attempt that is never answered is given up on after the timeout, a late answer to it is ignored, and the next is scheduled.
+void test_silent_broker_times_out(void)
+{
+    amReconnect link(FIRST_MS, MAX_MS, TIMEOUT_MS, STABLE_MS, 7);
+    link.start(0);
+    TEST_ASSERT_EQUAL_UINT8(RC_CONNECT, link.poll(0));
+    TEST_ASSERT_EQUAL_UINT8(RC_ABORT, link.poll(TIMEOUT_MS));
+    TEST_ASSERT_EQUAL_UINT8(RC_WAITING, link.getState());
+    TEST_ASSERT_EQUAL_UINT32(1, link.getTimeouts());
+    uint32_t wait = link.getWaitMs(TIMEOUT_MS);
+    link.disconnected(TIMEOUT_MS + 1); // Caused by the abort.
+    link.connected(TIMEOUT_MS + 2); // Too late.
+    TEST_ASSERT_EQUAL_UINT8(RC_WAITING, link.getState());
+    TEST_ASSERT_EQUAL_UINT8(1, link.getFailures());
+    TEST_ASSERT_EQUAL_UINT8(RC_CONNECT, link.poll(TIMEOUT_MS + wait));
+}
+
+// Drops soon after connecting keep backing off. A connection that lasted resets the backoff.
+void test_flapping_backs_off_stable_resets(void)
+{
+    amReconnect link(FIRST_MS, MAX_MS, TIMEOUT_MS, STABLE_MS, 42);
+    uint32_t now = 0;
+    link.start(now);
+    for (uint8_t i = 1; i <= 4; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT8(RC_CONNECT, link.poll(now));
+        link.connected(now + 10);
+        link.disconnected(now + 500); // Dropped straight away.
+        TEST_ASSERT_EQUAL_UINT8(i, link.getFailures());
+        now += 500 + link.getWaitMs(now + 500);
+    }
+    TEST_ASSERT_TRUE(link.getWaitMs(now - 1) <= 1); // Last wait is over.
+    TEST_ASSERT_EQUAL_UINT8(RC_CONNECT, link.poll(now));
+    link.connected(now);
+    link.disconnected(now + STABLE_MS);
+    TEST_ASSERT_EQUAL_UINT8(1, link.getFailures());
+    TEST_ASSERT_TRUE(link.getWaitMs(now + STABLE_MS) <= FIRST_MS);
+    TEST_ASSERT_EQUAL_UINT32(5, link.getDrops());
+    TEST_ASSERT_EQUAL_UINT32(5, link.getConnects());
+}
+
+// Robots with different seeds that lose the broker together come back at different times. Times wrap safely.
+void test_jitter_spreads_and_wraps(void)
+{
+    amReconnect a(FIRST_MS, MAX_MS, TIMEOUT_MS, STABLE_MS, 0x1111);
+    amReconnect b(FIRST_MS, MAX_MS, TIMEOUT_MS, STABLE_MS, 0x2222);
+    uint32_t now = 0xFFFFF000; // 4 seconds before millis() wraps.
+    uint8_t same = 0;
+    a.start(now);
+    b.start(now);
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT8(RC_CONNECT, a.poll(now));
+        TEST_ASSERT_EQUAL_UINT8(RC_CONNECT, b.poll(now));
+        a.disconnected(now);
+        b.disconnected(now);
+        if (a.getWaitMs(now) == b.getWaitMs(now)) same++;
+        uint32_t later = (a.getWaitMs(now) > b.getWaitMs(now)) ? a.getWaitMs(now) : b.getWaitMs(now);
+        now += later;
+    }
+    TEST_ASSERT_TRUE(same < 2);
+    a.stop();
+    TEST_ASSERT_EQUAL_UINT8(RC_NONE, a.poll(now + MAX_MS));
+}
+
+#ifdef ZIPPY_NATIVE
+static uint32_t t0 = 0; // Test clock. aaMqtt::poll() is given the time, so the test need not wait.
+
+// Start aaMqtt from scratch against a broker that has not answered yet.
+AsyncMqttClient* startMqtt(void)
+{
+    AsyncMqttClient* broker = AsyncMqttClient::hostClient();
+    broker->hostDrop(); // Forget the last test's connection.
+    aaMqtt::poll(t0); // Pass the drop on.
+    t0 = millis();
+    aaMqtt::connect(IPAddress(192, 168, 2, 10), "ZippyTest");
+    return broker;
+}
+
+// Setup is never held up: connect() returns at once and a refusing broker is retried less and less often.
+void test_mqtt_refusing_broker(void)
+{
+    WiFi.hostSetAccessPoint("workshop", -50, IPAddress(192, 168, 2, 50));
+    WiFi.begin("workshop");
+    AsyncMqttClient* broker = startMqtt();
+    TEST_ASSERT_TRUE(broker->hostIsConnecting()); // First attempt made by connect().
+    uint32_t now = t0;
+    for (uint8_t failure = 1; failure <= 6; failure++)
+    {
+        broker->hostDrop(AsyncMqttClientDisconnectReason::MQTT_SERVER_UNAVAILABLE);
+        aaMqtt::poll(now);
+        uint32_t wait = aaMqtt::getLink().getWaitMs(now);
+        TEST_ASSERT_TRUE(wait >= stepAfter(failure) / 2 && wait <= stepAfter(failure));
+        aaMqtt::poll(now + wait - 1);
+        TEST_ASSERT_FALSE(broker->hostIsConnecting());
+        now += wait;
+        aaMqtt::poll(now);
+        TEST_ASSERT_TRUE(broker->hostIsConnecting());
+    }
+    TEST_ASSERT_FALSE(aaMqtt::isConnected());
+    TEST_ASSERT_EQUAL_UINT32(7, aaMqtt::getLink().getAttempts());
+}
+
+// A host that takes the TCP connection but never sends CONNACK is dropped after the timeout and tried again later.
+void test_mqtt_silent_broker(void)
+{
+    AsyncMqttClient* broker = startMqtt();
+    TEST_ASSERT_TRUE(broker->hostIsConnecting());
+    aaMqtt::poll(t0 + MQTT_CONNECT_TIMEOUT_MS - 1);
+    TEST_ASSERT_TRUE(broker->hostIsConnecting());
+    aaMqtt::poll(t0 + MQTT_CONNECT_TIMEOUT_MS);
+    TEST_ASSERT_FALSE(broker->hostIsConnecting()); // Given up on.
+    TEST_ASSERT_EQUAL_UINT32(1, aaMqtt::getLink().getTimeouts());
+    broker->hostAccept(); // Answer arrives too late to count.
+    TEST_ASSERT_FALSE(aaMqtt::isConnected());
+    uint32_t now = t0 + MQTT_CONNECT_TIMEOUT_MS + aaMqtt::getLink().getWaitMs(t0 + MQTT_CONNECT_TIMEOUT_MS);
+    aaMqtt::poll(now);
+    TEST_ASSERT_TRUE(broker->hostIsConnecting());
+    broker->hostAccept(); // This time straight away.
+    aaMqtt::poll(now + 1);
+    TEST_ASSERT_TRUE(aaMqtt::isConnected());
+    TEST_ASSERT_EQUAL_UINT8(RC_CONNECTED, aaMqtt::getLink().getState());
+}
+
+// A broker that drops the connection soon after accepting it is retried with growing waits. Messages published while it is away
+// are held and go out, in order and ahead of newer ones, when it is back.
+void test_mqtt_dropping_broker_and_held_messages(void)
+{
+    AsyncMqttClient* broker = startMqtt();
+    uint32_t now = t0;
+    char msg[16];
+    for (uint8_t i = 1; i <= 3; i++)
+    {
+        broker->hostAccept();
+        aaMqtt::poll(now + 10);
+        broker->hostDrop();
+        aaMqtt::poll(now + 20);
+        TEST_ASSERT_EQUAL_UINT8(i, aaMqtt::getLink().getFailures());
+        now += 20 + aaMqtt::getLink().getWaitMs(now + 20);
+        aaMqtt::poll(now);
+        TEST_ASSERT_TRUE(broker->hostIsConnecting());
+    }
+    for (uint8_t i = 1; i <= 3; i++)
+    {
+        snprintf(msg, sizeof(msg), "lost link %u", (unsigned)i);
+        TEST_ASSERT_TRUE(aaMqtt::publishMQTT("ZippyTest/events", msg));
+    }
+    TEST_ASSERT_EQUAL_UINT16(3, aaMqtt::getHeldCount());
+    uint32_t published = broker->getPublishCount();
+    broker->hostAccept(); // Checkin goes out from the callback.
+    aaMqtt::poll(now + 10);
+    TEST_ASSERT_EQUAL_UINT16(0, aaMqtt::getHeldCount());
+    TEST_ASSERT_EQUAL_UINT32(published + 1 + 3, broker->getPublishCount());
+    TEST_ASSERT_EQUAL_STRING("agingApprentice/ZippyTest/events", broker->getLastTopic().c_str());
+    TEST_ASSERT_EQUAL_STRING("lost link 3", broker->getLastPayload().c_str());
+    TEST_ASSERT_TRUE(aaMqtt::publishMQTT("ZippyTest/events", "direct"));
+    TEST_ASSERT_EQUAL_STRING("direct", broker->getLastPayload().c_str());
+    broker->hostDrop(); // After a good long while.
+    aaMqtt::poll(now + 10 + MQTT_STABLE_MS);
+    TEST_ASSERT_EQUAL_UINT8(1, aaMqtt::getLink().getFailures());
+    TEST_ASSERT_TRUE(aaMqtt::getLink().getWaitMs(now + 10 + MQTT_STABLE_MS) <= MQTT_RETRY_FIRST_MS);
+}
+
+// A long outage keeps only the newest messages, counts the rest, and refuses a message too long to hold.
+void test_mqtt_long_outage_keeps_newest(void)
+{
+    AsyncMqttClient* broker = startMqtt();
+    uint32_t lost = aaMqtt::getHeldLost();
+    char msg[16];
+    for (uint8_t i = 0; i < MQTT_OFFLINE_SLOTS + 3; i++)
+    {
+        snprintf(msg, sizeof(msg), "reading %u", (unsigned)i);
+        aaMqtt::publishMQTT("ZippyTest/events", msg);
+    }
+    char big[MQTT_OFFLINE_LEN];
+    memset(big, 'x', sizeof(big) - 1);
+    big[sizeof(big) - 1] = 0;
+    TEST_ASSERT_FALSE(aaMqtt::publishMQTT("ZippyTest/events", big));
+    TEST_ASSERT_EQUAL_UINT16(MQTT_OFFLINE_SLOTS, aaMqtt::getHeldCount());
+    TEST_ASSERT_EQUAL_UINT32(lost + 3, aaMqtt::getHeldLost());
+    broker->hostAccept();
+    aaMqtt::poll(t0 + 1);
+    TEST_ASSERT_EQUAL_UINT16(0, aaMqtt::getHeldCount());
+    snprintf(msg, sizeof(msg), "reading %u", (unsigned)(MQTT_OFFLINE_SLOTS + 2));
+    TEST_ASSERT_EQUAL_STRING(msg, broker->getLastPayload().c_str());
+}
+
+// With WiFi down no connection is attempted, and the attempt counts as a failure so the waits still grow.
+void test_mqtt_waits_for_wifi(void)
+{
+    AsyncMqttClient* broker = startMqtt();
+    broker->hostDrop(AsyncMqttClientDisconnectReason::MQTT_SERVER_UNAVAILABLE);
+    WiFi.disconnect();
+    uint32_t now = t0;
+    aaMqtt::poll(now);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        now += aaMqtt::getLink().getWaitMs(now);
+        aaMqtt::poll(now);
+        TEST_ASSERT_FALSE(broker->hostIsConnecting());
+    }
+    TEST_ASSERT_EQUAL_UINT8(4, aaMqtt::getLink().getFailures());
+}
+#endif
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_first_attempt_at_once);
+    RUN_TEST(test_backoff_doubles_to_cap);
+    RUN_TEST(test_silent_broker_times_out);
+    RUN_TEST(test_flapping_backs_off_stable_resets);
+    RUN_TEST(test_jitter_spreads_and_wraps);
+#ifdef ZIPPY_NATIVE
+    RUN_TEST(test_mqtt_refusing_broker);
+    RUN_TEST(test_mqtt_silent_broker);
+    RUN_TEST(test_mqtt_dropping_broker_and_held_messages);
+    RUN_TEST(test_mqtt_long_outage_keeps_newest);
+    RUN_TEST(test_mqtt_waits_for_wifi);
+#endif
+    return UNITY_END();
+}
+
+#ifndef ZIPPY_NATIVE
+#include <Arduino.h>
+
+void setup()
+{
+    delay(2000); // Give the board time to open the serial port.
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,266 @@
+// Host side tests and benchmark for the amRing lock free single producer, single consumer ring.
+// The stress tests run a real producer thread against a real consumer thread. Each entry carries its sequence number so the
+// consumer can check that nothing arrives twice, out of order or torn, and that every entry sent is accounted for.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <amRing.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+uint64_t nowNs() { return (uint64_t)micros() * 1000; }
+#else
+#include <chrono>
+#include <thread>
+uint64_t nowNs() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+#endif
+
+const uint32_t STRESS_ENTRIES = 500000; // Entries pushed by each stress test.
+
+// Entry used by the stress tests. The filler repeats the sequence number so a torn copy shows up.
+struct stressEntry
+{
+    uint32_t seq;
+    uint8_t filler[12];
+};
+
+void makeEntry(stressEntry &e, uint32_t seq)
+{
+    e.seq = seq;
+    memset(e.filler, (uint8_t)seq, sizeof(e.filler));
+}
+
+bool entryIntact(const stressEntry &e)
+{
+    for(uint8_t i = 0; i < sizeof(e.filler); i++)
+    {
+        if(e.filler[i] != (uint8_t)e.seq) return false;
+    }
+    return true;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_push_pop_in_order(void)
+{
+    amRing<4, 8> ring;
+    TEST_ASSERT_TRUE(ring.isEmpty());
+    TEST_ASSERT_TRUE(ring.push("ONE", 4));
+    TEST_ASSERT_TRUE(ring.push("TWO", 4));
+    TEST_ASSERT_EQUAL_UINT16(2, ring.getCount());
+    char out[8];
+    uint16_t len = 0;
+    TEST_ASSERT_TRUE(ring.pop(out, sizeof(out), &len));
+    TEST_ASSERT_EQUAL_UINT16(4, len);
+    TEST_ASSERT_EQUAL_STRING("ONE", out);
+    TEST_ASSERT_TRUE(ring.pop(out, sizeof(out), &len));
+    TEST_ASSERT_EQUAL_STRING("TWO", out);
+    TEST_ASSERT_FALSE(ring.pop(out, sizeof(out), &len));
+    TEST_ASSERT_TRUE(ring.isEmpty());
+    TEST_ASSERT_EQUAL_UINT32(2, ring.getPushed());
+}
+
+void test_reject_policy_keeps_oldest(void)
+{
+    amRing<4, 4, RING_REJECT> ring;
+    for(uint8_t i = 0; i < 6; i++)
+    {
+        TEST_ASSERT_EQUAL(i < 4, ring.push(&i, 1));
+    }
+    TEST_ASSERT_EQUAL_UINT32(2, ring.getRejected());
+    TEST_ASSERT_EQUAL_UINT32(0, ring.getDropped());
+    uint8_t out;
+    uint16_t len;
+    for(uint8_t i = 0; i < 4; i++)
+    {
+        TEST_ASSERT_TRUE(ring.pop(&out, 1, &len));
+        TEST_ASSERT_EQUAL_UINT8(i, out);
+    }
+    TEST_ASSERT_TRUE(ring.isEmpty());
+}
+
+void test_drop_oldest_policy_keeps_newest(void)
+{
+    amRing<4, 4, RING_DROP_OLDEST> ring;
+    for(uint8_t i = 0; i < 6; i++)
+    {
+        TEST_ASSERT_TRUE(ring.push(&i, 1));
+    }
+    TEST_ASSERT_EQUAL_UINT32(2, ring.getDropped());
+    TEST_ASSERT_EQUAL_UINT32(0, ring.getRejected());
+    TEST_ASSERT_EQUAL_UINT16(4, ring.getCount());
+    uint8_t out;
+    uint16_t len;
+    for(uint8_t i = 2; i < 6; i++)
+    {
+        TEST_ASSERT_TRUE(ring.pop(&out, 1, &len));
+        TEST_ASSERT_EQUAL_UINT8(i, out);
+    }
+    TEST_ASSERT_FALSE(ring.pop(&out, 1, &len));
+}
+
+void test_oversize_rejected_and_small_dest_truncated(void)
+{
+    amRing<2, 4> ring;
+    TEST_ASSERT_FALSE(ring.push("TOOLONG", 7));
+    TEST_ASSERT_EQUAL_UINT32(1, ring.getRejected());
+    TEST_ASSERT_TRUE(ring.push("ABCD", 4));
+    char out[2];
+    uint16_t len;
+    TEST_ASSERT_TRUE(ring.pop(out, sizeof(out), &len));
+    TEST_ASSERT_EQUAL_UINT16(2, len);
+    TEST_ASSERT_EQUAL_MEMORY("AB", out, 2);
+}
+
+void test_many_laps_of_small_ring(void)
+{
+    amRing<2, 4> ring;
+    uint32_t out = 0;
+    uint16_t len;
+    for(uint32_t i = 0; i < 100000; i++) // Many laps of a small ring.
+    {
+        TEST_ASSERT_TRUE(ring.push(&i, sizeof(i)));
+        TEST_ASSERT_TRUE(ring.pop(&out, sizeof(out), &len));
+        TEST_ASSERT_EQUAL_UINT32(i, out);
+    }
+    TEST_ASSERT_TRUE(ring.isEmpty());
+}
+
+#ifndef ARDUINO
+// Push STRESS_ENTRIES from one thread while another pops. Returns through the out-params so asserts stay in the test.
+template <typename R> void stress(R &ring, uint32_t* received, uint32_t* outOfOrder, uint32_t* torn)
+{
+    *received = 0;
+    *outOfOrder = 0;
+    *torn = 0;
+    std::atomic<bool> done(false);
+    std::thread producer([&ring, &done]()
+    {
+        stressEntry e;
+        for(uint32_t i = 0; i < STRESS_ENTRIES; i++)
+        {
+            makeEntry(e, i);
+            ring.push(&e, sizeof(e));
+        }
+        done.store(true);
+    });
+    stressEntry e;
+    uint16_t len;
+    int64_t last = -1;
+    for(;;)
+    {
+        bool finished = done.load(); // Read before popping so the last entries are not missed.
+        if(ring.pop(&e, sizeof(e), &len) == true)
+        {
+            (*received)++;
+            if((int64_t)e.seq <= last) (*outOfOrder)++;
+            if(len != sizeof(e) || entryIntact(e) == false) (*torn)++;
+            last = e.seq;
+        }
+        else if(finished == true)
+        {
+            break;
+        }
+        else
+        {
+            std::this_thread::yield(); // Let the producer run on a single core host.
+        }
+    }
+    producer.join();
+}
+
+void test_stress_reject_policy(void)
+{
+    static amRing<16, sizeof(stressEntry), RING_REJECT> ring;
+    uint32_t received, outOfOrder, torn;
+    stress(ring, &received, &outOfOrder, &torn);
+    TEST_ASSERT_EQUAL_UINT32(0, outOfOrder);
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_EQUAL_UINT32(STRESS_ENTRIES, received + ring.getRejected());
+    TEST_ASSERT_EQUAL_UINT32(received, ring.getPushed());
+}
+
+void test_stress_drop_oldest_policy(void)
+{
+    static amRing<16, sizeof(stressEntry), RING_DROP_OLDEST> ring;
+    uint32_t received, outOfOrder, torn;
+    stress(ring, &received, &outOfOrder, &torn);
+    TEST_ASSERT_EQUAL_UINT32(0, outOfOrder);
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_EQUAL_UINT32(STRESS_ENTRIES, received + ring.getDropped() + ring.getRejected());
+    TEST_ASSERT_EQUAL_UINT32(received + ring.getDropped(), ring.getPushed());
+}
+
+// Not a pass/fail test. Reports entries per second moved between two threads with a 20 byte slot, the MQTT command size.
+template <typename R> double entriesPerSecond(R &ring)
+{
+    const uint32_t entries = 2000000;
+    char msg[20] = "FORWARD 100";
+    uint64_t start = nowNs();
+    std::thread producer([&ring, &msg]()
+    {
+        for(uint32_t i = 0; i < entries; i++)
+        {
+            while(ring.push(msg, sizeof(msg)) == false) std::this_thread::yield(); // Wait rather than lose entries so the rate is for all of them.
+        }
+    });
+    char out[20];
+    uint16_t len;
+    for(uint32_t got = 0; got < entries;)
+    {
+        if(ring.pop(out, sizeof(out), &len) == true) got++;
+        else std::this_thread::yield();
+    }
+    producer.join();
+    return entries * 1e9 / (double)(nowNs() - start);
+}
+
+void test_benchmark_entries_per_second(void)
+{
+    static amRing<64, 20, RING_REJECT> ring;
+    char msg[120];
+    snprintf(msg, sizeof(msg), "2 threads, 64 x 20 byte slots: %.2f M entries/s (%u threads available)",
+             entriesPerSecond(ring) / 1e6, std::thread::hardware_concurrency());
+    TEST_MESSAGE(msg);
+}
+#endif
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_push_pop_in_order);
+    RUN_TEST(test_reject_policy_keeps_oldest);
+    RUN_TEST(test_drop_oldest_policy_keeps_newest);
+    RUN_TEST(test_oversize_rejected_and_small_dest_truncated);
+    RUN_TEST(test_many_laps_of_small_ring);
+#ifndef ARDUINO
+    RUN_TEST(test_stress_reject_policy);
+    RUN_TEST(test_stress_drop_oldest_policy);
+    RUN_TEST(test_benchmark_entries_per_second);
+#endif
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+    delay(2000); // service delay
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runUnityTests();
+}
+#endif
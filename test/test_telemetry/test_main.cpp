@@ -0,0 +1,653 @@
+// Tests and benchmark for the amTelemetry batching publisher and the binary samples of amTelemetrySchema.
+// The batching, framing and backpressure rules, and the sample layouts, are checked on both targets against a sink that records
+// what it is given. On the host the benchmark then drives the real AsyncMqttClient through native/AsyncTCP.h, playing the broker, and compares publishing
+// each sample on its own at QoS 1, as aaMqtt::publishMQTT() does, with batches of amTelemetry, in messages/sec and bytes on the wire,
+// and a minute of 100 Hz state and 1 Hz health samples is measured against the WiFi budget.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef ZIPPY_NATIVE
+#include <chrono>
+// The library is not built for [env:native], where native/AsyncMqttClient.h stands in for it. Build the real one here.
+#include "../../native/hostArduino.cpp"
+#include "../../native/hostFreeRTOS.cpp"
+#include "../../native/hostAsyncMqttClient.cpp"
+uint64_t nowNs() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+#endif
+#include <amTelemetry.h>
+#include <amTelemetrySchema.h>
+
+// What the recording sink was given.
+static bool linkReady = true; // What the ready callback answers.
+static bool clientTakes = true; // What the send callback answers.
+static uint32_t sends = 0; // Messages taken.
+static char lastTopic[TLM_TOPIC_LEN] = "";
+static uint8_t lastQos = 0xFF;
+static uint8_t lastPayload[TLM_FRAME_LEN];
+static size_t lastLen = 0;
+static size_t lastReadyBytes = 0; // Size the ready callback was last asked about.
+
+bool recordSend(void* context, const char* topic, uint8_t qos, const uint8_t* payload, size_t len)
+{
+    (void)context;
+    if (!clientTakes) return false;
+    sends++;
+    strncpy(lastTopic, topic, sizeof(lastTopic) - 1);
+    lastQos = qos;
+    memcpy(lastPayload, payload, len);
+    lastLen = len;
+    return true;
+}
+
+bool recordReady(void* context, size_t wireBytes)
+{
+    (void)context;
+    lastReadyBytes = wireBytes;
+    return linkReady;
+}
+
+// A sample as the balance loop might stream it.
+struct reading
+{
+    int16_t pitch;
+    int16_t rate;
+};
+
+void setUp(void)
+{
+    linkReady = true;
+    clientTakes = true;
+    sends = 0;
+    lastLen = 0;
+    lastQos = 0xFF;
+}
+
+void tearDown(void)
+{
+}
+
+// Topics are joined once, and refused rather than cut short.
+void test_topics_built_once(void)
+{
+    amTelemetry telemetry(recordSend, recordReady, nullptr);
+    int8_t tilt = telemetry.addStream("agingApprentice/", "zippy/tilt", 100);
+    int8_t health = telemetry.addEvents("agingApprentice/", "zippy/health");
+    TEST_ASSERT_EQUAL_INT8(0, tilt);
+    TEST_ASSERT_EQUAL_INT8(0, health);
+    TEST_ASSERT_EQUAL_STRING("agingApprentice/zippy/tilt", telemetry.getStreamTopic(tilt));
+    TEST_ASSERT_EQUAL_STRING("agingApprentice/zippy/health", telemetry.getEventTopic(health));
+    char longName[TLM_TOPIC_LEN + 1];
+    memset(longName, 'x', sizeof(longName) - 1);
+    longName[sizeof(longName) - 1] = 0;
+    TEST_ASSERT_EQUAL_INT8(-1, telemetry.addStream(nullptr, longName, 100));
+    TEST_ASSERT_EQUAL_INT8(1, telemetry.addStream(nullptr, longName + 1, 100)); // Exactly fits.
+    TEST_ASSERT_EQUAL_INT8(2, telemetry.addStream(nullptr, "three", 100));
+    TEST_ASSERT_EQUAL_INT8(-1, telemetry.addStream(nullptr, "four", 100)); // Table full.
+    TEST_ASSERT_NULL(telemetry.getStreamTopic(3));
+    TEST_ASSERT_EQUAL_UINT8(TLM_BAD_ID, telemetry.sample(3, 0, "x", 1));
+    TEST_ASSERT_EQUAL_UINT8(TLM_BAD_ID, telemetry.event(1, "x"));
+}
+
+// Samples inside one interval go out as one QoS 0 frame that reads back sample for sample.
+void test_samples_coalesced_into_one_frame(void)
+{
+    amTelemetry telemetry(recordSend, recordReady, nullptr);
+    int8_t tilt = telemetry.addStream("agingApprentice/", "zippy/tilt", 100);
+    for (int16_t i = 0; i < 10; i++)
+    {
+        reading r = {i, (int16_t)-i};
+        TEST_ASSERT_EQUAL_UINT8(TLM_OK, telemetry.sample(tilt, 5000 + 10 * i, &r, sizeof(r)));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, sends);
+    TEST_ASSERT_EQUAL_UINT8(10, telemetry.getPending(tilt));
+    telemetry.poll(5099);
+    TEST_ASSERT_EQUAL_UINT32(0, sends);
+    telemetry.poll(5100);
+    TEST_ASSERT_EQUAL_UINT32(1, sends);
+    TEST_ASSERT_EQUAL_UINT8(TLM_QOS_STREAM, lastQos);
+    TEST_ASSERT_EQUAL_STRING("agingApprentice/zippy/tilt", lastTopic);
+    TEST_ASSERT_EQUAL(TLM_BATCH_HEADER + 10 * (TLM_SAMPLE_HEADER + sizeof(reading)), lastLen);
+    TEST_ASSERT_EQUAL(tlmWireSize(strlen(lastTopic), lastLen, 0), lastReadyBytes);
+    tlmBatchHeader header;
+    TEST_ASSERT_TRUE(tlmReadHeader(lastPayload, lastLen, &header));
+    TEST_ASSERT_EQUAL_UINT8(TLM_BATCH_VERSION, header.version);
+    TEST_ASSERT_EQUAL_UINT8(10, header.count);
+    TEST_ASSERT_EQUAL_UINT16(0, header.sequence);
+    TEST_ASSERT_EQUAL_UINT32(5000, header.startMs);
+    size_t offset = TLM_BATCH_HEADER;
+    tlmSample sample;
+    for (int16_t i = 0; i < 10; i++)
+    {
+        TEST_ASSERT_TRUE(tlmNextSample(lastPayload, lastLen, &offset, &sample));
+        TEST_ASSERT_EQUAL_UINT16(10 * i, sample.offsetMs);
+        TEST_ASSERT_EQUAL_UINT8(sizeof(reading), sample.len);
+        reading r;
+        memcpy(&r, sample.data, sizeof(r));
+        TEST_ASSERT_EQUAL_INT16(i, r.pitch);
+        TEST_ASSERT_EQUAL_INT16(-i, r.rate);
+    }
+    TEST_ASSERT_FALSE(tlmNextSample(lastPayload, lastLen, &offset, &sample));
+    TEST_ASSERT_EQUAL_UINT8(0, telemetry.getPending(tilt));
+    tlmStats stats = telemetry.getStats();
+    TEST_ASSERT_EQUAL_UINT32(10, stats.samples);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.batches);
+    TEST_ASSERT_EQUAL_UINT32(lastReadyBytes, stats.wireBytes);
+}
+
+// A sample past its batch's interval sends the batch without waiting for poll(). An interval of 0 sends every sample.
+void test_sample_sends_batch_when_due(void)
+{
+    amTelemetry telemetry(recordSend, recordReady, nullptr);
+    int8_t tilt = telemetry.addStream(nullptr, "tilt", 100);
+    int8_t raw = telemetry.addStream(nullptr, "raw", 0);
+    telemetry.sample(tilt, 0, "a", 1);
+    telemetry.sample(tilt, 50, "b", 1);
+    TEST_ASSERT_EQUAL_UINT32(0, sends);
+    telemetry.sample(tilt, 100, "c", 1); // Starts the next batch.
+    TEST_ASSERT_EQUAL_UINT32(1, sends);
+    TEST_ASSERT_EQUAL_UINT8(2, lastPayload[1]);
+    TEST_ASSERT_EQUAL_UINT8(1, telemetry.getPending(tilt));
+    telemetry.sample(raw, 100, "d", 1);
+    TEST_ASSERT_EQUAL_UINT32(2, sends);
+    TEST_ASSERT_EQUAL_STRING("raw", lastTopic);
+    TEST_ASSERT_EQUAL_UINT8(1, lastPayload[1]);
+}
+
+// A sample that does not fit sends the batch ahead of it and starts the next one.
+void test_full_frame_sent_early(void)
+{
+    amTelemetry telemetry(recordSend, recordReady, nullptr);
+    int8_t tilt = telemetry.addStream(nullptr, "tilt", 1000);
+    uint8_t big[100];
+    memset(big, 0x5A, sizeof(big));
+    const uint8_t perFrame = (TLM_FRAME_LEN - TLM_BATCH_HEADER) / (TLM_SAMPLE_HEADER + sizeof(big));
+    for (uint8_t i = 0; i < perFrame; i++) telemetry.sample(tilt, i, big, sizeof(big));
+    TEST_ASSERT_EQUAL_UINT32(0, sends);
+    telemetry.sample(tilt, perFrame, big, sizeof(big));
+    TEST_ASSERT_EQUAL_UINT32(1, sends);
+    TEST_ASSERT_EQUAL_UINT8(perFrame, lastPayload[1]);
+    TEST_ASSERT_EQUAL_UINT8(1, telemetry.getPending(tilt));
+    telemetry.flush();
+    TEST_ASSERT_EQUAL_UINT32(2, sends);
+    tlmBatchHeader header;
+    TEST_ASSERT_TRUE(tlmReadHeader(lastPayload, lastLen, &header));
+    TEST_ASSERT_EQUAL_UINT16(1, header.sequence);
+    TEST_ASSERT_EQUAL_UINT32(perFrame, header.startMs);
+    uint8_t huge[TLM_MAX_SAMPLE];
+    memset(huge, 0, sizeof(huge));
+    TEST_ASSERT_EQUAL_UINT8(TLM_OK, telemetry.sample(tilt, 2000, huge, TLM_MAX_SAMPLE));
+    TEST_ASSERT_EQUAL_UINT8(TLM_OK, telemetry.sample(tilt, 2001, huge, TLM_MAX_SAMPLE));
+    TEST_ASSERT_EQUAL_UINT32(3, sends);
+    TEST_ASSERT_EQUAL(TLM_BATCH_HEADER + TLM_SAMPLE_HEADER + TLM_MAX_SAMPLE, lastLen);
+}
+
+// With the window full a due batch is held, not queued. Once it is also full it is dropped, its sequence number is used up and
+// the newest samples carry on. When the window opens the held batch goes out.
+void test_backpressure_holds_then_drops_oldest(void)
+{
+    amTelemetry telemetry(recordSend, recordReady, nullptr);
+    int8_t tilt = telemetry.addStream(nullptr, "tilt", 10);
+    uint8_t big[100];
+    memset(big, 0, sizeof(big));
+    const uint8_t perFrame = (TLM_FRAME_LEN - TLM_BATCH_HEADER) / (TLM_SAMPLE_HEADER + sizeof(big));
+    linkReady = false;
+    for (uint8_t i = 0; i < perFrame; i++) telemetry.sample(tilt, 20 * i, big, sizeof(big));
+    TEST_ASSERT_EQUAL_UINT32(0, sends);
+    TEST_ASSERT_EQUAL_UINT8(perFrame, telemetry.getPending(tilt));
+    telemetry.poll(1000);
+    telemetry.sample(tilt, 1000, big, sizeof(big));
+    TEST_ASSERT_EQUAL_UINT8(1, telemetry.getPending(tilt));
+    tlmStats stats = telemetry.getStats();
+    TEST_ASSERT_EQUAL_UINT32(perFrame, stats.droppedSamples);
+    TEST_ASSERT_TRUE(stats.deferred >= perFrame);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.batches);
+    linkReady = true;
+    telemetry.poll(1010);
+    TEST_ASSERT_EQUAL_UINT32(1, sends);
+    tlmBatchHeader header;
+    TEST_ASSERT_TRUE(tlmReadHeader(lastPayload, lastLen, &header));
+    TEST_ASSERT_EQUAL_UINT16(1, header.sequence); // Batch 0 was dropped.
+    TEST_ASSERT_EQUAL_UINT8(1, header.count);
+    TEST_ASSERT_EQUAL_UINT32(1000, header.startMs);
+}
+
+// Events go out at once at QoS 1, and are refused and counted when the window is full or the client will not take them.
+void test_events_sent_at_once_or_refused(void)
+{
+    amTelemetry telemetry(recordSend, recordReady, nullptr);
+    int8_t health = telemetry.addEvents("agingApprentice/", "zippy/health");
+    TEST_ASSERT_EQUAL_UINT8(TLM_OK, telemetry.event(health, "Fell over"));
+    TEST_ASSERT_EQUAL_UINT32(1, sends);
+    TEST_ASSERT_EQUAL_UINT8(TLM_QOS_EVENT, lastQos);
+    TEST_ASSERT_EQUAL(9, lastLen);
+    TEST_ASSERT_EQUAL_MEMORY("Fell over", lastPayload, 9);
+    TEST_ASSERT_EQUAL(tlmWireSize(strlen("agingApprentice/zippy/health"), 9, 1), lastReadyBytes);
+    linkReady = false;
+    TEST_ASSERT_EQUAL_UINT8(TLM_BUSY, telemetry.event(health, "Got up"));
+    linkReady = true;
+    clientTakes = false;
+    TEST_ASSERT_EQUAL_UINT8(TLM_SEND_FAILED, telemetry.event(health, "Got up"));
+    TEST_ASSERT_EQUAL_UINT32(1, sends);
+    static uint8_t tooLong[TLM_FRAME_LEN + 1];
+    TEST_ASSERT_EQUAL_UINT8(TLM_TOO_BIG, telemetry.event(health, tooLong, sizeof(tooLong)));
+    tlmStats stats = telemetry.getStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.events);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.droppedEvents);
+}
+
+// PUBLISH sizes, including the step to a two byte remaining length, and frames that do not add up are refused.
+void test_wire_size_and_bad_frames(void)
+{
+    TEST_ASSERT_EQUAL(1 + 1 + 2 + 10 + 100, tlmWireSize(10, 100, 0));
+    TEST_ASSERT_EQUAL(1 + 1 + 2 + 10 + 115, tlmWireSize(10, 115, 0)); // Remaining length 127.
+    TEST_ASSERT_EQUAL(1 + 2 + 2 + 10 + 116, tlmWireSize(10, 116, 0)); // Remaining length 128.
+    TEST_ASSERT_EQUAL(1 + 2 + 2 + 10 + 2 + 200, tlmWireSize(10, 200, 1));
+    uint8_t frame[] = {TLM_BATCH_VERSION, 1, 0, 0, 0, 0, 0, 0, 0, 0, 4, 1, 2};
+    tlmBatchHeader header;
+    tlmSample sample;
+    size_t offset = TLM_BATCH_HEADER;
+    TEST_ASSERT_FALSE(tlmReadHeader(frame, TLM_BATCH_HEADER - 1, &header));
+    TEST_ASSERT_TRUE(tlmReadHeader(frame, sizeof(frame), &header));
+    TEST_ASSERT_FALSE(tlmNextSample(frame, sizeof(frame), &offset, &sample)); // Says 4 bytes, has 2.
+    TEST_ASSERT_EQUAL(TLM_BATCH_HEADER, offset);
+    frame[0] = TLM_BATCH_VERSION + 1;
+    TEST_ASSERT_FALSE(tlmReadHeader(frame, sizeof(frame), &header));
+}
+
+// A state sample as the balance task fills it in.
+tlmState sampleState(void)
+{
+    tlmState state;
+    state.pitch = tlmFixed16(-2.345f, 100);
+    state.pitchRate = tlmFixed16(12.34f, 10);
+    state.wheelSpeed1 = -150;
+    state.wheelSpeed2 = 175;
+    state.encoder1 = -123456;
+    state.encoder2 = 2000000000;
+    state.batteryVolts = 121;
+    state.motorCurrent1 = 15;
+    state.motorCurrent2 = 3;
+    state.execUs = 412;
+    state.flags = TLM_STATE_BALANCING;
+    return state;
+}
+
+// A state sample serialized straight into a batch comes back out of the frame unchanged.
+void test_state_serialized_in_place(void)
+{
+    amTelemetry telemetry(recordSend, recordReady, nullptr);
+    int8_t state = telemetry.addStream("agingApprentice/", "zippy/state", 100);
+    tlmState in = sampleState();
+    tlmEncodeState(in, telemetry.reserve(state, 1000, TLM_STATE_LEN));
+    in.encoder1++;
+    tlmEncodeState(in, telemetry.reserve(state, 1010, TLM_STATE_LEN));
+    TEST_ASSERT_NULL(telemetry.reserve(5, 1010, TLM_STATE_LEN));
+    telemetry.flush();
+    TEST_ASSERT_EQUAL_UINT32(TLM_BATCH_HEADER + 2 * (TLM_SAMPLE_HEADER + TLM_STATE_LEN), lastLen);
+    size_t offset = TLM_BATCH_HEADER;
+    tlmSample sample;
+    tlmState out;
+    TEST_ASSERT_TRUE(tlmNextSample(lastPayload, lastLen, &offset, &sample));
+    TEST_ASSERT_EQUAL_UINT8(TLM_STATE_LEN, sample.len);
+    TEST_ASSERT_TRUE(tlmDecodeState(sample.data, sample.len, &out));
+    TEST_ASSERT_EQUAL_INT16(-235, out.pitch);
+    TEST_ASSERT_EQUAL_INT16(123, out.pitchRate);
+    TEST_ASSERT_EQUAL_INT16(-150, out.wheelSpeed1);
+    TEST_ASSERT_EQUAL_INT16(175, out.wheelSpeed2);
+    TEST_ASSERT_EQUAL_INT32(-123456, out.encoder1);
+    TEST_ASSERT_EQUAL_INT32(2000000000, out.encoder2);
+    TEST_ASSERT_EQUAL_UINT8(121, out.batteryVolts);
+    TEST_ASSERT_EQUAL_UINT8(15, out.motorCurrent1);
+    TEST_ASSERT_EQUAL_UINT8(3, out.motorCurrent2);
+    TEST_ASSERT_EQUAL_UINT16(412, out.execUs);
+    TEST_ASSERT_EQUAL_UINT8(TLM_STATE_BALANCING, out.flags);
+    TEST_ASSERT_TRUE(tlmNextSample(lastPayload, lastLen, &offset, &sample));
+    TEST_ASSERT_EQUAL_UINT16(10, sample.offsetMs);
+    TEST_ASSERT_TRUE(tlmDecodeState(sample.data, sample.len, &out));
+    TEST_ASSERT_EQUAL_INT32(-123455, out.encoder1);
+}
+
+// Health samples survive the round trip, and fixed point values saturate instead of wrapping.
+void test_health_round_trip_and_saturation(void)
+{
+    tlmHealth in = {3600000, 180000, 150000, 110000, 5000, 612, 48, 7, 3, 1};
+    uint8_t wire[TLM_HEALTH_LEN];
+    tlmEncodeHealth(in, wire);
+    TEST_ASSERT_EQUAL_UINT8(TLM_SCHEMA_HEALTH, wire[0]);
+    tlmHealth out;
+    TEST_ASSERT_TRUE(tlmDecodeHealth(wire, sizeof(wire), &out));
+    TEST_ASSERT_EQUAL_UINT32(3600000, out.uptimeMs);
+    TEST_ASSERT_EQUAL_UINT32(180000, out.freeHeap);
+    TEST_ASSERT_EQUAL_UINT32(150000, out.minFreeHeap);
+    TEST_ASSERT_EQUAL_UINT32(110000, out.maxAllocHeap);
+    TEST_ASSERT_EQUAL_UINT16(5000, out.loopPeriodUs);
+    TEST_ASSERT_EQUAL_UINT16(612, out.loopExecMaxUs);
+    TEST_ASSERT_EQUAL_UINT16(48, out.loopJitterMaxUs);
+    TEST_ASSERT_EQUAL_UINT32(7, out.loopOverruns);
+    TEST_ASSERT_EQUAL_UINT32(3, out.telemetryDropped);
+    TEST_ASSERT_EQUAL_UINT32(1, out.stateLost);
+    TEST_ASSERT_EQUAL_INT16(32767, tlmFixed16(400.0f, 100));
+    TEST_ASSERT_EQUAL_INT16(-32768, tlmFixed16(-400.0f, 100));
+    TEST_ASSERT_EQUAL_INT16(0, tlmFixed16(0.0f / 0.0f, 100));
+    TEST_ASSERT_EQUAL_INT16(-1, tlmFixed16(-0.006f, 100));
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, tlmClamp16(70000));
+}
+
+// A reader takes samples from a later version, which only add fields at the end, and refuses short or unknown ones.
+void test_newer_and_unknown_samples(void)
+{
+    uint8_t wire[TLM_STATE_LEN + 4];
+    memset(wire, 0xAA, sizeof(wire));
+    tlmEncodeState(sampleState(), wire);
+    tlmState out;
+    TEST_ASSERT_TRUE(tlmDecodeState(wire, sizeof(wire), &out));
+    TEST_ASSERT_EQUAL_INT32(-123456, out.encoder1);
+    TEST_ASSERT_FALSE(tlmDecodeState(wire, TLM_STATE_LEN - 1, &out));
+    tlmHealth health;
+    TEST_ASSERT_FALSE(tlmDecodeHealth(wire, sizeof(wire), &health));
+    char text[200];
+    wire[0] = 99;
+    TEST_ASSERT_EQUAL_UINT32(0, tlmFormatSample(wire, sizeof(wire), text, sizeof(text)));
+    TEST_ASSERT_NULL(tlmFormatHeader(99));
+}
+
+// Samples print in their natural units, under a header with the same number of columns.
+void test_format_as_csv(void)
+{
+    uint8_t wire[TLM_STATE_LEN];
+    tlmEncodeState(sampleState(), wire);
+    char text[200];
+    size_t n = tlmFormatSample(wire, sizeof(wire), text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("-2.35,12.3,-0.150,0.175,-123456,2000000000,12.1,1.5,0.3,412,1,0", text);
+    TEST_ASSERT_EQUAL_UINT32(strlen(text), n);
+    uint8_t columns = 1;
+    for (const char* c = tlmFormatHeader(TLM_SCHEMA_STATE); *c; c++) columns += (*c == ',');
+    uint8_t fields = 1;
+    for (const char* c = text; *c; c++) fields += (*c == ',');
+    TEST_ASSERT_EQUAL_UINT8(columns, fields);
+    char small[8];
+    n = tlmFormatSample(wire, sizeof(wire), small, sizeof(small));
+    TEST_ASSERT_EQUAL_UINT32(sizeof(small) - 1, n);
+    TEST_ASSERT_EQUAL_STRING("-2.35,1", small);
+}
+
+// I2C samples survive the round trip and print with one column per field and bucket.
+void test_i2c_round_trip_and_csv(void)
+{
+    tlmI2c in = {0, 0x58, 4000000000UL, 123456, 7, 3, 1, 987654, 4321, {}};
+    for (uint8_t i = 0; i < TLM_I2C_BUCKETS; i++) in.buckets[i] = 1000 + i;
+    uint8_t wire[TLM_I2C_LEN];
+    tlmEncodeI2c(in, wire);
+    TEST_ASSERT_EQUAL_UINT8(TLM_SCHEMA_I2C, wire[0]);
+    tlmI2c out;
+    TEST_ASSERT_TRUE(tlmDecodeI2c(wire, sizeof(wire), &out));
+    TEST_ASSERT_FALSE(tlmDecodeI2c(wire, TLM_I2C_LEN - 1, &out));
+    TEST_ASSERT_EQUAL_UINT8(0x58, out.address);
+    TEST_ASSERT_EQUAL_UINT32(4000000000UL, out.transactions);
+    TEST_ASSERT_EQUAL_UINT32(123456, out.bytes);
+    TEST_ASSERT_EQUAL_UINT32(7, out.nacks);
+    TEST_ASSERT_EQUAL_UINT32(3, out.timeouts);
+    TEST_ASSERT_EQUAL_UINT32(1, out.errors);
+    TEST_ASSERT_EQUAL_UINT32(987654, out.busyUs);
+    TEST_ASSERT_EQUAL_UINT32(4321, out.maxUs);
+    for (uint8_t i = 0; i < TLM_I2C_BUCKETS; i++) TEST_ASSERT_EQUAL_UINT32(1000 + i, out.buckets[i]);
+    char text[384];
+    size_t n = tlmFormatSample(wire, sizeof(wire), text, sizeof(text));
+    TEST_ASSERT_EQUAL_UINT32(strlen(text), n);
+    TEST_ASSERT_EQUAL_STRING_LEN("0,0x58,4000000000,123456,7,3,1,987654,4321,1000,1001,", text, 52);
+    uint8_t columns = 1;
+    for (const char* c = tlmFormatHeader(TLM_SCHEMA_I2C); *c; c++) columns += (*c == ',');
+    uint8_t fields = 1;
+    for (const char* c = text; *c; c++) fields += (*c == ',');
+    TEST_ASSERT_EQUAL_UINT8(9 + TLM_I2C_BUCKETS, columns);
+    TEST_ASSERT_EQUAL_UINT8(columns, fields);
+    char small[16];
+    TEST_ASSERT_EQUAL_UINT32(sizeof(small) - 1, tlmFormatSample(wire, sizeof(wire), small, sizeof(small)));
+}
+
+#ifdef ZIPPY_NATIVE
+AsyncMqttClient client; // Client under test, talking to the broker played below.
+static const uint32_t BENCH_SAMPLES = 5000; // Samples per run.
+static const uint32_t BENCH_PERIOD_MS = 10; // 100 Hz, the balance loop's state rate.
+static uint32_t pendingAck = 0; // QoS 1 packet id waiting for the broker's PUBACK.
+
+void onPublish(uint16_t packetId)
+{
+    (void)packetId;
+}
+
+// Broker acknowledges the QoS 1 publish waiting at the head of the client's queue.
+void brokerAck(void)
+{
+    if (pendingAck == 0) return;
+    uint8_t puback[] = {0x40, 0x02, (uint8_t)(pendingAck >> 8), (uint8_t)(pendingAck & 0xFF)};
+    pendingAck = 0;
+    AsyncClient::hostClient()->hostReceive(puback, sizeof(puback));
+}
+
+bool clientSend(void* context, const char* topic, uint8_t qos, const uint8_t* payload, size_t len)
+{
+    (void)context;
+    uint16_t id = client.publish(topic, qos, false, (const char*)payload, len);
+    if (qos > 0) pendingAck = id;
+    return id != 0;
+}
+
+bool clientReady(void* context, size_t wireBytes)
+{
+    (void)context;
+    return client.isSendReady(wireBytes);
+}
+
+// Connect, as aaMqtt does.
+void connectClient(void)
+{
+    static const uint8_t CONNACK[] = {0x20, 0x02, 0x00, 0x00};
+    client.setServer(IPAddress(192, 168, 0, 2), 1883);
+    client.setClientId("zippy");
+    client.onPublish(onPublish);
+    client.connect();
+    AsyncClient::hostClient()->hostAccept();
+    AsyncClient::hostClient()->hostReceive(CONNACK, sizeof(CONNACK));
+}
+
+// What one run put on the wire.
+struct benchResult
+{
+    uint64_t ns; // Time taken.
+    uint32_t bytes; // Bytes passed to the TCP stack.
+    uint32_t writes; // TCP send() calls.
+};
+
+void report(const char* name, const benchResult &r)
+{
+    char text[160];
+    snprintf(text, sizeof(text), "%-9s %5u samples, %5u TCP writes, %7u bytes (%5.1f per sample), %9.0f samples/sec.", name,
+             (unsigned)BENCH_SAMPLES, (unsigned)r.writes, (unsigned)r.bytes, (double)r.bytes / BENCH_SAMPLES,
+             BENCH_SAMPLES * 1e9 / (double)(r.ns ? r.ns : 1));
+    TEST_MESSAGE(text);
+}
+
+// Each sample published on its own, at QoS 1, with the topic rebuilt every time, as aaMqtt::publishMQTT() does. The broker
+// acknowledges each one before the next can go.
+benchResult benchPerSample(void)
+{
+    AsyncClient* tcp = AsyncClient::hostClient();
+    uint32_t bytes = tcp->hostSentBytes();
+    uint32_t writes = tcp->hostSends();
+    uint64_t start = nowNs();
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++)
+    {
+        reading r = {(int16_t)i, (int16_t)-i};
+        char fullTopic[80] = "";
+        strcpy(fullTopic, "agingApprentice/");
+        strcat(fullTopic, "ZippyDEADBEEF0000/tilt");
+        pendingAck = client.publish(fullTopic, 1, false, (const char*)&r, sizeof(r));
+        brokerAck();
+    }
+    return benchResult{nowNs() - start, tcp->hostSentBytes() - bytes, tcp->hostSends() - writes};
+}
+
+// The same samples through amTelemetry, batched every 100ms of sample time at QoS 0.
+benchResult benchBatched(amTelemetry &telemetry, int8_t stream)
+{
+    AsyncClient* tcp = AsyncClient::hostClient();
+    uint32_t bytes = tcp->hostSentBytes();
+    uint32_t writes = tcp->hostSends();
+    uint64_t start = nowNs();
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++)
+    {
+        reading r = {(int16_t)i, (int16_t)-i};
+        telemetry.sample(stream, i * BENCH_PERIOD_MS, &r, sizeof(r));
+        telemetry.poll(i * BENCH_PERIOD_MS);
+    }
+    telemetry.flush();
+    return benchResult{nowNs() - start, tcp->hostSentBytes() - bytes, tcp->hostSends() - writes};
+}
+
+// Batching sends a tenth of the messages and well under half the bytes, and loses nothing when the window has room.
+void test_benchmark_against_per_sample_publish(void)
+{
+    connectClient();
+    TEST_ASSERT_TRUE(client.connected());
+    amTelemetry telemetry(clientSend, clientReady, nullptr);
+    int8_t stream = telemetry.addStream("agingApprentice/", "ZippyDEADBEEF0000/tilt", 100);
+    benchResult perSample = benchPerSample();
+    benchResult batched = benchBatched(telemetry, stream);
+    report("Per sample", perSample);
+    report("Batched", batched);
+    tlmStats stats = telemetry.getStats();
+    TEST_ASSERT_EQUAL_UINT32(BENCH_SAMPLES, stats.samples);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.droppedSamples);
+    TEST_ASSERT_EQUAL_UINT32(BENCH_SAMPLES / 10, stats.batches);
+    TEST_ASSERT_EQUAL_UINT32(stats.wireBytes, batched.bytes); // tlmWireSize() agrees with the client.
+    TEST_ASSERT_EQUAL_UINT32(BENCH_SAMPLES, perSample.writes);
+    TEST_ASSERT_EQUAL_UINT32(BENCH_SAMPLES / 10, batched.writes);
+    TEST_ASSERT_TRUE(batched.bytes * 2 < perSample.bytes);
+    TEST_ASSERT_EQUAL_UINT16(0, AsyncMqttClient::getPacketPoolStats().inUse);
+    TEST_ASSERT_EQUAL_UINT32(0, AsyncMqttClient::getBufferPoolStats().fallbacks);
+}
+
+// A send window too small for a batch, or an event waiting on its PUBACK, holds batches back instead of queueing them in the
+// client, and batches that wait too long are dropped. Nothing piles up in the client's pools.
+void test_backpressure_from_the_real_client(void)
+{
+    amTelemetry telemetry(clientSend, clientReady, nullptr);
+    int8_t stream = telemetry.addStream("agingApprentice/", "ZippyDEADBEEF0000/tilt", 100);
+    int8_t health = telemetry.addEvents("agingApprentice/", "ZippyDEADBEEF0000/health");
+    AsyncClient* tcp = AsyncClient::hostClient();
+    TEST_ASSERT_EQUAL_UINT8(TLM_OK, telemetry.event(health, "Balancing"));
+    TEST_ASSERT_EQUAL_UINT16(1, AsyncMqttClient::getPacketPoolStats().inUse); // Waiting for its PUBACK.
+    reading r = {1, 2};
+    for (uint32_t i = 0; i <= 10; i++) telemetry.sample(stream, i * BENCH_PERIOD_MS, &r, sizeof(r));
+    TEST_ASSERT_EQUAL_UINT32(0, telemetry.getStats().batches); // Would have queued behind the event.
+    TEST_ASSERT_EQUAL_UINT16(1, AsyncMqttClient::getPacketPoolStats().inUse);
+    brokerAck();
+    tcp->hostSetWindow(40); // Smaller than a batch.
+    telemetry.poll(110);
+    TEST_ASSERT_EQUAL_UINT32(0, telemetry.getStats().batches);
+    for (uint32_t i = 11; i < 2000; i++) telemetry.sample(stream, i * BENCH_PERIOD_MS, &r, sizeof(r));
+    TEST_ASSERT_EQUAL_UINT8(TLM_BUSY, telemetry.event(health, "Slow link"));
+    tlmStats stats = telemetry.getStats();
+    TEST_ASSERT_EQUAL_UINT32(0, stats.batches);
+    TEST_ASSERT_TRUE(stats.droppedSamples > 0);
+    TEST_ASSERT_EQUAL_UINT32(2000, stats.samples);
+    TEST_ASSERT_EQUAL_UINT32(stats.samples - stats.droppedSamples, telemetry.getPending(stream));
+    TEST_ASSERT_EQUAL_UINT16(0, AsyncMqttClient::getPacketPoolStats().inUse);
+    tcp->hostSetWindow(HOST_TCP_WINDOW);
+    telemetry.poll(20000);
+    TEST_ASSERT_EQUAL_UINT32(1, telemetry.getStats().batches);
+    char text[120];
+    snprintf(text, sizeof(text), "Window of 40 bytes: %u of %u samples dropped, %u batches held back, 0 queued in the client.",
+             (unsigned)stats.droppedSamples, (unsigned)stats.samples, (unsigned)stats.deferred);
+    TEST_MESSAGE(text);
+}
+
+// A minute of state samples at 100 Hz, as the balance task captures them, and health samples at 1 Hz, through the real client.
+// Every sample goes out, no packet needs the heap, and the total fits in a small fraction of a WiFi link.
+void test_state_at_100hz_fits_wifi_budget(void)
+{
+    static const uint32_t SECONDS = 60;
+    static const uint32_t BUDGET_BYTES_PER_SEC = 4000; // 32 kbit/s. A congested 2.4 GHz link still manages 1 Mbit/s.
+    amTelemetry telemetry(clientSend, clientReady, nullptr);
+    int8_t state = telemetry.addStream("agingApprentice/", "ZippyDEADBEEF0000/state", 100);
+    int8_t health = telemetry.addStream("agingApprentice/", "ZippyDEADBEEF0000/health", 0);
+    AsyncClient* tcp = AsyncClient::hostClient();
+    uint32_t bytes = tcp->hostSentBytes();
+    uint32_t writes = tcp->hostSends();
+    uint32_t fallbacks = AsyncMqttClient::getBufferPoolStats().fallbacks;
+    tlmState s = sampleState();
+    tlmHealth h = {0, 180000, 150000, 110000, 5000, 612, 48, 0, 0, 0};
+    uint64_t start = nowNs();
+    for (uint32_t ms = 0; ms < SECONDS * 1000; ms += BENCH_PERIOD_MS)
+    {
+        s.encoder1 += 3;
+        tlmEncodeState(s, telemetry.reserve(state, ms, TLM_STATE_LEN));
+        if (ms % 1000 == 0)
+        {
+            uint8_t wire[TLM_HEALTH_LEN];
+            h.uptimeMs = ms;
+            tlmEncodeHealth(h, wire);
+            TEST_ASSERT_EQUAL_UINT8(TLM_OK, telemetry.sample(health, ms, wire, sizeof(wire)));
+        }
+        telemetry.poll(ms);
+    }
+    telemetry.flush();
+    uint64_t ns = nowNs() - start;
+    tlmStats stats = telemetry.getStats();
+    uint32_t sent = tcp->hostSentBytes() - bytes;
+    TEST_ASSERT_EQUAL_UINT32(SECONDS * (1000 / BENCH_PERIOD_MS + 1), stats.samples);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.droppedSamples);
+    TEST_ASSERT_EQUAL_UINT32(SECONDS * (10 + 1), tcp->hostSends() - writes);
+    TEST_ASSERT_EQUAL_UINT32(stats.wireBytes, sent);
+    TEST_ASSERT_EQUAL_UINT32(fallbacks, AsyncMqttClient::getBufferPoolStats().fallbacks);
+    TEST_ASSERT_TRUE(sent / SECONDS < BUDGET_BYTES_PER_SEC);
+    char text[160];
+    snprintf(text, sizeof(text), "100 Hz state + 1 Hz health: %u bytes/sec (%.1f kbit/s), %u messages/sec, %.2f us per sample on the host.",
+             (unsigned)(sent / SECONDS), sent * 8.0 / SECONDS / 1000.0, (unsigned)((tcp->hostSends() - writes) / SECONDS),
+             ns / 1000.0 / stats.samples);
+    TEST_MESSAGE(text);
+}
+#endif
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_topics_built_once);
+    RUN_TEST(test_samples_coalesced_into_one_frame);
+    RUN_TEST(test_sample_sends_batch_when_due);
+    RUN_TEST(test_full_frame_sent_early);
+    RUN_TEST(test_backpressure_holds_then_drops_oldest);
+    RUN_TEST(test_events_sent_at_once_or_refused);
+    RUN_TEST(test_wire_size_and_bad_frames);
+    RUN_TEST(test_state_serialized_in_place);
+    RUN_TEST(test_health_round_trip_and_saturation);
+    RUN_TEST(test_newer_and_unknown_samples);
+    RUN_TEST(test_format_as_csv);
+    RUN_TEST(test_i2c_round_trip_and_csv);
+#ifdef ZIPPY_NATIVE
+    RUN_TEST(test_benchmark_against_per_sample_publish);
+    RUN_TEST(test_backpressure_from_the_real_client);
+    RUN_TEST(test_state_at_100hz_fits_wifi_budget);
+#endif
+    return UNITY_END();
+}
+
+#ifndef ZIPPY_NATIVE
+void setup()
+{
+    delay(2000); // Give the serial monitor time to attach.
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,250 @@
+// Host side accuracy tests and benchmark for the amTilt pitch estimators.
+// The reference traces are generated here from a known pitch profile so every run sees the same data: a slow sway with a faster
+// wobble, a sudden lean half way through, a constant gyro bias, white noise on both sensors and MPU6050 quantization.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <amTilt.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+uint64_t nowNs() { return (uint64_t)micros() * 1000; }
+#else
+#include <chrono>
+uint64_t nowNs() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+#endif
+
+const float DT = 0.001f; // 1kHz, as set up by initImu().
+const uint16_t TRACE_LEN = 20000; // 20 seconds.
+const uint16_t WARM_UP = 2000; // Samples ignored while the filters settle.
+const float GYRO_LSB_PER_DPS = 65.5f; // MPU6050_GYRO_500DPS.
+const float ACCEL_LSB_PER_G = 8192.0f; // MPU6050_ACCEL_4G.
+const float GYRO_BIAS = 0.03f; // Radians/second.
+const float TIME_CONSTANT = 0.5f; // Complementary filter time constant in seconds.
+
+mpu6050Sample trace[TRACE_LEN]; // Raw samples.
+float truth[TRACE_LEN]; // True pitch for each sample.
+
+// Small repeatable random number generator so traces are the same on every machine.
+uint32_t seed;
+float noise(float sigma)
+{
+    float sum = 0.0f;
+    for(int i = 0; i < 4; i++) // Sum of uniforms is close enough to gaussian.
+    {
+        seed = seed * 1664525u + 1013904223u;
+        sum += (float)(seed >> 8) / 16777216.0f - 0.5f;
+    }
+    return sum * sigma * 1.732f;
+}
+
+int16_t clampRaw(float value)
+{
+    if(value > 32767.0f) return 32767;
+    if(value < -32768.0f) return -32768;
+    return (int16_t)lroundf(value);
+}
+
+// Build a trace. sensorNoise scales the noise on both sensors.
+void makeTrace(float sensorNoise, uint32_t traceSeed)
+{
+    seed = traceSeed;
+    for(uint16_t i = 0; i < TRACE_LEN; i++)
+    {
+        float t = i * DT;
+        float pitch = 0.15f * sinf(2.0f * (float)M_PI * 0.4f * t) + 0.05f * sinf(2.0f * (float)M_PI * 2.3f * t);
+        float rate = 0.15f * 2.0f * (float)M_PI * 0.4f * cosf(2.0f * (float)M_PI * 0.4f * t) + 0.05f * 2.0f * (float)M_PI * 2.3f * cosf(2.0f * (float)M_PI * 2.3f * t);
+        if(t >= 10.0f) // Lean forward 0.1 radians over 50ms.
+        {
+            float s = (t - 10.0f) / 0.05f;
+            pitch += (s >= 1.0f) ? 0.1f : 0.1f * s;
+            rate += (s >= 1.0f) ? 0.0f : 0.1f / 0.05f;
+        }
+        truth[i] = pitch;
+        float gyro = (rate + GYRO_BIAS + noise(0.005f * sensorNoise)) * 57.29578f * GYRO_LSB_PER_DPS;
+        trace[i] = {clampRaw((sinf(pitch) + noise(0.03f * sensorNoise)) * ACCEL_LSB_PER_G), clampRaw(noise(0.03f * sensorNoise) * ACCEL_LSB_PER_G),
+                    clampRaw((cosf(pitch) + noise(0.03f * sensorNoise)) * ACCEL_LSB_PER_G), 0, 0, clampRaw(gyro), 0};
+    }
+}
+
+// Feed the trace to a filter in FIFO sized batches and return the RMS pitch error after the warm up.
+template <typename F, typename G> float rmsError(F &filter, G angleOf)
+{
+    double sum = 0.0;
+    for(uint16_t i = 0; i < TRACE_LEN; i += 5) // Five samples per 200Hz balance cycle.
+    {
+        filter.updateBatch(&trace[i], 5);
+        if(i + 4 >= WARM_UP)
+        {
+            double e = angleOf(filter) - truth[i + 4];
+            sum += e * e;
+        }
+    }
+    return (float)sqrt(sum / ((TRACE_LEN - WARM_UP) / 5));
+}
+
+float angleF(amTiltComplementary &f) { return f.getAngle(); }
+float angleCQ(amTiltComplementaryQ16 &f) { return q16ToFloat(f.getAngle()); }
+float angleK(amTiltKalman &f) { return f.getAngle(); }
+float angleKQ(amTiltKalmanQ16 &f) { return q16ToFloat(f.getAngle()); }
+
+void setUp(void)
+{
+    makeTrace(1.0f, 12345);
+}
+
+void tearDown(void)
+{
+}
+
+void test_q16_conversions_and_maths(void)
+{
+    TEST_ASSERT_EQUAL_INT32(65536, q16FromFloat(1.0f));
+    TEST_ASSERT_EQUAL_INT32(-32768, q16FromFloat(-0.5f));
+    TEST_ASSERT_EQUAL_FLOAT(1.5f, q16ToFloat(q16Mul(q16FromFloat(0.75f), q16FromFloat(2.0f))));
+    TEST_ASSERT_EQUAL_FLOAT(-0.25f, q16ToFloat(q16Div(q16FromFloat(-1.0f), q16FromFloat(4.0f))));
+}
+
+void test_q16_atan2_all_quadrants(void)
+{
+    float worst = 0.0f;
+    for(int deg = -179; deg <= 180; deg++)
+    {
+        float a = deg * (float)M_PI / 180.0f;
+        int32_t y = (int32_t)lroundf(sinf(a) * 8192.0f);
+        int32_t x = (int32_t)lroundf(cosf(a) * 8192.0f);
+        float e = fabsf(q16ToFloat(q16Atan2(y, x)) - atan2f((float)y, (float)x));
+        if(e > (float)M_PI) e = 2.0f * (float)M_PI - e; // +pi and -pi are the same angle.
+        if(e > worst) worst = e;
+    }
+    TEST_ASSERT_LESS_THAN_FLOAT(0.0016f, worst);
+    TEST_ASSERT_EQUAL_INT32(0, q16Atan2(0, 0));
+}
+
+void test_complementary_float_tracks_reference(void)
+{
+    amTiltComplementary filter(DT, TIME_CONSTANT, GYRO_LSB_PER_DPS);
+    float rms = rmsError(filter, angleF);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.02f, rms); // Gyro bias leaves a small steady offset.
+}
+
+void test_complementary_q16_matches_float(void)
+{
+    amTiltComplementary f(DT, TIME_CONSTANT, GYRO_LSB_PER_DPS);
+    amTiltComplementaryQ16 q(DT, TIME_CONSTANT, GYRO_LSB_PER_DPS);
+    float worst = 0.0f;
+    for(uint16_t i = 0; i < TRACE_LEN; i += 5)
+    {
+        f.updateBatch(&trace[i], 5);
+        q.updateBatch(&trace[i], 5);
+        float e = fabsf(f.getAngle() - q16ToFloat(q.getAngle()));
+        if(e > worst) worst = e;
+    }
+    TEST_ASSERT_LESS_THAN_FLOAT(0.002f, worst);
+}
+
+void test_kalman_float_tracks_reference_and_learns_bias(void)
+{
+    amTiltKalman filter(DT, GYRO_LSB_PER_DPS);
+    float rms = rmsError(filter, angleK);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.005f, rms);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, GYRO_BIAS, filter.getBias());
+}
+
+void test_kalman_q16_tracks_reference_and_learns_bias(void)
+{
+    amTiltKalmanQ16 filter(DT, GYRO_LSB_PER_DPS);
+    float rms = rmsError(filter, angleKQ);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.005f, rms);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, GYRO_BIAS, q16ToFloat(filter.getBias()));
+    TEST_ASSERT_GREATER_THAN_FLOAT(0.0f, filter.getAngleGain());
+    TEST_ASSERT_LESS_THAN_FLOAT(0.0f, filter.getBiasGain()); // Bias moves against the angle error.
+}
+
+void test_kalman_beats_complementary_with_bias(void)
+{
+    amTiltComplementary c(DT, TIME_CONSTANT, GYRO_LSB_PER_DPS);
+    amTiltKalman k(DT, GYRO_LSB_PER_DPS);
+    TEST_ASSERT_LESS_THAN_FLOAT(rmsError(c, angleF), rmsError(k, angleK));
+}
+
+void test_noisier_sensors_still_tracked(void)
+{
+    makeTrace(3.0f, 777);
+    amTiltKalman k(DT, GYRO_LSB_PER_DPS);
+    amTiltKalmanQ16 kq(DT, GYRO_LSB_PER_DPS);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.012f, rmsError(k, angleK));
+    TEST_ASSERT_LESS_THAN_FLOAT(0.012f, rmsError(kq, angleKQ));
+}
+
+void test_mounting_flips_gyro_sign(void)
+{
+    tiltMounting flipped = {TILT_AXIS_X, TILT_AXIS_Z, TILT_AXIS_Y, -1};
+    for(uint16_t i = 0; i < TRACE_LEN; i++)
+    {
+        trace[i].gyroY = (int16_t)-trace[i].gyroY;
+    }
+    amTiltKalman k(DT, GYRO_LSB_PER_DPS, flipped);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.005f, rmsError(k, angleK));
+}
+
+// Not a pass/fail test. Reports the cost of each filter per sample, batch API included.
+template <typename F> float nsPerSample(F &filter)
+{
+    const int passes = 20;
+    uint64_t start = nowNs();
+    for(int p = 0; p < passes; p++)
+    {
+        for(uint16_t i = 0; i < TRACE_LEN; i += 5)
+        {
+            filter.updateBatch(&trace[i], 5);
+        }
+    }
+    return (float)(nowNs() - start) / (passes * (float)TRACE_LEN);
+}
+
+void test_benchmark_ns_per_sample(void)
+{
+    amTiltComplementary c(DT, TIME_CONSTANT, GYRO_LSB_PER_DPS);
+    amTiltComplementaryQ16 cq(DT, TIME_CONSTANT, GYRO_LSB_PER_DPS);
+    amTiltKalman k(DT, GYRO_LSB_PER_DPS);
+    amTiltKalmanQ16 kq(DT, GYRO_LSB_PER_DPS);
+    char msg[160];
+    snprintf(msg, sizeof(msg), "ns/sample: complementary %.1f, complementary Q16 %.1f, Kalman %.1f, Kalman Q16 %.1f",
+             nsPerSample(c), nsPerSample(cq), nsPerSample(k), nsPerSample(kq));
+    TEST_MESSAGE(msg);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_q16_conversions_and_maths);
+    RUN_TEST(test_q16_atan2_all_quadrants);
+    RUN_TEST(test_complementary_float_tracks_reference);
+    RUN_TEST(test_complementary_q16_matches_float);
+    RUN_TEST(test_kalman_float_tracks_reference_and_learns_bias);
+    RUN_TEST(test_kalman_q16_tracks_reference_and_learns_bias);
+    RUN_TEST(test_kalman_beats_complementary_with_bias);
+    RUN_TEST(test_noisier_sensors_still_tracked);
+    RUN_TEST(test_mounting_flips_gyro_sign);
+    RUN_TEST(test_benchmark_ns_per_sample);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+    delay(2000); // service delay
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,372 @@
+// Tests for amProfile and amPath. Profiles are checked against their closed form durations and peak speeds, sampled finely to
+// show that position and velocity never jump, that an S-curve's acceleration never jumps either and its jerk stays within jMax,
+// and that integrating the velocity lands on the distance asked for. Paths are ticked at the balance loop rate to check that
+// segments run back to back on time, that stop() drops everything and that bad segments are refused. The benchmark times one
+// profile evaluation per control tick, which must stay well under 10 us.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <amTrajectory.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+uint64_t nowNs() { return (uint64_t)micros() * 1000; }
+#else
+#include <chrono>
+uint64_t nowNs() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+#endif
+
+const profileLimits LIMITS = {0.3f, 0.5f, 2.0f}; // m/s, m/s/s, m/s/s/s.
+const profileLimits TURN_LIMITS = {1.5f, 3.0f, 15.0f}; // rad/s, rad/s/s, rad/s/s/s.
+const uint32_t TICK_US = 5000; // 200 Hz balance loop.
+
+// Largest step in position, velocity and acceleration between samples dt apart, and the distance the velocity integrates to.
+struct sweep
+{
+    float maxDp = 0;
+    float maxDv = 0;
+    float maxDa = 0;
+    float maxV = 0;
+    float maxA = 0;
+    double integral = 0;
+    void run(const amProfile &p, float duration, float dt)
+    {
+        profilePoint last = p.at(0.0f);
+        for(float t = dt; t < duration + 4 * dt; t += dt)
+        {
+            profilePoint now = p.at(t);
+            maxDp = fmaxf(maxDp, fabsf(now.position - last.position));
+            maxDv = fmaxf(maxDv, fabsf(now.velocity - last.velocity));
+            maxDa = fmaxf(maxDa, fabsf(now.accel - last.accel));
+            maxV = fmaxf(maxV, fabsf(now.velocity));
+            maxA = fmaxf(maxA, fabsf(now.accel));
+            integral += 0.5 * (now.velocity + last.velocity) * dt;
+            last = now;
+        }
+    }
+};
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Long enough to cruise: ramp up, cruise, ramp down, in d / v + v / a.
+void test_trapezoid_cruises(void)
+{
+    amProfile p;
+    TEST_ASSERT_TRUE(p.plan(PROFILE_TRAPEZOID, 1.0f, LIMITS));
+    TEST_ASSERT_EQUAL_UINT8(3, p.getPhases());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f / 0.3f + 0.3f / 0.5f, p.getDuration());
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.3f, p.getPeakVelocity());
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.5f, p.at(0.1f).accel);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.3f, p.at(p.getDuration() * 0.5f).velocity);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, -0.5f, p.at(p.getDuration() - 0.1f).accel);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.5f, p.at(p.getDuration() * 0.5f).position); // Symmetric.
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, p.at(p.getDuration()).position);
+}
+
+// Too short to reach vMax: a triangle peaking at sqrt(d * a).
+void test_trapezoid_triangle(void)
+{
+    amProfile p;
+    TEST_ASSERT_TRUE(p.plan(PROFILE_TRAPEZOID, 0.1f, LIMITS));
+    TEST_ASSERT_EQUAL_UINT8(2, p.getPhases());
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, sqrtf(0.1f * 0.5f), p.getPeakVelocity());
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 2.0f * sqrtf(0.1f / 0.5f), p.getDuration());
+}
+
+// Long enough to reach vMax and aMax: all seven phases, in d / v + v / a + a / j.
+void test_scurve_full(void)
+{
+    amProfile p;
+    TEST_ASSERT_TRUE(p.plan(PROFILE_SCURVE, 1.0f, LIMITS));
+    TEST_ASSERT_EQUAL_UINT8(7, p.getPhases());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f / 0.3f + 0.3f / 0.5f + 0.5f / 2.0f, p.getDuration());
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.3f, p.getPeakVelocity());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, p.at(0.0001f).accel); // Acceleration ramps up from 0.
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.5f, p.at(p.getDuration() * 0.5f).position);
+}
+
+// Too short for vMax but aMax still reached, then too short for aMax as well.
+void test_scurve_short_moves(void)
+{
+    amProfile p;
+    TEST_ASSERT_TRUE(p.plan(PROFILE_SCURVE, 0.15f, LIMITS));
+    TEST_ASSERT_EQUAL_UINT8(6, p.getPhases()); // No cruise.
+    float v = p.getPeakVelocity();
+    TEST_ASSERT_TRUE(v < 0.3f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.15f, v * (v / 0.5f + 0.5f / 2.0f)); // Ramps up and down cover the move.
+    sweep s;
+    s.run(p, p.getDuration(), 0.0005f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.5f, s.maxA); // aMax reached.
+
+    TEST_ASSERT_TRUE(p.plan(PROFILE_SCURVE, 0.01f, LIMITS));
+    TEST_ASSERT_EQUAL_UINT8(4, p.getPhases()); // No cruise, no constant acceleration.
+    v = p.getPeakVelocity();
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, powf(0.5f * 0.01f * sqrtf(2.0f), 2.0f / 3.0f), v);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 4.0f * sqrtf(v / 2.0f), p.getDuration());
+    sweep t;
+    t.run(p, p.getDuration(), 0.0005f);
+    TEST_ASSERT_TRUE(t.maxA < 0.5f);
+}
+
+// vMax is reached before a jerk ramp would get to aMax, so aMax is never reached.
+void test_scurve_low_speed(void)
+{
+    amProfile p;
+    profileLimits slow = {0.05f, 0.5f, 2.0f};
+    TEST_ASSERT_TRUE(p.plan(PROFILE_SCURVE, 0.2f, slow));
+    float a = sqrtf(0.05f * 2.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.05f, p.getPeakVelocity());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.2f / 0.05f + 2.0f * a / 2.0f, p.getDuration());
+    sweep s;
+    s.run(p, p.getDuration(), 0.0005f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, a, s.maxA);
+}
+
+// Sampled every 1 ms, nothing jumps: position by at most vMax * dt, velocity by aMax * dt, and for the S-curve acceleration
+// by jMax * dt. The trapezoid's acceleration does step. Every profile integrates to its distance and keeps to its limits.
+void test_continuity(void)
+{
+    const float dt = 0.001f;
+    const float distances[] = {1.0f, 0.15f, 0.01f, -0.6f};
+    for(uint8_t shape = PROFILE_TRAPEZOID; shape <= PROFILE_SCURVE; shape++)
+    {
+        for(float d : distances)
+        {
+            amProfile p;
+            TEST_ASSERT_TRUE(p.plan(shape, d, LIMITS));
+            sweep s;
+            s.run(p, p.getDuration(), dt);
+            TEST_ASSERT_TRUE(s.maxDp <= LIMITS.vMax * dt * 1.001f);
+            TEST_ASSERT_TRUE(s.maxDv <= LIMITS.aMax * dt * 1.001f);
+            TEST_ASSERT_TRUE(s.maxV <= LIMITS.vMax * 1.0001f);
+            TEST_ASSERT_TRUE(s.maxA <= LIMITS.aMax * 1.0001f);
+            TEST_ASSERT_FLOAT_WITHIN(fabsf(d) * 1e-3f, d, (float)s.integral);
+            if(shape == PROFILE_SCURVE)
+            {
+                TEST_ASSERT_TRUE(s.maxDa <= LIMITS.jMax * dt * 1.001f);
+            }
+            else
+            {
+                TEST_ASSERT_TRUE(s.maxDa > LIMITS.aMax * 0.5f);
+            }
+        }
+    }
+}
+
+// The phases carry on from each other, so the end of the last one is at rest on the distance before at() snaps to it.
+void test_lands_at_rest(void)
+{
+    amProfile p;
+    TEST_ASSERT_TRUE(p.plan(PROFILE_SCURVE, 2.5f, LIMITS));
+    profilePoint end = p.at(p.getDuration() * 0.99999f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 2.5f, end.position);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, end.velocity);
+    profilePoint after = p.at(p.getDuration() + 1.0f);
+    TEST_ASSERT_EQUAL_FLOAT(2.5f, after.position);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, after.velocity);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, after.accel);
+}
+
+// A negative distance is the mirror image of the positive one.
+void test_negative_mirrors(void)
+{
+    amProfile fwd;
+    amProfile back;
+    TEST_ASSERT_TRUE(fwd.plan(PROFILE_SCURVE, 0.4f, LIMITS));
+    TEST_ASSERT_TRUE(back.plan(PROFILE_SCURVE, -0.4f, LIMITS));
+    TEST_ASSERT_EQUAL_FLOAT(fwd.getDuration(), back.getDuration());
+    for(float t = 0.0f; t < fwd.getDuration(); t += 0.05f)
+    {
+        TEST_ASSERT_EQUAL_FLOAT(-fwd.at(t).position, back.at(t).position);
+        TEST_ASSERT_EQUAL_FLOAT(-fwd.at(t).velocity, back.at(t).velocity);
+    }
+}
+
+// No distance is a move of no time. Limits that cannot be met are refused.
+void test_degenerate(void)
+{
+    amProfile p;
+    TEST_ASSERT_TRUE(p.plan(PROFILE_SCURVE, 0.0f, LIMITS));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, p.getDuration());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, p.at(1.0f).position);
+    TEST_ASSERT_FALSE(p.plan(PROFILE_TRAPEZOID, 1.0f, {0.0f, 0.5f, 0.0f}));
+    TEST_ASSERT_FALSE(p.plan(PROFILE_SCURVE, 1.0f, {0.3f, 0.5f, 0.0f}));
+    TEST_ASSERT_TRUE(p.plan(PROFILE_TRAPEZOID, 1.0f, {0.3f, 0.5f, 0.0f})); // Jerk not needed.
+    TEST_ASSERT_FALSE(p.plan(7, 1.0f, LIMITS));
+    TEST_ASSERT_FALSE(p.plan(PROFILE_SCURVE, NAN, LIMITS));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, p.getDuration());
+}
+
+// A straight then a turn, ticked at 200 Hz from a clock that wraps. The turn starts the moment the straight ends, the distance
+// and angle integrate out right, and the path takes the sum of the two durations.
+void test_path_runs_segments_back_to_back(void)
+{
+    amPath path(LIMITS, TURN_LIMITS);
+    amProfile straight;
+    amProfile turn;
+    straight.plan(PROFILE_SCURVE, 0.5f, LIMITS);
+    turn.plan(PROFILE_TRAPEZOID, -1.5708f, TURN_LIMITS);
+    TEST_ASSERT_TRUE(path.add({PATH_STRAIGHT, PROFILE_SCURVE, 0.5f}));
+    TEST_ASSERT_TRUE(path.add({PATH_TURN, PROFILE_TRAPEZOID, -1.5708f}));
+    TEST_ASSERT_EQUAL_UINT16(2, path.getQueued());
+    uint32_t us = 0xFFFFFFFF - 1000000; // micros() wraps part way through.
+    uint32_t startUs = us;
+    double driven = 0;
+    double turned = 0;
+    uint32_t lastActiveUs = us;
+    bool turning = false;
+    for(uint32_t i = 0; i < 2000; i++, us += TICK_US)
+    {
+        pathSetpoint sp = path.tick(us);
+        if(sp.active == false)
+        {
+            continue;
+        }
+        lastActiveUs = us;
+        TEST_ASSERT_TRUE(sp.speed == 0.0f || sp.turnRate == 0.0f); // One kind of segment at a time.
+        if(sp.turnRate != 0.0f && turning == false)
+        {
+            turning = true;
+            uint32_t intoTurnUs = us - startUs - (uint32_t)(straight.getDuration() * 1000000.0f + 0.5f);
+            TEST_ASSERT_TRUE(intoTurnUs < TICK_US); // First turn tick comes within a tick of the straight ending.
+            TEST_ASSERT_FLOAT_WITHIN(1e-4f, turn.at(intoTurnUs * 0.000001f).velocity, sp.turnRate);
+        }
+        driven += sp.speed * TICK_US * 0.000001;
+        turned += sp.turnRate * TICK_US * 0.000001;
+    }
+    float totalUs = (straight.getDuration() + turn.getDuration()) * 1000000.0f;
+    TEST_ASSERT_TRUE(lastActiveUs - startUs < (uint32_t)totalUs);
+    TEST_ASSERT_TRUE(lastActiveUs - startUs + TICK_US >= (uint32_t)totalUs);
+    TEST_ASSERT_FLOAT_WITHIN(0.002f, 0.5f, (float)driven);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -1.5708f, (float)turned);
+    TEST_ASSERT_FALSE(path.isBusy());
+    TEST_ASSERT_EQUAL_UINT32(2, path.getStarted());
+    TEST_ASSERT_EQUAL_UINT32(2, path.getFinished());
+}
+
+// Ticks slower than a whole segment still start each segment when the one before it ended.
+void test_path_keeps_time_across_slow_ticks(void)
+{
+    amPath path(LIMITS, TURN_LIMITS);
+    amProfile p;
+    p.plan(PROFILE_TRAPEZOID, 0.01f, LIMITS);
+    uint32_t durationUs = (uint32_t)(p.getDuration() * 1000000.0f + 0.5f);
+    for(uint8_t i = 0; i < 3; i++)
+    {
+        TEST_ASSERT_TRUE(path.add({PATH_STRAIGHT, PROFILE_TRAPEZOID, 0.01f}));
+    }
+    TEST_ASSERT_TRUE(path.tick(1000).active);
+    pathSetpoint sp = path.tick(1000 + 2 * durationUs + durationUs / 2); // Half way through the third.
+    TEST_ASSERT_TRUE(sp.active);
+    TEST_ASSERT_EQUAL_UINT32(2, path.getFinished());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, p.getPeakVelocity(), sp.speed);
+    TEST_ASSERT_FALSE(path.tick(1000 + 3 * durationUs).active);
+    TEST_ASSERT_EQUAL_UINT32(3, path.getFinished());
+}
+
+// stop() drops the running segment and everything queued, and the path takes new segments after.
+void test_path_stop(void)
+{
+    amPath path(LIMITS, TURN_LIMITS);
+    for(uint8_t i = 0; i < 4; i++)
+    {
+        TEST_ASSERT_TRUE(path.add({PATH_STRAIGHT, PROFILE_SCURVE, 1.0f}));
+    }
+    TEST_ASSERT_TRUE(path.tick(0).active);
+    TEST_ASSERT_TRUE(path.tick(500000).speed > 0.0f);
+    path.stop();
+    pathSetpoint sp = path.tick(505000);
+    TEST_ASSERT_FALSE(sp.active);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, sp.speed);
+    TEST_ASSERT_FALSE(path.isBusy());
+    TEST_ASSERT_EQUAL_UINT16(0, path.getQueued());
+    TEST_ASSERT_EQUAL_UINT32(4, path.getStopped());
+    TEST_ASSERT_EQUAL_UINT32(0, path.getFinished());
+    TEST_ASSERT_TRUE(path.add({PATH_TURN, PROFILE_SCURVE, 1.0f}));
+    TEST_ASSERT_TRUE(path.tick(600000).active);
+    TEST_ASSERT_TRUE(path.tick(700000).turnRate > 0.0f);
+}
+
+// Segments that are not valid, or that do not fit, are refused and counted.
+void test_path_rejects(void)
+{
+    amPath path(LIMITS, TURN_LIMITS);
+    TEST_ASSERT_FALSE(path.add({2, PROFILE_SCURVE, 1.0f}));
+    TEST_ASSERT_FALSE(path.add({PATH_TURN, 2, 1.0f}));
+    TEST_ASSERT_FALSE(path.add({PATH_TURN, PROFILE_SCURVE, INFINITY}));
+    for(uint8_t i = 0; i < PATH_QUEUE; i++)
+    {
+        TEST_ASSERT_TRUE(path.add({PATH_STRAIGHT, PROFILE_SCURVE, 0.1f}));
+    }
+    TEST_ASSERT_FALSE(path.add({PATH_STRAIGHT, PROFILE_SCURVE, 0.1f}));
+    TEST_ASSERT_EQUAL_UINT32(4, path.getRejected());
+    amPath broken({0.0f, 0.0f, 0.0f}, TURN_LIMITS); // Straight limits that cannot be planned.
+    TEST_ASSERT_TRUE(broken.add({PATH_STRAIGHT, PROFILE_SCURVE, 0.1f}));
+    TEST_ASSERT_FALSE(broken.tick(0).active);
+    TEST_ASSERT_EQUAL_UINT32(1, broken.getStopped());
+}
+
+// One S-curve evaluation per control tick.
+void test_benchmark_at(void)
+{
+    const uint32_t POINTS = 100000;
+    amProfile p;
+    p.plan(PROFILE_SCURVE, 1.0f, LIMITS);
+    float dt = p.getDuration() / POINTS;
+    volatile float sink = 0.0f;
+    uint64_t start = nowNs();
+    for(uint32_t i = 0; i < POINTS; i++)
+    {
+        sink = sink + p.at(i * dt).velocity;
+    }
+    uint64_t ns = (nowNs() - start) / POINTS;
+    char msg[64];
+    snprintf(msg, sizeof(msg), "ns/point: %lu", (unsigned long)ns);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(sink > 0.0f);
+    TEST_ASSERT_TRUE(ns < 10000);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_trapezoid_cruises);
+    RUN_TEST(test_trapezoid_triangle);
+    RUN_TEST(test_scurve_full);
+    RUN_TEST(test_scurve_short_moves);
+    RUN_TEST(test_scurve_low_speed);
+    RUN_TEST(test_continuity);
+    RUN_TEST(test_lands_at_rest);
+    RUN_TEST(test_negative_mirrors);
+    RUN_TEST(test_degenerate);
+    RUN_TEST(test_path_runs_segments_back_to_back);
+    RUN_TEST(test_path_keeps_time_across_slow_ticks);
+    RUN_TEST(test_path_stop);
+    RUN_TEST(test_path_rejects);
+    RUN_TEST(test_benchmark_at);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+    delay(2000); // Give the board time to open the serial port.
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main(void)
+{
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,297 @@
+// Tests for bringing WiFi up without holding up the boot.
+// amWifiLink is checked on both targets by feeding it events and times. On the host aaNetwork itself is then run against the
+// stand-in radio of native/WiFi.h: a first boot that has to scan, a second boot that joins the remembered access point without
+// one, an access point that has moved channel, no known access point at all, and an access point that drops us.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <amWifiLink.h>
+
+#ifdef ZIPPY_NATIVE
+// aaNetwork talks to the host stand-in of WiFi. Tests do not build native/ on their own.
+#include "../../native/hostArduino.cpp"
+#include "../../native/hostFreeRTOS.cpp"
+#include "../../native/hostNetwork.cpp"
+#include <aaNetwork.h>
+#endif
+
+static const uint32_t FAST_MS = 3000;
+static const uint32_t ATTEMPT_MS = 15000;
+static const uint32_t FIRST_MS = 2000;
+static const uint32_t MAX_MS = 60000;
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// With an access point remembered the first attempt joins it straight away and no scan is made.
+void test_fast_connect_first(void)
+{
+    amWifiLink link(FAST_MS, ATTEMPT_MS, FIRST_MS, MAX_MS);
+    TEST_ASSERT_EQUAL_UINT8(WF_NONE, link.poll(100));
+    link.start(100, true);
+    TEST_ASSERT_EQUAL_UINT8(WF_FAST_CONNECT, link.poll(100));
+    TEST_ASSERT_EQUAL_UINT8(WF_FAST, link.getState());
+    TEST_ASSERT_EQUAL_UINT8(WF_NONE, link.poll(100 + FAST_MS - 1));
+    link.gotIp(400);
+    TEST_ASSERT_EQUAL_UINT8(WF_UP, link.getState());
+    TEST_ASSERT_EQUAL_UINT32(300, link.getTimeToIpMs());
+    TEST_ASSERT_TRUE(link.getFastWasUsed());
+    TEST_ASSERT_EQUAL_UINT32(0, link.getScans());
+    TEST_ASSERT_EQUAL_UINT32(1, link.getFastWins());
+}
+
+// A fast connect that gets nowhere is stopped and a scan takes over. Time to IP counts from start().
+void test_fast_timeout_scans(void)
+{
+    amWifiLink link(FAST_MS, ATTEMPT_MS, FIRST_MS, MAX_MS);
+    link.start(0, true);
+    TEST_ASSERT_EQUAL_UINT8(WF_FAST_CONNECT, link.poll(0));
+    TEST_ASSERT_EQUAL_UINT8(WF_ABORT, link.poll(FAST_MS));
+    TEST_ASSERT_EQUAL_UINT8(WF_SCAN, link.poll(FAST_MS));
+    TEST_ASSERT_EQUAL_UINT8(WF_SCANNING, link.getState());
+    link.scanDone(FAST_MS + 2000, true);
+    TEST_ASSERT_EQUAL_UINT8(WF_JOIN, link.poll(FAST_MS + 2000));
+    TEST_ASSERT_EQUAL_UINT8(WF_JOINING, link.getState());
+    link.gotIp(FAST_MS + 2500);
+    TEST_ASSERT_EQUAL_UINT32(FAST_MS + 2500, link.getTimeToIpMs());
+    TEST_ASSERT_FALSE(link.getFastWasUsed());
+}
+
+// A fast connect that is refused goes to the scan without waiting out its time.
+void test_fast_refused_scans(void)
+{
+    amWifiLink link(FAST_MS, ATTEMPT_MS, FIRST_MS, MAX_MS);
+    link.start(0, true);
+    link.poll(0);
+    link.lost(200);
+    TEST_ASSERT_EQUAL_UINT8(WF_SCAN, link.poll(200));
+    TEST_ASSERT_EQUAL_UINT8(0, link.getFailures());
+}
+
+// Scans that find nothing wait twice as long each time, up to the cap, and an IP address starts the backoff over.
+void test_backoff_doubles_to_cap(void)
+{
+    amWifiLink link(FAST_MS, ATTEMPT_MS, FIRST_MS, MAX_MS);
+    uint32_t now = 0xFFFFF000; // Wraps part way through.
+    link.start(now, false);
+    TEST_ASSERT_EQUAL_UINT8(WF_SCAN, link.poll(now));
+    uint32_t expect = FIRST_MS;
+    for (uint8_t i = 1; i <= 8; i++)
+    {
+        link.scanDone(now, false);
+        TEST_ASSERT_EQUAL_UINT8(WF_WAITING, link.getState());
+        TEST_ASSERT_EQUAL_UINT32(expect, link.getWaitMs(now));
+        TEST_ASSERT_EQUAL_UINT8(i, link.getFailures());
+        TEST_ASSERT_EQUAL_UINT8(WF_NONE, link.poll(now + expect - 1));
+        now += expect;
+        TEST_ASSERT_EQUAL_UINT8(WF_SCAN, link.poll(now));
+        expect = (expect * 2 < MAX_MS) ? expect * 2 : MAX_MS;
+    }
+    link.scanDone(now, true);
+    TEST_ASSERT_EQUAL_UINT8(WF_JOIN, link.poll(now));
+    link.gotIp(now + 100);
+    TEST_ASSERT_EQUAL_UINT8(0, link.getFailures());
+    link.lost(now + 200);
+    TEST_ASSERT_EQUAL_UINT8(WF_SCAN, link.poll(now + 200));
+    link.scanDone(now + 300, false);
+    TEST_ASSERT_EQUAL_UINT32(FIRST_MS, link.getWaitMs(now + 300));
+}
+
+// A join that never gets an address is stopped after attemptTimeoutMs and backs off.
+void test_join_timeout_backs_off(void)
+{
+    amWifiLink link(FAST_MS, ATTEMPT_MS, FIRST_MS, MAX_MS);
+    link.start(0, false);
+    link.poll(0);
+    link.scanDone(2000, true);
+    TEST_ASSERT_EQUAL_UINT8(WF_JOIN, link.poll(2000));
+    TEST_ASSERT_EQUAL_UINT8(WF_NONE, link.poll(ATTEMPT_MS - 1));
+    TEST_ASSERT_EQUAL_UINT8(WF_ABORT, link.poll(ATTEMPT_MS));
+    TEST_ASSERT_EQUAL_UINT8(WF_WAITING, link.getState());
+    TEST_ASSERT_EQUAL_UINT8(WF_SCAN, link.poll(ATTEMPT_MS + FIRST_MS));
+}
+
+// Losing the connection goes back to the fast connect, and only the first IP address sets time to IP.
+void test_lost_goes_fast(void)
+{
+    amWifiLink link(FAST_MS, ATTEMPT_MS, FIRST_MS, MAX_MS);
+    link.start(0, false);
+    link.poll(0);
+    link.scanDone(1500, true);
+    link.poll(1500);
+    link.gotIp(1800);
+    link.setCache(true); // Owner remembered where it got the address.
+    link.lost(50000);
+    TEST_ASSERT_EQUAL_UINT8(WF_FAST_CONNECT, link.poll(50000));
+    link.gotIp(50200);
+    TEST_ASSERT_EQUAL_UINT32(1800, link.getTimeToIpMs());
+    TEST_ASSERT_EQUAL_UINT32(1, link.getLosses());
+    TEST_ASSERT_EQUAL_UINT32(1, link.getFastWins());
+    link.stop();
+    TEST_ASSERT_EQUAL_UINT8(WF_NONE, link.poll(60000));
+}
+
+#ifdef ZIPPY_NATIVE
+static const char* AP = "MN_WORKSHOP_2.4GHz"; // One of the names in known_networks.h.
+
+// Access point in range, scans and joins instant, nothing remembered from an earlier test.
+void resetRadio(void)
+{
+    WiFi.disconnect();
+    WiFi.hostSetAccessPoint(AP, -50, IPAddress(192, 168, 2, 50));
+    WiFi.hostSetChannel(HOST_AP_CHANNEL);
+    WiFi.hostSetTimes(0, 0, 0);
+    aaNetwork net("Test");
+    net.forgetAP();
+}
+
+// Poll until WiFi is up or the attempts run out. Returns the polls it took.
+uint16_t pollUntilUp(aaNetwork &net, uint16_t limit)
+{
+    uint16_t polls = 0;
+    while (net.getLink().getState() != WF_UP && polls < limit)
+    {
+        net.poll(millis());
+        polls++;
+    }
+    return polls;
+}
+
+// First boot scans, joins, and remembers the access point. The next boot joins it on its channel without scanning.
+void test_net_first_boot_scans_then_fast(void)
+{
+    resetRadio();
+    {
+        aaNetwork net("Test");
+        uint32_t scans = WiFi.hostScans();
+        net.connect();
+        pollUntilUp(net, 10);
+        TEST_ASSERT_EQUAL_UINT8(WF_UP, net.getLink().getState());
+        TEST_ASSERT_TRUE(net.areWeConnected());
+        TEST_ASSERT_EQUAL_UINT32(scans + 1, WiFi.hostScans());
+        TEST_ASSERT_FALSE(net.getLink().getFastWasUsed());
+        TEST_ASSERT_EQUAL_INT32(HOST_AP_CHANNEL, WiFi.hostLastJoinChannel());
+    }
+    WiFi.disconnect(); // Reboot.
+    aaNetwork net("Test");
+    uint32_t scans = WiFi.hostScans();
+    uint32_t joins = WiFi.hostJoins();
+    net.connect();
+    pollUntilUp(net, 10);
+    TEST_ASSERT_EQUAL_UINT8(WF_UP, net.getLink().getState());
+    TEST_ASSERT_TRUE(net.getLink().getFastWasUsed());
+    TEST_ASSERT_EQUAL_UINT32(scans, WiFi.hostScans());
+    TEST_ASSERT_EQUAL_UINT32(joins + 1, WiFi.hostJoins());
+    TEST_ASSERT_EQUAL_INT32(HOST_AP_CHANNEL, WiFi.hostLastJoinChannel());
+    TEST_ASSERT_EQUAL_INT32(-50, net.getSignalStrength());
+}
+
+// An access point that has moved channel fails the fast connect, is found by a scan, and is remembered on its new channel.
+void test_net_moved_channel_rescans(void)
+{
+    resetRadio();
+    {
+        aaNetwork net("Test");
+        net.connect();
+        pollUntilUp(net, 10);
+    }
+    WiFi.disconnect(); // Reboot, and the access point moves.
+    WiFi.hostSetChannel(11);
+    {
+        aaNetwork net("Test");
+        uint32_t scans = WiFi.hostScans();
+        net.connect();
+        pollUntilUp(net, 10);
+        TEST_ASSERT_EQUAL_UINT8(WF_UP, net.getLink().getState());
+        TEST_ASSERT_FALSE(net.getLink().getFastWasUsed());
+        TEST_ASSERT_EQUAL_UINT32(1, net.getLink().getFastConnects());
+        TEST_ASSERT_EQUAL_UINT32(scans + 1, WiFi.hostScans());
+        TEST_ASSERT_EQUAL_INT32(11, WiFi.hostLastJoinChannel());
+    }
+    WiFi.disconnect(); // Next boot goes straight to the new channel.
+    aaNetwork net("Test");
+    net.connect();
+    pollUntilUp(net, 10);
+    TEST_ASSERT_TRUE(net.getLink().getFastWasUsed());
+    TEST_ASSERT_EQUAL_INT32(11, WiFi.hostLastJoinChannel());
+}
+
+// With no known access point in range connect() returns at once and the scans back off.
+void test_net_no_ap_returns_at_once(void)
+{
+    resetRadio();
+    WiFi.hostSetAccessPoint("", -127, IPAddress(0, 0, 0, 0));
+    WiFi.hostSetTimes(200, 0, 0); // A scan takes a while.
+    aaNetwork net("Test");
+    uint32_t start = millis();
+    net.connect();
+    TEST_ASSERT_TRUE(millis() - start < 50);
+    TEST_ASSERT_EQUAL_UINT8(WF_SCANNING, net.getLink().getState());
+    net.poll(millis());
+    TEST_ASSERT_EQUAL_UINT8(WF_SCANNING, net.getLink().getState()); // Scan still running.
+    delay(250);
+    net.poll(millis());
+    TEST_ASSERT_EQUAL_UINT8(WF_WAITING, net.getLink().getState());
+    TEST_ASSERT_EQUAL_UINT8(1, net.getLink().getFailures());
+    TEST_ASSERT_FALSE(net.areWeConnected());
+}
+
+// Dropped by the access point, we rejoin it without a scan and time to IP keeps its first value.
+void test_net_drop_fast_reconnects(void)
+{
+    resetRadio();
+    aaNetwork net("Test");
+    net.connect();
+    pollUntilUp(net, 10);
+    uint32_t timeToIp = net.getTimeToIpMs();
+    uint32_t scans = WiFi.hostScans();
+    WiFi.hostDrop();
+    net.poll(millis());
+    pollUntilUp(net, 10);
+    TEST_ASSERT_EQUAL_UINT8(WF_UP, net.getLink().getState());
+    TEST_ASSERT_EQUAL_UINT32(scans, WiFi.hostScans());
+    TEST_ASSERT_EQUAL_UINT32(1, net.getLink().getLosses());
+    TEST_ASSERT_EQUAL_UINT32(timeToIp, net.getTimeToIpMs());
+}
+#endif
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fast_connect_first);
+    RUN_TEST(test_fast_timeout_scans);
+    RUN_TEST(test_fast_refused_scans);
+    RUN_TEST(test_backoff_doubles_to_cap);
+    RUN_TEST(test_join_timeout_backs_off);
+    RUN_TEST(test_lost_goes_fast);
+#ifdef ZIPPY_NATIVE
+    RUN_TEST(test_net_first_boot_scans_then_fast);
+    RUN_TEST(test_net_moved_channel_rescans);
+    RUN_TEST(test_net_no_ap_returns_at_once);
+    RUN_TEST(test_net_drop_fast_reconnects);
+#endif
+    return UNITY_END();
+}
+
+#ifndef ZIPPY_NATIVE
+#include <Arduino.h>
+
+void setup()
+{
+    delay(2000); // Give the board time to open the serial port.
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runUnityTests();
+}
+#endif
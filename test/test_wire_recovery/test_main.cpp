@@ -0,0 +1,312 @@
+// Fault injection tests for amWireBus, the TwoWire layer under every I2C driver.
+// On the host Wire is put in front of a fake bus that can drop the bytes of a read, fail a write, or have a device hold SDA low
+// until SCL has been pulsed a number of times, or for good. No call may wait longer than its retries allow, a held SDA must be
+// clocked free and followed by a STOP, a NACK on the address must not be retried, and every fault must show in the counters.
+// https://docs.platformio.org/en/latest/plus/unit-testing.html
+#include <unity.h>
+#include <string.h>
+#include <Arduino.h>
+#include <amWireBus.h>
+#include <amMD25Driver.h>
+
+#ifdef ZIPPY_NATIVE
+// amWireBus drives the host stand-in of TwoWire and the host GPIO. Tests do not build native/ on their own.
+#include "../../native/hostArduino.cpp"
+#include "../../native/hostFreeRTOS.cpp"
+#include "../../native/hostWire.cpp"
+#endif
+
+static const int SDA_PIN = 21;
+static const int SCL_PIN = 22;
+static const uint8_t DEVICE = 0x58; // Where the MD25 lives.
+static const uint32_t LIMIT_US = (I2C_WIRE_RETRIES + 1) * I2C_WIRE_TIMEOUT_MS * 1000UL + 5000; // Every try timing out, plus slack.
+
+amWireBus wireBus(Wire);
+
+#ifdef ZIPPY_NATIVE
+// One device whose registers count up from 0x10. It can lose the bytes of reads, fail writes, and reads SDA so that while a
+// device holds it nothing on the bus gets through.
+class faultBus : public amI2cBus
+{
+    public:
+        uint8_t regs[32];
+        uint8_t dropReads = 0; // Reads still to lose.
+        uint8_t failWrites = 0; // Writes still to fail.
+        uint16_t reads = 0;
+        uint16_t writes = 0;
+        void reset()
+        {
+            for(uint8_t i = 0; i < sizeof(regs); i++) regs[i] = 0x10 + i;
+            dropReads = 0;
+            failWrites = 0;
+            reads = 0;
+            writes = 0;
+        }
+        uint8_t writeRegs(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t len)
+        {
+            writes++;
+            if(held()) return I2C_ERR_OTHER;
+            if(address != DEVICE) return I2C_ERR_NACK_ADDR;
+            if(failWrites > 0)
+            {
+                failWrites--;
+                return I2C_ERR_TIMEOUT;
+            }
+            memcpy(regs + reg, data, len);
+            return I2C_OK;
+        }
+        uint8_t readRegs(uint8_t address, uint8_t reg, uint8_t* dest, uint8_t len)
+        {
+            reads++;
+            if(held()) return I2C_ERR_TIMEOUT;
+            if(address != DEVICE) return I2C_ERR_NACK_ADDR;
+            if(dropReads > 0)
+            {
+                dropReads--;
+                return I2C_ERR_TIMEOUT; // TwoWire hands back no bytes.
+            }
+            memcpy(dest, regs + reg, len);
+            return I2C_OK;
+        }
+        uint8_t probe(uint8_t address)
+        {
+            if(held()) return I2C_ERR_OTHER;
+            return (address == DEVICE) ? I2C_OK : I2C_ERR_NACK_ADDR;
+        }
+    private:
+        bool held() { return digitalRead(SDA_PIN) == LOW; }
+};
+
+faultBus bus;
+
+// A device part way through sending a byte. It holds SDA low and lets go once it has seen releaseAfter SCL pulses, or never if
+// releaseAfter is 0. Every SCL pulse and the STOP that should follow are logged.
+static uint8_t releaseAfter = 0;
+static uint8_t pulses = 0;
+static bool stopSeen = false;
+static bool sdaWentLow = false;
+
+void watchPins(uint8_t pin, uint8_t value)
+{
+    if(pin == SCL_PIN && value == LOW)
+    {
+        pulses++;
+        if(releaseAfter != 0 && pulses >= releaseAfter) hostHoldPin(SDA_PIN, false);
+    }
+    if(pin == SDA_PIN && value == LOW && digitalRead(SCL_PIN) == HIGH) sdaWentLow = true;
+    if(pin == SDA_PIN && value == HIGH && sdaWentLow && digitalRead(SCL_PIN) == HIGH) stopSeen = true;
+}
+
+void holdSda(uint8_t after)
+{
+    releaseAfter = after;
+    hostHoldPin(SDA_PIN, true);
+}
+#endif
+
+void setUp(void)
+{
+#ifdef ZIPPY_NATIVE
+    bus.reset();
+    Wire.hostAttachBus(&bus);
+    releaseAfter = 0;
+    pulses = 0;
+    stopSeen = false;
+    sdaWentLow = false;
+    hostHoldPin(SDA_PIN, false);
+    hostOnPinWrite(watchPins);
+#endif
+    wireBus.begin(SDA_PIN, SCL_PIN, 100000);
+    wireBus.setRetries(I2C_WIRE_RETRIES);
+    wireBus.resetCounters();
+}
+
+void tearDown(void)
+{
+#ifdef ZIPPY_NATIVE
+    hostOnPinWrite(nullptr);
+    hostHoldPin(SDA_PIN, false);
+#endif
+}
+
+// A bus that was never started has no pins to clock, so there is nothing recover() can do.
+void test_recover_needs_pins(void)
+{
+    amWireBus unstarted(Wire1);
+    TEST_ASSERT_FALSE(unstarted.recover());
+    TEST_ASSERT_EQUAL_UINT32(0, unstarted.getRecoveries());
+}
+
+#ifdef ZIPPY_NATIVE
+// With nothing wrong a read takes one transaction and counts nothing.
+void test_clean_read(void)
+{
+    uint8_t got[4];
+    TEST_ASSERT_EQUAL_UINT8(I2C_OK, wireBus.readRegs(DEVICE, 2, got, 4));
+    for(uint8_t i = 0; i < 4; i++) TEST_ASSERT_EQUAL_HEX8(0x12 + i, got[i]);
+    TEST_ASSERT_EQUAL_UINT16(1, bus.reads);
+    TEST_ASSERT_EQUAL_UINT32(0, wireBus.getTimeouts());
+    TEST_ASSERT_EQUAL_UINT32(0, wireBus.getRetries());
+    TEST_ASSERT_EQUAL_UINT32(0, wireBus.getFailures());
+}
+
+// A read whose bytes go missing once is waited on for the timeout, then tried again and succeeds.
+void test_dropped_read_is_retried(void)
+{
+    bus.dropReads = 1;
+    uint8_t got[4];
+    TEST_ASSERT_EQUAL_UINT8(I2C_OK, wireBus.readRegs(DEVICE, 6, got, 4));
+    TEST_ASSERT_EQUAL_HEX8(0x16, got[0]);
+    TEST_ASSERT_EQUAL_UINT16(2, bus.reads);
+    TEST_ASSERT_EQUAL_UINT32(1, wireBus.getTimeouts());
+    TEST_ASSERT_EQUAL_UINT32(1, wireBus.getRetries());
+    TEST_ASSERT_EQUAL_UINT32(0, wireBus.getRecoveries());
+    TEST_ASSERT_EQUAL_UINT32(0, wireBus.getFailures());
+}
+
+// A device that never answers costs each try its timeout and no more, where while(Wire.available() < n) hung for good.
+void test_lost_device_gives_up_in_time(void)
+{
+    bus.dropReads = 255;
+    uint8_t got[4];
+    uint32_t start = micros();
+    TEST_ASSERT_EQUAL_UINT8(I2C_ERR_TIMEOUT, wireBus.readRegs(DEVICE, 2, got, 4));
+    uint32_t elapsed = micros() - start;
+    TEST_ASSERT_TRUE(elapsed >= I2C_WIRE_TIMEOUT_MS * 1000UL);
+    TEST_ASSERT_TRUE(elapsed < LIMIT_US);
+    TEST_ASSERT_EQUAL_UINT16(I2C_WIRE_RETRIES + 1, bus.reads);
+    TEST_ASSERT_EQUAL_UINT32(I2C_WIRE_RETRIES + 1, wireBus.getTimeouts());
+    TEST_ASSERT_EQUAL_UINT32(1, wireBus.getFailures());
+    TEST_ASSERT_EQUAL_INT(0, Wire.available()); // Nothing left over for the next read.
+}
+
+// More retries mean more tries, and none means one.
+void test_retry_limit(void)
+{
+    bus.dropReads = 255;
+    uint8_t got;
+    wireBus.setRetries(3);
+    TEST_ASSERT_EQUAL_UINT8(I2C_ERR_TIMEOUT, wireBus.readRegs(DEVICE, 2, &got, 1));
+    TEST_ASSERT_EQUAL_UINT16(4, bus.reads);
+    wireBus.setRetries(0);
+    TEST_ASSERT_EQUAL_UINT8(I2C_ERR_TIMEOUT, wireBus.readRegs(DEVICE, 2, &got, 1));
+    TEST_ASSERT_EQUAL_UINT16(5, bus.reads);
+    TEST_ASSERT_EQUAL_UINT32(3, wireBus.getRetries());
+    TEST_ASSERT_EQUAL_UINT32(2, wireBus.getFailures());
+}
+
+// Nothing at the address is an answer, not a fault, so it is not tried again.
+void test_nack_is_not_retried(void)
+{
+    uint8_t got;
+    uint8_t one = 1;
+    TEST_ASSERT_EQUAL_UINT8(I2C_ERR_NACK_ADDR, wireBus.readRegs(0x33, 2, &got, 1));
+    TEST_ASSERT_EQUAL_UINT8(I2C_ERR_NACK_ADDR, wireBus.writeRegs(0x33, 2, &one, 1));
+    TEST_ASSERT_EQUAL_UINT8(I2C_ERR_NACK_ADDR, wireBus.probe(0x33));
+    TEST_ASSERT_EQUAL_UINT32(0, wireBus.getRetries());
+    TEST_ASSERT_EQUAL_UINT16(1, bus.writes);
+}
+
+// A write that fails once is written again.
+void test_failed_write_is_retried(void)
+{
+    bus.failWrites = 1;
+    uint8_t speeds[2] = {200, 60};
+    TEST_ASSERT_EQUAL_UINT8(I2C_OK, wireBus.writeRegs(DEVICE, 0, speeds, 2));
+    TEST_ASSERT_EQUAL_UINT8(200, bus.regs[0]);
+    TEST_ASSERT_EQUAL_UINT8(60, bus.regs[1]);
+    TEST_ASSERT_EQUAL_UINT16(2, bus.writes);
+    TEST_ASSERT_EQUAL_UINT32(1, wireBus.getRetries());
+}
+
+// A device holding SDA is clocked until it lets go, a STOP is sent and the retried read gets through.
+void test_held_sda_is_clocked_free(void)
+{
+    holdSda(3);
+    uint8_t got[4];
+    TEST_ASSERT_EQUAL_UINT8(I2C_OK, wireBus.readRegs(DEVICE, 2, got, 4));
+    TEST_ASSERT_EQUAL_HEX8(0x12, got[0]);
+    TEST_ASSERT_EQUAL_UINT8(3, pulses);
+    TEST_ASSERT_TRUE(stopSeen);
+    TEST_ASSERT_EQUAL_UINT32(1, wireBus.getRecoveries());
+    TEST_ASSERT_EQUAL_UINT32(0, wireBus.getStuck());
+    TEST_ASSERT_EQUAL_UINT32(0, wireBus.getFailures());
+}
+
+// A device that never lets go gets 9 pulses and no more, the bus is counted stuck and the read fails in bounded time.
+void test_stuck_sda_gives_up(void)
+{
+    holdSda(0);
+    uint8_t got[4];
+    uint32_t start = micros();
+    TEST_ASSERT_NOT_EQUAL(I2C_OK, wireBus.readRegs(DEVICE, 2, got, 4));
+    TEST_ASSERT_TRUE(micros() - start < LIMIT_US);
+    TEST_ASSERT_EQUAL_UINT8(I2C_RECOVER_PULSES * I2C_WIRE_RETRIES, pulses);
+    TEST_ASSERT_FALSE(stopSeen);
+    TEST_ASSERT_EQUAL_UINT32(I2C_WIRE_RETRIES, wireBus.getStuck());
+    TEST_ASSERT_EQUAL_UINT32(1, wireBus.getFailures());
+}
+
+// A reset part way through a transaction leaves SDA held. begin() frees it before TwoWire starts.
+void test_begin_frees_held_bus(void)
+{
+    holdSda(5);
+    TEST_ASSERT_TRUE(wireBus.begin(SDA_PIN, SCL_PIN, 100000));
+    TEST_ASSERT_EQUAL_UINT8(5, pulses);
+    TEST_ASSERT_TRUE(stopSeen);
+    TEST_ASSERT_EQUAL_UINT32(1, wireBus.getRecoveries());
+    TEST_ASSERT_EQUAL_UINT16(I2C_WIRE_TIMEOUT_MS, Wire.getTimeOut());
+    uint8_t got;
+    TEST_ASSERT_EQUAL_UINT8(I2C_OK, wireBus.readRegs(DEVICE, 2, &got, 1));
+}
+
+// The MD25 driver sees the retried burst as one good read and a lost controller as an error, never a hang.
+void test_md25_over_faulty_bus(void)
+{
+    amMD25Driver md25(wireBus, DEVICE);
+    md25Telemetry t;
+    bus.dropReads = 1;
+    TEST_ASSERT_EQUAL_UINT8(I2C_OK, md25.readTelemetrySnapshot(&t));
+    TEST_ASSERT_EQUAL_INT32(0x12131415, t.encoder1);
+    bus.dropReads = 255;
+    uint32_t start = micros();
+    TEST_ASSERT_EQUAL_UINT8(I2C_ERR_TIMEOUT, md25.readTelemetrySnapshot(&t));
+    TEST_ASSERT_TRUE(micros() - start < LIMIT_US);
+}
+#endif
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_recover_needs_pins);
+#ifdef ZIPPY_NATIVE
+    RUN_TEST(test_clean_read);
+    RUN_TEST(test_dropped_read_is_retried);
+    RUN_TEST(test_lost_device_gives_up_in_time);
+    RUN_TEST(test_retry_limit);
+    RUN_TEST(test_nack_is_not_retried);
+    RUN_TEST(test_failed_write_is_retried);
+    RUN_TEST(test_held_sda_is_clocked_free);
+    RUN_TEST(test_stuck_sda_gives_up);
+    RUN_TEST(test_begin_frees_held_bus);
+    RUN_TEST(test_md25_over_faulty_bus);
+#endif
+    return UNITY_END();
+}
+
+#ifndef ZIPPY_NATIVE
+void setup()
+{
+    delay(2000); // Give the board time to open the serial port.
+    runUnityTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runUnityTests();
+}
+#endif